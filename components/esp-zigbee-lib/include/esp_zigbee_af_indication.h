@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ESP_ZB_AF_INDICATION_HANDLER_MAX_NUM    8       /*!< Maximum number of APS data indication handlers */
+
+/**
+ * @brief A handler run in the Zigbee task on every APS data indication, before the stack processes the frame.
+ *
+ * @param[in] bufid  The buffer of the indication, the APS payload starts at zb_buf_begin() and the indication is the
+ *                   zb_apsde_data_indication_t parameter of the buffer
+ *
+ * @return true if the handler consumed the frame and freed the buffer, false to pass the frame on
+ *
+ */
+typedef bool (*esp_zb_af_indication_handler_t)(uint8_t bufid);
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Add a handler of the APS data indications.
+ *
+ * @note The stack has a single data indication hook, zb_af_set_data_indication(). It is set while at least one
+ * handler is added and runs the handlers in the order of their addition, the frame is passed on to the next handler
+ * and then to the stack until a handler consumes it. The hook is cleared again when the last handler is removed,
+ * so an application needing the hook adds a handler here instead of setting it.
+ * @warning It must be called from the Zigbee task context or before esp_zb_start().
+ *
+ * @param[in] handler  The handler
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p handler is NULL
+ *         - ESP_ERR_INVALID_STATE if @p handler is already added
+ *         - ESP_ERR_NO_MEM if there are ESP_ZB_AF_INDICATION_HANDLER_MAX_NUM handlers already
+ */
+esp_err_t esp_zb_af_indication_handler_add(esp_zb_af_indication_handler_t handler);
+
+/**
+ * @brief   Remove a handler of the APS data indications, it may be called from a handler.
+ *
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in] handler  The handler given to esp_zb_af_indication_handler_add()
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if @p handler is not added
+ */
+esp_err_t esp_zb_af_indication_handler_remove(esp_zb_af_indication_handler_t handler);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+
+#define ESP_ZB_ALARM_TICK_MS            10          /*!< Resolution in millisecond of the alarms */
+#define ESP_ZB_ALARM_MAX_NUM            0xfffe      /*!< Maximum number of alarms pending at the same time */
+#define ESP_ZB_ALARM_INVALID_HANDLE     0           /*!< A handle which refers to no alarm */
+
+/**
+ * @brief The handle of an alarm, it no longer refers to the alarm once the alarm is expired or cancelled.
+ *
+ */
+typedef uint32_t esp_zb_alarm_handle_t;
+
+/**
+ * @brief A callback run in the Zigbee task when an alarm expires.
+ *
+ * @param[in] handle  The handle of the alarm, a periodic alarm may be cancelled from its callback
+ * @param[in] ctx     The user context given when the alarm was started
+ *
+ */
+typedef void (*esp_zb_alarm_callback_t)(esp_zb_alarm_handle_t handle, void *ctx);
+
+/**
+ * @brief The alarm statistics.
+ *
+ */
+typedef struct esp_zb_alarm_stats_s {
+    uint16_t pending;                               /*!< The number of alarms pending */
+    uint16_t pending_max;                           /*!< The highest number of alarms pending at the same time */
+    uint16_t capacity;                              /*!< The number of alarms which can be pending at the same time */
+    uint32_t expire_count;                          /*!< The number of alarms expired, each period of a periodic alarm counts */
+} esp_zb_alarm_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the alarms.
+ *
+ * @note The alarms are kept in a hierarchical timer wheel of four levels of 64 slots, so starting and cancelling an
+ * alarm take a constant time whatever the number of alarms pending. A single scheduler alarm of the stack drives the
+ * wheel, set to the next slot to process.
+ *
+ * @param[in] alarm_num  The number of alarms which can be pending at the same time, up to ESP_ZB_ALARM_MAX_NUM
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p alarm_num is invalid
+ *         - ESP_ERR_NO_MEM if there is no memory for the alarms
+ *         - ESP_ERR_INVALID_STATE if the alarms are already initialized
+ */
+esp_err_t esp_zb_alarm_init(uint16_t alarm_num);
+
+/**
+ * @brief   Deinitialize the alarms, the pending alarms are dropped.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_alarm_deinit(void);
+
+/**
+ * @brief   Start an alarm.
+ *
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in]  cb      The callback run when the alarm expires
+ * @param[in]  ctx     The user context passed to @p cb
+ * @param[in]  delay   The time in millisecond before the first expiry
+ * @param[in]  period  The time in millisecond between two expiries of a periodic alarm, 0 for a one-shot alarm
+ * @param[out] handle  The handle of the alarm, optional
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p cb is NULL
+ *         - ESP_ERR_NO_MEM if too many alarms are pending
+ *         - ESP_ERR_INVALID_STATE if the alarms are not initialized
+ */
+esp_err_t esp_zb_alarm_start(esp_zb_alarm_callback_t cb, void *ctx, uint32_t delay, uint32_t period, esp_zb_alarm_handle_t *handle);
+
+/**
+ * @brief   Cancel an alarm.
+ *
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in] handle  The handle of the alarm
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the alarm is already expired or cancelled
+ */
+esp_err_t esp_zb_alarm_cancel(esp_zb_alarm_handle_t handle);
+
+/**
+ * @brief   Get the time left before an alarm expires.
+ *
+ * @param[in]  handle     The handle of the alarm
+ * @param[out] remaining  The time in millisecond before the next expiry
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p remaining is NULL
+ *         - ESP_ERR_NOT_FOUND if the alarm is already expired or cancelled
+ */
+esp_err_t esp_zb_alarm_get_remaining(esp_zb_alarm_handle_t handle, uint32_t *remaining);
+
+/**
+ * @brief   Get the statistics of the alarms.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_alarm_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ */
+esp_err_t esp_zb_alarm_get_stats(esp_zb_alarm_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+
+#define ESP_ZB_BATTERY_REPORT_ATTR_MAX_NUM  8       /*!< Maximum number of reporting attributes whose max interval is adapted to the battery level */
+#define ESP_ZB_BATTERY_CURVE_MAX_POINTS     12      /*!< Maximum number of points of a custom discharge curve */
+
+/**
+ * @brief The battery chemistry, which selects the discharge curve used to map the cell voltage to percentage
+ * @anchor esp_zb_battery_chemistry_t
+ */
+typedef enum {
+    ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_COIN   = 0x00,     /*!< Lithium coin cell, e.g. CR2032, 3.0V nominal */
+    ESP_ZB_BATTERY_CHEMISTRY_ALKALINE       = 0x01,     /*!< Alkaline cell, e.g. AA/AAA, 1.5V nominal */
+    ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_ION    = 0x02,     /*!< Lithium-ion or lithium-polymer cell, 3.7V nominal */
+    ESP_ZB_BATTERY_CHEMISTRY_CUSTOM         = 0xff,     /*!< Custom discharge curve provided in @ref esp_zb_battery_cfg_s */
+} esp_zb_battery_chemistry_t;
+
+/**
+ * @brief A point of the battery discharge curve.
+ *
+ */
+typedef struct esp_zb_battery_curve_point_s {
+    uint16_t voltage;                               /*!< The cell voltage in millivolt */
+    uint8_t percentage;                             /*!< The remaining capacity in percent at that voltage */
+} esp_zb_battery_curve_point_t;
+
+/** Battery voltage read callback
+ *
+ * @brief A callback for the battery monitor to measure the battery voltage, e.g. from an ADC channel.
+ *
+ * @note The callback is called from the Zigbee task context every measure period, it should not block.
+ *
+ * @param[out] voltage   The battery voltage in millivolt
+ * @param[in] user_ctx   User information context, set in @ref esp_zb_battery_cfg_s
+ *
+ * @return - ESP_OK if the voltage is measured, otherwise the measurement is skipped
+ */
+typedef esp_err_t (*esp_zb_battery_read_callback_t)(uint16_t *voltage, void *user_ctx);
+
+/** Battery low state callback
+ *
+ * @brief A callback for user to get notification when the battery enters or leaves the low battery mode.
+ *
+ * @param[in] low         True if the battery enters the low battery mode, false if it leaves
+ * @param[in] percentage  The remaining battery capacity in percent
+ * @param[in] user_ctx    User information context, set in @ref esp_zb_battery_cfg_s
+ */
+typedef void (*esp_zb_battery_low_callback_t)(bool low, uint8_t percentage, void *user_ctx);
+
+/**
+ * @brief The reporting attribute whose max interval is adapted to the battery level.
+ *
+ */
+typedef struct esp_zb_battery_report_attr_s {
+    uint8_t endpoint;                               /*!< The endpoint of the reporting attribute */
+    uint16_t cluster_id;                            /*!< The server cluster id of the reporting attribute */
+    uint16_t attr_id;                               /*!< The reporting attribute id */
+} esp_zb_battery_report_attr_t;
+
+/**
+ * @brief The battery monitor configuration.
+ *
+ * @note The report max interval and the keep alive timeout are multiplied by a factor that rises linearly from 1 at
+ * full battery to `drain_stretch` at empty battery, and that is further multiplied by `low_stretch` in low battery mode.
+ *
+ */
+typedef struct esp_zb_battery_cfg_s {
+    uint8_t endpoint;                               /*!< The endpoint holding the power configuration server cluster */
+    esp_zb_battery_chemistry_t chemistry;           /*!< The battery chemistry, refer to esp_zb_battery_chemistry_t */
+    uint8_t cell_num;                               /*!< The number of cells in series, 0 is treated as 1 */
+    const esp_zb_battery_curve_point_t *curve;      /*!< The custom discharge curve ordered by descending voltage, only used by ESP_ZB_BATTERY_CHEMISTRY_CUSTOM */
+    uint8_t curve_size;                             /*!< The number of points of the custom discharge curve, 2 to ESP_ZB_BATTERY_CURVE_MAX_POINTS */
+    uint8_t hysteresis;                             /*!< The minimum change in percent before the remaining capacity is updated */
+    uint8_t low_threshold;                          /*!< The remaining capacity in percent below which the low battery mode is entered */
+    uint32_t measure_period;                        /*!< The measure period in millisecond, 0 if the voltage is pushed by @ref esp_zb_battery_update */
+    uint8_t drain_stretch;                          /*!< The stretch factor applied at empty battery, 0 or 1 disables the stretch */
+    uint8_t low_stretch;                            /*!< The additional stretch factor applied in low battery mode, 0 or 1 disables it */
+    uint32_t keep_alive;                            /*!< The keep alive timeout in millisecond at full battery, 0 to leave it untouched, ZED only */
+    esp_zb_battery_report_attr_t report_attr[ESP_ZB_BATTERY_REPORT_ATTR_MAX_NUM];  /*!< The reporting attributes to stretch */
+    uint8_t report_attr_num;                        /*!< The number of reporting attributes to stretch */
+    esp_zb_battery_read_callback_t read_cb;         /*!< The voltage read callback, NULL if the voltage is pushed by @ref esp_zb_battery_update */
+    esp_zb_battery_low_callback_t low_cb;           /*!< The low battery state callback, optional */
+    void *user_ctx;                                 /*!< User information context passed to the callbacks */
+} esp_zb_battery_cfg_t;
+
+/**
+ * @brief The battery monitor status.
+ *
+ */
+typedef struct esp_zb_battery_status_s {
+    uint16_t voltage;                               /*!< The latest battery voltage in millivolt, of all the cells in series */
+    uint16_t cell_voltage;                          /*!< The latest voltage of one cell in millivolt, the one the discharge curve maps */
+    uint8_t percentage;                             /*!< The remaining capacity in percent after hysteresis */
+    bool low;                                       /*!< The battery is in low battery mode */
+    uint16_t stretch;                               /*!< The stretch factor currently applied, in units of 1/16 */
+} esp_zb_battery_status_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the battery monitor.
+ *
+ * @note The battery monitor writes the BatteryVoltage and BatteryPercentageRemaining attributes of the power
+ * configuration cluster on @p cfg endpoint, and adapts the report max interval of the configured attributes and the
+ * keep alive timeout to the battery level, so the device reports and polls less as the battery drains.
+ * @note It should be called after the Zigbee stack is started, since the reporting information is owned by the stack.
+ * A new max interval is set through the reporting configuration of the stack and the report of the attribute is
+ * started again, so the pending report is scheduled with it.
+ *
+ * @param[in] cfg  Pointer to the battery monitor configuration @ref esp_zb_battery_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ *         - ESP_ERR_INVALID_STATE if the battery monitor is already initialized
+ */
+esp_err_t esp_zb_battery_init(const esp_zb_battery_cfg_t *cfg);
+
+/**
+ * @brief   Deinitialize the battery monitor and restore the original report max intervals and keep alive timeout.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the battery monitor is not initialized
+ */
+esp_err_t esp_zb_battery_deinit(void);
+
+/**
+ * @brief   Feed a battery voltage measurement into the battery monitor.
+ *
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in] voltage  The battery voltage in millivolt
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the battery monitor is not initialized
+ */
+esp_err_t esp_zb_battery_update(uint16_t voltage);
+
+/**
+ * @brief   Map a battery voltage to the remaining capacity in percent.
+ *
+ * @param[in] chemistry  The battery chemistry, refer to esp_zb_battery_chemistry_t, ESP_ZB_BATTERY_CHEMISTRY_CUSTOM is not supported
+ * @param[in] voltage    The cell voltage in millivolt
+ *
+ * @return The remaining capacity in percent
+ */
+uint8_t esp_zb_battery_voltage_to_percentage(esp_zb_battery_chemistry_t chemistry, uint16_t voltage);
+
+/**
+ * @brief   Get the battery monitor status.
+ *
+ * @param[out] status  Pointer to the status @ref esp_zb_battery_status_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the battery monitor is not initialized
+ */
+esp_err_t esp_zb_battery_get_status(esp_zb_battery_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,120 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ESP_ZB_BUF_MONITOR_ID_MAX_NUM       256     /*!< Number of buffer ids the monitor tracks */
+#define ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM  16      /*!< Number of delayed requests pending at once whose buffer is tracked */
+
+/**
+ * @brief The kind of buffer allocation
+ * @anchor esp_zb_buf_monitor_alloc_t
+ */
+typedef enum {
+    ESP_ZB_BUF_MONITOR_ALLOC_OUT            = 0x00,     /*!< An output buffer allocated at once */
+    ESP_ZB_BUF_MONITOR_ALLOC_OUT_DELAYED    = 0x01,     /*!< An output buffer requested with a callback run once a buffer is free */
+    ESP_ZB_BUF_MONITOR_ALLOC_IN             = 0x02,     /*!< An input buffer allocated at once */
+    ESP_ZB_BUF_MONITOR_ALLOC_IN_DELAYED     = 0x03,     /*!< An input buffer requested with a callback run once a buffer is free */
+    ESP_ZB_BUF_MONITOR_ALLOC_MAX            = 0x04,     /*!< The number of kinds of allocation */
+} esp_zb_buf_monitor_alloc_t;
+
+/**
+ * @brief The statistics of a kind of buffer allocation.
+ *
+ */
+typedef struct esp_zb_buf_monitor_alloc_stats_s {
+    uint32_t alloc_count;                           /*!< The number of buffers allocated or requested */
+    uint32_t fail_count;                            /*!< The number of allocations or requests which failed */
+} esp_zb_buf_monitor_alloc_stats_t;
+
+/**
+ * @brief The buffer pool statistics.
+ *
+ */
+typedef struct esp_zb_buf_monitor_stats_s {
+    uint16_t pool_size;                             /*!< The size of the pool, as configured */
+    uint16_t in_use;                                /*!< The number of buffers allocated and not freed yet */
+    uint16_t free;                                  /*!< The pool size less the buffers in use, 0 if the pool size is not configured */
+    uint16_t in_use_max;                            /*!< The highest number of buffers in use at the same time */
+    uint16_t in_use_input;                          /*!< The number of input buffers among the buffers in use */
+    uint32_t free_count;                            /*!< The number of tracked buffers freed */
+    uint32_t untracked_free_count;                  /*!< The number of buffers freed the monitor did not see allocated */
+    uint32_t untracked_alloc_count;                 /*!< The number of delayed requests whose buffer is not tracked, as
+                                                         ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM requests were pending */
+    esp_zb_buf_monitor_alloc_stats_t alloc[ESP_ZB_BUF_MONITOR_ALLOC_MAX];  /*!< The statistics per kind of allocation */
+} esp_zb_buf_monitor_stats_t;
+
+/**
+ * @brief A callback run in the Zigbee task when a buffer allocation fails.
+ *
+ * @param[in] alloc  The kind of allocation which failed, refer to esp_zb_buf_monitor_alloc_t
+ * @param[in] stats  The statistics at the failure @ref esp_zb_buf_monitor_stats_s
+ * @param[in] ctx    The user context given in the configuration
+ *
+ */
+typedef void (*esp_zb_buf_monitor_fail_callback_t)(esp_zb_buf_monitor_alloc_t alloc, const esp_zb_buf_monitor_stats_t *stats, void *ctx);
+
+/**
+ * @brief The buffer monitor configuration.
+ *
+ */
+typedef struct esp_zb_buf_monitor_cfg_s {
+    uint16_t pool_size;                             /*!< The number of buffers the stack library is built with, 0 if unknown */
+    esp_zb_buf_monitor_fail_callback_t fail_cb;     /*!< The callback run on an allocation failure, optional */
+    void *ctx;                                      /*!< The user context passed to @p fail_cb */
+} esp_zb_buf_monitor_cfg_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Configure the buffer monitor.
+ *
+ * @note The monitor needs CONFIG_ZB_BUF_MONITOR, which wraps the buffer functions of the stack at link time. The stack
+ * buffer allocations and releases are then counted from the start, whether the monitor is configured or not. The input and output buffers, allocated at once or given to a delayed request, are tracked by their id so the
+ * buffers in use are known at any time.
+ * @note The linker redirects the calls of the buffer functions between the object files of the stack and the
+ * application, not the calls within the object file of the stack buffer pool. A buffer allocated there is not tracked
+ * and its release counts in untracked_free_count, the buffers in use and free are exact while it stays 0.
+ * @note The buffer pool is sized when the stack library is built, it cannot be changed at run time. The monitor tells
+ * whether the pool is large enough for the traffic of the device.
+ * @warning It must be called from the Zigbee task context or before esp_zb_start().
+ *
+ * @param[in] cfg  Pointer to the buffer monitor configuration @ref esp_zb_buf_monitor_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p cfg is NULL
+ *         - ESP_ERR_NOT_SUPPORTED if CONFIG_ZB_BUF_MONITOR is disabled
+ */
+esp_err_t esp_zb_buf_monitor_config(const esp_zb_buf_monitor_cfg_t *cfg);
+
+/**
+ * @brief   Get the statistics of the buffer pool.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_buf_monitor_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ *         - ESP_ERR_NOT_SUPPORTED if CONFIG_ZB_BUF_MONITOR is disabled
+ */
+esp_err_t esp_zb_buf_monitor_get_stats(esp_zb_buf_monitor_stats_t *stats);
+
+/**
+ * @brief   Clear the counters and set the high watermark to the buffers in use.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_SUPPORTED if CONFIG_ZB_BUF_MONITOR is disabled
+ */
+esp_err_t esp_zb_buf_monitor_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
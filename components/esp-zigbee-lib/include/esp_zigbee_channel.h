@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "zdo/esp_zigbee_zdo_command.h"
+
+#define ESP_ZB_CHANNEL_MASK_WIFI_CLEAR          ((1UL << 15) | (1UL << 20) | (1UL << 25) | (1UL << 26))    /*!< The channels between the Wi-Fi channels 1, 6 and 11 */
+#define ESP_ZB_CHANNEL_MONITOR_PERIOD           600000  /*!< Default time in millisecond between two checks of the channel monitor */
+#define ESP_ZB_CHANNEL_MONITOR_MIN_TRANSMISSION 20      /*!< Default number of transmissions below which the failure rate is not trusted */
+
+/**
+ * @brief A callback for the application to be told the channel monitor moved the network.
+ *
+ * @param[in] old_channel  The channel the network leaves
+ * @param[in] new_channel  The channel the network moves to
+ *
+ */
+typedef void (*esp_zb_channel_change_callback_t)(uint8_t old_channel, uint8_t new_channel);
+
+/**
+ * @brief The channel monitor configuration.
+ *
+ */
+typedef struct esp_zb_channel_monitor_cfg_s {
+    uint32_t channel_mask;                          /*!< The channels the network may move to, the current channel is always scanned */
+    uint32_t check_period;                          /*!< The time in millisecond between two checks, 0 means ESP_ZB_CHANNEL_MONITOR_PERIOD */
+    uint8_t scan_duration;                          /*!< The energy scan duration exponent, 0 to ESP_ZB_ZDO_NWK_UPDATE_SCAN_DURATION_MAX */
+    uint8_t failure_threshold;                      /*!< The transmission failure rate in percent from which the network moves */
+    uint16_t min_transmissions;                     /*!< The number of transmissions in a period below which the network does not move,
+                                                         0 means ESP_ZB_CHANNEL_MONITOR_MIN_TRANSMISSION */
+    uint8_t energy_margin;                          /*!< How much lower the energy of the new channel must be than the current one */
+    esp_zb_channel_change_callback_t change_cb;     /*!< The callback told about a channel change, optional */
+} esp_zb_channel_monitor_cfg_t;
+
+/**
+ * @brief The channel monitor statistics.
+ *
+ */
+typedef struct esp_zb_channel_monitor_stats_s {
+    uint32_t check_count;                           /*!< The number of checks done */
+    uint32_t change_count;                          /*!< The number of channel changes requested */
+    uint16_t transmissions;                         /*!< The number of transmissions during the last period */
+    uint16_t failures;                              /*!< The number of failed transmissions during the last period */
+    uint8_t failure_rate;                           /*!< The transmission failure rate in percent of the last period */
+    uint32_t scanned_channels;                      /*!< The bit mask of the channels of @p energy */
+    uint8_t energy[ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_NUM];    /*!< The energy of the last scan indexed by channel - 11, 0xff is the highest */
+} esp_zb_channel_monitor_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Select the quietest channel from an energy scan.
+ *
+ * @note To form the network on the quietest channel at startup, set a primary channel mask of several channels, e.g.
+ * ESP_ZB_CHANNEL_MASK_WIFI_CLEAR, refer to @ref esp_zb_set_primary_network_channel_set, instead of a single channel,
+ * the formation scans the energy of each of them and picks the quietest.
+ *
+ * @param[in]  rsp           The energy scan response, refer to esp_zb_zdo_mgmt_nwk_update_rsp_s
+ * @param[in]  channel_mask  The channels allowed
+ * @param[out] channel       The quietest channel, the lowest one if several channels have the same energy
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NOT_FOUND if no allowed channel was scanned
+ */
+esp_err_t esp_zb_channel_select(const esp_zb_zdo_mgmt_nwk_update_rsp_t *rsp, uint32_t channel_mask, uint8_t *channel);
+
+/**
+ * @brief   Start the channel monitor on the network manager.
+ *
+ * @note Every period the coordinator scans the energy of the channels and reads its own transmission counters. Once
+ * the failure rate of a period reaches @p failure_threshold, the network moves to the quietest allowed channel if it
+ * is quieter than the current channel by at least @p energy_margin, refer to @ref esp_zb_zdo_channel_change_req.
+ * @warning  Only for the network manager, the Zigbee coordinator by default!
+ *
+ * @param[in] cfg  Pointer to the channel monitor configuration @ref esp_zb_channel_monitor_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ */
+esp_err_t esp_zb_channel_monitor_start(const esp_zb_channel_monitor_cfg_t *cfg);
+
+/**
+ * @brief   Stop the channel monitor.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_channel_monitor_stop(void);
+
+/**
+ * @brief   Run a check of the channel monitor at once, the period restarts from the check.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the channel monitor is not started
+ *         - ESP_ERR_NO_MEM if the energy scan request could not be sent
+ */
+esp_err_t esp_zb_channel_monitor_check(void);
+
+/**
+ * @brief   Get the statistics of the channel monitor.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_channel_monitor_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ */
+esp_err_t esp_zb_channel_monitor_get_stats(esp_zb_channel_monitor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
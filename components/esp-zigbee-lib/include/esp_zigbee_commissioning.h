@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "esp_zigbee_core.h"
+
+#define ESP_ZB_COMMISSIONING_ROUTER_MAX_NUM         32      /*!< Maximum number of routers the permit join windows rotate over */
+#define ESP_ZB_COMMISSIONING_IN_PROGRESS_MAX_NUM    16      /*!< Maximum number of joins in progress tracked at the same time */
+#define ESP_ZB_COMMISSIONING_ALLOWLIST_MAX_NUM      512     /*!< Maximum number of devices of the allowlist */
+#define ESP_ZB_COMMISSIONING_JOIN_TIMEOUT           15000   /*!< Default time in millisecond for a joining device to announce itself */
+
+/**
+ * @brief The commissioning scheduler configuration.
+ *
+ */
+typedef struct esp_zb_commissioning_cfg_s {
+    const uint16_t *router_list;                    /*!< The NWK addresses the joining is opened on in turn, NULL to open on the coordinator only */
+    uint8_t router_num;                             /*!< The number of addresses of @p router_list, up to ESP_ZB_COMMISSIONING_ROUTER_MAX_NUM */
+    uint8_t window;                                 /*!< The duration in second of each permit join window, 1 to 254 */
+    uint8_t max_in_progress;                        /*!< The number of joins in progress at which the joining is closed, 1 to ESP_ZB_COMMISSIONING_IN_PROGRESS_MAX_NUM */
+    uint8_t resume_in_progress;                     /*!< The number of joins in progress under which the joining is opened again, lower than @p max_in_progress */
+    uint16_t join_timeout;                          /*!< The time in millisecond for a joining device to announce itself, 0 means ESP_ZB_COMMISSIONING_JOIN_TIMEOUT */
+    uint16_t duration;                              /*!< The duration in second of the commissioning mode, 0 to run until stopped */
+} esp_zb_commissioning_cfg_t;
+
+/**
+ * @brief The commissioning scheduler statistics.
+ *
+ */
+typedef struct esp_zb_commissioning_stats_s {
+    uint32_t join_count;                            /*!< The number of devices which joined and announced themselves */
+    uint32_t fail_count;                            /*!< The number of joins which did not complete in time or left */
+    uint32_t reject_count;                          /*!< The number of devices asked to leave because they are not in the allowlist */
+    uint32_t join_rate;                             /*!< The average number of joins per 1000 seconds since the start */
+    uint32_t throttle_count;                        /*!< The number of times the joining was closed because too many joins were in progress */
+    uint8_t in_progress;                            /*!< The number of joins in progress, the depth of the authorization queue */
+    uint8_t router_index;                           /*!< The index in the router list of the current permit join window */
+    bool throttled;                                 /*!< True if the joining is closed until the joins in progress complete */
+    bool running;                                   /*!< True if the commissioning mode is running */
+} esp_zb_commissioning_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Start the commissioning mode on the Trust Center.
+ *
+ * @note The joining is opened on one router of @p router_list at a time for @p window seconds, then on the next one,
+ * so the association and transport key traffic is spread over the network instead of hitting the coordinator at once.
+ * A join is in progress from the device update reported by the Trust Center until the device announcement. When
+ * @p max_in_progress joins are in progress the joining is closed, the devices keep retrying, and it is opened again
+ * once fewer than @p resume_in_progress are left.
+ *
+ * @param[in] cfg  Pointer to the commissioning scheduler configuration @ref esp_zb_commissioning_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ */
+esp_err_t esp_zb_commissioning_start(const esp_zb_commissioning_cfg_t *cfg);
+
+/**
+ * @brief   Stop the commissioning mode and close the joining on the whole network.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_commissioning_stop(void);
+
+/**
+ * @brief   Set the allowlist of the devices admitted to the network.
+ *
+ * @note While the commissioning mode runs, a device which joins without the network key while it is not on a
+ * non-empty allowlist is asked to leave at once. The devices rejoining with the network key and the joins outside of
+ * the commissioning mode are not checked.
+ *
+ * @param[in] ieee_list  The IEEE addresses of the admitted devices, the list is copied
+ * @param[in] num        The number of addresses of @p ieee_list, 0 to admit every device
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if there is no memory for the allowlist
+ */
+esp_err_t esp_zb_commissioning_allowlist_set(const esp_zb_ieee_addr_t *ieee_list, uint16_t num);
+
+/**
+ * @brief   Get the statistics of the commissioning scheduler.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_commissioning_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ */
+esp_err_t esp_zb_commissioning_get_stats(esp_zb_commissioning_stats_t *stats);
+
+/**
+ * @brief   Let the commissioning scheduler handle an application signal.
+ *
+ * @note Call it from @ref esp_zb_app_signal_handler.
+ *
+ * @param[in] signal_s  Pointer to the application signal @ref esp_zb_app_signal_s
+ *
+ */
+void esp_zb_commissioning_signal_handle(esp_zb_app_signal_t *signal_s);
+
+#ifdef __cplusplus
+}
+#endif
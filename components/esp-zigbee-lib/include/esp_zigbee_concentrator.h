@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+
+#define ESP_ZB_CONCENTRATOR_DISC_TIME           60      /*!< Default time in second between two many-to-one route requests */
+#define ESP_ZB_CONCENTRATOR_REPAIR_HOLDOFF      10000   /*!< Default minimum time in millisecond between two route repairs */
+#define ESP_ZB_CONCENTRATOR_FAILURE_MAX_NUM     16      /*!< Number of destinations whose route failures are tracked */
+
+/**
+ * @brief The concentrator configuration.
+ *
+ */
+typedef struct esp_zb_concentrator_cfg_s {
+    uint8_t radius;                                 /*!< The radius of the many-to-one route requests, 0 means the maximum radius of the network */
+    uint32_t disc_time;                             /*!< The time in second between two many-to-one route requests, 0 means ESP_ZB_CONCENTRATOR_DISC_TIME */
+    uint32_t repair_holdoff;                        /*!< The minimum time in millisecond between two route repairs triggered by route failures,
+                                                         0 means ESP_ZB_CONCENTRATOR_REPAIR_HOLDOFF */
+} esp_zb_concentrator_cfg_t;
+
+/**
+ * @brief The route failures reported for a destination.
+ *
+ */
+typedef struct esp_zb_concentrator_route_failure_s {
+    uint16_t short_addr;                            /*!< The NWK address of the destination */
+    uint8_t last_status;                            /*!< The last network status reported, refer to the Zigbee network status codes */
+    uint16_t count;                                 /*!< The number of route failures reported */
+    int64_t last_time;                              /*!< The time in microsecond since boot of the last failure, refer to esp_timer_get_time() */
+} esp_zb_concentrator_route_failure_t;
+
+/**
+ * @brief The concentrator statistics.
+ *
+ */
+typedef struct esp_zb_concentrator_stats_s {
+    uint32_t route_failure_count;                   /*!< The number of route failures reported by the network layer */
+    uint32_t source_route_failure_count;            /*!< The number of them which are source route failures */
+    uint32_t many_to_one_failure_count;             /*!< The number of them which are many-to-one route failures */
+    uint32_t repair_count;                          /*!< The number of many-to-one route requests sent at once to repair the routes */
+    uint32_t repair_skip_count;                     /*!< The number of route failures which did not trigger a repair due to the holdoff */
+    bool running;                                   /*!< True if the concentrator mode is running */
+} esp_zb_concentrator_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Start the high RAM concentrator mode on the coordinator.
+ *
+ * @note The coordinator sends a many-to-one route request every @p disc_time seconds, so every router learns a route
+ * towards it without a route discovery of its own. The routers send a route record ahead of their first packet, from
+ * which the stack keeps a source route to each of them, so the replies need no route discovery either.
+ * @note A source route failure or a many-to-one route failure reported by the network layer triggers a many-to-one
+ * route request at once, at most once per @p repair_holdoff.
+ *
+ * @param[in] cfg  Pointer to the concentrator configuration @ref esp_zb_concentrator_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ */
+esp_err_t esp_zb_concentrator_start(const esp_zb_concentrator_cfg_t *cfg);
+
+/**
+ * @brief   Stop the concentrator mode.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_concentrator_stop(void);
+
+/**
+ * @brief   Get the statistics of the concentrator.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_concentrator_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ */
+esp_err_t esp_zb_concentrator_get_stats(esp_zb_concentrator_stats_t *stats);
+
+/**
+ * @brief   Get the destinations with route failures, the most recent first.
+ *
+ * @param[out] failures     Array of the route failures @ref esp_zb_concentrator_route_failure_s to fill
+ * @param[in]  max_num      The capacity of @p failures
+ * @param[out] failure_num  The number of route failures filled
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ */
+esp_err_t esp_zb_concentrator_get_route_failures(esp_zb_concentrator_route_failure_t *failures, uint8_t max_num, uint8_t *failure_num);
+
+/**
+ * @brief   Let the concentrator handle an application signal.
+ *
+ * @note Call it from @ref esp_zb_app_signal_handler.
+ *
+ * @param[in] signal_s  Pointer to the application signal @ref esp_zb_app_signal_s
+ *
+ */
+void esp_zb_concentrator_signal_handle(esp_zb_app_signal_t *signal_s);
+
+#ifdef __cplusplus
+}
+#endif
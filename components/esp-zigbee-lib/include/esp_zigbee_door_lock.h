@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "zcl/esp_zigbee_zcl_door_lock.h"
+
+#define ESP_ZB_DOOR_LOCK_PIN_MAX_LEN                8       /*!< Maximum length in bytes of a PIN code */
+#define ESP_ZB_DOOR_LOCK_RFID_MAX_LEN               10      /*!< Maximum length in bytes of a RFID code */
+#define ESP_ZB_DOOR_LOCK_WEEKDAY_SCHEDULE_NUM       2       /*!< Number of week day schedules per user */
+#define ESP_ZB_DOOR_LOCK_YEARDAY_SCHEDULE_NUM       1       /*!< Number of year day schedules per user */
+#define ESP_ZB_DOOR_LOCK_USER_MAX_NUM               250     /*!< Maximum number of users of the credential store */
+
+/**
+ * @brief The door lock credential type
+ * @anchor esp_zb_door_lock_credential_type_t
+ */
+typedef enum {
+    ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN     = 0x00,     /*!< PIN code entered on the keypad or sent over the air */
+    ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID    = 0x01,     /*!< RFID code read from a tag */
+} esp_zb_door_lock_credential_type_t;
+
+/**
+ * @brief The door lock user status, as defined by ZCL
+ * @anchor esp_zb_door_lock_user_status_t
+ */
+typedef enum {
+    ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE          = 0x00,     /*!< The user id is available */
+    ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_ENABLED   = 0x01,     /*!< The user id is occupied and enabled */
+    ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_DISABLED  = 0x03,     /*!< The user id is occupied and disabled */
+} esp_zb_door_lock_user_status_t;
+
+/**
+ * @brief The door lock user type, as defined by ZCL
+ * @anchor esp_zb_door_lock_user_type_t
+ */
+typedef enum {
+    ESP_ZB_DOOR_LOCK_USER_TYPE_UNRESTRICTED         = 0x00,     /*!< The user has access at any time */
+    ESP_ZB_DOOR_LOCK_USER_TYPE_YEAR_DAY_SCHEDULE    = 0x01,     /*!< The user has access within the year day schedules */
+    ESP_ZB_DOOR_LOCK_USER_TYPE_WEEK_DAY_SCHEDULE    = 0x02,     /*!< The user has access within the week day schedules */
+    ESP_ZB_DOOR_LOCK_USER_TYPE_MASTER               = 0x03,     /*!< The master user has access at any time */
+    ESP_ZB_DOOR_LOCK_USER_TYPE_NON_ACCESS           = 0x04,     /*!< The user has no access */
+} esp_zb_door_lock_user_type_t;
+
+/**
+ * @brief The door lock week day schedule.
+ *
+ */
+typedef struct esp_zb_door_lock_weekday_schedule_s {
+    uint8_t days_mask;                              /*!< The days of the week, bit 0 is Sunday and bit 6 is Saturday, 0 if the schedule is not used */
+    uint8_t start_hour;                             /*!< The start hour, 0 to 23 */
+    uint8_t start_minute;                           /*!< The start minute, 0 to 59 */
+    uint8_t end_hour;                               /*!< The end hour, 0 to 23 */
+    uint8_t end_minute;                             /*!< The end minute, 0 to 59 */
+} esp_zb_door_lock_weekday_schedule_t;
+
+/**
+ * @brief The door lock year day schedule.
+ *
+ */
+typedef struct esp_zb_door_lock_yearday_schedule_s {
+    uint32_t start;                                 /*!< The local start time in second since 1 January 2000, 0 if the schedule is not used */
+    uint32_t end;                                   /*!< The local end time in second since 1 January 2000 */
+} esp_zb_door_lock_yearday_schedule_t;
+
+/**
+ * @brief The door lock user record.
+ *
+ */
+typedef struct esp_zb_door_lock_user_s {
+    uint16_t user_id;                               /*!< The user id, 0 to max user number - 1 */
+    uint8_t status;                                 /*!< The user status, refer to esp_zb_door_lock_user_status_t */
+    uint8_t type;                                   /*!< The user type, refer to esp_zb_door_lock_user_type_t */
+    uint8_t pin_len;                                /*!< The length of the PIN code, 0 if the user has no PIN code */
+    uint8_t pin[ESP_ZB_DOOR_LOCK_PIN_MAX_LEN];      /*!< The PIN code */
+    uint8_t rfid_len;                               /*!< The length of the RFID code, 0 if the user has no RFID code */
+    uint8_t rfid[ESP_ZB_DOOR_LOCK_RFID_MAX_LEN];    /*!< The RFID code */
+    esp_zb_door_lock_weekday_schedule_t weekday[ESP_ZB_DOOR_LOCK_WEEKDAY_SCHEDULE_NUM];    /*!< The week day schedules */
+    esp_zb_door_lock_yearday_schedule_t yearday[ESP_ZB_DOOR_LOCK_YEARDAY_SCHEDULE_NUM];    /*!< The year day schedules */
+} esp_zb_door_lock_user_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the door lock credential store and load the users from NVS.
+ *
+ * @note The users are kept in RAM in a compact record table indexed by a hash of each PIN and RFID code, so a
+ * credential is verified in constant time regardless of the number of users. Each change is written back to NVS
+ * in pages of users, so a single change does not rewrite the whole table.
+ * @note NVS must be initialized before, refer to nvs_flash_init().
+ *
+ * @param[in] user_num  The number of users supported, 1 to ESP_ZB_DOOR_LOCK_USER_MAX_NUM
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p user_num is invalid
+ *         - ESP_ERR_NO_MEM if there is no memory for the user table
+ *         - ESP_ERR_INVALID_STATE if the store is already initialized
+ */
+esp_err_t esp_zb_door_lock_store_init(uint16_t user_num);
+
+/**
+ * @brief   Deinitialize the door lock credential store, the users are kept in NVS.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_door_lock_store_deinit(void);
+
+/**
+ * @brief   Set a batch of users into the credential store.
+ *
+ * @note A user with ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE status is cleared. NVS is written once for the batch.
+ *
+ * @param[in] users     Array of user records @ref esp_zb_door_lock_user_s
+ * @param[in] user_num  Number of the user records
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if a user record is invalid, the records before it are applied
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized or a credential is a duplicate of another user's
+ */
+esp_err_t esp_zb_door_lock_user_set_batch(const esp_zb_door_lock_user_t *users, uint16_t user_num);
+
+/**
+ * @brief   Get a batch of occupied users from the credential store.
+ *
+ * @param[in]  start_id  The user id to start from
+ * @param[out] users     Array of user records @ref esp_zb_door_lock_user_s to fill
+ * @param[in]  max_num   The capacity of @p users
+ * @param[out] user_num  The number of user records filled
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_door_lock_user_get_batch(uint16_t start_id, esp_zb_door_lock_user_t *users, uint16_t max_num, uint16_t *user_num);
+
+/**
+ * @brief   Clear all the credentials of a type, or all users.
+ *
+ * @param[in] type     The credential type to clear, refer to esp_zb_door_lock_credential_type_t
+ * @param[in] all      True to clear the users entirely, @p type is then ignored
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_door_lock_credential_clear_all(esp_zb_door_lock_credential_type_t type, bool all);
+
+/**
+ * @brief   Verify a credential presented to the lock.
+ *
+ * @note The credential is checked against its user status, type and schedules. The schedules are checked against
+ * the local time of the local clock, refer to @ref esp_zb_time_get_local, a scheduled user is denied while the local
+ * clock is not set.
+ *
+ * @param[in]  type     The credential type, refer to esp_zb_door_lock_credential_type_t
+ * @param[in]  code     The code presented
+ * @param[in]  len      The length of @p code
+ * @param[out] user_id  The user id owning the credential, optional
+ *
+ * @return - ESP_OK if access is granted
+ *         - ESP_ERR_NOT_FOUND if the credential does not exist
+ *         - ESP_ERR_NOT_ALLOWED if the user is disabled, a non-access user, of a reserved type or out of its schedules
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_door_lock_credential_verify(esp_zb_door_lock_credential_type_t type, const uint8_t *code, uint8_t len,
+                                             uint16_t *user_id);
+
+/**
+ * @brief   Handle a door lock user management command received by the door lock server.
+ *
+ * @note It handles the payload of Set/Get/Clear/Clear All PIN Code, Set/Get User Status, Set/Get/Clear Weekday Schedule,
+ * Set/Get/Clear Year Day Schedule, Set/Get User Type and Set/Get/Clear/Clear All RFID Code commands, and builds the payload
+ * of the response command, which has the same command id.
+ * @note A Set PIN/RFID Code, Set User Status or Set User Type command with a reserved user status or type is answered
+ * with the ZCL INVALID_FIELD status, and the user is left untouched.
+ *
+ * @param[in]     cmd_id    The command id, refer to esp_zb_zcl_door_lock_cmd_id_t
+ * @param[in]     payload   The ZCL payload of the command
+ * @param[in]     len       The length of @p payload
+ * @param[out]    resp      The buffer to build the ZCL payload of the response command
+ * @param[in,out] resp_len  The size of @p resp as input, the length of the response payload as output
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_SUPPORTED if the command is not a user management command
+ *         - ESP_ERR_INVALID_SIZE if the payload is malformed or @p resp is too small
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_door_lock_cmd_handle(uint8_t cmd_id, const uint8_t *payload, uint16_t len, uint8_t *resp, uint16_t *resp_len);
+
+#ifdef __cplusplus
+}
+#endif
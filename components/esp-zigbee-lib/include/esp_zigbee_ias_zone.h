@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "zcl/esp_zigbee_zcl_ias_zone.h"
+
+#define ESP_ZB_IAS_ZONE_MAX_NUM                 4       /*!< Maximum number of IAS zone endpoints handled by the helper */
+#define ESP_ZB_IAS_ZONE_ENROLL_TIMEOUT          10000   /*!< Time in millisecond to wait for the enroll response before an enroll request can be resent */
+#define ESP_ZB_IAS_ZONE_ALARM_MASK_DEFAULT      (ESP_ZB_ZCL_IAS_ZONE_ZONE_STATUS_ALARM1 | ESP_ZB_ZCL_IAS_ZONE_ZONE_STATUS_ALARM2 | \
+                                                 ESP_ZB_ZCL_IAS_ZONE_ZONE_STATUS_TAMPER)  /*!< Default zone status bits sent on the fast path */
+
+/**
+ * @brief The IAS zone enroll state tracked by the helper
+ * @anchor esp_zb_ias_zone_enroll_state_t
+ */
+typedef enum {
+    ESP_ZB_IAS_ZONE_NOT_ENROLLED    = 0x00,     /*!< The zone is not enrolled to any CIE */
+    ESP_ZB_IAS_ZONE_ENROLLING       = 0x01,     /*!< The enroll request is sent, waiting for the enroll response */
+    ESP_ZB_IAS_ZONE_ENROLLED        = 0x02,     /*!< The zone is enrolled */
+} esp_zb_ias_zone_enroll_state_t;
+
+/**
+ * @brief The IAS zone helper configuration.
+ *
+ */
+typedef struct esp_zb_ias_zone_cfg_s {
+    uint8_t endpoint;                               /*!< The endpoint holding the IAS zone server cluster */
+    uint16_t cie_short_addr;                        /*!< The short address of the CIE */
+    uint8_t cie_endpoint;                           /*!< The endpoint of the CIE */
+    uint16_t zone_type;                             /*!< The zone type sent in the enroll request, refer to esp_zb_zcl_ias_zone_zonetype_t */
+    uint16_t manuf_code;                            /*!< The manufacturer code sent in the enroll request */
+    uint16_t coalesce_window;                       /*!< The window in millisecond in which status changes are merged into one notification */
+    uint16_t alarm_mask;                            /*!< The zone status bits whose transitions bypass the window, 0 means ESP_ZB_IAS_ZONE_ALARM_MASK_DEFAULT */
+} esp_zb_ias_zone_cfg_t;
+
+/**
+ * @brief The IAS zone helper statistics.
+ *
+ */
+typedef struct esp_zb_ias_zone_stats_s {
+    uint32_t update_count;                          /*!< The number of zone status updates from the application */
+    uint32_t notif_count;                           /*!< The number of zone status change notifications sent */
+    uint32_t fast_path_count;                       /*!< The number of notifications sent on the alarm fast path */
+    uint32_t coalesced_count;                       /*!< The number of updates merged into a later notification */
+    uint32_t enroll_req_count;                      /*!< The number of enroll requests sent */
+} esp_zb_ias_zone_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the IAS zone helper on an endpoint.
+ *
+ * @note The IAS zone server cluster must be registered on the endpoint. The zone enroll responses are watched through
+ * a data indication handler, refer to esp_zigbee_af_indication.h, so the status held until the enrollment is sent
+ * as soon as the zone is enrolled.
+ *
+ * @param[in] cfg  Pointer to the IAS zone helper configuration @ref esp_zb_ias_zone_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ *         - ESP_ERR_NO_MEM if all the IAS zone slots are in use, or there are too many data indication handlers
+ */
+esp_err_t esp_zb_ias_zone_init(const esp_zb_ias_zone_cfg_t *cfg);
+
+/**
+ * @brief   Deinitialize the IAS zone helper on an endpoint, the pending notification is dropped.
+ *
+ * @param[in] endpoint  The endpoint holding the IAS zone server cluster
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the helper is not initialized on the endpoint
+ */
+esp_err_t esp_zb_ias_zone_deinit(uint8_t endpoint);
+
+/**
+ * @brief   Update the zone status of an endpoint.
+ *
+ * @note The ZoneStatus attribute is updated at once. A transition of any bit of the alarm mask is notified to the CIE
+ * at once, otherwise the first change is notified at once and the following changes within the coalesce window are
+ * merged into one notification carrying the final zone status at the end of the window. Nothing is sent if the
+ * zone status flips back to the last notified value within the window.
+ * @note The notification is held until the zone is enrolled, refer to @ref esp_zb_ias_zone_enroll, and sent right
+ * after the zone enroll response of the CIE is processed.
+ *
+ * @param[in] endpoint     The endpoint holding the IAS zone server cluster
+ * @param[in] zone_status  The zone status, refer to esp_zb_zcl_ias_zone_zonestatus_t
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the helper is not initialized on the endpoint
+ */
+esp_err_t esp_zb_ias_zone_status_update(uint8_t endpoint, uint16_t zone_status);
+
+/**
+ * @brief   Enroll the zone of an endpoint to the CIE.
+ *
+ * @note The enroll request is not sent if the zone is already enrolled, or if an enroll request is waiting for the
+ * response for less than ESP_ZB_IAS_ZONE_ENROLL_TIMEOUT.
+ *
+ * @param[in] endpoint  The endpoint holding the IAS zone server cluster
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the helper is not initialized on the endpoint
+ */
+esp_err_t esp_zb_ias_zone_enroll(uint8_t endpoint);
+
+/**
+ * @brief   Get the enroll state of the zone of an endpoint.
+ *
+ * @param[in] endpoint  The endpoint holding the IAS zone server cluster
+ *
+ * @return The enroll state, refer to esp_zb_ias_zone_enroll_state_t
+ */
+esp_zb_ias_zone_enroll_state_t esp_zb_ias_zone_get_enroll_state(uint8_t endpoint);
+
+/**
+ * @brief   Get the statistics of the IAS zone helper on an endpoint.
+ *
+ * @param[in]  endpoint  The endpoint holding the IAS zone server cluster
+ * @param[out] stats     Pointer to the statistics @ref esp_zb_ias_zone_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the helper is not initialized on the endpoint
+ */
+esp_err_t esp_zb_ias_zone_get_stats(uint8_t endpoint, esp_zb_ias_zone_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_secur.h"
+
+#define ESP_ZB_IC_STORE_DEVICE_MAX_NUM      4096    /*!< Maximum number of devices of the install code store */
+#define ESP_ZB_IC_STORE_PAGE_SIZE           128     /*!< Number of devices written to NVS in one blob */
+#define ESP_ZB_IC_STORE_KEY_SIZE            16      /*!< Size in bytes of a derived link key */
+#define ESP_ZB_IC_STORE_PROVISION_BATCH     32      /*!< Number of link keys installed into the stack per scheduler run */
+
+/**
+ * @brief The format of an install code blob to import
+ * @anchor esp_zb_ic_store_format_t
+ */
+typedef enum {
+    ESP_ZB_IC_STORE_FORMAT_CSV      = 0x00,     /*!< CSV text as produced by tools/mfg_tool, with a header line naming the columns, the
+                                                     installcode and mac_address columns are used, a NULL install code line is skipped */
+    ESP_ZB_IC_STORE_FORMAT_PACKED   = 0x01,     /*!< Packed binary records, each of the IEEE address in little endian (8 bytes), the
+                                                     install code type (1 byte, refer to esp_zb_secur_ic_type_t) and the install code
+                                                     followed by its CRC (8, 10, 14 or 18 bytes) */
+} esp_zb_ic_store_format_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the install code store and load the devices from NVS.
+ *
+ * @note Only the link key derived from the install code of each device is kept, in a compact table indexed by a hash
+ * of the IEEE address, so the store finds a device in constant time regardless of the number of devices. The stack does
+ * not look into the store when a device joins, it only uses the keys installed into its own key table, refer to
+ * @ref esp_zb_ic_store_provision_all and @ref esp_zb_ic_store_signal_handle.
+ * @note NVS must be initialized before, refer to nvs_flash_init().
+ *
+ * @param[in] device_num  The number of devices supported, 1 to ESP_ZB_IC_STORE_DEVICE_MAX_NUM
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p device_num is invalid
+ *         - ESP_ERR_NO_MEM if there is no memory for the device table
+ *         - ESP_ERR_INVALID_STATE if the store is already initialized
+ */
+esp_err_t esp_zb_ic_store_init(uint16_t device_num);
+
+/**
+ * @brief   Deinitialize the install code store, the devices are kept in NVS.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_ic_store_deinit(void);
+
+/**
+ * @brief   Import a blob of install codes into the store.
+ *
+ * @note Each install code is checked against its CRC and hashed into the link key at once, an existing device is
+ * updated. NVS is written once for the blob, in pages of ESP_ZB_IC_STORE_PAGE_SIZE devices.
+ *
+ * @param[in]  blob      The blob to import
+ * @param[in]  len       The length of @p blob
+ * @param[in]  format    The format of @p blob, refer to esp_zb_ic_store_format_t
+ * @param[out] imported  The number of devices imported, optional
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if a record is malformed, the records before it are imported
+ *         - ESP_ERR_INVALID_CRC if the CRC of an install code does not match, the records before it are imported
+ *         - ESP_ERR_NO_MEM if the store is full, the records before it are imported
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_ic_store_import(const uint8_t *blob, size_t len, esp_zb_ic_store_format_t format, uint16_t *imported);
+
+/**
+ * @brief   Find the link key derived from the install code of a device.
+ *
+ * @param[in]  ieee_addr  The IEEE address of the device
+ * @param[out] key        The buffer of ESP_ZB_IC_STORE_KEY_SIZE bytes for the link key, optional
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the device is not in the store
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_ic_store_find(const esp_zb_ieee_addr_t ieee_addr, uint8_t *key);
+
+/**
+ * @brief   Remove a device from the store.
+ *
+ * @param[in] ieee_addr  The IEEE address of the device
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the device is not in the store
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_ic_store_remove(const esp_zb_ieee_addr_t ieee_addr);
+
+/**
+ * @brief   Remove all the devices from the store.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_ic_store_clear(void);
+
+/**
+ * @brief   Get the number of devices in the store.
+ *
+ * @return The number of devices, 0 if the store is not initialized
+ */
+uint16_t esp_zb_ic_store_get_count(void);
+
+/**
+ * @brief   Install the link key of a device into the key table of the Trust Center.
+ *
+ * @note The precomputed key is installed as the provisional unique link key of the device, the install code is not
+ * hashed again by the stack.
+ * @warning  Only for the Trust Center device (Zigbee coordinator)!
+ *
+ * @param[in] ieee_addr  The IEEE address of the device
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the device is not in the store
+ *         - ESP_ERR_NO_MEM if the key table of the stack is full
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_ic_store_provision(const esp_zb_ieee_addr_t ieee_addr);
+
+/**
+ * @brief   Install the link keys of all the devices into the key table of the Trust Center.
+ *
+ * @note The keys are installed ESP_ZB_IC_STORE_PROVISION_BATCH at a time from the Zigbee scheduler, so the stack keeps
+ * running. It stops once the key table of the stack is full, the store is then used to provision the devices expected
+ * next by @ref esp_zb_ic_store_provision.
+ * @warning  Only for the Trust Center device (Zigbee coordinator)!
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t esp_zb_ic_store_provision_all(void);
+
+/**
+ * @brief   Let the install code store handle an application signal.
+ *
+ * @note Call it from @ref esp_zb_app_signal_handler. On the device update of a device joining without the network key,
+ * the link key of the device is installed into the key table of the stack if the device is in the store. The stack may
+ * have sent the network key before the signal is handled, the device then gets its key on its next join attempt, and a
+ * device joining the coordinator directly is not reported by a device update. The keys of the devices expected are
+ * best installed beforehand by @ref esp_zb_ic_store_provision_all or @ref esp_zb_ic_store_provision, the signal covers
+ * the devices imported since.
+ * @warning  Only for the Trust Center device (Zigbee coordinator)!
+ *
+ * @param[in] signal_s  Pointer to the application signal @ref esp_zb_app_signal_s
+ *
+ */
+void esp_zb_ic_store_signal_handle(esp_zb_app_signal_t *signal_s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "esp_zigbee_core.h"
+
+#define ESP_ZB_INTERVIEW_CONCURRENCY_MAX_NUM    8       /*!< Maximum number of devices interviewed at the same time */
+#define ESP_ZB_INTERVIEW_QUEUE_SIZE             64      /*!< Maximum number of devices waiting to be interviewed */
+#define ESP_ZB_INTERVIEW_EP_MAX_NUM             8       /*!< Maximum number of endpoints recorded per device */
+#define ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM        16      /*!< Maximum number of clusters recorded per endpoint */
+#define ESP_ZB_INTERVIEW_STRING_MAX_LEN         32      /*!< Maximum length of the identity strings */
+#define ESP_ZB_INTERVIEW_STEP_TIMEOUT           5000    /*!< Default time in millisecond to wait for the response of a step */
+
+/**
+ * @brief The endpoint record of an interviewed device
+ *
+ */
+typedef struct esp_zb_interview_endpoint_s {
+    uint8_t endpoint;                               /*!< The endpoint id */
+    uint16_t profile_id;                            /*!< The application profile identifier */
+    uint16_t device_id;                             /*!< The application device identifier */
+    uint8_t device_version;                         /*!< The application device version */
+    uint8_t input_cluster_count;                    /*!< The number of input clusters recorded */
+    uint8_t output_cluster_count;                   /*!< The number of output clusters recorded */
+    uint16_t cluster_list[ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM];   /*!< The input clusters followed by the output clusters */
+} esp_zb_interview_endpoint_t;
+
+/**
+ * @brief The record of an interviewed device
+ *
+ */
+typedef struct esp_zb_interview_device_s {
+    esp_zb_ieee_addr_t ieee_addr;                   /*!< IEEE address of the device */
+    uint16_t short_addr;                            /*!< NWK address of the device */
+    uint8_t capability;                             /*!< MAC capability of the device from its device announcement */
+    esp_zb_af_node_desc_t node_desc;                /*!< The node descriptor */
+    uint8_t ep_count;                               /*!< The number of endpoints recorded */
+    esp_zb_interview_endpoint_t ep[ESP_ZB_INTERVIEW_EP_MAX_NUM];   /*!< The endpoints recorded */
+    uint8_t basic_endpoint;                         /*!< The endpoint the identity is read from, 0 if no endpoint has a Basic server */
+    char manufacturer_name[ESP_ZB_INTERVIEW_STRING_MAX_LEN + 1];   /*!< The ManufacturerName attribute, empty if unsupported */
+    char model_id[ESP_ZB_INTERVIEW_STRING_MAX_LEN + 1];            /*!< The ModelIdentifier attribute, empty if unsupported */
+    uint8_t app_version;                            /*!< The ApplicationVersion attribute */
+    uint8_t power_source;                           /*!< The PowerSource attribute, 0xff if unsupported */
+} esp_zb_interview_device_t;
+
+/**
+ * @brief A callback for user to get the record of an interviewed device
+ *
+ * @param[in] status  ESP_OK if the interview is complete, ESP_ERR_TIMEOUT if a step failed after all the retries,
+ *                    the record then holds what was collected so far
+ * @param[in] device  The device record @ref esp_zb_interview_device_s, valid only in the callback
+ *
+ */
+typedef void (*esp_zb_interview_callback_t)(esp_err_t status, const esp_zb_interview_device_t *device);
+
+/**
+ * @brief The interview engine configuration.
+ *
+ */
+typedef struct esp_zb_interview_cfg_s {
+    uint8_t src_endpoint;                           /*!< The local endpoint the Basic cluster attributes are read from */
+    uint8_t concurrency;                            /*!< The number of devices interviewed at the same time, 1 to ESP_ZB_INTERVIEW_CONCURRENCY_MAX_NUM */
+    uint8_t max_retry;                              /*!< The number of requests resent per device before its interview fails */
+    uint16_t step_timeout;                          /*!< The time in millisecond to wait for a response, 0 means ESP_ZB_INTERVIEW_STEP_TIMEOUT */
+    esp_zb_interview_callback_t done_cb;            /*!< The callback called when the interview of a device is finished */
+} esp_zb_interview_cfg_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the interview engine.
+ *
+ * @note Each device is interviewed in steps: node descriptor, active endpoints, the simple descriptor of every
+ * endpoint, then the ManufacturerName, ModelIdentifier, ApplicationVersion and PowerSource attributes of the Basic
+ * cluster. The requests of up to @p concurrency devices are in flight at the same time.
+ * @note The Basic cluster attributes are taken from the read attribute response handlers, refer to
+ * esp_zigbee_read_attr.h, a response is matched to its device by the source address and the ZCL sequence number
+ * of the read in flight. The read attribute response callback of @p src_endpoint is left to the application.
+ *
+ * @param[in] cfg  Pointer to the interview engine configuration @ref esp_zb_interview_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ *         - ESP_ERR_NO_MEM if there are too many read attribute response handlers
+ */
+esp_err_t esp_zb_interview_init(const esp_zb_interview_cfg_t *cfg);
+
+/**
+ * @brief   Deinitialize the interview engine, the running and queued interviews are dropped.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_interview_deinit(void);
+
+/**
+ * @brief   Queue the interview of a device.
+ *
+ * @note If the device is already queued or being interviewed with another NWK address, the address is updated and
+ * the running interview is restarted.
+ *
+ * @param[in] short_addr  NWK address of the device
+ * @param[in] ieee_addr   IEEE address of the device
+ * @param[in] capability  MAC capability of the device
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the interview engine is not initialized
+ *         - ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t esp_zb_interview_start(uint16_t short_addr, const esp_zb_ieee_addr_t ieee_addr, uint8_t capability);
+
+/**
+ * @brief   Let the interview engine handle an application signal.
+ *
+ * @note Call it from @ref esp_zb_app_signal_handler, every device announced by ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE
+ * is queued for interview.
+ *
+ * @param[in] signal_s  Pointer to the application signal @ref esp_zb_app_signal_s
+ *
+ */
+void esp_zb_interview_signal_handle(esp_zb_app_signal_t *signal_s);
+
+#ifdef __cplusplus
+}
+#endif
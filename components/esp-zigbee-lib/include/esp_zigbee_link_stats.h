@@ -0,0 +1,169 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+
+#define ESP_ZB_LINK_STATS_NODE_MAX_NUM          32      /*!< Number of nodes whose statistics are kept, the least recently seen is replaced */
+#define ESP_ZB_LINK_STATS_WINDOW_NUM            8       /*!< Number of time windows kept per node */
+#define ESP_ZB_LINK_STATS_LATENCY_SAMPLE_NUM    16      /*!< Number of latency samples kept per node */
+#define ESP_ZB_LINK_STATS_REQUEST_MAX_NUM       4       /*!< Number of requests per node waiting for their response, the oldest is given up */
+#define ESP_ZB_LINK_STATS_WINDOW_PERIOD         60000   /*!< Default time in millisecond covered by a window */
+
+/**
+ * @brief The statistics of a node over a time window.
+ *
+ */
+typedef struct esp_zb_link_stats_window_s {
+    uint16_t rx_count;                              /*!< The number of frames received from the node as the last hop */
+    uint8_t lqi_avg;                                /*!< The average LQI of the frames received, 0 if none */
+    int8_t rssi_avg;                                /*!< The average RSSI in dBm of the frames received, 0 if none */
+    uint16_t tx_count;                              /*!< The number of frames sent to the node with a delivery confirmation */
+    uint16_t tx_fail_count;                         /*!< The number of those frames whose confirmation is a failure */
+    uint16_t retry_count;                           /*!< The number of MAC retries of the frames sent to the node */
+    uint16_t route_fail_count;                      /*!< The number of route failures to the node reported by the network layer */
+} esp_zb_link_stats_window_t;
+
+/**
+ * @brief The statistics of a node.
+ *
+ */
+typedef struct esp_zb_link_stats_node_s {
+    uint16_t short_addr;                            /*!< The NWK address of the node */
+    uint32_t last_seen;                             /*!< The time in millisecond since a frame was last received from the node */
+    uint8_t latency_count;                          /*!< The number of latency samples kept */
+    uint16_t latency_p50;                           /*!< The median request latency in millisecond */
+    uint16_t latency_p90;                           /*!< The 90th percentile of the request latency in millisecond */
+    uint16_t latency_max;                           /*!< The highest request latency in millisecond */
+    esp_zb_link_stats_window_t total;               /*!< The sum of the windows */
+    esp_zb_link_stats_window_t window[ESP_ZB_LINK_STATS_WINDOW_NUM];   /*!< The windows, the current one first */
+} esp_zb_link_stats_node_t;
+
+/**
+ * @brief The link statistics configuration.
+ *
+ */
+typedef struct esp_zb_link_stats_cfg_s {
+    uint32_t window_period;                         /*!< The time in millisecond covered by a window, ESP_ZB_LINK_STATS_WINDOW_PERIOD by default */
+} esp_zb_link_stats_cfg_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Start keeping the link statistics.
+ *
+ * @note The LQI and RSSI of the frames received are accounted to the node they come from at the last hop, through the
+ * APS data indication handlers, refer to esp_zb_af_indication_handler_add(), so the neighbors are known with their link
+ * quality. The frames sent are accounted from their APS confirm, refer to @ref esp_zb_link_stats_tx_confirm, and the
+ * route failures from the ESP_ZB_NLME_STATUS_INDICATION signals, refer to @ref esp_zb_link_stats_signal_handle. The
+ * request latency runs from @ref esp_zb_link_stats_request_begin to the response with the sequence number of the request.
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in] cfg  Pointer to the link statistics configuration @ref esp_zb_link_stats_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p cfg is NULL
+ *         - ESP_ERR_INVALID_STATE if the link statistics are already started
+ *         - ESP_ERR_NO_MEM if there is no data indication handler left
+ */
+esp_err_t esp_zb_link_stats_start(const esp_zb_link_stats_cfg_t *cfg);
+
+/**
+ * @brief   Stop keeping the link statistics, the statistics are cleared.
+ *
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_link_stats_stop(void);
+
+/**
+ * @brief   Account a frame sent to a node, whose delivery is known from elsewhere than a ZCL send confirmation.
+ *
+ * @param[in] short_addr  The NWK address of the node
+ * @param[in] success     The frame was delivered
+ * @param[in] retries     The number of MAC retries of the frame
+ *
+ */
+void esp_zb_link_stats_tx_record(uint16_t short_addr, bool success, uint8_t retries);
+
+/**
+ * @brief   Account a ZCL frame sent from its APS confirm.
+ *
+ * @note It is the callback of a ZCL frame sent through the stack, e.g. the cb of ZB_ZCL_SEND_COMMAND_SHORT(), which
+ * the stack runs with the buffer of the frame once the APS confirm is received. The buffer is freed. The frames sent
+ * to a group or through a binding are not accounted.
+ *
+ * @param[in] bufid  The buffer with the zb_zcl_command_send_status_t parameter
+ *
+ */
+void esp_zb_link_stats_tx_confirm(uint8_t bufid);
+
+/**
+ * @brief   Mark that a request is sent to a node, the latency is the time until the response from the node with the
+ * sequence number of the request.
+ *
+ * @note Up to ESP_ZB_LINK_STATS_REQUEST_MAX_NUM requests per node wait for their response, a request without response
+ * is given up when the slots are full.
+ *
+ * @param[in] short_addr  The NWK address of the node
+ * @param[in] zdo         The request is a ZDO one, else a ZCL one
+ * @param[in] tsn         The ZDO or ZCL sequence number of the request
+ *
+ */
+void esp_zb_link_stats_request_begin(uint16_t short_addr, bool zdo, uint8_t tsn);
+
+/**
+ * @brief   Account the route failures reported by the network layer.
+ *
+ * @note It is to be called from esp_zb_app_signal_handler(), the signals other than ESP_ZB_NLME_STATUS_INDICATION are
+ * ignored.
+ *
+ * @param[in] signal_s  The signal given to esp_zb_app_signal_handler() @ref esp_zb_app_signal_s
+ *
+ */
+void esp_zb_link_stats_signal_handle(esp_zb_app_signal_t *signal_s);
+
+/**
+ * @brief   Get the statistics of a node.
+ *
+ * @param[in]  short_addr  The NWK address of the node
+ * @param[out] node        Pointer to the statistics @ref esp_zb_link_stats_node_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p node is NULL
+ *         - ESP_ERR_NOT_FOUND if the node is not known
+ */
+esp_err_t esp_zb_link_stats_get(uint16_t short_addr, esp_zb_link_stats_node_t *node);
+
+/**
+ * @brief   Get the statistics of all the nodes known.
+ *
+ * @param[out] nodes     Array of the statistics @ref esp_zb_link_stats_node_s to fill
+ * @param[in]  max_num   The capacity of @p nodes
+ * @param[out] node_num  The number of statistics filled
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ */
+esp_err_t esp_zb_link_stats_get_nodes(esp_zb_link_stats_node_t *nodes, uint8_t max_num, uint8_t *node_num);
+
+/**
+ * @brief   Print the statistics of all the nodes known to the console.
+ *
+ */
+void esp_zb_link_stats_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
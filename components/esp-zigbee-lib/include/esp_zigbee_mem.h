@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief The subsystem a heap allocation is accounted to
+ * @anchor esp_zb_mem_tag_t
+ */
+typedef enum {
+    ESP_ZB_MEM_TAG_CORE         = 0x00,     /*!< The library core: device registration, signals, scene table and ZCL callbacks, alarms and submissions */
+    ESP_ZB_MEM_TAG_DATA_MODEL   = 0x01,     /*!< The attribute, cluster and endpoint lists */
+    ESP_ZB_MEM_TAG_ZCL          = 0x02,     /*!< The ZCL commands and the cluster stores, e.g. the door lock users */
+    ESP_ZB_MEM_TAG_ZDO          = 0x03,     /*!< The ZDO requests and the device registry */
+    ESP_ZB_MEM_TAG_NWK          = 0x04,     /*!< The network tables kept by the library: the topology crawler, the install code store and the join allow list of the commissioning */
+    ESP_ZB_MEM_TAG_OTA          = 0x05,     /*!< The OTA upgrade client and server */
+    ESP_ZB_MEM_TAG_CLI          = 0x06,     /*!< The Zigbee CLI */
+    ESP_ZB_MEM_TAG_APP          = 0x07,     /*!< The application, through @ref esp_zb_mem_malloc */
+    ESP_ZB_MEM_TAG_MAX          = 0x08,     /*!< The number of tags */
+} esp_zb_mem_tag_t;
+
+/**
+ * @brief The heap usage of a subsystem.
+ *
+ */
+typedef struct esp_zb_mem_stats_s {
+    uint32_t current;                               /*!< The number of bytes allocated and not freed yet */
+    uint32_t peak;                                  /*!< The highest number of bytes allocated at the same time */
+    uint32_t block_count;                           /*!< The number of blocks allocated and not freed yet */
+    uint32_t fail_count;                            /*!< The number of allocations which failed */
+} esp_zb_mem_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Allocate a block of memory accounted to a subsystem.
+ *
+ * @note The heap allocations of the component sources are accounted this way from the start, those of the prebuilt
+ * libraries only with CONFIG_ZB_MEM_TAG_LIBRARY, which redirects them per object file when the project is configured.
+ * The block must be freed with @ref esp_zb_mem_free, a block freed with free() stays accounted until the heap gives its
+ * address again to an accounted allocation. The size and the tag of each block are kept in a table apart from the
+ * block, an entry of 8 bytes on the 32-bit targets, the table being doubled when three quarters full and halved when
+ * less than an eighth full.
+ *
+ * @param[in] tag   The subsystem, refer to esp_zb_mem_tag_t
+ * @param[in] size  The size in bytes of the block
+ *
+ * @return The block, NULL if the heap is exhausted
+ */
+void *esp_zb_mem_malloc(esp_zb_mem_tag_t tag, size_t size);
+
+/**
+ * @brief   Allocate a zeroed array accounted to a subsystem.
+ *
+ * @param[in] tag   The subsystem, refer to esp_zb_mem_tag_t
+ * @param[in] num   The number of elements
+ * @param[in] size  The size in bytes of an element
+ *
+ * @return The array, NULL if the heap is exhausted
+ */
+void *esp_zb_mem_calloc(esp_zb_mem_tag_t tag, size_t num, size_t size);
+
+/**
+ * @brief   Resize a block of memory.
+ *
+ * @note The block stays accounted to the subsystem which allocated it, @p tag only applies when @p ptr is NULL. A block
+ * from elsewhere is handed to realloc() and stays out of the accounting.
+ *
+ * @param[in] tag   The subsystem, refer to esp_zb_mem_tag_t
+ * @param[in] ptr   The block to resize, NULL to allocate a new one
+ * @param[in] size  The new size in bytes of the block, 0 frees it
+ *
+ * @return The block, NULL if the heap is exhausted, the block given is then left as it is
+ */
+void *esp_zb_mem_realloc(esp_zb_mem_tag_t tag, void *ptr, size_t size);
+
+/**
+ * @brief   Free a block of memory.
+ *
+ * @note A block which was not allocated by @ref esp_zb_mem_malloc, @ref esp_zb_mem_calloc or @ref esp_zb_mem_realloc
+ * is handed to free() as it is, its memory is not read.
+ *
+ * @param[in] ptr  The block, NULL is ignored
+ *
+ */
+void esp_zb_mem_free(void *ptr);
+
+/**
+ * @brief   Get the heap usage of a subsystem.
+ *
+ * @param[in]  tag    The subsystem, refer to esp_zb_mem_tag_t
+ * @param[out] stats  Pointer to the heap usage @ref esp_zb_mem_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ */
+esp_err_t esp_zb_mem_stats_get(esp_zb_mem_tag_t tag, esp_zb_mem_stats_t *stats);
+
+/**
+ * @brief   Set the peaks to the current usage and clear the failure counters.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_mem_stats_reset(void);
+
+/**
+ * @brief   Get the name of a subsystem.
+ *
+ * @param[in] tag  The subsystem, refer to esp_zb_mem_tag_t
+ *
+ * @return The name, "unknown" if @p tag is invalid
+ */
+const char *esp_zb_mem_tag_to_name(esp_zb_mem_tag_t tag);
+
+/**
+ * @brief   Print the heap usage of all the subsystems to the console.
+ *
+ */
+void esp_zb_mem_stats_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
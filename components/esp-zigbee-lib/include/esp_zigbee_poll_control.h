@@ -0,0 +1,192 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_attribute.h"
+#include "zcl/esp_zigbee_zcl_poll_control.h"
+
+#define ESP_ZB_POLL_CONTROL_INTERACTION_TIMEOUT     10000   /*!< Default time in millisecond of fast poll after a local user interaction */
+#define ESP_ZB_POLL_CONTROL_DECAY_STEP              2000    /*!< Default time in millisecond spent at each poll interval while decaying to long poll */
+#define ESP_ZB_POLL_CONTROL_CHECK_IN_WAIT           2000    /*!< Time in millisecond of fast poll after a check-in, waiting for the check-in responses */
+
+/**
+ * @brief The poll control configuration.
+ *
+ * @note The intervals are in quarter seconds, as the attributes of the poll control cluster.
+ *
+ */
+typedef struct esp_zb_poll_control_cfg_s {
+    uint8_t endpoint;                               /*!< The endpoint of the poll control cluster server */
+    uint32_t check_in_interval;                     /*!< The time between two check-ins, 0 disables the check-in */
+    uint32_t long_poll_interval;                    /*!< The poll interval while the device is idle */
+    uint16_t short_poll_interval;                   /*!< The poll interval while the device is in fast poll */
+    uint16_t fast_poll_timeout;                     /*!< The fast poll time requested by a check-in response carrying no timeout */
+    uint16_t fast_poll_timeout_max;                 /*!< The longest fast poll time a check-in response may request, 0 means no limit */
+    uint32_t interaction_timeout;                   /*!< The time in millisecond of fast poll after a local user interaction,
+                                                         0 means ESP_ZB_POLL_CONTROL_INTERACTION_TIMEOUT */
+    uint32_t decay_step;                            /*!< The time in millisecond spent at each poll interval between the short and the
+                                                         long poll interval, 0 means ESP_ZB_POLL_CONTROL_DECAY_STEP */
+} esp_zb_poll_control_cfg_t;
+
+/**
+ * @brief The poll control statistics.
+ *
+ */
+typedef struct esp_zb_poll_control_stats_s {
+    uint32_t poll_interval;                         /*!< The poll interval in millisecond currently applied */
+    bool fast_poll;                                 /*!< The device is in fast poll */
+    uint16_t pending_transactions;                  /*!< The number of transactions pending */
+    uint32_t fast_poll_count;                       /*!< The number of times the device entered fast poll */
+    uint32_t check_in_count;                        /*!< The number of check-ins sent */
+} esp_zb_poll_control_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Create a poll control cluster attribute list.
+ *
+ * @note Add it to the cluster list of the endpoint as a server with @ref esp_zb_cluster_list_add_custom_cluster.
+ *
+ * @param[in] cfg  Pointer to the poll control configuration @ref esp_zb_poll_control_cfg_s
+ *
+ * @return Pointer to attribute list @ref esp_zb_attribute_list_s, NULL if the configuration is invalid
+ */
+esp_zb_attribute_list_t *esp_zb_poll_control_cluster_create(const esp_zb_poll_control_cfg_t *cfg);
+
+/**
+ * @brief   Initialize the adaptive poller of the end device.
+ *
+ * @note The device polls its parent every long poll interval while it is idle. It switches to the short poll interval
+ * while a transaction is pending, after a local user interaction, after a check-in or on request of a check-in
+ * response, then doubles the interval every @p decay_step until it is back to the long poll interval, so a burst of
+ * commands following an interaction is still received quickly.
+ * @note It should be called after the Zigbee stack is started.
+ * @warning The poller functions must be called from the Zigbee task context.
+ *
+ * @param[in] cfg  Pointer to the poll control configuration @ref esp_zb_poll_control_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ */
+esp_err_t esp_zb_poll_control_init(const esp_zb_poll_control_cfg_t *cfg);
+
+/**
+ * @brief   Deinitialize the adaptive poller, the device is left at the long poll interval.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_poll_control_deinit(void);
+
+/**
+ * @brief   Tell the poller about a local user interaction, e.g. a button press or a display wake up.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the poller is not initialized
+ */
+esp_err_t esp_zb_poll_control_interaction(void);
+
+/**
+ * @brief   Tell the poller a transaction expecting a response from the network begins.
+ *
+ * @note The device stays in fast poll until every transaction begun is ended by @ref esp_zb_poll_control_transaction_end.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the poller is not initialized
+ */
+esp_err_t esp_zb_poll_control_transaction_begin(void);
+
+/**
+ * @brief   Tell the poller a transaction is completed or timed out.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the poller is not initialized or no transaction is pending
+ */
+esp_err_t esp_zb_poll_control_transaction_end(void);
+
+/**
+ * @brief   Start fast poll for a given time.
+ *
+ * @param[in] timeout  The time in quarter seconds, 0 means the fast poll timeout of the configuration
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the poller is not initialized
+ */
+esp_err_t esp_zb_poll_control_fast_poll_start(uint16_t timeout);
+
+/**
+ * @brief   Stop fast poll, the pending transactions still keep the device in fast poll.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the poller is not initialized
+ */
+esp_err_t esp_zb_poll_control_fast_poll_stop(void);
+
+/**
+ * @brief   Send a check-in to the bound poll control clients at once, the check-in period restarts from it.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the poller is not initialized
+ *         - ESP_ERR_NO_MEM if the check-in could not be sent
+ */
+esp_err_t esp_zb_poll_control_check_in(void);
+
+/**
+ * @brief   Handle a poll control command received by the poll control server.
+ *
+ * @note It handles the payload of Check-in Response, Fast Poll Stop, Set Long Poll Interval and Set Short Poll Interval
+ * commands, the new intervals are checked against each other and written to the attributes.
+ *
+ * @param[in] cmd_id   The command id, refer to esp_zb_zcl_poll_control_cmd_t
+ * @param[in] payload  The ZCL payload of the command
+ * @param[in] len      The length of @p payload
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_SUPPORTED if the command is not a poll control command
+ *         - ESP_ERR_INVALID_SIZE if the payload is malformed
+ *         - ESP_ERR_INVALID_ARG if the requested interval or timeout is out of range, to answer with an INVALID_VALUE status
+ *         - ESP_ERR_INVALID_STATE if the poller is not initialized
+ */
+esp_err_t esp_zb_poll_control_cmd_handle(uint8_t cmd_id, const uint8_t *payload, uint16_t len);
+
+/**
+ * @brief   Handle a write of a poll control attribute received by the poll control server.
+ *
+ * @note Call it before the value is written, an error rejects the write. The Check-in Interval is 0 or from the long
+ * poll interval to ESP_ZB_ZCL_POLL_CONTROL_INTERVAL_MAX_VALUE, the check-in period restarts from the write. The Fast Poll
+ * Timeout is not 0 and not above the Fast Poll Timeout Max when it is set. The accepted value is written to the
+ * attribute and applied to the poller.
+ *
+ * @param[in] attr_id  The attribute id, refer to esp_zb_zcl_poll_control_attr_t
+ * @param[in] value    The value of the attribute in the ZCL format, little endian
+ * @param[in] len      The length of @p value
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_SUPPORTED if the attribute is not a poll control attribute, to answer with an UNSUPPORTED_ATTRIBUTE status
+ *         - ESP_ERR_NOT_ALLOWED if the attribute is read only, to answer with a READ_ONLY status
+ *         - ESP_ERR_INVALID_SIZE if the value length does not match the attribute type
+ *         - ESP_ERR_INVALID_ARG if the value is out of range, to answer with an INVALID_VALUE status
+ *         - ESP_ERR_INVALID_STATE if the poller is not initialized
+ */
+esp_err_t esp_zb_poll_control_attr_write_handle(uint16_t attr_id, const uint8_t *value, uint16_t len);
+
+/**
+ * @brief   Get the statistics of the poller.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_poll_control_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ */
+esp_err_t esp_zb_poll_control_get_stats(esp_zb_poll_control_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ESP_ZB_PROFILER_ENTRY_MAX_NUM   32      /*!< Number of callbacks and signal types the profiler tracks */
+#define ESP_ZB_PROFILER_BUCKET_NUM      12      /*!< Number of buckets of a histogram, bucket i holds the times from 2^(i+4) to
+                                                     2^(i+5) microseconds, the first one also the shorter and the last one the longer */
+
+/**
+ * @brief The kind of code the profiler measures
+ * @anchor esp_zb_profiler_type_t
+ */
+typedef enum {
+    ESP_ZB_PROFILER_TYPE_CALLBACK   = 0x00,     /*!< An application callback, identified by its address */
+    ESP_ZB_PROFILER_TYPE_SIGNAL     = 0x01,     /*!< The application signal handler, identified by the signal type */
+    ESP_ZB_PROFILER_TYPE_ALARM      = 0x02,     /*!< An alarm callback, refer to esp_zb_alarm_start(), identified by its address */
+    ESP_ZB_PROFILER_TYPE_SUBMIT     = 0x03,     /*!< A submission callback, refer to esp_zb_submit(), identified by its address */
+    ESP_ZB_PROFILER_TYPE_LOOP       = 0x04,     /*!< A main loop iteration, identified by 0 */
+} esp_zb_profiler_type_t;
+
+/**
+ * @brief The profiler configuration.
+ *
+ */
+typedef struct esp_zb_profiler_cfg_s {
+    uint32_t stall_threshold;                       /*!< The time in microsecond from which a run is logged as a stall, 0 disables it */
+} esp_zb_profiler_cfg_t;
+
+/**
+ * @brief The runtime profile of a callback or a signal type.
+ *
+ */
+typedef struct esp_zb_profiler_entry_s {
+    esp_zb_profiler_type_t type;                    /*!< The kind of code measured */
+    uintptr_t id;                                   /*!< The address of the callback or the signal type */
+    uint32_t count;                                 /*!< The number of runs */
+    uint64_t total_time;                            /*!< The cumulative time in microsecond of the runs */
+    uint32_t max_time;                              /*!< The longest run in microsecond */
+    uint32_t histogram[ESP_ZB_PROFILER_BUCKET_NUM]; /*!< The number of runs per time bucket */
+} esp_zb_profiler_entry_t;
+
+/**
+ * @brief The profiler statistics.
+ *
+ */
+typedef struct esp_zb_profiler_stats_s {
+    bool running;                                   /*!< The profiler is started */
+    uint8_t entry_num;                              /*!< The number of entries tracked */
+    uint32_t drop_count;                            /*!< The number of runs not tracked because the entry table was full */
+    uint32_t stall_count;                           /*!< The number of runs longer than the stall threshold */
+    uint32_t lateness_count;                        /*!< The number of alarms whose lateness is recorded */
+    uint32_t lateness_max;                          /*!< The highest lateness in microsecond */
+    uint32_t lateness_histogram[ESP_ZB_PROFILER_BUCKET_NUM];  /*!< The number of alarms per lateness bucket */
+} esp_zb_profiler_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Start the profiler.
+ *
+ * @note The profiler is off by default and costs a single test per measured run while it is off. Once started, it
+ * measures the alarm callbacks (refer to esp_zb_alarm_start()) with their lateness, the submission callbacks (refer to
+ * esp_zb_submit()) and any code the application wraps with @ref esp_zb_profiler_begin and @ref esp_zb_profiler_end,
+ * typically its signal handler and its attribute and report callbacks.
+ * @warning The runs must be measured from the Zigbee task context.
+ *
+ * @param[in] cfg  Pointer to the profiler configuration @ref esp_zb_profiler_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p cfg is NULL
+ */
+esp_err_t esp_zb_profiler_start(const esp_zb_profiler_cfg_t *cfg);
+
+/**
+ * @brief   Stop the profiler, the profiles are kept.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_profiler_stop(void);
+
+/**
+ * @brief   Clear the profiles and the statistics.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_profiler_reset(void);
+
+/**
+ * @brief   Begin the measure of a run.
+ *
+ * @return The start time to give to @ref esp_zb_profiler_end, 0 if the profiler is not started
+ */
+int64_t esp_zb_profiler_begin(void);
+
+/**
+ * @brief   End the measure of a run and account it to a callback or a signal type.
+ *
+ * @note A run longer than the stall threshold is logged with its type and id.
+ *
+ * @param[in] type   The kind of code measured, refer to esp_zb_profiler_type_t
+ * @param[in] id     The address of the callback or the signal type
+ * @param[in] start  The start time returned by @ref esp_zb_profiler_begin, the run is ignored if it is 0
+ *
+ */
+void esp_zb_profiler_end(esp_zb_profiler_type_t type, uintptr_t id, int64_t start);
+
+/**
+ * @brief   Record the lateness of a scheduled callback, the time it runs minus the time it was scheduled for.
+ *
+ * @param[in] lateness  The lateness in microsecond
+ *
+ */
+void esp_zb_profiler_lateness_record(uint32_t lateness);
+
+/**
+ * @brief   Get the profiles, the longest cumulative time first.
+ *
+ * @param[out] entries    Array of the profiles @ref esp_zb_profiler_entry_s to fill
+ * @param[in]  max_num    The capacity of @p entries
+ * @param[out] entry_num  The number of profiles filled
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ */
+esp_err_t esp_zb_profiler_get_entries(esp_zb_profiler_entry_t *entries, uint8_t max_num, uint8_t *entry_num);
+
+/**
+ * @brief   Get the statistics of the profiler.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_profiler_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ */
+esp_err_t esp_zb_profiler_get_stats(esp_zb_profiler_stats_t *stats);
+
+/**
+ * @brief   Print the profiles and the lateness histogram to the console.
+ *
+ */
+void esp_zb_profiler_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "zcl/esp_zigbee_zcl_command.h"
+
+#define ESP_ZB_READ_ATTR_HANDLER_MAX_NUM    8       /*!< Maximum number of read attribute response handlers */
+
+/**
+ * @brief The origin of a read attribute response
+ *
+ */
+typedef struct esp_zb_read_attr_resp_info_s {
+    uint16_t src_addr;                              /*!< NWK address of the device the response comes from */
+    uint8_t src_endpoint;                           /*!< The endpoint the response comes from */
+    uint8_t dst_endpoint;                           /*!< The local endpoint the response is sent to */
+    uint16_t cluster_id;                            /*!< The cluster of the attributes */
+    uint8_t tsn;                                    /*!< The ZCL transaction sequence number, the one of the request */
+} esp_zb_read_attr_resp_info_t;
+
+/**
+ * @brief A handler run in the Zigbee task for each attribute record of a read attribute response.
+ *
+ * @param[in] info       The origin of the response @ref esp_zb_read_attr_resp_info_s
+ * @param[in] status     The status of the attribute record
+ * @param[in] attr_id    The attribute identifier
+ * @param[in] attr_type  The attribute type, valid if @p status is ESP_ZB_ZCL_STATUS_SUCCESS
+ * @param[in] value      The value in the frame, NULL if @p status is not ESP_ZB_ZCL_STATUS_SUCCESS, it may be unaligned
+ *                       and is valid only in the handler
+ *
+ */
+typedef void (*esp_zb_read_attr_resp_handler_t)(const esp_zb_read_attr_resp_info_t *info, esp_zb_zcl_status_t status,
+                                                uint16_t attr_id, esp_zb_zcl_attr_type_t attr_type, const void *value);
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Add a handler of the read attribute responses.
+ *
+ * @note The responses are parsed from the APS data indications, refer to esp_zigbee_af_indication.h, and every handler
+ * sees every response, so several modules and the application can read attributes from the same endpoint. Unlike
+ * @ref esp_zb_add_read_attr_resp_cb, the handlers are told the device and the transaction a response belongs to, and
+ * the read attribute response callback of the endpoint is left to the application.
+ * @warning It must be called from the Zigbee task context or before esp_zb_start().
+ *
+ * @param[in] handler  The handler
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p handler is NULL
+ *         - ESP_ERR_INVALID_STATE if @p handler is already added
+ *         - ESP_ERR_NO_MEM if there are ESP_ZB_READ_ATTR_HANDLER_MAX_NUM handlers already
+ */
+esp_err_t esp_zb_read_attr_handler_add(esp_zb_read_attr_resp_handler_t handler);
+
+/**
+ * @brief   Remove a handler of the read attribute responses, it may be called from a handler.
+ *
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in] handler  The handler given to esp_zb_read_attr_handler_add()
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if @p handler is not added
+ */
+esp_err_t esp_zb_read_attr_handler_remove(esp_zb_read_attr_resp_handler_t handler);
+
+/**
+ * @brief   Send a read attribute command and get its transaction sequence number.
+ *
+ * @note The response to the command carries the same sequence number in @ref esp_zb_read_attr_resp_info_s.
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in]  cmd_req  Pointer to the read attribute command @ref esp_zb_zcl_read_attr_cmd_s
+ * @param[out] tsn      The ZCL transaction sequence number of the command
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if an argument is NULL
+ */
+esp_err_t esp_zb_read_attr_send(esp_zb_zcl_read_attr_cmd_t *cmd_req, uint8_t *tsn);
+
+#ifdef __cplusplus
+}
+#endif
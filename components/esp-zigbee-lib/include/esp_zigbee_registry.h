@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_interview.h"
+
+#define ESP_ZB_REGISTRY_DEVICE_MAX_NUM          512     /*!< Maximum number of devices of the registry */
+#define ESP_ZB_REGISTRY_EP_MAX_NUM              4       /*!< Maximum number of endpoints recorded per device */
+#ifdef CONFIG_ZB_REGISTRY_CLUSTER_MAX_NUM
+#define ESP_ZB_REGISTRY_CLUSTER_MAX_NUM         CONFIG_ZB_REGISTRY_CLUSTER_MAX_NUM  /*!< Maximum number of clusters recorded per endpoint */
+#else
+#define ESP_ZB_REGISTRY_CLUSTER_MAX_NUM         16      /*!< Maximum number of clusters recorded per endpoint */
+#endif
+#define ESP_ZB_REGISTRY_FLUSH_PERIOD            600000  /*!< Time in millisecond between two writes of the last seen time and LQI to NVS */
+#define ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN      0xffff  /*!< The NWK address of a device which is not known */
+
+/**
+ * @brief The endpoint record of a registered device
+ *
+ */
+typedef struct esp_zb_registry_endpoint_s {
+    uint8_t endpoint;                               /*!< The endpoint id */
+    uint8_t input_cluster_count;                    /*!< The number of input clusters recorded */
+    uint8_t output_cluster_count;                   /*!< The number of output clusters recorded */
+    uint16_t profile_id;                            /*!< The application profile identifier */
+    uint16_t device_id;                             /*!< The application device identifier */
+    uint16_t cluster_list[ESP_ZB_REGISTRY_CLUSTER_MAX_NUM];    /*!< The input clusters followed by the output clusters */
+} esp_zb_registry_endpoint_t;
+
+/**
+ * @brief The record of a registered device
+ *
+ */
+typedef struct esp_zb_registry_device_s {
+    esp_zb_ieee_addr_t ieee_addr;                   /*!< IEEE address of the device, the key of the record */
+    uint16_t short_addr;                            /*!< NWK address of the device, ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN if not known */
+    uint16_t manufacturer_code;                     /*!< Manufacturer code from the node descriptor */
+    uint8_t capability;                             /*!< MAC capability of the device */
+    uint8_t power_source;                           /*!< The PowerSource attribute of the Basic cluster, 0xff if unknown */
+    uint8_t lqi;                                    /*!< The LQI of the last frame received from the device */
+    uint8_t ep_count;                               /*!< The number of endpoints recorded */
+    uint32_t last_seen;                             /*!< The UTCTime the device was last heard from, ESP_ZB_TIME_INVALID if unknown */
+    esp_zb_registry_endpoint_t ep[ESP_ZB_REGISTRY_EP_MAX_NUM];     /*!< The endpoints recorded */
+} esp_zb_registry_device_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the device registry and load the devices from NVS.
+ *
+ * @note The devices are kept in RAM with an index on the IEEE address and an index on the NWK address, so both
+ * lookups take constant time. Each change of a device is written to NVS at once, the last seen time and LQI are
+ * written every ESP_ZB_REGISTRY_FLUSH_PERIOD to spare the flash.
+ * @note The records in NVS written with another CONFIG_ZB_REGISTRY_CLUSTER_MAX_NUM are of another layout, they are
+ * dropped on load and the devices are registered again on their next announcement.
+ * @note NVS must be initialized before, refer to nvs_flash_init().
+ *
+ * @param[in] device_num  The number of devices supported, 1 to ESP_ZB_REGISTRY_DEVICE_MAX_NUM
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p device_num is invalid
+ *         - ESP_ERR_NO_MEM if there is no memory for the device table
+ *         - ESP_ERR_INVALID_STATE if the registry is already initialized
+ */
+esp_err_t esp_zb_registry_init(uint16_t device_num);
+
+/**
+ * @brief   Deinitialize the device registry, the devices are kept in NVS.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_registry_deinit(void);
+
+/**
+ * @brief   Add a device to the registry, or replace the record of the device with the same IEEE address.
+ *
+ * @param[in] device  Pointer to the device record @ref esp_zb_registry_device_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the record is invalid
+ *         - ESP_ERR_NO_MEM if the registry is full
+ *         - ESP_ERR_INVALID_STATE if the registry is not initialized
+ */
+esp_err_t esp_zb_registry_update(const esp_zb_registry_device_t *device);
+
+/**
+ * @brief   Add or update a device in the registry from the record of its interview.
+ *
+ * @note The endpoints and clusters which do not fit the registry record are dropped, the number of clusters recorded
+ * per endpoint is set by CONFIG_ZB_REGISTRY_CLUSTER_MAX_NUM.
+ *
+ * @param[in] device  Pointer to the interview record @ref esp_zb_interview_device_s
+ *
+ * @return Refer to @ref esp_zb_registry_update
+ */
+esp_err_t esp_zb_registry_update_from_interview(const esp_zb_interview_device_t *device);
+
+/**
+ * @brief   Remove a device from the registry.
+ *
+ * @param[in] ieee_addr  IEEE address of the device
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the device is not registered
+ *         - ESP_ERR_INVALID_STATE if the registry is not initialized
+ */
+esp_err_t esp_zb_registry_remove(const esp_zb_ieee_addr_t ieee_addr);
+
+/**
+ * @brief   Find a device by its IEEE address.
+ *
+ * @param[in] ieee_addr  IEEE address of the device
+ *
+ * @return The device record @ref esp_zb_registry_device_s, NULL if the device is not registered
+ */
+const esp_zb_registry_device_t *esp_zb_registry_find_by_ieee(const esp_zb_ieee_addr_t ieee_addr);
+
+/**
+ * @brief   Find a device by its NWK address.
+ *
+ * @param[in] short_addr  NWK address of the device
+ *
+ * @return The device record @ref esp_zb_registry_device_s, NULL if the device is not registered
+ */
+const esp_zb_registry_device_t *esp_zb_registry_find_by_short(uint16_t short_addr);
+
+/**
+ * @brief   Iterate over the registered devices.
+ *
+ * @param[in,out] iterator  Set to 0 to get the first device, it is moved to the next device on return
+ *
+ * @return The device record @ref esp_zb_registry_device_s, NULL if there is no more device
+ */
+const esp_zb_registry_device_t *esp_zb_registry_get_next(uint16_t *iterator);
+
+/**
+ * @brief   Record that a frame was received from a device.
+ *
+ * @note The last seen time is taken from the local clock, refer to @ref esp_zb_time_get_utc.
+ *
+ * @param[in] short_addr  NWK address of the device
+ * @param[in] lqi         The LQI of the frame
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the device is not registered
+ */
+esp_err_t esp_zb_registry_touch(uint16_t short_addr, uint8_t lqi);
+
+/**
+ * @brief   Write the pending last seen times and LQIs to NVS at once.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the registry is not initialized
+ *         - Others: NVS error
+ */
+esp_err_t esp_zb_registry_flush(void);
+
+/**
+ * @brief   Let the device registry handle an application signal.
+ *
+ * @note Call it from @ref esp_zb_app_signal_handler. A device announcement adds the device or updates its NWK
+ * address, a device update updates its NWK address, a leave without rejoin removes the device.
+ *
+ * @param[in] signal_s  Pointer to the application signal @ref esp_zb_app_signal_s
+ *
+ */
+void esp_zb_registry_signal_handle(esp_zb_app_signal_t *signal_s);
+
+#ifdef __cplusplus
+}
+#endif
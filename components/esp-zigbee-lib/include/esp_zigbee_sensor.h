@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "zcl/esp_zigbee_zcl_common.h"
+
+#define ESP_ZB_SENSOR_MAX_NUM               8       /*!< Maximum number of sensor pipelines that can be created */
+#define ESP_ZB_SENSOR_WINDOW_MAX_SIZE       16      /*!< Maximum size of the sample ring buffer of a sensor pipeline */
+#define ESP_ZB_SENSOR_EMA_ALPHA_DEFAULT     64      /*!< Default EMA smoothing factor, in units of 1/256 */
+
+/**
+ * @brief The sensor pipeline filter type
+ * @anchor esp_zb_sensor_filter_t
+ */
+typedef enum {
+    ESP_ZB_SENSOR_FILTER_NONE       = 0x00,     /*!< The latest raw sample is used as-is */
+    ESP_ZB_SENSOR_FILTER_EMA        = 0x01,     /*!< Exponential moving average of the samples */
+    ESP_ZB_SENSOR_FILTER_MEDIAN     = 0x02,     /*!< Median of the samples held in the ring buffer */
+} esp_zb_sensor_filter_t;
+
+/** Sensor sample callback
+ *
+ * @brief A callback for the sensor pipeline to acquire a new raw sample from the sensor driver.
+ *
+ * @note The callback is called from the Zigbee task context every sample period, it should not block.
+ *
+ * @param[out] value    The raw sample, already scaled into the unit of the target attribute, e.g. 0.01 degree Celsius for
+ *                      `ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID`
+ * @param[in] user_ctx  User information context, set in @ref esp_zb_sensor_cfg_s
+ *
+ * @return - ESP_OK if a sample is acquired, otherwise the sample is skipped
+ */
+typedef esp_err_t (*esp_zb_sensor_sample_callback_t)(int32_t *value, void *user_ctx);
+
+/**
+ * @brief The sensor pipeline configuration.
+ *
+ * @note The attribute must be a numeric attribute of the types U8, U16, U32, S8, S16 or S32.
+ *
+ */
+typedef struct esp_zb_sensor_cfg_s {
+    uint8_t endpoint;                               /*!< The endpoint of the attribute that is fed by the sensor */
+    uint16_t cluster_id;                            /*!< The server cluster id of the attribute, refer to esp_zb_zcl_cluster_id */
+    uint16_t attr_id;                               /*!< The attribute id */
+    esp_zb_zcl_attr_type_t attr_type;               /*!< The attribute data type, refer to esp_zb_zcl_attr_type_t */
+    uint32_t sample_period;                         /*!< The sample period in millisecond */
+    esp_zb_sensor_filter_t filter;                  /*!< The filter applied to the samples, refer to esp_zb_sensor_filter_t */
+    uint8_t window_size;                            /*!< The number of samples held in the ring buffer, 1 to ESP_ZB_SENSOR_WINDOW_MAX_SIZE */
+    uint8_t ema_alpha;                              /*!< The EMA smoothing factor in units of 1/256, 0 means ESP_ZB_SENSOR_EMA_ALPHA_DEFAULT */
+    uint32_t reportable_change;                     /*!< The minimum change of the filtered value that is written to the attribute */
+    esp_zb_sensor_sample_callback_t sample_cb;      /*!< The sample callback, NULL if the samples are pushed by @ref esp_zb_sensor_push_sample */
+    void *user_ctx;                                 /*!< User information context passed to the sample callback */
+} esp_zb_sensor_cfg_t;
+
+/**
+ * @brief The sensor pipeline statistics.
+ *
+ */
+typedef struct esp_zb_sensor_stats_s {
+    uint32_t sample_count;                          /*!< The number of samples fed into the pipeline */
+    uint32_t sample_fail_count;                     /*!< The number of samples the sample callback failed to acquire */
+    uint32_t attr_write_count;                      /*!< The number of attribute writes issued by the pipeline */
+    int32_t  filtered_value;                        /*!< The latest filtered value */
+    int32_t  written_value;                         /*!< The value last written to the attribute */
+} esp_zb_sensor_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Create a sensor pipeline.
+ *
+ * @note The pipeline samples the sensor every sample period, filters the samples and only writes the attribute
+ * when the filtered value moves by at least the reportable change since the last write, so the attribute report
+ * and its NVS traffic are only generated for meaningful changes.
+ * @note The pipeline is created in stopped state, refer to @ref esp_zb_sensor_start.
+ *
+ * @param[in]  cfg        Pointer to the sensor pipeline configuration @ref esp_zb_sensor_cfg_s
+ * @param[out] sensor_id  The identifier of the created sensor pipeline
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ *         - ESP_ERR_NO_MEM if all the sensor pipelines are in use
+ */
+esp_err_t esp_zb_sensor_create(const esp_zb_sensor_cfg_t *cfg, uint8_t *sensor_id);
+
+/**
+ * @brief   Delete a sensor pipeline.
+ *
+ * @param[in] sensor_id  The identifier of the sensor pipeline
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the sensor pipeline does not exist
+ */
+esp_err_t esp_zb_sensor_delete(uint8_t sensor_id);
+
+/**
+ * @brief   Start periodic sampling of a sensor pipeline.
+ *
+ * @note It has no effect on the pipeline that samples are pushed by @ref esp_zb_sensor_push_sample.
+ *
+ * @param[in] sensor_id  The identifier of the sensor pipeline
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the sensor pipeline does not exist
+ */
+esp_err_t esp_zb_sensor_start(uint8_t sensor_id);
+
+/**
+ * @brief   Stop periodic sampling of a sensor pipeline.
+ *
+ * @param[in] sensor_id  The identifier of the sensor pipeline
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the sensor pipeline does not exist
+ */
+esp_err_t esp_zb_sensor_stop(uint8_t sensor_id);
+
+/**
+ * @brief   Push a raw sample into a sensor pipeline.
+ *
+ * @note It is used by the sensor driver that produces samples by itself, e.g. from an interrupt-driven conversion.
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in] sensor_id  The identifier of the sensor pipeline
+ * @param[in] value      The raw sample, already scaled into the unit of the target attribute
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the sensor pipeline does not exist
+ */
+esp_err_t esp_zb_sensor_push_sample(uint8_t sensor_id, int32_t value);
+
+/**
+ * @brief   Get the statistics of a sensor pipeline.
+ *
+ * @param[in]  sensor_id  The identifier of the sensor pipeline
+ * @param[out] stats      Pointer to the statistics @ref esp_zb_sensor_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if the sensor pipeline does not exist
+ */
+esp_err_t esp_zb_sensor_get_stats(uint8_t sensor_id, esp_zb_sensor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
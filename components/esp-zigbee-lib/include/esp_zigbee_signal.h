@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+
+#define ESP_ZB_SIGNAL_TYPE_MAX_NUM          64      /*!< Signal types below this value can be subscribed to */
+#define ESP_ZB_SIGNAL_SUBSCRIBER_MAX_NUM    32      /*!< Maximum number of subscriptions, all signal types together */
+
+/**
+ * @brief A signal delivered to its subscribers.
+ *
+ */
+typedef struct esp_zb_signal_s {
+    esp_zb_app_signal_type_t type;                  /*!< The signal type */
+    esp_err_t status;                               /*!< The error status of the signal */
+    uint32_t *p_app_signal;                         /*!< The raw signal, refer to esp_zb_app_signal_get_params() */
+} esp_zb_signal_t;
+
+/**
+ * @brief A callback run in the Zigbee task when a subscribed signal is delivered.
+ *
+ * @param[in] signal  The signal @ref esp_zb_signal_s, its parameters are read with the typed accessors
+ * @param[in] ctx     The user context given on subscription
+ *
+ */
+typedef void (*esp_zb_signal_callback_t)(const esp_zb_signal_t *signal, void *ctx);
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Subscribe to a signal type.
+ *
+ * @note A signal type may have several subscribers, run in the order of their subscription, so independent modules
+ * each subscribe to the signals they need instead of sharing a single esp_zb_app_signal_handler().
+ * @note A subscription made from a subscriber callback gets the signals from the next dispatch on.
+ * @warning It must be called from the Zigbee task context or before esp_zb_start().
+ *
+ * @param[in] type  The signal type, below ESP_ZB_SIGNAL_TYPE_MAX_NUM
+ * @param[in] cb    The callback run on the signal
+ * @param[in] ctx   The user context passed to @p cb
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p type or @p cb is invalid
+ *         - ESP_ERR_NO_MEM if there are ESP_ZB_SIGNAL_SUBSCRIBER_MAX_NUM subscriptions already
+ */
+esp_err_t esp_zb_signal_subscribe(esp_zb_app_signal_type_t type, esp_zb_signal_callback_t cb, void *ctx);
+
+/**
+ * @brief   Unsubscribe from a signal type, it may be called from a subscriber callback.
+ *
+ * @param[in] type  The signal type
+ * @param[in] cb    The callback given on subscription
+ * @param[in] ctx   The user context given on subscription
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_NOT_FOUND if there is no such subscription
+ */
+esp_err_t esp_zb_signal_unsubscribe(esp_zb_app_signal_type_t type, esp_zb_signal_callback_t cb, void *ctx);
+
+/**
+ * @brief   Deliver a signal to its subscribers.
+ *
+ * @note It is to be called from esp_zb_app_signal_handler(), the subscribers of the signal type are found in a table
+ * indexed by the signal type.
+ *
+ * @param[in] signal_s  The signal given to esp_zb_app_signal_handler() @ref esp_zb_app_signal_s
+ *
+ * @return true if the signal has at least one subscriber, false otherwise
+ */
+bool esp_zb_signal_dispatch(const esp_zb_app_signal_t *signal_s);
+
+/**
+ * @brief   Get the parameters of an ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE signal.
+ *
+ * @param[in] signal  The signal
+ *
+ * @return The parameters @ref esp_zb_zdo_signal_device_annce_params_s, NULL if the signal is of another type
+ */
+esp_zb_zdo_signal_device_annce_params_t *esp_zb_signal_get_device_annce_params(const esp_zb_signal_t *signal);
+
+/**
+ * @brief   Get the parameters of an ESP_ZB_ZDO_SIGNAL_LEAVE signal.
+ *
+ * @param[in] signal  The signal
+ *
+ * @return The parameters @ref esp_zb_zdo_signal_leave_params_s, NULL if the signal is of another type
+ */
+esp_zb_zdo_signal_leave_params_t *esp_zb_signal_get_leave_params(const esp_zb_signal_t *signal);
+
+/**
+ * @brief   Get the parameters of an ESP_ZB_ZDO_SIGNAL_LEAVE_INDICATION signal.
+ *
+ * @param[in] signal  The signal
+ *
+ * @return The parameters @ref esp_zb_zdo_signal_leave_indication_params_s, NULL if the signal is of another type
+ */
+esp_zb_zdo_signal_leave_indication_params_t *esp_zb_signal_get_leave_indication_params(const esp_zb_signal_t *signal);
+
+/**
+ * @brief   Get the parameters of an ESP_ZB_COMMON_SIGNAL_CAN_SLEEP signal.
+ *
+ * @param[in] signal  The signal
+ *
+ * @return The parameters @ref esp_zb_zdo_signal_can_sleep_params_s, NULL if the signal is of another type
+ */
+esp_zb_zdo_signal_can_sleep_params_t *esp_zb_signal_get_can_sleep_params(const esp_zb_signal_t *signal);
+
+/**
+ * @brief   Get the parameters of an ESP_ZB_MACSPLIT_DEVICE_BOOT signal.
+ *
+ * @param[in] signal  The signal
+ *
+ * @return The parameters @ref esp_zb_zdo_signal_macsplit_dev_boot_params_s, NULL if the signal is of another type
+ */
+esp_zb_zdo_signal_macsplit_dev_boot_params_t *esp_zb_signal_get_macsplit_dev_boot_params(const esp_zb_signal_t *signal);
+
+/**
+ * @brief   Get the parameters of an ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE signal.
+ *
+ * @param[in] signal  The signal
+ *
+ * @return The parameters @ref esp_zb_zdo_signal_device_update_params_s, NULL if the signal is of another type
+ */
+esp_zb_zdo_signal_device_update_params_t *esp_zb_signal_get_device_update_params(const esp_zb_signal_t *signal);
+
+#ifdef __cplusplus
+}
+#endif
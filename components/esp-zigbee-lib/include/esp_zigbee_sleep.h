@@ -0,0 +1,129 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief The reason of a wake-up from light sleep
+ * @anchor esp_zb_sleep_wakeup_reason_t
+ */
+typedef enum {
+    ESP_ZB_SLEEP_WAKEUP_NONE        = 0x00,     /*!< The device did not sleep, the deadline was too close */
+    ESP_ZB_SLEEP_WAKEUP_TIMER       = 0x01,     /*!< The next stack deadline is reached */
+    ESP_ZB_SLEEP_WAKEUP_GPIO        = 0x02,     /*!< One of the wake-up GPIOs is at its wake-up level */
+    ESP_ZB_SLEEP_WAKEUP_UART        = 0x03,     /*!< The UART received data */
+    ESP_ZB_SLEEP_WAKEUP_OTHER       = 0x04,     /*!< Another wake-up source enabled by the application */
+    ESP_ZB_SLEEP_WAKEUP_MAX         = 0x05,     /*!< The number of wake-up reasons */
+} esp_zb_sleep_wakeup_reason_t;
+
+/**
+ * @brief The sleep configuration.
+ *
+ */
+typedef struct esp_zb_sleep_cfg_s {
+    uint32_t threshold;                             /*!< The shortest time in millisecond worth entering light sleep */
+    uint32_t guard_time;                            /*!< The time in millisecond to wake up before the deadline, to let the clocks and the radio settle */
+    uint64_t gpio_wakeup_mask;                      /*!< The bitmask of the GPIOs which wake up the device, 0 for none */
+    bool gpio_wakeup_high;                          /*!< The GPIOs wake up the device at high level, otherwise at low level */
+    bool trace;                                     /*!< Log a trace line per sleep, refer to tools/power_model */
+} esp_zb_sleep_cfg_t;
+
+/**
+ * @brief The sleep statistics.
+ *
+ */
+typedef struct esp_zb_sleep_stats_s {
+    uint32_t sleep_count;                           /*!< The number of light sleeps entered */
+    uint32_t skip_count;                            /*!< The number of light sleeps skipped because the deadline was too close */
+    uint64_t sleep_time;                            /*!< The cumulative time in microsecond spent in light sleep */
+    uint64_t awake_time;                            /*!< The cumulative time in microsecond spent awake since the initialization */
+    uint32_t wakeup_count[ESP_ZB_SLEEP_WAKEUP_MAX]; /*!< The number of wake-ups per reason, refer to esp_zb_sleep_wakeup_reason_t */
+} esp_zb_sleep_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the sleep helper and enable its wake-up sources.
+ *
+ * @note The light sleep wakes up on the timer of the next stack deadline and on the configured GPIOs. The 802.15.4 radio
+ * is not a light sleep wake-up source, a sleepy end device receives its pending data by polling its parent, whose
+ * deadline is part of the next stack deadline.
+ * @note With the FreeRTOS tickless idle and the automatic light sleep of the power management enabled, the idle task
+ * enters light sleep by itself and this helper is not needed, @ref esp_zb_sleep_get_next_deadline still tells how long
+ * the stack is idle.
+ *
+ * @param[in] cfg  Pointer to the sleep configuration @ref esp_zb_sleep_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ */
+esp_err_t esp_zb_sleep_init(const esp_zb_sleep_cfg_t *cfg);
+
+/**
+ * @brief   Deinitialize the sleep helper and disable its wake-up sources.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_sleep_deinit(void);
+
+/**
+ * @brief   Record the time the stack can sleep, given by the ESP_ZB_COMMON_SIGNAL_CAN_SLEEP signal.
+ *
+ * @note The time is the delay to the next scheduled alarm of the stack, which covers its timers, the next poll of the
+ * parent and the next attribute report, as well as the alarms of esp_zb_alarm_start() and esp_zb_scheduler_alarm().
+ *
+ * @param[in] sleep_tmo  The time in millisecond, refer to esp_zb_zdo_signal_can_sleep_params_s
+ *
+ */
+void esp_zb_sleep_deadline_update(uint32_t sleep_tmo);
+
+/**
+ * @brief   Get the time left before the next stack deadline.
+ *
+ * @param[out] time  The time in millisecond before the next deadline
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p time is NULL
+ *         - ESP_ERR_INVALID_STATE if the stack is busy, no ESP_ZB_COMMON_SIGNAL_CAN_SLEEP signal since the last wake-up
+ */
+esp_err_t esp_zb_sleep_get_next_deadline(uint32_t *time);
+
+/**
+ * @brief   Enter light sleep until the next stack deadline or a wake-up GPIO.
+ *
+ * @note It is typically called from the ESP_ZB_COMMON_SIGNAL_CAN_SLEEP signal handling, after
+ * @ref esp_zb_sleep_deadline_update. The sleep is skipped when the deadline is closer than the threshold and the
+ * guard time.
+ * @warning It must be called from the Zigbee task context of a sleepy end device, whose receiver is off when idle.
+ *
+ * @param[out] reason  The reason of the wake-up, optional
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the helper is not initialized or the stack is busy
+ *         - Otherwise the error of esp_light_sleep_start()
+ */
+esp_err_t esp_zb_sleep_light(esp_zb_sleep_wakeup_reason_t *reason);
+
+/**
+ * @brief   Get the statistics of the sleep helper.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_sleep_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ */
+esp_err_t esp_zb_sleep_get_stats(esp_zb_sleep_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
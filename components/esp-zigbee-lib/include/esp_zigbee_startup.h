@@ -0,0 +1,142 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+
+#define ESP_ZB_STARTUP_REJOIN_RETRY_MAX         3       /*!< Default number of rejoin retries on the stored channel before the failure is given to the application */
+#define ESP_ZB_STARTUP_REJOIN_BACKOFF           200     /*!< Default base time in millisecond between two rejoin attempts */
+
+/**
+ * @brief The startup phases, in the order they are normally reached
+ * @anchor esp_zb_startup_phase_t
+ */
+typedef enum {
+    ESP_ZB_STARTUP_PHASE_RADIO_INIT     = 0x00,     /*!< esp_zb_platform_config() returned, the radio or the RCP link is set up */
+    ESP_ZB_STARTUP_PHASE_STACK_INIT     = 0x01,     /*!< esp_zb_init() returned */
+    ESP_ZB_STARTUP_PHASE_START          = 0x02,     /*!< esp_zb_start() is called */
+    ESP_ZB_STARTUP_PHASE_NVS_LOADED     = 0x03,     /*!< esp_zb_start() returned, the network parameters are loaded from NVS */
+    ESP_ZB_STARTUP_PHASE_RCP_READY      = 0x04,     /*!< The RCP answered the handshake, ESP_ZB_MACSPLIT_DEVICE_BOOT signal */
+    ESP_ZB_STARTUP_PHASE_STACK_READY    = 0x05,     /*!< The stack is ready to rejoin, ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP signal */
+    ESP_ZB_STARTUP_PHASE_JOINED         = 0x06,     /*!< The device is on the network, rejoined after a reboot or newly joined */
+    ESP_ZB_STARTUP_PHASE_FIRST_POLL     = 0x07,     /*!< The end device polled its parent for the first time since it joined */
+    ESP_ZB_STARTUP_PHASE_FIRST_COMMAND  = 0x08,     /*!< The application handled its first command, refer to @ref esp_zb_startup_mark */
+    ESP_ZB_STARTUP_PHASE_MAX            = 0x09,     /*!< The number of phases */
+} esp_zb_startup_phase_t;
+
+/**
+ * @brief The startup record.
+ *
+ */
+typedef struct esp_zb_startup_record_s {
+    int64_t time[ESP_ZB_STARTUP_PHASE_MAX];         /*!< The time in microsecond since boot each phase was reached at, 0 if not reached */
+    bool fast_rejoin;                               /*!< The device rejoined with the network parameters stored by the fast rejoin */
+    uint8_t rejoin_count;                           /*!< The number of rejoin attempts */
+    uint8_t channel;                                /*!< The channel the device rejoined or joined on, 0 if not joined */
+} esp_zb_startup_record_t;
+
+/**
+ * @brief The startup configuration.
+ *
+ */
+typedef struct esp_zb_startup_cfg_s {
+    bool fast_rejoin;                               /*!< Rejoin on the stored channel at once and retry with a short backoff */
+    uint32_t channel_mask;                          /*!< The primary channel set of the device, restored once the rejoin is over */
+    uint8_t rejoin_retry_max;                       /*!< The number of rejoin retries before the failure is given to the application, 0 means
+                                                         ESP_ZB_STARTUP_REJOIN_RETRY_MAX */
+    uint16_t rejoin_backoff;                        /*!< The base time in millisecond between two rejoin attempts, 0 means
+                                                         ESP_ZB_STARTUP_REJOIN_BACKOFF */
+} esp_zb_startup_cfg_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Configure the startup of the device.
+ *
+ * @note The startup phases are traced from the boot whether this function is called or not. The calls to
+ * esp_zb_platform_config(), esp_zb_init() and esp_zb_start() are timed when CONFIG_ZB_STARTUP_TRACE_STACK_CALLS is
+ * enabled, which wraps them at link time, otherwise the application may mark them with @ref esp_zb_startup_mark. The
+ * other phases are traced by @ref esp_zb_startup_signal_handle.
+ *
+ * With @p fast_rejoin, the channel, PAN ID and NWK address of the network are stored in NVS each time the device joins
+ * a network. At the next boot the primary channel set is narrowed to the stored channel as soon as the stack is ready,
+ * so the rejoin started by the BDB initialization of the application looks for the parent there alone. A failed rejoin
+ * is retried after @p rejoin_backoff doubled at each retry, plus a random jitter of up to @p rejoin_backoff so devices
+ * powered up together do not retry together. The primary channel set is restored to @p channel_mask once the device
+ * rejoined or the retries are exhausted.
+ * @warning It must be called before esp_zb_start().
+ *
+ * @param[in] cfg  Pointer to the startup configuration @ref esp_zb_startup_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ */
+esp_err_t esp_zb_startup_config(const esp_zb_startup_cfg_t *cfg);
+
+/**
+ * @brief   Let the startup tracing and the fast rejoin handle an application signal.
+ *
+ * @note Call it first from @ref esp_zb_app_signal_handler. The signals are passed through to the application, which
+ * starts the BDB initialization on ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP as usual, except a failed
+ * ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT while the fast rejoin retries: the function then returns true and the application
+ * must not handle the signal itself. Once the retries are exhausted the failure is given to the application, the device
+ * is still commissioned and is to retry the rejoin later with the BDB initialization, not the network steering.
+ *
+ * @param[in] signal_s  Pointer to the application signal @ref esp_zb_app_signal_s
+ *
+ * @return true if the signal is taken over, false if the application is to handle it
+ */
+bool esp_zb_startup_signal_handle(esp_zb_app_signal_t *signal_s);
+
+/**
+ * @brief   Mark that a startup phase is reached, the phases reached already are left as they are.
+ *
+ * @note It is meant for ESP_ZB_STARTUP_PHASE_FIRST_COMMAND, marked by the application from its attribute or command
+ * callbacks, for ESP_ZB_STARTUP_PHASE_FIRST_POLL on the end devices which do not signal they can sleep, and for the
+ * phases of the stack calls when CONFIG_ZB_STARTUP_TRACE_STACK_CALLS is disabled.
+ *
+ * @param[in] phase  The phase, refer to esp_zb_startup_phase_t
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p phase is invalid
+ */
+esp_err_t esp_zb_startup_mark(esp_zb_startup_phase_t phase);
+
+/**
+ * @brief   Get the startup record.
+ *
+ * @param[out] record  Pointer to the startup record @ref esp_zb_startup_record_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p record is NULL
+ */
+esp_err_t esp_zb_startup_get_record(esp_zb_startup_record_t *record);
+
+/**
+ * @brief   Get the name of a startup phase.
+ *
+ * @param[in] phase  The phase, refer to esp_zb_startup_phase_t
+ *
+ * @return The name, "unknown" if @p phase is invalid
+ */
+const char *esp_zb_startup_phase_to_name(esp_zb_startup_phase_t phase);
+
+/**
+ * @brief   Print the startup record to the console.
+ *
+ */
+void esp_zb_startup_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
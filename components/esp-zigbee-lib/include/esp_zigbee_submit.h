@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+
+#define ESP_ZB_SUBMIT_DATA_MAX_SIZE     32      /*!< Maximum size in bytes of the data copied along with a submission */
+#define ESP_ZB_SUBMIT_QUEUE_MAX_SIZE    1024    /*!< Maximum number of submissions the queue can hold */
+#define ESP_ZB_SUBMIT_IDLE_WAIT_TIME    10      /*!< Time in millisecond the submission main loop waits for a submission between stack iterations */
+
+/**
+ * @brief A callback run in the Zigbee task for a submission.
+ *
+ * @param[in] data  The copy of the submitted data, or the submitted pointer itself if it was submitted with no length
+ *
+ */
+typedef void (*esp_zb_submit_callback_t)(void *data);
+
+/**
+ * @brief The submission queue statistics.
+ *
+ */
+typedef struct esp_zb_submit_stats_s {
+    uint32_t submit_count;                          /*!< The number of submissions queued */
+    uint32_t drop_count;                            /*!< The number of submissions rejected because the queue was full */
+    uint32_t run_count;                             /*!< The number of submissions run in the Zigbee task */
+    uint16_t size;                                  /*!< The number of submissions the queue can hold */
+} esp_zb_submit_stats_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Initialize the submission queue.
+ *
+ * @note The queue lets any task or ISR hand a piece of work, typically a ZCL or ZDO request, over to the Zigbee task,
+ * where the stack APIs are safe to call. Submitting never blocks nor takes a lock: the producers reserve a slot of a
+ * ring with an atomic compare and swap, the Zigbee task is the only consumer.
+ *
+ * @param[in] size  The number of submissions the queue can hold, rounded up to a power of two, up to ESP_ZB_SUBMIT_QUEUE_MAX_SIZE
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p size is invalid
+ *         - ESP_ERR_NO_MEM if there is no memory for the queue
+ *         - ESP_ERR_INVALID_STATE if the queue is already initialized
+ */
+esp_err_t esp_zb_submit_init(uint16_t size);
+
+/**
+ * @brief   Deinitialize the submission queue, the submissions not run yet are dropped.
+ *
+ * @warning It must be called from the Zigbee task context, with no producer left.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the queue is not initialized
+ */
+esp_err_t esp_zb_submit_deinit(void);
+
+/**
+ * @brief   Submit a callback to run in the Zigbee task.
+ *
+ * @note It can be called from any task or ISR, the errors are logged with the early log. The submission gives the
+ * wakeup of the queue, a semaphore of its own, so the Zigbee task waiting in @ref esp_zb_submit_wait runs it without
+ * waiting for the next stack event.
+ *
+ * @param[in] cb    The callback to run
+ * @param[in] data  The data passed to @p cb
+ * @param[in] len   The length of @p data copied into the queue, up to ESP_ZB_SUBMIT_DATA_MAX_SIZE, 0 to pass the
+ *                  @p data pointer as is
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if the queue is full
+ *         - ESP_ERR_INVALID_STATE if the queue is not initialized
+ */
+esp_err_t esp_zb_submit(esp_zb_submit_callback_t cb, const void *data, uint16_t len);
+
+/**
+ * @brief   Run the submissions queued so far.
+ *
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @return The number of submissions run
+ */
+uint16_t esp_zb_submit_process(void);
+
+/**
+ * @brief   Wait until a submission is queued.
+ *
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in] timeout  The time in millisecond to wait at most
+ *
+ * @return - ESP_OK if a submission was queued since the last wait
+ *         - ESP_ERR_TIMEOUT if none was queued within @p timeout
+ *         - ESP_ERR_INVALID_STATE if the queue is not initialized
+ */
+esp_err_t esp_zb_submit_wait(uint32_t timeout);
+
+/**
+ * @brief   Zigbee main loop running the submissions.
+ *
+ * @note Use it in place of @ref esp_zb_main_loop_iteration, it never returns. It runs the submissions queued before
+ * each iteration of the stack, then waits for a submission up to ESP_ZB_SUBMIT_IDLE_WAIT_TIME.
+ *
+ */
+void esp_zb_submit_main_loop_iteration(void);
+
+/**
+ * @brief   Get the statistics of the submission queue.
+ *
+ * @param[out] stats  Pointer to the statistics @ref esp_zb_submit_stats_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p stats is NULL
+ */
+esp_err_t esp_zb_submit_get_stats(esp_zb_submit_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+
+#define ESP_ZB_TIME_INVALID                 0xffffffff  /*!< Invalid UTCTime, as defined by ZCL */
+#define ESP_ZB_TIME_DRIFT_MIN_INTERVAL      600         /*!< Minimum interval in second between two syncs to estimate the clock drift */
+
+/**
+ * @brief The Time cluster TimeStatus attribute bits
+ * @anchor esp_zb_time_status_t
+ */
+typedef enum {
+    ESP_ZB_TIME_STATUS_MASTER               = 1 << 0,   /*!< The Time attribute is set from an external time source */
+    ESP_ZB_TIME_STATUS_SYNCHRONIZED         = 1 << 1,   /*!< The Time attribute is synchronized to a master clock over the network */
+    ESP_ZB_TIME_STATUS_MASTER_ZONE_DST      = 1 << 2,   /*!< The TimeZone, DstStart, DstEnd and DstShift attributes are set from an external source */
+    ESP_ZB_TIME_STATUS_SUPERSEDING          = 1 << 3,   /*!< The time server is considered as a more authoritative time source */
+} esp_zb_time_status_t;
+
+/**
+ * @brief The time zone and daylight saving time information.
+ *
+ */
+typedef struct esp_zb_time_zone_s {
+    int32_t time_zone;                              /*!< The offset in second of the local time zone from UTC */
+    uint32_t dst_start;                             /*!< The UTCTime when the daylight saving time starts, ESP_ZB_TIME_INVALID if not used */
+    uint32_t dst_end;                               /*!< The UTCTime when the daylight saving time ends, ESP_ZB_TIME_INVALID if not used */
+    int32_t dst_shift;                              /*!< The offset in second applied to the local time during the daylight saving time */
+} esp_zb_time_zone_t;
+
+/**
+ * @brief The time client sync configuration.
+ *
+ */
+typedef struct esp_zb_time_sync_cfg_s {
+    uint8_t src_endpoint;                           /*!< The local endpoint holding the time client cluster */
+    uint16_t dst_short_addr;                        /*!< The short address of the time server, normally 0x0000 for the coordinator */
+    uint8_t dst_endpoint;                           /*!< The endpoint of the time server */
+    uint32_t sync_period;                           /*!< The resync period in second, 0 to only sync once */
+} esp_zb_time_sync_cfg_t;
+
+/**
+ * @brief The local clock information.
+ *
+ */
+typedef struct esp_zb_time_info_s {
+    uint8_t time_status;                            /*!< The time status, refer to esp_zb_time_status_t */
+    uint32_t last_set_time;                         /*!< The UTCTime when the clock was last set */
+    int32_t drift_ppb;                              /*!< The estimated drift of the local oscillator in part per billion */
+    uint32_t sync_count;                            /*!< The number of successful syncs from the time server */
+    uint32_t sync_fail_count;                       /*!< The number of failed syncs from the time server */
+} esp_zb_time_info_t;
+
+/** Time sync callback
+ *
+ * @brief A callback for user to get notification when a time sync from the time server completes.
+ *
+ * @param[in] status  ESP_OK if the clock is synchronized, otherwise the sync failed
+ * @param[in] utc     The UTCTime after sync
+ */
+typedef void (*esp_zb_time_sync_callback_t)(esp_err_t status, uint32_t utc);
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Set the local clock from an external time source, e.g. SNTP or RTC.
+ *
+ * @note The local clock keeps the UTCTime as the number of seconds since 00:00:00 UTC 1 January 2000, on a
+ * monotonic base, so the time can be served without re-querying any time source.
+ *
+ * @param[in] utc   The UTCTime in second
+ * @param[in] zone  Pointer to the time zone information @ref esp_zb_time_zone_s, NULL to keep the current one
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p utc is ESP_ZB_TIME_INVALID
+ */
+esp_err_t esp_zb_time_set(uint32_t utc, const esp_zb_time_zone_t *zone);
+
+/**
+ * @brief   Get the UTCTime of the local clock.
+ *
+ * @param[out] utc  The UTCTime in second since 00:00:00 UTC 1 January 2000
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the local clock is not set or synchronized yet
+ */
+esp_err_t esp_zb_time_get_utc(uint32_t *utc);
+
+/**
+ * @brief   Get the local time of the local clock, with the time zone and daylight saving time applied.
+ *
+ * @param[out] local_time  The local time in second since 00:00:00 1 January 2000
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if the local clock is not set or synchronized yet
+ */
+esp_err_t esp_zb_time_get_local(uint32_t *local_time);
+
+/**
+ * @brief   Get the information of the local clock.
+ *
+ * @param[out] info  Pointer to the clock information @ref esp_zb_time_info_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p info is NULL
+ */
+esp_err_t esp_zb_time_get_info(esp_zb_time_info_t *info);
+
+/**
+ * @brief   Serve the local clock through the Time server cluster of an endpoint.
+ *
+ * @note The Time, TimeStatus, TimeZone, DstStart, DstEnd, DstShift, StandardTime and LocalTime attributes are
+ * refreshed from the local clock every @p update_period second, the Time server cluster must be registered
+ * on the endpoint, refer to @ref esp_zb_cluster_list_add_time_cluster.
+ *
+ * @param[in] endpoint       The endpoint holding the Time server cluster
+ * @param[in] update_period  The attribute refresh period in second, 0 is treated as 1
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_time_server_start(uint8_t endpoint, uint16_t update_period);
+
+/**
+ * @brief   Stop serving the local clock through the Time server cluster.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_time_server_stop(void);
+
+/**
+ * @brief   Synchronize the local clock from a time server over the air.
+ *
+ * @note The first sync sets the local clock, the following ones estimate the drift of the local oscillator,
+ * so the clock stays accurate between syncs and the resync period can be long.
+ * @note The responses are taken from the read attribute response handlers, refer to esp_zigbee_read_attr.h, only the
+ * response of the time server to the request in flight is used and the read attribute response callback of
+ * @p src_endpoint is left to the application.
+ *
+ * @param[in] cfg  Pointer to the sync configuration @ref esp_zb_time_sync_cfg_s
+ * @param[in] cb   The callback for the sync completion, optional
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ *         - ESP_ERR_NO_MEM if there are too many read attribute response handlers
+ */
+esp_err_t esp_zb_time_sync_start(const esp_zb_time_sync_cfg_t *cfg, esp_zb_time_sync_callback_t cb);
+
+/**
+ * @brief   Stop synchronizing the local clock from the time server, the local clock keeps running.
+ *
+ * @return - ESP_OK on success
+ */
+esp_err_t esp_zb_time_sync_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,184 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_zigbee_type.h"
+#include "zdo/esp_zigbee_zdo_command.h"
+
+#define ESP_ZB_TOPOLOGY_IN_FLIGHT_MAX_NUM       4       /*!< Maximum number of Mgmt_Lqi and Mgmt_Rtg requests in flight during a crawl */
+#define ESP_ZB_TOPOLOGY_RETRY_DELAY             100     /*!< Time in millisecond to wait before sending again when no request could be sent */
+
+/**
+ * @brief The topology node state
+ * @anchor esp_zb_topology_node_state_t
+ */
+typedef enum {
+    ESP_ZB_TOPOLOGY_NODE_PENDING    = 0x00,     /*!< The router is discovered, its tables are not read completely yet */
+    ESP_ZB_TOPOLOGY_NODE_QUERYING   = 0x01,     /*!< A Mgmt_Lqi or Mgmt_Rtg request is in flight to the router */
+    ESP_ZB_TOPOLOGY_NODE_DONE       = 0x02,     /*!< The tables of the router are read, or the node is an end device */
+    ESP_ZB_TOPOLOGY_NODE_FAILED     = 0x03,     /*!< The router did not answer after all the retries */
+} esp_zb_topology_node_state_t;
+
+/**
+ * @brief The topology node, a device of the network
+ *
+ */
+typedef struct esp_zb_topology_node_s {
+    esp_zb_ieee_addr_t ieee_addr;               /*!< IEEE address of the node, all zero if unknown */
+    uint16_t short_addr;                        /*!< NWK address of the node */
+    uint8_t device_type;                        /*!< Device type: 0x00 - coordinator, 0x01 - router, 0x02 - end device, 0x03 - unknown */
+    uint8_t depth;                              /*!< Tree depth of the node */
+    uint8_t state;                              /*!< The node state, refer to esp_zb_topology_node_state_t */
+    uint8_t next_index;                         /*!< The start index of the next neighbor table page to read */
+    uint8_t route_next_index;                   /*!< The start index of the next routing table page to read */
+    bool reading_routes;                        /*!< The neighbor table is read, the routing table is being read */
+    uint8_t retry;                              /*!< The number of retries of the current page */
+} esp_zb_topology_node_t;
+
+/**
+ * @brief The topology link, one entry of the neighbor table of a router
+ *
+ */
+typedef struct esp_zb_topology_link_s {
+    uint16_t from;                              /*!< The index in the node table of the router reporting the link */
+    uint16_t to;                                /*!< The index in the node table of the neighbor */
+    uint8_t lqi;                                /*!< The link quality of the link as seen by @p from */
+    uint8_t relationship;                       /*!< Relationship of @p to with @p from, refer to esp_zb_zdo_neighbor_table_record_s */
+} esp_zb_topology_link_t;
+
+/**
+ * @brief The topology route, one entry of the routing table of a router
+ *
+ */
+typedef struct esp_zb_topology_route_s {
+    uint16_t from;                              /*!< The index in the node table of the router reporting the route */
+    uint16_t dst_addr;                          /*!< NWK address of the destination of the route */
+    uint16_t next_hop_addr;                     /*!< NWK address of the next hop towards the destination */
+    uint8_t status;                             /*!< The route status, refer to esp_zb_zdo_routing_table_record_s */
+    bool many_to_one;                           /*!< The destination is a concentrator */
+} esp_zb_topology_route_t;
+
+/**
+ * @brief The topology crawl statistics
+ *
+ */
+typedef struct esp_zb_topology_stats_s {
+    uint32_t duration;                          /*!< The duration of the crawl in millisecond */
+    uint16_t node_count;                        /*!< The number of nodes discovered */
+    uint16_t link_count;                        /*!< The number of links discovered */
+    uint16_t route_count;                       /*!< The number of routes discovered */
+    uint16_t req_count;                         /*!< The number of Mgmt_Lqi and Mgmt_Rtg requests sent */
+    uint16_t fail_count;                        /*!< The number of routers which did not answer */
+    bool truncated;                             /*!< True if nodes, links or routes were dropped because the tables were full */
+} esp_zb_topology_stats_t;
+
+/**
+ * @brief A callback for user to get the result of the topology crawl
+ *
+ * @param[in] stats  The crawl statistics @ref esp_zb_topology_stats_s
+ *
+ */
+typedef void (*esp_zb_topology_done_callback_t)(const esp_zb_topology_stats_t *stats);
+
+/**
+ * @brief The topology crawl configuration.
+ *
+ */
+typedef struct esp_zb_topology_cfg_s {
+    uint16_t root_addr;                         /*!< The NWK address of the router to start from, usually the coordinator 0x0000 */
+    uint8_t max_in_flight;                      /*!< The maximum number of requests in flight, 1 to ESP_ZB_TOPOLOGY_IN_FLIGHT_MAX_NUM */
+    uint8_t max_retry;                          /*!< The number of retries of a page before the router is marked failed */
+    uint16_t node_capacity;                     /*!< The capacity of the node table */
+    uint16_t link_capacity;                     /*!< The capacity of the link table */
+    uint16_t route_capacity;                    /*!< The capacity of the route table, 0 not to read the routing tables */
+    esp_zb_topology_done_callback_t done_cb;    /*!< The callback called when the crawl is finished, optional */
+} esp_zb_topology_cfg_t;
+
+/********************* Declare functions **************************/
+
+/**
+ * @brief   Start crawling the network topology.
+ *
+ * @note The neighbor table of every router is read with Mgmt_Lqi requests, page by page, starting from the root. The
+ * routers found in the neighbor tables are queued in the order they are discovered, and up to @p max_in_flight routers
+ * are queried at the same time, so the crawl time grows with the depth of the network rather than its size.
+ * @note With a route capacity, the routing table of each router is read with Mgmt_Rtg requests once its neighbor
+ * table is read, which needs CONFIG_ZB_ZDO_MGMT_RTG. A router not supporting Mgmt_Rtg is not counted as failed.
+ * @note The result of the previous crawl is cleared.
+ *
+ * @param[in] cfg  Pointer to the topology crawl configuration @ref esp_zb_topology_cfg_s
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the configuration is invalid
+ *         - ESP_ERR_NO_MEM if there is no memory for the tables
+ *         - ESP_ERR_INVALID_STATE if a crawl is running
+ *         - ESP_ERR_NOT_SUPPORTED if a route capacity is given without CONFIG_ZB_ZDO_MGMT_RTG
+ */
+esp_err_t esp_zb_topology_crawl_start(const esp_zb_topology_cfg_t *cfg);
+
+/**
+ * @brief   Stop the running topology crawl, the nodes and links discovered so far are kept.
+ *
+ * @note The done callback is not called.
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_STATE if no crawl is running
+ */
+esp_err_t esp_zb_topology_crawl_stop(void);
+
+/**
+ * @brief   Get the node table of the last crawl.
+ *
+ * @note The table is valid until the next crawl is started or the result is cleared.
+ *
+ * @param[out] nodes     Pointer to the node table @ref esp_zb_topology_node_s
+ * @param[out] node_num  The number of nodes in the table
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ */
+esp_err_t esp_zb_topology_get_nodes(const esp_zb_topology_node_t **nodes, uint16_t *node_num);
+
+/**
+ * @brief   Get the link table of the last crawl.
+ *
+ * @note The table is valid until the next crawl is started or the result is cleared.
+ *
+ * @param[out] links     Pointer to the link table @ref esp_zb_topology_link_s
+ * @param[out] link_num  The number of links in the table
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ */
+esp_err_t esp_zb_topology_get_links(const esp_zb_topology_link_t **links, uint16_t *link_num);
+
+/**
+ * @brief   Get the route table of the last crawl.
+ *
+ * @note The table is valid until the next crawl is started or the result is cleared.
+ *
+ * @param[out] routes     Pointer to the route table @ref esp_zb_topology_route_s
+ * @param[out] route_num  The number of routes in the table
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ */
+esp_err_t esp_zb_topology_get_routes(const esp_zb_topology_route_t **routes, uint16_t *route_num);
+
+/**
+ * @brief   Stop the running crawl if any and free the node, link and route tables.
+ *
+ */
+void esp_zb_topology_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,6 +26,7 @@ extern "C" {
 #include "esp_zigbee_zcl_humidity_meas.h"
 #include "esp_zigbee_zcl_temperature_meas.h"
 #include "esp_zigbee_zcl_ota.h"
+#include "esp_zigbee_zcl_poll_control.h"
 
 /** HA profile ID*/
 #define ESP_ZB_AF_HA_PROFILE_ID       0x0104U
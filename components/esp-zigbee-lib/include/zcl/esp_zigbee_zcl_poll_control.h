@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_zigbee_type.h"
+
+/** @brief Poll Control cluster attribute identifiers
+*/
+typedef enum {
+    ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_ID         = 0x0000,  /*!< Check-in Interval attribute */
+    ESP_ZB_ZCL_ATTR_POLL_CONTROL_LONG_POLL_INTERVAL_ID        = 0x0001,  /*!< Long Poll Interval attribute */
+    ESP_ZB_ZCL_ATTR_POLL_CONTROL_SHORT_POLL_INTERVAL_ID       = 0x0002,  /*!< Short Poll Interval attribute */
+    ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_ID         = 0x0003,  /*!< Fast Poll Timeout attribute */
+    ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_MIN_ID     = 0x0004,  /*!< Check-in Interval Min attribute */
+    ESP_ZB_ZCL_ATTR_POLL_CONTROL_LONG_POLL_INTERVAL_MIN_ID    = 0x0005,  /*!< Long Poll Interval Min attribute */
+    ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_MAX_ID     = 0x0006   /*!< Fast Poll Timeout Max attribute */
+} esp_zb_zcl_poll_control_attr_t;
+
+/** @brief Default value for Check-in Interval attribute, in quarter seconds */
+#define ESP_ZB_ZCL_POLL_CONTROL_CHECK_IN_INTERVAL_DEFAULT_VALUE ((uint32_t)0x3840)
+
+/** @brief Default value for Long Poll Interval attribute, in quarter seconds */
+#define ESP_ZB_ZCL_POLL_CONTROL_LONG_POLL_INTERVAL_DEFAULT_VALUE ((uint32_t)0x14)
+
+/** @brief Default value for Short Poll Interval attribute, in quarter seconds */
+#define ESP_ZB_ZCL_POLL_CONTROL_SHORT_POLL_INTERVAL_DEFAULT_VALUE ((uint16_t)0x02)
+
+/** @brief Default value for Fast Poll Timeout attribute, in quarter seconds */
+#define ESP_ZB_ZCL_POLL_CONTROL_FAST_POLL_TIMEOUT_DEFAULT_VALUE ((uint16_t)0x28)
+
+/** @brief Default value for Check-in Interval Min attribute */
+#define ESP_ZB_ZCL_POLL_CONTROL_CHECK_IN_INTERVAL_MIN_DEFAULT_VALUE ((uint32_t)0x00)
+
+/** @brief Default value for Long Poll Interval Min attribute */
+#define ESP_ZB_ZCL_POLL_CONTROL_LONG_POLL_INTERVAL_MIN_DEFAULT_VALUE ((uint32_t)0x00)
+
+/** @brief Default value for Fast Poll Timeout Max attribute */
+#define ESP_ZB_ZCL_POLL_CONTROL_FAST_POLL_TIMEOUT_MAX_DEFAULT_VALUE ((uint16_t)0x00)
+
+/** @brief Maximum value for Check-in Interval and Long Poll Interval attributes */
+#define ESP_ZB_ZCL_POLL_CONTROL_INTERVAL_MAX_VALUE ((uint32_t)0x6e0000)
+
+/** @brief Poll Control cluster command identifiers for client
+*/
+typedef enum {
+    ESP_ZB_ZCL_CMD_POLL_CONTROL_CHECK_IN_RESPONSE_ID          = 0x00,    /*!< "Check-in Response" command */
+    ESP_ZB_ZCL_CMD_POLL_CONTROL_FAST_POLL_STOP_ID             = 0x01,    /*!< "Fast Poll Stop" command */
+    ESP_ZB_ZCL_CMD_POLL_CONTROL_SET_LONG_POLL_INTERVAL_ID     = 0x02,    /*!< "Set Long Poll Interval" command */
+    ESP_ZB_ZCL_CMD_POLL_CONTROL_SET_SHORT_POLL_INTERVAL_ID    = 0x03,    /*!< "Set Short Poll Interval" command */
+} esp_zb_zcl_poll_control_cmd_t;
+
+/** @brief Poll Control cluster command identifiers for server
+*/
+typedef enum {
+    ESP_ZB_ZCL_CMD_POLL_CONTROL_CHECK_IN_ID                   = 0x00,    /*!< "Check-in" command */
+} esp_zb_zcl_poll_control_resp_cmd_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,6 +8,7 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+#include "esp_err.h"
 #include "esp_zigbee_type.h"
 #include "esp_zigbee_zdo_common.h"
 
@@ -23,6 +24,24 @@ extern "C" {
 #define ESP_ZB_PERMIT_JOIN_REQ_TIMEOUT              (5 * ESP_ZB_TIME_ONE_SECOND)            /* timeout for permit join */
 #define ESP_ZB_DEVICE_LEAVE_REQ_TIMEOUT             (5 * ESP_ZB_TIME_ONE_SECOND)            /* timeout for device leave */
 
+/* MATCH CLUSTER REQ configuration */
+#define ESP_ZB_ZDO_MATCH_CLUSTER_WINDOW             3000                                    /* default time in millisecond to collect the responses */
+#define ESP_ZB_ZDO_MATCH_CLUSTER_MAX_NUM            16                                      /* maximum number of clusters of a request */
+#define ESP_ZB_ZDO_MATCH_CLUSTER_RESULT_MAX_NUM     64                                      /* maximum number of matching endpoints collected per request */
+
+/* BIND BATCH configuration */
+#define ESP_ZB_ZDO_BIND_BATCH_MAX_NUM               256                                     /* maximum number of entries of a bind batch */
+#define ESP_ZB_ZDO_BIND_BATCH_CONCURRENCY_MAX_NUM   4                                       /* maximum number of bind requests in flight of a batch */
+#define ESP_ZB_ZDO_BIND_BATCH_TIMEOUT               10000                                   /* time in millisecond after which an unanswered entry of a batch is completed with TIMEOUT */
+
+/* Mgmt_NWK_Update */
+#define ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_NUM           16                                      /* number of channels of the 2.4 GHz page, 11 to 26 */
+#define ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_MASK          0x07fff800UL                            /* bit mask of the channels of the 2.4 GHz page */
+#define ESP_ZB_ZDO_NWK_UPDATE_SCAN_DURATION_MAX     5                                       /* maximum exponent of the energy scan duration */
+
+/* Mgmt_Rtg */
+#define ESP_ZB_ZDO_MGMT_RTG_TIMEOUT                 5000                                    /* time in millisecond to wait for the Mgmt_Rtg response */
+
 /** Find device callback
  *
  * @brief A ZDO match desc request callback for user to get response info.
@@ -37,6 +56,30 @@ extern "C" {
  */
 typedef void (*esp_zb_zdo_match_desc_callback_t)(esp_zb_zdp_status_t zdo_status, uint16_t addr, uint8_t endpoint, void *user_ctx);
 
+/**
+ * @brief The Zigbee ZDO match cluster result, one matching endpoint of a responding device
+ *
+ */
+typedef struct esp_zb_zdo_match_cluster_result_s {
+    uint16_t short_addr;                                /*!< NWK address of the responding device */
+    uint8_t endpoint;                                   /*!< The matching endpoint of the responding device */
+} esp_zb_zdo_match_cluster_result_t;
+
+/** Match cluster request callback
+ *
+ * @brief A ZDO match cluster request callback for user to get all the matching endpoints at once.
+ *
+ * @note It is called once, when the collection window of the request ends, or at the first response of a unicast request.
+ *
+ * @param[in] zdo_status  ESP_ZB_ZDP_STATUS_SUCCESS if any device responded, ESP_ZB_ZDP_STATUS_TIMEOUT otherwise
+ * @param[in] results     The matching endpoints @ref esp_zb_zdo_match_cluster_result_s, valid only in the callback
+ * @param[in] result_num  The number of the matching endpoints
+ * @param[in] user_ctx    User information context, set in `esp_zb_zdo_match_cluster_req()`
+ *
+ */
+typedef void (*esp_zb_zdo_match_cluster_callback_t)(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_match_cluster_result_t *results,
+                                                    uint16_t result_num, void *user_ctx);
+
 /** IEEE address request callback
  *
  * @brief A ZDO ieee address request callback for user to get response info.
@@ -127,14 +170,171 @@ typedef void (*esp_zb_zdo_permit_join_callback_t)(esp_zb_zdp_status_t zdo_status
  */
 typedef void (*esp_zb_zdo_leave_callback_t)(esp_zb_zdp_status_t zdo_status, void *user_ctx);
 
+/**
+ * @brief The Zigbee ZDO neighbor table record of the Mgmt_Lqi response
+ *
+ */
+typedef struct esp_zb_zdo_neighbor_table_record_s {
+    esp_zb_ieee_addr_t ext_pan_id;                      /*!< Extended PAN ID of the neighbor */
+    esp_zb_ieee_addr_t ieee_addr;                       /*!< IEEE address of the neighbor */
+    uint16_t short_addr;                                /*!< NWK address of the neighbor */
+    uint8_t device_type;                                /*!< Device type of the neighbor: 0x00 - coordinator, 0x01 - router, 0x02 - end device, 0x03 - unknown */
+    uint8_t rx_on_when_idle;                            /*!< Receiver on when idle: 0x00 - off, 0x01 - on, 0x02 - unknown */
+    uint8_t relationship;                               /*!< Relationship: 0x00 - parent, 0x01 - child, 0x02 - sibling, 0x03 - none, 0x04 - previous child */
+    uint8_t permit_join;                                /*!< Permit joining: 0x00 - not accepting, 0x01 - accepting, 0x02 - unknown */
+    uint8_t depth;                                      /*!< Tree depth of the neighbor */
+    uint8_t lqi;                                        /*!< Link quality of the link to the neighbor */
+} esp_zb_zdo_neighbor_table_record_t;
+
+/**
+ * @brief The Zigbee ZDO Mgmt_Lqi response
+ *
+ */
+typedef struct esp_zb_zdo_mgmt_lqi_rsp_s {
+    uint16_t src_addr;                                  /*!< NWK address of the device the request was sent to */
+    uint8_t neighbor_table_entries;                     /*!< Total number of entries in the neighbor table of the remote device */
+    uint8_t start_index;                                /*!< Starting index of the neighbor table records of this response */
+    uint8_t neighbor_table_list_count;                  /*!< Number of the neighbor table records of this response */
+    esp_zb_zdo_neighbor_table_record_t *neighbor_table_list;    /*!< The neighbor table records of this response */
+} esp_zb_zdo_mgmt_lqi_rsp_t;
+
+/** Mgmt_Lqi request callback
+ *
+ * @brief A ZDO Mgmt_Lqi request callback for user to get the neighbor table of a remote device.
+ *
+ * @note The neighbor table is returned in pages, request the next page with the start index moved forward by
+ * `neighbor_table_list_count` until `neighbor_table_entries` records are received.
+ *
+ * @param[in] zdo_status The ZDO response status, refer to `esp_zb_zdp_status`
+ * @param[in] rsp        The Mgmt_Lqi response, valid only in the callback, NULL if the request failed
+ * @param[in] user_ctx   User information context, set in `esp_zb_zdo_mgmt_lqi_req()`
+ *
+ */
+typedef void (*esp_zb_zdo_mgmt_lqi_callback_t)(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_lqi_rsp_t *rsp, void *user_ctx);
+
+/**
+ * @brief The Zigbee ZDO routing table record of the Mgmt_Rtg response
+ *
+ */
+typedef struct esp_zb_zdo_routing_table_record_s {
+    uint16_t dst_addr;                                  /*!< NWK address of the destination of the route */
+    uint8_t status;                                     /*!< Route status: 0x00 - active, 0x01 - discovery underway, 0x02 - discovery failed, 0x03 - inactive, 0x04 - validation underway */
+    bool memory_constrained;                            /*!< The device is memory constrained */
+    bool many_to_one;                                   /*!< The destination is a concentrator which issued a many-to-one route request */
+    bool route_record_required;                         /*!< A route record command frame should be sent to the destination prior to the next data packet */
+    uint16_t next_hop_addr;                             /*!< NWK address of the next hop towards the destination */
+} esp_zb_zdo_routing_table_record_t;
+
+/**
+ * @brief The Zigbee ZDO Mgmt_Rtg response
+ *
+ */
+typedef struct esp_zb_zdo_mgmt_rtg_rsp_s {
+    uint16_t src_addr;                                  /*!< NWK address of the device the request was sent to */
+    uint8_t routing_table_entries;                      /*!< Total number of entries in the routing table of the remote device */
+    uint8_t start_index;                                /*!< Starting index of the routing table records of this response */
+    uint8_t routing_table_list_count;                   /*!< Number of the routing table records of this response */
+    esp_zb_zdo_routing_table_record_t *routing_table_list;      /*!< The routing table records of this response */
+} esp_zb_zdo_mgmt_rtg_rsp_t;
+
+/** Mgmt_Rtg request callback
+ *
+ * @brief A ZDO Mgmt_Rtg request callback for user to get the routing table of a remote device.
+ *
+ * @note The routing table is returned in pages, request the next page with the start index moved forward by
+ * `routing_table_list_count` until `routing_table_entries` records are received.
+ *
+ * @param[in] zdo_status The ZDO response status, refer to `esp_zb_zdp_status`, ESP_ZB_ZDP_STATUS_TIMEOUT if no response came
+ * @param[in] rsp        The Mgmt_Rtg response, valid only in the callback, NULL if the request failed
+ * @param[in] user_ctx   User information context, set in `esp_zb_zdo_mgmt_rtg_req()`
+ *
+ */
+typedef void (*esp_zb_zdo_mgmt_rtg_callback_t)(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_rtg_rsp_t *rsp, void *user_ctx);
+
+/**
+ * @brief The Zigbee ZDO binding table record of the Mgmt_Bind response
+ *
+ */
+typedef struct esp_zb_zdo_binding_table_record_s {
+    esp_zb_ieee_addr_t src_address;                     /*!< The IEEE address of the source of the binding entry */
+    uint8_t src_endp;                                   /*!< The source endpoint of the binding entry */
+    uint16_t cluster_id;                                /*!< The identifier of the cluster of the binding entry */
+    uint8_t dst_addr_mode;                              /*!< The destination address mode refer to esp_zb_zdo_bind_dst_addr_mode_t */
+    esp_zb_addr_u dst_address;                          /*!< The group address or the IEEE address of the destination */
+    uint8_t dst_endp;                                   /*!< The destination endpoint, only valid for the 64 bit extended address mode */
+} esp_zb_zdo_binding_table_record_t;
+
+/**
+ * @brief The Zigbee ZDO Mgmt_Bind response
+ *
+ */
+typedef struct esp_zb_zdo_mgmt_bind_rsp_s {
+    uint16_t src_addr;                                  /*!< NWK address of the device the request was sent to */
+    uint8_t binding_table_entries;                      /*!< Total number of entries in the binding table of the remote device */
+    uint8_t start_index;                                /*!< Starting index of the binding table records of this response */
+    uint8_t binding_table_list_count;                   /*!< Number of the binding table records of this response */
+    esp_zb_zdo_binding_table_record_t *binding_table_list;      /*!< The binding table records of this response */
+} esp_zb_zdo_mgmt_bind_rsp_t;
+
+/** Mgmt_Bind request callback
+ *
+ * @brief A ZDO Mgmt_Bind request callback for user to get the binding table of a remote device.
+ *
+ * @note The binding table is returned in pages, request the next page with the start index moved forward by
+ * `binding_table_list_count` until `binding_table_entries` records are received.
+ *
+ * @param[in] zdo_status The ZDO response status, refer to `esp_zb_zdp_status`
+ * @param[in] rsp        The Mgmt_Bind response, valid only in the callback, NULL if the request failed
+ * @param[in] user_ctx   User information context, set in `esp_zb_zdo_mgmt_bind_req()`
+ *
+ */
+typedef void (*esp_zb_zdo_mgmt_bind_callback_t)(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_bind_rsp_t *rsp, void *user_ctx);
+
+/**
+ * @brief The Zigbee ZDO Mgmt_NWK_Update_notify of an energy scan
+ *
+ */
+typedef struct esp_zb_zdo_mgmt_nwk_update_rsp_s {
+    uint16_t src_addr;                                  /*!< NWK address of the device the request was sent to */
+    uint32_t scanned_channels;                          /*!< The bit mask of the channels scanned */
+    uint16_t total_transmissions;                       /*!< Total number of transmissions reported by the MAC layer of the remote device */
+    uint16_t transmission_failures;                     /*!< Number of failed transmissions reported by the MAC layer of the remote device */
+    uint8_t energy_list_count;                          /*!< Number of the energy values of this response */
+    uint8_t energy_list[ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_NUM];    /*!< The energy measured on each scanned channel, in ascending channel order, 0xff is the highest */
+} esp_zb_zdo_mgmt_nwk_update_rsp_t;
+
+/** Energy scan request callback
+ *
+ * @brief A ZDO energy scan request callback for user to get the channel energy and the transmission counters of a device.
+ *
+ * @param[in] zdo_status The ZDO response status, refer to `esp_zb_zdp_status`
+ * @param[in] rsp        The Mgmt_NWK_Update_notify, valid only in the callback, NULL if the request failed
+ * @param[in] user_ctx   User information context, set in `esp_zb_zdo_energy_scan_req()`
+ *
+ */
+typedef void (*esp_zb_zdo_energy_scan_callback_t)(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_nwk_update_rsp_t *rsp,
+                                                  void *user_ctx);
+
+/** Bind batch callback
+ *
+ * @brief A ZDO bind batch callback for user to get the status of every entry of the batch.
+ *
+ * @param[in] status_list The ZDO response status of each entry, in the order of the entries, refer to `esp_zb_zdp_status`
+ * @param[in] entry_num   The number of entries of the batch
+ * @param[in] user_ctx    User information context, set in `esp_zb_zdo_bind_batch_req()`
+ *
+ */
+typedef void (*esp_zb_zdo_bind_batch_callback_t)(const esp_zb_zdp_status_t *status_list, uint16_t entry_num, void *user_ctx);
+
 /**
  * @brief The Zigbee ZDO bind command struct
  *
- * @note Current implementation of the API ONLY supports 64 bit extended address's address mode. Other address mode will support later.
+ * @note `esp_zb_zdo_device_bind_req()` ONLY supports 64 bit extended address's address mode, the 16 bit group address mode is
+ * supported by `esp_zb_zdo_device_group_bind_req()`, `esp_zb_zdo_device_unbind_req()` and `esp_zb_zdo_bind_batch_req()`.
  *
  * @note Be aware of the one req_dst_addr is address that command send to, while dst_address is the destination of the binding entry.
  *
- * @note NOW the dst_addr_mode is default by ZB_BIND_DST_ADDR_MODE_64_BIT_EXTENDED. Later SDK will support other address mode.
+ * @note NOW the dst_addr_mode is default by ZB_BIND_DST_ADDR_MODE_64_BIT_EXTENDED for `esp_zb_zdo_device_bind_req()`.
  *
  */
 typedef struct esp_zb_zdo_bind_req_param_s {
@@ -159,6 +359,20 @@ typedef struct esp_zb_zdo_match_desc_req_param_s {
     uint16_t   addr_of_interest;                        /*!< NWK address of interest */
 } esp_zb_zdo_match_desc_req_param_t;
 
+/**
+ * @brief The Zigbee ZDO match cluster command struct, a match descriptor request for any profile and cluster set
+ *
+ */
+typedef struct esp_zb_zdo_match_cluster_req_param_s {
+    uint16_t   dst_nwk_addr;                            /*!< NWK address that request sent to, a broadcast address reaches the whole network */
+    uint16_t   addr_of_interest;                        /*!< NWK address of interest, a broadcast address matches every device */
+    uint16_t   profile_id;                              /*!< Profile ID to be match at the destination which refers to esp_zb_af_profile_id_t */
+    uint8_t    num_in_clusters;                         /*!< The number of input clusters provided for matching cluster server */
+    uint8_t    num_out_clusters;                        /*!< The number of output clusters provided for matching cluster client */
+    uint16_t   *cluster_list;                           /*!< The input clusters followed by the output clusters */
+    uint16_t   collect_window;                          /*!< Time in millisecond to collect the responses, 0 means ESP_ZB_ZDO_MATCH_CLUSTER_WINDOW */
+} esp_zb_zdo_match_cluster_req_param_t;
+
 /**
  * @brief The Zigbee ZDO ieee request command struct
  *
@@ -220,6 +434,53 @@ typedef struct esp_zb_zdo_mgmt_leave_req_param_s {
     unsigned int rejoin: 1;                             /*!< Bitfield of rejoin or not */
 } esp_zb_zdo_mgmt_leave_req_param_t;
 
+/**
+ * @brief The Zigbee ZDO Mgmt_Lqi command struct
+ *
+ */
+typedef struct esp_zb_zdo_mgmt_lqi_req_param_s {
+    uint16_t   dst_nwk_addr;                            /*!< NWK address that request sent to */
+    uint8_t    start_index;                             /*!< Starting index of the requested neighbor table records */
+} esp_zb_zdo_mgmt_lqi_req_param_t;
+
+/**
+ * @brief The Zigbee ZDO Mgmt_Rtg command struct
+ *
+ */
+typedef struct esp_zb_zdo_mgmt_rtg_req_param_s {
+    uint16_t   dst_nwk_addr;                            /*!< NWK address that request sent to */
+    uint8_t    start_index;                             /*!< Starting index of the requested routing table records */
+} esp_zb_zdo_mgmt_rtg_req_param_t;
+
+/**
+ * @brief The Zigbee ZDO Mgmt_Bind command struct
+ *
+ */
+typedef struct esp_zb_zdo_mgmt_bind_req_param_s {
+    uint16_t   dst_nwk_addr;                            /*!< NWK address that request sent to */
+    uint8_t    start_index;                             /*!< Starting index of the requested binding table records */
+} esp_zb_zdo_mgmt_bind_req_param_t;
+
+/**
+ * @brief The Zigbee ZDO energy scan command struct
+ *
+ */
+typedef struct esp_zb_zdo_energy_scan_req_param_s {
+    uint16_t   dst_nwk_addr;                            /*!< NWK address that request sent to, the device itself is allowed */
+    uint32_t   scan_channels;                           /*!< The bit mask of the channels to scan, from 0x00000800 to 0x07FFF800 */
+    uint8_t    scan_duration;                           /*!< The scan duration exponent on each channel, 0 to ESP_ZB_ZDO_NWK_UPDATE_SCAN_DURATION_MAX */
+    uint8_t    scan_count;                              /*!< The number of scans on each channel, 1 to 5 */
+} esp_zb_zdo_energy_scan_req_param_t;
+
+/**
+ * @brief The Zigbee ZDO bind batch entry
+ *
+ */
+typedef struct esp_zb_zdo_bind_batch_entry_s {
+    esp_zb_zdo_bind_req_param_t bind_req;               /*!< The bind request, refer to esp_zb_zdo_bind_req_param_s */
+    bool unbind;                                        /*!< True to remove the binding entry instead of creating it */
+} esp_zb_zdo_bind_batch_entry_t;
+
 /********************* Declare functions **************************/
 /* ZDO command list, more ZDO command will be supported later like node_desc, power_desc */
 
@@ -253,6 +514,24 @@ void esp_zb_zdo_find_on_off_light(esp_zb_zdo_match_desc_req_param_t *cmd_req, es
  */
 void esp_zb_zdo_find_color_dimmable_light(esp_zb_zdo_match_desc_req_param_t *cmd_req, esp_zb_zdo_match_desc_callback_t user_cb, void *user_ctx);
 
+/**
+ * @brief   Send match descriptor request command for any profile and cluster set
+ *
+ * @note The responses are collected during the collection window and returned in one callback, so a single broadcast
+ * finds every device of the network implementing the clusters, e.g. all the temperature sensors or all the IAS zones.
+ * A device matches if any of its clusters matches.
+ *
+ * @param[in] cmd_req  Pointer to the match cluster request command @ref esp_zb_zdo_match_cluster_req_param_s
+ * @param[in] user_cb  A user callback that will be called with all the responses refer to esp_zb_zdo_match_cluster_callback_t
+ * @param[in] user_ctx A void pointer that contains the user defines additional information when callback trigger
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid or the cluster list exceeds ESP_ZB_ZDO_MATCH_CLUSTER_MAX_NUM
+ *         - ESP_ERR_NO_MEM if there is no buffer or request slot for the request
+ */
+esp_err_t esp_zb_zdo_match_cluster_req(esp_zb_zdo_match_cluster_req_param_t *cmd_req, esp_zb_zdo_match_cluster_callback_t user_cb,
+                                       void *user_ctx);
+
 /**
  * @brief   Send ieee request command
  *
@@ -313,6 +592,137 @@ void esp_zb_zdo_device_leave_req(esp_zb_zdo_mgmt_leave_req_param_t *cmd_req, esp
  */
 void esp_zb_zdo_permit_joining_req(esp_zb_zdo_permit_joining_req_param_t *cmd_req, esp_zb_zdo_permit_join_callback_t user_cb, void *user_ctx);
 
+/**
+ * @brief   Send Mgmt_Lqi request command to get a page of the neighbor table of a remote router or coordinator
+ *
+ *
+ * @param[in] cmd_req  Pointer to the Mgmt_Lqi request command @ref esp_zb_zdo_mgmt_lqi_req_param_s
+ * @param[in] user_cb  A user callback that will be called if received Mgmt_Lqi response refer to esp_zb_zdo_mgmt_lqi_callback_t
+ * @param[in] user_ctx A void pointer that contains the user defines additional information when callback trigger
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if there is no buffer or request slot for the request
+ */
+esp_err_t esp_zb_zdo_mgmt_lqi_req(esp_zb_zdo_mgmt_lqi_req_param_t *cmd_req, esp_zb_zdo_mgmt_lqi_callback_t user_cb, void *user_ctx);
+
+/**
+ * @brief   Send Mgmt_Rtg request command to get a page of the routing table of a remote router or coordinator
+ *
+ * @note The Zigbee stack has no routing table request, so with CONFIG_ZB_ZDO_MGMT_RTG the request is sent as a ZDP
+ * frame over APS, with a transaction sequence number of its own, and the response is taken from the APS data
+ * indications, refer to esp_zb_af_indication_handler_add(). The callback is called with ESP_ZB_ZDP_STATUS_TIMEOUT if no
+ * response is received within ESP_ZB_ZDO_MGMT_RTG_TIMEOUT.
+ * @warning It must be called from the Zigbee task context.
+ *
+ * @param[in] cmd_req  Pointer to the Mgmt_Rtg request command @ref esp_zb_zdo_mgmt_rtg_req_param_s
+ * @param[in] user_cb  A user callback that will be called if received Mgmt_Rtg response refer to esp_zb_zdo_mgmt_rtg_callback_t
+ * @param[in] user_ctx A void pointer that contains the user defines additional information when callback trigger
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if there is no buffer, request slot or data indication handler for the request
+ *         - ESP_ERR_NOT_SUPPORTED if CONFIG_ZB_ZDO_MGMT_RTG is disabled
+ */
+esp_err_t esp_zb_zdo_mgmt_rtg_req(esp_zb_zdo_mgmt_rtg_req_param_t *cmd_req, esp_zb_zdo_mgmt_rtg_callback_t user_cb, void *user_ctx);
+
+/**
+ * @brief   Send bind request command with a 16 bit group address destination
+ *
+ * @note A frame sent through the binding reaches every member of the group at once, refer to `dst_address_u.addr_short` for
+ * the group address, `dst_addr_mode` and `dst_endp` are ignored.
+ *
+ * @param[in] cmd_req  Pointer to the bind request command @ref esp_zb_zdo_bind_req_param_s
+ * @param[in] user_cb  A user callback that will be called if received bind response refer to esp_zb_zdo_bind_callback_t
+ * @param[in] user_ctx A void pointer that contains the user defines additional information when callback trigger
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if there is no buffer or request slot for the request
+ */
+esp_err_t esp_zb_zdo_device_group_bind_req(esp_zb_zdo_bind_req_param_t *cmd_req, esp_zb_zdo_bind_callback_t user_cb, void *user_ctx);
+
+/**
+ * @brief   Send unbind request command
+ *
+ * @param[in] cmd_req  Pointer to the unbind request command @ref esp_zb_zdo_bind_req_param_s, both destination address modes are supported
+ * @param[in] user_cb  A user callback that will be called if received unbind response refer to esp_zb_zdo_bind_callback_t
+ * @param[in] user_ctx A void pointer that contains the user defines additional information when callback trigger
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if there is no buffer or request slot for the request
+ */
+esp_err_t esp_zb_zdo_device_unbind_req(esp_zb_zdo_bind_req_param_t *cmd_req, esp_zb_zdo_bind_callback_t user_cb, void *user_ctx);
+
+/**
+ * @brief   Send Mgmt_Bind request command to get a page of the binding table of a remote device
+ *
+ * @param[in] cmd_req  Pointer to the Mgmt_Bind request command @ref esp_zb_zdo_mgmt_bind_req_param_s
+ * @param[in] user_cb  A user callback that will be called if received Mgmt_Bind response refer to esp_zb_zdo_mgmt_bind_callback_t
+ * @param[in] user_ctx A void pointer that contains the user defines additional information when callback trigger
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if there is no buffer or request slot for the request
+ */
+esp_err_t esp_zb_zdo_mgmt_bind_req(esp_zb_zdo_mgmt_bind_req_param_t *cmd_req, esp_zb_zdo_mgmt_bind_callback_t user_cb, void *user_ctx);
+
+/**
+ * @brief   Send a batch of bind and unbind requests
+ *
+ * @note Up to @p concurrency requests are in flight at the same time, the next entry is sent as soon as a response is
+ * received. The entries are copied, the caller may release them after the call. One batch runs at a time.
+ * @note The dst_addr_mode of every entry must be set, an entry with an invalid mode is not sent and gets
+ * ESP_ZB_ZDP_STATUS_INV_REQUESTTYPE. An entry the stack has not answered within ESP_ZB_ZDO_BIND_BATCH_TIMEOUT gets
+ * ESP_ZB_ZDP_STATUS_TIMEOUT, a response received later is ignored.
+ *
+ * @param[in] entries     Array of the batch entries @ref esp_zb_zdo_bind_batch_entry_s
+ * @param[in] entry_num   The number of entries, up to ESP_ZB_ZDO_BIND_BATCH_MAX_NUM
+ * @param[in] concurrency The number of requests in flight, 1 to ESP_ZB_ZDO_BIND_BATCH_CONCURRENCY_MAX_NUM
+ * @param[in] user_cb     A user callback that will be called with the status of every entry refer to esp_zb_zdo_bind_batch_callback_t
+ * @param[in] user_ctx    A void pointer that contains the user defines additional information when callback trigger
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if there is no memory for the batch
+ *         - ESP_ERR_INVALID_STATE if a batch is running
+ */
+esp_err_t esp_zb_zdo_bind_batch_req(const esp_zb_zdo_bind_batch_entry_t *entries, uint16_t entry_num, uint8_t concurrency,
+                                    esp_zb_zdo_bind_batch_callback_t user_cb, void *user_ctx);
+
+/**
+ * @brief   Send Mgmt_NWK_Update request command to run an energy scan on a device
+ *
+ * @note The energy of each channel is returned with the transmission counters of the device, which tell how many
+ * transmissions failed on the current channel.
+ *
+ * @param[in] cmd_req  Pointer to the energy scan request command @ref esp_zb_zdo_energy_scan_req_param_s
+ * @param[in] user_cb  A user callback that will be called if received Mgmt_NWK_Update_notify refer to esp_zb_zdo_energy_scan_callback_t
+ * @param[in] user_ctx A void pointer that contains the user defines additional information when callback trigger
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if the arguments are invalid
+ *         - ESP_ERR_NO_MEM if there is no buffer or request slot for the request
+ */
+esp_err_t esp_zb_zdo_energy_scan_req(esp_zb_zdo_energy_scan_req_param_t *cmd_req, esp_zb_zdo_energy_scan_callback_t user_cb, void *user_ctx);
+
+/**
+ * @brief   Broadcast Mgmt_NWK_Update request command to move the whole network to another channel
+ *
+ * @note The request is broadcast to all the devices with the receiver on when idle, the sleepy end devices find the
+ * network again by rejoining. The coordinator moves after the broadcast delivery time.
+ *
+ * @warning  Only for the network manager, the Zigbee coordinator by default!
+ *
+ * @param[in] channel  The new channel, 11 to 26
+ *
+ * @return - ESP_OK on success
+ *         - ESP_ERR_INVALID_ARG if @p channel is invalid
+ *         - ESP_ERR_NO_MEM if there is no buffer for the request
+ */
+esp_err_t esp_zb_zdo_channel_change_req(uint8_t channel);
+
 #ifdef __cplusplus
 }
 #endif
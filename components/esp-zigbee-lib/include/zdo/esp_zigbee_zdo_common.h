@@ -126,6 +126,15 @@ typedef struct esp_zb_zdo_signal_device_annce_params_s {
     uint8_t       capability;             /*!< The capability of the device. */
 } esp_zb_zdo_signal_device_annce_params_t;
 
+/**
+ * @brief Can sleep parameters
+ *
+ * @note Stack passes this parameter to application when it has nothing to do before its next deadline.
+ */
+typedef struct esp_zb_zdo_signal_can_sleep_params_s {
+    uint32_t sleep_tmo;                   /*!< The time in millisecond the device can sleep */
+} esp_zb_zdo_signal_can_sleep_params_t;
+
 /**
  * @brief Macsplit device boot parameters.
  *
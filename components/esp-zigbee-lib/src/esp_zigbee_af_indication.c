@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "zboss_api.h"
+#include "esp_zigbee_af_indication.h"
+
+static const char *TAG = "ESP_ZB_AF_INDICATION";
+
+typedef struct esp_zb_af_indication_s {
+    bool dispatching;
+    bool purge_pending;                             /* a handler was removed during a dispatch */
+    uint8_t handler_num;
+    esp_zb_af_indication_handler_t handler[ESP_ZB_AF_INDICATION_HANDLER_MAX_NUM];   /* NULL once removed, until purged */
+} esp_zb_af_indication_t;
+
+static esp_zb_af_indication_t s_af_indication;
+
+static void esp_zb_af_indication_purge(void)
+{
+    uint8_t num = 0;
+
+    for (uint8_t i = 0; i < s_af_indication.handler_num; i++) {
+        if (s_af_indication.handler[i]) {
+            s_af_indication.handler[num++] = s_af_indication.handler[i];
+        }
+    }
+    s_af_indication.handler_num = num;
+    s_af_indication.purge_pending = false;
+    if (!num) {
+        zb_af_set_data_indication(NULL);
+    }
+}
+
+static zb_uint8_t esp_zb_af_indication_dispatch(zb_uint8_t param)
+{
+    bool consumed = false;
+
+    s_af_indication.dispatching = true;
+    /* the handlers added during the dispatch only see the next frames */
+    for (uint8_t i = 0, num = s_af_indication.handler_num; i < num && !consumed; i++) {
+        if (s_af_indication.handler[i]) {
+            consumed = s_af_indication.handler[i](param);
+        }
+    }
+    s_af_indication.dispatching = false;
+    if (s_af_indication.purge_pending) {
+        esp_zb_af_indication_purge();
+    }
+    return consumed ? ZB_TRUE : ZB_FALSE;
+}
+
+esp_err_t esp_zb_af_indication_handler_add(esp_zb_af_indication_handler_t handler)
+{
+    ESP_RETURN_ON_FALSE(handler, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    for (uint8_t i = 0; i < s_af_indication.handler_num; i++) {
+        ESP_RETURN_ON_FALSE(s_af_indication.handler[i] != handler, ESP_ERR_INVALID_STATE, TAG, "Handler is already added");
+    }
+    if (s_af_indication.handler_num == ESP_ZB_AF_INDICATION_HANDLER_MAX_NUM && s_af_indication.purge_pending &&
+            !s_af_indication.dispatching) {
+        esp_zb_af_indication_purge();
+    }
+    ESP_RETURN_ON_FALSE(s_af_indication.handler_num < ESP_ZB_AF_INDICATION_HANDLER_MAX_NUM, ESP_ERR_NO_MEM, TAG,
+                        "Too many data indication handlers");
+    s_af_indication.handler[s_af_indication.handler_num++] = handler;
+    zb_af_set_data_indication(esp_zb_af_indication_dispatch);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_af_indication_handler_remove(esp_zb_af_indication_handler_t handler)
+{
+    for (uint8_t i = 0; i < s_af_indication.handler_num; i++) {
+        if (s_af_indication.handler[i] == handler && handler) {
+            /* the table is walked by the dispatch, the handler is only dropped once it is over */
+            s_af_indication.handler[i] = NULL;
+            s_af_indication.purge_pending = true;
+            if (!s_af_indication.dispatching) {
+                esp_zb_af_indication_purge();
+            }
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
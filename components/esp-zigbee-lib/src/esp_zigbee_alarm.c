@@ -0,0 +1,346 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_alarm.h"
+#include "esp_zigbee_mem.h"
+#include "esp_zigbee_profiler.h"
+
+#define ESP_ZB_ALARM_LEVEL_NUM          4
+#define ESP_ZB_ALARM_SLOT_BITS          6
+#define ESP_ZB_ALARM_SLOT_NUM           (1 << ESP_ZB_ALARM_SLOT_BITS)
+#define ESP_ZB_ALARM_SLOT_MASK          (ESP_ZB_ALARM_SLOT_NUM - 1)
+#define ESP_ZB_ALARM_LEVEL_SHIFT(level) ((level) * ESP_ZB_ALARM_SLOT_BITS)
+#define ESP_ZB_ALARM_LEVEL_MASK(level)  ((1UL << ESP_ZB_ALARM_LEVEL_SHIFT(level)) - 1)
+#define ESP_ZB_ALARM_RANGE              (1UL << ESP_ZB_ALARM_LEVEL_SHIFT(ESP_ZB_ALARM_LEVEL_NUM))
+#define ESP_ZB_ALARM_NONE               0xffff
+
+static const char *TAG = "ESP_ZB_ALARM";
+
+typedef enum {
+    ESP_ZB_ALARM_STATE_FREE,
+    ESP_ZB_ALARM_STATE_PENDING,
+    ESP_ZB_ALARM_STATE_RUNNING,
+} esp_zb_alarm_state_t;
+
+typedef struct esp_zb_alarm_entry_s {
+    esp_zb_alarm_callback_t cb;
+    void *ctx;
+    uint32_t expire;                                /* the tick of the next expiry */
+    uint32_t period;                                /* the period in ticks, 0 for a one-shot alarm */
+    uint16_t prev;
+    uint16_t next;                                  /* the next entry of the slot, or of the free list */
+    uint16_t generation;                            /* bumped when the entry is freed, so the handles given out no longer match */
+    uint8_t level;
+    uint8_t slot;
+    uint8_t state;
+} esp_zb_alarm_entry_t;
+
+/* level l holds the alarms expiring in less than 64^(l+1) ticks, in the slot of bits [6l, 6l+6) of their expiry tick.
+ * When the wheel reaches the start of a slot of level l, its alarms are cascaded to the lower levels */
+typedef struct esp_zb_alarm_wheel_s {
+    esp_zb_alarm_entry_t *entries;
+    uint16_t free_head;
+    uint16_t heads[ESP_ZB_ALARM_LEVEL_NUM][ESP_ZB_ALARM_SLOT_NUM];
+    uint64_t occupied[ESP_ZB_ALARM_LEVEL_NUM];      /* the bit map of the non-empty slots of each level */
+    uint32_t now;                                   /* the last tick processed by the wheel */
+    int64_t base_time;                              /* the time in microsecond of tick 0 */
+    esp_zb_alarm_stats_t stats;
+} esp_zb_alarm_wheel_t;
+
+static esp_zb_alarm_wheel_t s_wheel;
+
+static uint32_t esp_zb_alarm_tick_get(bool round_up)
+{
+    int64_t time = esp_timer_get_time() - s_wheel.base_time;
+
+    return (uint32_t)((time + (round_up ? 1000 * ESP_ZB_ALARM_TICK_MS - 1 : 0)) / (1000 * ESP_ZB_ALARM_TICK_MS));
+}
+
+static esp_zb_alarm_handle_t esp_zb_alarm_handle_make(uint16_t index)
+{
+    return ((uint32_t)s_wheel.entries[index].generation << 16) | (index + 1);
+}
+
+static esp_zb_alarm_entry_t *esp_zb_alarm_entry_get(esp_zb_alarm_handle_t handle)
+{
+    uint32_t index = (handle & 0xffff) - 1;
+
+    if (!s_wheel.entries || index >= s_wheel.stats.capacity || s_wheel.entries[index].generation != (handle >> 16) ||
+            s_wheel.entries[index].state == ESP_ZB_ALARM_STATE_FREE) {
+        return NULL;
+    }
+    return &s_wheel.entries[index];
+}
+
+static void esp_zb_alarm_link(uint16_t index)
+{
+    esp_zb_alarm_entry_t *entry = &s_wheel.entries[index];
+    uint32_t delta = entry->expire - s_wheel.now;
+    uint8_t level = 0;
+
+    while (level < ESP_ZB_ALARM_LEVEL_NUM - 1 && delta >> ESP_ZB_ALARM_LEVEL_SHIFT(level + 1)) {
+        level++;
+    }
+    if (delta >= ESP_ZB_ALARM_RANGE) {
+        /* beyond the wheel, parked in the farthest slot and placed again when it is cascaded */
+        entry->slot = ((s_wheel.now >> ESP_ZB_ALARM_LEVEL_SHIFT(level)) + ESP_ZB_ALARM_SLOT_MASK) & ESP_ZB_ALARM_SLOT_MASK;
+    } else {
+        entry->slot = (entry->expire >> ESP_ZB_ALARM_LEVEL_SHIFT(level)) & ESP_ZB_ALARM_SLOT_MASK;
+    }
+    entry->level = level;
+    entry->prev = ESP_ZB_ALARM_NONE;
+    entry->next = s_wheel.heads[level][entry->slot];
+    if (entry->next != ESP_ZB_ALARM_NONE) {
+        s_wheel.entries[entry->next].prev = index;
+    }
+    s_wheel.heads[level][entry->slot] = index;
+    s_wheel.occupied[level] |= 1ULL << entry->slot;
+    entry->state = ESP_ZB_ALARM_STATE_PENDING;
+}
+
+static void esp_zb_alarm_unlink(uint16_t index)
+{
+    esp_zb_alarm_entry_t *entry = &s_wheel.entries[index];
+
+    if (entry->prev != ESP_ZB_ALARM_NONE) {
+        s_wheel.entries[entry->prev].next = entry->next;
+    } else {
+        s_wheel.heads[entry->level][entry->slot] = entry->next;
+        if (entry->next == ESP_ZB_ALARM_NONE) {
+            s_wheel.occupied[entry->level] &= ~(1ULL << entry->slot);
+        }
+    }
+    if (entry->next != ESP_ZB_ALARM_NONE) {
+        s_wheel.entries[entry->next].prev = entry->prev;
+    }
+}
+
+static void esp_zb_alarm_free(uint16_t index)
+{
+    esp_zb_alarm_entry_t *entry = &s_wheel.entries[index];
+
+    entry->state = ESP_ZB_ALARM_STATE_FREE;
+    entry->generation++;
+    entry->next = s_wheel.free_head;
+    s_wheel.free_head = index;
+    s_wheel.stats.pending--;
+}
+
+/* the number of ticks from now to the next slot to process, 0 if no alarm is pending */
+static uint32_t esp_zb_alarm_next_event(void)
+{
+    uint32_t next = 0;
+
+    for (uint8_t level = 0; level < ESP_ZB_ALARM_LEVEL_NUM; level++) {
+        uint64_t occupied = s_wheel.occupied[level];
+        uint8_t shift = 0;
+        uint32_t ticks = 0;
+
+        if (!occupied) {
+            continue;
+        }
+        /* rotate the bit map so that bit 0 is the slot following the current one */
+        shift = ((s_wheel.now >> ESP_ZB_ALARM_LEVEL_SHIFT(level)) + 1) & ESP_ZB_ALARM_SLOT_MASK;
+        occupied = shift ? (occupied >> shift) | (occupied << (ESP_ZB_ALARM_SLOT_NUM - shift)) : occupied;
+        ticks = ((uint32_t)(__builtin_ctzll(occupied) + 1) << ESP_ZB_ALARM_LEVEL_SHIFT(level)) -
+                (s_wheel.now & ESP_ZB_ALARM_LEVEL_MASK(level));
+        if (!next || ticks < next) {
+            next = ticks;
+        }
+    }
+    return next;
+}
+
+static void esp_zb_alarm_cascade(uint8_t level, uint8_t slot)
+{
+    uint16_t index = s_wheel.heads[level][slot];
+
+    s_wheel.heads[level][slot] = ESP_ZB_ALARM_NONE;
+    s_wheel.occupied[level] &= ~(1ULL << slot);
+    while (index != ESP_ZB_ALARM_NONE) {
+        uint16_t next = s_wheel.entries[index].next;
+        esp_zb_alarm_link(index);
+        index = next;
+    }
+}
+
+static void esp_zb_alarm_tick(void)
+{
+    uint8_t slot = 0;
+    uint16_t index = 0;
+
+    s_wheel.now++;
+    for (uint8_t level = 1; level < ESP_ZB_ALARM_LEVEL_NUM && !(s_wheel.now & ESP_ZB_ALARM_LEVEL_MASK(level)); level++) {
+        esp_zb_alarm_cascade(level, (s_wheel.now >> ESP_ZB_ALARM_LEVEL_SHIFT(level)) & ESP_ZB_ALARM_SLOT_MASK);
+    }
+    slot = s_wheel.now & ESP_ZB_ALARM_SLOT_MASK;
+    /* the callbacks may cancel the other alarms of the slot, so the slot is popped one alarm at a time, an alarm
+     * started from a callback always lands in another slot */
+    while ((index = s_wheel.heads[0][slot]) != ESP_ZB_ALARM_NONE) {
+        esp_zb_alarm_entry_t *entry = &s_wheel.entries[index];
+        esp_zb_alarm_callback_t cb = entry->cb;
+        uint16_t generation = entry->generation;
+        int64_t start = esp_zb_profiler_begin();
+
+        esp_zb_alarm_unlink(index);
+        entry->state = ESP_ZB_ALARM_STATE_RUNNING;
+        s_wheel.stats.expire_count++;
+        if (start) {
+            int64_t lateness = start - s_wheel.base_time - (int64_t)entry->expire * ESP_ZB_ALARM_TICK_MS * 1000;
+            esp_zb_profiler_lateness_record(lateness > 0 ? (uint32_t)lateness : 0);
+        }
+        cb(esp_zb_alarm_handle_make(index), entry->ctx);
+        esp_zb_profiler_end(ESP_ZB_PROFILER_TYPE_ALARM, (uintptr_t)cb, start);
+        if (entry->generation != generation) {
+            continue;
+        }
+        if (entry->period) {
+            entry->expire += entry->period;
+            if ((int32_t)(entry->expire - s_wheel.now) <= 0) {
+                entry->expire = s_wheel.now + 1;
+            }
+            esp_zb_alarm_link(index);
+        } else {
+            esp_zb_alarm_free(index);
+        }
+    }
+}
+
+static void esp_zb_alarm_advance(uint32_t target)
+{
+    while ((int32_t)(target - s_wheel.now) > 0) {
+        uint32_t ticks = esp_zb_alarm_next_event();
+        if (!ticks || ticks > target - s_wheel.now) {
+            s_wheel.now = target;
+            break;
+        }
+        /* nothing to process in between, jump right before the next slot */
+        s_wheel.now += ticks - 1;
+        esp_zb_alarm_tick();
+    }
+}
+
+static void esp_zb_alarm_drive(uint8_t param);
+
+static void esp_zb_alarm_schedule(void)
+{
+    uint32_t ticks = esp_zb_alarm_next_event();
+    int64_t delay = 0;
+
+    esp_zb_scheduler_alarm_cancel(esp_zb_alarm_drive, 0);
+    if (!ticks) {
+        return;
+    }
+    /* the delay counts from the time rather than from the start of the current tick, so the slot is processed as soon
+     * as it starts instead of up to a tick later */
+    delay = s_wheel.base_time + (int64_t)(s_wheel.now + ticks) * ESP_ZB_ALARM_TICK_MS * 1000 - esp_timer_get_time();
+    esp_zb_scheduler_alarm(esp_zb_alarm_drive, 0, delay > 0 ? (uint32_t)((delay + 999) / 1000) : 0);
+}
+
+static void esp_zb_alarm_drive(uint8_t param)
+{
+    if (s_wheel.entries) {
+        esp_zb_alarm_advance(esp_zb_alarm_tick_get(false));
+        esp_zb_alarm_schedule();
+    }
+}
+
+esp_err_t esp_zb_alarm_init(uint16_t alarm_num)
+{
+    ESP_RETURN_ON_FALSE(alarm_num && alarm_num <= ESP_ZB_ALARM_MAX_NUM, ESP_ERR_INVALID_ARG, TAG, "Invalid alarm number: %d", alarm_num);
+    ESP_RETURN_ON_FALSE(!s_wheel.entries, ESP_ERR_INVALID_STATE, TAG, "Alarms are already initialized");
+    memset(&s_wheel, 0, sizeof(s_wheel));
+    s_wheel.entries = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_CORE, alarm_num, sizeof(esp_zb_alarm_entry_t));
+    ESP_RETURN_ON_FALSE(s_wheel.entries, ESP_ERR_NO_MEM, TAG, "No memory for the alarms");
+    for (uint16_t i = 0; i < alarm_num; i++) {
+        s_wheel.entries[i].next = i + 1 < alarm_num ? i + 1 : ESP_ZB_ALARM_NONE;
+        s_wheel.entries[i].generation = 1;
+    }
+    memset(s_wheel.heads, 0xff, sizeof(s_wheel.heads));
+    s_wheel.base_time = esp_timer_get_time();
+    s_wheel.stats.capacity = alarm_num;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_alarm_deinit(void)
+{
+    if (s_wheel.entries) {
+        esp_zb_scheduler_alarm_cancel(esp_zb_alarm_drive, 0);
+        esp_zb_mem_free(s_wheel.entries);
+        s_wheel.entries = NULL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_alarm_start(esp_zb_alarm_callback_t cb, void *ctx, uint32_t delay, uint32_t period, esp_zb_alarm_handle_t *handle)
+{
+    esp_zb_alarm_entry_t *entry = NULL;
+    uint16_t index = 0;
+    uint32_t ticks = (delay + ESP_ZB_ALARM_TICK_MS - 1) / ESP_ZB_ALARM_TICK_MS;
+
+    ESP_RETURN_ON_FALSE(s_wheel.entries, ESP_ERR_INVALID_STATE, TAG, "Alarms are not initialized");
+    ESP_RETURN_ON_FALSE(cb, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(s_wheel.free_head != ESP_ZB_ALARM_NONE, ESP_ERR_NO_MEM, TAG, "Too many alarms pending");
+    index = s_wheel.free_head;
+    entry = &s_wheel.entries[index];
+    s_wheel.free_head = entry->next;
+    entry->cb = cb;
+    entry->ctx = ctx;
+    entry->period = period ? (period + ESP_ZB_ALARM_TICK_MS - 1) / ESP_ZB_ALARM_TICK_MS : 0;
+    /* the wheel may lag behind the time when its driving alarm is late, the expiry counts from the time, rounded up
+     * so that the alarm never expires early */
+    entry->expire = esp_zb_alarm_tick_get(true) + ticks;
+    if ((int32_t)(entry->expire - s_wheel.now) <= 0) {
+        entry->expire = s_wheel.now + 1;
+    }
+    esp_zb_alarm_link(index);
+    if (++s_wheel.stats.pending > s_wheel.stats.pending_max) {
+        s_wheel.stats.pending_max = s_wheel.stats.pending;
+    }
+    if (handle) {
+        *handle = esp_zb_alarm_handle_make(index);
+    }
+    esp_zb_alarm_schedule();
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_alarm_cancel(esp_zb_alarm_handle_t handle)
+{
+    esp_zb_alarm_entry_t *entry = esp_zb_alarm_entry_get(handle);
+    uint16_t index = (handle & 0xffff) - 1;
+
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Alarm not found");
+    if (entry->state == ESP_ZB_ALARM_STATE_PENDING) {
+        esp_zb_alarm_unlink(index);
+    }
+    /* the driving alarm is left as is, it only wakes the wheel up for nothing */
+    esp_zb_alarm_free(index);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_alarm_get_remaining(esp_zb_alarm_handle_t handle, uint32_t *remaining)
+{
+    esp_zb_alarm_entry_t *entry = esp_zb_alarm_entry_get(handle);
+    int32_t ticks = 0;
+
+    ESP_RETURN_ON_FALSE(remaining, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Alarm not found");
+    ticks = (int32_t)(entry->expire - esp_zb_alarm_tick_get(false));
+    *remaining = ticks > 0 ? (uint32_t)ticks * ESP_ZB_ALARM_TICK_MS : 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_alarm_get_stats(esp_zb_alarm_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *stats = s_wheel.stats;
+    return ESP_OK;
+}
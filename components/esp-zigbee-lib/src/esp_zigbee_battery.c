@@ -0,0 +1,309 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_battery.h"
+#include "zcl/esp_zigbee_zcl_power_config.h"
+#include "zboss_api.h"
+
+#define ESP_ZB_BATTERY_STRETCH_UNIT     16          /* the stretch factor is kept in units of 1/16 */
+#define ESP_ZB_BATTERY_MAX_INTERVAL_MAX 0xfffe      /* 0xffff disables the periodic report, never stretch into it */
+
+static const char *TAG = "ESP_ZB_BATTERY";
+
+typedef struct esp_zb_battery_report_s {
+    uint16_t base_max_interval;                     /* the max interval configured for the attribute, before stretch */
+    uint16_t applied_max_interval;                  /* the max interval last written by the battery monitor */
+} esp_zb_battery_report_t;
+
+typedef struct esp_zb_battery_s {
+    bool initialized;
+    bool measured;                                  /* at least one voltage has been measured */
+    esp_zb_battery_cfg_t cfg;
+    esp_zb_battery_curve_point_t curve[ESP_ZB_BATTERY_CURVE_MAX_POINTS];
+    uint8_t curve_size;
+    esp_zb_battery_report_t report[ESP_ZB_BATTERY_REPORT_ATTR_MAX_NUM];
+    esp_zb_battery_status_t status;
+} esp_zb_battery_t;
+
+/* per-cell discharge curves under the light load of a sleepy end device, ordered by descending voltage */
+static const esp_zb_battery_curve_point_t s_lithium_coin_curve[] = {
+    {3000, 100}, {2900, 80}, {2800, 60}, {2700, 40}, {2600, 30}, {2500, 20}, {2400, 10}, {2000, 0},
+};
+
+static const esp_zb_battery_curve_point_t s_alkaline_curve[] = {
+    {1600, 100}, {1450, 85}, {1350, 65}, {1250, 40}, {1150, 20}, {1050, 8}, {900, 0},
+};
+
+static const esp_zb_battery_curve_point_t s_lithium_ion_curve[] = {
+    {4200, 100}, {4100, 90}, {4000, 78}, {3900, 66}, {3800, 52}, {3700, 38}, {3600, 15}, {3500, 7}, {3300, 2}, {3000, 0},
+};
+
+static esp_zb_battery_t s_battery;
+
+static uint8_t esp_zb_battery_curve_lookup(const esp_zb_battery_curve_point_t *curve, uint8_t size, uint16_t voltage)
+{
+    if (voltage >= curve[0].voltage) {
+        return curve[0].percentage;
+    }
+    for (uint8_t i = 1; i < size; i++) {
+        if (voltage >= curve[i].voltage) {
+            uint16_t span = curve[i - 1].voltage - curve[i].voltage;
+            uint16_t delta = voltage - curve[i].voltage;
+            return curve[i].percentage + (uint8_t)((curve[i - 1].percentage - curve[i].percentage) * delta / span);
+        }
+    }
+    return curve[size - 1].percentage;
+}
+
+static bool esp_zb_battery_curve_is_valid(const esp_zb_battery_curve_point_t *curve, uint8_t size)
+{
+    if (!curve || size < 2 || size > ESP_ZB_BATTERY_CURVE_MAX_POINTS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < size; i++) {
+        if (curve[i].percentage > 100 || (i > 0 && (curve[i].voltage >= curve[i - 1].voltage ||
+                                                    curve[i].percentage > curve[i - 1].percentage))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t esp_zb_battery_voltage_to_percentage(esp_zb_battery_chemistry_t chemistry, uint16_t voltage)
+{
+    switch (chemistry) {
+    case ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_COIN:
+        return esp_zb_battery_curve_lookup(s_lithium_coin_curve, sizeof(s_lithium_coin_curve) / sizeof(s_lithium_coin_curve[0]), voltage);
+    case ESP_ZB_BATTERY_CHEMISTRY_ALKALINE:
+        return esp_zb_battery_curve_lookup(s_alkaline_curve, sizeof(s_alkaline_curve) / sizeof(s_alkaline_curve[0]), voltage);
+    case ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_ION:
+        return esp_zb_battery_curve_lookup(s_lithium_ion_curve, sizeof(s_lithium_ion_curve) / sizeof(s_lithium_ion_curve[0]), voltage);
+    default:
+        return 0;
+    }
+}
+
+static uint16_t esp_zb_battery_stretch_calc(const esp_zb_battery_t *battery)
+{
+    uint32_t stretch = ESP_ZB_BATTERY_STRETCH_UNIT;
+
+    if (battery->cfg.drain_stretch > 1) {
+        stretch += (uint32_t)(100 - battery->status.percentage) * (battery->cfg.drain_stretch - 1) * ESP_ZB_BATTERY_STRETCH_UNIT / 100;
+    }
+    if (battery->status.low && battery->cfg.low_stretch > 1) {
+        stretch *= battery->cfg.low_stretch;
+    }
+    return stretch > UINT16_MAX ? UINT16_MAX : (uint16_t)stretch;
+}
+
+static uint32_t esp_zb_battery_stretch_apply(uint32_t value, uint16_t stretch)
+{
+    return (uint32_t)(((uint64_t)value * stretch) / ESP_ZB_BATTERY_STRETCH_UNIT);
+}
+
+/* the new max interval goes through the reporting configuration of the stack, as a Configure Reporting command does,
+ * and the report is started again so the pending one is scheduled with it */
+static void esp_zb_battery_report_reconfigure(const zb_zcl_reporting_info_t *info, uint16_t max_interval)
+{
+    zb_zcl_reporting_info_t rep_info = *info;
+
+    rep_info.u.send_info.max_interval = max_interval;
+    if (zb_zcl_put_reporting_info(&rep_info, ZB_TRUE) != RET_OK ||
+            zb_zcl_start_attr_reporting(rep_info.ep, rep_info.cluster_id, rep_info.cluster_role, rep_info.attr_id) != RET_OK) {
+        ESP_LOGW(TAG, "Failed to set the max interval of attribute 0x%04x of cluster 0x%04x on endpoint %d", rep_info.attr_id,
+                 rep_info.cluster_id, rep_info.ep);
+    }
+}
+
+static void esp_zb_battery_report_stretch(esp_zb_battery_t *battery, bool restore)
+{
+    for (uint8_t i = 0; i < battery->cfg.report_attr_num; i++) {
+        const esp_zb_battery_report_attr_t *attr = &battery->cfg.report_attr[i];
+        esp_zb_battery_report_t *report = &battery->report[i];
+        zb_zcl_reporting_info_t *info = zb_zcl_find_reporting_info(attr->endpoint, attr->cluster_id, ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                                                   attr->attr_id);
+        uint32_t max_interval = 0;
+
+        if (!info) {
+            continue;
+        }
+        /* the reporting has been reconfigured by a remote device since the last stretch, take it as the new base */
+        if (info->u.send_info.max_interval != report->applied_max_interval) {
+            report->base_max_interval = info->u.send_info.max_interval;
+        }
+        /* 0 and 0xffff have dedicated meanings for the max interval, leave them untouched */
+        if (report->base_max_interval == 0 || report->base_max_interval == 0xffff) {
+            report->applied_max_interval = report->base_max_interval;
+            continue;
+        }
+        max_interval = restore ? report->base_max_interval : esp_zb_battery_stretch_apply(report->base_max_interval, battery->status.stretch);
+        if (max_interval > ESP_ZB_BATTERY_MAX_INTERVAL_MAX) {
+            max_interval = ESP_ZB_BATTERY_MAX_INTERVAL_MAX;
+        }
+        if (max_interval != info->u.send_info.max_interval) {
+            esp_zb_battery_report_reconfigure(info, (uint16_t)max_interval);
+        }
+        report->applied_max_interval = (uint16_t)max_interval;
+    }
+}
+
+static void esp_zb_battery_keep_alive_stretch(esp_zb_battery_t *battery, bool restore)
+{
+#if defined ZB_ED_ROLE
+    uint32_t keep_alive = battery->cfg.keep_alive;
+
+    if (keep_alive == 0) {
+        return;
+    }
+    if (!restore) {
+        keep_alive = esp_zb_battery_stretch_apply(keep_alive, battery->status.stretch);
+    }
+    zb_set_keepalive_timeout(ZB_MILLISECONDS_TO_BEACON_INTERVAL(keep_alive));
+#endif
+}
+
+static void esp_zb_battery_attr_update(const esp_zb_battery_t *battery)
+{
+    uint32_t voltage = (battery->status.voltage + 50) / 100;
+    uint8_t voltage_attr = voltage > 0xfe ? 0xfe : (uint8_t)voltage;
+    uint8_t percentage_attr = battery->status.percentage * 2;
+
+    /* BatteryVoltage is in units of 100mV, BatteryPercentageRemaining is in units of 0.5% */
+    esp_zb_zcl_set_attribute_val(battery->cfg.endpoint, ESP_ZB_ZCL_CLUSTER_ID_POWER_CONFIG, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_POWER_CONFIG_BATTERY_VOLTAGE_ID, &voltage_attr);
+    esp_zb_zcl_set_attribute_val(battery->cfg.endpoint, ESP_ZB_ZCL_CLUSTER_ID_POWER_CONFIG, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_POWER_CONFIG_BATTERY_PERCENTAGE_REMAINING_ID, &percentage_attr);
+}
+
+static void esp_zb_battery_process(esp_zb_battery_t *battery, uint16_t voltage)
+{
+    uint16_t cell_voltage = voltage / battery->cfg.cell_num;
+    uint8_t percentage = esp_zb_battery_curve_lookup(battery->curve, battery->curve_size, cell_voltage);
+    uint8_t diff = 0;
+    bool low = battery->status.low;
+    uint16_t stretch = 0;
+
+    battery->status.voltage = voltage;
+    battery->status.cell_voltage = cell_voltage;
+    diff = percentage > battery->status.percentage ? percentage - battery->status.percentage : battery->status.percentage - percentage;
+    /* a cell voltage recovers for a while after a load, the hysteresis keeps the percentage from bouncing */
+    if (!battery->measured || diff >= battery->cfg.hysteresis) {
+        battery->status.percentage = percentage;
+    }
+    battery->measured = true;
+    if (!low && battery->status.percentage < battery->cfg.low_threshold) {
+        low = true;
+    } else if (low && battery->status.percentage >= battery->cfg.low_threshold + battery->cfg.hysteresis) {
+        low = false;
+    }
+    esp_zb_battery_attr_update(battery);
+    if (low != battery->status.low) {
+        battery->status.low = low;
+        ESP_LOGI(TAG, "%s low battery mode at %d%%", low ? "Enter" : "Leave", battery->status.percentage);
+        if (battery->cfg.low_cb) {
+            battery->cfg.low_cb(low, battery->status.percentage, battery->cfg.user_ctx);
+        }
+    }
+    stretch = esp_zb_battery_stretch_calc(battery);
+    if (stretch != battery->status.stretch) {
+        battery->status.stretch = stretch;
+        esp_zb_battery_report_stretch(battery, false);
+        esp_zb_battery_keep_alive_stretch(battery, false);
+    }
+}
+
+static void esp_zb_battery_measure_alarm(uint8_t param)
+{
+    uint16_t voltage = 0;
+
+    if (!s_battery.initialized || !s_battery.cfg.read_cb) {
+        return;
+    }
+    if (s_battery.cfg.read_cb(&voltage, s_battery.cfg.user_ctx) == ESP_OK) {
+        esp_zb_battery_process(&s_battery, voltage);
+    } else {
+        ESP_LOGW(TAG, "Failed to measure the battery voltage");
+    }
+    esp_zb_scheduler_alarm(esp_zb_battery_measure_alarm, 0, s_battery.cfg.measure_period);
+}
+
+esp_err_t esp_zb_battery_init(const esp_zb_battery_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(!s_battery.initialized, ESP_ERR_INVALID_STATE, TAG, "Battery monitor is already initialized");
+    ESP_RETURN_ON_FALSE(cfg->report_attr_num <= ESP_ZB_BATTERY_REPORT_ATTR_MAX_NUM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid reporting attribute number: %d", cfg->report_attr_num);
+    ESP_RETURN_ON_FALSE(!cfg->read_cb || cfg->measure_period > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid measure period");
+    ESP_RETURN_ON_FALSE(cfg->low_threshold <= 100, ESP_ERR_INVALID_ARG, TAG, "Invalid low threshold: %d", cfg->low_threshold);
+
+    memset(&s_battery, 0, sizeof(esp_zb_battery_t));
+    switch (cfg->chemistry) {
+    case ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_COIN:
+        memcpy(s_battery.curve, s_lithium_coin_curve, sizeof(s_lithium_coin_curve));
+        s_battery.curve_size = sizeof(s_lithium_coin_curve) / sizeof(s_lithium_coin_curve[0]);
+        break;
+    case ESP_ZB_BATTERY_CHEMISTRY_ALKALINE:
+        memcpy(s_battery.curve, s_alkaline_curve, sizeof(s_alkaline_curve));
+        s_battery.curve_size = sizeof(s_alkaline_curve) / sizeof(s_alkaline_curve[0]);
+        break;
+    case ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_ION:
+        memcpy(s_battery.curve, s_lithium_ion_curve, sizeof(s_lithium_ion_curve));
+        s_battery.curve_size = sizeof(s_lithium_ion_curve) / sizeof(s_lithium_ion_curve[0]);
+        break;
+    case ESP_ZB_BATTERY_CHEMISTRY_CUSTOM:
+        ESP_RETURN_ON_FALSE(esp_zb_battery_curve_is_valid(cfg->curve, cfg->curve_size), ESP_ERR_INVALID_ARG, TAG,
+                            "Invalid discharge curve");
+        memcpy(s_battery.curve, cfg->curve, cfg->curve_size * sizeof(esp_zb_battery_curve_point_t));
+        s_battery.curve_size = cfg->curve_size;
+        break;
+    default:
+        ESP_LOGE(TAG, "Unsupported battery chemistry: 0x%x", cfg->chemistry);
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_battery.cfg = *cfg;
+    s_battery.cfg.curve = NULL;
+    if (s_battery.cfg.cell_num == 0) {
+        s_battery.cfg.cell_num = 1;
+    }
+    s_battery.status.percentage = 100;
+    s_battery.status.stretch = ESP_ZB_BATTERY_STRETCH_UNIT;
+    s_battery.initialized = true;
+    if (s_battery.cfg.read_cb) {
+        esp_zb_scheduler_alarm(esp_zb_battery_measure_alarm, 0, s_battery.cfg.measure_period);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_battery_deinit(void)
+{
+    ESP_RETURN_ON_FALSE(s_battery.initialized, ESP_ERR_INVALID_STATE, TAG, "Battery monitor is not initialized");
+    esp_zb_scheduler_alarm_cancel(esp_zb_battery_measure_alarm, 0);
+    if (s_battery.status.stretch != ESP_ZB_BATTERY_STRETCH_UNIT) {
+        esp_zb_battery_report_stretch(&s_battery, true);
+        esp_zb_battery_keep_alive_stretch(&s_battery, true);
+    }
+    s_battery.initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_battery_update(uint16_t voltage)
+{
+    ESP_RETURN_ON_FALSE(s_battery.initialized, ESP_ERR_INVALID_STATE, TAG, "Battery monitor is not initialized");
+    esp_zb_battery_process(&s_battery, voltage);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_battery_get_status(esp_zb_battery_status_t *status)
+{
+    ESP_RETURN_ON_FALSE(status, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(s_battery.initialized, ESP_ERR_INVALID_STATE, TAG, "Battery monitor is not initialized");
+    *status = s_battery.status;
+    return ESP_OK;
+}
@@ -0,0 +1,274 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "sdkconfig.h"
+#include "esp_zigbee_buf_monitor.h"
+#include "zboss_api.h"
+
+static const char *TAG = "ESP_ZB_BUF_MONITOR";
+
+#if CONFIG_ZB_BUF_MONITOR
+
+/* a delayed request, given to the stack with the slot index as argument of the trampoline */
+typedef struct esp_zb_buf_monitor_delayed_s {
+    bool in_use;
+    esp_zb_buf_monitor_alloc_t alloc;
+    zb_callback_t cb;                                           /* the callback of a plain request */
+    zb_callback2_t cb2;                                         /* the callback of an extended request */
+    zb_uint16_t arg;                                            /* the argument of an extended request */
+} esp_zb_buf_monitor_delayed_t;
+
+typedef struct esp_zb_buf_monitor_s {
+    esp_zb_buf_monitor_cfg_t cfg;
+    esp_zb_buf_monitor_stats_t stats;
+    uint32_t allocated[ESP_ZB_BUF_MONITOR_ID_MAX_NUM / 32];     /* the buffers allocated and not freed yet */
+    uint32_t input[ESP_ZB_BUF_MONITOR_ID_MAX_NUM / 32];         /* the input buffers among them */
+    esp_zb_buf_monitor_delayed_t delayed[ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM];
+} esp_zb_buf_monitor_t;
+
+static esp_zb_buf_monitor_t s_buf_monitor;
+
+/* a stack built with ZB_DEBUG_BUFFERS takes the file id and line of the caller first, TRACE_PROTO of zboss_api.h, the
+ * wrappers pass them on */
+#ifdef ZB_DEBUG_BUFFERS
+#define ESP_ZB_BUF_TRACE_ARGS_VOID  from_file, from_line
+#define ESP_ZB_BUF_TRACE_ARGS       ESP_ZB_BUF_TRACE_ARGS_VOID,
+#else
+#define ESP_ZB_BUF_TRACE_ARGS_VOID
+#define ESP_ZB_BUF_TRACE_ARGS
+#endif
+
+/* the linker redirects the calls of these functions to the wrappers below, refer to the --wrap options CMakeLists.txt
+ * adds with CONFIG_ZB_BUF_MONITOR, only the calls between object files are redirected, not the calls within the object
+ * file of the stack which defines them */
+zb_bufid_t __real_zb_buf_get_out_func(TRACE_PROTO_VOID);
+zb_bufid_t __real_zb_buf_get_in_func(TRACE_PROTO_VOID);
+zb_bufid_t __real_zb_buf_get_func(TRACE_PROTO zb_bool_t is_in, zb_uint_t max_size);
+zb_bufid_t __real_zb_buf_get_hipri_func(TRACE_PROTO zb_bool_t is_in);
+void __real_zb_buf_free_func(TRACE_PROTO zb_bufid_t buf);
+zb_ret_t __real_zb_buf_get_out_delayed_func(TRACE_PROTO zb_callback_t callback);
+zb_ret_t __real_zb_buf_get_in_delayed_func(TRACE_PROTO zb_callback_t callback);
+zb_ret_t __real_zb_buf_get_out_delayed_ext_func(TRACE_PROTO zb_callback2_t callback, zb_uint16_t arg, zb_uint_t max_size);
+zb_ret_t __real_zb_buf_get_in_delayed_ext_func(TRACE_PROTO zb_callback2_t callback, zb_uint16_t arg, zb_uint_t max_size);
+
+static bool esp_zb_buf_monitor_is_tracked(uint32_t buf)
+{
+    return buf < ESP_ZB_BUF_MONITOR_ID_MAX_NUM;
+}
+
+static bool esp_zb_buf_monitor_is_allocated(uint32_t buf)
+{
+    return esp_zb_buf_monitor_is_tracked(buf) && (s_buf_monitor.allocated[buf / 32] & (1U << (buf % 32)));
+}
+
+static void esp_zb_buf_monitor_stats_update(esp_zb_buf_monitor_stats_t *stats)
+{
+    *stats = s_buf_monitor.stats;
+    stats->free = stats->pool_size > stats->in_use ? stats->pool_size - stats->in_use : 0;
+}
+
+static void esp_zb_buf_monitor_fail(esp_zb_buf_monitor_alloc_t alloc)
+{
+    esp_zb_buf_monitor_stats_t stats;
+
+    s_buf_monitor.stats.alloc[alloc].fail_count++;
+    if (s_buf_monitor.cfg.fail_cb) {
+        esp_zb_buf_monitor_stats_update(&stats);
+        s_buf_monitor.cfg.fail_cb(alloc, &stats, s_buf_monitor.cfg.ctx);
+    }
+}
+
+static void esp_zb_buf_monitor_allocated(zb_bufid_t buf, bool is_in)
+{
+    if (!esp_zb_buf_monitor_is_tracked(buf) || esp_zb_buf_monitor_is_allocated(buf)) {
+        return;
+    }
+    s_buf_monitor.allocated[buf / 32] |= 1U << (buf % 32);
+    s_buf_monitor.stats.in_use++;
+    if (is_in) {
+        s_buf_monitor.input[buf / 32] |= 1U << (buf % 32);
+        s_buf_monitor.stats.in_use_input++;
+    }
+    if (s_buf_monitor.stats.in_use > s_buf_monitor.stats.in_use_max) {
+        s_buf_monitor.stats.in_use_max = s_buf_monitor.stats.in_use;
+    }
+}
+
+static zb_bufid_t esp_zb_buf_monitor_get(zb_bufid_t buf, bool is_in)
+{
+    esp_zb_buf_monitor_alloc_t alloc = is_in ? ESP_ZB_BUF_MONITOR_ALLOC_IN : ESP_ZB_BUF_MONITOR_ALLOC_OUT;
+
+    s_buf_monitor.stats.alloc[alloc].alloc_count++;
+    if (buf == ZB_BUF_INVALID) {
+        esp_zb_buf_monitor_fail(alloc);
+    } else {
+        esp_zb_buf_monitor_allocated(buf, is_in);
+    }
+    return buf;
+}
+
+zb_bufid_t __wrap_zb_buf_get_out_func(TRACE_PROTO_VOID)
+{
+    return esp_zb_buf_monitor_get(__real_zb_buf_get_out_func(ESP_ZB_BUF_TRACE_ARGS_VOID), false);
+}
+
+zb_bufid_t __wrap_zb_buf_get_in_func(TRACE_PROTO_VOID)
+{
+    return esp_zb_buf_monitor_get(__real_zb_buf_get_in_func(ESP_ZB_BUF_TRACE_ARGS_VOID), true);
+}
+
+zb_bufid_t __wrap_zb_buf_get_func(TRACE_PROTO zb_bool_t is_in, zb_uint_t max_size)
+{
+    return esp_zb_buf_monitor_get(__real_zb_buf_get_func(ESP_ZB_BUF_TRACE_ARGS is_in, max_size), is_in);
+}
+
+zb_bufid_t __wrap_zb_buf_get_hipri_func(TRACE_PROTO zb_bool_t is_in)
+{
+    return esp_zb_buf_monitor_get(__real_zb_buf_get_hipri_func(ESP_ZB_BUF_TRACE_ARGS is_in), is_in);
+}
+
+void __wrap_zb_buf_free_func(TRACE_PROTO zb_bufid_t buf)
+{
+    if (esp_zb_buf_monitor_is_allocated(buf)) {
+        s_buf_monitor.allocated[buf / 32] &= ~(1U << (buf % 32));
+        s_buf_monitor.stats.in_use--;
+        if (s_buf_monitor.input[buf / 32] & (1U << (buf % 32))) {
+            s_buf_monitor.input[buf / 32] &= ~(1U << (buf % 32));
+            s_buf_monitor.stats.in_use_input--;
+        }
+        s_buf_monitor.stats.free_count++;
+    } else {
+        s_buf_monitor.stats.untracked_free_count++;
+    }
+    __real_zb_buf_free_func(ESP_ZB_BUF_TRACE_ARGS buf);
+}
+
+/* the stack runs the trampoline of a delayed request with the buffer, which is tracked before the callback runs */
+static void esp_zb_buf_monitor_delayed_cb(zb_uint8_t buf, zb_uint16_t slot)
+{
+    esp_zb_buf_monitor_delayed_t delayed = s_buf_monitor.delayed[slot];
+
+    s_buf_monitor.delayed[slot].in_use = false;
+    esp_zb_buf_monitor_allocated(buf, delayed.alloc == ESP_ZB_BUF_MONITOR_ALLOC_IN_DELAYED);
+    if (delayed.cb2) {
+        delayed.cb2(buf, delayed.arg);
+    } else {
+        delayed.cb(buf);
+    }
+}
+
+static zb_ret_t esp_zb_buf_monitor_request(TRACE_PROTO bool is_in, zb_callback_t cb, zb_callback2_t cb2, zb_uint16_t arg,
+                                           zb_uint_t max_size)
+{
+    if (cb2) {
+        return is_in ? __real_zb_buf_get_in_delayed_ext_func(ESP_ZB_BUF_TRACE_ARGS cb2, arg, max_size)
+               : __real_zb_buf_get_out_delayed_ext_func(ESP_ZB_BUF_TRACE_ARGS cb2, arg, max_size);
+    }
+    return is_in ? __real_zb_buf_get_in_delayed_func(ESP_ZB_BUF_TRACE_ARGS cb)
+           : __real_zb_buf_get_out_delayed_func(ESP_ZB_BUF_TRACE_ARGS cb);
+}
+
+/* a delayed request reaches the stack as an extended request of the trampoline with the slot which keeps the callback,
+ * a plain request with the default buffer size, the max_size 0 */
+static zb_ret_t esp_zb_buf_monitor_get_delayed(TRACE_PROTO bool is_in, zb_callback_t cb, zb_callback2_t cb2,
+                                               zb_uint16_t arg, zb_uint_t max_size)
+{
+    esp_zb_buf_monitor_alloc_t alloc = is_in ? ESP_ZB_BUF_MONITOR_ALLOC_IN_DELAYED : ESP_ZB_BUF_MONITOR_ALLOC_OUT_DELAYED;
+    zb_uint16_t slot = 0;
+    zb_ret_t ret = RET_OK;
+
+    while (slot < ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM && s_buf_monitor.delayed[slot].in_use) {
+        slot++;
+    }
+    s_buf_monitor.stats.alloc[alloc].alloc_count++;
+    if (slot < ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM) {
+        s_buf_monitor.delayed[slot] = (esp_zb_buf_monitor_delayed_t) {
+            .in_use = true, .alloc = alloc, .cb = cb, .cb2 = cb2, .arg = arg,
+        };
+        ret = esp_zb_buf_monitor_request(ESP_ZB_BUF_TRACE_ARGS is_in, NULL, esp_zb_buf_monitor_delayed_cb, slot, max_size);
+        if (ret != RET_OK) {
+            s_buf_monitor.delayed[slot].in_use = false;
+        }
+    } else {
+        /* too many requests pending, the buffer of this one is not tracked */
+        s_buf_monitor.stats.untracked_alloc_count++;
+        ret = esp_zb_buf_monitor_request(ESP_ZB_BUF_TRACE_ARGS is_in, cb, cb2, arg, max_size);
+    }
+    if (ret != RET_OK) {
+        esp_zb_buf_monitor_fail(alloc);
+    }
+    return ret;
+}
+
+zb_ret_t __wrap_zb_buf_get_out_delayed_func(TRACE_PROTO zb_callback_t callback)
+{
+    return esp_zb_buf_monitor_get_delayed(ESP_ZB_BUF_TRACE_ARGS false, callback, NULL, 0, 0);
+}
+
+zb_ret_t __wrap_zb_buf_get_in_delayed_func(TRACE_PROTO zb_callback_t callback)
+{
+    return esp_zb_buf_monitor_get_delayed(ESP_ZB_BUF_TRACE_ARGS true, callback, NULL, 0, 0);
+}
+
+zb_ret_t __wrap_zb_buf_get_out_delayed_ext_func(TRACE_PROTO zb_callback2_t callback, zb_uint16_t arg, zb_uint_t max_size)
+{
+    return esp_zb_buf_monitor_get_delayed(ESP_ZB_BUF_TRACE_ARGS false, NULL, callback, arg, max_size);
+}
+
+zb_ret_t __wrap_zb_buf_get_in_delayed_ext_func(TRACE_PROTO zb_callback2_t callback, zb_uint16_t arg, zb_uint_t max_size)
+{
+    return esp_zb_buf_monitor_get_delayed(ESP_ZB_BUF_TRACE_ARGS true, NULL, callback, arg, max_size);
+}
+
+esp_err_t esp_zb_buf_monitor_config(const esp_zb_buf_monitor_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    s_buf_monitor.cfg = *cfg;
+    s_buf_monitor.stats.pool_size = cfg->pool_size;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_buf_monitor_get_stats(esp_zb_buf_monitor_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    esp_zb_buf_monitor_stats_update(stats);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_buf_monitor_reset(void)
+{
+    uint16_t in_use = s_buf_monitor.stats.in_use;
+    uint16_t in_use_input = s_buf_monitor.stats.in_use_input;
+
+    memset(&s_buf_monitor.stats, 0, sizeof(s_buf_monitor.stats));
+    s_buf_monitor.stats.pool_size = s_buf_monitor.cfg.pool_size;
+    s_buf_monitor.stats.in_use = in_use;
+    s_buf_monitor.stats.in_use_input = in_use_input;
+    s_buf_monitor.stats.in_use_max = in_use;
+    return ESP_OK;
+}
+#else
+esp_err_t esp_zb_buf_monitor_config(const esp_zb_buf_monitor_cfg_t *cfg)
+{
+    ESP_LOGE(TAG, "The buffer monitor needs CONFIG_ZB_BUF_MONITOR");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_zb_buf_monitor_get_stats(esp_zb_buf_monitor_stats_t *stats)
+{
+    ESP_LOGE(TAG, "The buffer monitor needs CONFIG_ZB_BUF_MONITOR");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_zb_buf_monitor_reset(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+#endif
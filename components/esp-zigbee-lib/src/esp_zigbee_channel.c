@@ -0,0 +1,187 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_channel.h"
+
+#define ESP_ZB_CHANNEL_MIN                  11
+#define ESP_ZB_CHANNEL_MAX                  26
+#define ESP_ZB_CHANNEL_LOCAL_ADDR           0x0000  /* the monitor runs on the coordinator, which scans itself */
+#define ESP_ZB_CHANNEL_RETRY_DELAY          1000    /* time in millisecond to wait before a check is retried when it could not be sent */
+
+static const char *TAG = "ESP_ZB_CHANNEL";
+
+typedef struct esp_zb_channel_monitor_s {
+    bool running;
+    bool counters_valid;                            /* the counters of the previous check are known */
+    uint8_t generation;                             /* carried by the scan requests, a response of a previous run is dropped */
+    uint16_t last_transmissions;
+    uint16_t last_failures;
+    esp_zb_channel_monitor_cfg_t cfg;
+    esp_zb_channel_monitor_stats_t stats;
+} esp_zb_channel_monitor_t;
+
+static esp_zb_channel_monitor_t s_monitor;
+
+esp_err_t esp_zb_channel_select(const esp_zb_zdo_mgmt_nwk_update_rsp_t *rsp, uint32_t channel_mask, uint8_t *channel)
+{
+    uint8_t energy_index = 0;
+    int best = -1;
+
+    ESP_RETURN_ON_FALSE(rsp && channel, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    /* the energy values follow the order of the bits of the scanned channel mask */
+    for (uint8_t ch = ESP_ZB_CHANNEL_MIN; ch <= ESP_ZB_CHANNEL_MAX && energy_index < rsp->energy_list_count; ch++) {
+        if (!(rsp->scanned_channels & (1UL << ch))) {
+            continue;
+        }
+        if ((channel_mask & (1UL << ch)) && (best < 0 || rsp->energy_list[energy_index] < rsp->energy_list[best])) {
+            best = energy_index;
+            *channel = ch;
+        }
+        energy_index++;
+    }
+    return best < 0 ? ESP_ERR_NOT_FOUND : ESP_OK;
+}
+
+static void esp_zb_channel_monitor_alarm(uint8_t param);
+
+static void esp_zb_channel_monitor_schedule(uint32_t delay)
+{
+    esp_zb_scheduler_alarm_cancel(esp_zb_channel_monitor_alarm, 0);
+    esp_zb_scheduler_alarm(esp_zb_channel_monitor_alarm, 0, delay);
+}
+
+/* the transmission counters of the MAC layer are cumulative, the first check after a start or a channel change only takes
+ * them as the reference since they may or may not include the transmissions on the previous channel */
+static void esp_zb_channel_monitor_counters_update(const esp_zb_zdo_mgmt_nwk_update_rsp_t *rsp)
+{
+    esp_zb_channel_monitor_stats_t *stats = &s_monitor.stats;
+
+    if (!s_monitor.counters_valid) {
+        stats->transmissions = 0;
+        stats->failures = 0;
+    } else if (rsp->total_transmissions < s_monitor.last_transmissions || rsp->transmission_failures < s_monitor.last_failures) {
+        stats->transmissions = rsp->total_transmissions;
+        stats->failures = rsp->transmission_failures;
+    } else {
+        stats->transmissions = rsp->total_transmissions - s_monitor.last_transmissions;
+        stats->failures = rsp->transmission_failures - s_monitor.last_failures;
+    }
+    stats->failure_rate = stats->transmissions ? (uint32_t)stats->failures * 100 / stats->transmissions : 0;
+    s_monitor.last_transmissions = rsp->total_transmissions;
+    s_monitor.last_failures = rsp->transmission_failures;
+    s_monitor.counters_valid = true;
+}
+
+static uint8_t esp_zb_channel_monitor_energy(uint8_t channel)
+{
+    return s_monitor.stats.energy[channel - ESP_ZB_CHANNEL_MIN];
+}
+
+static void esp_zb_channel_monitor_scan_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_nwk_update_rsp_t *rsp, void *user_ctx)
+{
+    esp_zb_channel_monitor_stats_t *stats = &s_monitor.stats;
+    uint8_t current = esp_zb_get_current_channel();
+    uint8_t channel = 0;
+    uint8_t energy_index = 0;
+
+    if (!s_monitor.running || (uint8_t)(uintptr_t)user_ctx != s_monitor.generation) {
+        return;
+    }
+    if (zdo_status != ESP_ZB_ZDP_STATUS_SUCCESS) {
+        ESP_LOGW(TAG, "Energy scan failed, status: 0x%x", zdo_status);
+        return;
+    }
+    stats->check_count++;
+    esp_zb_channel_monitor_counters_update(rsp);
+    stats->scanned_channels = rsp->scanned_channels;
+    memset(stats->energy, 0xff, sizeof(stats->energy));
+    for (uint8_t ch = ESP_ZB_CHANNEL_MIN; ch <= ESP_ZB_CHANNEL_MAX && energy_index < rsp->energy_list_count; ch++) {
+        if (rsp->scanned_channels & (1UL << ch)) {
+            stats->energy[ch - ESP_ZB_CHANNEL_MIN] = rsp->energy_list[energy_index++];
+        }
+    }
+    ESP_LOGD(TAG, "Channel %d: %d transmissions, %d failures", current, stats->transmissions, stats->failures);
+    if (stats->transmissions < s_monitor.cfg.min_transmissions || stats->failure_rate < s_monitor.cfg.failure_threshold) {
+        return;
+    }
+    if (esp_zb_channel_select(rsp, s_monitor.cfg.channel_mask & ~(1UL << current), &channel) != ESP_OK ||
+            esp_zb_channel_monitor_energy(channel) + s_monitor.cfg.energy_margin > esp_zb_channel_monitor_energy(current)) {
+        ESP_LOGW(TAG, "Failure rate %d%% on channel %d, no quieter channel", stats->failure_rate, current);
+        return;
+    }
+    ESP_LOGI(TAG, "Failure rate %d%% on channel %d, move to channel %d", stats->failure_rate, current, channel);
+    if (esp_zb_zdo_channel_change_req(channel) == ESP_OK) {
+        stats->change_count++;
+        s_monitor.counters_valid = false;
+        if (s_monitor.cfg.change_cb) {
+            s_monitor.cfg.change_cb(current, channel);
+        }
+    }
+}
+
+static void esp_zb_channel_monitor_alarm(uint8_t param)
+{
+    if (s_monitor.running && esp_zb_channel_monitor_check() != ESP_OK) {
+        esp_zb_channel_monitor_schedule(ESP_ZB_CHANNEL_RETRY_DELAY);
+    }
+}
+
+esp_err_t esp_zb_channel_monitor_check(void)
+{
+    esp_zb_zdo_energy_scan_req_param_t cmd_req = {
+        .dst_nwk_addr = ESP_ZB_CHANNEL_LOCAL_ADDR,
+        .scan_channels = s_monitor.cfg.channel_mask | (1UL << esp_zb_get_current_channel()),
+        .scan_duration = s_monitor.cfg.scan_duration,
+        .scan_count = 1,
+    };
+
+    ESP_RETURN_ON_FALSE(s_monitor.running, ESP_ERR_INVALID_STATE, TAG, "Channel monitor is not started");
+    ESP_RETURN_ON_ERROR(esp_zb_zdo_energy_scan_req(&cmd_req, esp_zb_channel_monitor_scan_cb,
+                                                   (void *)(uintptr_t)s_monitor.generation), TAG, "Failed to send energy scan");
+    esp_zb_channel_monitor_schedule(s_monitor.cfg.check_period);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_channel_monitor_start(const esp_zb_channel_monitor_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg && cfg->channel_mask && !(cfg->channel_mask & ~ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_MASK) &&
+                        cfg->scan_duration <= ESP_ZB_ZDO_NWK_UPDATE_SCAN_DURATION_MAX && cfg->failure_threshold <= 100,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid channel monitor configuration");
+    esp_zb_channel_monitor_stop();
+    memset(&s_monitor.stats, 0, sizeof(s_monitor.stats));
+    s_monitor.cfg = *cfg;
+    if (!s_monitor.cfg.check_period) {
+        s_monitor.cfg.check_period = ESP_ZB_CHANNEL_MONITOR_PERIOD;
+    }
+    if (!s_monitor.cfg.min_transmissions) {
+        s_monitor.cfg.min_transmissions = ESP_ZB_CHANNEL_MONITOR_MIN_TRANSMISSION;
+    }
+    s_monitor.counters_valid = false;
+    s_monitor.generation++;
+    s_monitor.running = true;
+    esp_zb_channel_monitor_schedule(0);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_channel_monitor_stop(void)
+{
+    if (s_monitor.running) {
+        s_monitor.running = false;
+        esp_zb_scheduler_alarm_cancel(esp_zb_channel_monitor_alarm, 0);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_channel_monitor_get_stats(esp_zb_channel_monitor_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *stats = s_monitor.stats;
+    return ESP_OK;
+}
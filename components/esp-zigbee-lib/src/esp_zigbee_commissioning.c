@@ -0,0 +1,324 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_zigbee_commissioning.h"
+#include "esp_zigbee_mem.h"
+#include "zdo/esp_zigbee_zdo_command.h"
+
+#define ESP_ZB_COMMISSIONING_BROADCAST_ADDR     0xfffc  /* all the routers and the coordinator */
+#define ESP_ZB_COMMISSIONING_CHECK_PERIOD       1000    /* time in millisecond between two checks of the join timeouts */
+
+/* the status of the device update signal */
+#define ESP_ZB_DEVICE_UPDATE_UNSECURED_JOIN     0x01
+#define ESP_ZB_DEVICE_UPDATE_DEVICE_LEFT        0x02
+
+static const char *TAG = "ESP_ZB_COMMISSIONING";
+
+typedef struct esp_zb_commissioning_join_s {
+    bool in_use;
+    esp_zb_ieee_addr_t ieee_addr;
+    int64_t since;                                  /* time in microsecond the join started */
+} esp_zb_commissioning_join_t;
+
+typedef struct esp_zb_commissioning_s {
+    bool check_scheduled;
+    esp_zb_commissioning_cfg_t cfg;
+    uint16_t router_list[ESP_ZB_COMMISSIONING_ROUTER_MAX_NUM];
+    esp_zb_commissioning_join_t join[ESP_ZB_COMMISSIONING_IN_PROGRESS_MAX_NUM];
+    int64_t start_time;
+    esp_zb_commissioning_stats_t stats;
+    esp_zb_ieee_addr_t *allowlist;                  /* sorted, so a device is looked up by binary search */
+    uint16_t allowlist_num;
+} esp_zb_commissioning_t;
+
+static esp_zb_commissioning_t s_comm;
+
+static int esp_zb_commissioning_ieee_cmp(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(esp_zb_ieee_addr_t));
+}
+
+static void esp_zb_commissioning_permit_join_cb(esp_zb_zdp_status_t zdo_status, void *user_ctx)
+{
+    if (zdo_status != ESP_ZB_ZDP_STATUS_SUCCESS) {
+        ESP_LOGW(TAG, "Permit join request to 0x%04x failed, status: 0x%x", (unsigned int)(uintptr_t)user_ctx, zdo_status);
+    }
+}
+
+static void esp_zb_commissioning_permit_join(uint16_t addr, uint8_t duration)
+{
+    esp_zb_zdo_permit_joining_req_param_t cmd_req = {
+        .dst_nwk_addr = addr,
+        .permit_duration = duration,
+        .tc_significance = 1,
+    };
+
+    esp_zb_zdo_permit_joining_req(&cmd_req, esp_zb_commissioning_permit_join_cb, (void *)(uintptr_t)addr);
+}
+
+static void esp_zb_commissioning_leave_cb(esp_zb_zdp_status_t zdo_status, void *user_ctx)
+{
+    if (zdo_status != ESP_ZB_ZDP_STATUS_SUCCESS) {
+        ESP_LOGW(TAG, "Leave request to a rejected device failed, status: 0x%x", zdo_status);
+    }
+}
+
+static void esp_zb_commissioning_window_next(uint8_t param);
+
+static void esp_zb_commissioning_window_open(void)
+{
+    uint16_t addr = s_comm.router_list[s_comm.stats.router_index];
+
+    if (!s_comm.stats.running || s_comm.stats.throttled) {
+        return;
+    }
+    ESP_LOGI(TAG, "Open joining on 0x%04hx for %d seconds", addr, s_comm.cfg.window);
+    esp_zb_commissioning_permit_join(addr, s_comm.cfg.window);
+    esp_zb_scheduler_alarm(esp_zb_commissioning_window_next, 0, s_comm.cfg.window * 1000);
+}
+
+static void esp_zb_commissioning_window_next(uint8_t param)
+{
+    if (!s_comm.stats.running) {
+        return;
+    }
+    if (s_comm.cfg.duration && esp_timer_get_time() - s_comm.start_time >= (int64_t)s_comm.cfg.duration * 1000000) {
+        esp_zb_commissioning_stop();
+        return;
+    }
+    s_comm.stats.router_index = (s_comm.stats.router_index + 1) % s_comm.cfg.router_num;
+    esp_zb_commissioning_window_open();
+}
+
+static void esp_zb_commissioning_throttle(void)
+{
+    ESP_LOGI(TAG, "Close joining, %d joins in progress", s_comm.stats.in_progress);
+    s_comm.stats.throttled = true;
+    s_comm.stats.throttle_count++;
+    esp_zb_scheduler_alarm_cancel(esp_zb_commissioning_window_next, 0);
+    esp_zb_commissioning_permit_join(ESP_ZB_COMMISSIONING_BROADCAST_ADDR, 0);
+}
+
+static esp_zb_commissioning_join_t *esp_zb_commissioning_join_find(const esp_zb_ieee_addr_t ieee_addr)
+{
+    for (uint8_t i = 0; i < ESP_ZB_COMMISSIONING_IN_PROGRESS_MAX_NUM; i++) {
+        if (s_comm.join[i].in_use && !memcmp(s_comm.join[i].ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t))) {
+            return &s_comm.join[i];
+        }
+    }
+    return NULL;
+}
+
+static void esp_zb_commissioning_join_end(esp_zb_commissioning_join_t *join, bool success)
+{
+    join->in_use = false;
+    s_comm.stats.in_progress--;
+    if (success) {
+        s_comm.stats.join_count++;
+    } else {
+        s_comm.stats.fail_count++;
+    }
+    if (s_comm.stats.throttled && s_comm.stats.in_progress < s_comm.cfg.resume_in_progress) {
+        s_comm.stats.throttled = false;
+        esp_zb_commissioning_window_open();
+    }
+}
+
+static void esp_zb_commissioning_join_check(uint8_t param)
+{
+    int64_t now = esp_timer_get_time();
+
+    s_comm.check_scheduled = false;
+    for (uint8_t i = 0; i < ESP_ZB_COMMISSIONING_IN_PROGRESS_MAX_NUM; i++) {
+        if (s_comm.join[i].in_use && now - s_comm.join[i].since >= (int64_t)s_comm.cfg.join_timeout * 1000) {
+            ESP_LOGW(TAG, "Join timeout");
+            esp_zb_commissioning_join_end(&s_comm.join[i], false);
+        }
+    }
+    if (s_comm.stats.in_progress) {
+        s_comm.check_scheduled = true;
+        esp_zb_scheduler_alarm(esp_zb_commissioning_join_check, 0, ESP_ZB_COMMISSIONING_CHECK_PERIOD);
+    }
+}
+
+static void esp_zb_commissioning_join_begin(const esp_zb_ieee_addr_t ieee_addr)
+{
+    esp_zb_commissioning_join_t *join = esp_zb_commissioning_join_find(ieee_addr);
+
+    if (join) {
+        join->since = esp_timer_get_time();
+        return;
+    }
+    for (uint8_t i = 0; i < ESP_ZB_COMMISSIONING_IN_PROGRESS_MAX_NUM && !join; i++) {
+        if (!s_comm.join[i].in_use) {
+            join = &s_comm.join[i];
+        }
+    }
+    if (!join) {
+        ESP_LOGW(TAG, "Too many joins in progress to track");
+        return;
+    }
+    join->in_use = true;
+    memcpy(join->ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t));
+    join->since = esp_timer_get_time();
+    s_comm.stats.in_progress++;
+    if (!s_comm.stats.throttled && s_comm.stats.in_progress >= s_comm.cfg.max_in_progress) {
+        esp_zb_commissioning_throttle();
+    }
+    if (!s_comm.check_scheduled) {
+        s_comm.check_scheduled = true;
+        esp_zb_scheduler_alarm(esp_zb_commissioning_join_check, 0, ESP_ZB_COMMISSIONING_CHECK_PERIOD);
+    }
+}
+
+/* ask a device which is not on the allowlist to leave, return true if it is rejected */
+static bool esp_zb_commissioning_admit_check(const esp_zb_ieee_addr_t ieee_addr, uint16_t short_addr)
+{
+    esp_zb_zdo_mgmt_leave_req_param_t cmd_req;
+
+    if (!s_comm.allowlist_num ||
+            bsearch(ieee_addr, s_comm.allowlist, s_comm.allowlist_num, sizeof(esp_zb_ieee_addr_t), esp_zb_commissioning_ieee_cmp)) {
+        return false;
+    }
+    ESP_LOGW(TAG, "Device 0x%04hx is not on the allowlist, ask it to leave", short_addr);
+    memset(&cmd_req, 0, sizeof(cmd_req));
+    memcpy(cmd_req.device_address, ieee_addr, sizeof(esp_zb_ieee_addr_t));
+    cmd_req.dst_nwk_addr = short_addr;
+    esp_zb_zdo_device_leave_req(&cmd_req, esp_zb_commissioning_leave_cb, NULL);
+    s_comm.stats.reject_count++;
+    return true;
+}
+
+esp_err_t esp_zb_commissioning_start(const esp_zb_commissioning_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg && cfg->window && cfg->window < 0xff, ESP_ERR_INVALID_ARG, TAG, "Invalid commissioning configuration");
+    ESP_RETURN_ON_FALSE(cfg->router_num <= ESP_ZB_COMMISSIONING_ROUTER_MAX_NUM && (cfg->router_list || !cfg->router_num),
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid router list");
+    ESP_RETURN_ON_FALSE(cfg->max_in_progress && cfg->max_in_progress <= ESP_ZB_COMMISSIONING_IN_PROGRESS_MAX_NUM &&
+                        cfg->resume_in_progress < cfg->max_in_progress, ESP_ERR_INVALID_ARG, TAG, "Invalid join in progress limits");
+    esp_zb_commissioning_stop();
+    memset(s_comm.join, 0, sizeof(s_comm.join));
+    memset(&s_comm.stats, 0, sizeof(s_comm.stats));
+    s_comm.cfg = *cfg;
+    if (cfg->router_num) {
+        memcpy(s_comm.router_list, cfg->router_list, cfg->router_num * sizeof(uint16_t));
+    } else {
+        s_comm.router_list[0] = 0x0000;
+        s_comm.cfg.router_num = 1;
+    }
+    s_comm.cfg.router_list = s_comm.router_list;
+    if (!s_comm.cfg.join_timeout) {
+        s_comm.cfg.join_timeout = ESP_ZB_COMMISSIONING_JOIN_TIMEOUT;
+    }
+    /* fewer than 0 joins in progress is never reached, so 0 means to resume once all the joins are complete */
+    if (!s_comm.cfg.resume_in_progress) {
+        s_comm.cfg.resume_in_progress = 1;
+    }
+    s_comm.start_time = esp_timer_get_time();
+    s_comm.stats.running = true;
+    esp_zb_commissioning_window_open();
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_commissioning_stop(void)
+{
+    if (s_comm.stats.running) {
+        s_comm.stats.running = false;
+        s_comm.stats.throttled = false;
+        esp_zb_scheduler_alarm_cancel(esp_zb_commissioning_window_next, 0);
+        esp_zb_commissioning_permit_join(ESP_ZB_COMMISSIONING_BROADCAST_ADDR, 0);
+        ESP_LOGI(TAG, "Commissioning stopped, joins: %lu, failures: %lu, rejected: %lu", (unsigned long)s_comm.stats.join_count,
+                 (unsigned long)s_comm.stats.fail_count, (unsigned long)s_comm.stats.reject_count);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_commissioning_allowlist_set(const esp_zb_ieee_addr_t *ieee_list, uint16_t num)
+{
+    esp_zb_ieee_addr_t *allowlist = NULL;
+
+    ESP_RETURN_ON_FALSE((ieee_list || !num) && num <= ESP_ZB_COMMISSIONING_ALLOWLIST_MAX_NUM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid allowlist");
+    if (num) {
+        allowlist = esp_zb_mem_malloc(ESP_ZB_MEM_TAG_NWK, num * sizeof(esp_zb_ieee_addr_t));
+        ESP_RETURN_ON_FALSE(allowlist, ESP_ERR_NO_MEM, TAG, "No memory for the allowlist");
+        memcpy(allowlist, ieee_list, num * sizeof(esp_zb_ieee_addr_t));
+        qsort(allowlist, num, sizeof(esp_zb_ieee_addr_t), esp_zb_commissioning_ieee_cmp);
+    }
+    esp_zb_mem_free(s_comm.allowlist);
+    s_comm.allowlist = allowlist;
+    s_comm.allowlist_num = num;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_commissioning_get_stats(esp_zb_commissioning_stats_t *stats)
+{
+    int64_t elapsed = 0;
+
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    elapsed = (esp_timer_get_time() - s_comm.start_time) / 1000;
+    s_comm.stats.join_rate = elapsed > 0 ? (uint32_t)((int64_t)s_comm.stats.join_count * 1000000 / elapsed) : 0;
+    *stats = s_comm.stats;
+    return ESP_OK;
+}
+
+void esp_zb_commissioning_signal_handle(esp_zb_app_signal_t *signal_s)
+{
+    uint32_t sig_type = *signal_s->p_app_signal;
+
+    if (signal_s->esp_err_status != ESP_OK) {
+        return;
+    }
+    switch (sig_type) {
+    case ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE: {
+        esp_zb_zdo_signal_device_update_params_t *params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+        esp_zb_commissioning_join_t *join = esp_zb_commissioning_join_find(params->long_addr);
+
+        if (params->status == ESP_ZB_DEVICE_UPDATE_DEVICE_LEFT) {
+            if (join) {
+                esp_zb_commissioning_join_end(join, false);
+            }
+        } else if (params->status == ESP_ZB_DEVICE_UPDATE_UNSECURED_JOIN && s_comm.stats.running) {
+            /* only a device joining without the network key is checked, a device of the network rejoining is left alone */
+            if (!esp_zb_commissioning_admit_check(params->long_addr, params->short_addr)) {
+                esp_zb_commissioning_join_begin(params->long_addr);
+            } else if (join) {
+                esp_zb_commissioning_join_end(join, false);
+            }
+        }
+        break;
+    }
+    case ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE: {
+        esp_zb_zdo_signal_device_annce_params_t *params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+        esp_zb_commissioning_join_t *join = esp_zb_commissioning_join_find(params->ieee_addr);
+
+        /* the device was checked at its unsecured join, an announcement alone may come from a rejoin */
+        if (join) {
+            esp_zb_commissioning_join_end(join, true);
+        } else if (s_comm.stats.running) {
+            /* a device joining the coordinator directly is not reported by a device update */
+            s_comm.stats.join_count++;
+        }
+        break;
+    }
+    case ESP_ZB_ZDO_SIGNAL_LEAVE_INDICATION: {
+        esp_zb_zdo_signal_leave_indication_params_t *params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+        esp_zb_commissioning_join_t *join = esp_zb_commissioning_join_find(params->device_addr);
+
+        if (join) {
+            esp_zb_commissioning_join_end(join, false);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
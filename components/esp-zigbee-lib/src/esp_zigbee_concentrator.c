@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "zboss_api.h"
+#include "esp_zigbee_concentrator.h"
+
+/* the network status codes of the route failures, refer to Zigbee specification 3.4.3.3.1 */
+#define ESP_ZB_NWK_STATUS_NO_ROUTE_AVAILABLE            0x00
+#define ESP_ZB_NWK_STATUS_TREE_LINK_FAILURE             0x01
+#define ESP_ZB_NWK_STATUS_NON_TREE_LINK_FAILURE         0x02
+#define ESP_ZB_NWK_STATUS_SOURCE_ROUTE_FAILURE          0x0b
+#define ESP_ZB_NWK_STATUS_MANY_TO_ONE_ROUTE_FAILURE     0x0c
+
+static const char *TAG = "ESP_ZB_CONCENTRATOR";
+
+typedef struct esp_zb_concentrator_s {
+    esp_zb_concentrator_cfg_t cfg;
+    esp_zb_concentrator_stats_t stats;
+    int64_t last_repair;                            /* time in microsecond of the last route repair */
+    uint8_t failure_num;
+    esp_zb_concentrator_route_failure_t failure[ESP_ZB_CONCENTRATOR_FAILURE_MAX_NUM];
+} esp_zb_concentrator_t;
+
+static esp_zb_concentrator_t s_concentrator;
+
+/* record a route failure, the destination with the oldest failure is replaced when the table is full */
+static void esp_zb_concentrator_failure_record(uint16_t short_addr, uint8_t status, int64_t now)
+{
+    esp_zb_concentrator_route_failure_t *failure = NULL;
+
+    for (uint8_t i = 0; i < s_concentrator.failure_num && !failure; i++) {
+        if (s_concentrator.failure[i].short_addr == short_addr) {
+            failure = &s_concentrator.failure[i];
+        }
+    }
+    if (!failure && s_concentrator.failure_num < ESP_ZB_CONCENTRATOR_FAILURE_MAX_NUM) {
+        failure = &s_concentrator.failure[s_concentrator.failure_num++];
+        memset(failure, 0, sizeof(esp_zb_concentrator_route_failure_t));
+    }
+    if (!failure) {
+        failure = &s_concentrator.failure[0];
+        for (uint8_t i = 1; i < s_concentrator.failure_num; i++) {
+            if (s_concentrator.failure[i].last_time < failure->last_time) {
+                failure = &s_concentrator.failure[i];
+            }
+        }
+        memset(failure, 0, sizeof(esp_zb_concentrator_route_failure_t));
+    }
+    failure->short_addr = short_addr;
+    failure->last_status = status;
+    failure->count++;
+    failure->last_time = now;
+}
+
+static void esp_zb_concentrator_repair(int64_t now)
+{
+    if (s_concentrator.stats.repair_count && now - s_concentrator.last_repair < (int64_t)s_concentrator.cfg.repair_holdoff * 1000) {
+        s_concentrator.stats.repair_skip_count++;
+        return;
+    }
+    /* restarting the concentrator mode sends a many-to-one route request at once */
+    zb_start_concentrator_mode(s_concentrator.cfg.radius, s_concentrator.cfg.disc_time);
+    s_concentrator.last_repair = now;
+    s_concentrator.stats.repair_count++;
+}
+
+esp_err_t esp_zb_concentrator_start(const esp_zb_concentrator_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid concentrator configuration");
+    memset(&s_concentrator, 0, sizeof(s_concentrator));
+    s_concentrator.cfg = *cfg;
+    if (!s_concentrator.cfg.disc_time) {
+        s_concentrator.cfg.disc_time = ESP_ZB_CONCENTRATOR_DISC_TIME;
+    }
+    if (!s_concentrator.cfg.repair_holdoff) {
+        s_concentrator.cfg.repair_holdoff = ESP_ZB_CONCENTRATOR_REPAIR_HOLDOFF;
+    }
+    zb_start_concentrator_mode(s_concentrator.cfg.radius, s_concentrator.cfg.disc_time);
+    s_concentrator.stats.running = true;
+    ESP_LOGI(TAG, "Concentrator mode started, many-to-one route request every %" PRIu32 " seconds", s_concentrator.cfg.disc_time);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_concentrator_stop(void)
+{
+    if (s_concentrator.stats.running) {
+        zb_stop_concentrator_mode();
+        s_concentrator.stats.running = false;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_concentrator_get_stats(esp_zb_concentrator_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *stats = s_concentrator.stats;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_concentrator_get_route_failures(esp_zb_concentrator_route_failure_t *failures, uint8_t max_num, uint8_t *failure_num)
+{
+    uint8_t num = 0;
+
+    ESP_RETURN_ON_FALSE(failure_num && (failures || !max_num), ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    /* insertion sort of the most recent failures, the table is small */
+    for (uint8_t i = 0; i < s_concentrator.failure_num; i++) {
+        const esp_zb_concentrator_route_failure_t *failure = &s_concentrator.failure[i];
+        uint8_t pos = num;
+
+        while (pos > 0 && failures[pos - 1].last_time < failure->last_time) {
+            if (pos < max_num) {
+                failures[pos] = failures[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max_num) {
+            failures[pos] = *failure;
+            num = num < max_num ? num + 1 : num;
+        }
+    }
+    *failure_num = num;
+    return ESP_OK;
+}
+
+void esp_zb_concentrator_signal_handle(esp_zb_app_signal_t *signal_s)
+{
+    zb_zdo_signal_nlme_status_indication_params_t *params = NULL;
+    int64_t now = 0;
+    uint8_t status = 0;
+
+    if (*signal_s->p_app_signal != ESP_ZB_NLME_STATUS_INDICATION || !s_concentrator.stats.running) {
+        return;
+    }
+    params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+    status = params->nlme_status.status;
+    if (status != ESP_ZB_NWK_STATUS_NO_ROUTE_AVAILABLE && status != ESP_ZB_NWK_STATUS_TREE_LINK_FAILURE &&
+            status != ESP_ZB_NWK_STATUS_NON_TREE_LINK_FAILURE && status != ESP_ZB_NWK_STATUS_SOURCE_ROUTE_FAILURE &&
+            status != ESP_ZB_NWK_STATUS_MANY_TO_ONE_ROUTE_FAILURE) {
+        return;
+    }
+    now = esp_timer_get_time();
+    s_concentrator.stats.route_failure_count++;
+    esp_zb_concentrator_failure_record(params->nlme_status.network_addr, status, now);
+    ESP_LOGD(TAG, "Route failure 0x%02x to 0x%04hx", status, params->nlme_status.network_addr);
+    if (status == ESP_ZB_NWK_STATUS_SOURCE_ROUTE_FAILURE) {
+        s_concentrator.stats.source_route_failure_count++;
+        esp_zb_concentrator_repair(now);
+    } else if (status == ESP_ZB_NWK_STATUS_MANY_TO_ONE_ROUTE_FAILURE) {
+        s_concentrator.stats.many_to_one_failure_count++;
+        esp_zb_concentrator_repair(now);
+    }
+}
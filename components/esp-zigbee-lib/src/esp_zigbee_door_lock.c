@@ -0,0 +1,819 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "nvs.h"
+#include "esp_zigbee_door_lock.h"
+#include "esp_zigbee_mem.h"
+#include "esp_zigbee_time.h"
+
+#define ESP_ZB_DOOR_LOCK_NVS_NAMESPACE      "zb_door_lock"
+#define ESP_ZB_DOOR_LOCK_PAGE_SIZE          16          /* number of user records per NVS blob */
+#define ESP_ZB_DOOR_LOCK_PAGE_NUM           ((ESP_ZB_DOOR_LOCK_USER_MAX_NUM + ESP_ZB_DOOR_LOCK_PAGE_SIZE - 1) / ESP_ZB_DOOR_LOCK_PAGE_SIZE)
+#define ESP_ZB_DOOR_LOCK_INDEX_EMPTY        0x0000
+#define ESP_ZB_DOOR_LOCK_CODE_MAX_LEN       ESP_ZB_DOOR_LOCK_RFID_MAX_LEN
+
+/* the status of the user management responses */
+#define ESP_ZB_DOOR_LOCK_RESP_SUCCESS       0x00
+#define ESP_ZB_DOOR_LOCK_RESP_FAILURE       0x01
+#define ESP_ZB_DOOR_LOCK_RESP_MEMORY_FULL   0x02
+#define ESP_ZB_DOOR_LOCK_RESP_DUPLICATE     0x03
+#define ESP_ZB_DOOR_LOCK_RESP_INVALID_FIELD 0x85
+#define ESP_ZB_DOOR_LOCK_RESP_NOT_FOUND     0x8b
+
+static const char *TAG = "ESP_ZB_DOOR_LOCK";
+
+/* the compact user record, as stored in RAM and in NVS, the user id is the index of the record */
+typedef struct esp_zb_door_lock_record_s {
+    uint8_t status;
+    uint8_t type;
+    uint8_t pin_len;
+    uint8_t rfid_len;
+    uint8_t pin[ESP_ZB_DOOR_LOCK_PIN_MAX_LEN];
+    uint8_t rfid[ESP_ZB_DOOR_LOCK_RFID_MAX_LEN];
+    esp_zb_door_lock_weekday_schedule_t weekday[ESP_ZB_DOOR_LOCK_WEEKDAY_SCHEDULE_NUM];
+    esp_zb_door_lock_yearday_schedule_t yearday[ESP_ZB_DOOR_LOCK_YEARDAY_SCHEDULE_NUM];
+} esp_zb_door_lock_record_t;
+
+typedef struct esp_zb_door_lock_store_s {
+    bool initialized;
+    uint16_t user_num;
+    esp_zb_door_lock_record_t *record;
+    uint16_t index_mask;                            /* the index tables hold index_mask + 1 entries */
+    uint16_t *index[2];                             /* open addressing hash index of the PIN and RFID codes, holds user id + 1 */
+    uint32_t dirty_page;                            /* bitmap of the pages to write back to NVS */
+} esp_zb_door_lock_store_t;
+
+static esp_zb_door_lock_store_t s_store;
+
+static uint32_t esp_zb_door_lock_hash(const uint8_t *code, uint8_t len)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (uint8_t i = 0; i < len; i++) {
+        hash = (hash ^ code[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static const uint8_t *esp_zb_door_lock_record_code(const esp_zb_door_lock_record_t *record, esp_zb_door_lock_credential_type_t type,
+                                                   uint8_t *len)
+{
+    *len = type == ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN ? record->pin_len : record->rfid_len;
+    return type == ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN ? record->pin : record->rfid;
+}
+
+/* compare the whole code buffer whatever the content, so the time does not leak how many bytes match */
+static bool esp_zb_door_lock_code_equal(const uint8_t *stored, uint8_t stored_len, const uint8_t *code, uint8_t len)
+{
+    uint8_t diff = stored_len ^ len;
+
+    for (uint8_t i = 0; i < ESP_ZB_DOOR_LOCK_CODE_MAX_LEN; i++) {
+        uint8_t a = i < stored_len ? stored[i] : 0;
+        uint8_t b = i < len ? code[i] : 0;
+        diff |= a ^ b;
+    }
+    return diff == 0;
+}
+
+static int esp_zb_door_lock_index_find(esp_zb_door_lock_credential_type_t type, const uint8_t *code, uint8_t len)
+{
+    uint16_t *index = s_store.index[type];
+    uint16_t pos = esp_zb_door_lock_hash(code, len) & s_store.index_mask;
+
+    for (uint16_t probe = 0; probe <= s_store.index_mask; probe++, pos = (pos + 1) & s_store.index_mask) {
+        uint8_t stored_len = 0;
+        const uint8_t *stored = NULL;
+
+        if (index[pos] == ESP_ZB_DOOR_LOCK_INDEX_EMPTY) {
+            break;
+        }
+        stored = esp_zb_door_lock_record_code(&s_store.record[index[pos] - 1], type, &stored_len);
+        if (esp_zb_door_lock_code_equal(stored, stored_len, code, len)) {
+            return index[pos] - 1;
+        }
+    }
+    return -1;
+}
+
+static void esp_zb_door_lock_index_insert(esp_zb_door_lock_credential_type_t type, uint16_t user_id)
+{
+    uint16_t *index = s_store.index[type];
+    uint8_t len = 0;
+    const uint8_t *code = esp_zb_door_lock_record_code(&s_store.record[user_id], type, &len);
+    uint16_t pos = esp_zb_door_lock_hash(code, len) & s_store.index_mask;
+
+    if (len == 0) {
+        return;
+    }
+    /* the table holds at least twice the users, a free slot always exists */
+    while (index[pos] != ESP_ZB_DOOR_LOCK_INDEX_EMPTY) {
+        pos = (pos + 1) & s_store.index_mask;
+    }
+    index[pos] = user_id + 1;
+}
+
+/* the slot the code of an index entry hashes to */
+static uint16_t esp_zb_door_lock_index_home(esp_zb_door_lock_credential_type_t type, uint16_t entry)
+{
+    uint8_t len = 0;
+    const uint8_t *code = esp_zb_door_lock_record_code(&s_store.record[entry - 1], type, &len);
+
+    return esp_zb_door_lock_hash(code, len) & s_store.index_mask;
+}
+
+/* remove by shifting the following entries of the probe sequence back, so no tombstone is left and a lookup stops at
+ * the first empty slot whatever the history of the table */
+static void esp_zb_door_lock_index_remove(esp_zb_door_lock_credential_type_t type, uint16_t user_id)
+{
+    uint16_t *index = s_store.index[type];
+    uint8_t len = 0;
+    const uint8_t *code = esp_zb_door_lock_record_code(&s_store.record[user_id], type, &len);
+    uint16_t pos = esp_zb_door_lock_hash(code, len) & s_store.index_mask;
+    uint16_t next = 0;
+
+    if (len == 0) {
+        return;
+    }
+    for (uint16_t probe = 0; index[pos] != user_id + 1; probe++) {
+        if (probe > s_store.index_mask || index[pos] == ESP_ZB_DOOR_LOCK_INDEX_EMPTY) {
+            return;
+        }
+        pos = (pos + 1) & s_store.index_mask;
+    }
+    next = pos;
+    while (true) {
+        uint16_t home = 0;
+
+        next = (next + 1) & s_store.index_mask;
+        if (index[next] == ESP_ZB_DOOR_LOCK_INDEX_EMPTY) {
+            break;
+        }
+        /* the entry moves to the hole unless its home lies cyclically in (pos, next] */
+        home = esp_zb_door_lock_index_home(type, index[next]);
+        if (((next - home) & s_store.index_mask) >= ((next - pos) & s_store.index_mask)) {
+            index[pos] = index[next];
+            pos = next;
+        }
+    }
+    index[pos] = ESP_ZB_DOOR_LOCK_INDEX_EMPTY;
+}
+
+static void esp_zb_door_lock_index_rebuild(void)
+{
+    memset(s_store.index[0], 0, (s_store.index_mask + 1) * sizeof(uint16_t));
+    memset(s_store.index[1], 0, (s_store.index_mask + 1) * sizeof(uint16_t));
+    for (uint16_t i = 0; i < s_store.user_num; i++) {
+        if (s_store.record[i].status != ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE) {
+            esp_zb_door_lock_index_insert(ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN, i);
+            esp_zb_door_lock_index_insert(ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID, i);
+        }
+    }
+}
+
+static void esp_zb_door_lock_page_dirty(uint16_t user_id)
+{
+    s_store.dirty_page |= 1UL << (user_id / ESP_ZB_DOOR_LOCK_PAGE_SIZE);
+}
+
+static esp_err_t esp_zb_door_lock_flush(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = ESP_OK;
+    char key[16];
+
+    if (!s_store.dirty_page) {
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(nvs_open(ESP_ZB_DOOR_LOCK_NVS_NAMESPACE, NVS_READWRITE, &handle), TAG, "Failed to open NVS");
+    for (uint8_t page = 0; page < ESP_ZB_DOOR_LOCK_PAGE_NUM && ret == ESP_OK; page++) {
+        uint16_t first = page * ESP_ZB_DOOR_LOCK_PAGE_SIZE;
+        uint16_t num = s_store.user_num - first < ESP_ZB_DOOR_LOCK_PAGE_SIZE ? s_store.user_num - first : ESP_ZB_DOOR_LOCK_PAGE_SIZE;
+
+        if (!(s_store.dirty_page & (1UL << page))) {
+            continue;
+        }
+        snprintf(key, sizeof(key), "user_%02x", page);
+        ret = nvs_set_blob(handle, key, &s_store.record[first], num * sizeof(esp_zb_door_lock_record_t));
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to write the users to NVS");
+    s_store.dirty_page = 0;
+    return ESP_OK;
+}
+
+static void esp_zb_door_lock_load(void)
+{
+    nvs_handle_t handle;
+    char key[16];
+
+    if (nvs_open(ESP_ZB_DOOR_LOCK_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    for (uint8_t page = 0; page * ESP_ZB_DOOR_LOCK_PAGE_SIZE < s_store.user_num; page++) {
+        uint16_t first = page * ESP_ZB_DOOR_LOCK_PAGE_SIZE;
+        size_t size = 0;
+
+        snprintf(key, sizeof(key), "user_%02x", page);
+        /* a page of a different layout or user number is dropped rather than misread */
+        if (nvs_get_blob(handle, key, NULL, &size) != ESP_OK || size % sizeof(esp_zb_door_lock_record_t) ||
+                first + size / sizeof(esp_zb_door_lock_record_t) > s_store.user_num) {
+            continue;
+        }
+        nvs_get_blob(handle, key, &s_store.record[first], &size);
+    }
+    nvs_close(handle);
+}
+
+static bool esp_zb_door_lock_record_is_empty(const esp_zb_door_lock_record_t *record)
+{
+    return record->pin_len == 0 && record->rfid_len == 0;
+}
+
+static void esp_zb_door_lock_record_reset(uint16_t user_id)
+{
+    esp_zb_door_lock_index_remove(ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN, user_id);
+    esp_zb_door_lock_index_remove(ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID, user_id);
+    memset(&s_store.record[user_id], 0, sizeof(esp_zb_door_lock_record_t));
+    esp_zb_door_lock_page_dirty(user_id);
+}
+
+/* whether the status and type are those of an occupied user, the reserved values are rejected */
+static bool esp_zb_door_lock_user_valid(uint8_t status, uint8_t type)
+{
+    return (status == ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_ENABLED || status == ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_DISABLED) &&
+           type <= ESP_ZB_DOOR_LOCK_USER_TYPE_NON_ACCESS;
+}
+
+static esp_err_t esp_zb_door_lock_code_set(uint16_t user_id, esp_zb_door_lock_credential_type_t type, const uint8_t *code, uint8_t len)
+{
+    esp_zb_door_lock_record_t *record = &s_store.record[user_id];
+    int owner = -1;
+
+    if (len > (type == ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN ? ESP_ZB_DOOR_LOCK_PIN_MAX_LEN : ESP_ZB_DOOR_LOCK_RFID_MAX_LEN)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len) {
+        owner = esp_zb_door_lock_index_find(type, code, len);
+        if (owner >= 0 && owner != user_id) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    esp_zb_door_lock_index_remove(type, user_id);
+    if (type == ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN) {
+        memset(record->pin, 0, sizeof(record->pin));
+        if (len) {
+            memcpy(record->pin, code, len);
+        }
+        record->pin_len = len;
+    } else {
+        memset(record->rfid, 0, sizeof(record->rfid));
+        if (len) {
+            memcpy(record->rfid, code, len);
+        }
+        record->rfid_len = len;
+    }
+    esp_zb_door_lock_index_insert(type, user_id);
+    esp_zb_door_lock_page_dirty(user_id);
+    return ESP_OK;
+}
+
+static esp_err_t esp_zb_door_lock_user_apply(const esp_zb_door_lock_user_t *user)
+{
+    esp_zb_door_lock_record_t *record = NULL;
+    int owner = -1;
+
+    ESP_RETURN_ON_FALSE(user->user_id < s_store.user_num, ESP_ERR_INVALID_ARG, TAG, "Invalid user id: %d", user->user_id);
+    ESP_RETURN_ON_FALSE(user->pin_len <= ESP_ZB_DOOR_LOCK_PIN_MAX_LEN && user->rfid_len <= ESP_ZB_DOOR_LOCK_RFID_MAX_LEN,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid code length of user %d", user->user_id);
+    if (user->status == ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE) {
+        esp_zb_door_lock_record_reset(user->user_id);
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_FALSE(esp_zb_door_lock_user_valid(user->status, user->type), ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid status or type of user %d", user->user_id);
+    /* reject the duplicates before anything is changed, so a failed user is left untouched */
+    if (user->pin_len) {
+        owner = esp_zb_door_lock_index_find(ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN, user->pin, user->pin_len);
+        ESP_RETURN_ON_FALSE(owner < 0 || owner == user->user_id, ESP_ERR_INVALID_STATE, TAG, "Duplicate PIN code of user %d", user->user_id);
+    }
+    if (user->rfid_len) {
+        owner = esp_zb_door_lock_index_find(ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID, user->rfid, user->rfid_len);
+        ESP_RETURN_ON_FALSE(owner < 0 || owner == user->user_id, ESP_ERR_INVALID_STATE, TAG, "Duplicate RFID code of user %d", user->user_id);
+    }
+    esp_zb_door_lock_code_set(user->user_id, ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN, user->pin, user->pin_len);
+    esp_zb_door_lock_code_set(user->user_id, ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID, user->rfid, user->rfid_len);
+    record = &s_store.record[user->user_id];
+    record->status = user->status;
+    record->type = user->type;
+    memcpy(record->weekday, user->weekday, sizeof(record->weekday));
+    memcpy(record->yearday, user->yearday, sizeof(record->yearday));
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_door_lock_store_init(uint16_t user_num)
+{
+    uint16_t index_size = 1;
+
+    ESP_RETURN_ON_FALSE(!s_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Credential store is already initialized");
+    ESP_RETURN_ON_FALSE(user_num > 0 && user_num <= ESP_ZB_DOOR_LOCK_USER_MAX_NUM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid user number: %d", user_num);
+    /* keep the load factor of the index under one half, so the probe sequences stay short */
+    while (index_size < user_num * 2) {
+        index_size <<= 1;
+    }
+    s_store.record = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZCL, user_num, sizeof(esp_zb_door_lock_record_t));
+    s_store.index[0] = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZCL, index_size, sizeof(uint16_t));
+    s_store.index[1] = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZCL, index_size, sizeof(uint16_t));
+    if (!s_store.record || !s_store.index[0] || !s_store.index[1]) {
+        esp_zb_mem_free(s_store.record);
+        esp_zb_mem_free(s_store.index[0]);
+        esp_zb_mem_free(s_store.index[1]);
+        memset(&s_store, 0, sizeof(s_store));
+        return ESP_ERR_NO_MEM;
+    }
+    s_store.user_num = user_num;
+    s_store.index_mask = index_size - 1;
+    esp_zb_door_lock_load();
+    esp_zb_door_lock_index_rebuild();
+    s_store.initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_door_lock_store_deinit(void)
+{
+    if (s_store.initialized) {
+        esp_zb_door_lock_flush();
+        esp_zb_mem_free(s_store.record);
+        esp_zb_mem_free(s_store.index[0]);
+        esp_zb_mem_free(s_store.index[1]);
+        memset(&s_store, 0, sizeof(s_store));
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_door_lock_user_set_batch(const esp_zb_door_lock_user_t *users, uint16_t user_num)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(s_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Credential store is not initialized");
+    ESP_RETURN_ON_FALSE(users || user_num == 0, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    for (uint16_t i = 0; i < user_num && ret == ESP_OK; i++) {
+        ret = esp_zb_door_lock_user_apply(&users[i]);
+    }
+    esp_zb_door_lock_flush();
+    return ret;
+}
+
+esp_err_t esp_zb_door_lock_user_get_batch(uint16_t start_id, esp_zb_door_lock_user_t *users, uint16_t max_num, uint16_t *user_num)
+{
+    uint16_t num = 0;
+
+    ESP_RETURN_ON_FALSE(s_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Credential store is not initialized");
+    ESP_RETURN_ON_FALSE(user_num && (users || max_num == 0), ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    for (uint16_t i = start_id; i < s_store.user_num && num < max_num; i++) {
+        const esp_zb_door_lock_record_t *record = &s_store.record[i];
+
+        if (record->status == ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE) {
+            continue;
+        }
+        users[num].user_id = i;
+        users[num].status = record->status;
+        users[num].type = record->type;
+        users[num].pin_len = record->pin_len;
+        memcpy(users[num].pin, record->pin, sizeof(record->pin));
+        users[num].rfid_len = record->rfid_len;
+        memcpy(users[num].rfid, record->rfid, sizeof(record->rfid));
+        memcpy(users[num].weekday, record->weekday, sizeof(record->weekday));
+        memcpy(users[num].yearday, record->yearday, sizeof(record->yearday));
+        num++;
+    }
+    *user_num = num;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_door_lock_credential_clear_all(esp_zb_door_lock_credential_type_t type, bool all)
+{
+    ESP_RETURN_ON_FALSE(s_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Credential store is not initialized");
+    for (uint16_t i = 0; i < s_store.user_num; i++) {
+        esp_zb_door_lock_record_t *record = &s_store.record[i];
+
+        if (record->status == ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE) {
+            continue;
+        }
+        if (type == ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN) {
+            record->pin_len = 0;
+            memset(record->pin, 0, sizeof(record->pin));
+        } else {
+            record->rfid_len = 0;
+            memset(record->rfid, 0, sizeof(record->rfid));
+        }
+        if (all || esp_zb_door_lock_record_is_empty(record)) {
+            memset(record, 0, sizeof(esp_zb_door_lock_record_t));
+        }
+        esp_zb_door_lock_page_dirty(i);
+    }
+    esp_zb_door_lock_index_rebuild();
+    return esp_zb_door_lock_flush();
+}
+
+static bool esp_zb_door_lock_schedule_allow(const esp_zb_door_lock_record_t *record)
+{
+    uint32_t local_time = 0;
+
+    switch (record->type) {
+    case ESP_ZB_DOOR_LOCK_USER_TYPE_UNRESTRICTED:
+    case ESP_ZB_DOOR_LOCK_USER_TYPE_MASTER:
+        return true;
+    case ESP_ZB_DOOR_LOCK_USER_TYPE_WEEK_DAY_SCHEDULE:
+    case ESP_ZB_DOOR_LOCK_USER_TYPE_YEAR_DAY_SCHEDULE:
+        break;
+    default:
+        /* non access users and the types this lock does not know are denied */
+        return false;
+    }
+    if (esp_zb_time_get_local(&local_time) != ESP_OK) {
+        return false;
+    }
+    if (record->type == ESP_ZB_DOOR_LOCK_USER_TYPE_WEEK_DAY_SCHEDULE) {
+        /* 1 January 2000 is a Saturday, bit 0 of the days mask is Sunday */
+        uint8_t day = (local_time / 86400 + 6) % 7;
+        uint16_t minute = (local_time % 86400) / 60;
+
+        for (uint8_t i = 0; i < ESP_ZB_DOOR_LOCK_WEEKDAY_SCHEDULE_NUM; i++) {
+            const esp_zb_door_lock_weekday_schedule_t *schedule = &record->weekday[i];
+
+            if ((schedule->days_mask & (1 << day)) && minute >= schedule->start_hour * 60 + schedule->start_minute &&
+                    minute <= schedule->end_hour * 60 + schedule->end_minute) {
+                return true;
+            }
+        }
+        return false;
+    }
+    for (uint8_t i = 0; i < ESP_ZB_DOOR_LOCK_YEARDAY_SCHEDULE_NUM; i++) {
+        if (record->yearday[i].start && local_time >= record->yearday[i].start && local_time <= record->yearday[i].end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t esp_zb_door_lock_credential_verify(esp_zb_door_lock_credential_type_t type, const uint8_t *code, uint8_t len,
+                                             uint16_t *user_id)
+{
+    const esp_zb_door_lock_record_t *record = NULL;
+    int owner = -1;
+
+    ESP_RETURN_ON_FALSE(s_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Credential store is not initialized");
+    ESP_RETURN_ON_FALSE(type <= ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID && (code || len == 0), ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    if (len == 0 || len > ESP_ZB_DOOR_LOCK_CODE_MAX_LEN) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    owner = esp_zb_door_lock_index_find(type, code, len);
+    if (owner < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (user_id) {
+        *user_id = owner;
+    }
+    record = &s_store.record[owner];
+    if (record->status != ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_ENABLED || !esp_zb_door_lock_schedule_allow(record)) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    return ESP_OK;
+}
+
+/* ZCL payload parsing and building */
+
+typedef struct esp_zb_door_lock_buf_s {
+    uint8_t *data;
+    uint16_t size;
+    uint16_t pos;
+    bool overflow;
+} esp_zb_door_lock_buf_t;
+
+static void esp_zb_door_lock_put(esp_zb_door_lock_buf_t *buf, const void *data, uint16_t len)
+{
+    if (buf->pos + len > buf->size) {
+        buf->overflow = true;
+        return;
+    }
+    memcpy(buf->data + buf->pos, data, len);
+    buf->pos += len;
+}
+
+static void esp_zb_door_lock_put_u8(esp_zb_door_lock_buf_t *buf, uint8_t value)
+{
+    esp_zb_door_lock_put(buf, &value, sizeof(value));
+}
+
+static void esp_zb_door_lock_put_u16(esp_zb_door_lock_buf_t *buf, uint16_t value)
+{
+    uint8_t data[2] = {value & 0xff, value >> 8};
+
+    esp_zb_door_lock_put(buf, data, sizeof(data));
+}
+
+static void esp_zb_door_lock_put_u32(esp_zb_door_lock_buf_t *buf, uint32_t value)
+{
+    uint8_t data[4] = {value & 0xff, (value >> 8) & 0xff, (value >> 16) & 0xff, value >> 24};
+
+    esp_zb_door_lock_put(buf, data, sizeof(data));
+}
+
+static uint16_t esp_zb_door_lock_get_u16(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+static uint32_t esp_zb_door_lock_get_u32(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint8_t esp_zb_door_lock_status_resp(esp_err_t ret)
+{
+    switch (ret) {
+    case ESP_OK:
+        return ESP_ZB_DOOR_LOCK_RESP_SUCCESS;
+    case ESP_ERR_INVALID_STATE:
+        return ESP_ZB_DOOR_LOCK_RESP_DUPLICATE;
+    case ESP_ERR_NO_MEM:
+        return ESP_ZB_DOOR_LOCK_RESP_MEMORY_FULL;
+    default:
+        return ESP_ZB_DOOR_LOCK_RESP_FAILURE;
+    }
+}
+
+/* Set PIN Code and Set RFID Code: user id, user status, user type, code as octet string */
+static esp_err_t esp_zb_door_lock_cmd_set_code(esp_zb_door_lock_credential_type_t type, const uint8_t *payload, uint16_t len,
+                                               esp_zb_door_lock_buf_t *resp)
+{
+    uint16_t user_id = 0;
+    uint8_t code_len = 0;
+    esp_err_t ret = ESP_ERR_INVALID_ARG;
+
+    ESP_RETURN_ON_FALSE(len >= 5 && len >= 5 + payload[4], ESP_ERR_INVALID_SIZE, TAG, "Malformed set code command");
+    user_id = esp_zb_door_lock_get_u16(payload);
+    code_len = payload[4];
+    if (!esp_zb_door_lock_user_valid(payload[2], payload[3])) {
+        esp_zb_door_lock_put_u8(resp, ESP_ZB_DOOR_LOCK_RESP_INVALID_FIELD);
+        return ESP_OK;
+    }
+    if (user_id < s_store.user_num && code_len) {
+        ret = esp_zb_door_lock_code_set(user_id, type, &payload[5], code_len);
+        if (ret == ESP_OK) {
+            s_store.record[user_id].status = payload[2];
+            s_store.record[user_id].type = payload[3];
+        }
+    }
+    esp_zb_door_lock_put_u8(resp, esp_zb_door_lock_status_resp(ret));
+    return ESP_OK;
+}
+
+/* Get PIN Code and Get RFID Code: user id */
+static esp_err_t esp_zb_door_lock_cmd_get_code(esp_zb_door_lock_credential_type_t type, const uint8_t *payload, uint16_t len,
+                                               esp_zb_door_lock_buf_t *resp)
+{
+    uint16_t user_id = 0;
+    const esp_zb_door_lock_record_t *record = NULL;
+    const uint8_t *code = NULL;
+    uint8_t code_len = 0;
+
+    ESP_RETURN_ON_FALSE(len >= 2, ESP_ERR_INVALID_SIZE, TAG, "Malformed get code command");
+    user_id = esp_zb_door_lock_get_u16(payload);
+    esp_zb_door_lock_put_u16(resp, user_id);
+    if (user_id >= s_store.user_num) {
+        esp_zb_door_lock_put_u8(resp, ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE);
+        esp_zb_door_lock_put_u8(resp, 0xff);
+        esp_zb_door_lock_put_u8(resp, 0);
+        return ESP_OK;
+    }
+    record = &s_store.record[user_id];
+    code = esp_zb_door_lock_record_code(record, type, &code_len);
+    esp_zb_door_lock_put_u8(resp, record->status);
+    esp_zb_door_lock_put_u8(resp, record->status == ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE ? 0xff : record->type);
+    esp_zb_door_lock_put_u8(resp, code_len);
+    esp_zb_door_lock_put(resp, code, code_len);
+    return ESP_OK;
+}
+
+/* Clear PIN Code and Clear RFID Code: user id */
+static esp_err_t esp_zb_door_lock_cmd_clear_code(esp_zb_door_lock_credential_type_t type, const uint8_t *payload, uint16_t len,
+                                                 esp_zb_door_lock_buf_t *resp)
+{
+    uint16_t user_id = 0;
+    esp_err_t ret = ESP_ERR_INVALID_ARG;
+
+    ESP_RETURN_ON_FALSE(len >= 2, ESP_ERR_INVALID_SIZE, TAG, "Malformed clear code command");
+    user_id = esp_zb_door_lock_get_u16(payload);
+    if (user_id < s_store.user_num) {
+        ret = esp_zb_door_lock_code_set(user_id, type, NULL, 0);
+        if (esp_zb_door_lock_record_is_empty(&s_store.record[user_id])) {
+            esp_zb_door_lock_record_reset(user_id);
+        }
+    }
+    esp_zb_door_lock_put_u8(resp, esp_zb_door_lock_status_resp(ret));
+    return ESP_OK;
+}
+
+/* Set/Get/Clear Weekday Schedule: schedule id, user id, days mask, start hour, start minute, end hour, end minute */
+static esp_err_t esp_zb_door_lock_cmd_weekday(uint8_t cmd_id, const uint8_t *payload, uint16_t len, esp_zb_door_lock_buf_t *resp)
+{
+    uint8_t schedule_id = 0;
+    uint16_t user_id = 0;
+    bool valid = false;
+    esp_zb_door_lock_weekday_schedule_t *schedule = NULL;
+
+    ESP_RETURN_ON_FALSE(len >= (cmd_id == ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_WEEKDAY_SCHEDULE ? 8 : 3), ESP_ERR_INVALID_SIZE, TAG,
+                        "Malformed weekday schedule command");
+    schedule_id = payload[0];
+    user_id = esp_zb_door_lock_get_u16(&payload[1]);
+    valid = schedule_id < ESP_ZB_DOOR_LOCK_WEEKDAY_SCHEDULE_NUM && user_id < s_store.user_num &&
+            s_store.record[user_id].status != ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE;
+    schedule = valid ? &s_store.record[user_id].weekday[schedule_id] : NULL;
+    switch (cmd_id) {
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_WEEKDAY_SCHEDULE:
+        if (valid && payload[3] != 0 && payload[4] < 24 && payload[5] < 60 && payload[6] < 24 && payload[7] < 60) {
+            schedule->days_mask = payload[3];
+            schedule->start_hour = payload[4];
+            schedule->start_minute = payload[5];
+            schedule->end_hour = payload[6];
+            schedule->end_minute = payload[7];
+            esp_zb_door_lock_page_dirty(user_id);
+        } else {
+            valid = false;
+        }
+        esp_zb_door_lock_put_u8(resp, valid ? ESP_ZB_DOOR_LOCK_RESP_SUCCESS : ESP_ZB_DOOR_LOCK_RESP_FAILURE);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_WEEKDAY_SCHEDULE:
+        valid = valid && schedule->days_mask;
+        esp_zb_door_lock_put_u8(resp, schedule_id);
+        esp_zb_door_lock_put_u16(resp, user_id);
+        esp_zb_door_lock_put_u8(resp, valid ? ESP_ZB_DOOR_LOCK_RESP_SUCCESS : ESP_ZB_DOOR_LOCK_RESP_NOT_FOUND);
+        if (valid) {
+            esp_zb_door_lock_put(resp, schedule, sizeof(esp_zb_door_lock_weekday_schedule_t));
+        }
+        break;
+    default:
+        if (valid) {
+            memset(schedule, 0, sizeof(esp_zb_door_lock_weekday_schedule_t));
+            esp_zb_door_lock_page_dirty(user_id);
+        }
+        esp_zb_door_lock_put_u8(resp, valid ? ESP_ZB_DOOR_LOCK_RESP_SUCCESS : ESP_ZB_DOOR_LOCK_RESP_FAILURE);
+        break;
+    }
+    return ESP_OK;
+}
+
+/* Set/Get/Clear Year Day Schedule: schedule id, user id, local start time, local end time */
+static esp_err_t esp_zb_door_lock_cmd_yearday(uint8_t cmd_id, const uint8_t *payload, uint16_t len, esp_zb_door_lock_buf_t *resp)
+{
+    uint8_t schedule_id = 0;
+    uint16_t user_id = 0;
+    bool valid = false;
+    esp_zb_door_lock_yearday_schedule_t *schedule = NULL;
+
+    ESP_RETURN_ON_FALSE(len >= (cmd_id == ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_YEAR_DAY_SCHEDULE ? 11 : 3), ESP_ERR_INVALID_SIZE, TAG,
+                        "Malformed year day schedule command");
+    schedule_id = payload[0];
+    user_id = esp_zb_door_lock_get_u16(&payload[1]);
+    valid = schedule_id < ESP_ZB_DOOR_LOCK_YEARDAY_SCHEDULE_NUM && user_id < s_store.user_num &&
+            s_store.record[user_id].status != ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE;
+    schedule = valid ? &s_store.record[user_id].yearday[schedule_id] : NULL;
+    switch (cmd_id) {
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_YEAR_DAY_SCHEDULE:
+        if (valid && esp_zb_door_lock_get_u32(&payload[3]) && esp_zb_door_lock_get_u32(&payload[3]) <= esp_zb_door_lock_get_u32(&payload[7])) {
+            schedule->start = esp_zb_door_lock_get_u32(&payload[3]);
+            schedule->end = esp_zb_door_lock_get_u32(&payload[7]);
+            esp_zb_door_lock_page_dirty(user_id);
+        } else {
+            valid = false;
+        }
+        esp_zb_door_lock_put_u8(resp, valid ? ESP_ZB_DOOR_LOCK_RESP_SUCCESS : ESP_ZB_DOOR_LOCK_RESP_FAILURE);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_YEAR_DAY_SCHEDULE:
+        valid = valid && schedule->start;
+        esp_zb_door_lock_put_u8(resp, schedule_id);
+        esp_zb_door_lock_put_u16(resp, user_id);
+        esp_zb_door_lock_put_u8(resp, valid ? ESP_ZB_DOOR_LOCK_RESP_SUCCESS : ESP_ZB_DOOR_LOCK_RESP_NOT_FOUND);
+        if (valid) {
+            esp_zb_door_lock_put_u32(resp, schedule->start);
+            esp_zb_door_lock_put_u32(resp, schedule->end);
+        }
+        break;
+    default:
+        if (valid) {
+            memset(schedule, 0, sizeof(esp_zb_door_lock_yearday_schedule_t));
+            esp_zb_door_lock_page_dirty(user_id);
+        }
+        esp_zb_door_lock_put_u8(resp, valid ? ESP_ZB_DOOR_LOCK_RESP_SUCCESS : ESP_ZB_DOOR_LOCK_RESP_FAILURE);
+        break;
+    }
+    return ESP_OK;
+}
+
+/* Set/Get User Status and Set/Get User Type: user id, value */
+static esp_err_t esp_zb_door_lock_cmd_user(uint8_t cmd_id, const uint8_t *payload, uint16_t len, esp_zb_door_lock_buf_t *resp)
+{
+    bool set = cmd_id == ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_STATUS || cmd_id == ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_TYPE;
+    bool status = cmd_id == ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_STATUS || cmd_id == ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_USER_STATUS;
+    uint16_t user_id = 0;
+    esp_zb_door_lock_record_t *record = NULL;
+
+    ESP_RETURN_ON_FALSE(len >= (set ? 3 : 2), ESP_ERR_INVALID_SIZE, TAG, "Malformed user command");
+    user_id = esp_zb_door_lock_get_u16(payload);
+    record = user_id < s_store.user_num ? &s_store.record[user_id] : NULL;
+    if (!set) {
+        esp_zb_door_lock_put_u16(resp, user_id);
+        esp_zb_door_lock_put_u8(resp, record ? (status ? record->status : record->type) : (status ? 0 : 0xff));
+        return ESP_OK;
+    }
+    /* a user id only becomes occupied through its credentials */
+    if (!record || record->status == ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE) {
+        esp_zb_door_lock_put_u8(resp, ESP_ZB_DOOR_LOCK_RESP_FAILURE);
+        return ESP_OK;
+    }
+    if (!esp_zb_door_lock_user_valid(status ? payload[2] : record->status, status ? record->type : payload[2])) {
+        esp_zb_door_lock_put_u8(resp, ESP_ZB_DOOR_LOCK_RESP_INVALID_FIELD);
+        return ESP_OK;
+    }
+    if (status) {
+        record->status = payload[2];
+    } else {
+        record->type = payload[2];
+    }
+    esp_zb_door_lock_page_dirty(user_id);
+    esp_zb_door_lock_put_u8(resp, ESP_ZB_DOOR_LOCK_RESP_SUCCESS);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_door_lock_cmd_handle(uint8_t cmd_id, const uint8_t *payload, uint16_t len, uint8_t *resp, uint16_t *resp_len)
+{
+    esp_zb_door_lock_buf_t buf = {0};
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(s_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Credential store is not initialized");
+    ESP_RETURN_ON_FALSE((payload || len == 0) && resp && resp_len, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    buf.data = resp;
+    buf.size = *resp_len;
+    switch (cmd_id) {
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_PIN_CODE:
+        ret = esp_zb_door_lock_cmd_set_code(ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN, payload, len, &buf);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_RFID_CODE:
+        ret = esp_zb_door_lock_cmd_set_code(ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID, payload, len, &buf);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_PIN_CODE:
+        ret = esp_zb_door_lock_cmd_get_code(ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN, payload, len, &buf);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_RFID_CODE:
+        ret = esp_zb_door_lock_cmd_get_code(ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID, payload, len, &buf);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_CLEAR_PIN_CODE:
+        ret = esp_zb_door_lock_cmd_clear_code(ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN, payload, len, &buf);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_CLEAR_RFID_CODE:
+        ret = esp_zb_door_lock_cmd_clear_code(ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID, payload, len, &buf);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_CLEAR_ALL_PIN_CODES:
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_CLEAR_ALL_RFID_CODES:
+        ret = esp_zb_door_lock_credential_clear_all(cmd_id == ESP_ZB_ZCL_CMD_DOOR_LOCK_CLEAR_ALL_PIN_CODES ?
+                                                    ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN : ESP_ZB_DOOR_LOCK_CREDENTIAL_RFID, false);
+        esp_zb_door_lock_put_u8(&buf, esp_zb_door_lock_status_resp(ret));
+        ret = ESP_OK;
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_STATUS:
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_USER_STATUS:
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_TYPE:
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_USER_TYPE:
+        ret = esp_zb_door_lock_cmd_user(cmd_id, payload, len, &buf);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_WEEKDAY_SCHEDULE:
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_WEEKDAY_SCHEDULE:
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_CLEAR_WEEKDAY_SCHEDULE:
+        ret = esp_zb_door_lock_cmd_weekday(cmd_id, payload, len, &buf);
+        break;
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_YEAR_DAY_SCHEDULE:
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_GET_YEAR_DAY_SCHEDULE:
+    case ESP_ZB_ZCL_CMD_DOOR_LOCK_CLEAR_YEAR_DAY_SCHEDULE:
+        ret = esp_zb_door_lock_cmd_yearday(cmd_id, payload, len, &buf);
+        break;
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to handle command 0x%02x", cmd_id);
+    ESP_RETURN_ON_FALSE(!buf.overflow, ESP_ERR_INVALID_SIZE, TAG, "Response buffer is too small");
+    *resp_len = buf.pos;
+    esp_zb_door_lock_flush();
+    return ESP_OK;
+}
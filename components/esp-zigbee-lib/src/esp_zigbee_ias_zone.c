@@ -0,0 +1,291 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "zboss_api.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_af_indication.h"
+#include "esp_zigbee_ias_zone.h"
+
+/* the ZCL frame header, refer to ZCL specification 2.4.1 */
+#define ESP_ZB_ZCL_FRAME_TYPE_MASK                  0x03
+#define ESP_ZB_ZCL_FRAME_TYPE_CLUSTER_SPECIFIC      0x01
+#define ESP_ZB_ZCL_FRAME_MANUF_SPECIFIC             0x04
+#define ESP_ZB_ZCL_FRAME_DIRECTION_TO_CLIENT        0x08
+
+static const char *TAG = "ESP_ZB_IAS_ZONE";
+
+typedef struct esp_zb_ias_zone_s {
+    bool in_use;
+    bool window_open;                               /* a notification is sent within the coalesce window */
+    bool pending;                                   /* the zone status has changed since the last notification */
+    esp_zb_ias_zone_cfg_t cfg;
+    uint16_t zone_status;                           /* the latest zone status from the application */
+    uint16_t sent_status;                           /* the zone status of the last notification */
+    int64_t pending_since;                          /* time in microsecond of the first change not notified yet */
+    esp_zb_ias_zone_enroll_state_t enroll_state;
+    esp_zb_ias_zone_stats_t stats;
+} esp_zb_ias_zone_t;
+
+static esp_zb_ias_zone_t s_zone[ESP_ZB_IAS_ZONE_MAX_NUM];
+static uint8_t s_zone_num;
+
+static esp_zb_ias_zone_t *esp_zb_ias_zone_get(uint8_t endpoint)
+{
+    for (uint8_t i = 0; i < ESP_ZB_IAS_ZONE_MAX_NUM; i++) {
+        if (s_zone[i].in_use && s_zone[i].cfg.endpoint == endpoint) {
+            return &s_zone[i];
+        }
+    }
+    return NULL;
+}
+
+static uint8_t esp_zb_ias_zone_index(const esp_zb_ias_zone_t *zone)
+{
+    return (uint8_t)(zone - s_zone);
+}
+
+static void *esp_zb_ias_zone_attr_get(const esp_zb_ias_zone_t *zone, uint16_t attr_id)
+{
+    esp_zb_zcl_attr_t *attr = esp_zb_zcl_get_attribute(zone->cfg.endpoint, ESP_ZB_ZCL_CLUSTER_ID_IAS_ZONE,
+                                                       ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, attr_id);
+
+    return attr ? attr->data_p : NULL;
+}
+
+static void esp_zb_ias_zone_window_close(uint8_t index);
+
+static void esp_zb_ias_zone_notify(esp_zb_ias_zone_t *zone, bool fast)
+{
+    esp_zb_zcl_ias_zone_status_change_notif_cmd_t notif_cmd;
+    uint8_t *zone_id = esp_zb_ias_zone_attr_get(zone, ESP_ZB_ZCL_ATTR_IAS_ZONE_ZONEID_ID);
+    int64_t delay = zone->pending ? (esp_timer_get_time() - zone->pending_since) / 250000 : 0;
+
+    memset(&notif_cmd, 0, sizeof(notif_cmd));
+    notif_cmd.zcl_basic_cmd.dst_addr_u.addr_short = zone->cfg.cie_short_addr;
+    notif_cmd.zcl_basic_cmd.dst_endpoint = zone->cfg.cie_endpoint;
+    notif_cmd.zcl_basic_cmd.src_endpoint = zone->cfg.endpoint;
+    notif_cmd.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
+    notif_cmd.zone_status = zone->zone_status;
+    notif_cmd.zone_id = zone_id ? *zone_id : 0xff;
+    /* the delay tells the CIE how long the merged change has been held, in quarter-seconds */
+    notif_cmd.delay = delay > UINT16_MAX ? UINT16_MAX : (uint16_t)delay;
+    esp_zb_zcl_ias_zone_status_change_notif_cmd_req(&notif_cmd);
+
+    zone->sent_status = zone->zone_status;
+    zone->pending = false;
+    zone->stats.notif_count++;
+    if (fast) {
+        zone->stats.fast_path_count++;
+    }
+    if (zone->cfg.coalesce_window) {
+        zone->window_open = true;
+        esp_zb_scheduler_alarm_cancel(esp_zb_ias_zone_window_close, esp_zb_ias_zone_index(zone));
+        esp_zb_scheduler_alarm(esp_zb_ias_zone_window_close, esp_zb_ias_zone_index(zone), zone->cfg.coalesce_window);
+    }
+}
+
+static void esp_zb_ias_zone_window_close(uint8_t index)
+{
+    esp_zb_ias_zone_t *zone = &s_zone[index];
+
+    if (!zone->in_use) {
+        return;
+    }
+    zone->window_open = false;
+    if (zone->pending && zone->enroll_state == ESP_ZB_IAS_ZONE_ENROLLED) {
+        esp_zb_ias_zone_notify(zone, false);
+    }
+}
+
+static void esp_zb_ias_zone_enroll_refresh(esp_zb_ias_zone_t *zone)
+{
+    uint8_t *zone_state = esp_zb_ias_zone_attr_get(zone, ESP_ZB_ZCL_ATTR_IAS_ZONE_ZONESTATE_ID);
+
+    if (zone_state && *zone_state == ESP_ZB_ZCL_IAS_ZONE_ZONESTATE_ENROLLED) {
+        if (zone->enroll_state != ESP_ZB_IAS_ZONE_ENROLLED) {
+            zone->enroll_state = ESP_ZB_IAS_ZONE_ENROLLED;
+            ESP_LOGI(TAG, "Zone on endpoint %d is enrolled", zone->cfg.endpoint);
+            /* flush the zone status held while the zone was not enrolled */
+            if (zone->pending && !zone->window_open) {
+                esp_zb_ias_zone_notify(zone, false);
+            }
+        }
+    } else if (zone->enroll_state == ESP_ZB_IAS_ZONE_ENROLLED) {
+        zone->enroll_state = ESP_ZB_IAS_ZONE_NOT_ENROLLED;
+    }
+}
+
+static void esp_zb_ias_zone_enroll_timeout(uint8_t index)
+{
+    esp_zb_ias_zone_t *zone = &s_zone[index];
+
+    if (!zone->in_use) {
+        return;
+    }
+    esp_zb_ias_zone_enroll_refresh(zone);
+    if (zone->enroll_state == ESP_ZB_IAS_ZONE_ENROLLING) {
+        ESP_LOGW(TAG, "Zone on endpoint %d enroll timeout", zone->cfg.endpoint);
+        zone->enroll_state = ESP_ZB_IAS_ZONE_NOT_ENROLLED;
+    }
+}
+
+static void esp_zb_ias_zone_enroll_check(uint8_t index)
+{
+    esp_zb_ias_zone_t *zone = &s_zone[index];
+
+    if (!zone->in_use) {
+        return;
+    }
+    esp_zb_ias_zone_enroll_refresh(zone);
+    if (zone->enroll_state == ESP_ZB_IAS_ZONE_ENROLLED) {
+        esp_zb_scheduler_alarm_cancel(esp_zb_ias_zone_enroll_timeout, index);
+    }
+}
+
+static bool esp_zb_ias_zone_indication(uint8_t bufid)
+{
+    zb_apsde_data_indication_t *ind = ZB_BUF_GET_PARAM(bufid, zb_apsde_data_indication_t);
+    const uint8_t *data = zb_buf_begin(bufid);
+
+    if (ind->clusterid != ESP_ZB_ZCL_CLUSTER_ID_IAS_ZONE || zb_buf_len(bufid) < 3 ||
+            (data[0] & (ESP_ZB_ZCL_FRAME_TYPE_MASK | ESP_ZB_ZCL_FRAME_MANUF_SPECIFIC | ESP_ZB_ZCL_FRAME_DIRECTION_TO_CLIENT)) !=
+            ESP_ZB_ZCL_FRAME_TYPE_CLUSTER_SPECIFIC || data[2] != ESP_ZB_ZCL_CMD_IAS_ZONE_ZONE_ENROLL_RESPONSE_ID) {
+        return false;
+    }
+    for (uint8_t i = 0; i < ESP_ZB_IAS_ZONE_MAX_NUM; i++) {
+        if (s_zone[i].in_use && s_zone[i].cfg.endpoint == ind->dst_endpoint) {
+            /* the stack sets the ZoneState attribute once the handlers return, the held status is flushed right after */
+            esp_zb_scheduler_alarm(esp_zb_ias_zone_enroll_check, i, 0);
+        }
+    }
+    return false;
+}
+
+esp_err_t esp_zb_ias_zone_init(const esp_zb_ias_zone_cfg_t *cfg)
+{
+    uint16_t *zone_status = NULL;
+
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(!esp_zb_ias_zone_get(cfg->endpoint), ESP_ERR_INVALID_ARG, TAG, "Endpoint %d is already initialized",
+                        cfg->endpoint);
+    for (uint8_t i = 0; i < ESP_ZB_IAS_ZONE_MAX_NUM; i++) {
+        if (!s_zone[i].in_use) {
+            if (!s_zone_num) {
+                ESP_RETURN_ON_ERROR(esp_zb_af_indication_handler_add(esp_zb_ias_zone_indication), TAG,
+                                    "Failed to add the data indication handler");
+            }
+            s_zone_num++;
+            memset(&s_zone[i], 0, sizeof(esp_zb_ias_zone_t));
+            s_zone[i].cfg = *cfg;
+            if (!s_zone[i].cfg.alarm_mask) {
+                s_zone[i].cfg.alarm_mask = ESP_ZB_IAS_ZONE_ALARM_MASK_DEFAULT;
+            }
+            s_zone[i].in_use = true;
+            zone_status = esp_zb_ias_zone_attr_get(&s_zone[i], ESP_ZB_ZCL_ATTR_IAS_ZONE_ZONESTATUS_ID);
+            s_zone[i].zone_status = zone_status ? *zone_status : 0;
+            s_zone[i].sent_status = s_zone[i].zone_status;
+            esp_zb_ias_zone_enroll_refresh(&s_zone[i]);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_zb_ias_zone_deinit(uint8_t endpoint)
+{
+    esp_zb_ias_zone_t *zone = esp_zb_ias_zone_get(endpoint);
+
+    ESP_RETURN_ON_FALSE(zone, ESP_ERR_NOT_FOUND, TAG, "Endpoint %d is not initialized", endpoint);
+    esp_zb_scheduler_alarm_cancel(esp_zb_ias_zone_window_close, esp_zb_ias_zone_index(zone));
+    esp_zb_scheduler_alarm_cancel(esp_zb_ias_zone_enroll_timeout, esp_zb_ias_zone_index(zone));
+    esp_zb_scheduler_alarm_cancel(esp_zb_ias_zone_enroll_check, esp_zb_ias_zone_index(zone));
+    zone->in_use = false;
+    if (!--s_zone_num) {
+        esp_zb_af_indication_handler_remove(esp_zb_ias_zone_indication);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_ias_zone_status_update(uint8_t endpoint, uint16_t zone_status)
+{
+    esp_zb_ias_zone_t *zone = esp_zb_ias_zone_get(endpoint);
+    uint16_t changed = 0;
+
+    ESP_RETURN_ON_FALSE(zone, ESP_ERR_NOT_FOUND, TAG, "Endpoint %d is not initialized", endpoint);
+    zone->stats.update_count++;
+    if (zone_status == zone->zone_status) {
+        return ESP_OK;
+    }
+    esp_zb_zcl_set_attribute_val(endpoint, ESP_ZB_ZCL_CLUSTER_ID_IAS_ZONE, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_IAS_ZONE_ZONESTATUS_ID, &zone_status);
+    zone->zone_status = zone_status;
+    if (zone->pending) {
+        zone->stats.coalesced_count++;
+    } else {
+        zone->pending_since = esp_timer_get_time();
+    }
+    zone->pending = zone_status != zone->sent_status;
+
+    esp_zb_ias_zone_enroll_refresh(zone);
+    if (zone->enroll_state != ESP_ZB_IAS_ZONE_ENROLLED || !zone->pending) {
+        return ESP_OK;
+    }
+    changed = zone_status ^ zone->sent_status;
+    if (changed & zone->cfg.alarm_mask) {
+        esp_zb_ias_zone_notify(zone, true);
+    } else if (!zone->window_open) {
+        esp_zb_ias_zone_notify(zone, false);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_ias_zone_enroll(uint8_t endpoint)
+{
+    esp_zb_ias_zone_t *zone = esp_zb_ias_zone_get(endpoint);
+    esp_zb_zcl_ias_zone_enroll_request_cmd_t enroll_cmd;
+
+    ESP_RETURN_ON_FALSE(zone, ESP_ERR_NOT_FOUND, TAG, "Endpoint %d is not initialized", endpoint);
+    esp_zb_ias_zone_enroll_refresh(zone);
+    if (zone->enroll_state != ESP_ZB_IAS_ZONE_NOT_ENROLLED) {
+        return ESP_OK;
+    }
+    memset(&enroll_cmd, 0, sizeof(enroll_cmd));
+    enroll_cmd.zcl_basic_cmd.dst_addr_u.addr_short = zone->cfg.cie_short_addr;
+    enroll_cmd.zcl_basic_cmd.dst_endpoint = zone->cfg.cie_endpoint;
+    enroll_cmd.zcl_basic_cmd.src_endpoint = endpoint;
+    enroll_cmd.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
+    enroll_cmd.zone_type = zone->cfg.zone_type;
+    enroll_cmd.manuf_code = zone->cfg.manuf_code;
+    esp_zb_zcl_ias_zone_enroll_cmd_req(&enroll_cmd);
+    zone->enroll_state = ESP_ZB_IAS_ZONE_ENROLLING;
+    zone->stats.enroll_req_count++;
+    esp_zb_scheduler_alarm(esp_zb_ias_zone_enroll_timeout, esp_zb_ias_zone_index(zone), ESP_ZB_IAS_ZONE_ENROLL_TIMEOUT);
+    return ESP_OK;
+}
+
+esp_zb_ias_zone_enroll_state_t esp_zb_ias_zone_get_enroll_state(uint8_t endpoint)
+{
+    esp_zb_ias_zone_t *zone = esp_zb_ias_zone_get(endpoint);
+
+    if (!zone) {
+        return ESP_ZB_IAS_ZONE_NOT_ENROLLED;
+    }
+    esp_zb_ias_zone_enroll_refresh(zone);
+    return zone->enroll_state;
+}
+
+esp_err_t esp_zb_ias_zone_get_stats(uint8_t endpoint, esp_zb_ias_zone_stats_t *stats)
+{
+    esp_zb_ias_zone_t *zone = esp_zb_ias_zone_get(endpoint);
+
+    ESP_RETURN_ON_FALSE(zone && stats, ESP_ERR_NOT_FOUND, TAG, "Endpoint %d is not initialized", endpoint);
+    *stats = zone->stats;
+    return ESP_OK;
+}
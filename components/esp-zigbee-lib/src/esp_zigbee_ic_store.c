@@ -0,0 +1,578 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "nvs.h"
+#include "mbedtls/aes.h"
+#include "zboss_api.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_ic_store.h"
+#include "esp_zigbee_mem.h"
+
+#define ESP_ZB_IC_STORE_NVS_NAMESPACE       "zb_ic_store"
+#define ESP_ZB_IC_STORE_NVS_COUNT_KEY       "count"
+#define ESP_ZB_IC_STORE_INDEX_EMPTY         0x0000
+#define ESP_ZB_IC_STORE_INDEX_DELETED       0xffff
+#define ESP_ZB_IC_STORE_IC_MAX_SIZE         18      /* the largest install code with its CRC */
+#define ESP_ZB_IC_STORE_BLOCK_SIZE          16      /* the block size of the AES-MMO hash */
+#define ESP_ZB_DEVICE_UPDATE_UNSECURED_JOIN 0x01
+
+static const char *TAG = "ESP_ZB_IC_STORE";
+
+/* the install code size without CRC of each esp_zb_secur_ic_type_t */
+static const uint8_t s_ic_size[ESP_ZB_IC_TYPE_MAX] = {6, 8, 12, 16};
+
+typedef struct esp_zb_ic_store_entry_s {
+    esp_zb_ieee_addr_t ieee_addr;
+    uint8_t key[ESP_ZB_IC_STORE_KEY_SIZE];
+} esp_zb_ic_store_entry_t;
+
+typedef struct esp_zb_ic_store_s {
+    bool initialized;
+    uint16_t device_num;
+    uint16_t count;
+    esp_zb_ic_store_entry_t *entry;                 /* the devices are kept packed at the front, so they are written in full pages */
+    uint16_t index_mask;                            /* the index table holds index_mask + 1 entries */
+    uint16_t *index;                                /* open addressing hash index of the IEEE addresses, holds entry index + 1 */
+    uint16_t deleted_num;                           /* the number of deleted index entries, they lengthen the probe sequences */
+    uint32_t dirty_page;                            /* bit mask of the pages not written to NVS yet */
+    uint16_t provision_next;                        /* the next device to install into the stack by esp_zb_ic_store_provision_all() */
+} esp_zb_ic_store_t;
+
+static esp_zb_ic_store_t s_ic_store;
+
+static uint32_t esp_zb_ic_store_hash(const esp_zb_ieee_addr_t ieee_addr)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (uint8_t i = 0; i < sizeof(esp_zb_ieee_addr_t); i++) {
+        hash = (hash ^ ieee_addr[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static void esp_zb_ic_store_index_insert(uint16_t entry_index)
+{
+    uint32_t slot = esp_zb_ic_store_hash(s_ic_store.entry[entry_index].ieee_addr) & s_ic_store.index_mask;
+
+    while (s_ic_store.index[slot] != ESP_ZB_IC_STORE_INDEX_EMPTY && s_ic_store.index[slot] != ESP_ZB_IC_STORE_INDEX_DELETED) {
+        slot = (slot + 1) & s_ic_store.index_mask;
+    }
+    if (s_ic_store.index[slot] == ESP_ZB_IC_STORE_INDEX_DELETED) {
+        s_ic_store.deleted_num--;
+    }
+    s_ic_store.index[slot] = entry_index + 1;
+}
+
+static int32_t esp_zb_ic_store_index_find(const esp_zb_ieee_addr_t ieee_addr, uint32_t *index_slot)
+{
+    uint32_t slot = esp_zb_ic_store_hash(ieee_addr) & s_ic_store.index_mask;
+    uint16_t *index = s_ic_store.index;
+
+    while (index[slot] != ESP_ZB_IC_STORE_INDEX_EMPTY) {
+        if (index[slot] != ESP_ZB_IC_STORE_INDEX_DELETED &&
+                !memcmp(s_ic_store.entry[index[slot] - 1].ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t))) {
+            if (index_slot) {
+                *index_slot = slot;
+            }
+            return index[slot] - 1;
+        }
+        slot = (slot + 1) & s_ic_store.index_mask;
+    }
+    return -1;
+}
+
+static void esp_zb_ic_store_index_rebuild(void)
+{
+    uint16_t count = 0;
+
+    memset(s_ic_store.index, 0, (s_ic_store.index_mask + 1) * sizeof(uint16_t));
+    s_ic_store.deleted_num = 0;
+    for (uint16_t i = 0; i < s_ic_store.count; i++) {
+        /* a duplicate left by an interrupted write is dropped */
+        if (esp_zb_ic_store_index_find(s_ic_store.entry[i].ieee_addr, NULL) >= 0) {
+            continue;
+        }
+        if (count != i) {
+            s_ic_store.entry[count] = s_ic_store.entry[i];
+            s_ic_store.dirty_page |= 1UL << (count / ESP_ZB_IC_STORE_PAGE_SIZE);
+        }
+        esp_zb_ic_store_index_insert(count++);
+    }
+    /* the pages from the new end on are written again, or erased if they are left empty */
+    for (uint16_t page = count / ESP_ZB_IC_STORE_PAGE_SIZE; count < s_ic_store.count &&
+            page <= (s_ic_store.count - 1) / ESP_ZB_IC_STORE_PAGE_SIZE; page++) {
+        s_ic_store.dirty_page |= 1UL << page;
+    }
+    s_ic_store.count = count;
+}
+
+static esp_err_t esp_zb_ic_store_save(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = ESP_OK;
+    char key[16];
+
+    if (!s_ic_store.dirty_page) {
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(nvs_open(ESP_ZB_IC_STORE_NVS_NAMESPACE, NVS_READWRITE, &handle), TAG, "Failed to open NVS");
+    for (uint16_t page = 0; ret == ESP_OK && page * ESP_ZB_IC_STORE_PAGE_SIZE < s_ic_store.device_num; page++) {
+        uint16_t start = page * ESP_ZB_IC_STORE_PAGE_SIZE;
+
+        if (!(s_ic_store.dirty_page & (1UL << page))) {
+            continue;
+        }
+        snprintf(key, sizeof(key), "page_%02x", page);
+        if (start < s_ic_store.count) {
+            uint16_t num = s_ic_store.count - start < ESP_ZB_IC_STORE_PAGE_SIZE ? s_ic_store.count - start : ESP_ZB_IC_STORE_PAGE_SIZE;
+
+            ret = nvs_set_blob(handle, key, &s_ic_store.entry[start], num * sizeof(esp_zb_ic_store_entry_t));
+        } else {
+            ret = nvs_erase_key(handle, key);
+            ret = ret == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : ret;
+        }
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_set_u16(handle, ESP_ZB_IC_STORE_NVS_COUNT_KEY, s_ic_store.count);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to write the install code store to NVS");
+    s_ic_store.dirty_page = 0;
+    return ESP_OK;
+}
+
+static void esp_zb_ic_store_load(void)
+{
+    nvs_handle_t handle;
+    uint16_t count = 0;
+    char key[16];
+
+    if (nvs_open(ESP_ZB_IC_STORE_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_get_u16(handle, ESP_ZB_IC_STORE_NVS_COUNT_KEY, &count) == ESP_OK) {
+        count = count < s_ic_store.device_num ? count : s_ic_store.device_num;
+        for (uint16_t start = 0; start < count; start += ESP_ZB_IC_STORE_PAGE_SIZE) {
+            uint16_t num = count - start < ESP_ZB_IC_STORE_PAGE_SIZE ? count - start : ESP_ZB_IC_STORE_PAGE_SIZE;
+            size_t size = num * sizeof(esp_zb_ic_store_entry_t);
+
+            snprintf(key, sizeof(key), "page_%02x", start / ESP_ZB_IC_STORE_PAGE_SIZE);
+            /* the devices after a missing page are dropped rather than misread */
+            if (nvs_get_blob(handle, key, &s_ic_store.entry[start], &size) != ESP_OK ||
+                    size != num * sizeof(esp_zb_ic_store_entry_t)) {
+                ESP_LOGW(TAG, "Install code page %d is lost", start / ESP_ZB_IC_STORE_PAGE_SIZE);
+                break;
+            }
+            s_ic_store.count = start + num;
+        }
+    }
+    nvs_close(handle);
+}
+
+static uint16_t esp_zb_ic_store_crc16(const uint8_t *data, uint8_t len)
+{
+    uint16_t crc = 0xffff;
+
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x0001) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+/* derive the link key from the install code with the Matyas-Meyer-Oseas hash, refer to Zigbee specification B.6 */
+static esp_err_t esp_zb_ic_store_mmo_hash(const uint8_t *data, uint8_t len, uint8_t *hash)
+{
+    uint8_t message[ESP_ZB_IC_STORE_BLOCK_SIZE * 2] = {0};
+    uint8_t output[ESP_ZB_IC_STORE_BLOCK_SIZE];
+    uint8_t message_len = (len + 3 + ESP_ZB_IC_STORE_BLOCK_SIZE - 1) / ESP_ZB_IC_STORE_BLOCK_SIZE * ESP_ZB_IC_STORE_BLOCK_SIZE;
+    mbedtls_aes_context aes;
+    int ret = 0;
+
+    /* the message is padded with a 1 bit, zeros and its length in bits on 16 bits */
+    memcpy(message, data, len);
+    message[len] = 0x80;
+    message[message_len - 2] = (len * 8) >> 8;
+    message[message_len - 1] = (len * 8) & 0xff;
+    memset(hash, 0, ESP_ZB_IC_STORE_BLOCK_SIZE);
+    mbedtls_aes_init(&aes);
+    for (uint8_t offset = 0; offset < message_len && !ret; offset += ESP_ZB_IC_STORE_BLOCK_SIZE) {
+        ret = mbedtls_aes_setkey_enc(&aes, hash, ESP_ZB_IC_STORE_BLOCK_SIZE * 8);
+        if (!ret) {
+            ret = mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, &message[offset], output);
+        }
+        for (uint8_t i = 0; i < ESP_ZB_IC_STORE_BLOCK_SIZE; i++) {
+            hash[i] = output[i] ^ message[offset + i];
+        }
+    }
+    mbedtls_aes_free(&aes);
+    return ret ? ESP_FAIL : ESP_OK;
+}
+
+/* add or update a device from its install code followed by the CRC, the page written is marked dirty */
+static esp_err_t esp_zb_ic_store_add(const esp_zb_ieee_addr_t ieee_addr, const uint8_t *ic, uint8_t ic_size)
+{
+    uint8_t key[ESP_ZB_IC_STORE_KEY_SIZE];
+    int32_t entry_index = -1;
+    uint16_t crc = ic[ic_size] | (ic[ic_size + 1] << 8);
+
+    ESP_RETURN_ON_FALSE(esp_zb_ic_store_crc16(ic, ic_size) == crc, ESP_ERR_INVALID_CRC, TAG, "Invalid install code CRC");
+    ESP_RETURN_ON_ERROR(esp_zb_ic_store_mmo_hash(ic, ic_size + 2, key), TAG, "Failed to hash the install code");
+    entry_index = esp_zb_ic_store_index_find(ieee_addr, NULL);
+    if (entry_index < 0) {
+        ESP_RETURN_ON_FALSE(s_ic_store.count < s_ic_store.device_num, ESP_ERR_NO_MEM, TAG, "Install code store is full");
+        entry_index = s_ic_store.count++;
+        memcpy(s_ic_store.entry[entry_index].ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t));
+        esp_zb_ic_store_index_insert(entry_index);
+    } else if (!memcmp(s_ic_store.entry[entry_index].key, key, sizeof(key))) {
+        return ESP_OK;
+    }
+    memcpy(s_ic_store.entry[entry_index].key, key, sizeof(key));
+    s_ic_store.dirty_page |= 1UL << (entry_index / ESP_ZB_IC_STORE_PAGE_SIZE);
+    return ESP_OK;
+}
+
+/* parse a hex string into bytes, return the number of bytes or -1 if it is malformed */
+static int esp_zb_ic_store_hex_parse(const char *str, size_t len, uint8_t *out, uint8_t max_len)
+{
+    if (len % 2 || len / 2 > max_len) {
+        return -1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        char c = str[i];
+        uint8_t nibble = 0;
+
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else {
+            return -1;
+        }
+        out[i / 2] = (i % 2) ? (out[i / 2] | nibble) : (nibble << 4);
+    }
+    return len / 2;
+}
+
+/* find the field of a column in a CSV line, return false if the line has fewer columns */
+static bool esp_zb_ic_store_csv_field(const char *line, size_t line_len, int column, const char **field, size_t *field_len)
+{
+    const char *start = line;
+    const char *end = line + line_len;
+
+    for (int i = 0; i < column; i++) {
+        start = memchr(start, ',', end - start);
+        if (!start) {
+            return false;
+        }
+        start++;
+    }
+    *field = start;
+    *field_len = (memchr(start, ',', end - start) ? (const char *)memchr(start, ',', end - start) : end) - start;
+    /* the fields written by a spreadsheet may be padded with spaces */
+    while (*field_len && **field == ' ') {
+        (*field)++;
+        (*field_len)--;
+    }
+    while (*field_len && (*field)[*field_len - 1] == ' ') {
+        (*field_len)--;
+    }
+    return true;
+}
+
+static int esp_zb_ic_store_csv_column(const char *line, size_t line_len, const char *name)
+{
+    const char *field = NULL;
+    size_t field_len = 0;
+
+    for (int column = 0; esp_zb_ic_store_csv_field(line, line_len, column, &field, &field_len); column++) {
+        if (field_len == strlen(name) && !memcmp(field, name, field_len)) {
+            return column;
+        }
+    }
+    return -1;
+}
+
+static esp_err_t esp_zb_ic_store_csv_import(const char *csv, size_t len, uint16_t *imported)
+{
+    int ic_column = -1;
+    int ieee_column = -1;
+    uint32_t line_num = 0;
+
+    for (size_t offset = 0; offset < len;) {
+        const char *line = csv + offset;
+        const char *newline = memchr(line, '\n', len - offset);
+        size_t line_len = newline ? (size_t)(newline - line) : len - offset;
+        const char *field = NULL;
+        size_t field_len = 0;
+        uint8_t ieee[sizeof(esp_zb_ieee_addr_t)];
+        uint8_t ic[ESP_ZB_IC_STORE_IC_MAX_SIZE];
+        esp_zb_ieee_addr_t ieee_addr;
+        int ic_len = 0;
+
+        offset += line_len + 1;
+        line_num++;
+        if (line_len && line[line_len - 1] == '\r') {
+            line_len--;
+        }
+        if (!line_len) {
+            continue;
+        }
+        if (ic_column < 0) {
+            ic_column = esp_zb_ic_store_csv_column(line, line_len, "installcode");
+            ieee_column = esp_zb_ic_store_csv_column(line, line_len, "mac_address");
+            ESP_RETURN_ON_FALSE(ic_column >= 0 && ieee_column >= 0, ESP_ERR_INVALID_ARG, TAG,
+                                "CSV header has no installcode or mac_address column");
+            continue;
+        }
+        ESP_RETURN_ON_FALSE(esp_zb_ic_store_csv_field(line, line_len, ic_column, &field, &field_len), ESP_ERR_INVALID_ARG, TAG,
+                            "Missing install code on line %" PRIu32, line_num);
+        if (field_len == 4 && !memcmp(field, "NULL", 4)) {
+            continue;
+        }
+        ic_len = esp_zb_ic_store_hex_parse(field, field_len, ic, sizeof(ic));
+        ESP_RETURN_ON_FALSE(ic_len > 2, ESP_ERR_INVALID_ARG, TAG, "Invalid install code on line %" PRIu32, line_num);
+        ESP_RETURN_ON_FALSE(esp_zb_ic_store_csv_field(line, line_len, ieee_column, &field, &field_len) &&
+                            esp_zb_ic_store_hex_parse(field, field_len, ieee, sizeof(ieee)) == sizeof(ieee),
+                            ESP_ERR_INVALID_ARG, TAG, "Invalid IEEE address on line %" PRIu32, line_num);
+        ESP_RETURN_ON_FALSE(memchr(s_ic_size, ic_len - 2, sizeof(s_ic_size)), ESP_ERR_INVALID_ARG, TAG,
+                            "Invalid install code size on line %" PRIu32, line_num);
+        /* the MAC address is written most significant byte first */
+        for (uint8_t i = 0; i < sizeof(ieee); i++) {
+            ieee_addr[i] = ieee[sizeof(ieee) - 1 - i];
+        }
+        ESP_RETURN_ON_ERROR(esp_zb_ic_store_add(ieee_addr, ic, ic_len - 2), TAG, "Failed to import line %" PRIu32, line_num);
+        (*imported)++;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t esp_zb_ic_store_packed_import(const uint8_t *blob, size_t len, uint16_t *imported)
+{
+    for (size_t offset = 0; offset < len;) {
+        const uint8_t *record = blob + offset;
+        uint8_t ic_size = 0;
+
+        ESP_RETURN_ON_FALSE(len - offset > sizeof(esp_zb_ieee_addr_t) && record[sizeof(esp_zb_ieee_addr_t)] < ESP_ZB_IC_TYPE_MAX,
+                            ESP_ERR_INVALID_ARG, TAG, "Invalid record at offset %u", (unsigned int)offset);
+        ic_size = s_ic_size[record[sizeof(esp_zb_ieee_addr_t)]];
+        ESP_RETURN_ON_FALSE(len - offset >= sizeof(esp_zb_ieee_addr_t) + 1 + ic_size + 2, ESP_ERR_INVALID_ARG, TAG,
+                            "Truncated record at offset %u", (unsigned int)offset);
+        ESP_RETURN_ON_ERROR(esp_zb_ic_store_add(record, record + sizeof(esp_zb_ieee_addr_t) + 1, ic_size), TAG,
+                            "Failed to import the record at offset %u", (unsigned int)offset);
+        offset += sizeof(esp_zb_ieee_addr_t) + 1 + ic_size + 2;
+        (*imported)++;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t esp_zb_ic_store_key_install(uint16_t entry_index)
+{
+    esp_zb_ic_store_entry_t entry = s_ic_store.entry[entry_index];
+
+    ESP_RETURN_ON_FALSE(zb_secur_update_key_pair(entry.ieee_addr, entry.key, ZB_SECUR_UNIQUE_KEY, ZB_SECUR_PROVISIONAL_KEY,
+                                                 ZB_SECUR_KEY_SRC_UNKNOWN) == RET_OK, ESP_ERR_NO_MEM, TAG,
+                        "Failed to install the link key into the stack");
+    return ESP_OK;
+}
+
+static void esp_zb_ic_store_provision_alarm(uint8_t param)
+{
+    for (uint16_t i = 0; i < ESP_ZB_IC_STORE_PROVISION_BATCH && s_ic_store.provision_next < s_ic_store.count; i++) {
+        if (esp_zb_ic_store_key_install(s_ic_store.provision_next) != ESP_OK) {
+            ESP_LOGW(TAG, "Key table of the stack is full, %d of %d link keys installed", s_ic_store.provision_next,
+                     s_ic_store.count);
+            return;
+        }
+        s_ic_store.provision_next++;
+    }
+    if (s_ic_store.provision_next < s_ic_store.count) {
+        esp_zb_scheduler_alarm(esp_zb_ic_store_provision_alarm, 0, 0);
+    } else {
+        ESP_LOGI(TAG, "%d link keys installed", s_ic_store.count);
+    }
+}
+
+esp_err_t esp_zb_ic_store_init(uint16_t device_num)
+{
+    uint16_t index_size = 1;
+
+    ESP_RETURN_ON_FALSE(!s_ic_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Install code store is already initialized");
+    ESP_RETURN_ON_FALSE(device_num > 0 && device_num <= ESP_ZB_IC_STORE_DEVICE_MAX_NUM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid device number: %d", device_num);
+    /* keep the load factor of the index under one half, so the probe sequences stay short */
+    while (index_size < device_num * 2) {
+        index_size <<= 1;
+    }
+    s_ic_store.entry = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_NWK, device_num, sizeof(esp_zb_ic_store_entry_t));
+    s_ic_store.index = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_NWK, index_size, sizeof(uint16_t));
+    if (!s_ic_store.entry || !s_ic_store.index) {
+        esp_zb_mem_free(s_ic_store.entry);
+        esp_zb_mem_free(s_ic_store.index);
+        memset(&s_ic_store, 0, sizeof(s_ic_store));
+        return ESP_ERR_NO_MEM;
+    }
+    s_ic_store.device_num = device_num;
+    s_ic_store.index_mask = index_size - 1;
+    esp_zb_ic_store_load();
+    esp_zb_ic_store_index_rebuild();
+    esp_zb_ic_store_save();
+    s_ic_store.initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_ic_store_deinit(void)
+{
+    if (s_ic_store.initialized) {
+        esp_zb_scheduler_alarm_cancel(esp_zb_ic_store_provision_alarm, 0);
+        esp_zb_mem_free(s_ic_store.entry);
+        esp_zb_mem_free(s_ic_store.index);
+        memset(&s_ic_store, 0, sizeof(s_ic_store));
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_ic_store_import(const uint8_t *blob, size_t len, esp_zb_ic_store_format_t format, uint16_t *imported)
+{
+    esp_err_t ret = ESP_OK;
+    uint16_t num = 0;
+
+    ESP_RETURN_ON_FALSE(s_ic_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Install code store is not initialized");
+    ESP_RETURN_ON_FALSE(blob || !len, ESP_ERR_INVALID_ARG, TAG, "Invalid blob");
+    switch (format) {
+    case ESP_ZB_IC_STORE_FORMAT_CSV:
+        ret = esp_zb_ic_store_csv_import((const char *)blob, len, &num);
+        break;
+    case ESP_ZB_IC_STORE_FORMAT_PACKED:
+        ret = esp_zb_ic_store_packed_import(blob, len, &num);
+        break;
+    default:
+        ret = ESP_ERR_INVALID_ARG;
+        break;
+    }
+    if (imported) {
+        *imported = num;
+    }
+    ESP_LOGI(TAG, "%d install codes imported, %d devices in the store", num, s_ic_store.count);
+    /* the records imported before an error are kept */
+    if (esp_zb_ic_store_save() != ESP_OK && ret == ESP_OK) {
+        ret = ESP_FAIL;
+    }
+    return ret;
+}
+
+esp_err_t esp_zb_ic_store_find(const esp_zb_ieee_addr_t ieee_addr, uint8_t *key)
+{
+    int32_t entry_index = -1;
+
+    ESP_RETURN_ON_FALSE(s_ic_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Install code store is not initialized");
+    entry_index = esp_zb_ic_store_index_find(ieee_addr, NULL);
+    if (entry_index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (key) {
+        memcpy(key, s_ic_store.entry[entry_index].key, ESP_ZB_IC_STORE_KEY_SIZE);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_ic_store_remove(const esp_zb_ieee_addr_t ieee_addr)
+{
+    uint32_t index_slot = 0;
+    int32_t entry_index = -1;
+    uint16_t last = 0;
+
+    ESP_RETURN_ON_FALSE(s_ic_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Install code store is not initialized");
+    entry_index = esp_zb_ic_store_index_find(ieee_addr, &index_slot);
+    if (entry_index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_ic_store.index[index_slot] = ESP_ZB_IC_STORE_INDEX_DELETED;
+    s_ic_store.deleted_num++;
+    /* the last device fills the hole, so the devices stay packed */
+    last = --s_ic_store.count;
+    if (entry_index != last) {
+        esp_zb_ic_store_index_find(s_ic_store.entry[last].ieee_addr, &index_slot);
+        s_ic_store.entry[entry_index] = s_ic_store.entry[last];
+        s_ic_store.index[index_slot] = entry_index + 1;
+        s_ic_store.dirty_page |= 1UL << (entry_index / ESP_ZB_IC_STORE_PAGE_SIZE);
+    }
+    s_ic_store.dirty_page |= 1UL << (last / ESP_ZB_IC_STORE_PAGE_SIZE);
+    /* rebuild the index once the deleted entries make up half of the device number */
+    if (s_ic_store.deleted_num > s_ic_store.device_num / 2) {
+        esp_zb_ic_store_index_rebuild();
+    }
+    return esp_zb_ic_store_save();
+}
+
+esp_err_t esp_zb_ic_store_clear(void)
+{
+    ESP_RETURN_ON_FALSE(s_ic_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Install code store is not initialized");
+    for (uint16_t start = 0; start < s_ic_store.count; start += ESP_ZB_IC_STORE_PAGE_SIZE) {
+        s_ic_store.dirty_page |= 1UL << (start / ESP_ZB_IC_STORE_PAGE_SIZE);
+    }
+    s_ic_store.count = 0;
+    esp_zb_ic_store_index_rebuild();
+    return esp_zb_ic_store_save();
+}
+
+uint16_t esp_zb_ic_store_get_count(void)
+{
+    return s_ic_store.count;
+}
+
+esp_err_t esp_zb_ic_store_provision(const esp_zb_ieee_addr_t ieee_addr)
+{
+    int32_t entry_index = -1;
+
+    ESP_RETURN_ON_FALSE(s_ic_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Install code store is not initialized");
+    entry_index = esp_zb_ic_store_index_find(ieee_addr, NULL);
+    if (entry_index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return esp_zb_ic_store_key_install(entry_index);
+}
+
+esp_err_t esp_zb_ic_store_provision_all(void)
+{
+    ESP_RETURN_ON_FALSE(s_ic_store.initialized, ESP_ERR_INVALID_STATE, TAG, "Install code store is not initialized");
+    esp_zb_scheduler_alarm_cancel(esp_zb_ic_store_provision_alarm, 0);
+    s_ic_store.provision_next = 0;
+    esp_zb_scheduler_alarm(esp_zb_ic_store_provision_alarm, 0, 0);
+    return ESP_OK;
+}
+
+void esp_zb_ic_store_signal_handle(esp_zb_app_signal_t *signal_s)
+{
+    uint32_t sig_type = *signal_s->p_app_signal;
+    esp_zb_zdo_signal_device_update_params_t *params = NULL;
+    int32_t entry_index = -1;
+
+    if (!s_ic_store.initialized || signal_s->esp_err_status != ESP_OK || sig_type != ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE) {
+        return;
+    }
+    params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+    entry_index = esp_zb_ic_store_index_find(params->long_addr, NULL);
+    /* only a device joining without the network key needs its link key, a rejoin keeps the one it has */
+    if (params->status != ESP_ZB_DEVICE_UPDATE_UNSECURED_JOIN || entry_index < 0) {
+        return;
+    }
+    if (esp_zb_ic_store_key_install(entry_index) != ESP_OK) {
+        ESP_LOGW(TAG, "No link key installed for the device joining as 0x%04hx", params->short_addr);
+    }
+}
@@ -0,0 +1,444 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_zigbee_interview.h"
+#include "esp_zigbee_read_attr.h"
+#include "zcl/esp_zigbee_zcl_command.h"
+#include "zcl/esp_zigbee_zcl_basic.h"
+#include "zdo/esp_zigbee_zdo_command.h"
+
+static const char *TAG = "ESP_ZB_INTERVIEW";
+
+typedef enum {
+    ESP_ZB_INTERVIEW_STEP_NODE_DESC,
+    ESP_ZB_INTERVIEW_STEP_ACTIVE_EP,
+    ESP_ZB_INTERVIEW_STEP_SIMPLE_DESC,
+    ESP_ZB_INTERVIEW_STEP_BASIC,
+} esp_zb_interview_step_t;
+
+typedef struct esp_zb_interview_slot_s {
+    bool in_use;
+    uint8_t step;
+    uint8_t step_index;                             /* the endpoint index or the attribute index of the step */
+    uint8_t retry;
+    uint16_t seq;                                   /* tells the responses of the current request apart */
+    uint8_t tsn;                                    /* ZCL sequence number of the Basic cluster read in flight */
+    esp_zb_interview_device_t device;
+} esp_zb_interview_slot_t;
+
+typedef struct esp_zb_interview_queue_entry_s {
+    esp_zb_ieee_addr_t ieee_addr;
+    uint16_t short_addr;
+    uint8_t capability;
+} esp_zb_interview_queue_entry_t;
+
+typedef struct esp_zb_interview_s {
+    bool initialized;
+    esp_zb_interview_cfg_t cfg;
+    uint16_t seq;
+    esp_zb_interview_slot_t slot[ESP_ZB_INTERVIEW_CONCURRENCY_MAX_NUM];
+    esp_zb_interview_queue_entry_t queue[ESP_ZB_INTERVIEW_QUEUE_SIZE];
+    uint8_t queue_head;
+    uint8_t queue_num;
+} esp_zb_interview_t;
+
+static esp_zb_interview_t s_interview;
+
+static const uint16_t s_basic_attr[] = {
+    ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID,
+    ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID,
+    ESP_ZB_ZCL_ATTR_BASIC_APPLICATION_VERSION_ID,
+    ESP_ZB_ZCL_ATTR_BASIC_POWER_SOURCE_ID,
+};
+
+static void esp_zb_interview_step_send(uint8_t index);
+
+static void *esp_zb_interview_ctx(uint8_t index)
+{
+    return (void *)(uintptr_t)(((uint32_t)s_interview.slot[index].seq << 8) | index);
+}
+
+/* get the slot of a response, NULL if the response is stale */
+static esp_zb_interview_slot_t *esp_zb_interview_ctx_slot(void *user_ctx, uint8_t *index)
+{
+    uint32_t ctx = (uint32_t)(uintptr_t)user_ctx;
+    esp_zb_interview_slot_t *slot = NULL;
+
+    *index = ctx & 0xff;
+    if (!s_interview.initialized || *index >= ESP_ZB_INTERVIEW_CONCURRENCY_MAX_NUM) {
+        return NULL;
+    }
+    slot = &s_interview.slot[*index];
+    return slot->in_use && slot->seq == (ctx >> 8) ? slot : NULL;
+}
+
+static void esp_zb_interview_timeout(uint8_t index);
+
+static void esp_zb_interview_slot_start(uint8_t index, const esp_zb_interview_queue_entry_t *entry)
+{
+    esp_zb_interview_slot_t *slot = &s_interview.slot[index];
+
+    memset(slot, 0, sizeof(esp_zb_interview_slot_t));
+    slot->in_use = true;
+    memcpy(slot->device.ieee_addr, entry->ieee_addr, sizeof(esp_zb_ieee_addr_t));
+    slot->device.short_addr = entry->short_addr;
+    slot->device.capability = entry->capability;
+    slot->device.power_source = 0xff;
+    slot->step = ESP_ZB_INTERVIEW_STEP_NODE_DESC;
+    esp_zb_interview_step_send(index);
+}
+
+static void esp_zb_interview_finish(uint8_t index, esp_err_t status)
+{
+    esp_zb_interview_slot_t *slot = &s_interview.slot[index];
+    esp_zb_interview_queue_entry_t entry;
+
+    esp_zb_scheduler_alarm_cancel(esp_zb_interview_timeout, index);
+    slot->in_use = false;
+    if (status != ESP_OK) {
+        ESP_LOGW(TAG, "Interview of 0x%04hx failed at step %d", slot->device.short_addr, slot->step);
+    }
+    if (s_interview.cfg.done_cb) {
+        s_interview.cfg.done_cb(status, &slot->device);
+    }
+    if (s_interview.initialized && !slot->in_use && s_interview.queue_num) {
+        entry = s_interview.queue[s_interview.queue_head];
+        s_interview.queue_head = (s_interview.queue_head + 1) % ESP_ZB_INTERVIEW_QUEUE_SIZE;
+        s_interview.queue_num--;
+        esp_zb_interview_slot_start(index, &entry);
+    }
+}
+
+/* move to the step following a completed step */
+static void esp_zb_interview_step_next(uint8_t index)
+{
+    esp_zb_interview_slot_t *slot = &s_interview.slot[index];
+
+    esp_zb_scheduler_alarm_cancel(esp_zb_interview_timeout, index);
+    switch (slot->step) {
+    case ESP_ZB_INTERVIEW_STEP_NODE_DESC:
+        slot->step = ESP_ZB_INTERVIEW_STEP_ACTIVE_EP;
+        break;
+    case ESP_ZB_INTERVIEW_STEP_ACTIVE_EP:
+        slot->step = ESP_ZB_INTERVIEW_STEP_SIMPLE_DESC;
+        slot->step_index = 0;
+        break;
+    case ESP_ZB_INTERVIEW_STEP_SIMPLE_DESC:
+        slot->step_index++;
+        break;
+    case ESP_ZB_INTERVIEW_STEP_BASIC:
+        slot->step_index++;
+        break;
+    default:
+        break;
+    }
+    if (slot->step == ESP_ZB_INTERVIEW_STEP_SIMPLE_DESC && slot->step_index >= slot->device.ep_count) {
+        if (!slot->device.basic_endpoint) {
+            esp_zb_interview_finish(index, ESP_OK);
+            return;
+        }
+        slot->step = ESP_ZB_INTERVIEW_STEP_BASIC;
+        slot->step_index = 0;
+    }
+    if (slot->step == ESP_ZB_INTERVIEW_STEP_BASIC && slot->step_index >= sizeof(s_basic_attr) / sizeof(s_basic_attr[0])) {
+        esp_zb_interview_finish(index, ESP_OK);
+        return;
+    }
+    slot->retry = 0;
+    esp_zb_interview_step_send(index);
+}
+
+static void esp_zb_interview_step_fail(uint8_t index)
+{
+    esp_zb_interview_slot_t *slot = &s_interview.slot[index];
+
+    esp_zb_scheduler_alarm_cancel(esp_zb_interview_timeout, index);
+    if (slot->retry >= s_interview.cfg.max_retry) {
+        esp_zb_interview_finish(index, ESP_ERR_TIMEOUT);
+        return;
+    }
+    slot->retry++;
+    esp_zb_interview_step_send(index);
+}
+
+static void esp_zb_interview_timeout(uint8_t index)
+{
+    if (s_interview.initialized && s_interview.slot[index].in_use) {
+        esp_zb_interview_step_fail(index);
+    }
+}
+
+static void esp_zb_interview_node_desc_cb(esp_zb_zdp_status_t zdo_status, uint16_t addr, esp_zb_af_node_desc_t *node_desc, void *user_ctx)
+{
+    uint8_t index = 0;
+    esp_zb_interview_slot_t *slot = esp_zb_interview_ctx_slot(user_ctx, &index);
+
+    if (!slot) {
+        return;
+    }
+    if (zdo_status != ESP_ZB_ZDP_STATUS_SUCCESS || !node_desc) {
+        esp_zb_interview_step_fail(index);
+        return;
+    }
+    slot->device.node_desc = *node_desc;
+    esp_zb_interview_step_next(index);
+}
+
+static void esp_zb_interview_active_ep_cb(esp_zb_zdp_status_t zdo_status, uint8_t ep_count, uint8_t *ep_id_list, void *user_ctx)
+{
+    uint8_t index = 0;
+    esp_zb_interview_slot_t *slot = esp_zb_interview_ctx_slot(user_ctx, &index);
+
+    if (!slot) {
+        return;
+    }
+    if (zdo_status != ESP_ZB_ZDP_STATUS_SUCCESS) {
+        esp_zb_interview_step_fail(index);
+        return;
+    }
+    if (ep_count > ESP_ZB_INTERVIEW_EP_MAX_NUM) {
+        ESP_LOGW(TAG, "0x%04hx has %d endpoints, only %d are recorded", slot->device.short_addr, ep_count, ESP_ZB_INTERVIEW_EP_MAX_NUM);
+        ep_count = ESP_ZB_INTERVIEW_EP_MAX_NUM;
+    }
+    slot->device.ep_count = ep_id_list ? ep_count : 0;
+    for (uint8_t i = 0; i < slot->device.ep_count; i++) {
+        slot->device.ep[i].endpoint = ep_id_list[i];
+    }
+    esp_zb_interview_step_next(index);
+}
+
+static void esp_zb_interview_simple_desc_cb(esp_zb_zdp_status_t zdo_status, esp_zb_af_simple_desc_1_1_t *simple_desc, void *user_ctx)
+{
+    uint8_t index = 0;
+    esp_zb_interview_slot_t *slot = esp_zb_interview_ctx_slot(user_ctx, &index);
+    esp_zb_interview_endpoint_t *ep = NULL;
+    uint8_t in_count = 0;
+    uint8_t out_count = 0;
+
+    if (!slot) {
+        return;
+    }
+    if (zdo_status != ESP_ZB_ZDP_STATUS_SUCCESS || !simple_desc) {
+        esp_zb_interview_step_fail(index);
+        return;
+    }
+    ep = &slot->device.ep[slot->step_index];
+    ep->profile_id = simple_desc->app_profile_id;
+    ep->device_id = simple_desc->app_device_id;
+    ep->device_version = simple_desc->app_device_version;
+    /* the input clusters are kept first when the list does not fit */
+    in_count = simple_desc->app_input_cluster_count;
+    out_count = simple_desc->app_output_cluster_count;
+    if (in_count > ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM) {
+        in_count = ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM;
+    }
+    if (out_count > ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM - in_count) {
+        out_count = ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM - in_count;
+    }
+    memcpy(ep->cluster_list, simple_desc->app_cluster_list, in_count * sizeof(uint16_t));
+    memcpy(&ep->cluster_list[in_count], &simple_desc->app_cluster_list[simple_desc->app_input_cluster_count],
+           out_count * sizeof(uint16_t));
+    ep->input_cluster_count = in_count;
+    ep->output_cluster_count = out_count;
+    for (uint8_t i = 0; i < in_count && !slot->device.basic_endpoint; i++) {
+        if (ep->cluster_list[i] == ESP_ZB_ZCL_CLUSTER_ID_BASIC) {
+            slot->device.basic_endpoint = ep->endpoint;
+        }
+    }
+    esp_zb_interview_step_next(index);
+}
+
+static void esp_zb_interview_string_copy(char *dst, const uint8_t *zcl_str)
+{
+    uint8_t len = zcl_str[0] == 0xff ? 0 : zcl_str[0];
+
+    if (len > ESP_ZB_INTERVIEW_STRING_MAX_LEN) {
+        len = ESP_ZB_INTERVIEW_STRING_MAX_LEN;
+    }
+    memcpy(dst, &zcl_str[1], len);
+    dst[len] = '\0';
+}
+
+static void esp_zb_interview_read_attr_resp_handler(const esp_zb_read_attr_resp_info_t *info, esp_zb_zcl_status_t status,
+                                                    uint16_t attr_id, esp_zb_zcl_attr_type_t attr_type, const void *value)
+{
+    esp_zb_interview_slot_t *slot = NULL;
+    uint8_t index = 0;
+
+    if (!s_interview.initialized || info->cluster_id != ESP_ZB_ZCL_CLUSTER_ID_BASIC ||
+            info->dst_endpoint != s_interview.cfg.src_endpoint) {
+        return;
+    }
+    /* only the response of the device to the Basic cluster read in flight */
+    for (; index < s_interview.cfg.concurrency; index++) {
+        slot = &s_interview.slot[index];
+        if (slot->in_use && slot->step == ESP_ZB_INTERVIEW_STEP_BASIC && slot->device.short_addr == info->src_addr &&
+                slot->tsn == info->tsn) {
+            break;
+        }
+    }
+    if (index == s_interview.cfg.concurrency || attr_id != s_basic_attr[slot->step_index]) {
+        return;
+    }
+    /* the attributes are optional on the device, an unsupported one is left empty */
+    if (status == ESP_ZB_ZCL_STATUS_SUCCESS && value) {
+        switch (attr_id) {
+        case ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID:
+            esp_zb_interview_string_copy(slot->device.manufacturer_name, value);
+            break;
+        case ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID:
+            esp_zb_interview_string_copy(slot->device.model_id, value);
+            break;
+        case ESP_ZB_ZCL_ATTR_BASIC_APPLICATION_VERSION_ID:
+            slot->device.app_version = *(const uint8_t *)value;
+            break;
+        case ESP_ZB_ZCL_ATTR_BASIC_POWER_SOURCE_ID:
+            slot->device.power_source = *(const uint8_t *)value;
+            break;
+        default:
+            break;
+        }
+    }
+    esp_zb_interview_step_next(index);
+}
+
+static void esp_zb_interview_step_send(uint8_t index)
+{
+    esp_zb_interview_slot_t *slot = &s_interview.slot[index];
+    esp_zb_interview_device_t *device = &slot->device;
+
+    slot->seq = ++s_interview.seq;
+    switch (slot->step) {
+    case ESP_ZB_INTERVIEW_STEP_NODE_DESC: {
+        esp_zb_zdo_node_desc_req_param_t req = {
+            .dst_nwk_addr = device->short_addr,
+        };
+        esp_zb_zdo_node_desc_req(&req, esp_zb_interview_node_desc_cb, esp_zb_interview_ctx(index));
+        break;
+    }
+    case ESP_ZB_INTERVIEW_STEP_ACTIVE_EP: {
+        esp_zb_zdo_active_ep_req_param_t req = {
+            .addr_of_interest = device->short_addr,
+        };
+        esp_zb_zdo_active_ep_req(&req, esp_zb_interview_active_ep_cb, esp_zb_interview_ctx(index));
+        break;
+    }
+    case ESP_ZB_INTERVIEW_STEP_SIMPLE_DESC: {
+        esp_zb_zdo_simple_desc_req_param_t req = {
+            .addr_of_interest = device->short_addr,
+            .endpoint = device->ep[slot->step_index].endpoint,
+        };
+        esp_zb_zdo_simple_desc_req(&req, esp_zb_interview_simple_desc_cb, esp_zb_interview_ctx(index));
+        break;
+    }
+    case ESP_ZB_INTERVIEW_STEP_BASIC: {
+        esp_zb_zcl_read_attr_cmd_t req;
+
+        memset(&req, 0, sizeof(req));
+        req.zcl_basic_cmd.dst_addr_u.addr_short = device->short_addr;
+        req.zcl_basic_cmd.dst_endpoint = device->basic_endpoint;
+        req.zcl_basic_cmd.src_endpoint = s_interview.cfg.src_endpoint;
+        req.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
+        req.clusterID = ESP_ZB_ZCL_CLUSTER_ID_BASIC;
+        req.attributeID = s_basic_attr[slot->step_index];
+        esp_zb_read_attr_send(&req, &slot->tsn);
+        break;
+    }
+    default:
+        return;
+    }
+    esp_zb_scheduler_alarm(esp_zb_interview_timeout, index, s_interview.cfg.step_timeout);
+}
+
+esp_err_t esp_zb_interview_init(const esp_zb_interview_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg && cfg->done_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid interview configuration");
+    ESP_RETURN_ON_FALSE(cfg->concurrency && cfg->concurrency <= ESP_ZB_INTERVIEW_CONCURRENCY_MAX_NUM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid interview concurrency: %d", cfg->concurrency);
+    esp_zb_interview_deinit();
+    s_interview.cfg = *cfg;
+    if (!s_interview.cfg.step_timeout) {
+        s_interview.cfg.step_timeout = ESP_ZB_INTERVIEW_STEP_TIMEOUT;
+    }
+    ESP_RETURN_ON_ERROR(esp_zb_read_attr_handler_add(esp_zb_interview_read_attr_resp_handler), TAG,
+                        "Failed to add the read attribute response handler");
+    s_interview.initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_interview_deinit(void)
+{
+    for (uint8_t i = 0; i < ESP_ZB_INTERVIEW_CONCURRENCY_MAX_NUM; i++) {
+        if (s_interview.slot[i].in_use) {
+            esp_zb_scheduler_alarm_cancel(esp_zb_interview_timeout, i);
+            s_interview.slot[i].in_use = false;
+        }
+    }
+    if (s_interview.initialized) {
+        esp_zb_read_attr_handler_remove(esp_zb_interview_read_attr_resp_handler);
+    }
+    s_interview.initialized = false;
+    s_interview.queue_head = 0;
+    s_interview.queue_num = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_interview_start(uint16_t short_addr, const esp_zb_ieee_addr_t ieee_addr, uint8_t capability)
+{
+    esp_zb_interview_queue_entry_t entry;
+    int16_t free_slot = -1;
+
+    ESP_RETURN_ON_FALSE(s_interview.initialized, ESP_ERR_INVALID_STATE, TAG, "Interview engine is not initialized");
+    memcpy(entry.ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t));
+    entry.short_addr = short_addr;
+    entry.capability = capability;
+    for (uint8_t i = 0; i < s_interview.cfg.concurrency; i++) {
+        esp_zb_interview_slot_t *slot = &s_interview.slot[i];
+
+        if (!slot->in_use) {
+            free_slot = free_slot < 0 ? i : free_slot;
+        } else if (!memcmp(slot->device.ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t))) {
+            if (slot->device.short_addr != short_addr) {
+                /* the device rejoined with a new address, the requests in flight are lost */
+                esp_zb_scheduler_alarm_cancel(esp_zb_interview_timeout, i);
+                esp_zb_interview_slot_start(i, &entry);
+            }
+            return ESP_OK;
+        }
+    }
+    for (uint8_t i = 0; i < s_interview.queue_num; i++) {
+        esp_zb_interview_queue_entry_t *queued = &s_interview.queue[(s_interview.queue_head + i) % ESP_ZB_INTERVIEW_QUEUE_SIZE];
+
+        if (!memcmp(queued->ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t))) {
+            queued->short_addr = short_addr;
+            queued->capability = capability;
+            return ESP_OK;
+        }
+    }
+    if (free_slot >= 0) {
+        esp_zb_interview_slot_start(free_slot, &entry);
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_FALSE(s_interview.queue_num < ESP_ZB_INTERVIEW_QUEUE_SIZE, ESP_ERR_NO_MEM, TAG, "Interview queue is full");
+    s_interview.queue[(s_interview.queue_head + s_interview.queue_num) % ESP_ZB_INTERVIEW_QUEUE_SIZE] = entry;
+    s_interview.queue_num++;
+    return ESP_OK;
+}
+
+void esp_zb_interview_signal_handle(esp_zb_app_signal_t *signal_s)
+{
+    esp_zb_zdo_signal_device_annce_params_t *dev_annce_params = NULL;
+
+    if (!s_interview.initialized || *signal_s->p_app_signal != ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE ||
+            signal_s->esp_err_status != ESP_OK) {
+        return;
+    }
+    dev_annce_params = (esp_zb_zdo_signal_device_annce_params_t *)esp_zb_app_signal_get_params(signal_s->p_app_signal);
+    esp_zb_interview_start(dev_annce_params->device_short_addr, dev_annce_params->ieee_addr, dev_annce_params->capability);
+}
@@ -0,0 +1,360 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "zboss_api.h"
+#include "esp_zigbee_af_indication.h"
+#include "esp_zigbee_link_stats.h"
+
+/* the network status codes of the delivery failures, refer to Zigbee specification 3.4.3.3.1 */
+#define ESP_ZB_NWK_STATUS_NO_ROUTE_AVAILABLE            0x00
+#define ESP_ZB_NWK_STATUS_TREE_LINK_FAILURE             0x01
+#define ESP_ZB_NWK_STATUS_NON_TREE_LINK_FAILURE         0x02
+#define ESP_ZB_NWK_STATUS_SOURCE_ROUTE_FAILURE          0x0b
+#define ESP_ZB_NWK_STATUS_MANY_TO_ONE_ROUTE_FAILURE     0x0c
+
+#define ESP_ZB_ZDO_PROFILE_ID                           0x0000
+#define ESP_ZB_ZCL_FRAME_CONTROL_MANUF_SPECIFIC         0x04
+
+static const char *TAG = "ESP_ZB_LINK_STATS";
+
+typedef struct esp_zb_link_stats_acc_s {
+    uint16_t rx_count;
+    uint16_t tx_count;
+    uint16_t tx_fail_count;
+    uint16_t retry_count;
+    uint16_t route_fail_count;
+    uint32_t lqi_sum;
+    int32_t rssi_sum;
+} esp_zb_link_stats_acc_t;
+
+typedef struct esp_zb_link_stats_request_s {
+    int64_t time;                                   /* time in microsecond the request was sent, 0 if the slot is free */
+    bool zdo;                                       /* a ZDO request, else a ZCL one, they have their own sequence numbers */
+    uint8_t tsn;
+} esp_zb_link_stats_request_t;
+
+typedef struct esp_zb_link_stats_entry_s {
+    uint16_t short_addr;
+    int64_t last_seen;                              /* time in microsecond of the last frame received, or of the entry creation */
+    esp_zb_link_stats_request_t request[ESP_ZB_LINK_STATS_REQUEST_MAX_NUM];   /* the requests waiting for a response */
+    uint8_t latency_head;
+    uint8_t latency_count;
+    uint16_t latency[ESP_ZB_LINK_STATS_LATENCY_SAMPLE_NUM];
+    esp_zb_link_stats_acc_t window[ESP_ZB_LINK_STATS_WINDOW_NUM];
+} esp_zb_link_stats_entry_t;
+
+typedef struct esp_zb_link_stats_s {
+    bool running;
+    uint8_t window_index;                           /* the current window of every entry */
+    uint8_t entry_num;
+    uint32_t window_period;
+    esp_zb_link_stats_entry_t entry[ESP_ZB_LINK_STATS_NODE_MAX_NUM];
+} esp_zb_link_stats_t;
+
+static esp_zb_link_stats_t s_link_stats;
+
+static esp_zb_link_stats_entry_t *esp_zb_link_stats_entry_find(uint16_t short_addr)
+{
+    for (uint8_t i = 0; i < s_link_stats.entry_num; i++) {
+        if (s_link_stats.entry[i].short_addr == short_addr) {
+            return &s_link_stats.entry[i];
+        }
+    }
+    return NULL;
+}
+
+/* get the entry of a node, the least recently seen node is replaced when the table is full */
+static esp_zb_link_stats_entry_t *esp_zb_link_stats_entry_get(uint16_t short_addr, int64_t now)
+{
+    esp_zb_link_stats_entry_t *entry = esp_zb_link_stats_entry_find(short_addr);
+
+    if (entry) {
+        return entry;
+    }
+    if (s_link_stats.entry_num < ESP_ZB_LINK_STATS_NODE_MAX_NUM) {
+        entry = &s_link_stats.entry[s_link_stats.entry_num++];
+    } else {
+        entry = &s_link_stats.entry[0];
+        for (uint8_t i = 1; i < s_link_stats.entry_num; i++) {
+            if (s_link_stats.entry[i].last_seen < entry->last_seen) {
+                entry = &s_link_stats.entry[i];
+            }
+        }
+    }
+    memset(entry, 0, sizeof(esp_zb_link_stats_entry_t));
+    entry->short_addr = short_addr;
+    entry->last_seen = now;
+    return entry;
+}
+
+static void esp_zb_link_stats_window_rotate(uint8_t param)
+{
+    if (!s_link_stats.running) {
+        return;
+    }
+    s_link_stats.window_index = (s_link_stats.window_index + 1) % ESP_ZB_LINK_STATS_WINDOW_NUM;
+    for (uint8_t i = 0; i < s_link_stats.entry_num; i++) {
+        memset(&s_link_stats.entry[i].window[s_link_stats.window_index], 0, sizeof(esp_zb_link_stats_acc_t));
+    }
+    esp_zb_scheduler_alarm(esp_zb_link_stats_window_rotate, 0, s_link_stats.window_period);
+}
+
+/* the sequence number of a ZDO frame is its first byte, the one of a ZCL frame follows the frame control and the
+ * manufacturer code if any */
+static bool esp_zb_link_stats_tsn_get(const zb_apsde_data_indication_t *ind, const uint8_t *payload, uint32_t len,
+                                      uint8_t *tsn)
+{
+    uint8_t offset = 1;
+
+    if (ind->profileid == ESP_ZB_ZDO_PROFILE_ID) {
+        offset = 0;
+    } else if (len && (payload[0] & ESP_ZB_ZCL_FRAME_CONTROL_MANUF_SPECIFIC)) {
+        offset = 3;
+    }
+    if (len <= offset) {
+        return false;
+    }
+    *tsn = payload[offset];
+    return true;
+}
+
+static void esp_zb_link_stats_latency_record(esp_zb_link_stats_entry_t *entry, int64_t latency)
+{
+    entry->latency[entry->latency_head] = latency > UINT16_MAX ? UINT16_MAX : (uint16_t)latency;
+    entry->latency_head = (entry->latency_head + 1) % ESP_ZB_LINK_STATS_LATENCY_SAMPLE_NUM;
+    if (entry->latency_count < ESP_ZB_LINK_STATS_LATENCY_SAMPLE_NUM) {
+        entry->latency_count++;
+    }
+}
+
+static bool esp_zb_link_stats_data_indication(uint8_t bufid)
+{
+    zb_apsde_data_indication_t *ind = ZB_BUF_GET_PARAM(bufid, zb_apsde_data_indication_t);
+    esp_zb_link_stats_entry_t *entry = NULL;
+    esp_zb_link_stats_acc_t *acc = NULL;
+    int64_t now = esp_timer_get_time();
+    uint8_t tsn = 0;
+
+    /* the link quality belongs to the last hop */
+    entry = esp_zb_link_stats_entry_get(ind->mac_src_addr, now);
+    acc = &entry->window[s_link_stats.window_index];
+    entry->last_seen = now;
+    if (acc->rx_count < UINT16_MAX) {
+        acc->rx_count++;
+        acc->lqi_sum += ind->lqi;
+        acc->rssi_sum += ind->rssi;
+    }
+    /* the latency belongs to the originator, the response carries the sequence number of its request */
+    entry = esp_zb_link_stats_entry_find(ind->src_addr);
+    if (entry && esp_zb_link_stats_tsn_get(ind, zb_buf_begin(bufid), zb_buf_len(bufid), &tsn)) {
+        for (uint8_t i = 0; i < ESP_ZB_LINK_STATS_REQUEST_MAX_NUM; i++) {
+            esp_zb_link_stats_request_t *request = &entry->request[i];
+            if (request->time && request->tsn == tsn && request->zdo == (ind->profileid == ESP_ZB_ZDO_PROFILE_ID)) {
+                esp_zb_link_stats_latency_record(entry, (now - request->time) / 1000);
+                request->time = 0;
+                break;
+            }
+        }
+    }
+    /* let the stack process the frame */
+    return false;
+}
+
+esp_err_t esp_zb_link_stats_start(const esp_zb_link_stats_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(!s_link_stats.running, ESP_ERR_INVALID_STATE, TAG, "Link statistics are already started");
+    ESP_RETURN_ON_ERROR(esp_zb_af_indication_handler_add(esp_zb_link_stats_data_indication), TAG,
+                        "No data indication handler for the link statistics");
+    memset(&s_link_stats, 0, sizeof(s_link_stats));
+    s_link_stats.window_period = cfg->window_period ? cfg->window_period : ESP_ZB_LINK_STATS_WINDOW_PERIOD;
+    s_link_stats.running = true;
+    esp_zb_scheduler_alarm(esp_zb_link_stats_window_rotate, 0, s_link_stats.window_period);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_link_stats_stop(void)
+{
+    if (s_link_stats.running) {
+        esp_zb_af_indication_handler_remove(esp_zb_link_stats_data_indication);
+        esp_zb_scheduler_alarm_cancel(esp_zb_link_stats_window_rotate, 0);
+    }
+    memset(&s_link_stats, 0, sizeof(s_link_stats));
+    return ESP_OK;
+}
+
+static void esp_zb_link_stats_tx_account(uint16_t short_addr, bool success, uint8_t retries)
+{
+    esp_zb_link_stats_entry_t *entry = esp_zb_link_stats_entry_get(short_addr, esp_timer_get_time());
+    esp_zb_link_stats_acc_t *acc = &entry->window[s_link_stats.window_index];
+
+    if (acc->tx_count < UINT16_MAX) {
+        acc->tx_count++;
+        acc->tx_fail_count += !success;
+        acc->retry_count = acc->retry_count + retries < UINT16_MAX ? acc->retry_count + retries : UINT16_MAX;
+    }
+}
+
+void esp_zb_link_stats_tx_record(uint16_t short_addr, bool success, uint8_t retries)
+{
+    if (s_link_stats.running) {
+        esp_zb_link_stats_tx_account(short_addr, success, retries);
+    }
+}
+
+void esp_zb_link_stats_tx_confirm(uint8_t bufid)
+{
+    zb_zcl_command_send_status_t *status = ZB_BUF_GET_PARAM(bufid, zb_zcl_command_send_status_t);
+
+    /* the frames sent to a group or a binding are not accounted to a node */
+    if (s_link_stats.running && status->dst_addr.addr_type == ZB_ZCL_ADDR_TYPE_SHORT) {
+        esp_zb_link_stats_tx_account(status->dst_addr.u.short_addr, status->status == RET_OK, 0);
+    }
+    zb_buf_free(bufid);
+}
+
+void esp_zb_link_stats_request_begin(uint16_t short_addr, bool zdo, uint8_t tsn)
+{
+    esp_zb_link_stats_entry_t *entry = NULL;
+    esp_zb_link_stats_request_t *request = NULL;
+    int64_t now = esp_timer_get_time();
+
+    if (!s_link_stats.running) {
+        return;
+    }
+    entry = esp_zb_link_stats_entry_get(short_addr, now);
+    /* a free slot, else the request waiting the longest is given up */
+    request = &entry->request[0];
+    for (uint8_t i = 0; i < ESP_ZB_LINK_STATS_REQUEST_MAX_NUM && request->time; i++) {
+        if (!entry->request[i].time || entry->request[i].time < request->time) {
+            request = &entry->request[i];
+        }
+    }
+    request->time = now;
+    request->zdo = zdo;
+    request->tsn = tsn;
+}
+
+void esp_zb_link_stats_signal_handle(esp_zb_app_signal_t *signal_s)
+{
+    zb_zdo_signal_nlme_status_indication_params_t *params = NULL;
+    esp_zb_link_stats_entry_t *entry = NULL;
+    esp_zb_link_stats_acc_t *acc = NULL;
+    uint8_t status = 0;
+
+    if (*signal_s->p_app_signal != ESP_ZB_NLME_STATUS_INDICATION || !s_link_stats.running) {
+        return;
+    }
+    params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+    status = params->nlme_status.status;
+    if (status != ESP_ZB_NWK_STATUS_NO_ROUTE_AVAILABLE && status != ESP_ZB_NWK_STATUS_TREE_LINK_FAILURE &&
+            status != ESP_ZB_NWK_STATUS_NON_TREE_LINK_FAILURE && status != ESP_ZB_NWK_STATUS_SOURCE_ROUTE_FAILURE &&
+            status != ESP_ZB_NWK_STATUS_MANY_TO_ONE_ROUTE_FAILURE) {
+        return;
+    }
+    entry = esp_zb_link_stats_entry_get(params->nlme_status.network_addr, esp_timer_get_time());
+    acc = &entry->window[s_link_stats.window_index];
+    if (acc->route_fail_count < UINT16_MAX) {
+        acc->route_fail_count++;
+    }
+}
+
+static void esp_zb_link_stats_window_fill(esp_zb_link_stats_window_t *window, const esp_zb_link_stats_acc_t *acc)
+{
+    window->rx_count = acc->rx_count;
+    window->lqi_avg = acc->rx_count ? acc->lqi_sum / acc->rx_count : 0;
+    window->rssi_avg = acc->rx_count ? acc->rssi_sum / acc->rx_count : 0;
+    window->tx_count = acc->tx_count;
+    window->tx_fail_count = acc->tx_fail_count;
+    window->retry_count = acc->retry_count;
+    window->route_fail_count = acc->route_fail_count;
+}
+
+static void esp_zb_link_stats_node_fill(esp_zb_link_stats_node_t *node, const esp_zb_link_stats_entry_t *entry, int64_t now)
+{
+    esp_zb_link_stats_acc_t total = {0};
+    uint16_t sorted[ESP_ZB_LINK_STATS_LATENCY_SAMPLE_NUM];
+    uint8_t count = entry->latency_count;
+
+    memset(node, 0, sizeof(esp_zb_link_stats_node_t));
+    node->short_addr = entry->short_addr;
+    node->last_seen = (now - entry->last_seen) / 1000;
+    for (uint8_t i = 0; i < ESP_ZB_LINK_STATS_WINDOW_NUM; i++) {
+        const esp_zb_link_stats_acc_t *acc =
+            &entry->window[(s_link_stats.window_index + ESP_ZB_LINK_STATS_WINDOW_NUM - i) % ESP_ZB_LINK_STATS_WINDOW_NUM];
+        esp_zb_link_stats_window_fill(&node->window[i], acc);
+        total.rx_count += acc->rx_count;
+        total.tx_count += acc->tx_count;
+        total.tx_fail_count += acc->tx_fail_count;
+        total.retry_count += acc->retry_count;
+        total.route_fail_count += acc->route_fail_count;
+        total.lqi_sum += acc->lqi_sum;
+        total.rssi_sum += acc->rssi_sum;
+    }
+    esp_zb_link_stats_window_fill(&node->total, &total);
+    /* insertion sort of the few latency samples for the percentiles */
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t latency = entry->latency[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > latency; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = latency;
+    }
+    node->latency_count = count;
+    if (count) {
+        node->latency_p50 = sorted[(count - 1) * 50 / 100];
+        node->latency_p90 = sorted[(count - 1) * 90 / 100];
+        node->latency_max = sorted[count - 1];
+    }
+}
+
+esp_err_t esp_zb_link_stats_get(uint16_t short_addr, esp_zb_link_stats_node_t *node)
+{
+    esp_zb_link_stats_entry_t *entry = NULL;
+
+    ESP_RETURN_ON_FALSE(node, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    entry = esp_zb_link_stats_entry_find(short_addr);
+    ESP_RETURN_ON_FALSE(entry, ESP_ERR_NOT_FOUND, TAG, "Node 0x%04hx not found", short_addr);
+    esp_zb_link_stats_node_fill(node, entry, esp_timer_get_time());
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_link_stats_get_nodes(esp_zb_link_stats_node_t *nodes, uint8_t max_num, uint8_t *node_num)
+{
+    int64_t now = esp_timer_get_time();
+    uint8_t num = 0;
+
+    ESP_RETURN_ON_FALSE(nodes && node_num, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    for (; num < s_link_stats.entry_num && num < max_num; num++) {
+        esp_zb_link_stats_node_fill(&nodes[num], &s_link_stats.entry[num], now);
+    }
+    *node_num = num;
+    return ESP_OK;
+}
+
+void esp_zb_link_stats_dump(void)
+{
+    esp_zb_link_stats_node_t node;
+    int64_t now = esp_timer_get_time();
+
+    printf("Link statistics %s, %" PRIu32 " ms windows, %d nodes\n", s_link_stats.running ? "running" : "stopped",
+           s_link_stats.window_period, s_link_stats.entry_num);
+    printf("%-6s %8s %6s %4s %5s %6s %6s %6s %6s %7s %7s %7s\n", "addr", "seen(ms)", "rx", "lqi", "rssi", "tx", "fail",
+           "retry", "route", "p50(ms)", "p90(ms)", "max(ms)");
+    for (uint8_t i = 0; i < s_link_stats.entry_num; i++) {
+        esp_zb_link_stats_node_fill(&node, &s_link_stats.entry[i], now);
+        printf("0x%04hx %8" PRIu32 " %6u %4u %5d %6u %6u %6u %6u %7u %7u %7u\n", node.short_addr, node.last_seen,
+               node.total.rx_count, node.total.lqi_avg, node.total.rssi_avg, node.total.tx_count, node.total.tx_fail_count,
+               node.total.retry_count, node.total.route_fail_count, node.latency_p50, node.latency_p90, node.latency_max);
+    }
+}
@@ -0,0 +1,371 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "sdkconfig.h"
+#include "esp_zigbee_mem.h"
+
+#define ESP_ZB_MEM_TAG_BITS         4
+#define ESP_ZB_MEM_TAG_MASK         ((1U << ESP_ZB_MEM_TAG_BITS) - 1)
+#define ESP_ZB_MEM_SIZE_MAX         (UINT32_MAX >> ESP_ZB_MEM_TAG_BITS)
+#define ESP_ZB_MEM_TABLE_MIN_SIZE   32                  /* the entries of the block table when it is first allocated */
+
+static const char *TAG = "ESP_ZB_MEM";
+
+/* an entry of the block table, which holds the size and the tag of each block apart from the block itself, so a block
+ * from elsewhere is told from the others without reading its memory */
+typedef struct esp_zb_mem_entry_s {
+    void *ptr;                                      /* the block, NULL for a free entry */
+    uint32_t size_tag;                              /* the size of the block shifted left, the tag in the low bits */
+} esp_zb_mem_entry_t;
+
+/* the block table, open addressing with linear probing, kept between an eighth and three quarters full */
+typedef struct esp_zb_mem_table_s {
+    esp_zb_mem_entry_t *entry;
+    uint32_t size;                                  /* the number of entries, a power of two */
+    uint32_t count;                                 /* the number of blocks */
+} esp_zb_mem_table_t;
+
+static esp_zb_mem_stats_t s_mem_stats[ESP_ZB_MEM_TAG_MAX];
+static esp_zb_mem_table_t s_mem_table;
+static portMUX_TYPE s_mem_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *s_mem_tag_name[ESP_ZB_MEM_TAG_MAX] = {
+    "core", "data_model", "zcl", "zdo", "nwk", "ota", "cli", "app",
+};
+
+static uint32_t esp_zb_mem_table_slot(const void *ptr, uint32_t size)
+{
+    uint32_t hash = (uint32_t)((uintptr_t)ptr >> 3) * 2654435761U;
+
+    return (hash ^ (hash >> 16)) & (size - 1);
+}
+
+/* the entry of the block is overwritten if the address is in the table already, true is then returned with the entry
+ * it held */
+static bool esp_zb_mem_table_put(esp_zb_mem_entry_t *entry, uint32_t size, void *ptr, uint32_t size_tag,
+                                 uint32_t *stale_size_tag)
+{
+    uint32_t slot = esp_zb_mem_table_slot(ptr, size);
+    bool stale = false;
+
+    while (entry[slot].ptr && entry[slot].ptr != ptr) {
+        slot = (slot + 1) & (size - 1);
+    }
+    stale = entry[slot].ptr != NULL;
+    if (stale) {
+        *stale_size_tag = entry[slot].size_tag;
+    }
+    entry[slot].ptr = ptr;
+    entry[slot].size_tag = size_tag;
+    return stale;
+}
+
+/* called in the critical section, false if the table has to grow first. An address already in the table belongs to a
+ * block freed by free() instead of esp_zb_mem_free(), its entry is taken over and the block is taken out of the
+ * accounting of its tag */
+static bool esp_zb_mem_table_insert(void *ptr, uint32_t size_tag)
+{
+    uint32_t stale_size_tag = 0;
+    esp_zb_mem_stats_t *stats = NULL;
+
+    if ((s_mem_table.count + 1) * 4 > s_mem_table.size * 3) {
+        return false;
+    }
+    if (esp_zb_mem_table_put(s_mem_table.entry, s_mem_table.size, ptr, size_tag, &stale_size_tag)) {
+        stats = &s_mem_stats[stale_size_tag & ESP_ZB_MEM_TAG_MASK];
+        stats->current -= stale_size_tag >> ESP_ZB_MEM_TAG_BITS;
+        stats->block_count--;
+    } else {
+        s_mem_table.count++;
+    }
+    return true;
+}
+
+/* called in the critical section, the entries following the one removed are moved back so no probe sequence breaks */
+static bool esp_zb_mem_table_remove(const void *ptr, uint32_t *size_tag)
+{
+    uint32_t mask = s_mem_table.size - 1;
+    uint32_t slot = 0;
+    uint32_t next = 0;
+    uint32_t home = 0;
+
+    if (!s_mem_table.count) {
+        return false;
+    }
+    slot = esp_zb_mem_table_slot(ptr, s_mem_table.size);
+    while (s_mem_table.entry[slot].ptr != ptr) {
+        if (!s_mem_table.entry[slot].ptr) {
+            return false;
+        }
+        slot = (slot + 1) & mask;
+    }
+    *size_tag = s_mem_table.entry[slot].size_tag;
+    next = slot;
+    while (true) {
+        next = (next + 1) & mask;
+        if (!s_mem_table.entry[next].ptr) {
+            break;
+        }
+        home = esp_zb_mem_table_slot(s_mem_table.entry[next].ptr, s_mem_table.size);
+        /* the entry may move to the free slot unless its home lies cyclically in (slot, next] */
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            s_mem_table.entry[slot] = s_mem_table.entry[next];
+            slot = next;
+        }
+    }
+    s_mem_table.entry[slot].ptr = NULL;
+    s_mem_table.count--;
+    return true;
+}
+
+/* the table is resized out of the critical section, the heap must not be called in it */
+static bool esp_zb_mem_table_resize(uint32_t size)
+{
+    esp_zb_mem_entry_t *entry = calloc(size, sizeof(esp_zb_mem_entry_t));
+    esp_zb_mem_entry_t *unused = entry;
+
+    if (!entry) {
+        return false;
+    }
+    portENTER_CRITICAL_SAFE(&s_mem_lock);
+    /* another task may have resized it meanwhile */
+    if (s_mem_table.size != size && (s_mem_table.count + 1) * 4 <= size * 3) {
+        for (uint32_t i = 0; i < s_mem_table.size; i++) {
+            if (s_mem_table.entry[i].ptr) {
+                esp_zb_mem_table_put(entry, size, s_mem_table.entry[i].ptr, s_mem_table.entry[i].size_tag, NULL);
+            }
+        }
+        unused = s_mem_table.entry;
+        s_mem_table.entry = entry;
+        s_mem_table.size = size;
+    }
+    portEXIT_CRITICAL_SAFE(&s_mem_lock);
+    free(unused);
+    return true;
+}
+
+/* record a block in the table and account it, false if the table cannot grow */
+static bool esp_zb_mem_block_add(void *ptr, esp_zb_mem_tag_t tag, uint32_t size)
+{
+    esp_zb_mem_stats_t *stats = &s_mem_stats[tag];
+    uint32_t table_size = 0;
+    bool added = false;
+
+    while (true) {
+        portENTER_CRITICAL_SAFE(&s_mem_lock);
+        added = esp_zb_mem_table_insert(ptr, (size << ESP_ZB_MEM_TAG_BITS) | tag);
+        if (added) {
+            stats->current += size;
+            stats->block_count++;
+            if (stats->current > stats->peak) {
+                stats->peak = stats->current;
+            }
+        }
+        table_size = s_mem_table.size;
+        portEXIT_CRITICAL_SAFE(&s_mem_lock);
+        if (added) {
+            return true;
+        }
+        if (!esp_zb_mem_table_resize(table_size ? table_size * 2 : ESP_ZB_MEM_TABLE_MIN_SIZE)) {
+            return false;
+        }
+    }
+}
+
+/* remove a block from the table and the accounting, false for a block from elsewhere */
+static bool esp_zb_mem_block_remove(void *ptr, esp_zb_mem_tag_t *tag, uint32_t *size)
+{
+    uint32_t size_tag = 0;
+    uint32_t table_size = 0;
+    bool removed = false;
+
+    portENTER_CRITICAL_SAFE(&s_mem_lock);
+    removed = esp_zb_mem_table_remove(ptr, &size_tag);
+    if (removed) {
+        *tag = size_tag & ESP_ZB_MEM_TAG_MASK;
+        *size = size_tag >> ESP_ZB_MEM_TAG_BITS;
+        s_mem_stats[*tag].current -= *size;
+        s_mem_stats[*tag].block_count--;
+        /* the table halves once it is less than an eighth full, far enough from the growth not to swing */
+        if (s_mem_table.size > ESP_ZB_MEM_TABLE_MIN_SIZE && s_mem_table.count * 8 < s_mem_table.size) {
+            table_size = s_mem_table.size / 2;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&s_mem_lock);
+    if (table_size) {
+        /* the table keeps its size if the heap is short */
+        esp_zb_mem_table_resize(table_size);
+    }
+    return removed;
+}
+
+static void esp_zb_mem_account_fail(esp_zb_mem_tag_t tag)
+{
+    portENTER_CRITICAL_SAFE(&s_mem_lock);
+    s_mem_stats[tag].fail_count++;
+    portEXIT_CRITICAL_SAFE(&s_mem_lock);
+}
+
+void *esp_zb_mem_malloc(esp_zb_mem_tag_t tag, size_t size)
+{
+    void *ptr = NULL;
+
+    if ((uint32_t)tag >= ESP_ZB_MEM_TAG_MAX) {
+        tag = ESP_ZB_MEM_TAG_APP;
+    }
+    if (size <= ESP_ZB_MEM_SIZE_MAX) {
+        /* a block of no byte still gets an address of its own */
+        ptr = malloc(size ? size : 1);
+    }
+    if (!ptr || !esp_zb_mem_block_add(ptr, tag, size)) {
+        free(ptr);
+        esp_zb_mem_account_fail(tag);
+        return NULL;
+    }
+    return ptr;
+}
+
+void *esp_zb_mem_calloc(esp_zb_mem_tag_t tag, size_t num, size_t size)
+{
+    void *ptr = NULL;
+
+    if (num && size > ESP_ZB_MEM_SIZE_MAX / num) {
+        esp_zb_mem_account_fail((uint32_t)tag < ESP_ZB_MEM_TAG_MAX ? tag : ESP_ZB_MEM_TAG_APP);
+        return NULL;
+    }
+    ptr = esp_zb_mem_malloc(tag, num * size);
+    if (ptr) {
+        memset(ptr, 0, num * size);
+    }
+    return ptr;
+}
+
+void *esp_zb_mem_realloc(esp_zb_mem_tag_t tag, void *ptr, size_t size)
+{
+    void *resized = NULL;
+    esp_zb_mem_tag_t block_tag = ESP_ZB_MEM_TAG_APP;
+    uint32_t block_size = 0;
+
+    if (!ptr) {
+        return esp_zb_mem_malloc(tag, size);
+    }
+    if (!size) {
+        esp_zb_mem_free(ptr);
+        return NULL;
+    }
+    /* the block leaves the table before the heap may free its address and hand it to another task */
+    if (!esp_zb_mem_block_remove(ptr, &block_tag, &block_size)) {
+        /* a block from elsewhere stays out of the accounting */
+        return realloc(ptr, size);
+    }
+    if (size <= ESP_ZB_MEM_SIZE_MAX) {
+        resized = realloc(ptr, size);
+    }
+    if (!resized) {
+        esp_zb_mem_account_fail(block_tag);
+        /* the entry just freed is normally still there, otherwise the block is left out of the accounting */
+        esp_zb_mem_block_add(ptr, block_tag, block_size);
+        return NULL;
+    }
+    if (!esp_zb_mem_block_add(resized, block_tag, size)) {
+        esp_zb_mem_account_fail(block_tag);
+    }
+    return resized;
+}
+
+void esp_zb_mem_free(void *ptr)
+{
+    esp_zb_mem_tag_t tag = ESP_ZB_MEM_TAG_APP;
+    uint32_t size = 0;
+
+    if (ptr) {
+        esp_zb_mem_block_remove(ptr, &tag, &size);
+        free(ptr);
+    }
+}
+
+#if CONFIG_ZB_MEM_TAG_LIBRARY
+/* the heap functions the prebuilt library calls instead of malloc(), calloc() and realloc(), one set per tag, refer
+ * to esp_zb_mem_tag_library() of CMakeLists.txt, its calls to free() go to esp_zb_mem_free() */
+#define ESP_ZB_MEM_LIB_ALLOCATOR(name, tag)                                                 \
+    void *esp_zb_mem_lib_malloc_##name(size_t size);                                        \
+    void *esp_zb_mem_lib_calloc_##name(size_t num, size_t size);                            \
+    void *esp_zb_mem_lib_realloc_##name(void *ptr, size_t size);                            \
+    void *esp_zb_mem_lib_malloc_##name(size_t size)                                         \
+    {                                                                                       \
+        return esp_zb_mem_malloc(tag, size);                                                \
+    }                                                                                       \
+    void *esp_zb_mem_lib_calloc_##name(size_t num, size_t size)                             \
+    {                                                                                       \
+        return esp_zb_mem_calloc(tag, num, size);                                           \
+    }                                                                                       \
+    void *esp_zb_mem_lib_realloc_##name(void *ptr, size_t size)                             \
+    {                                                                                       \
+        return esp_zb_mem_realloc(tag, ptr, size);                                          \
+    }
+
+ESP_ZB_MEM_LIB_ALLOCATOR(core, ESP_ZB_MEM_TAG_CORE)
+ESP_ZB_MEM_LIB_ALLOCATOR(data_model, ESP_ZB_MEM_TAG_DATA_MODEL)
+ESP_ZB_MEM_LIB_ALLOCATOR(zcl, ESP_ZB_MEM_TAG_ZCL)
+ESP_ZB_MEM_LIB_ALLOCATOR(zdo, ESP_ZB_MEM_TAG_ZDO)
+ESP_ZB_MEM_LIB_ALLOCATOR(ota, ESP_ZB_MEM_TAG_OTA)
+ESP_ZB_MEM_LIB_ALLOCATOR(cli, ESP_ZB_MEM_TAG_CLI)
+#endif
+
+esp_err_t esp_zb_mem_stats_get(esp_zb_mem_tag_t tag, esp_zb_mem_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE((uint32_t)tag < ESP_ZB_MEM_TAG_MAX && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    portENTER_CRITICAL_SAFE(&s_mem_lock);
+    *stats = s_mem_stats[tag];
+    portEXIT_CRITICAL_SAFE(&s_mem_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_mem_stats_reset(void)
+{
+    portENTER_CRITICAL_SAFE(&s_mem_lock);
+    for (uint8_t i = 0; i < ESP_ZB_MEM_TAG_MAX; i++) {
+        s_mem_stats[i].peak = s_mem_stats[i].current;
+        s_mem_stats[i].fail_count = 0;
+    }
+    portEXIT_CRITICAL_SAFE(&s_mem_lock);
+    return ESP_OK;
+}
+
+const char *esp_zb_mem_tag_to_name(esp_zb_mem_tag_t tag)
+{
+    return (uint32_t)tag < ESP_ZB_MEM_TAG_MAX ? s_mem_tag_name[tag] : "unknown";
+}
+
+void esp_zb_mem_stats_dump(void)
+{
+    esp_zb_mem_stats_t stats;
+    esp_zb_mem_stats_t total = {0};
+    uint32_t table_size = 0;
+
+    printf("%-10s %10s %10s %8s %6s\n", "tag", "current", "peak", "blocks", "fails");
+    for (uint8_t i = 0; i < ESP_ZB_MEM_TAG_MAX; i++) {
+        esp_zb_mem_stats_get(i, &stats);
+        printf("%-10s %10" PRIu32 " %10" PRIu32 " %8" PRIu32 " %6" PRIu32 "\n", s_mem_tag_name[i], stats.current,
+               stats.peak, stats.block_count, stats.fail_count);
+        total.current += stats.current;
+        total.block_count += stats.block_count;
+        total.fail_count += stats.fail_count;
+    }
+    printf("%-10s %10" PRIu32 " %10s %8" PRIu32 " %6" PRIu32 "\n", "total", total.current, "-", total.block_count,
+           total.fail_count);
+    portENTER_CRITICAL_SAFE(&s_mem_lock);
+    table_size = s_mem_table.size;
+    portEXIT_CRITICAL_SAFE(&s_mem_lock);
+    printf("Block table: %" PRIu32 " bytes\n", table_size * (uint32_t)sizeof(esp_zb_mem_entry_t));
+}
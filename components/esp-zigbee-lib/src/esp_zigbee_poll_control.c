@@ -0,0 +1,358 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_poll_control.h"
+#include "zboss_api.h"
+
+#define ESP_ZB_POLL_CONTROL_QS_TO_MS(qs)        ((uint32_t)(qs) * 250)
+#define ESP_ZB_POLL_CONTROL_RETRY_DELAY         1000    /* time in millisecond to wait before a check-in is retried when it could not be sent */
+
+static const char *TAG = "ESP_ZB_POLL_CONTROL";
+
+typedef struct esp_zb_poll_control_s {
+    bool initialized;
+    int64_t fast_until;                             /* the time in microsecond the current fast poll ends */
+    esp_zb_poll_control_cfg_t cfg;
+    esp_zb_poll_control_stats_t stats;
+} esp_zb_poll_control_t;
+
+static esp_zb_poll_control_t s_poll_control;
+
+static bool esp_zb_poll_control_cfg_is_valid(const esp_zb_poll_control_cfg_t *cfg)
+{
+    return cfg && cfg->short_poll_interval && cfg->short_poll_interval <= cfg->long_poll_interval &&
+           cfg->long_poll_interval <= ESP_ZB_ZCL_POLL_CONTROL_INTERVAL_MAX_VALUE &&
+           cfg->check_in_interval <= ESP_ZB_ZCL_POLL_CONTROL_INTERVAL_MAX_VALUE &&
+           (!cfg->check_in_interval || cfg->long_poll_interval <= cfg->check_in_interval) &&
+           (!cfg->fast_poll_timeout_max || cfg->fast_poll_timeout <= cfg->fast_poll_timeout_max);
+}
+
+esp_zb_attribute_list_t *esp_zb_poll_control_cluster_create(const esp_zb_poll_control_cfg_t *cfg)
+{
+    esp_zb_attribute_list_t *attr_list = NULL;
+    uint32_t check_in_interval_min = ESP_ZB_ZCL_POLL_CONTROL_CHECK_IN_INTERVAL_MIN_DEFAULT_VALUE;
+    uint32_t long_poll_interval_min = ESP_ZB_ZCL_POLL_CONTROL_LONG_POLL_INTERVAL_MIN_DEFAULT_VALUE;
+    esp_zb_poll_control_cfg_t attr_cfg;
+
+    ESP_RETURN_ON_FALSE(esp_zb_poll_control_cfg_is_valid(cfg), NULL, TAG, "Invalid poll control configuration");
+    attr_cfg = *cfg;
+    attr_list = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_POLL_CONTROL);
+    ESP_RETURN_ON_FALSE(attr_list, NULL, TAG, "No memory for the poll control cluster");
+    esp_zb_custom_cluster_add_custom_attr(attr_list, ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_ID, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &attr_cfg.check_in_interval);
+    esp_zb_custom_cluster_add_custom_attr(attr_list, ESP_ZB_ZCL_ATTR_POLL_CONTROL_LONG_POLL_INTERVAL_ID, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &attr_cfg.long_poll_interval);
+    esp_zb_custom_cluster_add_custom_attr(attr_list, ESP_ZB_ZCL_ATTR_POLL_CONTROL_SHORT_POLL_INTERVAL_ID, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &attr_cfg.short_poll_interval);
+    esp_zb_custom_cluster_add_custom_attr(attr_list, ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_ID, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &attr_cfg.fast_poll_timeout);
+    esp_zb_custom_cluster_add_custom_attr(attr_list, ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_MIN_ID, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &check_in_interval_min);
+    esp_zb_custom_cluster_add_custom_attr(attr_list, ESP_ZB_ZCL_ATTR_POLL_CONTROL_LONG_POLL_INTERVAL_MIN_ID, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &long_poll_interval_min);
+    esp_zb_custom_cluster_add_custom_attr(attr_list, ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_MAX_ID, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &attr_cfg.fast_poll_timeout_max);
+    return attr_list;
+}
+
+static void esp_zb_poll_control_attr_write(uint16_t attr_id, void *value)
+{
+    esp_zb_zcl_set_attribute_val(s_poll_control.cfg.endpoint, ESP_ZB_ZCL_CLUSTER_ID_POLL_CONTROL, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 attr_id, value);
+}
+
+static void esp_zb_poll_control_alarm(uint8_t param);
+
+/* the stack polls the parent every long poll interval, which is the only knob driven here: it is lowered to the short
+ * poll interval during fast poll, then doubled every decay step, one step per alarm, until it is back to long poll */
+static void esp_zb_poll_control_update(bool decay)
+{
+    esp_zb_poll_control_stats_t *stats = &s_poll_control.stats;
+    uint32_t short_ms = ESP_ZB_POLL_CONTROL_QS_TO_MS(s_poll_control.cfg.short_poll_interval);
+    uint32_t long_ms = ESP_ZB_POLL_CONTROL_QS_TO_MS(s_poll_control.cfg.long_poll_interval);
+    int64_t now = esp_timer_get_time();
+    uint32_t interval = stats->poll_interval;
+    uint32_t delay = 0;
+
+    esp_zb_scheduler_alarm_cancel(esp_zb_poll_control_alarm, 0);
+    if (stats->pending_transactions || now < s_poll_control.fast_until) {
+        if (!stats->fast_poll) {
+            stats->fast_poll = true;
+            stats->fast_poll_count++;
+        }
+        interval = short_ms;
+        if (!stats->pending_transactions) {
+            delay = (uint32_t)((s_poll_control.fast_until - now + 999) / 1000);
+        }
+    } else {
+        if (stats->fast_poll || decay) {
+            interval = interval < long_ms / 2 ? interval * 2 : long_ms;
+        }
+        stats->fast_poll = false;
+        if (interval < short_ms) {
+            interval = short_ms;
+        } else if (interval > long_ms) {
+            interval = long_ms;
+        }
+        if (interval < long_ms) {
+            delay = s_poll_control.cfg.decay_step;
+        }
+    }
+    if (interval != stats->poll_interval) {
+        ESP_LOGD(TAG, "Poll interval: %" PRIu32 " ms", interval);
+        zb_zdo_pim_set_long_poll_interval(interval);
+        stats->poll_interval = interval;
+    }
+    if (delay) {
+        esp_zb_scheduler_alarm(esp_zb_poll_control_alarm, 0, delay);
+    }
+}
+
+static void esp_zb_poll_control_alarm(uint8_t param)
+{
+    if (s_poll_control.initialized) {
+        esp_zb_poll_control_update(true);
+    }
+}
+
+static void esp_zb_poll_control_fast_poll_extend(uint32_t time)
+{
+    int64_t until = esp_timer_get_time() + (int64_t)time * 1000;
+
+    if (until > s_poll_control.fast_until) {
+        s_poll_control.fast_until = until;
+    }
+    esp_zb_poll_control_update(false);
+}
+
+static void esp_zb_poll_control_check_in_alarm(uint8_t param);
+
+static void esp_zb_poll_control_check_in_schedule(uint32_t delay)
+{
+    esp_zb_scheduler_alarm_cancel(esp_zb_poll_control_check_in_alarm, 0);
+    if (s_poll_control.cfg.check_in_interval) {
+        esp_zb_scheduler_alarm(esp_zb_poll_control_check_in_alarm, 0, delay);
+    }
+}
+
+static void esp_zb_poll_control_check_in_alarm(uint8_t param)
+{
+    if (s_poll_control.initialized && esp_zb_poll_control_check_in() != ESP_OK) {
+        esp_zb_poll_control_check_in_schedule(ESP_ZB_POLL_CONTROL_RETRY_DELAY);
+    }
+}
+
+esp_err_t esp_zb_poll_control_check_in(void)
+{
+    zb_bufid_t bufid = 0;
+    zb_uint8_t *cmd_ptr = NULL;
+
+    ESP_RETURN_ON_FALSE(s_poll_control.initialized, ESP_ERR_INVALID_STATE, TAG, "Poll control is not initialized");
+    bufid = zb_buf_get_out();
+    ESP_RETURN_ON_FALSE(bufid != ZB_BUF_INVALID, ESP_ERR_NO_MEM, TAG, "No buffer for the check-in");
+    /* the check-in has no payload and is sent to the bound clients, each of them answers with a check-in response */
+    cmd_ptr = ZB_ZCL_START_PACKET(bufid);
+    ZB_ZCL_CONSTRUCT_SPECIFIC_COMMAND_RES_FRAME_CONTROL(cmd_ptr);
+    ZB_ZCL_CONSTRUCT_COMMAND_HEADER(cmd_ptr, ZB_ZCL_GET_SEQ_NUM(), ESP_ZB_ZCL_CMD_POLL_CONTROL_CHECK_IN_ID);
+    ZB_ZCL_FINISH_PACKET(bufid, cmd_ptr)
+    ZB_ZCL_SEND_COMMAND_SHORT(bufid, 0, ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT, 0, s_poll_control.cfg.endpoint,
+                              ZB_AF_HA_PROFILE_ID, ESP_ZB_ZCL_CLUSTER_ID_POLL_CONTROL, NULL);
+    s_poll_control.stats.check_in_count++;
+    esp_zb_poll_control_check_in_schedule(ESP_ZB_POLL_CONTROL_QS_TO_MS(s_poll_control.cfg.check_in_interval));
+    esp_zb_poll_control_fast_poll_extend(ESP_ZB_POLL_CONTROL_CHECK_IN_WAIT);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_poll_control_init(const esp_zb_poll_control_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(esp_zb_poll_control_cfg_is_valid(cfg), ESP_ERR_INVALID_ARG, TAG, "Invalid poll control configuration");
+    esp_zb_poll_control_deinit();
+    memset(&s_poll_control, 0, sizeof(s_poll_control));
+    s_poll_control.cfg = *cfg;
+    if (!s_poll_control.cfg.interaction_timeout) {
+        s_poll_control.cfg.interaction_timeout = ESP_ZB_POLL_CONTROL_INTERACTION_TIMEOUT;
+    }
+    if (!s_poll_control.cfg.decay_step) {
+        s_poll_control.cfg.decay_step = ESP_ZB_POLL_CONTROL_DECAY_STEP;
+    }
+    s_poll_control.initialized = true;
+    s_poll_control.stats.poll_interval = ESP_ZB_POLL_CONTROL_QS_TO_MS(cfg->long_poll_interval);
+    zb_zdo_pim_set_long_poll_interval(s_poll_control.stats.poll_interval);
+    esp_zb_poll_control_check_in_schedule(ESP_ZB_POLL_CONTROL_QS_TO_MS(cfg->check_in_interval));
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_poll_control_deinit(void)
+{
+    if (s_poll_control.initialized) {
+        esp_zb_scheduler_alarm_cancel(esp_zb_poll_control_alarm, 0);
+        esp_zb_scheduler_alarm_cancel(esp_zb_poll_control_check_in_alarm, 0);
+        zb_zdo_pim_set_long_poll_interval(ESP_ZB_POLL_CONTROL_QS_TO_MS(s_poll_control.cfg.long_poll_interval));
+        s_poll_control.initialized = false;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_poll_control_interaction(void)
+{
+    ESP_RETURN_ON_FALSE(s_poll_control.initialized, ESP_ERR_INVALID_STATE, TAG, "Poll control is not initialized");
+    esp_zb_poll_control_fast_poll_extend(s_poll_control.cfg.interaction_timeout);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_poll_control_transaction_begin(void)
+{
+    ESP_RETURN_ON_FALSE(s_poll_control.initialized, ESP_ERR_INVALID_STATE, TAG, "Poll control is not initialized");
+    s_poll_control.stats.pending_transactions++;
+    esp_zb_poll_control_update(false);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_poll_control_transaction_end(void)
+{
+    ESP_RETURN_ON_FALSE(s_poll_control.initialized && s_poll_control.stats.pending_transactions, ESP_ERR_INVALID_STATE, TAG,
+                        "No transaction pending");
+    s_poll_control.stats.pending_transactions--;
+    esp_zb_poll_control_update(false);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_poll_control_fast_poll_start(uint16_t timeout)
+{
+    ESP_RETURN_ON_FALSE(s_poll_control.initialized, ESP_ERR_INVALID_STATE, TAG, "Poll control is not initialized");
+    esp_zb_poll_control_fast_poll_extend(ESP_ZB_POLL_CONTROL_QS_TO_MS(timeout ? timeout : s_poll_control.cfg.fast_poll_timeout));
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_poll_control_fast_poll_stop(void)
+{
+    ESP_RETURN_ON_FALSE(s_poll_control.initialized, ESP_ERR_INVALID_STATE, TAG, "Poll control is not initialized");
+    s_poll_control.fast_until = 0;
+    esp_zb_poll_control_update(false);
+    return ESP_OK;
+}
+
+static esp_err_t esp_zb_poll_control_check_in_response_handle(const uint8_t *payload, uint16_t len)
+{
+    uint16_t timeout = 0;
+
+    ESP_RETURN_ON_FALSE(len >= 3, ESP_ERR_INVALID_SIZE, TAG, "Invalid check-in response length: %d", len);
+    timeout = payload[1] | (payload[2] << 8);
+    if (!payload[0]) {
+        /* the client does not need fast poll, the end of the check-in wait returns to long poll */
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_FALSE(!s_poll_control.cfg.fast_poll_timeout_max || timeout <= s_poll_control.cfg.fast_poll_timeout_max,
+                        ESP_ERR_INVALID_ARG, TAG, "Fast poll timeout %d out of range", timeout);
+    return esp_zb_poll_control_fast_poll_start(timeout);
+}
+
+static esp_err_t esp_zb_poll_control_long_poll_interval_set(const uint8_t *payload, uint16_t len)
+{
+    uint32_t interval = 0;
+
+    ESP_RETURN_ON_FALSE(len >= 4, ESP_ERR_INVALID_SIZE, TAG, "Invalid set long poll interval length: %d", len);
+    interval = payload[0] | (payload[1] << 8) | ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+    ESP_RETURN_ON_FALSE(interval >= s_poll_control.cfg.short_poll_interval && interval <= ESP_ZB_ZCL_POLL_CONTROL_INTERVAL_MAX_VALUE &&
+                        (!s_poll_control.cfg.check_in_interval || interval <= s_poll_control.cfg.check_in_interval),
+                        ESP_ERR_INVALID_ARG, TAG, "Long poll interval %" PRIu32 " out of range", interval);
+    s_poll_control.cfg.long_poll_interval = interval;
+    esp_zb_poll_control_attr_write(ESP_ZB_ZCL_ATTR_POLL_CONTROL_LONG_POLL_INTERVAL_ID, &interval);
+    esp_zb_poll_control_update(false);
+    return ESP_OK;
+}
+
+static esp_err_t esp_zb_poll_control_short_poll_interval_set(const uint8_t *payload, uint16_t len)
+{
+    uint16_t interval = 0;
+
+    ESP_RETURN_ON_FALSE(len >= 2, ESP_ERR_INVALID_SIZE, TAG, "Invalid set short poll interval length: %d", len);
+    interval = payload[0] | (payload[1] << 8);
+    ESP_RETURN_ON_FALSE(interval && interval <= s_poll_control.cfg.long_poll_interval, ESP_ERR_INVALID_ARG, TAG,
+                        "Short poll interval %d out of range", interval);
+    s_poll_control.cfg.short_poll_interval = interval;
+    esp_zb_poll_control_attr_write(ESP_ZB_ZCL_ATTR_POLL_CONTROL_SHORT_POLL_INTERVAL_ID, &interval);
+    if (s_poll_control.stats.fast_poll) {
+        /* apply the new interval at once rather than at the end of the fast poll */
+        s_poll_control.stats.poll_interval = 0;
+    }
+    esp_zb_poll_control_update(false);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_poll_control_cmd_handle(uint8_t cmd_id, const uint8_t *payload, uint16_t len)
+{
+    ESP_RETURN_ON_FALSE(s_poll_control.initialized, ESP_ERR_INVALID_STATE, TAG, "Poll control is not initialized");
+    ESP_RETURN_ON_FALSE(payload || !len, ESP_ERR_INVALID_SIZE, TAG, "Invalid payload");
+    switch (cmd_id) {
+    case ESP_ZB_ZCL_CMD_POLL_CONTROL_CHECK_IN_RESPONSE_ID:
+        return esp_zb_poll_control_check_in_response_handle(payload, len);
+    case ESP_ZB_ZCL_CMD_POLL_CONTROL_FAST_POLL_STOP_ID:
+        return esp_zb_poll_control_fast_poll_stop();
+    case ESP_ZB_ZCL_CMD_POLL_CONTROL_SET_LONG_POLL_INTERVAL_ID:
+        return esp_zb_poll_control_long_poll_interval_set(payload, len);
+    case ESP_ZB_ZCL_CMD_POLL_CONTROL_SET_SHORT_POLL_INTERVAL_ID:
+        return esp_zb_poll_control_short_poll_interval_set(payload, len);
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+esp_err_t esp_zb_poll_control_attr_write_handle(uint16_t attr_id, const uint8_t *value, uint16_t len)
+{
+    ESP_RETURN_ON_FALSE(s_poll_control.initialized, ESP_ERR_INVALID_STATE, TAG, "Poll control is not initialized");
+    ESP_RETURN_ON_FALSE(value || !len, ESP_ERR_INVALID_SIZE, TAG, "Invalid value");
+    switch (attr_id) {
+    case ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_ID: {
+        uint32_t interval = 0;
+
+        ESP_RETURN_ON_FALSE(len == 4, ESP_ERR_INVALID_SIZE, TAG, "Invalid check-in interval length: %d", len);
+        interval = value[0] | (value[1] << 8) | ((uint32_t)value[2] << 16) | ((uint32_t)value[3] << 24);
+        /* 0 disables the check-in, otherwise it is not shorter than the long poll interval, refer to ZCL specification,
+         * the Check-in Interval Min of the cluster is 0 */
+        ESP_RETURN_ON_FALSE(!interval || (interval >= s_poll_control.cfg.long_poll_interval &&
+                                          interval <= ESP_ZB_ZCL_POLL_CONTROL_INTERVAL_MAX_VALUE),
+                            ESP_ERR_INVALID_ARG, TAG, "Check-in interval %" PRIu32 " out of range", interval);
+        s_poll_control.cfg.check_in_interval = interval;
+        esp_zb_poll_control_attr_write(attr_id, &interval);
+        /* the next check-in follows the new interval from now on */
+        esp_zb_poll_control_check_in_schedule(ESP_ZB_POLL_CONTROL_QS_TO_MS(interval));
+        return ESP_OK;
+    }
+    case ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_ID: {
+        uint16_t timeout = 0;
+
+        ESP_RETURN_ON_FALSE(len == 2, ESP_ERR_INVALID_SIZE, TAG, "Invalid fast poll timeout length: %d", len);
+        timeout = value[0] | (value[1] << 8);
+        ESP_RETURN_ON_FALSE(timeout && (!s_poll_control.cfg.fast_poll_timeout_max || timeout <= s_poll_control.cfg.fast_poll_timeout_max),
+                            ESP_ERR_INVALID_ARG, TAG, "Fast poll timeout %d out of range", timeout);
+        s_poll_control.cfg.fast_poll_timeout = timeout;
+        esp_zb_poll_control_attr_write(attr_id, &timeout);
+        return ESP_OK;
+    }
+    case ESP_ZB_ZCL_ATTR_POLL_CONTROL_LONG_POLL_INTERVAL_ID:
+    case ESP_ZB_ZCL_ATTR_POLL_CONTROL_SHORT_POLL_INTERVAL_ID:
+    case ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_MIN_ID:
+    case ESP_ZB_ZCL_ATTR_POLL_CONTROL_LONG_POLL_INTERVAL_MIN_ID:
+    case ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_MAX_ID:
+        return ESP_ERR_NOT_ALLOWED;
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+esp_err_t esp_zb_poll_control_get_stats(esp_zb_poll_control_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *stats = s_poll_control.stats;
+    return ESP_OK;
+}
@@ -0,0 +1,188 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_zigbee_profiler.h"
+
+#define ESP_ZB_PROFILER_BUCKET_SHIFT    5       /* the first bucket holds the times below 2^5 microseconds */
+
+static const char *TAG = "ESP_ZB_PROFILER";
+
+typedef struct esp_zb_profiler_s {
+    esp_zb_profiler_cfg_t cfg;
+    esp_zb_profiler_stats_t stats;
+    esp_zb_profiler_entry_t entries[ESP_ZB_PROFILER_ENTRY_MAX_NUM];
+} esp_zb_profiler_t;
+
+static esp_zb_profiler_t s_profiler;
+
+static const char *esp_zb_profiler_type_name(esp_zb_profiler_type_t type)
+{
+    static const char *names[] = {"callback", "signal", "alarm", "submit", "loop"};
+
+    return type < sizeof(names) / sizeof(names[0]) ? names[type] : "unknown";
+}
+
+static uint8_t esp_zb_profiler_bucket(uint32_t time)
+{
+    uint8_t bucket = 0;
+
+    if (time >> ESP_ZB_PROFILER_BUCKET_SHIFT) {
+        bucket = 32 - __builtin_clz(time) - ESP_ZB_PROFILER_BUCKET_SHIFT;
+    }
+    return bucket < ESP_ZB_PROFILER_BUCKET_NUM ? bucket : ESP_ZB_PROFILER_BUCKET_NUM - 1;
+}
+
+static esp_zb_profiler_entry_t *esp_zb_profiler_entry_find(esp_zb_profiler_type_t type, uintptr_t id)
+{
+    esp_zb_profiler_entry_t *entry = NULL;
+
+    for (uint8_t i = 0; i < s_profiler.stats.entry_num; i++) {
+        if (s_profiler.entries[i].type == type && s_profiler.entries[i].id == id) {
+            return &s_profiler.entries[i];
+        }
+    }
+    if (s_profiler.stats.entry_num == ESP_ZB_PROFILER_ENTRY_MAX_NUM) {
+        return NULL;
+    }
+    entry = &s_profiler.entries[s_profiler.stats.entry_num++];
+    memset(entry, 0, sizeof(esp_zb_profiler_entry_t));
+    entry->type = type;
+    entry->id = id;
+    return entry;
+}
+
+esp_err_t esp_zb_profiler_start(const esp_zb_profiler_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    s_profiler.cfg = *cfg;
+    s_profiler.stats.running = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_profiler_stop(void)
+{
+    s_profiler.stats.running = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_profiler_reset(void)
+{
+    bool running = s_profiler.stats.running;
+
+    memset(&s_profiler.stats, 0, sizeof(s_profiler.stats));
+    s_profiler.stats.running = running;
+    return ESP_OK;
+}
+
+int64_t esp_zb_profiler_begin(void)
+{
+    return s_profiler.stats.running ? esp_timer_get_time() : 0;
+}
+
+void esp_zb_profiler_end(esp_zb_profiler_type_t type, uintptr_t id, int64_t start)
+{
+    esp_zb_profiler_entry_t *entry = NULL;
+    int64_t elapsed = 0;
+    uint32_t time = 0;
+
+    if (!start || !s_profiler.stats.running) {
+        return;
+    }
+    elapsed = esp_timer_get_time() - start;
+    time = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+    if (s_profiler.cfg.stall_threshold && time >= s_profiler.cfg.stall_threshold) {
+        s_profiler.stats.stall_count++;
+        ESP_LOGW(TAG, "Stall: %s 0x%" PRIxPTR " ran for %" PRIu32 " us", esp_zb_profiler_type_name(type), id, time);
+    }
+    entry = esp_zb_profiler_entry_find(type, id);
+    if (!entry) {
+        s_profiler.stats.drop_count++;
+        return;
+    }
+    entry->count++;
+    entry->total_time += time;
+    if (time > entry->max_time) {
+        entry->max_time = time;
+    }
+    entry->histogram[esp_zb_profiler_bucket(time)]++;
+}
+
+void esp_zb_profiler_lateness_record(uint32_t lateness)
+{
+    if (!s_profiler.stats.running) {
+        return;
+    }
+    s_profiler.stats.lateness_count++;
+    if (lateness > s_profiler.stats.lateness_max) {
+        s_profiler.stats.lateness_max = lateness;
+    }
+    s_profiler.stats.lateness_histogram[esp_zb_profiler_bucket(lateness)]++;
+}
+
+static int esp_zb_profiler_entry_compare(const void *a, const void *b)
+{
+    const esp_zb_profiler_entry_t *entry_a = a;
+    const esp_zb_profiler_entry_t *entry_b = b;
+
+    return entry_a->total_time < entry_b->total_time ? 1 : entry_a->total_time > entry_b->total_time ? -1 : 0;
+}
+
+esp_err_t esp_zb_profiler_get_entries(esp_zb_profiler_entry_t *entries, uint8_t max_num, uint8_t *entry_num)
+{
+    esp_zb_profiler_entry_t sorted[ESP_ZB_PROFILER_ENTRY_MAX_NUM];
+    uint8_t num = s_profiler.stats.entry_num;
+
+    ESP_RETURN_ON_FALSE(entries && entry_num, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    memcpy(sorted, s_profiler.entries, num * sizeof(esp_zb_profiler_entry_t));
+    qsort(sorted, num, sizeof(esp_zb_profiler_entry_t), esp_zb_profiler_entry_compare);
+    *entry_num = num < max_num ? num : max_num;
+    memcpy(entries, sorted, *entry_num * sizeof(esp_zb_profiler_entry_t));
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_profiler_get_stats(esp_zb_profiler_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *stats = s_profiler.stats;
+    return ESP_OK;
+}
+
+static void esp_zb_profiler_histogram_print(const uint32_t *histogram)
+{
+    printf("   ");
+    for (uint8_t i = 0; i < ESP_ZB_PROFILER_BUCKET_NUM - 1; i++) {
+        printf(" <%" PRIu32 "us:%" PRIu32, (uint32_t)1 << (i + ESP_ZB_PROFILER_BUCKET_SHIFT), histogram[i]);
+    }
+    printf(" >=%" PRIu32 "us:%" PRIu32, (uint32_t)1 << (ESP_ZB_PROFILER_BUCKET_NUM + ESP_ZB_PROFILER_BUCKET_SHIFT - 2),
+           histogram[ESP_ZB_PROFILER_BUCKET_NUM - 1]);
+    printf("\n");
+}
+
+void esp_zb_profiler_dump(void)
+{
+    esp_zb_profiler_entry_t entries[ESP_ZB_PROFILER_ENTRY_MAX_NUM];
+    uint8_t entry_num = 0;
+
+    esp_zb_profiler_get_entries(entries, ESP_ZB_PROFILER_ENTRY_MAX_NUM, &entry_num);
+    printf("Profiler %s, stalls: %" PRIu32 ", untracked runs: %" PRIu32 "\n", s_profiler.stats.running ? "running" : "stopped",
+           s_profiler.stats.stall_count, s_profiler.stats.drop_count);
+    printf("%-8s %-10s %10s %12s %10s %10s\n", "type", "id", "count", "total(us)", "avg(us)", "max(us)");
+    for (uint8_t i = 0; i < entry_num; i++) {
+        printf("%-8s 0x%08" PRIxPTR " %10" PRIu32 " %12" PRIu64 " %10" PRIu64 " %10" PRIu32 "\n",
+               esp_zb_profiler_type_name(entries[i].type), entries[i].id, entries[i].count, entries[i].total_time,
+               entries[i].count ? entries[i].total_time / entries[i].count : 0, entries[i].max_time);
+        esp_zb_profiler_histogram_print(entries[i].histogram);
+    }
+    printf("Alarm lateness, count: %" PRIu32 ", max: %" PRIu32 " us\n", s_profiler.stats.lateness_count, s_profiler.stats.lateness_max);
+    esp_zb_profiler_histogram_print(s_profiler.stats.lateness_histogram);
+}
@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "zboss_api.h"
+#include "esp_zigbee_af_indication.h"
+#include "esp_zigbee_read_attr.h"
+
+/* the ZCL frame header, refer to ZCL specification 2.4.1 */
+#define ESP_ZB_ZCL_FRAME_TYPE_MASK                  0x03
+#define ESP_ZB_ZCL_FRAME_TYPE_PROFILE_WIDE          0x00
+#define ESP_ZB_ZCL_FRAME_MANUF_SPECIFIC             0x04
+#define ESP_ZB_ZCL_CMD_READ_ATTRIB_RESP             0x01
+
+static const char *TAG = "ESP_ZB_READ_ATTR";
+
+typedef struct esp_zb_read_attr_s {
+    bool dispatching;
+    bool purge_pending;                             /* a handler was removed during a dispatch */
+    uint8_t handler_num;
+    esp_zb_read_attr_resp_handler_t handler[ESP_ZB_READ_ATTR_HANDLER_MAX_NUM];     /* NULL once removed, until purged */
+} esp_zb_read_attr_t;
+
+static esp_zb_read_attr_t s_read_attr;
+
+static void esp_zb_read_attr_purge(void)
+{
+    uint8_t num = 0;
+
+    for (uint8_t i = 0; i < s_read_attr.handler_num; i++) {
+        if (s_read_attr.handler[i]) {
+            s_read_attr.handler[num++] = s_read_attr.handler[i];
+        }
+    }
+    s_read_attr.handler_num = num;
+    s_read_attr.purge_pending = false;
+}
+
+static void esp_zb_read_attr_dispatch(const esp_zb_read_attr_resp_info_t *info, esp_zb_zcl_status_t status,
+                                      uint16_t attr_id, esp_zb_zcl_attr_type_t attr_type, const void *value)
+{
+    for (uint8_t i = 0, num = s_read_attr.handler_num; i < num; i++) {
+        if (s_read_attr.handler[i]) {
+            s_read_attr.handler[i](info, status, attr_id, attr_type, value);
+        }
+    }
+}
+
+static bool esp_zb_read_attr_indication(uint8_t bufid)
+{
+    zb_apsde_data_indication_t *ind = ZB_BUF_GET_PARAM(bufid, zb_apsde_data_indication_t);
+    const uint8_t *data = zb_buf_begin(bufid);
+    uint32_t len = zb_buf_len(bufid);
+    esp_zb_read_attr_resp_info_t info;
+    uint32_t pos = 0;
+
+    if (len < 3 || (data[0] & ESP_ZB_ZCL_FRAME_TYPE_MASK) != ESP_ZB_ZCL_FRAME_TYPE_PROFILE_WIDE) {
+        return false;
+    }
+    pos = data[0] & ESP_ZB_ZCL_FRAME_MANUF_SPECIFIC ? 3 : 1;
+    if (pos + 2 > len || data[pos + 1] != ESP_ZB_ZCL_CMD_READ_ATTRIB_RESP) {
+        return false;
+    }
+    info.src_addr = ind->src_addr;
+    info.src_endpoint = ind->src_endpoint;
+    info.dst_endpoint = ind->dst_endpoint;
+    info.cluster_id = ind->clusterid;
+    info.tsn = data[pos];
+    pos += 2;
+    s_read_attr.dispatching = true;
+    /* each record is the attribute id, the status, then the type and the value on success */
+    while (pos + 3 <= len) {
+        uint16_t attr_id = data[pos] | (data[pos + 1] << 8);
+        uint8_t status = data[pos + 2];
+        uint8_t attr_type = 0;
+        uint32_t size = 0;
+
+        pos += 3;
+        if (status != ESP_ZB_ZCL_STATUS_SUCCESS) {
+            esp_zb_read_attr_dispatch(&info, status, attr_id, 0, NULL);
+            continue;
+        }
+        if (pos + 1 > len) {
+            break;
+        }
+        attr_type = data[pos++];
+        size = zb_zcl_get_attribute_size(attr_type, (zb_uint8_t *)&data[pos]);
+        if (!size || pos + size > len) {
+            /* an unknown type or a truncated value, the records after it cannot be located */
+            ESP_LOGD(TAG, "Stop parsing at attribute 0x%04x of type 0x%02x", attr_id, attr_type);
+            break;
+        }
+        esp_zb_read_attr_dispatch(&info, ESP_ZB_ZCL_STATUS_SUCCESS, attr_id, attr_type, &data[pos]);
+        pos += size;
+    }
+    s_read_attr.dispatching = false;
+    if (s_read_attr.purge_pending) {
+        esp_zb_read_attr_purge();
+    }
+    /* let the stack process the frame, the application callback still gets the response */
+    return false;
+}
+
+esp_err_t esp_zb_read_attr_handler_add(esp_zb_read_attr_resp_handler_t handler)
+{
+    ESP_RETURN_ON_FALSE(handler, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    for (uint8_t i = 0; i < s_read_attr.handler_num; i++) {
+        ESP_RETURN_ON_FALSE(s_read_attr.handler[i] != handler, ESP_ERR_INVALID_STATE, TAG, "Handler is already added");
+    }
+    if (s_read_attr.handler_num == ESP_ZB_READ_ATTR_HANDLER_MAX_NUM && s_read_attr.purge_pending && !s_read_attr.dispatching) {
+        esp_zb_read_attr_purge();
+    }
+    ESP_RETURN_ON_FALSE(s_read_attr.handler_num < ESP_ZB_READ_ATTR_HANDLER_MAX_NUM, ESP_ERR_NO_MEM, TAG,
+                        "Too many read attribute response handlers");
+    if (!s_read_attr.handler_num) {
+        ESP_RETURN_ON_ERROR(esp_zb_af_indication_handler_add(esp_zb_read_attr_indication), TAG,
+                            "Failed to add the data indication handler");
+    }
+    s_read_attr.handler[s_read_attr.handler_num++] = handler;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_read_attr_handler_remove(esp_zb_read_attr_resp_handler_t handler)
+{
+    uint8_t live_num = 0;
+
+    for (uint8_t i = 0; i < s_read_attr.handler_num; i++) {
+        live_num += s_read_attr.handler[i] != NULL;
+    }
+    for (uint8_t i = 0; i < s_read_attr.handler_num; i++) {
+        if (s_read_attr.handler[i] == handler && handler) {
+            /* the table is walked by the dispatch, the handler is only dropped once it is over */
+            s_read_attr.handler[i] = NULL;
+            s_read_attr.purge_pending = true;
+            if (!s_read_attr.dispatching) {
+                esp_zb_read_attr_purge();
+            }
+            if (live_num == 1) {
+                esp_zb_af_indication_handler_remove(esp_zb_read_attr_indication);
+            }
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_zb_read_attr_send(esp_zb_zcl_read_attr_cmd_t *cmd_req, uint8_t *tsn)
+{
+    ESP_RETURN_ON_FALSE(cmd_req && tsn, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    /* the command takes the sequence number of the ZCL context, it is sent right away */
+    *tsn = ZCL_CTX().seq_number;
+    esp_zb_zcl_read_attr_cmd_req(cmd_req);
+    return ESP_OK;
+}
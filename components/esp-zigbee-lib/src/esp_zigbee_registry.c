@@ -0,0 +1,498 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "nvs.h"
+#include "esp_zigbee_registry.h"
+#include "esp_zigbee_mem.h"
+#include "esp_zigbee_time.h"
+
+#define ESP_ZB_REGISTRY_NVS_NAMESPACE       "zb_registry"
+#define ESP_ZB_REGISTRY_INDEX_EMPTY         0x0000
+#define ESP_ZB_REGISTRY_INDEX_DELETED       0xffff
+#define ESP_ZB_REGISTRY_INDEX_IEEE          0
+#define ESP_ZB_REGISTRY_INDEX_SHORT         1
+
+static const char *TAG = "ESP_ZB_REGISTRY";
+
+typedef struct esp_zb_registry_entry_s {
+    bool in_use;
+    bool touched;                                   /* the last seen time or LQI is not written to NVS yet */
+    esp_zb_registry_device_t device;
+} esp_zb_registry_entry_t;
+
+typedef struct esp_zb_registry_s {
+    bool initialized;
+    bool flush_scheduled;
+    uint16_t device_num;
+    esp_zb_registry_entry_t *entry;
+    uint16_t index_mask;                            /* the index tables hold index_mask + 1 entries */
+    uint16_t *index[2];                             /* open addressing hash index of the IEEE and NWK addresses, holds entry index + 1 */
+    uint16_t deleted_num;                           /* the number of deleted index entries, they lengthen the probe sequences */
+} esp_zb_registry_t;
+
+static esp_zb_registry_t s_registry;
+
+static uint32_t esp_zb_registry_ieee_hash(const esp_zb_ieee_addr_t ieee_addr)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (uint8_t i = 0; i < sizeof(esp_zb_ieee_addr_t); i++) {
+        hash = (hash ^ ieee_addr[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static uint32_t esp_zb_registry_short_hash(uint16_t short_addr)
+{
+    return (short_addr * 2654435761UL) >> 16;
+}
+
+static uint32_t esp_zb_registry_entry_hash(uint8_t type, uint16_t entry_index)
+{
+    const esp_zb_registry_device_t *device = &s_registry.entry[entry_index].device;
+
+    return type == ESP_ZB_REGISTRY_INDEX_IEEE ? esp_zb_registry_ieee_hash(device->ieee_addr) :
+           esp_zb_registry_short_hash(device->short_addr);
+}
+
+static void esp_zb_registry_index_insert(uint8_t type, uint16_t entry_index)
+{
+    uint32_t slot = esp_zb_registry_entry_hash(type, entry_index) & s_registry.index_mask;
+
+    while (s_registry.index[type][slot] != ESP_ZB_REGISTRY_INDEX_EMPTY &&
+            s_registry.index[type][slot] != ESP_ZB_REGISTRY_INDEX_DELETED) {
+        slot = (slot + 1) & s_registry.index_mask;
+    }
+    if (s_registry.index[type][slot] == ESP_ZB_REGISTRY_INDEX_DELETED) {
+        s_registry.deleted_num--;
+    }
+    s_registry.index[type][slot] = entry_index + 1;
+}
+
+static int32_t esp_zb_registry_ieee_find(const esp_zb_ieee_addr_t ieee_addr, uint32_t *index_slot)
+{
+    uint32_t slot = esp_zb_registry_ieee_hash(ieee_addr) & s_registry.index_mask;
+    uint16_t *index = s_registry.index[ESP_ZB_REGISTRY_INDEX_IEEE];
+
+    while (index[slot] != ESP_ZB_REGISTRY_INDEX_EMPTY) {
+        if (index[slot] != ESP_ZB_REGISTRY_INDEX_DELETED &&
+                !memcmp(s_registry.entry[index[slot] - 1].device.ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t))) {
+            if (index_slot) {
+                *index_slot = slot;
+            }
+            return index[slot] - 1;
+        }
+        slot = (slot + 1) & s_registry.index_mask;
+    }
+    return -1;
+}
+
+static int32_t esp_zb_registry_short_find(uint16_t short_addr, uint32_t *index_slot)
+{
+    uint32_t slot = esp_zb_registry_short_hash(short_addr) & s_registry.index_mask;
+    uint16_t *index = s_registry.index[ESP_ZB_REGISTRY_INDEX_SHORT];
+
+    while (index[slot] != ESP_ZB_REGISTRY_INDEX_EMPTY) {
+        if (index[slot] != ESP_ZB_REGISTRY_INDEX_DELETED && s_registry.entry[index[slot] - 1].device.short_addr == short_addr) {
+            if (index_slot) {
+                *index_slot = slot;
+            }
+            return index[slot] - 1;
+        }
+        slot = (slot + 1) & s_registry.index_mask;
+    }
+    return -1;
+}
+
+static void esp_zb_registry_index_rebuild(void)
+{
+    memset(s_registry.index[0], 0, (s_registry.index_mask + 1) * sizeof(uint16_t));
+    memset(s_registry.index[1], 0, (s_registry.index_mask + 1) * sizeof(uint16_t));
+    s_registry.deleted_num = 0;
+    for (uint16_t i = 0; i < s_registry.device_num; i++) {
+        esp_zb_registry_entry_t *entry = &s_registry.entry[i];
+
+        if (!entry->in_use) {
+            continue;
+        }
+        /* a duplicate left by an interrupted write is dropped */
+        if (esp_zb_registry_ieee_find(entry->device.ieee_addr, NULL) >= 0) {
+            entry->in_use = false;
+            continue;
+        }
+        esp_zb_registry_index_insert(ESP_ZB_REGISTRY_INDEX_IEEE, i);
+        if (entry->device.short_addr != ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN) {
+            if (esp_zb_registry_short_find(entry->device.short_addr, NULL) >= 0) {
+                entry->device.short_addr = ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN;
+            } else {
+                esp_zb_registry_index_insert(ESP_ZB_REGISTRY_INDEX_SHORT, i);
+            }
+        }
+    }
+}
+
+static void esp_zb_registry_index_remove(uint8_t type, uint32_t index_slot)
+{
+    s_registry.index[type][index_slot] = ESP_ZB_REGISTRY_INDEX_DELETED;
+    s_registry.deleted_num++;
+}
+
+/* rebuild the indexes once the deleted entries make up half of the device number */
+static void esp_zb_registry_index_compact(void)
+{
+    if (s_registry.deleted_num > s_registry.device_num / 2) {
+        esp_zb_registry_index_rebuild();
+    }
+}
+
+static esp_err_t esp_zb_registry_save(uint16_t entry_index)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = ESP_OK;
+    char key[16];
+
+    ESP_RETURN_ON_ERROR(nvs_open(ESP_ZB_REGISTRY_NVS_NAMESPACE, NVS_READWRITE, &handle), TAG, "Failed to open NVS");
+    snprintf(key, sizeof(key), "dev_%03x", entry_index);
+    if (s_registry.entry[entry_index].in_use) {
+        ret = nvs_set_blob(handle, key, &s_registry.entry[entry_index].device, sizeof(esp_zb_registry_device_t));
+    } else {
+        ret = nvs_erase_key(handle, key);
+        ret = ret == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : ret;
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to write device %d to NVS", entry_index);
+    s_registry.entry[entry_index].touched = false;
+    return ESP_OK;
+}
+
+static void esp_zb_registry_load(void)
+{
+    nvs_handle_t handle;
+    char key[16];
+
+    if (nvs_open(ESP_ZB_REGISTRY_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    for (uint16_t i = 0; i < s_registry.device_num; i++) {
+        size_t size = 0;
+
+        snprintf(key, sizeof(key), "dev_%03x", i);
+        /* a record of a different layout is dropped rather than misread */
+        if (nvs_get_blob(handle, key, NULL, &size) != ESP_OK || size != sizeof(esp_zb_registry_device_t)) {
+            continue;
+        }
+        s_registry.entry[i].in_use = nvs_get_blob(handle, key, &s_registry.entry[i].device, &size) == ESP_OK;
+    }
+    nvs_close(handle);
+}
+
+/* set the NWK address of a device, the address is taken from any other device holding it */
+static void esp_zb_registry_short_set(uint16_t entry_index, uint16_t short_addr)
+{
+    esp_zb_registry_device_t *device = &s_registry.entry[entry_index].device;
+    uint32_t index_slot = 0;
+    int32_t owner = -1;
+
+    if (device->short_addr == short_addr) {
+        return;
+    }
+    if (device->short_addr != ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN &&
+            esp_zb_registry_short_find(device->short_addr, &index_slot) == entry_index) {
+        esp_zb_registry_index_remove(ESP_ZB_REGISTRY_INDEX_SHORT, index_slot);
+    }
+    if (short_addr != ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN) {
+        owner = esp_zb_registry_short_find(short_addr, &index_slot);
+        if (owner >= 0) {
+            ESP_LOGW(TAG, "Address 0x%04hx moved to another device", short_addr);
+            esp_zb_registry_index_remove(ESP_ZB_REGISTRY_INDEX_SHORT, index_slot);
+            s_registry.entry[owner].device.short_addr = ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN;
+            esp_zb_registry_save(owner);
+        }
+    }
+    device->short_addr = short_addr;
+    if (short_addr != ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN) {
+        esp_zb_registry_index_insert(ESP_ZB_REGISTRY_INDEX_SHORT, entry_index);
+    }
+    esp_zb_registry_index_compact();
+}
+
+static void esp_zb_registry_flush_alarm(uint8_t param)
+{
+    s_registry.flush_scheduled = false;
+    esp_zb_registry_flush();
+}
+
+esp_err_t esp_zb_registry_init(uint16_t device_num)
+{
+    uint16_t index_size = 1;
+
+    ESP_RETURN_ON_FALSE(!s_registry.initialized, ESP_ERR_INVALID_STATE, TAG, "Registry is already initialized");
+    ESP_RETURN_ON_FALSE(device_num > 0 && device_num <= ESP_ZB_REGISTRY_DEVICE_MAX_NUM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid device number: %d", device_num);
+    /* keep the load factor of the indexes under one half, so the probe sequences stay short */
+    while (index_size < device_num * 2) {
+        index_size <<= 1;
+    }
+    s_registry.entry = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZDO, device_num, sizeof(esp_zb_registry_entry_t));
+    s_registry.index[0] = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZDO, index_size, sizeof(uint16_t));
+    s_registry.index[1] = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZDO, index_size, sizeof(uint16_t));
+    if (!s_registry.entry || !s_registry.index[0] || !s_registry.index[1]) {
+        esp_zb_mem_free(s_registry.entry);
+        esp_zb_mem_free(s_registry.index[0]);
+        esp_zb_mem_free(s_registry.index[1]);
+        memset(&s_registry, 0, sizeof(s_registry));
+        return ESP_ERR_NO_MEM;
+    }
+    s_registry.device_num = device_num;
+    s_registry.index_mask = index_size - 1;
+    esp_zb_registry_load();
+    esp_zb_registry_index_rebuild();
+    s_registry.initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_registry_deinit(void)
+{
+    if (s_registry.initialized) {
+        esp_zb_scheduler_alarm_cancel(esp_zb_registry_flush_alarm, 0);
+        esp_zb_registry_flush();
+        esp_zb_mem_free(s_registry.entry);
+        esp_zb_mem_free(s_registry.index[0]);
+        esp_zb_mem_free(s_registry.index[1]);
+        memset(&s_registry, 0, sizeof(s_registry));
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_registry_update(const esp_zb_registry_device_t *device)
+{
+    int32_t entry_index = -1;
+    uint16_t short_addr = 0;
+
+    ESP_RETURN_ON_FALSE(s_registry.initialized, ESP_ERR_INVALID_STATE, TAG, "Registry is not initialized");
+    ESP_RETURN_ON_FALSE(device && device->ep_count <= ESP_ZB_REGISTRY_EP_MAX_NUM, ESP_ERR_INVALID_ARG, TAG, "Invalid device");
+    for (uint8_t i = 0; i < device->ep_count; i++) {
+        ESP_RETURN_ON_FALSE(device->ep[i].input_cluster_count + device->ep[i].output_cluster_count <= ESP_ZB_REGISTRY_CLUSTER_MAX_NUM,
+                            ESP_ERR_INVALID_ARG, TAG, "Invalid cluster count of endpoint %d", device->ep[i].endpoint);
+    }
+    entry_index = esp_zb_registry_ieee_find(device->ieee_addr, NULL);
+    if (entry_index < 0) {
+        for (uint16_t i = 0; i < s_registry.device_num && entry_index < 0; i++) {
+            if (!s_registry.entry[i].in_use) {
+                entry_index = i;
+            }
+        }
+        ESP_RETURN_ON_FALSE(entry_index >= 0, ESP_ERR_NO_MEM, TAG, "Registry is full");
+        memset(&s_registry.entry[entry_index], 0, sizeof(esp_zb_registry_entry_t));
+        memcpy(s_registry.entry[entry_index].device.ieee_addr, device->ieee_addr, sizeof(esp_zb_ieee_addr_t));
+        s_registry.entry[entry_index].device.short_addr = ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN;
+        s_registry.entry[entry_index].in_use = true;
+        esp_zb_registry_index_insert(ESP_ZB_REGISTRY_INDEX_IEEE, entry_index);
+    }
+    esp_zb_registry_short_set(entry_index, device->short_addr);
+    short_addr = s_registry.entry[entry_index].device.short_addr;
+    s_registry.entry[entry_index].device = *device;
+    s_registry.entry[entry_index].device.short_addr = short_addr;
+    return esp_zb_registry_save(entry_index);
+}
+
+esp_err_t esp_zb_registry_update_from_interview(const esp_zb_interview_device_t *device)
+{
+    esp_zb_registry_device_t record;
+    const esp_zb_registry_device_t *known = NULL;
+
+    ESP_RETURN_ON_FALSE(device, ESP_ERR_INVALID_ARG, TAG, "Invalid device");
+    known = esp_zb_registry_find_by_ieee(device->ieee_addr);
+    memset(&record, 0, sizeof(record));
+    memcpy(record.ieee_addr, device->ieee_addr, sizeof(esp_zb_ieee_addr_t));
+    record.short_addr = device->short_addr;
+    record.manufacturer_code = device->node_desc.manufacturer_code;
+    record.capability = device->capability;
+    record.power_source = device->power_source;
+    record.lqi = known ? known->lqi : 0;
+    record.last_seen = known ? known->last_seen : ESP_ZB_TIME_INVALID;
+    record.ep_count = device->ep_count < ESP_ZB_REGISTRY_EP_MAX_NUM ? device->ep_count : ESP_ZB_REGISTRY_EP_MAX_NUM;
+    for (uint8_t i = 0; i < record.ep_count; i++) {
+        const esp_zb_interview_endpoint_t *src = &device->ep[i];
+        esp_zb_registry_endpoint_t *dst = &record.ep[i];
+        uint8_t in_count = src->input_cluster_count < ESP_ZB_REGISTRY_CLUSTER_MAX_NUM ? src->input_cluster_count :
+                           ESP_ZB_REGISTRY_CLUSTER_MAX_NUM;
+        uint8_t out_count = src->output_cluster_count < ESP_ZB_REGISTRY_CLUSTER_MAX_NUM - in_count ? src->output_cluster_count :
+                            ESP_ZB_REGISTRY_CLUSTER_MAX_NUM - in_count;
+
+        dst->endpoint = src->endpoint;
+        dst->profile_id = src->profile_id;
+        dst->device_id = src->device_id;
+        dst->input_cluster_count = in_count;
+        dst->output_cluster_count = out_count;
+        memcpy(dst->cluster_list, src->cluster_list, in_count * sizeof(uint16_t));
+        memcpy(&dst->cluster_list[in_count], &src->cluster_list[src->input_cluster_count], out_count * sizeof(uint16_t));
+    }
+    return esp_zb_registry_update(&record);
+}
+
+esp_err_t esp_zb_registry_remove(const esp_zb_ieee_addr_t ieee_addr)
+{
+    uint32_t index_slot = 0;
+    int32_t entry_index = -1;
+
+    ESP_RETURN_ON_FALSE(s_registry.initialized, ESP_ERR_INVALID_STATE, TAG, "Registry is not initialized");
+    entry_index = esp_zb_registry_ieee_find(ieee_addr, &index_slot);
+    if (entry_index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_zb_registry_short_set(entry_index, ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN);
+    /* the short address removal may have rebuilt the index */
+    entry_index = esp_zb_registry_ieee_find(ieee_addr, &index_slot);
+    esp_zb_registry_index_remove(ESP_ZB_REGISTRY_INDEX_IEEE, index_slot);
+    s_registry.entry[entry_index].in_use = false;
+    esp_zb_registry_index_compact();
+    return esp_zb_registry_save(entry_index);
+}
+
+const esp_zb_registry_device_t *esp_zb_registry_find_by_ieee(const esp_zb_ieee_addr_t ieee_addr)
+{
+    int32_t entry_index = s_registry.initialized ? esp_zb_registry_ieee_find(ieee_addr, NULL) : -1;
+
+    return entry_index >= 0 ? &s_registry.entry[entry_index].device : NULL;
+}
+
+const esp_zb_registry_device_t *esp_zb_registry_find_by_short(uint16_t short_addr)
+{
+    int32_t entry_index = s_registry.initialized && short_addr != ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN ?
+                          esp_zb_registry_short_find(short_addr, NULL) : -1;
+
+    return entry_index >= 0 ? &s_registry.entry[entry_index].device : NULL;
+}
+
+const esp_zb_registry_device_t *esp_zb_registry_get_next(uint16_t *iterator)
+{
+    if (!s_registry.initialized || !iterator) {
+        return NULL;
+    }
+    while (*iterator < s_registry.device_num) {
+        esp_zb_registry_entry_t *entry = &s_registry.entry[(*iterator)++];
+
+        if (entry->in_use) {
+            return &entry->device;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t esp_zb_registry_touch(uint16_t short_addr, uint8_t lqi)
+{
+    int32_t entry_index = s_registry.initialized && short_addr != ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN ?
+                          esp_zb_registry_short_find(short_addr, NULL) : -1;
+    esp_zb_registry_entry_t *entry = NULL;
+    uint32_t utc = ESP_ZB_TIME_INVALID;
+
+    if (entry_index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    entry = &s_registry.entry[entry_index];
+    if (esp_zb_time_get_utc(&utc) == ESP_OK) {
+        entry->device.last_seen = utc;
+    }
+    entry->device.lqi = lqi;
+    entry->touched = true;
+    if (!s_registry.flush_scheduled) {
+        s_registry.flush_scheduled = true;
+        esp_zb_scheduler_alarm(esp_zb_registry_flush_alarm, 0, ESP_ZB_REGISTRY_FLUSH_PERIOD);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_registry_flush(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = ESP_OK;
+    char key[16];
+
+    ESP_RETURN_ON_FALSE(s_registry.initialized, ESP_ERR_INVALID_STATE, TAG, "Registry is not initialized");
+    ESP_RETURN_ON_ERROR(nvs_open(ESP_ZB_REGISTRY_NVS_NAMESPACE, NVS_READWRITE, &handle), TAG, "Failed to open NVS");
+    for (uint16_t i = 0; i < s_registry.device_num && ret == ESP_OK; i++) {
+        esp_zb_registry_entry_t *entry = &s_registry.entry[i];
+
+        if (!entry->in_use || !entry->touched) {
+            continue;
+        }
+        snprintf(key, sizeof(key), "dev_%03x", i);
+        ret = nvs_set_blob(handle, key, &entry->device, sizeof(esp_zb_registry_device_t));
+        entry->touched = ret != ESP_OK;
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to write the devices to NVS");
+    return ESP_OK;
+}
+
+void esp_zb_registry_signal_handle(esp_zb_app_signal_t *signal_s)
+{
+    uint32_t sig_type = *signal_s->p_app_signal;
+
+    if (!s_registry.initialized || signal_s->esp_err_status != ESP_OK) {
+        return;
+    }
+    switch (sig_type) {
+    case ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE: {
+        esp_zb_zdo_signal_device_annce_params_t *params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+        int32_t entry_index = esp_zb_registry_ieee_find(params->ieee_addr, NULL);
+        uint32_t utc = ESP_ZB_TIME_INVALID;
+
+        if (entry_index < 0) {
+            esp_zb_registry_device_t device = {
+                .short_addr = params->device_short_addr,
+                .capability = params->capability,
+                .power_source = 0xff,
+                .last_seen = esp_zb_time_get_utc(&utc) == ESP_OK ? utc : ESP_ZB_TIME_INVALID,
+            };
+            memcpy(device.ieee_addr, params->ieee_addr, sizeof(esp_zb_ieee_addr_t));
+            esp_zb_registry_update(&device);
+        } else {
+            esp_zb_registry_short_set(entry_index, params->device_short_addr);
+            s_registry.entry[entry_index].device.capability = params->capability;
+            if (esp_zb_time_get_utc(&utc) == ESP_OK) {
+                s_registry.entry[entry_index].device.last_seen = utc;
+            }
+            esp_zb_registry_save(entry_index);
+        }
+        break;
+    }
+    case ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE: {
+        esp_zb_zdo_signal_device_update_params_t *params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+        int32_t entry_index = esp_zb_registry_ieee_find(params->long_addr, NULL);
+
+        /* status 0x02 is the device left, the device is added on its announcement otherwise */
+        if (params->status == 0x02) {
+            esp_zb_registry_remove(params->long_addr);
+        } else if (entry_index >= 0 && s_registry.entry[entry_index].device.short_addr != params->short_addr) {
+            esp_zb_registry_short_set(entry_index, params->short_addr);
+            esp_zb_registry_save(entry_index);
+        }
+        break;
+    }
+    case ESP_ZB_ZDO_SIGNAL_LEAVE_INDICATION: {
+        esp_zb_zdo_signal_leave_indication_params_t *params = esp_zb_app_signal_get_params(signal_s->p_app_signal);
+
+        if (!params->rejoin) {
+            esp_zb_registry_remove(params->device_addr);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
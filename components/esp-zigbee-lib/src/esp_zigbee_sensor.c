@@ -0,0 +1,246 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_sensor.h"
+
+static const char *TAG = "ESP_ZB_SENSOR";
+
+typedef struct esp_zb_sensor_s {
+    bool in_use;                                    /* slot is allocated */
+    bool running;                                   /* periodic sampling is scheduled */
+    bool written;                                   /* attribute has been written at least once */
+    esp_zb_sensor_cfg_t cfg;
+    int32_t window[ESP_ZB_SENSOR_WINDOW_MAX_SIZE];  /* ring buffer of the raw samples */
+    uint8_t head;                                   /* next slot of the ring buffer to write */
+    uint8_t count;                                  /* number of valid samples in the ring buffer */
+    int64_t ema_q8;                                 /* EMA state in Q24.8 fixed point */
+    esp_zb_sensor_stats_t stats;
+} esp_zb_sensor_t;
+
+static esp_zb_sensor_t s_sensor[ESP_ZB_SENSOR_MAX_NUM];
+
+static esp_zb_sensor_t *esp_zb_sensor_get(uint8_t sensor_id)
+{
+    if (sensor_id >= ESP_ZB_SENSOR_MAX_NUM || !s_sensor[sensor_id].in_use) {
+        return NULL;
+    }
+    return &s_sensor[sensor_id];
+}
+
+static bool esp_zb_sensor_attr_type_is_valid(esp_zb_zcl_attr_type_t attr_type)
+{
+    switch (attr_type) {
+    case ESP_ZB_ZCL_ATTR_TYPE_U8:
+    case ESP_ZB_ZCL_ATTR_TYPE_U16:
+    case ESP_ZB_ZCL_ATTR_TYPE_U32:
+    case ESP_ZB_ZCL_ATTR_TYPE_S8:
+    case ESP_ZB_ZCL_ATTR_TYPE_S16:
+    case ESP_ZB_ZCL_ATTR_TYPE_S32:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static int32_t esp_zb_sensor_clamp(int64_t value, int64_t min, int64_t max)
+{
+    return (int32_t)(value < min ? min : (value > max ? max : value));
+}
+
+/* median of the ring buffer, the window is at most ESP_ZB_SENSOR_WINDOW_MAX_SIZE so insertion sort is enough */
+static int32_t esp_zb_sensor_median(const esp_zb_sensor_t *sensor)
+{
+    int32_t sorted[ESP_ZB_SENSOR_WINDOW_MAX_SIZE];
+
+    for (uint8_t i = 0; i < sensor->count; i++) {
+        int32_t value = sensor->window[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    if (sensor->count & 0x01) {
+        return sorted[sensor->count / 2];
+    }
+    return (int32_t)(((int64_t)sorted[sensor->count / 2 - 1] + sorted[sensor->count / 2]) / 2);
+}
+
+static int32_t esp_zb_sensor_filter(esp_zb_sensor_t *sensor, int32_t value)
+{
+    sensor->window[sensor->head] = value;
+    sensor->head = (sensor->head + 1) % sensor->cfg.window_size;
+    if (sensor->count < sensor->cfg.window_size) {
+        sensor->count++;
+    }
+
+    switch (sensor->cfg.filter) {
+    case ESP_ZB_SENSOR_FILTER_EMA:
+        if (sensor->stats.sample_count == 0) {
+            sensor->ema_q8 = (int64_t)value * 256;
+        } else {
+            sensor->ema_q8 += (((int64_t)value * 256 - sensor->ema_q8) * sensor->cfg.ema_alpha) / 256;
+        }
+        return (int32_t)(sensor->ema_q8 / 256);
+    case ESP_ZB_SENSOR_FILTER_MEDIAN:
+        return esp_zb_sensor_median(sensor);
+    default:
+        return value;
+    }
+}
+
+static esp_zb_zcl_status_t esp_zb_sensor_write_attr(esp_zb_sensor_t *sensor, int32_t value)
+{
+    union {
+        uint8_t u8;
+        uint16_t u16;
+        uint32_t u32;
+        int8_t s8;
+        int16_t s16;
+        int32_t s32;
+    } attr_value;
+
+    switch (sensor->cfg.attr_type) {
+    case ESP_ZB_ZCL_ATTR_TYPE_U8:
+        attr_value.u8 = (uint8_t)esp_zb_sensor_clamp(value, 0, UINT8_MAX);
+        break;
+    case ESP_ZB_ZCL_ATTR_TYPE_U16:
+        attr_value.u16 = (uint16_t)esp_zb_sensor_clamp(value, 0, UINT16_MAX);
+        break;
+    case ESP_ZB_ZCL_ATTR_TYPE_U32:
+        attr_value.u32 = (uint32_t)(value < 0 ? 0 : value);
+        break;
+    case ESP_ZB_ZCL_ATTR_TYPE_S8:
+        attr_value.s8 = (int8_t)esp_zb_sensor_clamp(value, INT8_MIN, INT8_MAX);
+        break;
+    case ESP_ZB_ZCL_ATTR_TYPE_S16:
+        attr_value.s16 = (int16_t)esp_zb_sensor_clamp(value, INT16_MIN, INT16_MAX);
+        break;
+    default:
+        attr_value.s32 = value;
+        break;
+    }
+    return esp_zb_zcl_set_attribute_val(sensor->cfg.endpoint, sensor->cfg.cluster_id, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                        sensor->cfg.attr_id, &attr_value);
+}
+
+static void esp_zb_sensor_process(esp_zb_sensor_t *sensor, int32_t value)
+{
+    int32_t filtered = esp_zb_sensor_filter(sensor, value);
+    int64_t delta = (int64_t)filtered - sensor->stats.written_value;
+
+    sensor->stats.sample_count++;
+    sensor->stats.filtered_value = filtered;
+    if (delta < 0) {
+        delta = -delta;
+    }
+    /* only a meaningful change reaches the data model, reporting and NVS */
+    if (sensor->written && (delta == 0 || delta < sensor->cfg.reportable_change)) {
+        return;
+    }
+    if (esp_zb_sensor_write_attr(sensor, filtered) != ESP_ZB_ZCL_STATUS_SUCCESS) {
+        ESP_LOGW(TAG, "Failed to write attribute (endpoint: %d, cluster: 0x%04x, attribute: 0x%04x)", sensor->cfg.endpoint,
+                 sensor->cfg.cluster_id, sensor->cfg.attr_id);
+        return;
+    }
+    sensor->written = true;
+    sensor->stats.written_value = filtered;
+    sensor->stats.attr_write_count++;
+}
+
+static void esp_zb_sensor_sample_alarm(uint8_t sensor_id)
+{
+    esp_zb_sensor_t *sensor = esp_zb_sensor_get(sensor_id);
+    int32_t value = 0;
+
+    if (!sensor || !sensor->running) {
+        return;
+    }
+    if (sensor->cfg.sample_cb(&value, sensor->cfg.user_ctx) == ESP_OK) {
+        esp_zb_sensor_process(sensor, value);
+    } else {
+        sensor->stats.sample_fail_count++;
+    }
+    esp_zb_scheduler_alarm(esp_zb_sensor_sample_alarm, sensor_id, sensor->cfg.sample_period);
+}
+
+esp_err_t esp_zb_sensor_create(const esp_zb_sensor_cfg_t *cfg, uint8_t *sensor_id)
+{
+    ESP_RETURN_ON_FALSE(cfg && sensor_id, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(esp_zb_sensor_attr_type_is_valid(cfg->attr_type), ESP_ERR_INVALID_ARG, TAG,
+                        "Unsupported attribute type: 0x%x", cfg->attr_type);
+    ESP_RETURN_ON_FALSE(cfg->window_size > 0 && cfg->window_size <= ESP_ZB_SENSOR_WINDOW_MAX_SIZE, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid window size: %d", cfg->window_size);
+    ESP_RETURN_ON_FALSE(!cfg->sample_cb || cfg->sample_period > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid sample period");
+
+    for (uint8_t i = 0; i < ESP_ZB_SENSOR_MAX_NUM; i++) {
+        if (!s_sensor[i].in_use) {
+            memset(&s_sensor[i], 0, sizeof(esp_zb_sensor_t));
+            s_sensor[i].cfg = *cfg;
+            if (s_sensor[i].cfg.ema_alpha == 0) {
+                s_sensor[i].cfg.ema_alpha = ESP_ZB_SENSOR_EMA_ALPHA_DEFAULT;
+            }
+            s_sensor[i].in_use = true;
+            *sensor_id = i;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_zb_sensor_delete(uint8_t sensor_id)
+{
+    ESP_RETURN_ON_ERROR(esp_zb_sensor_stop(sensor_id), TAG, "Sensor %d does not exist", sensor_id);
+    s_sensor[sensor_id].in_use = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_sensor_start(uint8_t sensor_id)
+{
+    esp_zb_sensor_t *sensor = esp_zb_sensor_get(sensor_id);
+
+    ESP_RETURN_ON_FALSE(sensor, ESP_ERR_NOT_FOUND, TAG, "Sensor %d does not exist", sensor_id);
+    if (sensor->cfg.sample_cb && !sensor->running) {
+        sensor->running = true;
+        esp_zb_scheduler_alarm(esp_zb_sensor_sample_alarm, sensor_id, sensor->cfg.sample_period);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_sensor_stop(uint8_t sensor_id)
+{
+    esp_zb_sensor_t *sensor = esp_zb_sensor_get(sensor_id);
+
+    ESP_RETURN_ON_FALSE(sensor, ESP_ERR_NOT_FOUND, TAG, "Sensor %d does not exist", sensor_id);
+    if (sensor->running) {
+        sensor->running = false;
+        esp_zb_scheduler_alarm_cancel(esp_zb_sensor_sample_alarm, sensor_id);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_sensor_push_sample(uint8_t sensor_id, int32_t value)
+{
+    esp_zb_sensor_t *sensor = esp_zb_sensor_get(sensor_id);
+
+    ESP_RETURN_ON_FALSE(sensor, ESP_ERR_NOT_FOUND, TAG, "Sensor %d does not exist", sensor_id);
+    esp_zb_sensor_process(sensor, value);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_sensor_get_stats(uint8_t sensor_id, esp_zb_sensor_stats_t *stats)
+{
+    esp_zb_sensor_t *sensor = esp_zb_sensor_get(sensor_id);
+
+    ESP_RETURN_ON_FALSE(sensor && stats, ESP_ERR_NOT_FOUND, TAG, "Sensor %d does not exist", sensor_id);
+    *stats = sensor->stats;
+    return ESP_OK;
+}
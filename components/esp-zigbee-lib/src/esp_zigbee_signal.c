@@ -0,0 +1,177 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_zigbee_signal.h"
+
+#define ESP_ZB_SIGNAL_NONE      0xff                /* the end of a subscriber list */
+
+static const char *TAG = "ESP_ZB_SIGNAL";
+
+typedef struct esp_zb_signal_subscriber_s {
+    esp_zb_signal_callback_t cb;                    /* NULL once unsubscribed, until it is unlinked */
+    void *ctx;
+    uint8_t next;
+} esp_zb_signal_subscriber_t;
+
+typedef struct esp_zb_signal_registry_s {
+    bool initialized;
+    bool dispatching;
+    bool purge_pending;                             /* a subscriber was unsubscribed during a dispatch */
+    uint8_t free_head;
+    uint8_t head[ESP_ZB_SIGNAL_TYPE_MAX_NUM];
+    esp_zb_signal_subscriber_t subscribers[ESP_ZB_SIGNAL_SUBSCRIBER_MAX_NUM];
+} esp_zb_signal_registry_t;
+
+static esp_zb_signal_registry_t s_signal;
+
+static void esp_zb_signal_registry_init(void)
+{
+    memset(s_signal.head, ESP_ZB_SIGNAL_NONE, sizeof(s_signal.head));
+    for (uint8_t i = 0; i < ESP_ZB_SIGNAL_SUBSCRIBER_MAX_NUM; i++) {
+        s_signal.subscribers[i].next = i + 1 < ESP_ZB_SIGNAL_SUBSCRIBER_MAX_NUM ? i + 1 : ESP_ZB_SIGNAL_NONE;
+    }
+    s_signal.free_head = 0;
+    s_signal.initialized = true;
+}
+
+static void esp_zb_signal_purge(void)
+{
+    for (uint8_t type = 0; type < ESP_ZB_SIGNAL_TYPE_MAX_NUM; type++) {
+        uint8_t *link = &s_signal.head[type];
+        while (*link != ESP_ZB_SIGNAL_NONE) {
+            uint8_t index = *link;
+            if (s_signal.subscribers[index].cb) {
+                link = &s_signal.subscribers[index].next;
+                continue;
+            }
+            *link = s_signal.subscribers[index].next;
+            s_signal.subscribers[index].next = s_signal.free_head;
+            s_signal.free_head = index;
+        }
+    }
+    s_signal.purge_pending = false;
+}
+
+esp_err_t esp_zb_signal_subscribe(esp_zb_app_signal_type_t type, esp_zb_signal_callback_t cb, void *ctx)
+{
+    uint8_t *link = NULL;
+    uint8_t index = 0;
+
+    ESP_RETURN_ON_FALSE((uint32_t)type < ESP_ZB_SIGNAL_TYPE_MAX_NUM && cb, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    if (!s_signal.initialized) {
+        esp_zb_signal_registry_init();
+    }
+    if (s_signal.free_head == ESP_ZB_SIGNAL_NONE && s_signal.purge_pending && !s_signal.dispatching) {
+        esp_zb_signal_purge();
+    }
+    ESP_RETURN_ON_FALSE(s_signal.free_head != ESP_ZB_SIGNAL_NONE, ESP_ERR_NO_MEM, TAG, "Too many signal subscriptions");
+    index = s_signal.free_head;
+    s_signal.free_head = s_signal.subscribers[index].next;
+    s_signal.subscribers[index].cb = cb;
+    s_signal.subscribers[index].ctx = ctx;
+    s_signal.subscribers[index].next = ESP_ZB_SIGNAL_NONE;
+    /* append, so the subscribers run in the order of their subscription */
+    link = &s_signal.head[type];
+    while (*link != ESP_ZB_SIGNAL_NONE) {
+        link = &s_signal.subscribers[*link].next;
+    }
+    *link = index;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_signal_unsubscribe(esp_zb_app_signal_type_t type, esp_zb_signal_callback_t cb, void *ctx)
+{
+    ESP_RETURN_ON_FALSE(s_signal.initialized && (uint32_t)type < ESP_ZB_SIGNAL_TYPE_MAX_NUM, ESP_ERR_NOT_FOUND, TAG,
+                        "Signal subscription not found");
+    for (uint8_t index = s_signal.head[type]; index != ESP_ZB_SIGNAL_NONE; index = s_signal.subscribers[index].next) {
+        if (s_signal.subscribers[index].cb == cb && s_signal.subscribers[index].ctx == ctx) {
+            /* the list is walked by the dispatch, the subscriber is only unlinked once it is over */
+            s_signal.subscribers[index].cb = NULL;
+            s_signal.purge_pending = true;
+            if (!s_signal.dispatching) {
+                esp_zb_signal_purge();
+            }
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+bool esp_zb_signal_dispatch(const esp_zb_app_signal_t *signal_s)
+{
+    esp_zb_signal_t signal = {0};
+    bool dispatched = false;
+    bool nested = s_signal.dispatching;
+    uint8_t last = ESP_ZB_SIGNAL_NONE;
+
+    if (!s_signal.initialized || !signal_s || !signal_s->p_app_signal) {
+        return false;
+    }
+    signal.type = *signal_s->p_app_signal;
+    signal.status = signal_s->esp_err_status;
+    signal.p_app_signal = signal_s->p_app_signal;
+    if ((uint32_t)signal.type >= ESP_ZB_SIGNAL_TYPE_MAX_NUM) {
+        return false;
+    }
+    /* the subscriptions made by the callbacks are appended behind the last subscriber of now, which ends the walk */
+    for (uint8_t index = s_signal.head[signal.type]; index != ESP_ZB_SIGNAL_NONE; index = s_signal.subscribers[index].next) {
+        last = index;
+    }
+    s_signal.dispatching = true;
+    for (uint8_t index = s_signal.head[signal.type]; last != ESP_ZB_SIGNAL_NONE; index = s_signal.subscribers[index].next) {
+        esp_zb_signal_subscriber_t *subscriber = &s_signal.subscribers[index];
+        if (subscriber->cb) {
+            subscriber->cb(&signal, subscriber->ctx);
+            dispatched = true;
+        }
+        if (index == last) {
+            break;
+        }
+    }
+    s_signal.dispatching = nested;
+    if (!nested && s_signal.purge_pending) {
+        esp_zb_signal_purge();
+    }
+    return dispatched;
+}
+
+static void *esp_zb_signal_params_get(const esp_zb_signal_t *signal, esp_zb_app_signal_type_t type)
+{
+    return signal && signal->type == type ? esp_zb_app_signal_get_params(signal->p_app_signal) : NULL;
+}
+
+esp_zb_zdo_signal_device_annce_params_t *esp_zb_signal_get_device_annce_params(const esp_zb_signal_t *signal)
+{
+    return esp_zb_signal_params_get(signal, ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE);
+}
+
+esp_zb_zdo_signal_leave_params_t *esp_zb_signal_get_leave_params(const esp_zb_signal_t *signal)
+{
+    return esp_zb_signal_params_get(signal, ESP_ZB_ZDO_SIGNAL_LEAVE);
+}
+
+esp_zb_zdo_signal_leave_indication_params_t *esp_zb_signal_get_leave_indication_params(const esp_zb_signal_t *signal)
+{
+    return esp_zb_signal_params_get(signal, ESP_ZB_ZDO_SIGNAL_LEAVE_INDICATION);
+}
+
+esp_zb_zdo_signal_can_sleep_params_t *esp_zb_signal_get_can_sleep_params(const esp_zb_signal_t *signal)
+{
+    return esp_zb_signal_params_get(signal, ESP_ZB_COMMON_SIGNAL_CAN_SLEEP);
+}
+
+esp_zb_zdo_signal_macsplit_dev_boot_params_t *esp_zb_signal_get_macsplit_dev_boot_params(const esp_zb_signal_t *signal)
+{
+    return esp_zb_signal_params_get(signal, ESP_ZB_MACSPLIT_DEVICE_BOOT);
+}
+
+esp_zb_zdo_signal_device_update_params_t *esp_zb_signal_get_device_update_params(const esp_zb_signal_t *signal)
+{
+    return esp_zb_signal_params_get(signal, ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE);
+}
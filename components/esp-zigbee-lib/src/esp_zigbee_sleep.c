@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "esp_zigbee_sleep.h"
+
+static const char *TAG = "ESP_ZB_SLEEP";
+
+typedef struct esp_zb_sleep_s {
+    bool initialized;
+    bool deadline_valid;
+    int64_t deadline;                               /* the time in microsecond of the next stack deadline */
+    int64_t wakeup_time;                            /* the time in microsecond of the last wake-up */
+    esp_zb_sleep_cfg_t cfg;
+    esp_zb_sleep_stats_t stats;
+} esp_zb_sleep_t;
+
+static esp_zb_sleep_t s_sleep;
+
+static const char *esp_zb_sleep_reason_name(esp_zb_sleep_wakeup_reason_t reason)
+{
+    static const char *names[] = {"none", "timer", "gpio", "uart", "other"};
+
+    return reason < ESP_ZB_SLEEP_WAKEUP_MAX ? names[reason] : "unknown";
+}
+
+static void esp_zb_sleep_gpio_wakeup_set(bool enable)
+{
+    for (uint8_t pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (!(s_sleep.cfg.gpio_wakeup_mask & (1ULL << pin))) {
+            continue;
+        }
+        if (enable) {
+            gpio_wakeup_enable(pin, s_sleep.cfg.gpio_wakeup_high ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+        } else {
+            gpio_wakeup_disable(pin);
+        }
+    }
+}
+
+esp_err_t esp_zb_sleep_init(const esp_zb_sleep_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(!(cfg->gpio_wakeup_mask >> GPIO_NUM_MAX), ESP_ERR_INVALID_ARG, TAG, "Invalid wake-up GPIO mask");
+    if (s_sleep.initialized) {
+        esp_zb_sleep_deinit();
+    }
+    memset(&s_sleep, 0, sizeof(s_sleep));
+    s_sleep.cfg = *cfg;
+    if (cfg->gpio_wakeup_mask) {
+        esp_zb_sleep_gpio_wakeup_set(true);
+        ESP_RETURN_ON_ERROR(esp_sleep_enable_gpio_wakeup(), TAG, "Failed to enable the GPIO wake-up");
+    }
+    s_sleep.wakeup_time = esp_timer_get_time();
+    s_sleep.initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_sleep_deinit(void)
+{
+    if (s_sleep.initialized && s_sleep.cfg.gpio_wakeup_mask) {
+        esp_zb_sleep_gpio_wakeup_set(false);
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    }
+    s_sleep.initialized = false;
+    return ESP_OK;
+}
+
+void esp_zb_sleep_deadline_update(uint32_t sleep_tmo)
+{
+    s_sleep.deadline = esp_timer_get_time() + (int64_t)sleep_tmo * 1000;
+    s_sleep.deadline_valid = true;
+}
+
+esp_err_t esp_zb_sleep_get_next_deadline(uint32_t *time)
+{
+    int64_t remaining = 0;
+
+    ESP_RETURN_ON_FALSE(time, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(s_sleep.deadline_valid, ESP_ERR_INVALID_STATE, TAG, "Stack is busy");
+    remaining = (s_sleep.deadline - esp_timer_get_time()) / 1000;
+    *time = remaining > 0 ? (remaining > UINT32_MAX ? UINT32_MAX : (uint32_t)remaining) : 0;
+    return ESP_OK;
+}
+
+static esp_zb_sleep_wakeup_reason_t esp_zb_sleep_reason_get(void)
+{
+    switch (esp_sleep_get_wakeup_cause()) {
+    case ESP_SLEEP_WAKEUP_TIMER:
+        return ESP_ZB_SLEEP_WAKEUP_TIMER;
+    case ESP_SLEEP_WAKEUP_GPIO:
+        return ESP_ZB_SLEEP_WAKEUP_GPIO;
+    case ESP_SLEEP_WAKEUP_UART:
+        return ESP_ZB_SLEEP_WAKEUP_UART;
+    default:
+        return ESP_ZB_SLEEP_WAKEUP_OTHER;
+    }
+}
+
+esp_err_t esp_zb_sleep_light(esp_zb_sleep_wakeup_reason_t *reason)
+{
+    esp_zb_sleep_wakeup_reason_t wakeup_reason = ESP_ZB_SLEEP_WAKEUP_NONE;
+    esp_err_t ret = ESP_OK;
+    uint32_t deadline = 0;
+    int64_t start = 0;
+    int64_t slept = 0;
+
+    ESP_RETURN_ON_FALSE(s_sleep.initialized, ESP_ERR_INVALID_STATE, TAG, "Sleep helper is not initialized");
+    ESP_RETURN_ON_ERROR(esp_zb_sleep_get_next_deadline(&deadline), TAG, "No deadline to sleep until");
+    /* the deadline is consumed, the stack must run again before the next sleep */
+    s_sleep.deadline_valid = false;
+    if (deadline < s_sleep.cfg.threshold + s_sleep.cfg.guard_time) {
+        s_sleep.stats.skip_count++;
+    } else {
+        ESP_RETURN_ON_ERROR(esp_sleep_enable_timer_wakeup((uint64_t)(deadline - s_sleep.cfg.guard_time) * 1000), TAG,
+                            "Failed to enable the timer wake-up");
+        start = esp_timer_get_time();
+        ret = esp_light_sleep_start();
+        slept = esp_timer_get_time() - start;
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+        ESP_RETURN_ON_ERROR(ret, TAG, "Failed to enter light sleep");
+        wakeup_reason = esp_zb_sleep_reason_get();
+        s_sleep.stats.sleep_count++;
+        s_sleep.stats.sleep_time += slept;
+        s_sleep.stats.awake_time += start - s_sleep.wakeup_time;
+        if (s_sleep.cfg.trace) {
+            ESP_LOGI(TAG, "trace,%" PRId64 ",%" PRId64 ",%s", start - s_sleep.wakeup_time, slept,
+                     esp_zb_sleep_reason_name(wakeup_reason));
+        }
+        s_sleep.wakeup_time = esp_timer_get_time();
+    }
+    s_sleep.stats.wakeup_count[wakeup_reason]++;
+    if (reason) {
+        *reason = wakeup_reason;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_sleep_get_stats(esp_zb_sleep_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *stats = s_sleep.stats;
+    return ESP_OK;
+}
@@ -0,0 +1,299 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "esp_zigbee_startup.h"
+
+#define ESP_ZB_STARTUP_NVS_NAMESPACE        "zb_startup"
+#define ESP_ZB_STARTUP_NVS_KEY              "network"
+#define ESP_ZB_STARTUP_BACKOFF_SHIFT_MAX    6       /* the backoff stops doubling after this number of retries */
+
+static const char *TAG = "ESP_ZB_STARTUP";
+
+/* the network parameters stored in NVS by the fast rejoin */
+typedef struct esp_zb_startup_network_s {
+    uint8_t channel;
+    uint16_t pan_id;
+    uint16_t short_addr;
+    esp_zb_ieee_addr_t extended_pan_id;
+} esp_zb_startup_network_t;
+
+typedef struct esp_zb_startup_s {
+    esp_zb_startup_cfg_t cfg;
+    esp_zb_startup_record_t record;
+    esp_zb_startup_network_t network;
+    bool network_valid;                             /* the network parameters are loaded from or stored in NVS */
+    bool rejoining;                                 /* the primary channel set is narrowed to the stored channel */
+    uint8_t retry_count;
+} esp_zb_startup_t;
+
+static esp_zb_startup_t s_startup;
+
+static const char *s_startup_phase_name[ESP_ZB_STARTUP_PHASE_MAX] = {
+    "radio_init", "stack_init", "start", "nvs_loaded", "rcp_ready", "stack_ready", "joined", "first_poll", "first_command",
+};
+
+static void esp_zb_startup_stamp(esp_zb_startup_phase_t phase)
+{
+    if (!s_startup.record.time[phase]) {
+        s_startup.record.time[phase] = esp_timer_get_time();
+        ESP_LOGD(TAG, "Phase %s at %lld us", s_startup_phase_name[phase], (long long)s_startup.record.time[phase]);
+    }
+}
+
+#if CONFIG_ZB_STARTUP_TRACE_STACK_CALLS
+/* the entry points of the stack are timed through the linker wrapping, refer to CMakeLists.txt */
+esp_err_t __real_esp_zb_platform_config(esp_zb_platform_config_t *config);
+void __real_esp_zb_init(esp_zb_cfg_t *nwk_cfg);
+esp_err_t __real_esp_zb_start(bool autostart);
+
+esp_err_t __wrap_esp_zb_platform_config(esp_zb_platform_config_t *config);
+void __wrap_esp_zb_init(esp_zb_cfg_t *nwk_cfg);
+esp_err_t __wrap_esp_zb_start(bool autostart);
+
+esp_err_t __wrap_esp_zb_platform_config(esp_zb_platform_config_t *config)
+{
+    esp_err_t ret = __real_esp_zb_platform_config(config);
+
+    esp_zb_startup_stamp(ESP_ZB_STARTUP_PHASE_RADIO_INIT);
+    return ret;
+}
+
+void __wrap_esp_zb_init(esp_zb_cfg_t *nwk_cfg)
+{
+    __real_esp_zb_init(nwk_cfg);
+    esp_zb_startup_stamp(ESP_ZB_STARTUP_PHASE_STACK_INIT);
+}
+
+esp_err_t __wrap_esp_zb_start(bool autostart)
+{
+    esp_err_t ret = ESP_OK;
+
+    esp_zb_startup_stamp(ESP_ZB_STARTUP_PHASE_START);
+    ret = __real_esp_zb_start(autostart);
+    esp_zb_startup_stamp(ESP_ZB_STARTUP_PHASE_NVS_LOADED);
+    return ret;
+}
+#endif
+
+static void esp_zb_startup_network_load(void)
+{
+    nvs_handle_t handle;
+    size_t size = sizeof(esp_zb_startup_network_t);
+
+    if (nvs_open(ESP_ZB_STARTUP_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    s_startup.network_valid = nvs_get_blob(handle, ESP_ZB_STARTUP_NVS_KEY, &s_startup.network, &size) == ESP_OK &&
+                              size == sizeof(esp_zb_startup_network_t) &&
+                              s_startup.network.channel < 32 &&
+                              ((1UL << s_startup.network.channel) & ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_MASK);
+    nvs_close(handle);
+}
+
+static void esp_zb_startup_network_store(const esp_zb_startup_network_t *network)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = ESP_OK;
+
+    /* the parameters are written only when they change, a device rejoining at each boot does not wear the flash */
+    if (network && s_startup.network_valid && !memcmp(&s_startup.network, network, sizeof(esp_zb_startup_network_t))) {
+        return;
+    }
+    ret = nvs_open(ESP_ZB_STARTUP_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = network ? nvs_set_blob(handle, ESP_ZB_STARTUP_NVS_KEY, network, sizeof(esp_zb_startup_network_t))
+              : nvs_erase_key(handle, ESP_ZB_STARTUP_NVS_KEY);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (ret != ESP_OK && ret != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Failed to store the network parameters (status: %s)", esp_err_to_name(ret));
+    }
+    s_startup.network_valid = network != NULL;
+    if (network) {
+        s_startup.network = *network;
+    }
+}
+
+static void esp_zb_startup_rejoin(uint8_t param)
+{
+    esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_INITIALIZATION);
+}
+
+static void esp_zb_startup_rejoin_end(void)
+{
+    if (s_startup.rejoining) {
+        esp_zb_set_primary_network_channel_set(s_startup.cfg.channel_mask);
+        s_startup.rejoining = false;
+    }
+    s_startup.retry_count = 0;
+}
+
+static bool esp_zb_startup_rejoin_retry(void)
+{
+    uint16_t backoff = s_startup.cfg.rejoin_backoff;
+    uint8_t shift = s_startup.retry_count;
+    uint32_t delay = 0;
+
+    if (!s_startup.rejoining || s_startup.retry_count >= s_startup.cfg.rejoin_retry_max) {
+        return false;
+    }
+    if (shift > ESP_ZB_STARTUP_BACKOFF_SHIFT_MAX) {
+        shift = ESP_ZB_STARTUP_BACKOFF_SHIFT_MAX;
+    }
+    delay = ((uint32_t)backoff << shift) + esp_random() % backoff;
+    s_startup.retry_count++;
+    ESP_LOGI(TAG, "Rejoin retry %d in %" PRIu32 " ms", s_startup.retry_count, delay);
+    esp_zb_scheduler_alarm(esp_zb_startup_rejoin, 0, delay);
+    return true;
+}
+
+/* the first join of the boot is traced, the network is stored at each join as the device may have moved to another */
+static void esp_zb_startup_joined(void)
+{
+    esp_zb_startup_network_t network = {0};
+
+    if (!s_startup.record.time[ESP_ZB_STARTUP_PHASE_JOINED]) {
+        esp_zb_startup_stamp(ESP_ZB_STARTUP_PHASE_JOINED);
+        s_startup.record.channel = esp_zb_get_current_channel();
+    }
+    if (s_startup.cfg.fast_rejoin) {
+        network.channel = esp_zb_get_current_channel();
+        network.pan_id = esp_zb_get_pan_id();
+        network.short_addr = esp_zb_get_short_address();
+        esp_zb_get_extended_pan_id(network.extended_pan_id);
+        esp_zb_startup_network_store(&network);
+    }
+}
+
+esp_err_t esp_zb_startup_config(const esp_zb_startup_cfg_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg && (!cfg->fast_rejoin || (cfg->channel_mask &&
+                        !(cfg->channel_mask & ~ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_MASK))), ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid startup configuration");
+    s_startup.cfg = *cfg;
+    if (!s_startup.cfg.rejoin_retry_max) {
+        s_startup.cfg.rejoin_retry_max = ESP_ZB_STARTUP_REJOIN_RETRY_MAX;
+    }
+    if (!s_startup.cfg.rejoin_backoff) {
+        s_startup.cfg.rejoin_backoff = ESP_ZB_STARTUP_REJOIN_BACKOFF;
+    }
+    s_startup.network_valid = false;
+    if (s_startup.cfg.fast_rejoin) {
+        esp_zb_startup_network_load();
+    }
+    return ESP_OK;
+}
+
+bool esp_zb_startup_signal_handle(esp_zb_app_signal_t *signal_s)
+{
+    uint32_t sig_type = *signal_s->p_app_signal;
+    esp_err_t status = signal_s->esp_err_status;
+
+    switch (sig_type) {
+    case ESP_ZB_MACSPLIT_DEVICE_BOOT:
+        esp_zb_startup_stamp(ESP_ZB_STARTUP_PHASE_RCP_READY);
+        break;
+    case ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP:
+        esp_zb_startup_stamp(ESP_ZB_STARTUP_PHASE_STACK_READY);
+        if (s_startup.cfg.fast_rejoin && s_startup.network_valid && !s_startup.rejoining) {
+            /* the rejoin the BDB initialization of the application starts only looks for the parent on the channel the
+             * network was last seen on */
+            ESP_LOGI(TAG, "Fast rejoin on channel %d (PAN ID: 0x%04hx)", s_startup.network.channel,
+                     s_startup.network.pan_id);
+            s_startup.rejoining = true;
+            esp_zb_set_primary_network_channel_set(1UL << s_startup.network.channel);
+        }
+        break;
+    case ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START:
+        /* the device is factory new, the parameters stored were left by a network it is no longer on */
+        esp_zb_startup_rejoin_end();
+        if (s_startup.network_valid) {
+            esp_zb_startup_network_store(NULL);
+        }
+        break;
+    case ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT:
+        s_startup.record.rejoin_count++;
+        if (status == ESP_OK) {
+            s_startup.record.fast_rejoin = s_startup.rejoining;
+            esp_zb_startup_rejoin_end();
+            esp_zb_startup_joined();
+        } else if (esp_zb_startup_rejoin_retry()) {
+            return true;
+        } else {
+            esp_zb_startup_rejoin_end();
+        }
+        break;
+    case ESP_ZB_BDB_SIGNAL_STEERING:
+    case ESP_ZB_BDB_SIGNAL_FORMATION:
+        if (status == ESP_OK) {
+            esp_zb_startup_joined();
+        }
+        break;
+    case ESP_ZB_COMMON_SIGNAL_CAN_SLEEP:
+        /* the stack lets the end device sleep once the data polled from its parent is handled */
+        if (s_startup.record.time[ESP_ZB_STARTUP_PHASE_JOINED]) {
+            esp_zb_startup_stamp(ESP_ZB_STARTUP_PHASE_FIRST_POLL);
+        }
+        break;
+    case ESP_ZB_ZDO_SIGNAL_LEAVE:
+        if (status == ESP_OK && s_startup.network_valid) {
+            esp_zb_startup_network_store(NULL);
+        }
+        break;
+    default:
+        break;
+    }
+    return false;
+}
+
+esp_err_t esp_zb_startup_mark(esp_zb_startup_phase_t phase)
+{
+    ESP_RETURN_ON_FALSE((uint32_t)phase < ESP_ZB_STARTUP_PHASE_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid phase");
+    esp_zb_startup_stamp(phase);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_startup_get_record(esp_zb_startup_record_t *record)
+{
+    ESP_RETURN_ON_FALSE(record, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    *record = s_startup.record;
+    return ESP_OK;
+}
+
+const char *esp_zb_startup_phase_to_name(esp_zb_startup_phase_t phase)
+{
+    return (uint32_t)phase < ESP_ZB_STARTUP_PHASE_MAX ? s_startup_phase_name[phase] : "unknown";
+}
+
+void esp_zb_startup_dump(void)
+{
+    int64_t previous = 0;
+
+    printf("%-14s %12s %12s\n", "phase", "time_us", "delta_us");
+    for (uint8_t i = 0; i < ESP_ZB_STARTUP_PHASE_MAX; i++) {
+        if (!s_startup.record.time[i]) {
+            printf("%-14s %12s %12s\n", s_startup_phase_name[i], "-", "-");
+            continue;
+        }
+        printf("%-14s %12lld %12lld\n", s_startup_phase_name[i], (long long)s_startup.record.time[i],
+               (long long)(s_startup.record.time[i] - previous));
+        previous = s_startup.record.time[i];
+    }
+    printf("Rejoin attempts: %d, fast rejoin: %s, channel: %d\n", s_startup.record.rejoin_count,
+           s_startup.record.fast_rejoin ? "yes" : "no", s_startup.record.channel);
+}
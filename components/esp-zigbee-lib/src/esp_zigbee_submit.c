@@ -0,0 +1,192 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_zigbee_submit.h"
+#include "esp_zigbee_mem.h"
+#include "esp_zigbee_profiler.h"
+#include "zboss_api.h"
+
+static const char *TAG = "ESP_ZB_SUBMIT";
+
+/* a slot is free for the producer of position pos when its sequence is pos, and holds the submission of position pos
+ * for the consumer when its sequence is pos + 1, the consumer frees it for the next lap with pos + size */
+typedef struct esp_zb_submit_slot_s {
+    _Atomic uint32_t sequence;
+    esp_zb_submit_callback_t cb;
+    void *data;
+    uint8_t buffer[ESP_ZB_SUBMIT_DATA_MAX_SIZE];
+} esp_zb_submit_slot_t;
+
+typedef struct esp_zb_submit_queue_s {
+    esp_zb_submit_slot_t *slots;
+    uint32_t mask;
+    _Atomic uint32_t tail;                          /* the next position to reserve, shared by the producers */
+    uint32_t head;                                  /* the next position to run, owned by the Zigbee task */
+    SemaphoreHandle_t wakeup;                       /* given on submission, taken by the Zigbee task while idle */
+    _Atomic uint32_t submit_count;
+    _Atomic uint32_t drop_count;
+    uint32_t run_count;
+} esp_zb_submit_queue_t;
+
+static esp_zb_submit_queue_t s_submit;
+
+esp_err_t esp_zb_submit_init(uint16_t size)
+{
+    uint32_t queue_size = 1;
+
+    ESP_RETURN_ON_FALSE(size && size <= ESP_ZB_SUBMIT_QUEUE_MAX_SIZE, ESP_ERR_INVALID_ARG, TAG, "Invalid queue size: %d", size);
+    ESP_RETURN_ON_FALSE(!s_submit.slots, ESP_ERR_INVALID_STATE, TAG, "Submission queue is already initialized");
+    while (queue_size < size) {
+        queue_size <<= 1;
+    }
+    s_submit.wakeup = xSemaphoreCreateBinary();
+    ESP_RETURN_ON_FALSE(s_submit.wakeup, ESP_ERR_NO_MEM, TAG, "No memory for the submission wakeup");
+    s_submit.slots = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_CORE, queue_size, sizeof(esp_zb_submit_slot_t));
+    if (!s_submit.slots) {
+        vSemaphoreDelete(s_submit.wakeup);
+        s_submit.wakeup = NULL;
+        ESP_LOGE(TAG, "No memory for the submission queue");
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t i = 0; i < queue_size; i++) {
+        atomic_init(&s_submit.slots[i].sequence, i);
+    }
+    s_submit.mask = queue_size - 1;
+    s_submit.head = 0;
+    atomic_init(&s_submit.tail, 0);
+    atomic_init(&s_submit.submit_count, 0);
+    atomic_init(&s_submit.drop_count, 0);
+    s_submit.run_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_submit_deinit(void)
+{
+    ESP_RETURN_ON_FALSE(s_submit.slots, ESP_ERR_INVALID_STATE, TAG, "Submission queue is not initialized");
+    esp_zb_mem_free(s_submit.slots);
+    vSemaphoreDelete(s_submit.wakeup);
+    memset(&s_submit, 0, sizeof(s_submit));
+    return ESP_OK;
+}
+
+/* the wakeup belongs to the queue alone, the task notification of the Zigbee task is left to the stack */
+static void esp_zb_submit_wakeup(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (xPortInIsrContext()) {
+        xSemaphoreGiveFromISR(s_submit.wakeup, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xSemaphoreGive(s_submit.wakeup);
+    }
+}
+
+esp_err_t esp_zb_submit(esp_zb_submit_callback_t cb, const void *data, uint16_t len)
+{
+    esp_zb_submit_slot_t *slot = NULL;
+    uint32_t pos = 0;
+
+    /* the producer may be an ISR, where only the early log is safe */
+    ESP_RETURN_ON_FALSE_ISR(s_submit.slots, ESP_ERR_INVALID_STATE, TAG, "Submission queue is not initialized");
+    ESP_RETURN_ON_FALSE_ISR(cb && len <= ESP_ZB_SUBMIT_DATA_MAX_SIZE && (data || !len), ESP_ERR_INVALID_ARG, TAG,
+                            "Invalid argument");
+    pos = atomic_load_explicit(&s_submit.tail, memory_order_relaxed);
+    while (true) {
+        slot = &s_submit.slots[pos & s_submit.mask];
+        int32_t diff = (int32_t)(atomic_load_explicit(&slot->sequence, memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s_submit.tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* the slot of the previous lap is not run yet */
+            atomic_fetch_add_explicit(&s_submit.drop_count, 1, memory_order_relaxed);
+            return ESP_ERR_NO_MEM;
+        } else {
+            pos = atomic_load_explicit(&s_submit.tail, memory_order_relaxed);
+        }
+    }
+    slot->cb = cb;
+    if (len) {
+        memcpy(slot->buffer, data, len);
+        slot->data = slot->buffer;
+    } else {
+        slot->data = (void *)data;
+    }
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    atomic_fetch_add_explicit(&s_submit.submit_count, 1, memory_order_relaxed);
+    esp_zb_submit_wakeup();
+    return ESP_OK;
+}
+
+uint16_t esp_zb_submit_process(void)
+{
+    esp_zb_submit_slot_t *slot = NULL;
+    esp_zb_submit_callback_t cb = NULL;
+    uint8_t buffer[ESP_ZB_SUBMIT_DATA_MAX_SIZE];
+    void *data = NULL;
+    uint16_t count = 0;
+
+    if (!s_submit.slots) {
+        return 0;
+    }
+    /* run at most one lap, the submissions queued by the callbacks themselves are left to the next call */
+    while (count <= s_submit.mask) {
+        slot = &s_submit.slots[s_submit.head & s_submit.mask];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != s_submit.head + 1) {
+            break;
+        }
+        cb = slot->cb;
+        data = slot->data;
+        if (data == slot->buffer) {
+            memcpy(buffer, slot->buffer, sizeof(buffer));
+            data = buffer;
+        }
+        /* free the slot before the callback, which may submit again */
+        atomic_store_explicit(&slot->sequence, s_submit.head + s_submit.mask + 1, memory_order_release);
+        s_submit.head++;
+        int64_t start = esp_zb_profiler_begin();
+        cb(data);
+        esp_zb_profiler_end(ESP_ZB_PROFILER_TYPE_SUBMIT, (uintptr_t)cb, start);
+        count++;
+    }
+    s_submit.run_count += count;
+    return count;
+}
+
+esp_err_t esp_zb_submit_wait(uint32_t timeout)
+{
+    ESP_RETURN_ON_FALSE(s_submit.slots, ESP_ERR_INVALID_STATE, TAG, "Submission queue is not initialized");
+    return xSemaphoreTake(s_submit.wakeup, pdMS_TO_TICKS(timeout)) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void esp_zb_submit_main_loop_iteration(void)
+{
+    /* the iteration of the stack is not assumed to wait on anything the producers can reach, so the loop waits on the
+     * wakeup of the queue between iterations, bounded to let the stack serve its own events */
+    while (true) {
+        esp_zb_submit_process();
+        zboss_main_loop_iteration();
+        esp_zb_submit_wait(ESP_ZB_SUBMIT_IDLE_WAIT_TIME);
+    }
+}
+
+esp_err_t esp_zb_submit_get_stats(esp_zb_submit_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    stats->submit_count = atomic_load_explicit(&s_submit.submit_count, memory_order_relaxed);
+    stats->drop_count = atomic_load_explicit(&s_submit.drop_count, memory_order_relaxed);
+    stats->run_count = s_submit.run_count;
+    stats->size = s_submit.slots ? s_submit.mask + 1 : 0;
+    return ESP_OK;
+}
@@ -0,0 +1,362 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_read_attr.h"
+#include "esp_zigbee_time.h"
+#include "zcl/esp_zigbee_zcl_time.h"
+
+#define ESP_ZB_TIME_SYNC_TIMEOUT            5000        /* timeout in millisecond of a single read attribute request */
+#define ESP_ZB_TIME_SYNC_RETRY_PERIOD       30          /* retry period in second after a failed sync */
+#define ESP_ZB_TIME_DRIFT_MAX_PPB           500000      /* drift above 500 ppm is an outlier, not a crystal */
+
+static const char *TAG = "ESP_ZB_TIME";
+
+typedef struct esp_zb_time_s {
+    bool valid;                                     /* the local clock is set */
+    uint8_t time_status;
+    int64_t base_utc_ms;                            /* UTCTime in millisecond at base_mono_us */
+    int64_t base_mono_us;                           /* monotonic time the clock is rebased at */
+    int32_t drift_ppb;
+    uint32_t last_set_time;
+    esp_zb_time_zone_t zone;
+    uint32_t sync_count;
+    uint32_t sync_fail_count;
+    /* time server */
+    bool server_running;
+    uint8_t server_endpoint;
+    uint16_t update_period;
+    /* time client */
+    bool sync_running;
+    esp_zb_time_sync_cfg_t sync_cfg;
+    esp_zb_time_sync_callback_t sync_cb;
+    uint8_t sync_attr_index;                        /* index of the attribute being read in s_sync_attr */
+    uint8_t sync_tsn;                               /* ZCL sequence number of the read attribute request */
+    int64_t sync_req_mono_us;                       /* monotonic time the Time attribute request is sent */
+    bool drift_ref_valid;
+    uint32_t drift_ref_utc;                         /* UTCTime received at the drift reference sync */
+    int64_t drift_ref_mono_us;                      /* monotonic time of the drift reference sync */
+} esp_zb_time_t;
+
+/* the attributes read from the time server in sequence, Time must be the first one */
+static const uint16_t s_sync_attr[] = {
+    ESP_ZB_ZCL_ATTR_TIME_TIME_ID,
+    ESP_ZB_ZCL_ATTR_TIME_TIME_ZONE_ID,
+    ESP_ZB_ZCL_ATTR_TIME_DST_START_ID,
+    ESP_ZB_ZCL_ATTR_TIME_DST_END_ID,
+    ESP_ZB_ZCL_ATTR_TIME_DST_SHIFT_ID,
+};
+
+static esp_zb_time_t s_time = {
+    .zone = {
+        .dst_start = ESP_ZB_TIME_INVALID,
+        .dst_end = ESP_ZB_TIME_INVALID,
+    },
+};
+
+static void esp_zb_time_sync_req(uint8_t param);
+
+static int64_t esp_zb_time_now_ms(int64_t mono_us)
+{
+    int64_t elapsed_us = mono_us - s_time.base_mono_us;
+
+    elapsed_us += elapsed_us * s_time.drift_ppb / 1000000000LL;
+    return s_time.base_utc_ms + elapsed_us / 1000;
+}
+
+static void esp_zb_time_rebase(int64_t utc_ms, int64_t mono_us)
+{
+    s_time.base_utc_ms = utc_ms;
+    s_time.base_mono_us = mono_us;
+    s_time.last_set_time = (uint32_t)(utc_ms / 1000);
+    s_time.valid = true;
+}
+
+static uint32_t esp_zb_time_local_calc(uint32_t utc, bool dst)
+{
+    int64_t local_time = (int64_t)utc + s_time.zone.time_zone;
+
+    if (dst && s_time.zone.dst_start != ESP_ZB_TIME_INVALID && s_time.zone.dst_end != ESP_ZB_TIME_INVALID &&
+            utc >= s_time.zone.dst_start && utc < s_time.zone.dst_end) {
+        local_time += s_time.zone.dst_shift;
+    }
+    return (uint32_t)local_time;
+}
+
+esp_err_t esp_zb_time_set(uint32_t utc, const esp_zb_time_zone_t *zone)
+{
+    ESP_RETURN_ON_FALSE(utc != ESP_ZB_TIME_INVALID, ESP_ERR_INVALID_ARG, TAG, "Invalid UTCTime");
+    esp_zb_time_rebase((int64_t)utc * 1000, esp_timer_get_time());
+    s_time.time_status |= ESP_ZB_TIME_STATUS_MASTER;
+    if (zone) {
+        s_time.zone = *zone;
+        s_time.time_status |= ESP_ZB_TIME_STATUS_MASTER_ZONE_DST;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_time_get_utc(uint32_t *utc)
+{
+    ESP_RETURN_ON_FALSE(utc, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    if (!s_time.valid) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *utc = (uint32_t)(esp_zb_time_now_ms(esp_timer_get_time()) / 1000);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_time_get_local(uint32_t *local_time)
+{
+    uint32_t utc = 0;
+
+    ESP_RETURN_ON_FALSE(local_time, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_ERROR(esp_zb_time_get_utc(&utc), TAG, "Local clock is not set");
+    *local_time = esp_zb_time_local_calc(utc, true);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_time_get_info(esp_zb_time_info_t *info)
+{
+    ESP_RETURN_ON_FALSE(info, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    info->time_status = s_time.time_status;
+    info->last_set_time = s_time.valid ? s_time.last_set_time : ESP_ZB_TIME_INVALID;
+    info->drift_ppb = s_time.drift_ppb;
+    info->sync_count = s_time.sync_count;
+    info->sync_fail_count = s_time.sync_fail_count;
+    return ESP_OK;
+}
+
+/* Time server */
+
+static void esp_zb_time_server_attr_set(uint16_t attr_id, void *value)
+{
+    /* the optional attributes may not be registered in the cluster, the failures are ignored */
+    esp_zb_zcl_set_attribute_val(s_time.server_endpoint, ESP_ZB_ZCL_CLUSTER_ID_TIME, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, attr_id, value);
+}
+
+static void esp_zb_time_server_update(uint8_t param)
+{
+    uint32_t utc = 0;
+
+    if (!s_time.server_running) {
+        return;
+    }
+    if (esp_zb_time_get_utc(&utc) == ESP_OK) {
+        uint32_t standard_time = esp_zb_time_local_calc(utc, false);
+        uint32_t local_time = esp_zb_time_local_calc(utc, true);
+
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_TIME_ID, &utc);
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_TIME_STATUS_ID, &s_time.time_status);
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_TIME_ZONE_ID, &s_time.zone.time_zone);
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_DST_START_ID, &s_time.zone.dst_start);
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_DST_END_ID, &s_time.zone.dst_end);
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_DST_SHIFT_ID, &s_time.zone.dst_shift);
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_STANDARD_TIME_ID, &standard_time);
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_LOCAL_TIME_ID, &local_time);
+        esp_zb_time_server_attr_set(ESP_ZB_ZCL_ATTR_TIME_LAST_SET_TIME_ID, &s_time.last_set_time);
+    }
+    esp_zb_scheduler_alarm(esp_zb_time_server_update, 0, s_time.update_period * 1000);
+}
+
+esp_err_t esp_zb_time_server_start(uint8_t endpoint, uint16_t update_period)
+{
+    esp_zb_time_server_stop();
+    s_time.server_endpoint = endpoint;
+    s_time.update_period = update_period ? update_period : 1;
+    s_time.server_running = true;
+    esp_zb_time_server_update(0);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_time_server_stop(void)
+{
+    if (s_time.server_running) {
+        s_time.server_running = false;
+        esp_zb_scheduler_alarm_cancel(esp_zb_time_server_update, 0);
+    }
+    return ESP_OK;
+}
+
+/* Time client */
+
+static void esp_zb_time_drift_estimate(uint32_t utc, int64_t mono_us)
+{
+    int64_t elapsed_mono_us = 0;
+    int64_t elapsed_true_us = 0;
+    int64_t drift_ppb = 0;
+
+    if (!s_time.drift_ref_valid) {
+        s_time.drift_ref_valid = true;
+        s_time.drift_ref_utc = utc;
+        s_time.drift_ref_mono_us = mono_us;
+        return;
+    }
+    elapsed_mono_us = mono_us - s_time.drift_ref_mono_us;
+    /* UTCTime has a resolution of one second, only a long baseline gives a meaningful drift */
+    if (elapsed_mono_us < (int64_t)ESP_ZB_TIME_DRIFT_MIN_INTERVAL * 1000000) {
+        return;
+    }
+    elapsed_true_us = ((int64_t)utc - s_time.drift_ref_utc) * 1000000;
+    drift_ppb = (elapsed_true_us - elapsed_mono_us) * 1000 / (elapsed_mono_us / 1000000);
+    s_time.drift_ref_utc = utc;
+    s_time.drift_ref_mono_us = mono_us;
+    if (drift_ppb > ESP_ZB_TIME_DRIFT_MAX_PPB || drift_ppb < -ESP_ZB_TIME_DRIFT_MAX_PPB) {
+        ESP_LOGW(TAG, "Drop drift outlier: %" PRId64 " ppb", drift_ppb);
+        return;
+    }
+    s_time.drift_ppb = s_time.drift_ppb ? (int32_t)((s_time.drift_ppb * 3LL + drift_ppb) / 4) : (int32_t)drift_ppb;
+}
+
+static void esp_zb_time_sync_time_handle(uint32_t utc)
+{
+    int64_t mono_us = esp_timer_get_time();
+    int64_t now_ms = 0;
+
+    /* the server time is sampled around the middle of the request round trip */
+    mono_us = s_time.sync_req_mono_us + (mono_us - s_time.sync_req_mono_us) / 2;
+    /* move the base forward under the current drift, so a new drift estimate only applies from now on */
+    if (s_time.valid) {
+        s_time.base_utc_ms = esp_zb_time_now_ms(mono_us);
+        s_time.base_mono_us = mono_us;
+    }
+    esp_zb_time_drift_estimate(utc, mono_us);
+    now_ms = esp_zb_time_now_ms(mono_us);
+    /* keep the local clock as long as it agrees with the server at one second resolution, so it does not jitter */
+    if (!s_time.valid || now_ms < (int64_t)utc * 1000 || now_ms >= ((int64_t)utc + 1) * 1000) {
+        esp_zb_time_rebase((int64_t)utc * 1000, mono_us);
+    }
+    s_time.time_status |= ESP_ZB_TIME_STATUS_SYNCHRONIZED;
+}
+
+static void esp_zb_time_sync_done(esp_err_t status)
+{
+    uint32_t utc = ESP_ZB_TIME_INVALID;
+    uint32_t next_sync = s_time.sync_cfg.sync_period;
+
+    esp_zb_scheduler_alarm_cancel(esp_zb_time_sync_req, 0xff);
+    if (status == ESP_OK) {
+        s_time.sync_count++;
+        esp_zb_time_get_utc(&utc);
+    } else {
+        s_time.sync_fail_count++;
+        next_sync = ESP_ZB_TIME_SYNC_RETRY_PERIOD;
+    }
+    if (s_time.sync_cb) {
+        s_time.sync_cb(status, utc);
+    }
+    if (s_time.sync_running && next_sync) {
+        esp_zb_scheduler_alarm(esp_zb_time_sync_req, 0, next_sync * 1000);
+    }
+}
+
+/* param is the index of the attribute to read, or 0xff when the previous request timed out */
+static void esp_zb_time_sync_req(uint8_t param)
+{
+    esp_zb_zcl_read_attr_cmd_t read_req;
+
+    if (!s_time.sync_running) {
+        return;
+    }
+    if (param == 0xff) {
+        ESP_LOGW(TAG, "Time sync timeout (attribute: 0x%04x)", s_sync_attr[s_time.sync_attr_index]);
+        esp_zb_time_sync_done(s_time.sync_attr_index == 0 ? ESP_ERR_TIMEOUT : ESP_OK);
+        return;
+    }
+    s_time.sync_attr_index = param;
+    memset(&read_req, 0, sizeof(read_req));
+    read_req.zcl_basic_cmd.dst_addr_u.addr_short = s_time.sync_cfg.dst_short_addr;
+    read_req.zcl_basic_cmd.dst_endpoint = s_time.sync_cfg.dst_endpoint;
+    read_req.zcl_basic_cmd.src_endpoint = s_time.sync_cfg.src_endpoint;
+    read_req.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
+    read_req.clusterID = ESP_ZB_ZCL_CLUSTER_ID_TIME;
+    read_req.attributeID = s_sync_attr[param];
+    if (param == 0) {
+        s_time.sync_req_mono_us = esp_timer_get_time();
+    }
+    esp_zb_read_attr_send(&read_req, &s_time.sync_tsn);
+    esp_zb_scheduler_alarm(esp_zb_time_sync_req, 0xff, ESP_ZB_TIME_SYNC_TIMEOUT);
+}
+
+static void esp_zb_time_read_attr_resp_handler(const esp_zb_read_attr_resp_info_t *info, esp_zb_zcl_status_t status,
+                                               uint16_t attr_id, esp_zb_zcl_attr_type_t attr_type, const void *value)
+{
+    uint32_t utc = 0;
+
+    /* only the response of the server to the request in flight */
+    if (!s_time.sync_running || info->cluster_id != ESP_ZB_ZCL_CLUSTER_ID_TIME || info->tsn != s_time.sync_tsn ||
+            info->src_addr != s_time.sync_cfg.dst_short_addr || info->dst_endpoint != s_time.sync_cfg.src_endpoint ||
+            attr_id != s_sync_attr[s_time.sync_attr_index]) {
+        return;
+    }
+    esp_zb_scheduler_alarm_cancel(esp_zb_time_sync_req, 0xff);
+    if (status == ESP_ZB_ZCL_STATUS_SUCCESS && value) {
+        switch (attr_id) {
+        /* the values are in the frame and may be unaligned */
+        case ESP_ZB_ZCL_ATTR_TIME_TIME_ID:
+            memcpy(&utc, value, sizeof(utc));
+            if (utc == ESP_ZB_TIME_INVALID) {
+                ESP_LOGW(TAG, "Time server is not synchronized");
+                esp_zb_time_sync_done(ESP_ERR_INVALID_STATE);
+                return;
+            }
+            esp_zb_time_sync_time_handle(utc);
+            break;
+        case ESP_ZB_ZCL_ATTR_TIME_TIME_ZONE_ID:
+            memcpy(&s_time.zone.time_zone, value, sizeof(s_time.zone.time_zone));
+            break;
+        case ESP_ZB_ZCL_ATTR_TIME_DST_START_ID:
+            memcpy(&s_time.zone.dst_start, value, sizeof(s_time.zone.dst_start));
+            break;
+        case ESP_ZB_ZCL_ATTR_TIME_DST_END_ID:
+            memcpy(&s_time.zone.dst_end, value, sizeof(s_time.zone.dst_end));
+            break;
+        case ESP_ZB_ZCL_ATTR_TIME_DST_SHIFT_ID:
+            memcpy(&s_time.zone.dst_shift, value, sizeof(s_time.zone.dst_shift));
+            break;
+        default:
+            break;
+        }
+    } else if (attr_id == ESP_ZB_ZCL_ATTR_TIME_TIME_ID) {
+        ESP_LOGW(TAG, "Failed to read Time attribute, status: 0x%x", status);
+        esp_zb_time_sync_done(ESP_FAIL);
+        return;
+    }
+    /* the time zone and dst attributes are optional on the server, move on regardless of the status */
+    if (s_time.sync_attr_index + 1 < (int)(sizeof(s_sync_attr) / sizeof(s_sync_attr[0]))) {
+        esp_zb_time_sync_req(s_time.sync_attr_index + 1);
+    } else {
+        esp_zb_time_sync_done(ESP_OK);
+    }
+}
+
+esp_err_t esp_zb_time_sync_start(const esp_zb_time_sync_cfg_t *cfg, esp_zb_time_sync_callback_t cb)
+{
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    esp_zb_time_sync_stop();
+    s_time.sync_cfg = *cfg;
+    s_time.sync_cb = cb;
+    ESP_RETURN_ON_ERROR(esp_zb_read_attr_handler_add(esp_zb_time_read_attr_resp_handler), TAG,
+                        "Failed to add the read attribute response handler");
+    s_time.sync_running = true;
+    esp_zb_time_sync_req(0);
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_time_sync_stop(void)
+{
+    if (s_time.sync_running) {
+        s_time.sync_running = false;
+        esp_zb_read_attr_handler_remove(esp_zb_time_read_attr_resp_handler);
+        esp_zb_scheduler_alarm_cancel(esp_zb_time_sync_req, 0);
+        esp_zb_scheduler_alarm_cancel(esp_zb_time_sync_req, 0xff);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,408 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "esp_zigbee_core.h"
+#include "esp_zigbee_topology.h"
+#include "esp_zigbee_mem.h"
+
+#define ESP_ZB_TOPOLOGY_INDEX_EMPTY         0x0000
+#define ESP_ZB_TOPOLOGY_RELATIONSHIP_PREV   0x04        /* previous child, the entry is stale */
+
+static const char *TAG = "ESP_ZB_TOPOLOGY";
+
+typedef struct esp_zb_topology_s {
+    bool running;
+    bool root_known;                                /* the IEEE address of the root is known */
+    uint16_t generation;                            /* tells the responses of a stopped crawl apart */
+    esp_zb_topology_cfg_t cfg;
+    esp_zb_topology_node_t *node;
+    esp_zb_topology_link_t *link;
+    esp_zb_topology_route_t *route;
+    uint16_t *index;                                /* open addressing hash index of the IEEE addresses, holds node index + 1 */
+    uint16_t index_mask;                            /* the index table holds index_mask + 1 entries */
+    uint16_t node_num;
+    uint16_t link_num;
+    uint16_t route_num;
+    uint16_t cursor;                                /* no node before the cursor is pending */
+    uint8_t in_flight;
+    int64_t start_time;
+    esp_zb_topology_stats_t stats;
+} esp_zb_topology_t;
+
+static esp_zb_topology_t s_topo;
+
+static uint32_t esp_zb_topology_hash(const esp_zb_ieee_addr_t ieee_addr)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (uint8_t i = 0; i < sizeof(esp_zb_ieee_addr_t); i++) {
+        hash = (hash ^ ieee_addr[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static void esp_zb_topology_index_insert(uint16_t node_index)
+{
+    uint32_t slot = esp_zb_topology_hash(s_topo.node[node_index].ieee_addr) & s_topo.index_mask;
+
+    while (s_topo.index[slot] != ESP_ZB_TOPOLOGY_INDEX_EMPTY) {
+        slot = (slot + 1) & s_topo.index_mask;
+    }
+    s_topo.index[slot] = node_index + 1;
+}
+
+static int32_t esp_zb_topology_index_find(const esp_zb_ieee_addr_t ieee_addr)
+{
+    uint32_t slot = esp_zb_topology_hash(ieee_addr) & s_topo.index_mask;
+
+    while (s_topo.index[slot] != ESP_ZB_TOPOLOGY_INDEX_EMPTY) {
+        uint16_t node_index = s_topo.index[slot] - 1;
+        if (!memcmp(s_topo.node[node_index].ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t))) {
+            return node_index;
+        }
+        slot = (slot + 1) & s_topo.index_mask;
+    }
+    return -1;
+}
+
+static void esp_zb_topology_node_pending(uint16_t node_index)
+{
+    s_topo.node[node_index].state = ESP_ZB_TOPOLOGY_NODE_PENDING;
+    if (node_index < s_topo.cursor) {
+        s_topo.cursor = node_index;
+    }
+}
+
+static int32_t esp_zb_topology_node_add(const esp_zb_zdo_neighbor_table_record_t *record)
+{
+    esp_zb_topology_node_t *node = NULL;
+    int32_t node_index = -1;
+
+    /* the root is queried before its IEEE address is known, it is learnt from the first neighbor reporting it */
+    if (!s_topo.root_known && record->short_addr == s_topo.node[0].short_addr) {
+        memcpy(s_topo.node[0].ieee_addr, record->ieee_addr, sizeof(esp_zb_ieee_addr_t));
+        esp_zb_topology_index_insert(0);
+        s_topo.root_known = true;
+        node_index = 0;
+    } else {
+        node_index = esp_zb_topology_index_find(record->ieee_addr);
+    }
+    if (node_index >= 0) {
+        node = &s_topo.node[node_index];
+        node->short_addr = record->short_addr;
+        node->depth = record->depth;
+        if (node->device_type == 0x03) {
+            node->device_type = record->device_type;
+        }
+        return node_index;
+    }
+    if (s_topo.node_num == s_topo.cfg.node_capacity) {
+        s_topo.stats.truncated = true;
+        return -1;
+    }
+    node_index = s_topo.node_num++;
+    node = &s_topo.node[node_index];
+    memcpy(node->ieee_addr, record->ieee_addr, sizeof(esp_zb_ieee_addr_t));
+    node->short_addr = record->short_addr;
+    node->device_type = record->device_type;
+    node->depth = record->depth;
+    node->next_index = 0;
+    node->route_next_index = 0;
+    node->reading_routes = false;
+    node->retry = 0;
+    /* only the coordinator and the routers have a neighbor table to read */
+    node->state = record->device_type <= 0x01 ? ESP_ZB_TOPOLOGY_NODE_PENDING : ESP_ZB_TOPOLOGY_NODE_DONE;
+    esp_zb_topology_index_insert(node_index);
+    return node_index;
+}
+
+static void esp_zb_topology_link_add(uint16_t from, uint16_t to, uint8_t lqi, uint8_t relationship)
+{
+    if (s_topo.link_num == s_topo.cfg.link_capacity) {
+        s_topo.stats.truncated = true;
+        return;
+    }
+    s_topo.link[s_topo.link_num].from = from;
+    s_topo.link[s_topo.link_num].to = to;
+    s_topo.link[s_topo.link_num].lqi = lqi;
+    s_topo.link[s_topo.link_num].relationship = relationship;
+    s_topo.link_num++;
+}
+
+static void esp_zb_topology_route_add(uint16_t from, const esp_zb_zdo_routing_table_record_t *record)
+{
+    esp_zb_topology_route_t *route = NULL;
+
+    if (s_topo.route_num == s_topo.cfg.route_capacity) {
+        s_topo.stats.truncated = true;
+        return;
+    }
+    route = &s_topo.route[s_topo.route_num++];
+    route->from = from;
+    route->dst_addr = record->dst_addr;
+    route->next_hop_addr = record->next_hop_addr;
+    route->status = record->status;
+    route->many_to_one = record->many_to_one;
+}
+
+static void esp_zb_topology_finish(void)
+{
+    s_topo.running = false;
+    s_topo.generation++;
+    s_topo.stats.duration = (esp_timer_get_time() - s_topo.start_time) / 1000;
+    s_topo.stats.node_count = s_topo.node_num;
+    s_topo.stats.link_count = s_topo.link_num;
+    s_topo.stats.route_count = s_topo.route_num;
+    ESP_LOGI(TAG, "Crawl finished in %lu ms, nodes: %d, links: %d, routes: %d, requests: %d, failures: %d",
+             (unsigned long)s_topo.stats.duration, s_topo.stats.node_count, s_topo.stats.link_count, s_topo.stats.route_count,
+             s_topo.stats.req_count, s_topo.stats.fail_count);
+    if (s_topo.cfg.done_cb) {
+        s_topo.cfg.done_cb(&s_topo.stats);
+    }
+}
+
+static void esp_zb_topology_lqi_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_lqi_rsp_t *rsp, void *user_ctx);
+
+static void esp_zb_topology_rtg_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_rtg_rsp_t *rsp, void *user_ctx);
+
+static void esp_zb_topology_retry_alarm(uint8_t param);
+
+static void esp_zb_topology_dispatch(void)
+{
+    while (s_topo.running && s_topo.in_flight < s_topo.cfg.max_in_flight && s_topo.cursor < s_topo.node_num) {
+        esp_zb_topology_node_t *node = &s_topo.node[s_topo.cursor];
+        void *ctx = (void *)(uintptr_t)(((uint32_t)s_topo.generation << 16) | s_topo.cursor);
+        esp_err_t ret = ESP_OK;
+
+        if (node->state != ESP_ZB_TOPOLOGY_NODE_PENDING) {
+            s_topo.cursor++;
+            continue;
+        }
+        if (node->reading_routes) {
+            esp_zb_zdo_mgmt_rtg_req_param_t req = {.dst_nwk_addr = node->short_addr, .start_index = node->route_next_index};
+            ret = esp_zb_zdo_mgmt_rtg_req(&req, esp_zb_topology_rtg_cb, ctx);
+        } else {
+            esp_zb_zdo_mgmt_lqi_req_param_t req = {.dst_nwk_addr = node->short_addr, .start_index = node->next_index};
+            ret = esp_zb_zdo_mgmt_lqi_req(&req, esp_zb_topology_lqi_cb, ctx);
+        }
+        if (ret != ESP_OK) {
+            /* no response will wake up the crawl if nothing is in flight */
+            if (!s_topo.in_flight) {
+                esp_zb_scheduler_alarm(esp_zb_topology_retry_alarm, (uint8_t)s_topo.generation, ESP_ZB_TOPOLOGY_RETRY_DELAY);
+            }
+            return;
+        }
+        node->state = ESP_ZB_TOPOLOGY_NODE_QUERYING;
+        s_topo.in_flight++;
+        s_topo.stats.req_count++;
+        s_topo.cursor++;
+    }
+    if (s_topo.running && !s_topo.in_flight && s_topo.cursor >= s_topo.node_num) {
+        esp_zb_topology_finish();
+    }
+}
+
+static void esp_zb_topology_retry_alarm(uint8_t param)
+{
+    if (s_topo.running && param == (uint8_t)s_topo.generation) {
+        esp_zb_topology_dispatch();
+    }
+}
+
+/* the node of a response, NULL if the response belongs to a stopped crawl */
+static esp_zb_topology_node_t *esp_zb_topology_response_node(void *user_ctx, uint16_t *node_index)
+{
+    uint32_t ctx = (uint32_t)(uintptr_t)user_ctx;
+
+    if (!s_topo.running || (ctx >> 16) != s_topo.generation) {
+        return NULL;
+    }
+    *node_index = ctx & 0xffff;
+    s_topo.in_flight--;
+    return &s_topo.node[*node_index];
+}
+
+/* retry the current page of a node, or give the node up */
+static void esp_zb_topology_response_fail(uint16_t node_index, esp_zb_zdp_status_t zdo_status)
+{
+    esp_zb_topology_node_t *node = &s_topo.node[node_index];
+
+    if (zdo_status != ESP_ZB_ZDP_STATUS_NOT_SUPPORTED && node->retry < s_topo.cfg.max_retry) {
+        node->retry++;
+        esp_zb_topology_node_pending(node_index);
+    } else if (zdo_status == ESP_ZB_ZDP_STATUS_NOT_SUPPORTED && node->reading_routes) {
+        /* the routing table is optional, the neighbor table is already read */
+        node->state = ESP_ZB_TOPOLOGY_NODE_DONE;
+    } else {
+        ESP_LOGW(TAG, "Failed to read the %s table of 0x%04hx, status: 0x%x", node->reading_routes ? "routing" : "neighbor",
+                 node->short_addr, zdo_status);
+        node->state = ESP_ZB_TOPOLOGY_NODE_FAILED;
+        s_topo.stats.fail_count++;
+    }
+}
+
+static void esp_zb_topology_lqi_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_lqi_rsp_t *rsp, void *user_ctx)
+{
+    uint16_t node_index = 0;
+    esp_zb_topology_node_t *node = esp_zb_topology_response_node(user_ctx, &node_index);
+
+    if (!node) {
+        return;
+    }
+    if (zdo_status == ESP_ZB_ZDP_STATUS_SUCCESS && rsp) {
+        for (uint8_t i = 0; i < rsp->neighbor_table_list_count; i++) {
+            const esp_zb_zdo_neighbor_table_record_t *record = &rsp->neighbor_table_list[i];
+            int32_t to = -1;
+
+            if (record->relationship == ESP_ZB_TOPOLOGY_RELATIONSHIP_PREV) {
+                continue;
+            }
+            to = esp_zb_topology_node_add(record);
+            if (to >= 0) {
+                esp_zb_topology_link_add(node_index, to, record->lqi, record->relationship);
+                if (s_topo.node[to].state == ESP_ZB_TOPOLOGY_NODE_PENDING && to < s_topo.cursor) {
+                    s_topo.cursor = to;
+                }
+            }
+        }
+        node->retry = 0;
+        node->next_index = rsp->start_index + rsp->neighbor_table_list_count;
+        if (rsp->neighbor_table_list_count && node->next_index < rsp->neighbor_table_entries) {
+            esp_zb_topology_node_pending(node_index);
+        } else if (s_topo.cfg.route_capacity) {
+            node->reading_routes = true;
+            esp_zb_topology_node_pending(node_index);
+        } else {
+            node->state = ESP_ZB_TOPOLOGY_NODE_DONE;
+        }
+    } else {
+        esp_zb_topology_response_fail(node_index, zdo_status);
+    }
+    esp_zb_topology_dispatch();
+}
+
+static void esp_zb_topology_rtg_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_rtg_rsp_t *rsp, void *user_ctx)
+{
+    uint16_t node_index = 0;
+    esp_zb_topology_node_t *node = esp_zb_topology_response_node(user_ctx, &node_index);
+
+    if (!node) {
+        return;
+    }
+    if (zdo_status == ESP_ZB_ZDP_STATUS_SUCCESS && rsp) {
+        for (uint8_t i = 0; i < rsp->routing_table_list_count; i++) {
+            esp_zb_topology_route_add(node_index, &rsp->routing_table_list[i]);
+        }
+        node->retry = 0;
+        node->route_next_index = rsp->start_index + rsp->routing_table_list_count;
+        if (rsp->routing_table_list_count && node->route_next_index < rsp->routing_table_entries) {
+            esp_zb_topology_node_pending(node_index);
+        } else {
+            node->state = ESP_ZB_TOPOLOGY_NODE_DONE;
+        }
+    } else {
+        esp_zb_topology_response_fail(node_index, zdo_status);
+    }
+    esp_zb_topology_dispatch();
+}
+
+esp_err_t esp_zb_topology_crawl_start(const esp_zb_topology_cfg_t *cfg)
+{
+    uint32_t index_size = 1;
+
+    ESP_RETURN_ON_FALSE(cfg, ESP_ERR_INVALID_ARG, TAG, "Invalid topology configuration");
+    ESP_RETURN_ON_FALSE(cfg->max_in_flight && cfg->max_in_flight <= ESP_ZB_TOPOLOGY_IN_FLIGHT_MAX_NUM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid number of requests in flight: %d", cfg->max_in_flight);
+    ESP_RETURN_ON_FALSE(cfg->node_capacity && cfg->node_capacity < 0x8000 && cfg->link_capacity, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid topology capacity");
+#if !CONFIG_ZB_ZDO_MGMT_RTG
+    ESP_RETURN_ON_FALSE(!cfg->route_capacity, ESP_ERR_NOT_SUPPORTED, TAG, "Routing table reads need CONFIG_ZB_ZDO_MGMT_RTG");
+#endif
+    ESP_RETURN_ON_FALSE(!s_topo.running, ESP_ERR_INVALID_STATE, TAG, "Topology crawl is running");
+
+    esp_zb_topology_clear();
+    /* keep the load factor of the index under one half */
+    while (index_size < 2 * (uint32_t)cfg->node_capacity) {
+        index_size <<= 1;
+    }
+    s_topo.node = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_NWK, cfg->node_capacity, sizeof(esp_zb_topology_node_t));
+    s_topo.link = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_NWK, cfg->link_capacity, sizeof(esp_zb_topology_link_t));
+    if (cfg->route_capacity) {
+        s_topo.route = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_NWK, cfg->route_capacity, sizeof(esp_zb_topology_route_t));
+    }
+    s_topo.index = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_NWK, index_size, sizeof(uint16_t));
+    if (!s_topo.node || !s_topo.link || (cfg->route_capacity && !s_topo.route) || !s_topo.index) {
+        esp_zb_topology_clear();
+        ESP_LOGE(TAG, "No memory for the topology tables");
+        return ESP_ERR_NO_MEM;
+    }
+    s_topo.cfg = *cfg;
+    s_topo.index_mask = index_size - 1;
+    s_topo.node[0].short_addr = cfg->root_addr;
+    s_topo.node[0].device_type = 0x03;
+    s_topo.node[0].state = ESP_ZB_TOPOLOGY_NODE_PENDING;
+    s_topo.node_num = 1;
+    s_topo.start_time = esp_timer_get_time();
+    s_topo.running = true;
+    esp_zb_topology_dispatch();
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_topology_crawl_stop(void)
+{
+    ESP_RETURN_ON_FALSE(s_topo.running, ESP_ERR_INVALID_STATE, TAG, "Topology crawl is not running");
+    esp_zb_scheduler_alarm_cancel(esp_zb_topology_retry_alarm, (uint8_t)s_topo.generation);
+    s_topo.running = false;
+    s_topo.generation++;
+    s_topo.in_flight = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_topology_get_nodes(const esp_zb_topology_node_t **nodes, uint16_t *node_num)
+{
+    ESP_RETURN_ON_FALSE(nodes && node_num, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    *nodes = s_topo.node;
+    *node_num = s_topo.node_num;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_topology_get_links(const esp_zb_topology_link_t **links, uint16_t *link_num)
+{
+    ESP_RETURN_ON_FALSE(links && link_num, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    *links = s_topo.link;
+    *link_num = s_topo.link_num;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_topology_get_routes(const esp_zb_topology_route_t **routes, uint16_t *route_num)
+{
+    ESP_RETURN_ON_FALSE(routes && route_num, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    *routes = s_topo.route;
+    *route_num = s_topo.route_num;
+    return ESP_OK;
+}
+
+void esp_zb_topology_clear(void)
+{
+    uint16_t generation = 0;
+
+    if (s_topo.running) {
+        esp_zb_topology_crawl_stop();
+    }
+    /* the generation survives so the responses of a stopped crawl are still ignored */
+    generation = s_topo.generation;
+    esp_zb_mem_free(s_topo.node);
+    esp_zb_mem_free(s_topo.link);
+    esp_zb_mem_free(s_topo.route);
+    esp_zb_mem_free(s_topo.index);
+    memset(&s_topo, 0, sizeof(s_topo));
+    s_topo.generation = generation;
+}
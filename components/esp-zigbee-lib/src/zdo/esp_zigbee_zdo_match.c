@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "zboss_api.h"
+#include "esp_zigbee_core.h"
+#include "zdo/esp_zigbee_zdo_command.h"
+#include "esp_zigbee_mem.h"
+
+#define ESP_ZB_ZDO_MATCH_CLUSTER_REQ_MAX_NUM    4       /* maximum number of match cluster requests collecting responses */
+#define ESP_ZB_ZDO_BROADCAST_ADDR_MIN           0xfff8  /* the NWK addresses from it are broadcast addresses */
+
+static const char *TAG = "ESP_ZB_ZDO_MATCH";
+
+typedef struct esp_zb_zdo_match_cluster_s {
+    bool in_use;
+    uint8_t tsn;
+    bool responded;                                 /* a device responded, even without a match */
+    bool broadcast;
+    esp_zb_zdo_match_cluster_callback_t user_cb;
+    void *user_ctx;
+    uint16_t result_num;
+    esp_zb_zdo_match_cluster_result_t *results;
+} esp_zb_zdo_match_cluster_t;
+
+static esp_zb_zdo_match_cluster_t s_match_req[ESP_ZB_ZDO_MATCH_CLUSTER_REQ_MAX_NUM];
+
+static void esp_zb_zdo_match_cluster_done(uint8_t index)
+{
+    esp_zb_zdo_match_cluster_t *req = &s_match_req[index];
+    esp_zb_zdo_match_cluster_t done = *req;
+
+    if (!req->in_use) {
+        return;
+    }
+    esp_zb_scheduler_alarm_cancel(esp_zb_zdo_match_cluster_done, index);
+    /* release the slot first, so the callback can send the next request */
+    req->in_use = false;
+    req->results = NULL;
+    done.user_cb(done.responded ? ESP_ZB_ZDP_STATUS_SUCCESS : ESP_ZB_ZDP_STATUS_TIMEOUT, done.results, done.result_num, done.user_ctx);
+    esp_zb_mem_free(done.results);
+}
+
+static void esp_zb_zdo_match_cluster_result_add(esp_zb_zdo_match_cluster_t *req, uint16_t short_addr, uint8_t endpoint)
+{
+    /* a device may answer twice when the broadcast is relayed back to it */
+    for (uint16_t i = 0; i < req->result_num; i++) {
+        if (req->results[i].short_addr == short_addr && req->results[i].endpoint == endpoint) {
+            return;
+        }
+    }
+    if (req->result_num == ESP_ZB_ZDO_MATCH_CLUSTER_RESULT_MAX_NUM) {
+        ESP_LOGW(TAG, "Match cluster results are full, 0x%04hx endpoint %d is dropped", short_addr, endpoint);
+        return;
+    }
+    req->results[req->result_num].short_addr = short_addr;
+    req->results[req->result_num].endpoint = endpoint;
+    req->result_num++;
+}
+
+static void esp_zb_zdo_match_cluster_resp_handler(zb_uint8_t bufid)
+{
+    zb_zdo_match_desc_resp_t *resp = (zb_zdo_match_desc_resp_t *)zb_buf_begin(bufid);
+    zb_uint8_t *match_ep = (zb_uint8_t *)(resp + 1);
+    esp_zb_zdo_match_cluster_t *req = NULL;
+    uint8_t index = 0;
+
+    for (index = 0; index < ESP_ZB_ZDO_MATCH_CLUSTER_REQ_MAX_NUM; index++) {
+        if (s_match_req[index].in_use && s_match_req[index].tsn == resp->tsn) {
+            req = &s_match_req[index];
+            break;
+        }
+    }
+    /* the responses arriving after the collection window are dropped */
+    if (req && resp->status == ESP_ZB_ZDP_STATUS_SUCCESS) {
+        uint32_t len = zb_buf_len(bufid);
+        uint8_t match_len = resp->match_len;
+
+        if (len < sizeof(*resp)) {
+            match_len = 0;
+        } else if (match_len > len - sizeof(*resp)) {
+            match_len = len - sizeof(*resp);
+        }
+        req->responded = true;
+        for (uint8_t i = 0; i < match_len; i++) {
+            esp_zb_zdo_match_cluster_result_add(req, resp->nwk_addr, match_ep[i]);
+        }
+        if (!req->broadcast) {
+            esp_zb_zdo_match_cluster_done(index);
+        }
+    } else if (req && !req->broadcast) {
+        esp_zb_zdo_match_cluster_done(index);
+    }
+    zb_buf_free(bufid);
+}
+
+esp_err_t esp_zb_zdo_match_cluster_req(esp_zb_zdo_match_cluster_req_param_t *cmd_req, esp_zb_zdo_match_cluster_callback_t user_cb,
+                                       void *user_ctx)
+{
+    esp_zb_zdo_match_cluster_t *req = NULL;
+    zb_zdo_match_desc_param_t *param = NULL;
+    zb_bufid_t bufid = 0;
+    uint8_t cluster_num = 0;
+    uint8_t index = 0;
+    uint8_t tsn = 0;
+
+    ESP_RETURN_ON_FALSE(cmd_req && user_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid match cluster request");
+    /* each count is bounded before the sum, so the sum of two uint8_t counts does not wrap */
+    ESP_RETURN_ON_FALSE(cmd_req->num_in_clusters <= ESP_ZB_ZDO_MATCH_CLUSTER_MAX_NUM &&
+                        cmd_req->num_out_clusters <= ESP_ZB_ZDO_MATCH_CLUSTER_MAX_NUM - cmd_req->num_in_clusters,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid cluster list");
+    cluster_num = cmd_req->num_in_clusters + cmd_req->num_out_clusters;
+    ESP_RETURN_ON_FALSE(cmd_req->cluster_list || !cluster_num, ESP_ERR_INVALID_ARG, TAG, "Invalid cluster list");
+    while (index < ESP_ZB_ZDO_MATCH_CLUSTER_REQ_MAX_NUM && s_match_req[index].in_use) {
+        index++;
+    }
+    ESP_RETURN_ON_FALSE(index < ESP_ZB_ZDO_MATCH_CLUSTER_REQ_MAX_NUM, ESP_ERR_NO_MEM, TAG, "No slot for match cluster request");
+    req = &s_match_req[index];
+    memset(req, 0, sizeof(esp_zb_zdo_match_cluster_t));
+    req->results = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZDO, ESP_ZB_ZDO_MATCH_CLUSTER_RESULT_MAX_NUM, sizeof(esp_zb_zdo_match_cluster_result_t));
+    ESP_RETURN_ON_FALSE(req->results, ESP_ERR_NO_MEM, TAG, "No memory for match cluster results");
+    bufid = zb_buf_get_out();
+    if (bufid == ZB_BUF_INVALID) {
+        esp_zb_mem_free(req->results);
+        req->results = NULL;
+        ESP_LOGE(TAG, "No buffer for match cluster request");
+        return ESP_ERR_NO_MEM;
+    }
+    /* the request struct holds one cluster, the others follow it */
+    param = zb_buf_initial_alloc(bufid, sizeof(zb_zdo_match_desc_param_t) + (cluster_num ? cluster_num - 1 : 0) * sizeof(zb_uint16_t));
+    param->nwk_addr = cmd_req->dst_nwk_addr;
+    param->addr_of_interest = cmd_req->addr_of_interest;
+    param->profile_id = cmd_req->profile_id;
+    param->num_in_clusters = cmd_req->num_in_clusters;
+    param->num_out_clusters = cmd_req->num_out_clusters;
+    for (uint8_t i = 0; i < cluster_num; i++) {
+        param->cluster_list[i] = cmd_req->cluster_list[i];
+    }
+    /* the buffer is owned by the stack once the request is sent, a request not sent leaves it to the caller */
+    tsn = zb_zdo_match_desc_req(bufid, esp_zb_zdo_match_cluster_resp_handler);
+    if (tsn == ZB_ZDO_INVALID_TSN) {
+        zb_buf_free(bufid);
+        esp_zb_mem_free(req->results);
+        req->results = NULL;
+        ESP_LOGE(TAG, "Failed to send match cluster request to 0x%04hx", cmd_req->dst_nwk_addr);
+        return ESP_ERR_NO_MEM;
+    }
+    req->in_use = true;
+    req->tsn = tsn;
+    req->broadcast = cmd_req->dst_nwk_addr >= ESP_ZB_ZDO_BROADCAST_ADDR_MIN;
+    req->user_cb = user_cb;
+    req->user_ctx = user_ctx;
+    esp_zb_scheduler_alarm(esp_zb_zdo_match_cluster_done, index,
+                           cmd_req->collect_window ? cmd_req->collect_window : ESP_ZB_ZDO_MATCH_CLUSTER_WINDOW);
+    return ESP_OK;
+}
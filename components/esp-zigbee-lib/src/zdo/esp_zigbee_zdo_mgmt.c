@@ -0,0 +1,655 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "sdkconfig.h"
+#include "zboss_api.h"
+#include "esp_zigbee_core.h"
+#include "zdo/esp_zigbee_zdo_command.h"
+#include "esp_zigbee_af_indication.h"
+#include "esp_zigbee_mem.h"
+
+#define ESP_ZB_ZDO_MGMT_REQ_MAX_NUM         8       /* maximum number of management requests waiting for the response */
+#define ESP_ZB_ZDO_MGMT_LQI_RECORD_MAX_NUM  4       /* maximum number of neighbor table records carried by one response */
+#define ESP_ZB_ZDO_MGMT_BIND_RECORD_MAX_NUM 5       /* maximum number of binding table records carried by one response */
+#define ESP_ZB_ZDO_MGMT_RTG_RECORD_MAX_NUM  16      /* maximum number of routing table records carried by one response */
+#define ESP_ZB_ZDO_BIND_BATCH_RETRY_DELAY   100     /* time in millisecond to wait before sending again when no request could be sent */
+
+/* the Mgmt_Rtg frames, refer to Zigbee specification 2.4.3.3.3 and 2.4.4.4.3 */
+#define ESP_ZB_ZDO_PROFILE_ID               0x0000
+#define ESP_ZB_ZDO_MGMT_RTG_REQ_CLUSTER     0x0032
+#define ESP_ZB_ZDO_MGMT_RTG_RSP_CLUSTER     0x8032
+#define ESP_ZB_ZDO_MGMT_RTG_RSP_HDR_LEN     5       /* tsn, status, routing table entries, start index, list count */
+#define ESP_ZB_ZDO_MGMT_RTG_RECORD_LEN      5       /* destination, status and flags, next hop */
+#define ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT 0x02
+
+static const char *TAG = "ESP_ZB_ZDO_MGMT";
+
+typedef struct esp_zb_zdo_mgmt_req_s {
+    bool in_use;
+    bool rtg;                                       /* a Mgmt_Rtg request, answered through the APS data indications */
+    uint8_t tsn;
+    uint16_t dst_addr;
+    void *user_cb;
+    void *user_ctx;
+} esp_zb_zdo_mgmt_req_t;
+
+typedef struct esp_zb_zdo_bind_batch_s {
+    bool running;
+    uint16_t entry_num;
+    uint16_t next_index;                            /* the next entry to send */
+    uint16_t done_num;
+    uint8_t in_flight;
+    uint8_t concurrency;
+    esp_zb_zdo_bind_batch_entry_t *entries;
+    esp_zb_zdp_status_t *status_list;
+    esp_zb_zdo_bind_batch_callback_t user_cb;
+    void *user_ctx;
+} esp_zb_zdo_bind_batch_t;
+
+static esp_zb_zdo_mgmt_req_t s_mgmt_req[ESP_ZB_ZDO_MGMT_REQ_MAX_NUM];
+#if CONFIG_ZB_ZDO_MGMT_RTG
+static uint8_t s_rtg_tsn;                           /* apart from the ZDO tsn of the stack, which is not exposed */
+static uint8_t s_rtg_num;                           /* the Mgmt_Rtg requests waiting for the response */
+#endif
+static esp_zb_zdo_bind_batch_t s_bind_batch;
+
+static esp_zb_zdo_mgmt_req_t *esp_zb_zdo_mgmt_req_alloc(void)
+{
+    for (uint8_t i = 0; i < ESP_ZB_ZDO_MGMT_REQ_MAX_NUM; i++) {
+        if (!s_mgmt_req[i].in_use) {
+            s_mgmt_req[i].in_use = true;
+            return &s_mgmt_req[i];
+        }
+    }
+    return NULL;
+}
+
+static bool esp_zb_zdo_mgmt_req_take(uint8_t tsn, esp_zb_zdo_mgmt_req_t *req)
+{
+    for (uint8_t i = 0; i < ESP_ZB_ZDO_MGMT_REQ_MAX_NUM; i++) {
+        if (s_mgmt_req[i].in_use && !s_mgmt_req[i].rtg && s_mgmt_req[i].tsn == tsn) {
+            *req = s_mgmt_req[i];
+            s_mgmt_req[i].in_use = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void esp_zb_zdo_mgmt_lqi_resp_handler(zb_uint8_t bufid)
+{
+    zb_zdo_mgmt_lqi_resp_t *resp = (zb_zdo_mgmt_lqi_resp_t *)zb_buf_begin(bufid);
+    zb_zdo_neighbor_table_record_t *record = (zb_zdo_neighbor_table_record_t *)(resp + 1);
+    esp_zb_zdo_neighbor_table_record_t list[ESP_ZB_ZDO_MGMT_LQI_RECORD_MAX_NUM];
+    esp_zb_zdo_mgmt_lqi_rsp_t rsp = {0};
+    esp_zb_zdo_mgmt_req_t req;
+
+    if (!esp_zb_zdo_mgmt_req_take(resp->tsn, &req)) {
+        ESP_LOGW(TAG, "Mgmt_Lqi response with unknown tsn: %d", resp->tsn);
+        zb_buf_free(bufid);
+        return;
+    }
+    if (resp->status == ESP_ZB_ZDP_STATUS_SUCCESS) {
+        uint32_t len = zb_buf_len(bufid);
+        uint8_t count = resp->neighbor_table_list_count;
+
+        /* the records are bounded by both the buffer length and the list count */
+        if (len < sizeof(*resp)) {
+            count = 0;
+        } else if (count > (len - sizeof(*resp)) / sizeof(*record)) {
+            count = (len - sizeof(*resp)) / sizeof(*record);
+        }
+        if (count > ESP_ZB_ZDO_MGMT_LQI_RECORD_MAX_NUM) {
+            count = ESP_ZB_ZDO_MGMT_LQI_RECORD_MAX_NUM;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            memcpy(list[i].ext_pan_id, record[i].ext_pan_id, sizeof(list[i].ext_pan_id));
+            memcpy(list[i].ieee_addr, record[i].ext_addr, sizeof(list[i].ieee_addr));
+            list[i].short_addr = record[i].network_addr;
+            list[i].device_type = record[i].type_flags & 0x03;
+            list[i].rx_on_when_idle = (record[i].type_flags >> 2) & 0x03;
+            list[i].relationship = (record[i].type_flags >> 4) & 0x07;
+            list[i].permit_join = record[i].permit_join & 0x03;
+            list[i].depth = record[i].depth;
+            list[i].lqi = record[i].lqi;
+        }
+        rsp.src_addr = req.dst_addr;
+        rsp.neighbor_table_entries = resp->neighbor_table_entries;
+        rsp.start_index = resp->start_index;
+        rsp.neighbor_table_list_count = count;
+        rsp.neighbor_table_list = list;
+    }
+    ((esp_zb_zdo_mgmt_lqi_callback_t)req.user_cb)((esp_zb_zdp_status_t)resp->status,
+                                                  resp->status == ESP_ZB_ZDP_STATUS_SUCCESS ? &rsp : NULL, req.user_ctx);
+    zb_buf_free(bufid);
+}
+
+esp_err_t esp_zb_zdo_mgmt_lqi_req(esp_zb_zdo_mgmt_lqi_req_param_t *cmd_req, esp_zb_zdo_mgmt_lqi_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_zdo_mgmt_req_t *req = NULL;
+    zb_zdo_mgmt_lqi_param_t *param = NULL;
+    zb_bufid_t bufid = 0;
+    uint8_t tsn = 0;
+
+    ESP_RETURN_ON_FALSE(cmd_req && user_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid Mgmt_Lqi request");
+    req = esp_zb_zdo_mgmt_req_alloc();
+    ESP_RETURN_ON_FALSE(req, ESP_ERR_NO_MEM, TAG, "No slot for Mgmt_Lqi request");
+    bufid = zb_buf_get_out();
+    if (bufid == ZB_BUF_INVALID) {
+        req->in_use = false;
+        ESP_LOGE(TAG, "No buffer for Mgmt_Lqi request");
+        return ESP_ERR_NO_MEM;
+    }
+    param = ZB_BUF_GET_PARAM(bufid, zb_zdo_mgmt_lqi_param_t);
+    param->dst_addr = cmd_req->dst_nwk_addr;
+    param->start_index = cmd_req->start_index;
+    /* the buffer is owned by the stack once the request is sent, a request not sent leaves it to the caller */
+    tsn = zb_zdo_mgmt_lqi_req(bufid, esp_zb_zdo_mgmt_lqi_resp_handler);
+    if (tsn == ZB_ZDO_INVALID_TSN) {
+        zb_buf_free(bufid);
+        req->in_use = false;
+        ESP_LOGE(TAG, "Failed to send Mgmt_Lqi request to 0x%04hx", cmd_req->dst_nwk_addr);
+        return ESP_ERR_NO_MEM;
+    }
+    req->tsn = tsn;
+    req->dst_addr = cmd_req->dst_nwk_addr;
+    req->user_cb = (void *)user_cb;
+    req->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+#if CONFIG_ZB_ZDO_MGMT_RTG
+static bool esp_zb_zdo_mgmt_rtg_indication(uint8_t bufid);
+
+static void esp_zb_zdo_mgmt_rtg_release(esp_zb_zdo_mgmt_req_t *req)
+{
+    req->in_use = false;
+    req->rtg = false;
+    if (--s_rtg_num == 0) {
+        esp_zb_af_indication_handler_remove(esp_zb_zdo_mgmt_rtg_indication);
+    }
+}
+
+static void esp_zb_zdo_mgmt_rtg_timeout(uint8_t param)
+{
+    esp_zb_zdo_mgmt_req_t req = s_mgmt_req[param];
+
+    if (!req.in_use || !req.rtg) {
+        return;
+    }
+    esp_zb_zdo_mgmt_rtg_release(&s_mgmt_req[param]);
+    ESP_LOGW(TAG, "Mgmt_Rtg request to 0x%04hx timed out", req.dst_addr);
+    ((esp_zb_zdo_mgmt_rtg_callback_t)req.user_cb)(ESP_ZB_ZDP_STATUS_TIMEOUT, NULL, req.user_ctx);
+}
+
+static bool esp_zb_zdo_mgmt_rtg_indication(uint8_t bufid)
+{
+    zb_apsde_data_indication_t *ind = ZB_BUF_GET_PARAM(bufid, zb_apsde_data_indication_t);
+    const uint8_t *data = zb_buf_begin(bufid);
+    uint32_t len = zb_buf_len(bufid);
+    esp_zb_zdo_routing_table_record_t list[ESP_ZB_ZDO_MGMT_RTG_RECORD_MAX_NUM];
+    esp_zb_zdo_mgmt_rtg_rsp_t rsp = {0};
+    esp_zb_zdo_mgmt_req_t req;
+    uint8_t index = 0;
+
+    if (ind->profileid != ESP_ZB_ZDO_PROFILE_ID || ind->clusterid != ESP_ZB_ZDO_MGMT_RTG_RSP_CLUSTER || len < 2) {
+        return false;
+    }
+    for (index = 0; index < ESP_ZB_ZDO_MGMT_REQ_MAX_NUM; index++) {
+        if (s_mgmt_req[index].in_use && s_mgmt_req[index].rtg && s_mgmt_req[index].tsn == data[0] &&
+                s_mgmt_req[index].dst_addr == ind->src_addr) {
+            break;
+        }
+    }
+    if (index == ESP_ZB_ZDO_MGMT_REQ_MAX_NUM) {
+        return false;
+    }
+    req = s_mgmt_req[index];
+    esp_zb_scheduler_alarm_cancel(esp_zb_zdo_mgmt_rtg_timeout, index);
+    esp_zb_zdo_mgmt_rtg_release(&s_mgmt_req[index]);
+    if (data[1] == ESP_ZB_ZDP_STATUS_SUCCESS && len >= ESP_ZB_ZDO_MGMT_RTG_RSP_HDR_LEN) {
+        const uint8_t *record = &data[ESP_ZB_ZDO_MGMT_RTG_RSP_HDR_LEN];
+        uint8_t count = data[4];
+
+        /* the records are bounded by both the buffer length and the list count */
+        if (count > (len - ESP_ZB_ZDO_MGMT_RTG_RSP_HDR_LEN) / ESP_ZB_ZDO_MGMT_RTG_RECORD_LEN) {
+            count = (len - ESP_ZB_ZDO_MGMT_RTG_RSP_HDR_LEN) / ESP_ZB_ZDO_MGMT_RTG_RECORD_LEN;
+        }
+        if (count > ESP_ZB_ZDO_MGMT_RTG_RECORD_MAX_NUM) {
+            count = ESP_ZB_ZDO_MGMT_RTG_RECORD_MAX_NUM;
+        }
+        for (uint8_t i = 0; i < count; i++, record += ESP_ZB_ZDO_MGMT_RTG_RECORD_LEN) {
+            list[i].dst_addr = record[0] | (record[1] << 8);
+            list[i].status = record[2] & 0x07;
+            list[i].memory_constrained = (record[2] >> 3) & 0x01;
+            list[i].many_to_one = (record[2] >> 4) & 0x01;
+            list[i].route_record_required = (record[2] >> 5) & 0x01;
+            list[i].next_hop_addr = record[3] | (record[4] << 8);
+        }
+        rsp.src_addr = req.dst_addr;
+        rsp.routing_table_entries = data[2];
+        rsp.start_index = data[3];
+        rsp.routing_table_list_count = count;
+        rsp.routing_table_list = list;
+    }
+    ((esp_zb_zdo_mgmt_rtg_callback_t)req.user_cb)((esp_zb_zdp_status_t)data[1],
+                                                  data[1] == ESP_ZB_ZDP_STATUS_SUCCESS && rsp.routing_table_list ? &rsp : NULL,
+                                                  req.user_ctx);
+    /* the response is consumed, so the stack does not match its tsn against a request of its own */
+    zb_buf_free(bufid);
+    return true;
+}
+
+esp_err_t esp_zb_zdo_mgmt_rtg_req(esp_zb_zdo_mgmt_rtg_req_param_t *cmd_req, esp_zb_zdo_mgmt_rtg_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_zdo_mgmt_req_t *req = NULL;
+    zb_apsde_data_req_t *param = NULL;
+    zb_bufid_t bufid = 0;
+    uint8_t *payload = NULL;
+
+    ESP_RETURN_ON_FALSE(cmd_req && user_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid Mgmt_Rtg request");
+    if (s_rtg_num == 0) {
+        ESP_RETURN_ON_FALSE(esp_zb_af_indication_handler_add(esp_zb_zdo_mgmt_rtg_indication) == ESP_OK, ESP_ERR_NO_MEM, TAG,
+                            "No data indication handler for Mgmt_Rtg request");
+    }
+    req = esp_zb_zdo_mgmt_req_alloc();
+    if (req) {
+        bufid = zb_buf_get_out();
+        if (bufid == ZB_BUF_INVALID) {
+            req->in_use = false;
+            req = NULL;
+        }
+    }
+    if (!req) {
+        if (s_rtg_num == 0) {
+            esp_zb_af_indication_handler_remove(esp_zb_zdo_mgmt_rtg_indication);
+        }
+        ESP_LOGE(TAG, "No slot or buffer for Mgmt_Rtg request");
+        return ESP_ERR_NO_MEM;
+    }
+    req->rtg = true;
+    req->tsn = s_rtg_tsn++;
+    req->dst_addr = cmd_req->dst_nwk_addr;
+    req->user_cb = (void *)user_cb;
+    req->user_ctx = user_ctx;
+    s_rtg_num++;
+    payload = zb_buf_initial_alloc(bufid, 2);
+    payload[0] = req->tsn;
+    payload[1] = cmd_req->start_index;
+    param = ZB_BUF_GET_PARAM(bufid, zb_apsde_data_req_t);
+    memset(param, 0, sizeof(zb_apsde_data_req_t));
+    param->dst_addr.addr_short = cmd_req->dst_nwk_addr;
+    param->addr_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
+    param->profileid = ESP_ZB_ZDO_PROFILE_ID;
+    param->clusterid = ESP_ZB_ZDO_MGMT_RTG_REQ_CLUSTER;
+    /* the buffer is owned by the stack from now on, the response or the timeout completes the request */
+    zb_apsde_data_request(bufid);
+    esp_zb_scheduler_alarm(esp_zb_zdo_mgmt_rtg_timeout, req - s_mgmt_req, ESP_ZB_ZDO_MGMT_RTG_TIMEOUT);
+    return ESP_OK;
+}
+#else
+esp_err_t esp_zb_zdo_mgmt_rtg_req(esp_zb_zdo_mgmt_rtg_req_param_t *cmd_req, esp_zb_zdo_mgmt_rtg_callback_t user_cb, void *user_ctx)
+{
+    ESP_LOGE(TAG, "Mgmt_Rtg request needs CONFIG_ZB_ZDO_MGMT_RTG");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+#endif
+
+static void esp_zb_zdo_bind_resp_handler(zb_uint8_t bufid)
+{
+    zb_zdo_bind_resp_t *resp = (zb_zdo_bind_resp_t *)zb_buf_begin(bufid);
+    esp_zb_zdo_mgmt_req_t req;
+
+    if (esp_zb_zdo_mgmt_req_take(resp->tsn, &req)) {
+        ((esp_zb_zdo_bind_callback_t)req.user_cb)((esp_zb_zdp_status_t)resp->status, req.user_ctx);
+    } else {
+        ESP_LOGW(TAG, "Bind response with unknown tsn: %d", resp->tsn);
+    }
+    zb_buf_free(bufid);
+}
+
+static esp_err_t esp_zb_zdo_bind_send(bool unbind, const esp_zb_zdo_bind_req_param_t *cmd_req, uint8_t dst_addr_mode,
+                                      esp_zb_zdo_bind_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_zdo_mgmt_req_t *req = NULL;
+    zb_zdo_bind_req_param_t *param = NULL;
+    zb_bufid_t bufid = 0;
+    uint8_t tsn = 0;
+
+    ESP_RETURN_ON_FALSE(cmd_req && user_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid bind request");
+    ESP_RETURN_ON_FALSE(dst_addr_mode == ESP_ZB_ZDO_BIND_DST_ADDR_MODE_16_BIT_GROUP ||
+                        dst_addr_mode == ESP_ZB_ZDO_BIND_DST_ADDR_MODE_64_BIT_EXTENDED, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid bind destination address mode: %d", dst_addr_mode);
+    req = esp_zb_zdo_mgmt_req_alloc();
+    ESP_RETURN_ON_FALSE(req, ESP_ERR_NO_MEM, TAG, "No slot for bind request");
+    bufid = zb_buf_get_out();
+    if (bufid == ZB_BUF_INVALID) {
+        req->in_use = false;
+        ESP_LOGE(TAG, "No buffer for bind request");
+        return ESP_ERR_NO_MEM;
+    }
+    param = ZB_BUF_GET_PARAM(bufid, zb_zdo_bind_req_param_t);
+    memset(param, 0, sizeof(zb_zdo_bind_req_param_t));
+    memcpy(param->src_address, cmd_req->src_address, sizeof(esp_zb_ieee_addr_t));
+    param->src_endp = cmd_req->src_endp;
+    param->cluster_id = cmd_req->cluster_id;
+    param->dst_addr_mode = dst_addr_mode;
+    if (dst_addr_mode == ESP_ZB_ZDO_BIND_DST_ADDR_MODE_16_BIT_GROUP) {
+        param->dst_address.addr_short = cmd_req->dst_address_u.addr_short;
+    } else {
+        memcpy(param->dst_address.addr_long, cmd_req->dst_address_u.addr_long, sizeof(esp_zb_ieee_addr_t));
+        param->dst_endp = cmd_req->dst_endp;
+    }
+    param->req_dst_addr = cmd_req->req_dst_addr;
+    /* the buffer is owned by the stack once the request is sent, a request not sent leaves it to the caller */
+    tsn = unbind ? zb_zdo_unbind_req(bufid, esp_zb_zdo_bind_resp_handler) : zb_zdo_bind_req(bufid, esp_zb_zdo_bind_resp_handler);
+    if (tsn == ZB_ZDO_INVALID_TSN) {
+        zb_buf_free(bufid);
+        req->in_use = false;
+        ESP_LOGE(TAG, "Failed to send %s request to 0x%04hx", unbind ? "unbind" : "bind", cmd_req->req_dst_addr);
+        return ESP_ERR_NO_MEM;
+    }
+    req->tsn = tsn;
+    req->dst_addr = cmd_req->req_dst_addr;
+    req->user_cb = (void *)user_cb;
+    req->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_zdo_device_group_bind_req(esp_zb_zdo_bind_req_param_t *cmd_req, esp_zb_zdo_bind_callback_t user_cb, void *user_ctx)
+{
+    return esp_zb_zdo_bind_send(false, cmd_req, ESP_ZB_ZDO_BIND_DST_ADDR_MODE_16_BIT_GROUP, user_cb, user_ctx);
+}
+
+esp_err_t esp_zb_zdo_device_unbind_req(esp_zb_zdo_bind_req_param_t *cmd_req, esp_zb_zdo_bind_callback_t user_cb, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(cmd_req, ESP_ERR_INVALID_ARG, TAG, "Invalid unbind request");
+    return esp_zb_zdo_bind_send(true, cmd_req, cmd_req->dst_addr_mode, user_cb, user_ctx);
+}
+
+static void esp_zb_zdo_mgmt_bind_resp_handler(zb_uint8_t bufid)
+{
+    zb_zdo_mgmt_bind_resp_t *resp = (zb_zdo_mgmt_bind_resp_t *)zb_buf_begin(bufid);
+    zb_zdo_binding_table_record_t *record = (zb_zdo_binding_table_record_t *)(resp + 1);
+    esp_zb_zdo_binding_table_record_t list[ESP_ZB_ZDO_MGMT_BIND_RECORD_MAX_NUM];
+    esp_zb_zdo_mgmt_bind_rsp_t rsp = {0};
+    esp_zb_zdo_mgmt_req_t req;
+
+    if (!esp_zb_zdo_mgmt_req_take(resp->tsn, &req)) {
+        ESP_LOGW(TAG, "Mgmt_Bind response with unknown tsn: %d", resp->tsn);
+        zb_buf_free(bufid);
+        return;
+    }
+    if (resp->status == ESP_ZB_ZDP_STATUS_SUCCESS) {
+        uint32_t len = zb_buf_len(bufid);
+        uint8_t count = resp->binding_table_list_count;
+
+        /* the records are bounded by both the buffer length and the list count */
+        if (len < sizeof(*resp)) {
+            count = 0;
+        } else if (count > (len - sizeof(*resp)) / sizeof(*record)) {
+            count = (len - sizeof(*resp)) / sizeof(*record);
+        }
+        if (count > ESP_ZB_ZDO_MGMT_BIND_RECORD_MAX_NUM) {
+            count = ESP_ZB_ZDO_MGMT_BIND_RECORD_MAX_NUM;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            memset(&list[i], 0, sizeof(list[i]));
+            memcpy(list[i].src_address, record[i].src_address, sizeof(list[i].src_address));
+            list[i].src_endp = record[i].src_endp;
+            list[i].cluster_id = record[i].cluster_id;
+            list[i].dst_addr_mode = record[i].dst_addr_mode;
+            if (record[i].dst_addr_mode == ESP_ZB_ZDO_BIND_DST_ADDR_MODE_16_BIT_GROUP) {
+                list[i].dst_address.addr_short = record[i].dst_address.addr_short;
+            } else {
+                memcpy(list[i].dst_address.addr_long, record[i].dst_address.addr_long, sizeof(esp_zb_ieee_addr_t));
+                list[i].dst_endp = record[i].dst_endp;
+            }
+        }
+        rsp.src_addr = req.dst_addr;
+        rsp.binding_table_entries = resp->binding_table_entries;
+        rsp.start_index = resp->start_index;
+        rsp.binding_table_list_count = count;
+        rsp.binding_table_list = list;
+    }
+    ((esp_zb_zdo_mgmt_bind_callback_t)req.user_cb)((esp_zb_zdp_status_t)resp->status,
+                                                   resp->status == ESP_ZB_ZDP_STATUS_SUCCESS ? &rsp : NULL, req.user_ctx);
+    zb_buf_free(bufid);
+}
+
+esp_err_t esp_zb_zdo_mgmt_bind_req(esp_zb_zdo_mgmt_bind_req_param_t *cmd_req, esp_zb_zdo_mgmt_bind_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_zdo_mgmt_req_t *req = NULL;
+    zb_zdo_mgmt_bind_param_t *param = NULL;
+    zb_bufid_t bufid = 0;
+    uint8_t tsn = 0;
+
+    ESP_RETURN_ON_FALSE(cmd_req && user_cb, ESP_ERR_INVALID_ARG, TAG, "Invalid Mgmt_Bind request");
+    req = esp_zb_zdo_mgmt_req_alloc();
+    ESP_RETURN_ON_FALSE(req, ESP_ERR_NO_MEM, TAG, "No slot for Mgmt_Bind request");
+    bufid = zb_buf_get_out();
+    if (bufid == ZB_BUF_INVALID) {
+        req->in_use = false;
+        ESP_LOGE(TAG, "No buffer for Mgmt_Bind request");
+        return ESP_ERR_NO_MEM;
+    }
+    param = ZB_BUF_GET_PARAM(bufid, zb_zdo_mgmt_bind_param_t);
+    param->dst_addr = cmd_req->dst_nwk_addr;
+    param->start_index = cmd_req->start_index;
+    /* the buffer is owned by the stack once the request is sent, a request not sent leaves it to the caller */
+    tsn = zb_zdo_mgmt_bind_req(bufid, esp_zb_zdo_mgmt_bind_resp_handler);
+    if (tsn == ZB_ZDO_INVALID_TSN) {
+        zb_buf_free(bufid);
+        req->in_use = false;
+        ESP_LOGE(TAG, "Failed to send Mgmt_Bind request to 0x%04hx", cmd_req->dst_nwk_addr);
+        return ESP_ERR_NO_MEM;
+    }
+    req->tsn = tsn;
+    req->dst_addr = cmd_req->dst_nwk_addr;
+    req->user_cb = (void *)user_cb;
+    req->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+static void esp_zb_zdo_energy_scan_resp_handler(zb_uint8_t bufid)
+{
+    zb_zdo_mgmt_nwk_update_notify_hdr_t *resp = (zb_zdo_mgmt_nwk_update_notify_hdr_t *)zb_buf_begin(bufid);
+    esp_zb_zdo_mgmt_nwk_update_rsp_t rsp = {0};
+    esp_zb_zdo_mgmt_req_t req;
+
+    if (!esp_zb_zdo_mgmt_req_take(resp->tsn, &req)) {
+        ESP_LOGW(TAG, "Mgmt_NWK_Update_notify with unknown tsn: %d", resp->tsn);
+        zb_buf_free(bufid);
+        return;
+    }
+    if (resp->status == ESP_ZB_ZDP_STATUS_SUCCESS) {
+        uint32_t len = zb_buf_len(bufid);
+        uint8_t count = resp->scanned_channels_list_count;
+
+        /* the energy values are bounded by both the buffer length and the list count */
+        if (len < sizeof(*resp)) {
+            count = 0;
+        } else if (count > len - sizeof(*resp)) {
+            count = len - sizeof(*resp);
+        }
+        if (count > ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_NUM) {
+            count = ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_NUM;
+        }
+        rsp.src_addr = req.dst_addr;
+        rsp.scanned_channels = resp->scanned_channels;
+        rsp.total_transmissions = resp->total_transmissions;
+        rsp.transmission_failures = resp->transmission_failures;
+        rsp.energy_list_count = count;
+        memcpy(rsp.energy_list, resp + 1, count);
+    }
+    ((esp_zb_zdo_energy_scan_callback_t)req.user_cb)((esp_zb_zdp_status_t)resp->status,
+                                                     resp->status == ESP_ZB_ZDP_STATUS_SUCCESS ? &rsp : NULL, req.user_ctx);
+    zb_buf_free(bufid);
+}
+
+esp_err_t esp_zb_zdo_energy_scan_req(esp_zb_zdo_energy_scan_req_param_t *cmd_req, esp_zb_zdo_energy_scan_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_zdo_mgmt_req_t *req = NULL;
+    zb_zdo_mgmt_nwk_update_req_t *param = NULL;
+    zb_bufid_t bufid = 0;
+    uint8_t tsn = 0;
+
+    ESP_RETURN_ON_FALSE(cmd_req && user_cb && cmd_req->scan_duration <= ESP_ZB_ZDO_NWK_UPDATE_SCAN_DURATION_MAX &&
+                        cmd_req->scan_count >= 1 && cmd_req->scan_count <= 5 && cmd_req->scan_channels &&
+                        !(cmd_req->scan_channels & ~ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_MASK), ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid energy scan request");
+    req = esp_zb_zdo_mgmt_req_alloc();
+    ESP_RETURN_ON_FALSE(req, ESP_ERR_NO_MEM, TAG, "No slot for energy scan request");
+    bufid = zb_buf_get_out();
+    if (bufid == ZB_BUF_INVALID) {
+        req->in_use = false;
+        ESP_LOGE(TAG, "No buffer for energy scan request");
+        return ESP_ERR_NO_MEM;
+    }
+    param = ZB_BUF_GET_PARAM(bufid, zb_zdo_mgmt_nwk_update_req_t);
+    memset(param, 0, sizeof(zb_zdo_mgmt_nwk_update_req_t));
+    param->hdr.scan_channels = cmd_req->scan_channels;
+    param->hdr.scan_duration = cmd_req->scan_duration;
+    param->scan_count = cmd_req->scan_count;
+    param->dst_addr = cmd_req->dst_nwk_addr;
+    /* the buffer is owned by the stack once the request is sent, a request not sent leaves it to the caller */
+    tsn = zb_zdo_mgmt_nwk_update_req(bufid, esp_zb_zdo_energy_scan_resp_handler);
+    if (tsn == ZB_ZDO_INVALID_TSN) {
+        zb_buf_free(bufid);
+        req->in_use = false;
+        ESP_LOGE(TAG, "Failed to send energy scan request to 0x%04hx", cmd_req->dst_nwk_addr);
+        return ESP_ERR_NO_MEM;
+    }
+    req->tsn = tsn;
+    req->dst_addr = cmd_req->dst_nwk_addr;
+    req->user_cb = (void *)user_cb;
+    req->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_zdo_channel_change_req(uint8_t channel)
+{
+    zb_zdo_mgmt_nwk_update_req_t *param = NULL;
+    zb_bufid_t bufid = 0;
+
+    ESP_RETURN_ON_FALSE(channel >= 11 && channel <= 26, ESP_ERR_INVALID_ARG, TAG, "Invalid channel: %d", channel);
+    bufid = zb_buf_get_out();
+    ESP_RETURN_ON_FALSE(bufid != ZB_BUF_INVALID, ESP_ERR_NO_MEM, TAG, "No buffer for channel change request");
+    param = ZB_BUF_GET_PARAM(bufid, zb_zdo_mgmt_nwk_update_req_t);
+    memset(param, 0, sizeof(zb_zdo_mgmt_nwk_update_req_t));
+    param->hdr.scan_channels = 1UL << channel;
+    param->hdr.scan_duration = ZB_ZDO_NEW_ACTIVE_CHANNEL;
+    param->dst_addr = ESP_ZB_NWK_BROADCAST_RX_ON_WHEN_IDLE;
+    /* a broadcast is not answered, the buffer is owned by the stack once the request is sent */
+    if (zb_zdo_mgmt_nwk_update_req(bufid, NULL) == ZB_ZDO_INVALID_TSN) {
+        zb_buf_free(bufid);
+        ESP_LOGE(TAG, "Failed to send channel change request");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Move the network to channel %d", channel);
+    return ESP_OK;
+}
+
+static void esp_zb_zdo_bind_batch_bind_cb(esp_zb_zdp_status_t zdo_status, void *user_ctx);
+
+/* the stack reports a request left unanswered itself, this one completes the entry should it not, the request slot is
+ * released so a late response is ignored */
+static void esp_zb_zdo_bind_batch_timeout(uint8_t param)
+{
+    void *user_ctx = (void *)(uintptr_t)param;
+
+    for (uint8_t i = 0; i < ESP_ZB_ZDO_MGMT_REQ_MAX_NUM; i++) {
+        if (s_mgmt_req[i].in_use && !s_mgmt_req[i].rtg && s_mgmt_req[i].user_cb == (void *)esp_zb_zdo_bind_batch_bind_cb &&
+                s_mgmt_req[i].user_ctx == user_ctx) {
+            s_mgmt_req[i].in_use = false;
+            ESP_LOGW(TAG, "Bind request of batch entry %d to 0x%04hx timed out", param, s_mgmt_req[i].dst_addr);
+            esp_zb_zdo_bind_batch_bind_cb(ESP_ZB_ZDP_STATUS_TIMEOUT, user_ctx);
+            return;
+        }
+    }
+}
+
+static void esp_zb_zdo_bind_batch_dispatch(uint8_t param)
+{
+    esp_zb_zdo_bind_batch_t *batch = &s_bind_batch;
+
+    while (batch->running && batch->in_flight < batch->concurrency && batch->next_index < batch->entry_num) {
+        esp_zb_zdo_bind_batch_entry_t *entry = &batch->entries[batch->next_index];
+        esp_err_t ret = esp_zb_zdo_bind_send(entry->unbind, &entry->bind_req, entry->bind_req.dst_addr_mode,
+                                             esp_zb_zdo_bind_batch_bind_cb, (void *)(uintptr_t)batch->next_index);
+
+        if (ret == ESP_ERR_INVALID_ARG) {
+            batch->status_list[batch->next_index++] = ESP_ZB_ZDP_STATUS_INV_REQUESTTYPE;
+            batch->done_num++;
+            continue;
+        } else if (ret != ESP_OK) {
+            /* no response will wake up the batch if nothing is in flight */
+            if (!batch->in_flight) {
+                esp_zb_scheduler_alarm(esp_zb_zdo_bind_batch_dispatch, 0, ESP_ZB_ZDO_BIND_BATCH_RETRY_DELAY);
+            }
+            return;
+        }
+        /* the entry index fits the alarm parameter, as a batch has up to ESP_ZB_ZDO_BIND_BATCH_MAX_NUM entries */
+        esp_zb_scheduler_alarm(esp_zb_zdo_bind_batch_timeout, (uint8_t)batch->next_index, ESP_ZB_ZDO_BIND_BATCH_TIMEOUT);
+        batch->in_flight++;
+        batch->next_index++;
+    }
+    if (batch->running && batch->done_num == batch->entry_num) {
+        esp_zb_zdo_bind_batch_t done = *batch;
+
+        /* release the batch first, so the callback can send the next batch */
+        memset(batch, 0, sizeof(esp_zb_zdo_bind_batch_t));
+        done.user_cb(done.status_list, done.entry_num, done.user_ctx);
+        esp_zb_mem_free(done.entries);
+        esp_zb_mem_free(done.status_list);
+    }
+}
+
+static void esp_zb_zdo_bind_batch_bind_cb(esp_zb_zdp_status_t zdo_status, void *user_ctx)
+{
+    uint16_t index = (uint16_t)(uintptr_t)user_ctx;
+
+    if (!s_bind_batch.running || index >= s_bind_batch.entry_num) {
+        return;
+    }
+    esp_zb_scheduler_alarm_cancel(esp_zb_zdo_bind_batch_timeout, (uint8_t)index);
+    s_bind_batch.status_list[index] = zdo_status;
+    s_bind_batch.in_flight--;
+    s_bind_batch.done_num++;
+    esp_zb_zdo_bind_batch_dispatch(0);
+}
+
+esp_err_t esp_zb_zdo_bind_batch_req(const esp_zb_zdo_bind_batch_entry_t *entries, uint16_t entry_num, uint8_t concurrency,
+                                    esp_zb_zdo_bind_batch_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_zdo_bind_batch_t *batch = &s_bind_batch;
+
+    ESP_RETURN_ON_FALSE(entries && entry_num && entry_num <= ESP_ZB_ZDO_BIND_BATCH_MAX_NUM && user_cb, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid bind batch");
+    ESP_RETURN_ON_FALSE(concurrency && concurrency <= ESP_ZB_ZDO_BIND_BATCH_CONCURRENCY_MAX_NUM, ESP_ERR_INVALID_ARG, TAG,
+                        "Invalid bind batch concurrency: %d", concurrency);
+    ESP_RETURN_ON_FALSE(!batch->running, ESP_ERR_INVALID_STATE, TAG, "Bind batch is running");
+    batch->entries = esp_zb_mem_malloc(ESP_ZB_MEM_TAG_ZDO, entry_num * sizeof(esp_zb_zdo_bind_batch_entry_t));
+    batch->status_list = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZDO, entry_num, sizeof(esp_zb_zdp_status_t));
+    if (!batch->entries || !batch->status_list) {
+        esp_zb_mem_free(batch->entries);
+        esp_zb_mem_free(batch->status_list);
+        memset(batch, 0, sizeof(esp_zb_zdo_bind_batch_t));
+        ESP_LOGE(TAG, "No memory for bind batch");
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(batch->entries, entries, entry_num * sizeof(esp_zb_zdo_bind_batch_entry_t));
+    batch->entry_num = entry_num;
+    batch->concurrency = concurrency;
+    batch->user_cb = user_cb;
+    batch->user_ctx = user_ctx;
+    batch->running = true;
+    esp_zb_zdo_bind_batch_dispatch(0);
+    return ESP_OK;
+}
@@ -16,6 +16,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "ha/esp_zigbee_ha_standard.h"
+#include "esp_zigbee_startup.h"
 #include "esp_zb_light.h"
 
 /**
@@ -40,6 +41,7 @@ void attr_cb(uint8_t status, uint8_t endpoint, uint16_t cluster_id, uint16_t att
             /* implemented light on/off control */
             ESP_LOGI(TAG, "on/off light set to %hd", value);
             light_driver_set_power((bool)value);
+            esp_zb_startup_mark(ESP_ZB_STARTUP_PHASE_FIRST_COMMAND);
         }
     } else {
         /* Implement some actions if needed when other cluster changed */
@@ -52,13 +54,16 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
     uint32_t *p_sg_p       = signal_struct->p_app_signal;
     esp_err_t err_status = signal_struct->esp_err_status;
     esp_zb_app_signal_type_t sig_type = *p_sg_p;
+    if (esp_zb_startup_signal_handle(signal_struct)) {
+        /* the fast rejoin retries on the stored channel */
+        return;
+    }
     switch (sig_type) {
     case ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP:
         ESP_LOGI(TAG, "Zigbee stack initialized");
         esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_INITIALIZATION);
         break;
     case ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START:
-    case ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT:
         if (err_status == ESP_OK) {
             ESP_LOGI(TAG, "Start network steering");
             esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_STEERING);
@@ -67,6 +72,17 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
             ESP_LOGW(TAG, "Failed to initialize Zigbee stack (status: %d)", err_status);
         }
         break;
+    case ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT:
+        if (err_status == ESP_OK) {
+            /* the light is back on its network, steering again would only open the network to joining */
+            ESP_LOGI(TAG, "Rejoined network on channel %d", esp_zb_get_current_channel());
+            esp_zb_startup_dump();
+        } else {
+            /* the light is still commissioned, the rejoin is retried later on all the channels of the primary set */
+            ESP_LOGW(TAG, "Failed to rejoin network (status: %d), retry later", err_status);
+            esp_zb_scheduler_alarm((esp_zb_callback_t)bdb_start_top_level_commissioning_cb, ESP_ZB_BDB_MODE_INITIALIZATION, 1000);
+        }
+        break;
     case ESP_ZB_BDB_SIGNAL_STEERING:
         if (err_status == ESP_OK) {
             esp_zb_ieee_addr_t extended_pan_id;
@@ -97,6 +113,12 @@ static void esp_zb_task(void *pvParameters)
     esp_zb_device_register(esp_zb_on_off_light_ep);
     esp_zb_device_add_set_attr_value_cb(attr_cb);
     esp_zb_set_primary_network_channel_set(ESP_ZB_PRIMARY_CHANNEL_MASK);
+    /* rejoin on the stored channel at once after a power cycle */
+    esp_zb_startup_cfg_t startup_cfg = {
+        .fast_rejoin = true,
+        .channel_mask = ESP_ZB_PRIMARY_CHANNEL_MASK,
+    };
+    ESP_ERROR_CHECK(esp_zb_startup_config(&startup_cfg));
     ESP_ERROR_CHECK(esp_zb_start(false));
     esp_zb_main_loop_iteration();
 }
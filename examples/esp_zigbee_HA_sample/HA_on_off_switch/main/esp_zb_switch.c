@@ -17,6 +17,8 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "ha/esp_zigbee_ha_standard.h"
+#include "esp_zigbee_signal.h"
+#include "esp_zigbee_submit.h"
 #include "esp_zb_switch.h"
 
 /**
@@ -43,6 +45,11 @@ static const char *TAG = "ESP_ZB_ON_OFF_SWITCH";
 light_bulb_device_params_t on_off_light;
 /********************* Define functions **************************/
 
+static void esp_zb_on_off_cmd_submit_cb(void *data)
+{
+    esp_zb_zcl_on_off_cmd_req((esp_zb_zcl_on_off_cmd_t *)data);
+}
+
 /**
  * @brief Callback for button events, currently only toggle event available
  *
@@ -59,7 +66,10 @@ static void esp_zb_buttons_handler(switch_func_pair_t *button_func_pair)
         cmd_req.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
         cmd_req.on_off_cmd_id = ESP_ZB_ZCL_CMD_ON_OFF_TOGGLE_ID;
         ESP_EARLY_LOGI(TAG, "send 'on_off toggle' command");
-        esp_zb_zcl_on_off_cmd_req(&cmd_req);
+        /* the button handler runs in the switch driver task, the command is sent from the Zigbee task */
+        if (esp_zb_submit(esp_zb_on_off_cmd_submit_cb, &cmd_req, sizeof(cmd_req)) != ESP_OK) {
+            ESP_EARLY_LOGW(TAG, "Failed to queue the 'on_off toggle' command");
+        }
     }
 }
 
@@ -77,56 +87,72 @@ void user_find_cb(esp_zb_zdp_status_t zdo_status, uint16_t addr, uint8_t endpoin
     }
 }
 
+static void esp_zb_skip_startup_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    ESP_LOGI(TAG, "Zigbee stack initialized");
+    esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_INITIALIZATION);
+}
+
+static void esp_zb_device_start_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    if (signal->status == ESP_OK) {
+        ESP_LOGI(TAG, "Start network formation");
+        esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_FORMATION);
+    } else {
+        ESP_LOGE(TAG, "Failed to initialize Zigbee stack (status: %d)", signal->status);
+    }
+}
+
+static void esp_zb_formation_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    if (signal->status == ESP_OK) {
+        esp_zb_ieee_addr_t extended_pan_id;
+        esp_zb_get_extended_pan_id(extended_pan_id);
+        ESP_LOGI(TAG, "Formed network successfully (Extended PAN ID: %02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x, PAN ID: 0x%04hx, Channel:%d)",
+                 extended_pan_id[7], extended_pan_id[6], extended_pan_id[5], extended_pan_id[4],
+                 extended_pan_id[3], extended_pan_id[2], extended_pan_id[1], extended_pan_id[0],
+                 esp_zb_get_pan_id(), esp_zb_get_current_channel());
+        esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_STEERING);
+    } else {
+        ESP_LOGI(TAG, "Restart network formation (status: %d)", signal->status);
+        esp_zb_scheduler_alarm((esp_zb_callback_t)bdb_start_top_level_commissioning_cb, ESP_ZB_BDB_MODE_NETWORK_FORMATION, 1000);
+    }
+}
+
+static void esp_zb_steering_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    if (signal->status == ESP_OK) {
+        ESP_LOGI(TAG, "Network steering started");
+    }
+}
+
+static void esp_zb_device_annce_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    esp_zb_zdo_signal_device_annce_params_t *dev_annce_params = esp_zb_signal_get_device_annce_params(signal);
+    esp_zb_zdo_match_desc_req_param_t cmd_req;
+
+    ESP_LOGI(TAG, "New device commissioned or rejoined (short: 0x%04hx)", dev_annce_params->device_short_addr);
+    cmd_req.dst_nwk_addr = dev_annce_params->device_short_addr;
+    cmd_req.addr_of_interest = dev_annce_params->device_short_addr;
+    esp_zb_zdo_find_on_off_light(&cmd_req, user_find_cb, NULL);
+}
+
+static void esp_zb_signal_subscriptions_init(void)
+{
+    ESP_ERROR_CHECK(esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, esp_zb_skip_startup_cb, NULL));
+    ESP_ERROR_CHECK(esp_zb_signal_subscribe(ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START, esp_zb_device_start_cb, NULL));
+    ESP_ERROR_CHECK(esp_zb_signal_subscribe(ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT, esp_zb_device_start_cb, NULL));
+    ESP_ERROR_CHECK(esp_zb_signal_subscribe(ESP_ZB_BDB_SIGNAL_FORMATION, esp_zb_formation_cb, NULL));
+    ESP_ERROR_CHECK(esp_zb_signal_subscribe(ESP_ZB_BDB_SIGNAL_STEERING, esp_zb_steering_cb, NULL));
+    ESP_ERROR_CHECK(esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, esp_zb_device_annce_cb, NULL));
+}
+
 void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
 {
-    uint32_t *p_sg_p       = signal_struct->p_app_signal;
-    esp_err_t err_status = signal_struct->esp_err_status;
-    esp_zb_app_signal_type_t sig_type = *p_sg_p;
-    esp_zb_zdo_signal_device_annce_params_t *dev_annce_params = NULL;
-    switch (sig_type) {
-    case ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP:
-        ESP_LOGI(TAG, "Zigbee stack initialized");
-        esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_INITIALIZATION);
-        break;
-    case ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START:
-    case ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT:
-        if (err_status == ESP_OK) {
-            ESP_LOGI(TAG, "Start network formation");
-            esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_FORMATION);
-        } else {
-            ESP_LOGE(TAG, "Failed to initialize Zigbee stack (status: %d)", err_status);
-        }
-        break;
-    case ESP_ZB_BDB_SIGNAL_FORMATION:
-        if (err_status == ESP_OK) {
-            esp_zb_ieee_addr_t extended_pan_id;
-            esp_zb_get_extended_pan_id(extended_pan_id);
-            ESP_LOGI(TAG, "Formed network successfully (Extended PAN ID: %02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x, PAN ID: 0x%04hx, Channel:%d)",
-                     extended_pan_id[7], extended_pan_id[6], extended_pan_id[5], extended_pan_id[4],
-                     extended_pan_id[3], extended_pan_id[2], extended_pan_id[1], extended_pan_id[0],
-                     esp_zb_get_pan_id(), esp_zb_get_current_channel());
-            esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_STEERING);
-        } else {
-            ESP_LOGI(TAG, "Restart network formation (status: %d)", err_status);
-            esp_zb_scheduler_alarm((esp_zb_callback_t)bdb_start_top_level_commissioning_cb, ESP_ZB_BDB_MODE_NETWORK_FORMATION, 1000);
-        }
-        break;
-    case ESP_ZB_BDB_SIGNAL_STEERING:
-        if (err_status == ESP_OK) {
-            ESP_LOGI(TAG, "Network steering started");
-        }
-        break;
-    case ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE:
-        dev_annce_params = (esp_zb_zdo_signal_device_annce_params_t *)esp_zb_app_signal_get_params(p_sg_p);
-        ESP_LOGI(TAG, "New device commissioned or rejoined (short: 0x%04hx)", dev_annce_params->device_short_addr);
-        esp_zb_zdo_match_desc_req_param_t  cmd_req;
-        cmd_req.dst_nwk_addr = dev_annce_params->device_short_addr;
-        cmd_req.addr_of_interest = dev_annce_params->device_short_addr;
-        esp_zb_zdo_find_on_off_light(&cmd_req, user_find_cb, NULL);
-        break;
-    default:
-        ESP_LOGI(TAG, "ZDO signal: %d, status: %d", sig_type, err_status);
-        break;
+    esp_zb_app_signal_type_t sig_type = *signal_struct->p_app_signal;
+    /* the signals are handled by their subscribers, refer to esp_zb_signal_subscriptions_init() */
+    if (!esp_zb_signal_dispatch(signal_struct)) {
+        ESP_LOGI(TAG, "ZDO signal: %d, status: %d", sig_type, signal_struct->esp_err_status);
     }
 }
 
@@ -135,13 +161,14 @@ static void esp_zb_task(void *pvParameters)
     /* initialize Zigbee stack with Zigbee coordinator config */
     esp_zb_cfg_t zb_nwk_cfg = ESP_ZB_ZC_CONFIG();
     esp_zb_init(&zb_nwk_cfg);
+    esp_zb_signal_subscriptions_init();
     /* set the on-off switch device config */
     esp_zb_on_off_switch_cfg_t switch_cfg = ESP_ZB_DEFAULT_ON_OFF_SWITCH_CONFIG();
     esp_zb_ep_list_t *esp_zb_on_off_switch_ep = esp_zb_on_off_switch_ep_create(HA_ONOFF_SWITCH_ENDPOINT, &switch_cfg);
     esp_zb_device_register(esp_zb_on_off_switch_ep);
     esp_zb_set_primary_network_channel_set(ESP_ZB_PRIMARY_CHANNEL_MASK);
     ESP_ERROR_CHECK(esp_zb_start(false));
-    esp_zb_main_loop_iteration();
+    esp_zb_submit_main_loop_iteration();
 }
 
 void app_main(void)
@@ -153,6 +180,7 @@ void app_main(void)
     ESP_ERROR_CHECK(nvs_flash_init());
     /* load Zigbee switch platform config to initialization */
     ESP_ERROR_CHECK(esp_zb_platform_config(&config));
+    ESP_ERROR_CHECK(esp_zb_submit_init(8));
     /* hardware related and device init */
     switch_driver_init(button_func_pair, PAIR_SIZE(button_func_pair), esp_zb_buttons_handler);
     xTaskCreate(esp_zb_task, "Zigbee_main", 4096, NULL, 5, NULL);
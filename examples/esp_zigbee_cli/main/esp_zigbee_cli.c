@@ -12,14 +12,22 @@
  * CONDITIONS OF ANY KIND, either express or implied.
  */
 
+#include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 #include "esp_log.h"
+#include "esp_console.h"
+#include "linenoise/linenoise.h"
 #include "ha/esp_zigbee_ha_standard.h"
+#include "esp_zigbee_link_stats.h"
+#include "esp_zigbee_mem.h"
+#include "esp_zigbee_profiler.h"
+#include "esp_zigbee_submit.h"
 #include "esp_zigbee_cli_config.h"
 
 #if CONFIG_ZB_ZCZR
@@ -65,6 +73,9 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
     esp_zb_nwk_device_type_t  role      = esp_zb_get_network_device_role();
     esp_zb_zdo_signal_device_annce_params_t *dev_annce_params = NULL;
     esp_zb_zdo_signal_leave_indication_params_t *leave_ind_params = NULL;
+    esp_zb_link_stats_cfg_t link_stats_cfg = {0};
+    int64_t start = esp_zb_profiler_begin();
+    esp_zb_link_stats_signal_handle(signal_struct);
     switch (sig_type) {
     case ESP_ZB_ZDO_SIGNAL_LEAVE:
         /* The ESP Zigbee CLI Agent will not attempt to rejoin the network after it receives the LEAVE command. */
@@ -75,6 +86,7 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
         }
         break;
     case ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP:
+        esp_zb_link_stats_start(&link_stats_cfg);
         esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_INITIALIZATION);
         break;
     case ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START:
@@ -123,6 +135,133 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
         ESP_LOGI(TAG, "ZDO signal: %d, status: %d", sig_type, err_status);
         break;
     }
+    esp_zb_profiler_end(ESP_ZB_PROFILER_TYPE_SIGNAL, sig_type, start);
+}
+
+static int zb_cli_profiler_cmd(int argc, char **argv)
+{
+    esp_zb_profiler_cfg_t cfg = {0};
+
+    if (argc >= 2 && !strcmp(argv[1], "start")) {
+        cfg.stall_threshold = argc >= 3 ? strtoul(argv[2], NULL, 0) : 0;
+        return esp_zb_profiler_start(&cfg) == ESP_OK ? 0 : 1;
+    } else if (argc >= 2 && !strcmp(argv[1], "stop")) {
+        return esp_zb_profiler_stop() == ESP_OK ? 0 : 1;
+    } else if (argc >= 2 && !strcmp(argv[1], "reset")) {
+        return esp_zb_profiler_reset() == ESP_OK ? 0 : 1;
+    } else if (argc >= 2 && !strcmp(argv[1], "dump")) {
+        esp_zb_profiler_dump();
+        return 0;
+    }
+    printf("Usage: profiler <start [stall_us]|stop|reset|dump>\n");
+    return 1;
+}
+
+static void zb_cli_profiler_register(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "profiler",
+        .help = "Profile the main loop: start [stall_us], stop, reset or dump",
+        .func = &zb_cli_profiler_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+typedef enum {
+    ZB_CLI_LINKSTATS_START,
+    ZB_CLI_LINKSTATS_STOP,
+    ZB_CLI_LINKSTATS_DUMP,
+    ZB_CLI_LINKSTATS_GET,
+} zb_cli_linkstats_op_t;
+
+typedef struct zb_cli_linkstats_req_s {
+    zb_cli_linkstats_op_t op;
+    uint32_t value;                                 /* the window period to start with, or the address to get */
+} zb_cli_linkstats_req_t;
+
+/* the link statistics belong to the Zigbee task, the console submits the command to it */
+static void zb_cli_linkstats_submit_cb(void *data)
+{
+    zb_cli_linkstats_req_t *req = (zb_cli_linkstats_req_t *)data;
+    esp_zb_link_stats_cfg_t cfg = {.window_period = req->value};
+    esp_zb_link_stats_node_t node;
+
+    switch (req->op) {
+    case ZB_CLI_LINKSTATS_START:
+        esp_zb_link_stats_start(&cfg);
+        break;
+    case ZB_CLI_LINKSTATS_STOP:
+        esp_zb_link_stats_stop();
+        break;
+    case ZB_CLI_LINKSTATS_DUMP:
+        esp_zb_link_stats_dump();
+        break;
+    case ZB_CLI_LINKSTATS_GET:
+        if (esp_zb_link_stats_get(req->value, &node) != ESP_OK) {
+            break;
+        }
+        printf("Node 0x%04hx, last seen %" PRIu32 " ms ago, latency p50 %u ms, p90 %u ms, max %u ms (%u samples)\n",
+               node.short_addr, node.last_seen, node.latency_p50, node.latency_p90, node.latency_max, node.latency_count);
+        for (uint8_t i = 0; i < ESP_ZB_LINK_STATS_WINDOW_NUM; i++) {
+            printf("  window %d: rx %u, lqi %u, rssi %d, tx %u, fail %u, retry %u, route fail %u\n", i,
+                   node.window[i].rx_count, node.window[i].lqi_avg, node.window[i].rssi_avg, node.window[i].tx_count,
+                   node.window[i].tx_fail_count, node.window[i].retry_count, node.window[i].route_fail_count);
+        }
+        break;
+    }
+}
+
+static int zb_cli_linkstats_cmd(int argc, char **argv)
+{
+    zb_cli_linkstats_req_t req = {0};
+
+    if (argc >= 2 && !strcmp(argv[1], "start")) {
+        req.op = ZB_CLI_LINKSTATS_START;
+        req.value = argc >= 3 ? strtoul(argv[2], NULL, 0) : 0;
+    } else if (argc >= 2 && !strcmp(argv[1], "stop")) {
+        req.op = ZB_CLI_LINKSTATS_STOP;
+    } else if (argc >= 2 && !strcmp(argv[1], "dump")) {
+        req.op = ZB_CLI_LINKSTATS_DUMP;
+    } else if (argc >= 3 && !strcmp(argv[1], "get")) {
+        req.op = ZB_CLI_LINKSTATS_GET;
+        req.value = strtoul(argv[2], NULL, 0);
+    } else {
+        printf("Usage: linkstats <start [window_ms]|stop|dump|get <short_addr>>\n");
+        return 1;
+    }
+    return esp_zb_submit(zb_cli_linkstats_submit_cb, &req, sizeof(req)) == ESP_OK ? 0 : 1;
+}
+
+static void zb_cli_linkstats_register(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "linkstats",
+        .help = "Per-node link statistics: start [window_ms], stop, dump or get <short_addr>",
+        .func = &zb_cli_linkstats_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+static int zb_cli_mem_cmd(int argc, char **argv)
+{
+    if (argc >= 2 && !strcmp(argv[1], "reset")) {
+        return esp_zb_mem_stats_reset() == ESP_OK ? 0 : 1;
+    } else if (argc == 1 || !strcmp(argv[1], "dump")) {
+        esp_zb_mem_stats_dump();
+        return 0;
+    }
+    printf("Usage: mem <dump|reset>\n");
+    return 1;
+}
+
+static void zb_cli_mem_register(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "mem",
+        .help = "Heap usage of the Zigbee subsystems: dump, or reset the peaks",
+        .func = &zb_cli_mem_cmd,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
 }
 
 void zigbee_stack_init(void)
@@ -145,9 +284,44 @@ void zb_main_loop_task(void *arg)
 {
     while (true) {
         if (zb_cli_is_stack_started()) {
+            esp_zb_submit_process();
+            int64_t start = esp_zb_profiler_begin();
             esp_zb_cli_main_loop_iteration();
+            esp_zb_profiler_end(ESP_ZB_PROFILER_TYPE_LOOP, 0, start);
+            /* the iteration is not known to block: wait for a console command, or 10 ms for the radio and timer events */
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+        } else {
+            /* the stack is started by a console command, nothing runs before */
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+}
+
+void zb_cli_console_loop_task(void *arg)
+{
+    const char *prompt = LOG_COLOR_I "> " LOG_RESET_COLOR;
+    TaskHandle_t zb_main_loop_task_handle = (TaskHandle_t)arg;
+    int ret = 0;
+
+    while (true) {
+        char *line = linenoise(prompt);
+        if (line == NULL) {
+            continue;
+        }
+        if (strlen(line) > 0) {
+            linenoiseHistoryAdd(line);
+        }
+        esp_err_t err = esp_console_run(line, &ret);
+        if (err == ESP_ERR_NOT_FOUND) {
+            printf("Unrecognized command\n");
+        } else if (err == ESP_OK && ret != ESP_OK) {
+            printf("Command returned non-zero error code: 0x%x (%s)\n", ret, esp_err_to_name(ret));
+        } else if (err != ESP_OK && err != ESP_ERR_INVALID_ARG) {
+            printf("Internal error: %s\n", esp_err_to_name(err));
         }
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+        linenoiseFree(line);
+        /* wake up the Zigbee task at once to run what the command queued */
+        xTaskNotifyGive(zb_main_loop_task_handle);
     }
 }
 
@@ -160,9 +334,14 @@ void app_main(void)
     ESP_ERROR_CHECK(nvs_flash_init());
     ESP_ERROR_CHECK(esp_zb_platform_config(&config));
 
+    ESP_ERROR_CHECK(esp_zb_submit_init(8));
     zb_cli_console_init();
+    zb_cli_profiler_register();
+    zb_cli_linkstats_register();
+    zb_cli_mem_register();
     zigbee_stack_init();
 
-    xTaskCreate(zb_cli_console_task, "zb_cli_console_task", 4096, NULL, 9, NULL);
-    xTaskCreate(zb_main_loop_task, "zb_main_loop_task", 4096, NULL, 10, NULL);
+    TaskHandle_t zb_main_loop_task_handle = NULL;
+    xTaskCreate(zb_main_loop_task, "zb_main_loop_task", 4096, NULL, 10, &zb_main_loop_task_handle);
+    xTaskCreate(zb_cli_console_loop_task, "zb_cli_console_task", 4096, zb_main_loop_task_handle, 9, NULL);
 }
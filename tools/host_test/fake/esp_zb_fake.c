@@ -0,0 +1,1617 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _GNU_SOURCE                     /* for the recursive mutex initializer */
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_random.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "mbedtls/aes.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "zboss_api.h"
+#include "zdo/esp_zigbee_zdo_command.h"
+#include "esp_zb_fake.h"
+
+#define ESP_ZB_FAKE_NVS_MAX_NUM         64
+#define ESP_ZB_FAKE_NVS_NAME_SIZE       16
+#define ESP_ZB_FAKE_NVS_VALUE_SIZE      4096    /* a page of 128 devices of the install code store */
+#define ESP_ZB_FAKE_BIND_REQ_MAX_NUM    64
+#define ESP_ZB_FAKE_REPORTING_MAX_NUM   8
+#define ESP_ZB_FAKE_KEY_MAX_NUM         64
+#define ESP_ZB_FAKE_AES_ROUND_NUM       10
+
+typedef struct esp_zb_fake_alarm_s {
+    bool in_use;
+    uint64_t due;                                   /* microsecond */
+    uint32_t order;                                 /* alarms due at the same time run in the order they were set */
+    esp_zb_callback_t cb;
+    zb_callback2_t cb2;
+    uint8_t param;
+    uint16_t cb_param;
+} esp_zb_fake_alarm_t;
+
+typedef struct esp_zb_fake_attr_s {
+    uint8_t endpoint;
+    uint16_t cluster_id;
+    uint8_t cluster_role;
+    uint8_t size;
+    esp_zb_zcl_attr_t attr;
+    uint8_t value[32];
+} esp_zb_fake_attr_t;
+
+typedef struct esp_zb_fake_nvs_s {
+    bool in_use;
+    char name_space[ESP_ZB_FAKE_NVS_NAME_SIZE];
+    char key[ESP_ZB_FAKE_NVS_NAME_SIZE];
+    size_t length;
+    uint8_t value[ESP_ZB_FAKE_NVS_VALUE_SIZE];
+} esp_zb_fake_nvs_t;
+
+typedef struct esp_zb_fake_buf_s {
+    bool in_use;
+    uint32_t length;
+    uint8_t data[ESP_ZB_FAKE_BUF_SIZE];
+} esp_zb_fake_buf_t;
+
+static struct {
+    uint64_t now;                                   /* microsecond */
+    uint32_t alarm_order;
+    esp_zb_fake_alarm_t alarm[ESP_ZB_FAKE_ALARM_MAX_NUM];
+    esp_zb_fake_attr_t attr[ESP_ZB_FAKE_ATTR_MAX_NUM];
+    uint16_t attr_num;
+    uint32_t attr_write_count;
+    zb_zcl_reporting_info_t reporting[ESP_ZB_FAKE_REPORTING_MAX_NUM];
+    uint8_t reporting_num;
+    uint32_t reporting_start_count;
+    zb_uint_t keepalive_timeout;
+    char nvs_namespace[ESP_ZB_FAKE_NVS_MAX_NUM][ESP_ZB_FAKE_NVS_NAME_SIZE];
+    esp_zb_fake_nvs_t nvs[ESP_ZB_FAKE_NVS_MAX_NUM];
+    uint32_t nvs_write_count;
+    esp_zb_fake_buf_t buf[ESP_ZB_FAKE_BUF_NUM];
+    bool buf_exhausted;
+    uint32_t random_state;
+    zb_device_handler_t af_hook;
+    zb_zcl_globals_t zcl_ctx;
+    uint32_t read_attr_count;
+    esp_zb_zcl_read_attr_cmd_t read_attr_last;
+    uint8_t read_attr_last_tsn;
+    struct {
+        const char *name;
+        uint32_t count;
+    } zcl_cmd[16];
+    uint32_t zdo_req_count;
+    esp_zb_fake_zdo_req_t zdo_req[ESP_ZB_FAKE_ZDO_REQ_MAX_NUM];
+    uint32_t aps_data_req_count;
+    zb_apsde_data_req_t aps_data_req_last;
+    uint8_t aps_payload[ESP_ZB_FAKE_APS_PAYLOAD_SIZE];
+    uint8_t aps_payload_len;
+    uint32_t stack_zdo_count;
+    zb_bufid_t stack_zdo_buf;
+    zb_callback_t stack_zdo_cb;
+    bool stack_zdo_fail;
+    zb_zdo_bind_req_param_t bind_req[ESP_ZB_FAKE_BIND_REQ_MAX_NUM];     /* by transaction sequence number */
+    bool bind_req_unbind[ESP_ZB_FAKE_BIND_REQ_MAX_NUM];
+    zb_zdo_mgmt_nwk_update_req_t nwk_update_req_last;
+    uint8_t channel;
+    uint16_t pan_id;
+    uint16_t short_addr;
+    uint32_t channel_mask;
+    uint32_t bdb_count;
+    uint8_t bdb_mode;
+    struct {
+        zb_ieee_addr_t ieee_addr;
+        zb_uint8_t key[16];
+    } key_table[ESP_ZB_FAKE_KEY_MAX_NUM];
+    uint16_t key_num;
+    uint16_t key_table_size;                        /* 0 for ESP_ZB_FAKE_KEY_MAX_NUM */
+    uint32_t concentrator_start_count;
+    uint8_t concentrator_radius;
+    uint32_t concentrator_disc_time;
+    bool concentrator_running;
+    uint32_t stack_call_count;
+    uint32_t zcl_send_count;
+    bool zcl_send_fail;
+    uint32_t long_poll_interval;
+    uint64_t sleep_timer;                           /* the timer wake-up in microsecond last enabled */
+    bool sleep_timer_enabled;
+    bool sleep_gpio_enabled;
+    uint64_t gpio_wakeup_mask;
+    uint32_t sleep_gpio_after;                      /* the time in millisecond a GPIO wakes the next sleep up after */
+    bool sleep_gpio_pending;
+    esp_sleep_source_t wakeup_cause;
+    esp_zb_attribute_list_t attr_list[ESP_ZB_FAKE_ATTR_MAX_NUM];
+    uint8_t attr_list_value[ESP_ZB_FAKE_ATTR_MAX_NUM][8];
+    uint8_t attr_list_num;
+} s_fake;
+
+static pthread_mutex_t s_fake_critical = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static pthread_mutex_t s_fake_notify_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_fake_notify_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t s_fake_notify_count;
+static __thread bool s_fake_in_isr;
+static __thread int s_fake_task;
+
+void esp_zb_fake_reset(void)
+{
+    memset(&s_fake, 0, sizeof(s_fake));
+    s_fake.now = 1000000;                           /* the boot takes a second, so a time is never 0 */
+    s_fake.random_state = 0x2545f491;
+    s_fake.channel = 11;
+    pthread_mutex_lock(&s_fake_notify_lock);
+    s_fake_notify_count = 0;
+    pthread_mutex_unlock(&s_fake_notify_lock);
+}
+
+/* clock and scheduler */
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)s_fake.now;
+}
+
+uint32_t esp_zb_fake_now(void)
+{
+    return (uint32_t)(s_fake.now / 1000);
+}
+
+static esp_zb_fake_alarm_t *esp_zb_fake_alarm_add(uint32_t time_ms)
+{
+    for (uint16_t i = 0; i < ESP_ZB_FAKE_ALARM_MAX_NUM; i++) {
+        if (!s_fake.alarm[i].in_use) {
+            memset(&s_fake.alarm[i], 0, sizeof(esp_zb_fake_alarm_t));
+            s_fake.alarm[i].in_use = true;
+            s_fake.alarm[i].due = s_fake.now + (uint64_t)time_ms * 1000;
+            s_fake.alarm[i].order = s_fake.alarm_order++;
+            return &s_fake.alarm[i];
+        }
+    }
+    fprintf(stderr, "fake: too many alarms\n");
+    abort();
+}
+
+void esp_zb_scheduler_alarm(esp_zb_callback_t cb, uint8_t param, uint32_t time)
+{
+    esp_zb_fake_alarm_t *alarm = esp_zb_fake_alarm_add(time);
+
+    alarm->cb = cb;
+    alarm->param = param;
+}
+
+void esp_zb_scheduler_alarm_cancel(esp_zb_callback_t cb, uint8_t param)
+{
+    for (uint16_t i = 0; i < ESP_ZB_FAKE_ALARM_MAX_NUM; i++) {
+        if (s_fake.alarm[i].in_use && s_fake.alarm[i].cb == cb && s_fake.alarm[i].param == param) {
+            s_fake.alarm[i].in_use = false;
+        }
+    }
+}
+
+static esp_zb_fake_alarm_t *esp_zb_fake_alarm_first(void)
+{
+    esp_zb_fake_alarm_t *first = NULL;
+
+    for (uint16_t i = 0; i < ESP_ZB_FAKE_ALARM_MAX_NUM; i++) {
+        esp_zb_fake_alarm_t *alarm = &s_fake.alarm[i];
+        if (alarm->in_use && (!first || alarm->due < first->due ||
+                              (alarm->due == first->due && alarm->order < first->order))) {
+            first = alarm;
+        }
+    }
+    return first;
+}
+
+static void esp_zb_fake_run_until(uint64_t until)
+{
+    esp_zb_fake_alarm_t *alarm = NULL;
+
+    while ((alarm = esp_zb_fake_alarm_first()) && alarm->due <= until) {
+        esp_zb_fake_alarm_t fired = *alarm;
+
+        alarm->in_use = false;
+        if (fired.due > s_fake.now) {
+            s_fake.now = fired.due;
+        }
+        if (fired.cb2) {
+            fired.cb2(fired.param, fired.cb_param);
+        } else {
+            fired.cb(fired.param);
+        }
+    }
+    if (until > s_fake.now) {
+        s_fake.now = until;
+    }
+}
+
+void esp_zb_fake_run(uint32_t time_ms)
+{
+    esp_zb_fake_run_until(s_fake.now + (uint64_t)time_ms * 1000);
+}
+
+void esp_zb_fake_run_pending(void)
+{
+    esp_zb_fake_run_until(s_fake.now);
+}
+
+/* an iteration of the stack runs the alarms due and never waits */
+void zboss_main_loop_iteration(void)
+{
+    esp_zb_fake_run_pending();
+}
+
+uint16_t esp_zb_fake_alarm_count(void)
+{
+    uint16_t count = 0;
+
+    for (uint16_t i = 0; i < ESP_ZB_FAKE_ALARM_MAX_NUM; i++) {
+        count += s_fake.alarm[i].in_use;
+    }
+    return count;
+}
+
+uint16_t esp_zb_fake_alarm_count_cb(esp_zb_callback_t cb)
+{
+    uint16_t count = 0;
+
+    for (uint16_t i = 0; i < ESP_ZB_FAKE_ALARM_MAX_NUM; i++) {
+        count += s_fake.alarm[i].in_use && s_fake.alarm[i].cb == cb;
+    }
+    return count;
+}
+
+uint32_t esp_zb_fake_alarm_next(void)
+{
+    esp_zb_fake_alarm_t *alarm = esp_zb_fake_alarm_first();
+
+    if (!alarm) {
+        return UINT32_MAX;
+    }
+    return alarm->due > s_fake.now ? (uint32_t)((alarm->due - s_fake.now + 999) / 1000) : 0;
+}
+
+/* random */
+
+void esp_zb_fake_random_seed(uint32_t seed)
+{
+    s_fake.random_state = seed ? seed : 1;
+}
+
+uint32_t esp_random(void)
+{
+    /* xorshift32, reproducible from the seed */
+    uint32_t x = s_fake.random_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_fake.random_state = x;
+    return x;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
+
+/* FreeRTOS */
+
+void esp_host_critical_enter(void)
+{
+    pthread_mutex_lock(&s_fake_critical);
+}
+
+void esp_host_critical_exit(void)
+{
+    pthread_mutex_unlock(&s_fake_critical);
+}
+
+bool esp_host_in_isr(void)
+{
+    return s_fake_in_isr;
+}
+
+void esp_zb_fake_isr_set(bool in_isr)
+{
+    s_fake_in_isr = in_isr;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &s_fake_task;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return esp_zb_fake_now();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    esp_zb_fake_run(ticks);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&s_fake_notify_lock);
+    s_fake_notify_count++;
+    pthread_cond_signal(&s_fake_notify_cond);
+    pthread_mutex_unlock(&s_fake_notify_lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken)
+{
+    xTaskNotifyGive(task);
+    if (higher_priority_task_woken) {
+        *higher_priority_task_woken = pdTRUE;
+    }
+}
+
+static void esp_zb_fake_deadline(struct timespec *deadline, TickType_t ticks_to_wait)
+{
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += ticks_to_wait / 1000;
+    deadline->tv_nsec += (long)(ticks_to_wait % 1000) * 1000000;
+    if (deadline->tv_nsec >= 1000000000) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+/* the Zigbee task is the only one waiting, the wait is in real time so producer threads can wake it up */
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    struct timespec deadline;
+    uint32_t count = 0;
+
+    esp_zb_fake_deadline(&deadline, ticks_to_wait);
+    pthread_mutex_lock(&s_fake_notify_lock);
+    while (!s_fake_notify_count && ticks_to_wait) {
+        if (pthread_cond_timedwait(&s_fake_notify_cond, &s_fake_notify_lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    count = s_fake_notify_count;
+    if (count) {
+        s_fake_notify_count = clear_on_exit ? 0 : count - 1;
+    }
+    pthread_mutex_unlock(&s_fake_notify_lock);
+    return count;
+}
+
+struct esp_host_semaphore_s {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool given;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    SemaphoreHandle_t semaphore = calloc(1, sizeof(*semaphore));
+
+    if (semaphore) {
+        pthread_mutex_init(&semaphore->lock, NULL);
+        pthread_cond_init(&semaphore->cond, NULL);
+    }
+    return semaphore;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    pthread_cond_destroy(&semaphore->cond);
+    pthread_mutex_destroy(&semaphore->lock);
+    free(semaphore);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    BaseType_t ret = pdFALSE;
+
+    pthread_mutex_lock(&semaphore->lock);
+    if (!semaphore->given) {
+        semaphore->given = true;
+        pthread_cond_signal(&semaphore->cond);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return ret;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken)
+{
+    if (higher_priority_task_woken) {
+        *higher_priority_task_woken = pdTRUE;
+    }
+    return xSemaphoreGive(semaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+    struct timespec deadline;
+    BaseType_t ret = pdFALSE;
+
+    esp_zb_fake_deadline(&deadline, ticks_to_wait);
+    pthread_mutex_lock(&semaphore->lock);
+    while (!semaphore->given && ticks_to_wait) {
+        if (pthread_cond_timedwait(&semaphore->cond, &semaphore->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (semaphore->given) {
+        semaphore->given = false;
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return ret;
+}
+
+uint32_t esp_zb_fake_notify_pending(void)
+{
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&s_fake_notify_lock);
+    count = s_fake_notify_count;
+    pthread_mutex_unlock(&s_fake_notify_lock);
+    return count;
+}
+
+/* attributes */
+
+esp_zb_zcl_attr_t *esp_zb_fake_attr_add(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role, uint16_t attr_id,
+                                        uint8_t type, uint8_t access, uint8_t size)
+{
+    esp_zb_fake_attr_t *attr = NULL;
+
+    if (s_fake.attr_num >= ESP_ZB_FAKE_ATTR_MAX_NUM || size > sizeof(attr->value)) {
+        abort();
+    }
+    attr = &s_fake.attr[s_fake.attr_num++];
+    attr->endpoint = endpoint;
+    attr->cluster_id = cluster_id;
+    attr->cluster_role = cluster_role;
+    attr->size = size;
+    attr->attr.id = attr_id;
+    attr->attr.type = type;
+    attr->attr.access = access;
+    attr->attr.data_p = attr->value;
+    return &attr->attr;
+}
+
+static esp_zb_fake_attr_t *esp_zb_fake_attr_find(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role,
+                                                 uint16_t attr_id)
+{
+    for (uint16_t i = 0; i < s_fake.attr_num; i++) {
+        esp_zb_fake_attr_t *attr = &s_fake.attr[i];
+        if (attr->endpoint == endpoint && attr->cluster_id == cluster_id && attr->cluster_role == cluster_role &&
+                attr->attr.id == attr_id) {
+            return attr;
+        }
+    }
+    return NULL;
+}
+
+esp_zb_zcl_attr_t *esp_zb_zcl_get_attribute(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role, uint16_t attr_id)
+{
+    esp_zb_fake_attr_t *attr = esp_zb_fake_attr_find(endpoint, cluster_id, cluster_role, attr_id);
+
+    return attr ? &attr->attr : NULL;
+}
+
+esp_zb_zcl_status_t esp_zb_zcl_set_attribute_val(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role,
+        uint16_t attr_id, void *value_p)
+{
+    esp_zb_fake_attr_t *attr = esp_zb_fake_attr_find(endpoint, cluster_id, cluster_role, attr_id);
+
+    if (!attr) {
+        return ESP_ZB_ZCL_STATUS_UNSUP_ATTRIB;
+    }
+    memcpy(attr->value, value_p, attr->size);
+    s_fake.attr_write_count++;
+    return ESP_ZB_ZCL_STATUS_SUCCESS;
+}
+
+uint32_t esp_zb_fake_attr_write_count(void)
+{
+    return s_fake.attr_write_count;
+}
+
+/* reporting */
+
+zb_zcl_reporting_info_t *esp_zb_fake_reporting_add(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role,
+                                                   uint16_t attr_id, uint16_t min_interval, uint16_t max_interval)
+{
+    zb_zcl_reporting_info_t *info = NULL;
+
+    if (s_fake.reporting_num >= ESP_ZB_FAKE_REPORTING_MAX_NUM) {
+        abort();
+    }
+    info = &s_fake.reporting[s_fake.reporting_num++];
+    info->ep = endpoint;
+    info->cluster_id = cluster_id;
+    info->cluster_role = cluster_role;
+    info->attr_id = attr_id;
+    info->u.send_info.min_interval = min_interval;
+    info->u.send_info.max_interval = max_interval;
+    return info;
+}
+
+zb_zcl_reporting_info_t *zb_zcl_find_reporting_info(zb_uint8_t ep, zb_uint16_t cluster_id, zb_uint8_t cluster_role,
+                                                    zb_uint16_t attr_id)
+{
+    for (uint8_t i = 0; i < s_fake.reporting_num; i++) {
+        zb_zcl_reporting_info_t *info = &s_fake.reporting[i];
+        if (info->ep == ep && info->cluster_id == cluster_id && info->cluster_role == cluster_role && info->attr_id == attr_id) {
+            return info;
+        }
+    }
+    return NULL;
+}
+
+zb_ret_t zb_zcl_put_reporting_info(zb_zcl_reporting_info_t *rep_info_ptr, zb_bool_t override)
+{
+    zb_zcl_reporting_info_t *info = zb_zcl_find_reporting_info(rep_info_ptr->ep, rep_info_ptr->cluster_id,
+                                                               rep_info_ptr->cluster_role, rep_info_ptr->attr_id);
+
+    if (!info) {
+        info = esp_zb_fake_reporting_add(rep_info_ptr->ep, rep_info_ptr->cluster_id, rep_info_ptr->cluster_role,
+                                         rep_info_ptr->attr_id, 0, 0);
+    } else if (!override) {
+        return RET_OK;
+    }
+    *info = *rep_info_ptr;
+    return RET_OK;
+}
+
+zb_ret_t zb_zcl_start_attr_reporting(zb_uint8_t ep, zb_uint16_t cluster_id, zb_uint8_t cluster_role, zb_uint16_t attr_id)
+{
+    if (!zb_zcl_find_reporting_info(ep, cluster_id, cluster_role, attr_id)) {
+        return -1;
+    }
+    s_fake.reporting_start_count++;
+    return RET_OK;
+}
+
+uint32_t esp_zb_fake_reporting_start_count(void)
+{
+    return s_fake.reporting_start_count;
+}
+
+void zb_set_keepalive_timeout(zb_uint_t to)
+{
+    s_fake.keepalive_timeout = to;
+}
+
+zb_uint_t esp_zb_fake_keepalive_timeout(void)
+{
+    return s_fake.keepalive_timeout;
+}
+
+/* NVS, the handle is the index of the namespace plus one */
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    int free_index = -1;
+
+    for (int i = 0; i < ESP_ZB_FAKE_NVS_MAX_NUM; i++) {
+        if (!strncmp(s_fake.nvs_namespace[i], name, ESP_ZB_FAKE_NVS_NAME_SIZE)) {
+            *out_handle = i + 1;
+            return ESP_OK;
+        }
+        if (!s_fake.nvs_namespace[i][0] && free_index < 0) {
+            free_index = i;
+        }
+    }
+    if (open_mode == NVS_READONLY || free_index < 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    strncpy(s_fake.nvs_namespace[free_index], name, ESP_ZB_FAKE_NVS_NAME_SIZE - 1);
+    *out_handle = free_index + 1;
+    return ESP_OK;
+}
+
+static esp_zb_fake_nvs_t *esp_zb_fake_nvs_find(nvs_handle_t handle, const char *key)
+{
+    for (int i = 0; i < ESP_ZB_FAKE_NVS_MAX_NUM; i++) {
+        esp_zb_fake_nvs_t *entry = &s_fake.nvs[i];
+        if (entry->in_use && !strcmp(entry->name_space, s_fake.nvs_namespace[handle - 1]) && !strcmp(entry->key, key)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    esp_zb_fake_nvs_t *entry = esp_zb_fake_nvs_find(handle, key);
+
+    if (length > ESP_ZB_FAKE_NVS_VALUE_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    for (int i = 0; !entry && i < ESP_ZB_FAKE_NVS_MAX_NUM; i++) {
+        if (!s_fake.nvs[i].in_use) {
+            entry = &s_fake.nvs[i];
+            entry->in_use = true;
+            strncpy(entry->name_space, s_fake.nvs_namespace[handle - 1], ESP_ZB_FAKE_NVS_NAME_SIZE - 1);
+            strncpy(entry->key, key, ESP_ZB_FAKE_NVS_NAME_SIZE - 1);
+        }
+    }
+    if (!entry) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(entry->value, value, length);
+    entry->length = length;
+    s_fake.nvs_write_count++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    esp_zb_fake_nvs_t *entry = esp_zb_fake_nvs_find(handle, key);
+
+    if (!entry) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value) {
+        if (*length < entry->length) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(out_value, entry->value, entry->length);
+    }
+    *length = entry->length;
+    return ESP_OK;
+}
+
+#define ESP_ZB_FAKE_NVS_INT(name, type)                                                     \
+    esp_err_t nvs_set_##name(nvs_handle_t handle, const char *key, type value)              \
+    {                                                                                       \
+        return nvs_set_blob(handle, key, &value, sizeof(type));                             \
+    }                                                                                       \
+    esp_err_t nvs_get_##name(nvs_handle_t handle, const char *key, type *out_value)         \
+    {                                                                                       \
+        size_t length = sizeof(type);                                                       \
+        return nvs_get_blob(handle, key, out_value, &length);                               \
+    }
+
+ESP_ZB_FAKE_NVS_INT(u8, uint8_t)
+ESP_ZB_FAKE_NVS_INT(u16, uint16_t)
+ESP_ZB_FAKE_NVS_INT(u32, uint32_t)
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    esp_zb_fake_nvs_t *entry = esp_zb_fake_nvs_find(handle, key);
+
+    if (!entry) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    entry->in_use = false;
+    s_fake.nvs_write_count++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle)
+{
+    for (int i = 0; i < ESP_ZB_FAKE_NVS_MAX_NUM; i++) {
+        if (s_fake.nvs[i].in_use && !strcmp(s_fake.nvs[i].name_space, s_fake.nvs_namespace[handle - 1])) {
+            s_fake.nvs[i].in_use = false;
+        }
+    }
+    s_fake.nvs_write_count++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+uint32_t esp_zb_fake_nvs_write_count(void)
+{
+    return s_fake.nvs_write_count;
+}
+
+/* buffers, the ids start at 1 as ZB_BUF_INVALID is 0 */
+
+static zb_bufid_t esp_zb_fake_buf_alloc(void)
+{
+    if (s_fake.buf_exhausted) {
+        return ZB_BUF_INVALID;
+    }
+    for (uint8_t i = 0; i < ESP_ZB_FAKE_BUF_NUM; i++) {
+        if (!s_fake.buf[i].in_use) {
+            memset(&s_fake.buf[i], 0, sizeof(esp_zb_fake_buf_t));
+            s_fake.buf[i].in_use = true;
+            return i + 1;
+        }
+    }
+    return ZB_BUF_INVALID;
+}
+
+static esp_zb_fake_buf_t *esp_zb_fake_buf_get(zb_bufid_t buf)
+{
+    if (buf == ZB_BUF_INVALID || buf > ESP_ZB_FAKE_BUF_NUM || !s_fake.buf[buf - 1].in_use) {
+        fprintf(stderr, "fake: invalid buffer %d\n", buf);
+        abort();
+    }
+    return &s_fake.buf[buf - 1];
+}
+
+zb_bufid_t zb_buf_get_out_func(TRACE_PROTO_VOID)
+{
+    return esp_zb_fake_buf_alloc();
+}
+
+zb_bufid_t zb_buf_get_in_func(TRACE_PROTO_VOID)
+{
+    return esp_zb_fake_buf_alloc();
+}
+
+zb_bufid_t zb_buf_get_func(TRACE_PROTO zb_bool_t is_in, zb_uint_t max_size)
+{
+    return esp_zb_fake_buf_alloc();
+}
+
+zb_bufid_t zb_buf_get_hipri_func(TRACE_PROTO zb_bool_t is_in)
+{
+    return esp_zb_fake_buf_alloc();
+}
+
+void zb_buf_free_func(TRACE_PROTO zb_bufid_t buf)
+{
+    esp_zb_fake_buf_get(buf)->in_use = false;
+}
+
+/* a delayed allocation is served from the scheduler, the input and output buffers come from the same pool */
+static zb_ret_t esp_zb_fake_buf_get_delayed(zb_callback_t callback, zb_callback2_t callback2, zb_uint16_t arg)
+{
+    zb_bufid_t buf = esp_zb_fake_buf_alloc();
+    esp_zb_fake_alarm_t *alarm = NULL;
+
+    if (buf == ZB_BUF_INVALID) {
+        return -1;
+    }
+    alarm = esp_zb_fake_alarm_add(0);
+    alarm->cb = callback;
+    alarm->cb2 = callback2;
+    alarm->param = buf;
+    alarm->cb_param = arg;
+    return RET_OK;
+}
+
+zb_ret_t zb_buf_get_out_delayed_func(TRACE_PROTO zb_callback_t callback)
+{
+    return esp_zb_fake_buf_get_delayed(callback, NULL, 0);
+}
+
+zb_ret_t zb_buf_get_in_delayed_func(TRACE_PROTO zb_callback_t callback)
+{
+    return esp_zb_fake_buf_get_delayed(callback, NULL, 0);
+}
+
+zb_ret_t zb_buf_get_out_delayed_ext_func(TRACE_PROTO zb_callback2_t callback, zb_uint16_t arg, zb_uint_t max_size)
+{
+    return esp_zb_fake_buf_get_delayed(NULL, callback, arg);
+}
+
+zb_ret_t zb_buf_get_in_delayed_ext_func(TRACE_PROTO zb_callback2_t callback, zb_uint16_t arg, zb_uint_t max_size)
+{
+    return esp_zb_fake_buf_get_delayed(NULL, callback, arg);
+}
+
+void *zb_buf_begin(zb_bufid_t buf)
+{
+    return esp_zb_fake_buf_get(buf)->data;
+}
+
+zb_uint32_t zb_buf_len(zb_bufid_t buf)
+{
+    return esp_zb_fake_buf_get(buf)->length;
+}
+
+void *zb_buf_initial_alloc(zb_bufid_t buf, zb_uint32_t size)
+{
+    esp_zb_fake_buf_t *fake_buf = esp_zb_fake_buf_get(buf);
+
+    fake_buf->length = size;
+    return fake_buf->data;
+}
+
+void *zb_buf_get_tail_func(zb_bufid_t buf, zb_uint32_t size)
+{
+    return esp_zb_fake_buf_get(buf)->data + ESP_ZB_FAKE_BUF_SIZE - size;
+}
+
+uint8_t esp_zb_fake_buf_in_use(void)
+{
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < ESP_ZB_FAKE_BUF_NUM; i++) {
+        count += s_fake.buf[i].in_use;
+    }
+    return count;
+}
+
+void esp_zb_fake_buf_exhaust(bool exhausted)
+{
+    s_fake.buf_exhausted = exhausted;
+}
+
+/* APS and ZCL */
+
+void zb_af_set_data_indication(zb_device_handler_t cb)
+{
+    s_fake.af_hook = cb;
+}
+
+bool esp_zb_fake_af_hook_set(void)
+{
+    return s_fake.af_hook != NULL;
+}
+
+bool esp_zb_fake_af_indication(const zb_apsde_data_indication_t *ind, const uint8_t *payload, uint8_t len)
+{
+    zb_bufid_t buf = esp_zb_fake_buf_alloc();
+    bool consumed = false;
+
+    if (buf == ZB_BUF_INVALID) {
+        fprintf(stderr, "fake: no buffer for the indication\n");
+        abort();
+    }
+    memcpy(zb_buf_initial_alloc(buf, len), payload, len);
+    *ZB_BUF_GET_PARAM(buf, zb_apsde_data_indication_t) = *ind;
+    consumed = s_fake.af_hook && s_fake.af_hook(buf);
+    if (!consumed) {
+        zb_buf_free(buf);
+    }
+    return consumed;
+}
+
+/* the stack sends the frame and releases the buffer once it is confirmed */
+void zb_apsde_data_request(zb_uint8_t param)
+{
+    esp_zb_fake_buf_t *buf = esp_zb_fake_buf_get(param);
+
+    s_fake.aps_data_req_count++;
+    s_fake.aps_data_req_last = *ZB_BUF_GET_PARAM(param, zb_apsde_data_req_t);
+    s_fake.aps_payload_len = buf->length < ESP_ZB_FAKE_APS_PAYLOAD_SIZE ? buf->length : ESP_ZB_FAKE_APS_PAYLOAD_SIZE;
+    memcpy(s_fake.aps_payload, buf->data, s_fake.aps_payload_len);
+    zb_buf_free(param);
+}
+
+uint32_t esp_zb_fake_aps_data_req_count(void)
+{
+    return s_fake.aps_data_req_count;
+}
+
+const zb_apsde_data_req_t *esp_zb_fake_aps_data_req_last(const uint8_t **payload, uint8_t *len)
+{
+    if (payload) {
+        *payload = s_fake.aps_payload;
+    }
+    if (len) {
+        *len = s_fake.aps_payload_len;
+    }
+    return &s_fake.aps_data_req_last;
+}
+
+zb_zcl_globals_t *zb_zcl_get_ctx(void)
+{
+    return &s_fake.zcl_ctx;
+}
+
+zb_uint8_t zb_zcl_get_seq(void)
+{
+    return s_fake.zcl_ctx.seq_number++;
+}
+
+/* the stack sends the frame and releases the buffer */
+void zb_zcl_send(zb_bufid_t buf, zb_uint16_t addr, zb_uint8_t addr_mode, zb_uint8_t dst_ep, zb_uint8_t ep,
+                 zb_uint16_t profile_id, zb_uint16_t cluster_id, zb_callback_t cb)
+{
+    zb_zcl_command_send_status_t *status = NULL;
+
+    s_fake.zcl_send_count++;
+    if (!cb) {
+        zb_buf_free(buf);
+        return;
+    }
+    /* the callback gets the buffer back with the status of the APS confirm and frees it */
+    status = ZB_BUF_GET_PARAM(buf, zb_zcl_command_send_status_t);
+    memset(status, 0, sizeof(zb_zcl_command_send_status_t));
+    status->status = s_fake.zcl_send_fail ? -1 : RET_OK;
+    status->dst_addr.addr_type = ZB_ZCL_ADDR_TYPE_SHORT;
+    status->dst_addr.u.short_addr = addr;
+    status->dst_endpoint = dst_ep;
+    status->src_endpoint = ep;
+    esp_zb_scheduler_alarm(cb, buf, 0);
+}
+
+void esp_zb_fake_zcl_send_fail(bool fail)
+{
+    s_fake.zcl_send_fail = fail;
+}
+
+uint32_t esp_zb_fake_zcl_send_count(void)
+{
+    return s_fake.zcl_send_count;
+}
+
+/* the attribute lists of the clusters, held by a pool reset with the fake */
+static esp_zb_attribute_list_t *esp_zb_fake_attr_list_node(uint16_t cluster_id)
+{
+    esp_zb_attribute_list_t *node = NULL;
+
+    if (s_fake.attr_list_num >= ESP_ZB_FAKE_ATTR_MAX_NUM) {
+        abort();
+    }
+    node = &s_fake.attr_list[s_fake.attr_list_num++];
+    node->cluster_id = cluster_id;
+    return node;
+}
+
+esp_zb_attribute_list_t *esp_zb_zcl_attr_list_create(uint16_t cluster_id)
+{
+    return esp_zb_fake_attr_list_node(cluster_id);
+}
+
+esp_err_t esp_zb_custom_cluster_add_custom_attr(esp_zb_attribute_list_t *attr_list, uint16_t attr_id, uint8_t attr_type,
+                                                uint8_t attr_access, void *value_p)
+{
+    esp_zb_attribute_list_t *node = esp_zb_fake_attr_list_node(attr_list->cluster_id);
+    uint8_t *value = s_fake.attr_list_value[node - s_fake.attr_list];
+    uint8_t size = zb_zcl_get_attribute_size(attr_type, value_p);
+
+    if (!size || size > sizeof(s_fake.attr_list_value[0])) {
+        abort();
+    }
+    memcpy(value, value_p, size);
+    node->attribute.id = attr_id;
+    node->attribute.type = attr_type;
+    node->attribute.access = attr_access;
+    node->attribute.data_p = value;
+    while (attr_list->next) {
+        attr_list = attr_list->next;
+    }
+    attr_list->next = node;
+    return ESP_OK;
+}
+
+void zb_zdo_pim_set_long_poll_interval(zb_uint32_t ms)
+{
+    s_fake.long_poll_interval = ms;
+}
+
+uint32_t esp_zb_fake_long_poll_interval(void)
+{
+    return s_fake.long_poll_interval;
+}
+
+zb_uint8_t zb_zcl_get_attribute_size(zb_uint8_t attr_type, zb_uint8_t *attr_value)
+{
+    switch (attr_type) {
+    case 0x08: case 0x10: case 0x18: case 0x20: case 0x28: case 0x30:
+        return 1;
+    case 0x09: case 0x19: case 0x21: case 0x29: case 0x31: case 0xe8: case 0xe9:
+        return 2;
+    case 0x0b: case 0x1b: case 0x23: case 0x2b: case 0x39: case 0xe0: case 0xe1: case 0xe2:
+        return 4;
+    case 0xf0:
+        return 8;
+    case 0x41: case 0x42:
+        return attr_value[0] == 0xff ? 1 : attr_value[0] + 1;
+    default:
+        return 0;
+    }
+}
+
+void esp_zb_zcl_read_attr_cmd_req(esp_zb_zcl_read_attr_cmd_t *cmd_req)
+{
+    s_fake.read_attr_last = *cmd_req;
+    s_fake.read_attr_last_tsn = zb_zcl_get_seq();
+    s_fake.read_attr_count++;
+}
+
+uint32_t esp_zb_fake_read_attr_count(void)
+{
+    return s_fake.read_attr_count;
+}
+
+const esp_zb_zcl_read_attr_cmd_t *esp_zb_fake_read_attr_last(uint8_t *tsn)
+{
+    if (tsn) {
+        *tsn = s_fake.read_attr_last_tsn;
+    }
+    return &s_fake.read_attr_last;
+}
+
+uint8_t esp_zb_fake_read_attr_resp_build(uint8_t *frame, uint8_t tsn, uint16_t attr_id, uint8_t attr_type,
+                                        const void *value, uint8_t size)
+{
+    frame[0] = 0x18;                                /* profile wide, server to client, no default response */
+    frame[1] = tsn;
+    frame[2] = 0x01;                                /* read attributes response */
+    frame[3] = attr_id & 0xff;
+    frame[4] = attr_id >> 8;
+    frame[5] = 0x00;
+    frame[6] = attr_type;
+    memcpy(&frame[7], value, size);
+    return 7 + size;
+}
+
+static void esp_zb_fake_zcl_cmd_add(const char *name)
+{
+    for (uint8_t i = 0; i < sizeof(s_fake.zcl_cmd) / sizeof(s_fake.zcl_cmd[0]); i++) {
+        if (!s_fake.zcl_cmd[i].name || !strcmp(s_fake.zcl_cmd[i].name, name)) {
+            s_fake.zcl_cmd[i].name = name;
+            s_fake.zcl_cmd[i].count++;
+            return;
+        }
+    }
+    abort();
+}
+
+uint32_t esp_zb_fake_zcl_cmd_count(const char *name)
+{
+    for (uint8_t i = 0; i < sizeof(s_fake.zcl_cmd) / sizeof(s_fake.zcl_cmd[0]) && s_fake.zcl_cmd[i].name; i++) {
+        if (!strcmp(s_fake.zcl_cmd[i].name, name)) {
+            return s_fake.zcl_cmd[i].count;
+        }
+    }
+    return 0;
+}
+
+void esp_zb_zcl_ias_zone_enroll_cmd_req(esp_zb_zcl_ias_zone_enroll_request_cmd_t *cmd_req)
+{
+    esp_zb_fake_zcl_cmd_add("ias_zone_enroll");
+}
+
+void esp_zb_zcl_ias_zone_status_change_notif_cmd_req(esp_zb_zcl_ias_zone_status_change_notif_cmd_t *cmd_req)
+{
+    esp_zb_fake_zcl_cmd_add("ias_zone_status_change_notif");
+}
+
+/* ZDO */
+
+static void esp_zb_fake_zdo_req_add(uint16_t cluster_id, uint16_t dst_addr, uint8_t endpoint, void *cb, void *user_ctx)
+{
+    esp_zb_fake_zdo_req_t *req = NULL;
+
+    if (s_fake.zdo_req_count >= ESP_ZB_FAKE_ZDO_REQ_MAX_NUM) {
+        fprintf(stderr, "fake: too many ZDO requests\n");
+        abort();
+    }
+    req = &s_fake.zdo_req[s_fake.zdo_req_count++];
+    req->cluster_id = cluster_id;
+    req->dst_addr = dst_addr;
+    req->endpoint = endpoint;
+    req->cb = cb;
+    req->user_ctx = user_ctx;
+}
+
+uint32_t esp_zb_fake_zdo_req_count(void)
+{
+    return s_fake.zdo_req_count;
+}
+
+const esp_zb_fake_zdo_req_t *esp_zb_fake_zdo_req_get(uint32_t index)
+{
+    return index < s_fake.zdo_req_count ? &s_fake.zdo_req[index] : NULL;
+}
+
+static void esp_zb_fake_mgmt_req_add(uint16_t cluster_id, uint16_t dst_addr, uint8_t start_index, void *cb, void *user_ctx)
+{
+    esp_zb_fake_zdo_req_add(cluster_id, dst_addr, 0, cb, user_ctx);
+    s_fake.zdo_req[s_fake.zdo_req_count - 1].start_index = start_index;
+}
+
+/* weak, so a test of the ZDO management source sends them through the stack instead */
+__attribute__((weak)) esp_err_t esp_zb_zdo_mgmt_lqi_req(esp_zb_zdo_mgmt_lqi_req_param_t *cmd_req, esp_zb_zdo_mgmt_lqi_callback_t user_cb,
+                                                        void *user_ctx)
+{
+    esp_zb_fake_mgmt_req_add(0x0031, cmd_req->dst_nwk_addr, cmd_req->start_index, (void *)user_cb, user_ctx);
+    return ESP_OK;
+}
+
+__attribute__((weak)) esp_err_t esp_zb_zdo_mgmt_rtg_req(esp_zb_zdo_mgmt_rtg_req_param_t *cmd_req, esp_zb_zdo_mgmt_rtg_callback_t user_cb,
+                                                        void *user_ctx)
+{
+    esp_zb_fake_mgmt_req_add(0x0032, cmd_req->dst_nwk_addr, cmd_req->start_index, (void *)user_cb, user_ctx);
+    return ESP_OK;
+}
+
+/* the ZDO requests of the stack take the buffer on success, the response is given by the test to the callback */
+static zb_uint8_t esp_zb_fake_stack_zdo_req(zb_uint8_t param, zb_callback_t cb)
+{
+    esp_zb_fake_buf_get(param);
+    if (s_fake.stack_zdo_fail) {
+        return ZB_ZDO_INVALID_TSN;
+    }
+    s_fake.stack_zdo_count++;
+    s_fake.stack_zdo_buf = param;
+    s_fake.stack_zdo_cb = cb;
+    zb_buf_free(param);
+    return (zb_uint8_t)s_fake.stack_zdo_count;
+}
+
+zb_uint8_t zb_zdo_mgmt_lqi_req(zb_uint8_t param, zb_callback_t cb)
+{
+    return esp_zb_fake_stack_zdo_req(param, cb);
+}
+
+zb_uint8_t zb_zdo_match_desc_req(zb_uint8_t param, zb_callback_t cb)
+{
+    return esp_zb_fake_stack_zdo_req(param, cb);
+}
+
+static zb_uint8_t esp_zb_fake_stack_bind_req(zb_uint8_t param, zb_callback_t cb, bool unbind)
+{
+    zb_zdo_bind_req_param_t req = *ZB_BUF_GET_PARAM(param, zb_zdo_bind_req_param_t);
+    zb_uint8_t tsn = esp_zb_fake_stack_zdo_req(param, cb);
+
+    if (tsn != ZB_ZDO_INVALID_TSN && tsn < ESP_ZB_FAKE_BIND_REQ_MAX_NUM) {
+        s_fake.bind_req[tsn] = req;
+        s_fake.bind_req_unbind[tsn] = unbind;
+    }
+    return tsn;
+}
+
+zb_uint8_t zb_zdo_bind_req(zb_uint8_t param, zb_callback_t cb)
+{
+    return esp_zb_fake_stack_bind_req(param, cb, false);
+}
+
+zb_uint8_t zb_zdo_unbind_req(zb_uint8_t param, zb_callback_t cb)
+{
+    return esp_zb_fake_stack_bind_req(param, cb, true);
+}
+
+const zb_zdo_bind_req_param_t *esp_zb_fake_bind_req_get(uint8_t tsn, bool *unbind)
+{
+    if (tsn == 0 || tsn >= ESP_ZB_FAKE_BIND_REQ_MAX_NUM || tsn > s_fake.stack_zdo_count) {
+        return NULL;
+    }
+    if (unbind) {
+        *unbind = s_fake.bind_req_unbind[tsn];
+    }
+    return &s_fake.bind_req[tsn];
+}
+
+zb_uint8_t zb_zdo_mgmt_bind_req(zb_uint8_t param, zb_callback_t cb)
+{
+    return esp_zb_fake_stack_zdo_req(param, cb);
+}
+
+zb_uint8_t zb_zdo_mgmt_nwk_update_req(zb_uint8_t param, zb_callback_t cb)
+{
+    s_fake.nwk_update_req_last = *ZB_BUF_GET_PARAM(param, zb_zdo_mgmt_nwk_update_req_t);
+    return esp_zb_fake_stack_zdo_req(param, cb);
+}
+
+const zb_zdo_mgmt_nwk_update_req_t *esp_zb_fake_nwk_update_req_last(void)
+{
+    return &s_fake.nwk_update_req_last;
+}
+
+uint32_t esp_zb_fake_stack_zdo_count(void)
+{
+    return s_fake.stack_zdo_count;
+}
+
+zb_callback_t esp_zb_fake_stack_zdo_last(zb_bufid_t *buf)
+{
+    if (buf) {
+        *buf = s_fake.stack_zdo_buf;
+    }
+    return s_fake.stack_zdo_cb;
+}
+
+void esp_zb_fake_stack_zdo_fail(bool fail)
+{
+    s_fake.stack_zdo_fail = fail;
+}
+
+void esp_zb_zdo_node_desc_req(esp_zb_zdo_node_desc_req_param_t *cmd_req, esp_zb_zdo_node_desc_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_fake_zdo_req_add(0x0002, cmd_req->dst_nwk_addr, 0, (void *)user_cb, user_ctx);
+}
+
+void esp_zb_zdo_simple_desc_req(esp_zb_zdo_simple_desc_req_param_t *cmd_req, esp_zb_zdo_simple_desc_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_fake_zdo_req_add(0x0004, cmd_req->addr_of_interest, cmd_req->endpoint, (void *)user_cb, user_ctx);
+}
+
+void esp_zb_zdo_active_ep_req(esp_zb_zdo_active_ep_req_param_t *cmd_req, esp_zb_zdo_active_ep_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_fake_zdo_req_add(0x0005, cmd_req->addr_of_interest, 0, (void *)user_cb, user_ctx);
+}
+
+void esp_zb_zdo_device_leave_req(esp_zb_zdo_mgmt_leave_req_param_t *cmd_req, esp_zb_zdo_leave_callback_t user_cb, void *user_ctx)
+{
+    esp_zb_fake_zdo_req_add(0x0034, cmd_req->dst_nwk_addr, 0, (void *)user_cb, user_ctx);
+}
+
+void esp_zb_zdo_permit_joining_req(esp_zb_zdo_permit_joining_req_param_t *cmd_req, esp_zb_zdo_permit_join_callback_t user_cb,
+                                   void *user_ctx)
+{
+    /* the duration is kept as the start index */
+    esp_zb_fake_mgmt_req_add(0x0036, cmd_req->dst_nwk_addr, cmd_req->permit_duration, (void *)user_cb, user_ctx);
+}
+
+uint8_t esp_zb_get_current_channel(void)
+{
+    return s_fake.channel;
+}
+
+void esp_zb_fake_channel_set(uint8_t channel)
+{
+    s_fake.channel = channel;
+}
+
+/* network and commissioning, the extended PAN ID is derived from the PAN ID */
+
+uint16_t esp_zb_get_pan_id(void)
+{
+    return s_fake.pan_id;
+}
+
+uint16_t esp_zb_get_short_address(void)
+{
+    return s_fake.short_addr;
+}
+
+void esp_zb_get_extended_pan_id(esp_zb_ieee_addr_t ext_pan_id)
+{
+    memset(ext_pan_id, 0, sizeof(esp_zb_ieee_addr_t));
+    ext_pan_id[0] = s_fake.pan_id & 0xff;
+    ext_pan_id[1] = s_fake.pan_id >> 8;
+}
+
+void esp_zb_fake_network_set(uint8_t channel, uint16_t pan_id, uint16_t short_addr)
+{
+    s_fake.channel = channel;
+    s_fake.pan_id = pan_id;
+    s_fake.short_addr = short_addr;
+}
+
+esp_err_t esp_zb_set_primary_network_channel_set(uint32_t channel_mask)
+{
+    s_fake.channel_mask = channel_mask;
+    return ESP_OK;
+}
+
+uint32_t esp_zb_fake_channel_mask(void)
+{
+    return s_fake.channel_mask;
+}
+
+esp_err_t esp_zb_bdb_start_top_level_commissioning(uint8_t mode_mask)
+{
+    s_fake.bdb_count++;
+    s_fake.bdb_mode = mode_mask;
+    return ESP_OK;
+}
+
+uint32_t esp_zb_fake_bdb_count(uint8_t *mode_mask)
+{
+    if (mode_mask) {
+        *mode_mask = s_fake.bdb_mode;
+    }
+    return s_fake.bdb_count;
+}
+
+/* concentrator mode, each start sends a many-to-one route request */
+
+void zb_start_concentrator_mode(zb_uint8_t radius, zb_uint32_t disc_time)
+{
+    s_fake.concentrator_start_count++;
+    s_fake.concentrator_radius = radius;
+    s_fake.concentrator_disc_time = disc_time;
+    s_fake.concentrator_running = true;
+}
+
+void zb_stop_concentrator_mode(void)
+{
+    s_fake.concentrator_running = false;
+}
+
+uint32_t esp_zb_fake_concentrator_start_count(uint8_t *radius, uint32_t *disc_time, bool *running)
+{
+    if (radius) {
+        *radius = s_fake.concentrator_radius;
+    }
+    if (disc_time) {
+        *disc_time = s_fake.concentrator_disc_time;
+    }
+    if (running) {
+        *running = s_fake.concentrator_running;
+    }
+    return s_fake.concentrator_start_count;
+}
+
+/* security, the key table of the Trust Center holds a key per device */
+
+zb_ret_t zb_secur_update_key_pair(zb_ieee_addr_t address, zb_uint8_t *key, zb_uint8_t key_type, zb_uint8_t key_attr,
+                                  zb_uint8_t key_source)
+{
+    uint16_t size = s_fake.key_table_size ? s_fake.key_table_size : ESP_ZB_FAKE_KEY_MAX_NUM;
+    uint16_t i = 0;
+
+    while (i < s_fake.key_num && memcmp(s_fake.key_table[i].ieee_addr, address, sizeof(zb_ieee_addr_t))) {
+        i++;
+    }
+    if (i == s_fake.key_num) {
+        if (s_fake.key_num == size) {
+            return RET_NO_MEMORY;
+        }
+        memcpy(s_fake.key_table[s_fake.key_num++].ieee_addr, address, sizeof(zb_ieee_addr_t));
+    }
+    memcpy(s_fake.key_table[i].key, key, sizeof(s_fake.key_table[i].key));
+    return RET_OK;
+}
+
+void esp_zb_fake_key_table_size(uint16_t size)
+{
+    s_fake.key_table_size = size;
+}
+
+uint16_t esp_zb_fake_key_count(void)
+{
+    return s_fake.key_num;
+}
+
+bool esp_zb_fake_key_get(const zb_ieee_addr_t ieee_addr, uint8_t *key)
+{
+    for (uint16_t i = 0; i < s_fake.key_num; i++) {
+        if (!memcmp(s_fake.key_table[i].ieee_addr, ieee_addr, sizeof(zb_ieee_addr_t))) {
+            memcpy(key, s_fake.key_table[i].key, sizeof(s_fake.key_table[i].key));
+            return true;
+        }
+    }
+    return false;
+}
+
+/* AES-128 encryption for the mbed TLS stand-in, the S-box is built from the multiplicative inverses in GF(2^8) */
+
+static uint8_t s_aes_sbox[256];
+
+static uint8_t esp_zb_fake_aes_xtime(uint8_t x)
+{
+    return (x << 1) ^ ((x & 0x80) ? 0x1b : 0x00);
+}
+
+static void esp_zb_fake_aes_sbox_init(void)
+{
+    uint8_t p = 1;
+    uint8_t q = 1;
+
+    do {
+        /* p runs over the group by multiplying by 3, q over the inverses by dividing by 3 */
+        p = p ^ esp_zb_fake_aes_xtime(p);
+        q ^= q << 1;
+        q ^= q << 2;
+        q ^= q << 4;
+        q ^= (q & 0x80) ? 0x09 : 0x00;
+        s_aes_sbox[p] = q ^ (uint8_t)((q << 1) | (q >> 7)) ^ (uint8_t)((q << 2) | (q >> 6)) ^
+                        (uint8_t)((q << 3) | (q >> 5)) ^ (uint8_t)((q << 4) | (q >> 4)) ^ 0x63;
+    } while (p != 1);
+    s_aes_sbox[0] = 0x63;
+}
+
+void mbedtls_aes_init(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    if (!s_aes_sbox[0]) {
+        esp_zb_fake_aes_sbox_init();
+    }
+}
+
+void mbedtls_aes_free(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits)
+{
+    if (keybits != 128) {
+        return -1;
+    }
+    memcpy(ctx->key, key, 16);
+    ctx->keybits = keybits;
+    return 0;
+}
+
+int mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode, const unsigned char input[16], unsigned char output[16])
+{
+    uint8_t round_key[(ESP_ZB_FAKE_AES_ROUND_NUM + 1) * 16];
+    uint8_t state[16];
+    uint8_t rcon = 0x01;
+
+    if (mode != MBEDTLS_AES_ENCRYPT || ctx->keybits != 128) {
+        return -1;
+    }
+    memcpy(round_key, ctx->key, 16);
+    for (uint16_t i = 16; i < sizeof(round_key); i += 4) {
+        uint8_t word[4] = {round_key[i - 4], round_key[i - 3], round_key[i - 2], round_key[i - 1]};
+
+        if (i % 16 == 0) {
+            uint8_t first = word[0];
+
+            word[0] = s_aes_sbox[word[1]] ^ rcon;
+            word[1] = s_aes_sbox[word[2]];
+            word[2] = s_aes_sbox[word[3]];
+            word[3] = s_aes_sbox[first];
+            rcon = esp_zb_fake_aes_xtime(rcon);
+        }
+        for (uint8_t j = 0; j < 4; j++) {
+            round_key[i + j] = round_key[i - 16 + j] ^ word[j];
+        }
+    }
+    for (uint8_t i = 0; i < 16; i++) {
+        state[i] = input[i] ^ round_key[i];
+    }
+    for (uint8_t round = 1; round <= ESP_ZB_FAKE_AES_ROUND_NUM; round++) {
+        uint8_t shifted[16];
+
+        /* the state is stored column by column, row r is rotated left by r columns */
+        for (uint8_t i = 0; i < 16; i++) {
+            shifted[i] = s_aes_sbox[state[(i + 4 * (i % 4)) % 16]];
+        }
+        /* the last round does not mix the columns */
+        for (uint8_t column = 0; round < ESP_ZB_FAKE_AES_ROUND_NUM && column < 4; column++) {
+            uint8_t *a = &shifted[column * 4];
+            uint8_t all = a[0] ^ a[1] ^ a[2] ^ a[3];
+            uint8_t first = a[0];
+
+            a[0] ^= all ^ esp_zb_fake_aes_xtime(a[0] ^ a[1]);
+            a[1] ^= all ^ esp_zb_fake_aes_xtime(a[1] ^ a[2]);
+            a[2] ^= all ^ esp_zb_fake_aes_xtime(a[2] ^ a[3]);
+            a[3] ^= all ^ esp_zb_fake_aes_xtime(a[3] ^ first);
+        }
+        for (uint8_t i = 0; i < 16; i++) {
+            state[i] = shifted[i] ^ round_key[round * 16 + i];
+        }
+    }
+    memcpy(output, state, 16);
+    return 0;
+}
+
+/* the startup calls of the stack each take a millisecond */
+
+esp_err_t esp_zb_platform_config(esp_zb_platform_config_t *config)
+{
+    s_fake.now += 1000;
+    s_fake.stack_call_count++;
+    return ESP_OK;
+}
+
+void esp_zb_init(esp_zb_cfg_t *nwk_cfg)
+{
+    s_fake.now += 1000;
+    s_fake.stack_call_count++;
+}
+
+esp_err_t esp_zb_start(bool autostart)
+{
+    s_fake.now += 1000;
+    s_fake.stack_call_count++;
+    return ESP_OK;
+}
+
+uint32_t esp_zb_fake_stack_call_count(void)
+{
+    return s_fake.stack_call_count;
+}
+
+/* signals, the parameters follow the signal type */
+
+void *esp_zb_app_signal_get_params(uint32_t *signal_p)
+{
+    return signal_p + 1;
+}
+
+/* light sleep, the clock jumps over the sleep without running the alarms */
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us)
+{
+    s_fake.sleep_timer = time_in_us;
+    s_fake.sleep_timer_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void)
+{
+    s_fake.sleep_gpio_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source)
+{
+    if (source == ESP_SLEEP_WAKEUP_TIMER) {
+        s_fake.sleep_timer_enabled = false;
+    } else if (source == ESP_SLEEP_WAKEUP_GPIO) {
+        s_fake.sleep_gpio_enabled = false;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start(void)
+{
+    uint64_t slept = s_fake.sleep_timer;
+
+    /* the helpers always arm the timer, a sleep without it would never end */
+    if (!s_fake.sleep_timer_enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_fake.wakeup_cause = ESP_SLEEP_WAKEUP_TIMER;
+    if (s_fake.sleep_gpio_pending && s_fake.sleep_gpio_enabled && s_fake.gpio_wakeup_mask &&
+            (uint64_t)s_fake.sleep_gpio_after * 1000 < slept) {
+        slept = (uint64_t)s_fake.sleep_gpio_after * 1000;
+        s_fake.wakeup_cause = ESP_SLEEP_WAKEUP_GPIO;
+    }
+    s_fake.sleep_gpio_pending = false;
+    s_fake.now += slept;
+    return ESP_OK;
+}
+
+esp_sleep_source_t esp_sleep_get_wakeup_cause(void)
+{
+    return s_fake.wakeup_cause;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    s_fake.gpio_wakeup_mask |= 1ULL << gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num)
+{
+    s_fake.gpio_wakeup_mask &= ~(1ULL << gpio_num);
+    return ESP_OK;
+}
+
+void esp_zb_fake_sleep_gpio_wakeup(uint32_t after_ms)
+{
+    s_fake.sleep_gpio_after = after_ms;
+    s_fake.sleep_gpio_pending = true;
+}
+
+uint64_t esp_zb_fake_sleep_timer(void)
+{
+    return s_fake.sleep_timer;
+}
+
+uint64_t esp_zb_fake_gpio_wakeup_mask(void)
+{
+    return s_fake.sleep_gpio_enabled ? s_fake.gpio_wakeup_mask : 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* The fake stack the host tests link the component sources against: a simulated clock driving the scheduler alarms,
+ * an attribute table with the reporting information, in-memory NVS, a buffer pool, the key table of the Trust Center,
+ * the AES encryption of mbed TLS and the task notification of the Zigbee task. */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_zigbee_core.h"
+#include "zboss_api.h"
+
+#define ESP_ZB_FAKE_ALARM_MAX_NUM       256     /* scheduler alarms pending at the same time */
+#define ESP_ZB_FAKE_ATTR_MAX_NUM        64      /* attributes of the attribute table */
+#define ESP_ZB_FAKE_BUF_NUM             32      /* buffers of the pool */
+#define ESP_ZB_FAKE_BUF_SIZE            128     /* bytes of a buffer, the parameter of a request lives at its tail */
+#define ESP_ZB_FAKE_ZDO_REQ_MAX_NUM     2048    /* ZDO requests recorded since the reset */
+#define ESP_ZB_FAKE_APS_PAYLOAD_SIZE    64      /* bytes of the payload of the last APS data request kept */
+
+/* A ZDO request sent through the esp_zb_zdo_*_req() functions, answered by calling its callback */
+typedef struct esp_zb_fake_zdo_req_s {
+    uint16_t cluster_id;                            /* the ZDO request cluster, e.g. 0x0002 for Node_Desc_req */
+    uint16_t dst_addr;
+    uint8_t endpoint;                               /* the endpoint of a Simple_Desc_req */
+    uint8_t start_index;                            /* the start index of a Mgmt_Lqi_req or Mgmt_Rtg_req, the duration of a Mgmt_Permit_Joining_req */
+    void *cb;
+    void *user_ctx;
+} esp_zb_fake_zdo_req_t;
+
+#define TEST_ASSERT(cond) do {                                                              \
+        if (!(cond)) {                                                                      \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #cond);   \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) do {                                            \
+        long long expected_ = (long long)(expected);                                        \
+        long long actual_ = (long long)(actual);                                            \
+        if (expected_ != actual_) {                                                         \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__,       \
+                    #actual, actual_, expected_);                                           \
+            exit(1);                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#define TEST_RUN(test) do {                                                                 \
+        esp_zb_fake_reset();                                                                \
+        test();                                                                             \
+        printf("PASS %s\n", #test);                                                         \
+    } while (0)
+
+/* Reset the clock, the alarms, the attribute table, NVS, the buffers and the random generator */
+void esp_zb_fake_reset(void);
+
+/* The simulated time in millisecond */
+uint32_t esp_zb_fake_now(void);
+
+/* Advance the simulated time by time_ms, running the scheduler alarms as they expire */
+void esp_zb_fake_run(uint32_t time_ms);
+
+/* Run the alarms expired at the current time */
+void esp_zb_fake_run_pending(void);
+
+/* The number of scheduler alarms pending, and of those calling cb */
+uint16_t esp_zb_fake_alarm_count(void);
+uint16_t esp_zb_fake_alarm_count_cb(esp_zb_callback_t cb);
+
+/* The time in millisecond until the next alarm, UINT32_MAX if none */
+uint32_t esp_zb_fake_alarm_next(void);
+
+/* Seed the generator of esp_random() */
+void esp_zb_fake_random_seed(uint32_t seed);
+
+/* Add an attribute to the attribute table, the value is held by the table */
+esp_zb_zcl_attr_t *esp_zb_fake_attr_add(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role, uint16_t attr_id,
+                                        uint8_t type, uint8_t access, uint8_t size);
+
+/* The number of writes through esp_zb_zcl_set_attribute_val() */
+uint32_t esp_zb_fake_attr_write_count(void);
+
+/* Add the reporting information of an attribute, as a Configure Reporting command does */
+zb_zcl_reporting_info_t *esp_zb_fake_reporting_add(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role,
+                                                   uint16_t attr_id, uint16_t min_interval, uint16_t max_interval);
+
+/* The number of reports started through zb_zcl_start_attr_reporting() */
+uint32_t esp_zb_fake_reporting_start_count(void);
+
+/* The keep alive timeout last set with zb_set_keepalive_timeout(), in beacon intervals */
+zb_uint_t esp_zb_fake_keepalive_timeout(void);
+
+/* The number of writes and erasures committed to NVS */
+uint32_t esp_zb_fake_nvs_write_count(void);
+
+/* The number of buffers allocated and not freed */
+uint8_t esp_zb_fake_buf_in_use(void);
+
+/* Make the next buffer allocations fail */
+void esp_zb_fake_buf_exhaust(bool exhausted);
+
+/* Run the current thread as an interrupt handler, for xPortInIsrContext() */
+void esp_zb_fake_isr_set(bool in_isr);
+
+/* The number of task notifications given and not taken yet */
+uint32_t esp_zb_fake_notify_pending(void);
+
+/* Deliver an APS data indication with a payload to the hook of zb_af_set_data_indication(), true if the hook
+ * consumed the frame; otherwise the stack processes and frees it */
+bool esp_zb_fake_af_indication(const zb_apsde_data_indication_t *ind, const uint8_t *payload, uint8_t len);
+
+/* Whether a data indication hook is set */
+bool esp_zb_fake_af_hook_set(void);
+
+/* The number of read attribute commands sent and the last one, with the ZCL sequence number it was sent with */
+uint32_t esp_zb_fake_read_attr_count(void);
+const esp_zb_zcl_read_attr_cmd_t *esp_zb_fake_read_attr_last(uint8_t *tsn);
+
+/* Build a read attribute response with a single successful record, the length of the frame is returned */
+uint8_t esp_zb_fake_read_attr_resp_build(uint8_t *frame, uint8_t tsn, uint16_t attr_id, uint8_t attr_type,
+                                        const void *value, uint8_t size);
+
+/* The number of ZDO requests sent and one of them, the oldest is 0. Mgmt_Lqi_req (0x0031) and Mgmt_Rtg_req (0x0032) are
+ * recorded unless the test links the ZDO management source, which then sends them through the stack */
+uint32_t esp_zb_fake_zdo_req_count(void);
+const esp_zb_fake_zdo_req_t *esp_zb_fake_zdo_req_get(uint32_t index);
+
+/* The number of ZCL commands sent through esp_zb_zcl_*_cmd_req() by command, e.g. "ias_zone_enroll" */
+uint32_t esp_zb_fake_zcl_cmd_count(const char *name);
+
+/* The number of APS data requests sent and the last one with its payload */
+uint32_t esp_zb_fake_aps_data_req_count(void);
+const zb_apsde_data_req_t *esp_zb_fake_aps_data_req_last(const uint8_t **payload, uint8_t *len);
+
+/* The number of ZDO requests sent through the stack, e.g. zb_zdo_mgmt_lqi_req(), and the buffer and callback of the
+ * last one */
+uint32_t esp_zb_fake_stack_zdo_count(void);
+zb_callback_t esp_zb_fake_stack_zdo_last(zb_bufid_t *buf);
+
+/* Make the next ZDO requests sent through the stack fail with ZB_ZDO_INVALID_TSN, the buffer is left to the caller */
+void esp_zb_fake_stack_zdo_fail(bool fail);
+
+/* The parameter of the bind or unbind request sent through the stack with a transaction sequence number, the ZDO
+ * requests sent through the stack being numbered from 1, NULL if it is not one of the first 63 */
+const zb_zdo_bind_req_param_t *esp_zb_fake_bind_req_get(uint8_t tsn, bool *unbind);
+
+/* The parameter of the last Mgmt_NWK_Update request sent through the stack */
+const zb_zdo_mgmt_nwk_update_req_t *esp_zb_fake_nwk_update_req_last(void);
+
+/* Set the channel of the network returned by esp_zb_get_current_channel() */
+void esp_zb_fake_channel_set(uint8_t channel);
+
+/* Set the network the device is on, as returned by esp_zb_get_current_channel(), esp_zb_get_pan_id() and
+ * esp_zb_get_short_address() */
+void esp_zb_fake_network_set(uint8_t channel, uint16_t pan_id, uint16_t short_addr);
+
+/* The primary channel set last set by esp_zb_set_primary_network_channel_set(), 0 if none */
+uint32_t esp_zb_fake_channel_mask(void);
+
+/* The number of calls to esp_zb_bdb_start_top_level_commissioning() and the mode of the last one */
+uint32_t esp_zb_fake_bdb_count(uint8_t *mode_mask);
+
+/* The number of calls to zb_start_concentrator_mode() with the radius and discovery time of the last one, and whether
+ * the concentrator mode runs */
+uint32_t esp_zb_fake_concentrator_start_count(uint8_t *radius, uint32_t *disc_time, bool *running);
+
+/* Limit the key table of the Trust Center filled by zb_secur_update_key_pair() to size keys, 0 for the default of 64 */
+void esp_zb_fake_key_table_size(uint16_t size);
+
+/* The number of keys in the key table of the Trust Center, and the key of a device, false if it has none */
+uint16_t esp_zb_fake_key_count(void);
+bool esp_zb_fake_key_get(const zb_ieee_addr_t ieee_addr, uint8_t *key);
+
+/* The number of calls to esp_zb_platform_config(), esp_zb_init() and esp_zb_start() which reached the stack */
+uint32_t esp_zb_fake_stack_call_count(void);
+
+/* The number of ZCL frames sent through zb_zcl_send() */
+uint32_t esp_zb_fake_zcl_send_count(void);
+
+/* Make the next ZCL frames sent with a callback fail their APS confirm, the callback runs from the scheduler */
+void esp_zb_fake_zcl_send_fail(bool fail);
+
+/* The poll interval in millisecond last set by zb_zdo_pim_set_long_poll_interval() */
+uint32_t esp_zb_fake_long_poll_interval(void);
+
+/* Wake the next light sleep up by a GPIO after after_ms, if the timer wake-up is not earlier */
+void esp_zb_fake_sleep_gpio_wakeup(uint32_t after_ms);
+
+/* The timer wake-up in microsecond last enabled */
+uint64_t esp_zb_fake_sleep_timer(void);
+
+/* The GPIOs enabled as wake-up sources, 0 while the GPIO wake-up is disabled */
+uint64_t esp_zb_fake_gpio_wakeup_mask(void);
@@ -0,0 +1,115 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Script to build and run the host tests of the Zigbee component sources against the fake stack.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+HOST_TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+COMPONENT_DIR = os.path.join(HOST_TEST_DIR, '..', '..', 'components', 'esp-zigbee-lib')
+
+# the buffer functions the buffer monitor wraps, as the component CMakeLists.txt does with CONFIG_ZB_BUF_MONITOR
+BUF_MONITOR_WRAP = ['-Wl,--wrap=zb_buf_get_out_func', '-Wl,--wrap=zb_buf_get_in_func', '-Wl,--wrap=zb_buf_get_func',
+                    '-Wl,--wrap=zb_buf_get_hipri_func', '-Wl,--wrap=zb_buf_free_func',
+                    '-Wl,--wrap=zb_buf_get_out_delayed_func', '-Wl,--wrap=zb_buf_get_in_delayed_func',
+                    '-Wl,--wrap=zb_buf_get_out_delayed_ext_func', '-Wl,--wrap=zb_buf_get_in_delayed_ext_func']
+
+# each test: its sources besides the test itself and the fake stack, relative to the component, the test file when it
+# is not test_<name>.c, extra compile and link flags and the sanitizers replacing the default ones
+TESTS = {
+    'alarm': {'sources': ['src/esp_zigbee_alarm.c', 'src/esp_zigbee_mem.c', 'src/esp_zigbee_profiler.c']},
+    'battery': {'sources': ['src/esp_zigbee_battery.c'], 'cflags': ['-DZB_ED_ROLE']},
+    'buf_monitor': {'sources': ['src/esp_zigbee_buf_monitor.c'], 'cflags': ['-DCONFIG_ZB_BUF_MONITOR=1'],
+                    'ldflags': BUF_MONITOR_WRAP},
+    'buf_monitor_debug': {'sources': ['src/esp_zigbee_buf_monitor.c'], 'test': 'buf_monitor',
+                          'cflags': ['-DCONFIG_ZB_BUF_MONITOR=1', '-DZB_DEBUG_BUFFERS'], 'ldflags': BUF_MONITOR_WRAP},
+    'channel': {'sources': ['src/esp_zigbee_af_indication.c', 'src/esp_zigbee_channel.c', 'src/esp_zigbee_mem.c',
+                            'src/zdo/esp_zigbee_zdo_mgmt.c']},
+    'concentrator': {'sources': ['src/esp_zigbee_concentrator.c']},
+    'commissioning': {'sources': ['src/esp_zigbee_commissioning.c', 'src/esp_zigbee_mem.c']},
+    'door_lock': {'sources': ['src/esp_zigbee_af_indication.c', 'src/esp_zigbee_read_attr.c', 'src/esp_zigbee_time.c',
+                               'src/esp_zigbee_mem.c', 'src/esp_zigbee_door_lock.c']},
+    'ias_zone': {'sources': ['src/esp_zigbee_af_indication.c', 'src/esp_zigbee_ias_zone.c']},
+    'ic_store': {'sources': ['src/esp_zigbee_ic_store.c', 'src/esp_zigbee_mem.c']},
+    'interview': {'sources': ['src/esp_zigbee_af_indication.c', 'src/esp_zigbee_read_attr.c', 'src/esp_zigbee_interview.c']},
+    'link_stats': {'sources': ['src/esp_zigbee_af_indication.c', 'src/esp_zigbee_link_stats.c']},
+    'mem': {'sources': ['src/esp_zigbee_mem.c']},
+    'poll_control': {'sources': ['src/esp_zigbee_poll_control.c']},
+    'profiler': {'sources': ['src/esp_zigbee_alarm.c', 'src/esp_zigbee_mem.c', 'src/esp_zigbee_profiler.c']},
+    'read_attr': {'sources': ['src/esp_zigbee_af_indication.c', 'src/esp_zigbee_read_attr.c', 'src/esp_zigbee_time.c']},
+    'registry': {'sources': ['src/esp_zigbee_af_indication.c', 'src/esp_zigbee_mem.c', 'src/esp_zigbee_read_attr.c',
+                             'src/esp_zigbee_registry.c', 'src/esp_zigbee_time.c']},
+    'zdo_mgmt': {'sources': ['src/esp_zigbee_af_indication.c', 'src/esp_zigbee_mem.c', 'src/zdo/esp_zigbee_zdo_match.c',
+                             'src/zdo/esp_zigbee_zdo_mgmt.c'], 'cflags': ['-DCONFIG_ZB_ZDO_MGMT_RTG=1']},
+    'topology': {'sources': ['src/esp_zigbee_mem.c', 'src/esp_zigbee_topology.c'], 'cflags': ['-DCONFIG_ZB_ZDO_MGMT_RTG=1']},
+    'sensor': {'sources': ['src/esp_zigbee_sensor.c']},
+    'signal': {'sources': ['src/esp_zigbee_signal.c']},
+    'sleep': {'sources': ['src/esp_zigbee_sleep.c']},
+    'startup': {'sources': ['src/esp_zigbee_startup.c'], 'cflags': ['-DCONFIG_ZB_STARTUP_TRACE_STACK_CALLS=1'],
+                'ldflags': ['-Wl,--wrap=esp_zb_platform_config', '-Wl,--wrap=esp_zb_init', '-Wl,--wrap=esp_zb_start']},
+    'submit': {'sources': ['src/esp_zigbee_mem.c', 'src/esp_zigbee_profiler.c', 'src/esp_zigbee_submit.c'],
+               'sanitizers': ['-fsanitize=thread']},
+}
+
+CFLAGS = ['-std=gnu17', '-g', '-O1', '-Wall', '-Wextra', '-Werror', '-Wno-unused-parameter', '-pthread']
+SANITIZERS = ['-fsanitize=address,undefined', '-fno-sanitize-recover=all']
+
+
+def build(name, test, args, build_dir):
+    output = os.path.join(build_dir, 'test_' + name)
+    command = [args.cc] + CFLAGS + ([] if args.no_sanitize else test.get('sanitizers', SANITIZERS))
+    command += test.get('cflags', [])
+    command += ['-I', os.path.join(HOST_TEST_DIR, 'stubs'), '-I', os.path.join(HOST_TEST_DIR, 'fake'),
+                '-I', os.path.join(COMPONENT_DIR, 'include'), '-I', os.path.join(COMPONENT_DIR, 'src')]
+    command += [os.path.join(HOST_TEST_DIR, 'test_{}.c'.format(test.get('test', name))), os.path.join(HOST_TEST_DIR, 'fake', 'esp_zb_fake.c')]
+    command += [os.path.join(COMPONENT_DIR, source) for source in test['sources']]
+    command += test.get('ldflags', []) + ['-lm', '-o', output]
+    subprocess.check_call(command)
+    return output
+
+
+def get_args():
+    parser = argparse.ArgumentParser(description='ESP Zigbee Host Tests')
+    parser.add_argument('tests', nargs='*', help='The tests to run, all of them by default: {}.'.format(', '.join(TESTS)))
+    parser.add_argument('--cc', default=os.environ.get('CC', 'gcc'), help='The host C compiler, default gcc.')
+    parser.add_argument('--no_sanitize', action='store_true', help='Build without the address and undefined behavior sanitizers.')
+    parser.add_argument('--build_dir', help='The directory to keep the test binaries in, a temporary one by default.')
+    return parser.parse_args()
+
+
+def main():
+    args = get_args()
+    names = args.tests or list(TESTS)
+    failed = []
+    for name in names:
+        if name not in TESTS:
+            print('Unknown test: {}'.format(name))
+            sys.exit(1)
+    with tempfile.TemporaryDirectory() as temp_dir:
+        build_dir = os.path.abspath(args.build_dir) if args.build_dir else temp_dir
+        os.makedirs(build_dir, exist_ok=True)
+        for name in names:
+            print('=== {}'.format(name))
+            sys.stdout.flush()
+            try:
+                binary = build(name, TESTS[name], args, build_dir)
+                subprocess.check_call([binary], cwd=HOST_TEST_DIR)
+            except subprocess.CalledProcessError:
+                failed.append(name)
+    if failed:
+        print('Failed: {}'.format(', '.join(failed)))
+        sys.exit(1)
+    print('All {} tests passed'.format(len(names)))
+
+
+if __name__ == '__main__':
+    main()
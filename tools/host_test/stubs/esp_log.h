@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* host stand-in for the ESP-IDF header, the errors, warnings and information are printed, the debug logs are dropped */
+
+#pragma once
+#include <stdio.h>
+
+#define ESP_HOST_LOG(level, tag, format, ...)   printf(level " (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_HOST_LOG_NONE(tag, format, ...)     do { if (0) { printf(format, ##__VA_ARGS__); } } while (0)
+
+#define ESP_LOGE(tag, format, ...)  ESP_HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)  ESP_HOST_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)  ESP_HOST_LOG("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)  ESP_HOST_LOG_NONE(tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)  ESP_HOST_LOG_NONE(tag, format, ##__VA_ARGS__)
+#define ESP_EARLY_LOGE(tag, format, ...)    ESP_HOST_LOG_NONE(tag, format, ##__VA_ARGS__)
+#define ESP_EARLY_LOGI(tag, format, ...)    ESP_HOST_LOG_NONE(tag, format, ##__VA_ARGS__)
+#define ESP_DRAM_LOGE(tag, format, ...)     ESP_HOST_LOG_NONE(tag, format, ##__VA_ARGS__)
+#define LOG_COLOR_I                 ""
+#define LOG_RESET_COLOR             ""
@@ -0,0 +1,12 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* host stand-in for the ESP-IDF header, the random numbers come from a seeded generator of the fake stack */
+
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_random(void);
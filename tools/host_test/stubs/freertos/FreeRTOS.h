@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* host stand-in for the FreeRTOS header, a tick is a millisecond and the critical sections take one global mutex */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE                      1
+#define pdFALSE                     0
+#define pdPASS                      1
+#define portMAX_DELAY               0xffffffffU
+#define portTICK_PERIOD_MS          1
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(x)       (void)(x)
+
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED        {0}
+
+void esp_host_critical_enter(void);
+void esp_host_critical_exit(void);
+bool esp_host_in_isr(void);
+
+#define portENTER_CRITICAL(mux)             ((void)(mux), esp_host_critical_enter())
+#define portEXIT_CRITICAL(mux)              ((void)(mux), esp_host_critical_exit())
+#define portENTER_CRITICAL_SAFE(mux)        portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux)         portEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL_ISR(mux)         portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)          portEXIT_CRITICAL(mux)
+#define xPortInIsrContext()                 esp_host_in_isr()
@@ -0,0 +1,9 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* host stand-in for the configuration generated by ESP-IDF, the options a test needs are given with its cflags */
+
+#pragma once
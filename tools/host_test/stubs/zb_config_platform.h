@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* host stand-in for the esp-zboss-lib header */
+
+#pragma once
+#include "esp_err.h"
+
+typedef struct {
+    int radio_mode;
+} esp_zb_radio_config_t;
+
+typedef struct {
+    int host_connection_mode;
+} esp_zb_host_config_t;
+
+typedef struct {
+    esp_zb_radio_config_t radio_config;
+    esp_zb_host_config_t host_config;
+} esp_zb_platform_config_t;
+
+esp_err_t esp_zb_platform_config(esp_zb_platform_config_t *config);
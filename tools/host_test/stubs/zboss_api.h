@@ -0,0 +1,305 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* host stand-in for the ZBOSS header, only the types, macros and functions the Zigbee component sources use, with the
+ * layout of the ZBOSS definitions they stand for */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint8_t zb_uint8_t;
+typedef int8_t zb_int8_t;
+typedef uint16_t zb_uint16_t;
+typedef uint32_t zb_uint32_t;
+typedef unsigned int zb_uint_t;
+typedef uint8_t zb_bool_t;
+typedef uint32_t zb_time_t;
+typedef int32_t zb_ret_t;
+typedef uint8_t zb_bufid_t;
+typedef uint8_t zb_ieee_addr_t[8];
+typedef uint8_t zb_ext_pan_id_t[8];
+typedef void (*zb_callback_t)(zb_uint8_t param);
+typedef void (*zb_callback2_t)(zb_uint8_t param, zb_uint16_t cb_param);
+typedef zb_uint8_t (*zb_device_handler_t)(zb_uint8_t param);
+
+#define ZB_FALSE                                    0
+#define ZB_TRUE                                     1
+#define RET_OK                                      0
+#define RET_NO_MEMORY                               (-4)
+#define ZB_BUF_INVALID                              0
+#define ZB_ZDO_INVALID_TSN                          0xff
+#define ZB_ZDO_NEW_ACTIVE_CHANNEL                   0xfe
+#define ZB_ZCL_CLUSTER_SERVER_ROLE                  0x01
+#define ZB_AF_HA_PROFILE_ID                         0x0104
+#define ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT  0x00
+#define ZB_SECUR_PROVISIONAL_KEY                    0
+#define ZB_SECUR_UNIQUE_KEY                         1
+#define ZB_SECUR_KEY_SRC_UNKNOWN                    0
+#define ZB_MILLISECONDS_TO_BEACON_INTERVAL(ms)      ((ms) / 15)
+
+/* buffers, built with ZB_DEBUG_BUFFERS the functions take the file id and line of the caller first */
+#ifdef ZB_DEBUG_BUFFERS
+#ifndef ZB_TRACE_FILE_ID
+#define ZB_TRACE_FILE_ID                            0
+#endif
+#define TRACE_PROTO_VOID                            zb_uint16_t from_file, zb_uint16_t from_line
+#define TRACE_PROTO                                 TRACE_PROTO_VOID,
+#define TRACE_CALL_VOID                             ZB_TRACE_FILE_ID, __LINE__
+#define TRACE_CALL                                  TRACE_CALL_VOID,
+#else
+#define TRACE_PROTO_VOID                            void
+#define TRACE_PROTO
+#define TRACE_CALL_VOID
+#define TRACE_CALL
+#endif
+
+zb_bufid_t zb_buf_get_out_func(TRACE_PROTO_VOID);
+zb_bufid_t zb_buf_get_in_func(TRACE_PROTO_VOID);
+zb_bufid_t zb_buf_get_func(TRACE_PROTO zb_bool_t is_in, zb_uint_t max_size);
+zb_bufid_t zb_buf_get_hipri_func(TRACE_PROTO zb_bool_t is_in);
+void zb_buf_free_func(TRACE_PROTO zb_bufid_t buf);
+zb_ret_t zb_buf_get_out_delayed_func(TRACE_PROTO zb_callback_t callback);
+zb_ret_t zb_buf_get_in_delayed_func(TRACE_PROTO zb_callback_t callback);
+zb_ret_t zb_buf_get_out_delayed_ext_func(TRACE_PROTO zb_callback2_t callback, zb_uint16_t arg, zb_uint_t max_size);
+zb_ret_t zb_buf_get_in_delayed_ext_func(TRACE_PROTO zb_callback2_t callback, zb_uint16_t arg, zb_uint_t max_size);
+#define zb_buf_get_out()                            zb_buf_get_out_func(TRACE_CALL_VOID)
+#define zb_buf_get_in()                             zb_buf_get_in_func(TRACE_CALL_VOID)
+#define zb_buf_get(is_in, max_size)                 zb_buf_get_func(TRACE_CALL (is_in), (max_size))
+#define zb_buf_get_hipri(is_in)                     zb_buf_get_hipri_func(TRACE_CALL (is_in))
+#define zb_buf_free(buf)                            zb_buf_free_func(TRACE_CALL (buf))
+#define zb_buf_get_out_delayed(callback)            zb_buf_get_out_delayed_func(TRACE_CALL (callback))
+#define zb_buf_get_in_delayed(callback)             zb_buf_get_in_delayed_func(TRACE_CALL (callback))
+#define zb_buf_get_out_delayed_ext(callback, arg, max_size) \
+    zb_buf_get_out_delayed_ext_func(TRACE_CALL (callback), (arg), (max_size))
+#define zb_buf_get_in_delayed_ext(callback, arg, max_size) \
+    zb_buf_get_in_delayed_ext_func(TRACE_CALL (callback), (arg), (max_size))
+void *zb_buf_begin(zb_bufid_t buf);
+zb_uint32_t zb_buf_len(zb_bufid_t buf);
+void *zb_buf_initial_alloc(zb_bufid_t buf, zb_uint32_t size);
+void *zb_buf_get_tail_func(zb_bufid_t buf, zb_uint32_t size);
+#define ZB_BUF_GET_PARAM(buf, type)                 ((type *)zb_buf_get_tail_func((buf), sizeof(type)))
+
+/* APS */
+typedef union zb_addr_u {
+    zb_uint16_t addr_short;
+    zb_ieee_addr_t addr_long;
+} zb_addr_u;
+
+typedef struct zb_apsde_data_indication_s {
+    zb_uint16_t src_addr;
+    zb_uint16_t dst_addr;
+    zb_uint16_t clusterid;
+    zb_uint16_t profileid;
+    zb_uint8_t src_endpoint;
+    zb_uint8_t dst_endpoint;
+    zb_uint16_t mac_src_addr;
+    zb_uint8_t lqi;
+    zb_int8_t rssi;
+} zb_apsde_data_indication_t;
+
+typedef struct __attribute__((packed)) zb_apsde_data_req_s {
+    zb_addr_u dst_addr;
+    zb_uint16_t profileid;
+    zb_uint16_t clusterid;
+    zb_uint8_t dst_endpoint;
+    zb_uint8_t src_endpoint;
+    zb_uint8_t radius;
+    zb_uint8_t addr_mode;
+    zb_uint8_t tx_options;
+    zb_uint8_t use_alias;
+    zb_uint16_t alias_src_addr;
+    zb_uint8_t alias_seq_num;
+    zb_uint8_t extension;
+} zb_apsde_data_req_t;
+
+void zb_af_set_data_indication(zb_device_handler_t cb);
+void zb_apsde_data_request(zb_uint8_t param);
+
+/* ZCL */
+typedef struct zb_zcl_reporting_info_s {
+    zb_uint8_t direction;
+    zb_uint8_t ep;
+    zb_uint16_t cluster_id;
+    zb_uint8_t cluster_role;
+    zb_uint16_t attr_id;
+    zb_uint8_t flags;
+    zb_uint32_t run_time;
+    union {
+        struct {
+            zb_uint16_t min_interval;
+            zb_uint16_t max_interval;
+        } send_info;
+    } u;
+} zb_zcl_reporting_info_t;
+
+zb_zcl_reporting_info_t *zb_zcl_find_reporting_info(zb_uint8_t ep, zb_uint16_t cluster_id, zb_uint8_t cluster_role,
+                                                    zb_uint16_t attr_id);
+zb_ret_t zb_zcl_put_reporting_info(zb_zcl_reporting_info_t *rep_info_ptr, zb_bool_t override);
+zb_ret_t zb_zcl_start_attr_reporting(zb_uint8_t ep, zb_uint16_t cluster_id, zb_uint8_t cluster_role, zb_uint16_t attr_id);
+typedef struct zb_zcl_globals_s {
+    zb_uint8_t seq_number;
+} zb_zcl_globals_t;
+
+#define ZB_ZCL_ADDR_TYPE_SHORT                      0
+typedef struct zb_zcl_addr_s {
+    zb_uint8_t addr_type;
+    union {
+        zb_uint16_t short_addr;
+        zb_ieee_addr_t ieee_addr;
+    } u;
+} zb_zcl_addr_t;
+
+/* the parameter of the buffer given to the callback of a ZCL send once the APS confirm is received */
+typedef struct zb_zcl_command_send_status_s {
+    zb_ret_t status;
+    zb_zcl_addr_t dst_addr;
+    zb_uint8_t dst_endpoint;
+    zb_uint8_t src_endpoint;
+} zb_zcl_command_send_status_t;
+
+zb_zcl_globals_t *zb_zcl_get_ctx(void);
+#define ZCL_CTX()                                   (*zb_zcl_get_ctx())
+zb_uint8_t zb_zcl_get_attribute_size(zb_uint8_t attr_type, zb_uint8_t *attr_value);
+zb_uint8_t zb_zcl_get_seq(void);
+void zb_zcl_send(zb_bufid_t buf, zb_uint16_t addr, zb_uint8_t addr_mode, zb_uint8_t dst_ep, zb_uint8_t ep,
+                 zb_uint16_t profile_id, zb_uint16_t cluster_id, zb_callback_t cb);
+#define ZB_ZCL_START_PACKET(buf)                    ((zb_uint8_t *)zb_buf_begin(buf))
+#define ZB_ZCL_CONSTRUCT_SPECIFIC_COMMAND_RES_FRAME_CONTROL(p)  (*((p)++) = 0x19)
+#define ZB_ZCL_CONSTRUCT_COMMAND_HEADER(p, seq, cmd)            do { *((p)++) = (seq); *((p)++) = (cmd); } while (0)
+#define ZB_ZCL_GET_SEQ_NUM()                        zb_zcl_get_seq()
+#define ZB_ZCL_FINISH_PACKET(buf, p)                (void)zb_buf_initial_alloc((buf), (p) - (zb_uint8_t *)zb_buf_begin(buf));
+#define ZB_ZCL_SEND_COMMAND_SHORT(buf, addr, addr_mode, dst_ep, ep, prof_id, cluster_id, cb) \
+    zb_zcl_send(buf, addr, addr_mode, dst_ep, ep, prof_id, cluster_id, cb)
+
+/* ZDO */
+typedef struct zb_zdo_mgmt_lqi_param_s {
+    zb_uint8_t start_index;
+    zb_uint16_t dst_addr;
+} zb_zdo_mgmt_lqi_param_t;
+
+typedef struct __attribute__((packed)) zb_zdo_mgmt_lqi_resp_s {
+    zb_uint8_t tsn;
+    zb_uint8_t status;
+    zb_uint8_t neighbor_table_entries;
+    zb_uint8_t start_index;
+    zb_uint8_t neighbor_table_list_count;
+} zb_zdo_mgmt_lqi_resp_t;
+
+typedef struct __attribute__((packed)) zb_zdo_neighbor_table_record_s {
+    zb_ext_pan_id_t ext_pan_id;
+    zb_ieee_addr_t ext_addr;
+    zb_uint16_t network_addr;
+    zb_uint8_t type_flags;
+    zb_uint8_t permit_join;
+    zb_uint8_t depth;
+    zb_uint8_t lqi;
+} zb_zdo_neighbor_table_record_t;
+
+typedef struct __attribute__((packed)) zb_zdo_match_desc_param_s {
+    zb_uint16_t nwk_addr;
+    zb_uint16_t addr_of_interest;
+    zb_uint16_t profile_id;
+    zb_uint8_t num_in_clusters;
+    zb_uint8_t num_out_clusters;
+    zb_uint16_t cluster_list[1];
+} zb_zdo_match_desc_param_t;
+
+typedef struct __attribute__((packed)) zb_zdo_match_desc_resp_s {
+    zb_uint8_t tsn;
+    zb_uint8_t status;
+    zb_uint16_t nwk_addr;
+    zb_uint8_t match_len;
+} zb_zdo_match_desc_resp_t;
+
+typedef struct zb_zdo_bind_req_param_s {
+    zb_ieee_addr_t src_address;
+    zb_uint8_t src_endp;
+    zb_uint16_t cluster_id;
+    zb_uint8_t dst_addr_mode;
+    zb_addr_u dst_address;
+    zb_uint8_t dst_endp;
+    zb_uint16_t req_dst_addr;
+} zb_zdo_bind_req_param_t;
+
+typedef struct __attribute__((packed)) zb_zdo_bind_resp_s {
+    zb_uint8_t tsn;
+    zb_uint8_t status;
+} zb_zdo_bind_resp_t;
+
+typedef struct zb_zdo_mgmt_bind_param_s {
+    zb_uint8_t start_index;
+    zb_uint16_t dst_addr;
+} zb_zdo_mgmt_bind_param_t;
+
+typedef struct __attribute__((packed)) zb_zdo_mgmt_bind_resp_s {
+    zb_uint8_t tsn;
+    zb_uint8_t status;
+    zb_uint8_t binding_table_entries;
+    zb_uint8_t start_index;
+    zb_uint8_t binding_table_list_count;
+} zb_zdo_mgmt_bind_resp_t;
+
+typedef struct __attribute__((packed)) zb_zdo_binding_table_record_s {
+    zb_ieee_addr_t src_address;
+    zb_uint8_t src_endp;
+    zb_uint16_t cluster_id;
+    zb_uint8_t dst_addr_mode;
+    zb_addr_u dst_address;
+    zb_uint8_t dst_endp;
+} zb_zdo_binding_table_record_t;
+
+typedef struct __attribute__((packed)) zb_zdo_mgmt_nwk_update_req_hdr_s {
+    zb_uint32_t scan_channels;
+    zb_uint8_t scan_duration;
+} zb_zdo_mgmt_nwk_update_req_hdr_t;
+
+typedef struct __attribute__((packed)) zb_zdo_mgmt_nwk_update_req_s {
+    zb_zdo_mgmt_nwk_update_req_hdr_t hdr;
+    zb_uint8_t scan_count;
+    zb_uint8_t tsn;
+    zb_uint16_t manager_addr;
+    zb_uint16_t dst_addr;
+} zb_zdo_mgmt_nwk_update_req_t;
+
+typedef struct __attribute__((packed)) zb_zdo_mgmt_nwk_update_notify_hdr_s {
+    zb_uint8_t tsn;
+    zb_uint8_t status;
+    zb_uint32_t scanned_channels;
+    zb_uint16_t total_transmissions;
+    zb_uint16_t transmission_failures;
+    zb_uint8_t scanned_channels_list_count;
+} zb_zdo_mgmt_nwk_update_notify_hdr_t;
+
+zb_uint8_t zb_zdo_mgmt_lqi_req(zb_uint8_t param, zb_callback_t cb);
+zb_uint8_t zb_zdo_match_desc_req(zb_uint8_t param, zb_callback_t cb);
+zb_uint8_t zb_zdo_bind_req(zb_uint8_t param, zb_callback_t cb);
+zb_uint8_t zb_zdo_unbind_req(zb_uint8_t param, zb_callback_t cb);
+zb_uint8_t zb_zdo_mgmt_bind_req(zb_uint8_t param, zb_callback_t cb);
+zb_uint8_t zb_zdo_mgmt_nwk_update_req(zb_uint8_t param, zb_callback_t cb);
+void zb_zdo_pim_set_long_poll_interval(zb_uint32_t ms);
+
+/* NWK */
+#define ESP_ZB_NWK_BROADCAST_RX_ON_WHEN_IDLE        0xfffd
+typedef struct zb_nlme_status_indication_s {
+    zb_uint8_t status;
+    zb_uint16_t network_addr;
+    zb_uint8_t unknown_command_id;
+} zb_nlme_status_indication_t;
+
+typedef struct zb_zdo_signal_nlme_status_indication_params_s {
+    zb_nlme_status_indication_t nlme_status;
+} zb_zdo_signal_nlme_status_indication_params_t;
+
+void zb_start_concentrator_mode(zb_uint8_t radius, zb_uint32_t disc_time);
+void zb_stop_concentrator_mode(void);
+void zb_set_keepalive_timeout(zb_uint_t to);
+
+/* security */
+zb_ret_t zb_secur_update_key_pair(zb_ieee_addr_t address, zb_uint8_t *key, zb_uint8_t key_type, zb_uint8_t key_attr,
+                                  zb_uint8_t key_source);
+
+void zboss_main_loop_iteration(void);
@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Alarm tests: random one-shot and periodic alarms, cancellations, from the callbacks too, are checked against a model
+ * on the simulated clock. An alarm never expires early nor later than two ticks, a cancelled alarm never expires and a
+ * stale handle never hits a reused alarm. */
+
+#include "esp_zigbee_alarm.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_zb_fake.h"
+
+#define TEST_ALARM_NUM              512
+#define TEST_OP_NUM                 20000
+#define TEST_TICK_US                (ESP_ZB_ALARM_TICK_MS * 1000)
+
+typedef struct test_alarm_s {
+    esp_zb_alarm_handle_t handle;
+    int64_t due;                                    /* the time in microsecond of the next expiry in the model */
+    int64_t period;                                 /* the period in microsecond, 0 for a one-shot alarm */
+    uint32_t fire_count;
+    bool pending;
+    bool cancel_self;                               /* the periodic alarm cancels itself at its third expiry */
+} test_alarm_t;
+
+static test_alarm_t s_alarms[TEST_ALARM_NUM];
+static uint32_t s_fire_count;
+static uint32_t s_error_count;
+static bool s_cancel_other;                         /* the callbacks cancel another pending alarm */
+
+static test_alarm_t *pending_pick(void)
+{
+    uint32_t start = esp_random() % TEST_ALARM_NUM;
+
+    for (uint32_t i = 0; i < TEST_ALARM_NUM; i++) {
+        test_alarm_t *alarm = &s_alarms[(start + i) % TEST_ALARM_NUM];
+        if (alarm->pending) {
+            return alarm;
+        }
+    }
+    return NULL;
+}
+
+static void alarm_cancel(test_alarm_t *alarm)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_cancel(alarm->handle));
+    alarm->pending = false;
+}
+
+static void alarm_cb(esp_zb_alarm_handle_t handle, void *ctx)
+{
+    test_alarm_t *alarm = ctx;
+    int64_t lateness = esp_timer_get_time() - alarm->due;
+
+    if (!alarm->pending || handle != alarm->handle || lateness < 0 || lateness >= 2 * TEST_TICK_US) {
+        printf("alarm %u: pending %d, lateness %lld us\n", (unsigned)(alarm - s_alarms), alarm->pending, (long long)lateness);
+        s_error_count++;
+    }
+    alarm->fire_count++;
+    s_fire_count++;
+    if (alarm->period) {
+        alarm->due += alarm->period;
+        if (alarm->cancel_self && alarm->fire_count == 3) {
+            alarm_cancel(alarm);
+        }
+    } else {
+        alarm->pending = false;
+    }
+    if (s_cancel_other && esp_random() % 16 == 0) {
+        test_alarm_t *other = pending_pick();
+        if (other && other != alarm) {
+            alarm_cancel(other);
+        }
+    }
+}
+
+static void alarm_start(test_alarm_t *alarm, uint32_t delay, uint32_t period)
+{
+    *alarm = (test_alarm_t) {
+        .due = esp_timer_get_time() + (int64_t)delay * 1000,
+        .period = (int64_t)period * 1000,
+        .pending = true,
+        .cancel_self = period && esp_random() % 8 == 0,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_start(alarm_cb, alarm, delay, period, &alarm->handle));
+}
+
+static void remaining_check(const test_alarm_t *alarm)
+{
+    uint32_t remaining = 0;
+    int64_t left = alarm->due - esp_timer_get_time();
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_get_remaining(alarm->handle, &remaining));
+    TEST_ASSERT((int64_t)remaining * 1000 + TEST_TICK_US > left && (int64_t)remaining * 1000 < left + 3 * TEST_TICK_US);
+}
+
+static void test_random_alarms(void)
+{
+    esp_zb_alarm_stats_t stats;
+    uint32_t pending = 0;
+
+    esp_zb_fake_random_seed(0x042);
+    s_fire_count = 0;
+    s_error_count = 0;
+    s_cancel_other = true;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_init(TEST_ALARM_NUM));
+    for (uint32_t op = 0; op < TEST_OP_NUM; op++) {
+        uint32_t action = esp_random() % 10;
+        test_alarm_t *alarm = NULL;
+
+        if (action < 5) {
+            for (uint32_t i = 0; i < TEST_ALARM_NUM && !alarm; i++) {
+                alarm = s_alarms[i].pending ? NULL : &s_alarms[i];
+            }
+            if (!alarm) {
+                continue;
+            }
+            /* mostly short delays, some of hours, the periods are whole ticks */
+            if (action < 3) {
+                alarm_start(alarm, esp_random() % (esp_random() % 3 ? 5000 : 4 * 3600 * 1000), 0);
+            } else {
+                alarm_start(alarm, esp_random() % 3000, (1 + esp_random() % 300) * ESP_ZB_ALARM_TICK_MS);
+            }
+        } else if (action < 7) {
+            if ((alarm = pending_pick())) {
+                remaining_check(alarm);
+                alarm_cancel(alarm);
+            }
+        } else {
+            esp_zb_fake_run(esp_random() % 200);
+        }
+    }
+    /* the periodic alarms are cancelled, the one-shot alarms all expire */
+    s_cancel_other = false;
+    for (uint32_t i = 0; i < TEST_ALARM_NUM; i++) {
+        if (s_alarms[i].pending && s_alarms[i].period) {
+            alarm_cancel(&s_alarms[i]);
+        }
+    }
+    esp_zb_fake_run(5 * 3600 * 1000);
+    for (uint32_t i = 0; i < TEST_ALARM_NUM; i++) {
+        pending += s_alarms[i].pending;
+    }
+    TEST_ASSERT_EQUAL(0, pending);
+    TEST_ASSERT_EQUAL(0, s_error_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.pending);
+    TEST_ASSERT_EQUAL(s_fire_count, stats.expire_count);
+    printf("%d operations: %u expiries, %u alarms pending at most\n", TEST_OP_NUM, (unsigned)s_fire_count,
+           (unsigned)stats.pending_max);
+    /* an idle wheel leaves no alarm to the stack */
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_deinit());
+}
+
+/* the delays beyond the range of the wheel, about 46 hours, are parked and placed again */
+static void test_long_delays(void)
+{
+    static const uint32_t delays[] = {10 * 3600 * 1000, 46 * 3600 * 1000 + 3599 * 1000, 60 * 3600 * 1000, 100 * 3600 * 1000};
+
+    s_error_count = 0;
+    s_cancel_other = false;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_init(8));
+    for (uint32_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        alarm_start(&s_alarms[i], delays[i], 0);
+    }
+    for (uint32_t hour = 0; hour < 101; hour++) {
+        esp_zb_fake_run(3600 * 1000);
+    }
+    for (uint32_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        TEST_ASSERT_EQUAL(1, s_alarms[i].fire_count);
+    }
+    TEST_ASSERT_EQUAL(0, s_error_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_deinit());
+}
+
+static void test_stale_handle(void)
+{
+    esp_zb_alarm_handle_t stale = ESP_ZB_ALARM_INVALID_HANDLE;
+    uint32_t remaining = 0;
+
+    s_error_count = 0;
+    s_cancel_other = false;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_init(1));
+    alarm_start(&s_alarms[0], 100, 0);
+    stale = s_alarms[0].handle;
+    esp_zb_fake_run(120);
+    TEST_ASSERT_EQUAL(1, s_alarms[0].fire_count);
+    /* the only entry is reused, the handle of its previous alarm no longer matches */
+    alarm_start(&s_alarms[1], 100, 0);
+    TEST_ASSERT((stale & 0xffff) == (s_alarms[1].handle & 0xffff) && stale != s_alarms[1].handle);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_alarm_cancel(stale));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_alarm_get_remaining(stale, &remaining));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_alarm_cancel(ESP_ZB_ALARM_INVALID_HANDLE));
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_alarm_start(alarm_cb, NULL, 100, 0, NULL));
+    esp_zb_fake_run(120);
+    TEST_ASSERT_EQUAL(1, s_alarms[1].fire_count);
+    TEST_ASSERT_EQUAL(0, s_error_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_deinit());
+}
+
+int main(void)
+{
+    TEST_RUN(test_stale_handle);
+    TEST_RUN(test_long_delays);
+    TEST_RUN(test_random_alarms);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Battery monitor tests: the discharge curves are interpolated between their points, the percentage moves by the
+ * hysteresis only, the low battery mode is entered and left, and the report max interval and the keep alive timeout
+ * are stretched through the reporting configuration of the stack and restored. */
+
+#include "esp_zigbee_battery.h"
+#include "zcl/esp_zigbee_zcl_power_config.h"
+#include "esp_zb_fake.h"
+
+#define TEST_ENDPOINT               1
+#define TEST_CLUSTER_ID             0x0402
+#define TEST_ATTR_ID                0x0000
+#define TEST_MAX_INTERVAL           300
+#define TEST_KEEP_ALIVE             15000
+
+static uint32_t s_low_count;
+static bool s_low;
+static uint8_t s_low_percentage;
+
+static void low_cb(bool low, uint8_t percentage, void *user_ctx)
+{
+    s_low_count++;
+    s_low = low;
+    s_low_percentage = percentage;
+    TEST_ASSERT_EQUAL((void *)&s_low_count, user_ctx);
+}
+
+static esp_zb_battery_status_t status_get(void)
+{
+    esp_zb_battery_status_t status;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_get_status(&status));
+    return status;
+}
+
+static void test_curve(void)
+{
+    esp_zb_battery_curve_point_t curve[] = {{3000, 100}, {2000, 0}};
+    esp_zb_battery_cfg_t cfg = {
+        .endpoint = TEST_ENDPOINT, .chemistry = ESP_ZB_BATTERY_CHEMISTRY_CUSTOM, .curve = curve, .curve_size = 2,
+    };
+
+    TEST_ASSERT_EQUAL(100, esp_zb_battery_voltage_to_percentage(ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_COIN, 3100));
+    TEST_ASSERT_EQUAL(100, esp_zb_battery_voltage_to_percentage(ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_COIN, 3000));
+    TEST_ASSERT_EQUAL(90, esp_zb_battery_voltage_to_percentage(ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_COIN, 2950));
+    TEST_ASSERT_EQUAL(0, esp_zb_battery_voltage_to_percentage(ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_COIN, 1900));
+    TEST_ASSERT_EQUAL(52, esp_zb_battery_voltage_to_percentage(ESP_ZB_BATTERY_CHEMISTRY_ALKALINE, 1300));
+    TEST_ASSERT_EQUAL(26, esp_zb_battery_voltage_to_percentage(ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_ION, 3650));
+    TEST_ASSERT_EQUAL(0, esp_zb_battery_voltage_to_percentage(ESP_ZB_BATTERY_CHEMISTRY_CUSTOM, 3000));
+    /* a custom curve must fall with the voltage */
+    curve[1].voltage = 3000;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_battery_init(&cfg));
+    curve[1].voltage = 2000;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_init(&cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_update(2250));
+    TEST_ASSERT_EQUAL(25, status_get().percentage);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_deinit());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_battery_update(2250));
+}
+
+/* two coin cells in series, the max interval and the keep alive timeout stretch up to 3 times at empty battery and
+ * twice more in low battery mode */
+static void test_stretch(void)
+{
+    esp_zb_battery_cfg_t cfg = {
+        .endpoint = TEST_ENDPOINT, .chemistry = ESP_ZB_BATTERY_CHEMISTRY_LITHIUM_COIN, .cell_num = 2, .hysteresis = 5,
+        .low_threshold = 25, .drain_stretch = 3, .low_stretch = 2, .keep_alive = TEST_KEEP_ALIVE,
+        .report_attr = {{TEST_ENDPOINT, TEST_CLUSTER_ID, TEST_ATTR_ID}}, .report_attr_num = 1,
+        .low_cb = low_cb, .user_ctx = &s_low_count,
+    };
+    esp_zb_zcl_attr_t *voltage_attr = esp_zb_fake_attr_add(TEST_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_POWER_CONFIG,
+                                                           ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                                           ESP_ZB_ZCL_ATTR_POWER_CONFIG_BATTERY_VOLTAGE_ID,
+                                                           ESP_ZB_ZCL_ATTR_TYPE_U8, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, 1);
+    esp_zb_zcl_attr_t *percentage_attr = esp_zb_fake_attr_add(TEST_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_POWER_CONFIG,
+                                                              ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                                              ESP_ZB_ZCL_ATTR_POWER_CONFIG_BATTERY_PERCENTAGE_REMAINING_ID,
+                                                              ESP_ZB_ZCL_ATTR_TYPE_U8, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, 1);
+    zb_zcl_reporting_info_t *info = esp_zb_fake_reporting_add(TEST_ENDPOINT, TEST_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                                              TEST_ATTR_ID, 1, TEST_MAX_INTERVAL);
+
+    s_low_count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_init(&cfg));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_battery_init(&cfg));
+    /* 2900 mV a cell is 80%, the stretch is 1 + 2 * 20% in 1/16 units, 22 */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_update(5800));
+    TEST_ASSERT_EQUAL(5800, status_get().voltage);
+    TEST_ASSERT_EQUAL(2900, status_get().cell_voltage);
+    TEST_ASSERT_EQUAL(80, status_get().percentage);
+    TEST_ASSERT_EQUAL(22, status_get().stretch);
+    TEST_ASSERT_EQUAL(58, *(uint8_t *)voltage_attr->data_p);
+    TEST_ASSERT_EQUAL(160, *(uint8_t *)percentage_attr->data_p);
+    TEST_ASSERT_EQUAL(TEST_MAX_INTERVAL * 22 / 16, info->u.send_info.max_interval);
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_reporting_start_count());
+    TEST_ASSERT_EQUAL(ZB_MILLISECONDS_TO_BEACON_INTERVAL(TEST_KEEP_ALIVE * 22 / 16), esp_zb_fake_keepalive_timeout());
+    /* 79% is within the hysteresis, nothing changes */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_update(5790));
+    TEST_ASSERT_EQUAL(80, status_get().percentage);
+    TEST_ASSERT_EQUAL(2895, status_get().cell_voltage);
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_reporting_start_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_update(5700));
+    TEST_ASSERT_EQUAL(70, status_get().percentage);
+    TEST_ASSERT_EQUAL(TEST_MAX_INTERVAL * 25 / 16, info->u.send_info.max_interval);
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_reporting_start_count());
+    /* a remote device configures another max interval, which becomes the base of the stretch */
+    info->u.send_info.max_interval = 600;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_update(5000));
+    TEST_ASSERT_EQUAL(20, status_get().percentage);
+    TEST_ASSERT(status_get().low);
+    TEST_ASSERT_EQUAL(1, s_low_count);
+    TEST_ASSERT(s_low);
+    TEST_ASSERT_EQUAL(20, s_low_percentage);
+    TEST_ASSERT_EQUAL(82, status_get().stretch);
+    TEST_ASSERT_EQUAL(600 * 82 / 16, info->u.send_info.max_interval);
+    TEST_ASSERT_EQUAL(3, esp_zb_fake_reporting_start_count());
+    /* the low battery mode is left above the threshold plus the hysteresis only */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_update(5180));
+    TEST_ASSERT_EQUAL(29, status_get().percentage);
+    TEST_ASSERT(status_get().low);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_update(5300));
+    TEST_ASSERT_EQUAL(35, status_get().percentage);
+    TEST_ASSERT(!status_get().low);
+    TEST_ASSERT_EQUAL(2, s_low_count);
+    TEST_ASSERT(!s_low);
+    TEST_ASSERT_EQUAL(36, status_get().stretch);
+    TEST_ASSERT_EQUAL(600 * 36 / 16, info->u.send_info.max_interval);
+    /* the original max interval and keep alive timeout are restored */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_battery_deinit());
+    TEST_ASSERT_EQUAL(600, info->u.send_info.max_interval);
+    TEST_ASSERT_EQUAL(ZB_MILLISECONDS_TO_BEACON_INTERVAL(TEST_KEEP_ALIVE), esp_zb_fake_keepalive_timeout());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_battery_deinit());
+}
+
+int main(void)
+{
+    TEST_RUN(test_curve);
+    TEST_RUN(test_stretch);
+    return 0;
+}
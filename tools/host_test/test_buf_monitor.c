@@ -0,0 +1,227 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Buffer monitor tests: the buffer functions are redirected to the monitor with --wrap as on the device, refer to
+ * run_host_tests.py, the input and output buffers allocated at once or given to delayed requests are tracked until
+ * freed, and a buffer the fake stack allocates within its own object file is not seen, as within the stack. The test is
+ * also built with ZB_DEBUG_BUFFERS, for the trace arguments of the buffer functions. */
+
+#include "esp_zigbee_buf_monitor.h"
+#include "zboss_api.h"
+#include "esp_zb_fake.h"
+
+#define TEST_POOL_SIZE              ESP_ZB_FAKE_BUF_NUM
+#define TEST_EXT_ARG                0x1234
+
+static uint32_t s_fail_count;
+static esp_zb_buf_monitor_alloc_t s_fail_alloc;
+static zb_bufid_t s_delayed_buf[ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM + 2];
+static uint8_t s_delayed_num;
+static zb_uint16_t s_ext_arg;
+
+static void fail_cb(esp_zb_buf_monitor_alloc_t alloc, const esp_zb_buf_monitor_stats_t *stats, void *ctx)
+{
+    TEST_ASSERT_EQUAL(&s_fail_count, ctx);
+    s_fail_count++;
+    s_fail_alloc = alloc;
+}
+
+static void delayed_cb(zb_uint8_t param)
+{
+    s_delayed_buf[s_delayed_num++] = param;
+}
+
+static void delayed_ext_cb(zb_uint8_t param, zb_uint16_t cb_param)
+{
+    s_ext_arg = cb_param;
+    s_delayed_buf[s_delayed_num++] = param;
+}
+
+static void test_config(void)
+{
+    esp_zb_buf_monitor_cfg_t cfg = {.pool_size = TEST_POOL_SIZE, .fail_cb = fail_cb, .ctx = &s_fail_count};
+
+    s_fail_count = 0;
+    s_delayed_num = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_config(&cfg));
+}
+
+static void test_immediate(void)
+{
+    esp_zb_buf_monitor_stats_t stats;
+    zb_bufid_t buf[4];
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_buf_monitor_config(NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_buf_monitor_get_stats(NULL));
+    test_config();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_reset());
+    buf[0] = zb_buf_get_out();
+    buf[1] = zb_buf_get_in();
+    buf[2] = zb_buf_get(ZB_TRUE, 0);
+    buf[3] = zb_buf_get_hipri(ZB_FALSE);
+    TEST_ASSERT_EQUAL(4, esp_zb_fake_buf_in_use());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(4, stats.in_use);
+    TEST_ASSERT_EQUAL(2, stats.in_use_input);
+    TEST_ASSERT_EQUAL(4, stats.in_use_max);
+    TEST_ASSERT_EQUAL(TEST_POOL_SIZE - 4, stats.free);
+    TEST_ASSERT_EQUAL(2, stats.alloc[ESP_ZB_BUF_MONITOR_ALLOC_OUT].alloc_count);
+    TEST_ASSERT_EQUAL(2, stats.alloc[ESP_ZB_BUF_MONITOR_ALLOC_IN].alloc_count);
+
+    zb_buf_free(buf[1]);
+    zb_buf_free(buf[3]);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(2, stats.in_use);
+    TEST_ASSERT_EQUAL(1, stats.in_use_input);
+    TEST_ASSERT_EQUAL(4, stats.in_use_max);
+    TEST_ASSERT_EQUAL(2, stats.free_count);
+    /* the high watermark starts again from the buffers in use */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_reset());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(2, stats.in_use);
+    TEST_ASSERT_EQUAL(1, stats.in_use_input);
+    TEST_ASSERT_EQUAL(2, stats.in_use_max);
+    TEST_ASSERT_EQUAL(0, stats.free_count);
+    zb_buf_free(buf[0]);
+    zb_buf_free(buf[2]);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+    TEST_ASSERT_EQUAL(0, stats.in_use_input);
+    TEST_ASSERT_EQUAL(0, stats.untracked_free_count);
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+}
+
+/* the buffer of a delayed request is tracked once the stack gives it to the callback */
+static void test_delayed(void)
+{
+    esp_zb_buf_monitor_stats_t stats;
+
+    test_config();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_reset());
+    TEST_ASSERT_EQUAL(RET_OK, zb_buf_get_out_delayed(delayed_cb));
+    TEST_ASSERT_EQUAL(RET_OK, zb_buf_get_in_delayed_ext(delayed_ext_cb, TEST_EXT_ARG, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+    TEST_ASSERT_EQUAL(1, stats.alloc[ESP_ZB_BUF_MONITOR_ALLOC_OUT_DELAYED].alloc_count);
+    TEST_ASSERT_EQUAL(1, stats.alloc[ESP_ZB_BUF_MONITOR_ALLOC_IN_DELAYED].alloc_count);
+
+    esp_zb_fake_run_pending();
+    TEST_ASSERT_EQUAL(2, s_delayed_num);
+    TEST_ASSERT_EQUAL(TEST_EXT_ARG, s_ext_arg);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(2, stats.in_use);
+    TEST_ASSERT_EQUAL(1, stats.in_use_input);
+    zb_buf_free(s_delayed_buf[0]);
+    zb_buf_free(s_delayed_buf[1]);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+    TEST_ASSERT_EQUAL(2, stats.free_count);
+    TEST_ASSERT_EQUAL(0, stats.untracked_free_count);
+    TEST_ASSERT_EQUAL(0, stats.untracked_alloc_count);
+}
+
+/* the requests beyond the slots reach the stack as they are, their buffers are not tracked */
+static void test_delayed_full(void)
+{
+    esp_zb_buf_monitor_stats_t stats;
+
+    test_config();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_reset());
+    for (uint8_t i = 0; i < ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM + 2; i++) {
+        TEST_ASSERT_EQUAL(RET_OK, zb_buf_get_out_delayed_ext(delayed_ext_cb, i, 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(2, stats.untracked_alloc_count);
+    esp_zb_fake_run_pending();
+    TEST_ASSERT_EQUAL(ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM + 2, s_delayed_num);
+    TEST_ASSERT_EQUAL(ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM + 1, s_ext_arg);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM, stats.in_use);
+    for (uint8_t i = 0; i < s_delayed_num; i++) {
+        zb_buf_free(s_delayed_buf[i]);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+    TEST_ASSERT_EQUAL(2, stats.untracked_free_count);
+    /* the slots are free again */
+    s_delayed_num = 0;
+    TEST_ASSERT_EQUAL(RET_OK, zb_buf_get_out_delayed(delayed_cb));
+    esp_zb_fake_run_pending();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(1, stats.in_use);
+    TEST_ASSERT_EQUAL(2, stats.untracked_alloc_count);
+    zb_buf_free(s_delayed_buf[0]);
+}
+
+static void test_fail(void)
+{
+    esp_zb_buf_monitor_stats_t stats;
+
+    test_config();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_reset());
+    esp_zb_fake_buf_exhaust(true);
+    TEST_ASSERT_EQUAL(ZB_BUF_INVALID, zb_buf_get_out());
+    TEST_ASSERT_EQUAL(1, s_fail_count);
+    TEST_ASSERT_EQUAL(ESP_ZB_BUF_MONITOR_ALLOC_OUT, s_fail_alloc);
+    TEST_ASSERT_EQUAL(ZB_BUF_INVALID, zb_buf_get(ZB_TRUE, 0));
+    TEST_ASSERT_EQUAL(ESP_ZB_BUF_MONITOR_ALLOC_IN, s_fail_alloc);
+    TEST_ASSERT(zb_buf_get_in_delayed(delayed_cb) != RET_OK);
+    TEST_ASSERT_EQUAL(3, s_fail_count);
+    TEST_ASSERT_EQUAL(ESP_ZB_BUF_MONITOR_ALLOC_IN_DELAYED, s_fail_alloc);
+    esp_zb_fake_buf_exhaust(false);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+    TEST_ASSERT_EQUAL(1, stats.alloc[ESP_ZB_BUF_MONITOR_ALLOC_OUT].fail_count);
+    TEST_ASSERT_EQUAL(1, stats.alloc[ESP_ZB_BUF_MONITOR_ALLOC_IN].fail_count);
+    TEST_ASSERT_EQUAL(1, stats.alloc[ESP_ZB_BUF_MONITOR_ALLOC_IN_DELAYED].fail_count);
+
+    /* the slot of the failed request is released */
+    for (uint8_t i = 0; i < ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM; i++) {
+        TEST_ASSERT_EQUAL(RET_OK, zb_buf_get_out_delayed(delayed_cb));
+    }
+    esp_zb_fake_run_pending();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.untracked_alloc_count);
+    TEST_ASSERT_EQUAL(ESP_ZB_BUF_MONITOR_DELAYED_MAX_NUM, stats.in_use);
+    for (uint8_t i = 0; i < s_delayed_num; i++) {
+        zb_buf_free(s_delayed_buf[i]);
+    }
+}
+
+static zb_uint8_t consume_indication(zb_uint8_t param)
+{
+    zb_buf_free(param);
+    return ZB_TRUE;
+}
+
+/* the fake stack allocates the buffer of an indication within its object file, as the stack does in its buffer pool,
+ * the linker does not redirect the call and the release is untracked */
+static void test_same_object(void)
+{
+    zb_apsde_data_indication_t ind = {.src_addr = 0x1234};
+    esp_zb_buf_monitor_stats_t stats;
+    uint8_t payload[2] = {0};
+
+    test_config();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_reset());
+    zb_af_set_data_indication(consume_indication);
+    TEST_ASSERT(esp_zb_fake_af_indication(&ind, payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_buf_monitor_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.in_use);
+    TEST_ASSERT_EQUAL(0, stats.free_count);
+    TEST_ASSERT_EQUAL(1, stats.untracked_free_count);
+    zb_af_set_data_indication(NULL);
+}
+
+int main(void)
+{
+    TEST_RUN(test_immediate);
+    TEST_RUN(test_delayed);
+    TEST_RUN(test_delayed_full);
+    TEST_RUN(test_fail);
+    TEST_RUN(test_same_object);
+    return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Channel monitor simulation: the coordinator sends its traffic on the simulated channels while Wi-Fi access points
+ * switch on and off. A Wi-Fi channel raises the energy of the 4 Zigbee channels it overlaps and makes the transmissions
+ * on them fail with its duty cycle. The energy scans are answered from the simulated channels through the stack, the
+ * channel changes move the simulated network. */
+
+#include <string.h>
+#include "esp_random.h"
+#include "esp_zigbee_channel.h"
+#include "esp_zb_fake.h"
+
+#define SIM_CHANNEL_MIN             11
+#define SIM_CHANNEL_NUM             16
+#define SIM_WIFI_NUM                3       /* the Wi-Fi channels 1, 6 and 11 */
+#define SIM_NOISE_FLOOR             30      /* energy of a quiet channel */
+#define SIM_NOISE_SPREAD            10      /* random energy added to each scan of a channel */
+#define SIM_WIFI_ENERGY             200     /* energy added by a Wi-Fi access point transmitting all the time */
+#define SIM_BASE_FAILURE            2       /* failure rate in percent of a quiet channel */
+#define SIM_STEP                    1000    /* time in millisecond of a simulation step */
+#define SIM_SCAN_TIME               500     /* time in millisecond the energy scan takes */
+#define SIM_CHECK_PERIOD            60000   /* time in millisecond between two checks of the monitor */
+#define SIM_FAILURE_THRESHOLD       20
+#define SIM_ENERGY_MARGIN           40
+
+/* a phase of the simulation, from its minute on */
+typedef struct sim_phase_s {
+    uint16_t minute;
+    uint8_t wifi_duty[SIM_WIFI_NUM];        /* the share of time in percent each Wi-Fi channel transmits */
+    uint8_t jammer_duty;                    /* a wideband interferer over the whole band */
+    uint8_t frame_per_second;               /* the traffic sent by the coordinator */
+} sim_phase_t;
+
+typedef struct sim_s {
+    const sim_phase_t *phase;
+    uint8_t phase_num;
+    uint8_t current;                        /* the phase in force */
+    uint16_t total_transmissions;           /* the cumulative counters of the MAC layer, wrapping at 16 bits */
+    uint16_t transmission_failures;
+    uint32_t stack_zdo_handled;
+    bool scan_pending;
+    uint8_t scan_tsn;
+    uint32_t scan_channels;
+    zb_callback_t scan_cb;
+    uint8_t change_num;
+    uint8_t change_from[8];
+    uint8_t change_to[8];
+    uint16_t change_minute[8];
+} sim_t;
+
+static sim_t s_sim;
+
+/* the Wi-Fi channel 1, 6 and 11 at 2412, 2437 and 2462 MHz overlap the Zigbee channels 11 to 14, 16 to 19 and 21 to 24 */
+static uint8_t sim_duty(uint8_t channel)
+{
+    const sim_phase_t *phase = &s_sim.phase[s_sim.current];
+    uint8_t duty = phase->jammer_duty;
+
+    for (uint8_t i = 0; i < SIM_WIFI_NUM; i++) {
+        if (channel >= SIM_CHANNEL_MIN + i * 5 && channel < SIM_CHANNEL_MIN + i * 5 + 4 && phase->wifi_duty[i] > duty) {
+            duty = phase->wifi_duty[i];
+        }
+    }
+    return duty;
+}
+
+static uint8_t sim_energy(uint8_t channel)
+{
+    uint32_t energy = SIM_NOISE_FLOOR + esp_random() % SIM_NOISE_SPREAD + SIM_WIFI_ENERGY * sim_duty(channel) / 100;
+
+    return energy > 0xff ? 0xff : energy;
+}
+
+static void sim_scan_answer(uint8_t param)
+{
+    zb_bufid_t buf = zb_buf_get_out();
+    zb_zdo_mgmt_nwk_update_notify_hdr_t *hdr = NULL;
+    uint8_t count = 0;
+
+    TEST_ASSERT(buf != ZB_BUF_INVALID && s_sim.scan_pending);
+    s_sim.scan_pending = false;
+    hdr = zb_buf_initial_alloc(buf, sizeof(*hdr) + SIM_CHANNEL_NUM);
+    for (uint8_t ch = SIM_CHANNEL_MIN; ch < SIM_CHANNEL_MIN + SIM_CHANNEL_NUM; ch++) {
+        if (s_sim.scan_channels & (1UL << ch)) {
+            ((uint8_t *)(hdr + 1))[count++] = sim_energy(ch);
+        }
+    }
+    hdr->tsn = s_sim.scan_tsn;
+    hdr->status = ESP_ZB_ZDP_STATUS_SUCCESS;
+    hdr->scanned_channels = s_sim.scan_channels;
+    hdr->total_transmissions = s_sim.total_transmissions;
+    hdr->transmission_failures = s_sim.transmission_failures;
+    hdr->scanned_channels_list_count = count;
+    s_sim.scan_cb(buf);
+}
+
+/* the requests the monitor sent through the stack: an energy scan of the coordinator or a channel change broadcast */
+static void sim_stack_serve(uint16_t minute)
+{
+    for (; s_sim.stack_zdo_handled < esp_zb_fake_stack_zdo_count(); s_sim.stack_zdo_handled++) {
+        const zb_zdo_mgmt_nwk_update_req_t *req = esp_zb_fake_nwk_update_req_last();
+        uint8_t channel = esp_zb_get_current_channel();
+
+        TEST_ASSERT_EQUAL(s_sim.stack_zdo_handled + 1, esp_zb_fake_stack_zdo_count());
+        if (req->hdr.scan_duration == ZB_ZDO_NEW_ACTIVE_CHANNEL) {
+            TEST_ASSERT(s_sim.change_num < sizeof(s_sim.change_to));
+            s_sim.change_from[s_sim.change_num] = channel;
+            s_sim.change_minute[s_sim.change_num] = minute;
+            channel = __builtin_ctz(req->hdr.scan_channels);
+            s_sim.change_to[s_sim.change_num++] = channel;
+            esp_zb_fake_channel_set(channel);
+            continue;
+        }
+        TEST_ASSERT(!s_sim.scan_pending && req->dst_addr == 0x0000);
+        s_sim.scan_pending = true;
+        s_sim.scan_tsn = (uint8_t)esp_zb_fake_stack_zdo_count();
+        s_sim.scan_channels = req->hdr.scan_channels;
+        s_sim.scan_cb = esp_zb_fake_stack_zdo_last(NULL);
+        esp_zb_scheduler_alarm(sim_scan_answer, 0, SIM_SCAN_TIME);
+    }
+}
+
+static void sim_traffic(void)
+{
+    uint8_t channel = esp_zb_get_current_channel();
+    uint8_t failure = SIM_BASE_FAILURE + sim_duty(channel) * (100 - SIM_BASE_FAILURE) / 100;
+
+    for (uint8_t i = 0; i < s_sim.phase[s_sim.current].frame_per_second; i++) {
+        s_sim.total_transmissions++;
+        s_sim.transmission_failures += esp_random() % 100 < failure;
+    }
+}
+
+static void sim_run(const sim_phase_t *phase, uint8_t phase_num, uint16_t minutes, uint8_t channel, bool trace)
+{
+    esp_zb_channel_monitor_cfg_t cfg = {
+        .channel_mask = ESP_ZB_CHANNEL_MASK_WIFI_CLEAR | (1UL << channel),
+        .check_period = SIM_CHECK_PERIOD,
+        .scan_duration = 3,
+        .failure_threshold = SIM_FAILURE_THRESHOLD,
+        .energy_margin = SIM_ENERGY_MARGIN,
+    };
+    uint32_t check_count = 0;
+
+    memset(&s_sim, 0, sizeof(s_sim));
+    s_sim.phase = phase;
+    s_sim.phase_num = phase_num;
+    esp_zb_fake_channel_set(channel);
+    esp_zb_fake_random_seed(3);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_channel_monitor_start(&cfg));
+    if (trace) {
+        printf("\n%-7s %-8s %6s %6s %6s %7s %s\n", "minute", "channel", "tx", "fail", "rate", "energy", "action");
+    }
+    for (uint32_t step = 0; step < minutes * 60000 / SIM_STEP; step++) {
+        uint16_t minute = step * SIM_STEP / 60000;
+        uint8_t change_num = s_sim.change_num;
+        esp_zb_channel_monitor_stats_t stats;
+
+        while (s_sim.current + 1 < s_sim.phase_num && s_sim.phase[s_sim.current + 1].minute <= minute) {
+            s_sim.current++;
+        }
+        sim_traffic();
+        sim_stack_serve(minute);
+        esp_zb_fake_run(SIM_STEP);
+        sim_stack_serve(minute);
+        TEST_ASSERT_EQUAL(ESP_OK, esp_zb_channel_monitor_get_stats(&stats));
+        /* a check every 5 minutes and every check above the threshold */
+        if (trace && stats.check_count != check_count && (minute % 5 == 0 || stats.failure_rate >= SIM_FAILURE_THRESHOLD)) {
+            uint8_t ch = s_sim.change_num != change_num ? s_sim.change_from[change_num] : esp_zb_get_current_channel();
+
+            printf("%-7u %-8u %6u %6u %5u%% %7u ", minute, ch, stats.transmissions, stats.failures, stats.failure_rate,
+                   stats.energy[ch - SIM_CHANNEL_MIN]);
+            if (s_sim.change_num != change_num) {
+                printf("move to %u\n", s_sim.change_to[change_num]);
+            } else {
+                printf("%s\n", stats.failure_rate >= SIM_FAILURE_THRESHOLD && stats.transmissions >= ESP_ZB_CHANNEL_MONITOR_MIN_TRANSMISSION ?
+                       "stay, no quieter channel" : "-");
+            }
+        }
+        check_count = stats.check_count;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_channel_monitor_stop());
+}
+
+/* the network formed on channel 13 while the Wi-Fi channel 1 was quiet, the access point gets busy at minute 10 */
+static void test_wifi_moves_network(void)
+{
+    static const sim_phase_t phase[] = {
+        {.minute = 0, .wifi_duty = {0, 30, 0}, .frame_per_second = 2},
+        {.minute = 10, .wifi_duty = {60, 30, 0}, .frame_per_second = 2},
+        {.minute = 40, .wifi_duty = {60, 30, 5}, .frame_per_second = 2},
+    };
+    esp_zb_channel_monitor_stats_t stats;
+
+    sim_run(phase, sizeof(phase) / sizeof(phase[0]), 60, 13, true);
+    TEST_ASSERT_EQUAL(1, s_sim.change_num);
+    TEST_ASSERT_EQUAL(13, s_sim.change_from[0]);
+    /* the network moves within two checks of the interference, to a channel clear of the busy Wi-Fi channels */
+    TEST_ASSERT(s_sim.change_minute[0] >= 10 && s_sim.change_minute[0] <= 12);
+    TEST_ASSERT(ESP_ZB_CHANNEL_MASK_WIFI_CLEAR & (1UL << s_sim.change_to[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_channel_monitor_get_stats(&stats));
+    TEST_ASSERT(stats.failure_rate < SIM_FAILURE_THRESHOLD);
+}
+
+/* a wideband interferer hits every channel alike, moving would not help */
+static void test_wideband_stays(void)
+{
+    static const sim_phase_t phase[] = {
+        {.minute = 0, .jammer_duty = 50, .frame_per_second = 2},
+    };
+    esp_zb_channel_monitor_stats_t stats;
+
+    sim_run(phase, sizeof(phase) / sizeof(phase[0]), 20, 15, false);
+    TEST_ASSERT_EQUAL(0, s_sim.change_num);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_channel_monitor_get_stats(&stats));
+    TEST_ASSERT(stats.failure_rate >= SIM_FAILURE_THRESHOLD);
+}
+
+/* a few frames in a period give no trustworthy failure rate */
+static void test_low_traffic_stays(void)
+{
+    static const sim_phase_t phase[] = {
+        {.minute = 0, .wifi_duty = {80, 0, 0}, .frame_per_second = 0},
+    };
+
+    sim_run(phase, sizeof(phase) / sizeof(phase[0]), 20, 13, false);
+    TEST_ASSERT_EQUAL(0, s_sim.change_num);
+}
+
+/* the formation picks the quietest channel of a scan of the channels clear of Wi-Fi and the busy ones */
+static void test_select_formation_channel(void)
+{
+    static const sim_phase_t phase[] = {
+        {.minute = 0, .wifi_duty = {70, 70, 70}},
+    };
+    esp_zb_zdo_mgmt_nwk_update_rsp_t rsp = {.scanned_channels = ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_MASK};
+    uint8_t channel = 0;
+
+    s_sim.phase = phase;
+    s_sim.current = 0;
+    for (uint8_t ch = SIM_CHANNEL_MIN; ch < SIM_CHANNEL_MIN + SIM_CHANNEL_NUM; ch++) {
+        rsp.energy_list[rsp.energy_list_count++] = sim_energy(ch);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_channel_select(&rsp, ESP_ZB_ZDO_NWK_UPDATE_CHANNEL_MASK, &channel));
+    TEST_ASSERT(ESP_ZB_CHANNEL_MASK_WIFI_CLEAR & (1UL << channel));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_channel_select(&rsp, 0, &channel));
+}
+
+int main(void)
+{
+    TEST_RUN(test_wifi_moves_network);
+    TEST_RUN(test_wideband_stays);
+    TEST_RUN(test_low_traffic_stays);
+    TEST_RUN(test_select_formation_channel);
+    return 0;
+}
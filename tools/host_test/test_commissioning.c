@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Commissioning scheduler tests: the allowlist is checked on the unsecured joins while the commissioning mode runs,
+ * the devices rejoining and the joins outside of the commissioning mode are left alone. */
+
+#include <string.h>
+#include "esp_zigbee_commissioning.h"
+#include "esp_zb_fake.h"
+
+#define TEST_DEVICE_UPDATE_SECURED_REJOIN   0x00
+#define TEST_DEVICE_UPDATE_UNSECURED_JOIN   0x01
+#define TEST_LEAVE_CLUSTER                  0x0034
+
+static const esp_zb_ieee_addr_t s_allowed = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+static const esp_zb_ieee_addr_t s_stranger = {0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18};
+
+static void signal_send(esp_zb_app_signal_type_t type, const void *params, size_t size)
+{
+    uint32_t signal[8] = {type};
+    esp_zb_app_signal_t signal_s = {.p_app_signal = signal, .esp_err_status = ESP_OK};
+
+    memcpy(&signal[1], params, size);
+    esp_zb_commissioning_signal_handle(&signal_s);
+}
+
+static void device_update(const esp_zb_ieee_addr_t ieee_addr, uint16_t short_addr, uint8_t status)
+{
+    esp_zb_zdo_signal_device_update_params_t params = {.short_addr = short_addr, .status = status};
+
+    memcpy(params.long_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t));
+    signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE, &params, sizeof(params));
+}
+
+static void device_annce(const esp_zb_ieee_addr_t ieee_addr, uint16_t short_addr)
+{
+    esp_zb_zdo_signal_device_annce_params_t params = {.device_short_addr = short_addr};
+
+    memcpy(params.ieee_addr, ieee_addr, sizeof(esp_zb_ieee_addr_t));
+    signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, &params, sizeof(params));
+}
+
+static uint32_t leave_count(void)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < esp_zb_fake_zdo_req_count(); i++) {
+        count += esp_zb_fake_zdo_req_get(i)->cluster_id == TEST_LEAVE_CLUSTER;
+    }
+    return count;
+}
+
+static void commissioning_start(void)
+{
+    esp_zb_commissioning_cfg_t cfg = {.window = 60, .max_in_progress = 4, .resume_in_progress = 2};
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_start(&cfg));
+}
+
+static void test_allowlist_unsecured_join(void)
+{
+    esp_zb_commissioning_stats_t stats;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_allowlist_set(&s_allowed, 1));
+    commissioning_start();
+    device_update(s_stranger, 0x2222, TEST_DEVICE_UPDATE_UNSECURED_JOIN);
+    TEST_ASSERT_EQUAL(1, leave_count());
+    device_update(s_allowed, 0x1111, TEST_DEVICE_UPDATE_UNSECURED_JOIN);
+    TEST_ASSERT_EQUAL(1, leave_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_get_stats(&stats));
+    TEST_ASSERT_EQUAL(1, stats.reject_count);
+    TEST_ASSERT_EQUAL(1, stats.in_progress);
+    device_annce(s_allowed, 0x1111);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_get_stats(&stats));
+    TEST_ASSERT_EQUAL(1, stats.join_count);
+    TEST_ASSERT_EQUAL(0, stats.in_progress);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_stop());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_allowlist_set(NULL, 0));
+}
+
+/* a device of the network missing from the allowlist rejoins with the network key and announces itself */
+static void test_allowlist_rejoin_left_alone(void)
+{
+    esp_zb_commissioning_stats_t stats;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_allowlist_set(&s_allowed, 1));
+    commissioning_start();
+    device_update(s_stranger, 0x2222, TEST_DEVICE_UPDATE_SECURED_REJOIN);
+    device_annce(s_stranger, 0x2222);
+    TEST_ASSERT_EQUAL(0, leave_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.reject_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_stop());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_allowlist_set(NULL, 0));
+}
+
+/* the allowlist belongs to the commissioning mode, the joins outside of it are not checked */
+static void test_allowlist_not_running(void)
+{
+    esp_zb_commissioning_stats_t stats;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_allowlist_set(&s_allowed, 1));
+    device_update(s_stranger, 0x2222, TEST_DEVICE_UPDATE_UNSECURED_JOIN);
+    device_annce(s_stranger, 0x2222);
+    TEST_ASSERT_EQUAL(0, leave_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.reject_count);
+    TEST_ASSERT_EQUAL(0, stats.in_progress);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_commissioning_allowlist_set(NULL, 0));
+}
+
+int main(void)
+{
+    TEST_RUN(test_allowlist_unsecured_join);
+    TEST_RUN(test_allowlist_rejoin_left_alone);
+    TEST_RUN(test_allowlist_not_running);
+    return 0;
+}
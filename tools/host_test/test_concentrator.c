@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Concentrator tests: the concentrator mode is started with its defaults, the source route and many-to-one route
+ * failures restart it within the repair holdoff, the other statuses are only recorded, and the route failures are
+ * returned the most recent first, the oldest destination giving way when the table is full. */
+
+#include "esp_zigbee_concentrator.h"
+#include "esp_zb_fake.h"
+
+#define TEST_STATUS_NO_ROUTE        0x00
+#define TEST_STATUS_SOURCE_ROUTE    0x0b
+#define TEST_STATUS_MANY_TO_ONE     0x0c
+#define TEST_STATUS_OTHER           0x10
+#define TEST_RADIUS                 5
+
+static void route_failure(uint16_t short_addr, uint8_t status)
+{
+    struct {
+        uint32_t signal;
+        zb_zdo_signal_nlme_status_indication_params_t params;
+    } nlme = {
+        .signal = ESP_ZB_NLME_STATUS_INDICATION,
+        .params.nlme_status = {.status = status, .network_addr = short_addr},
+    };
+    esp_zb_app_signal_t signal_s = {.p_app_signal = &nlme.signal};
+
+    esp_zb_concentrator_signal_handle(&signal_s);
+}
+
+static esp_zb_concentrator_stats_t stats_get(void)
+{
+    esp_zb_concentrator_stats_t stats;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_get_stats(&stats));
+    return stats;
+}
+
+static void test_repair(void)
+{
+    esp_zb_concentrator_cfg_t cfg = {.radius = TEST_RADIUS};
+    uint32_t disc_time = 0;
+    uint8_t radius = 0;
+    bool running = false;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_concentrator_start(NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_start(&cfg));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_concentrator_start_count(&radius, &disc_time, &running));
+    TEST_ASSERT_EQUAL(TEST_RADIUS, radius);
+    TEST_ASSERT_EQUAL(ESP_ZB_CONCENTRATOR_DISC_TIME, disc_time);
+    TEST_ASSERT(running && stats_get().running);
+    /* a broken link is recorded, the routers repair it themselves */
+    route_failure(0x1234, TEST_STATUS_NO_ROUTE);
+    route_failure(0x1234, TEST_STATUS_OTHER);
+    TEST_ASSERT_EQUAL(1, stats_get().route_failure_count);
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_concentrator_start_count(NULL, NULL, NULL));
+    /* a source route failure restarts the concentrator mode at once */
+    esp_zb_fake_run(1000);
+    route_failure(0x2345, TEST_STATUS_SOURCE_ROUTE);
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_concentrator_start_count(NULL, NULL, NULL));
+    TEST_ASSERT_EQUAL(1, stats_get().repair_count);
+    TEST_ASSERT_EQUAL(1, stats_get().source_route_failure_count);
+    /* the next failures within the holdoff are not repaired */
+    esp_zb_fake_run(ESP_ZB_CONCENTRATOR_REPAIR_HOLDOFF - 1);
+    route_failure(0x3456, TEST_STATUS_MANY_TO_ONE);
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_concentrator_start_count(NULL, NULL, NULL));
+    TEST_ASSERT_EQUAL(1, stats_get().repair_skip_count);
+    TEST_ASSERT_EQUAL(1, stats_get().many_to_one_failure_count);
+    esp_zb_fake_run(1);
+    route_failure(0x3456, TEST_STATUS_MANY_TO_ONE);
+    TEST_ASSERT_EQUAL(3, esp_zb_fake_concentrator_start_count(NULL, NULL, NULL));
+    TEST_ASSERT_EQUAL(2, stats_get().repair_count);
+    TEST_ASSERT_EQUAL(4, stats_get().route_failure_count);
+    /* the failures are ignored once stopped */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_stop());
+    esp_zb_fake_concentrator_start_count(NULL, NULL, &running);
+    TEST_ASSERT(!running && !stats_get().running);
+    esp_zb_fake_run(ESP_ZB_CONCENTRATOR_REPAIR_HOLDOFF);
+    route_failure(0x2345, TEST_STATUS_SOURCE_ROUTE);
+    TEST_ASSERT_EQUAL(4, stats_get().route_failure_count);
+    TEST_ASSERT_EQUAL(3, esp_zb_fake_concentrator_start_count(NULL, NULL, NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_stop());
+    /* a restart takes the new configuration and clears the statistics and the failures */
+    cfg.disc_time = 30;
+    cfg.repair_holdoff = 100;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_start(&cfg));
+    TEST_ASSERT_EQUAL(4, esp_zb_fake_concentrator_start_count(NULL, &disc_time, &running));
+    TEST_ASSERT_EQUAL(30, disc_time);
+    TEST_ASSERT(running);
+    TEST_ASSERT_EQUAL(0, stats_get().route_failure_count);
+    route_failure(0x2345, TEST_STATUS_SOURCE_ROUTE);
+    esp_zb_fake_run(100);
+    route_failure(0x2345, TEST_STATUS_SOURCE_ROUTE);
+    TEST_ASSERT_EQUAL(2, stats_get().repair_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_stop());
+}
+
+static void test_failure_order(void)
+{
+    esp_zb_concentrator_cfg_t cfg = {0};
+    esp_zb_concentrator_route_failure_t failures[ESP_ZB_CONCENTRATOR_FAILURE_MAX_NUM + 1];
+    uint8_t num = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_start(&cfg));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_concentrator_get_route_failures(failures, 1, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_concentrator_get_route_failures(NULL, 1, &num));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_get_route_failures(failures, 1, &num));
+    TEST_ASSERT_EQUAL(0, num);
+    route_failure(0x0001, TEST_STATUS_NO_ROUTE);
+    esp_zb_fake_run(10);
+    route_failure(0x0002, TEST_STATUS_NO_ROUTE);
+    esp_zb_fake_run(10);
+    route_failure(0x0003, TEST_STATUS_NO_ROUTE);
+    esp_zb_fake_run(10);
+    /* a new failure moves its destination to the front */
+    route_failure(0x0001, TEST_STATUS_SOURCE_ROUTE);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_get_route_failures(failures, ESP_ZB_CONCENTRATOR_FAILURE_MAX_NUM, &num));
+    TEST_ASSERT_EQUAL(3, num);
+    TEST_ASSERT_EQUAL(0x0001, failures[0].short_addr);
+    TEST_ASSERT_EQUAL(2, failures[0].count);
+    TEST_ASSERT_EQUAL(TEST_STATUS_SOURCE_ROUTE, failures[0].last_status);
+    TEST_ASSERT_EQUAL(0x0003, failures[1].short_addr);
+    TEST_ASSERT_EQUAL(0x0002, failures[2].short_addr);
+    /* fewer places keep the most recent */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_get_route_failures(failures, 2, &num));
+    TEST_ASSERT_EQUAL(2, num);
+    TEST_ASSERT_EQUAL(0x0001, failures[0].short_addr);
+    TEST_ASSERT_EQUAL(0x0003, failures[1].short_addr);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_get_route_failures(NULL, 0, &num));
+    TEST_ASSERT_EQUAL(0, num);
+    /* a full table replaces the destination with the oldest failure, 0x0002 */
+    for (uint16_t i = 0; i < ESP_ZB_CONCENTRATOR_FAILURE_MAX_NUM - 3; i++) {
+        esp_zb_fake_run(10);
+        route_failure(0x0100 + i, TEST_STATUS_NO_ROUTE);
+    }
+    esp_zb_fake_run(10);
+    route_failure(0x0200, TEST_STATUS_NO_ROUTE);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_get_route_failures(failures, ESP_ZB_CONCENTRATOR_FAILURE_MAX_NUM + 1,
+                                                                     &num));
+    TEST_ASSERT_EQUAL(ESP_ZB_CONCENTRATOR_FAILURE_MAX_NUM, num);
+    TEST_ASSERT_EQUAL(0x0200, failures[0].short_addr);
+    TEST_ASSERT_EQUAL(0x0003, failures[num - 1].short_addr);
+    for (uint8_t i = 1; i < num; i++) {
+        TEST_ASSERT(failures[i - 1].last_time > failures[i].last_time);
+        TEST_ASSERT(failures[i].short_addr != 0x0002);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_concentrator_stop());
+}
+
+int main(void)
+{
+    TEST_RUN(test_repair);
+    TEST_RUN(test_failure_order);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Door lock credential store tests: the user management commands reject the invalid fields, the reserved user types
+ * are denied, and the credential index stays consistent with the users through a long series of changes. */
+
+#include <string.h>
+#include "esp_random.h"
+#include "nvs.h"
+#include "esp_zigbee_door_lock.h"
+#include "esp_zb_fake.h"
+
+#define TEST_USER_NUM               8       /* a page of users fits in a value of the fake NVS */
+#define TEST_RESP_SIZE              32
+#define TEST_RESP_SUCCESS           0x00
+#define TEST_RESP_FAILURE           0x01
+#define TEST_RESP_INVALID_FIELD     0x85
+
+static uint8_t cmd_run(uint8_t cmd_id, const uint8_t *payload, uint16_t len)
+{
+    uint8_t resp[TEST_RESP_SIZE] = {0};
+    uint16_t resp_len = sizeof(resp);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_cmd_handle(cmd_id, payload, len, resp, &resp_len));
+    TEST_ASSERT_EQUAL(1, resp_len);
+    return resp[0];
+}
+
+static uint8_t pin_set(uint16_t user_id, uint8_t status, uint8_t type, const char *pin)
+{
+    uint8_t payload[5 + ESP_ZB_DOOR_LOCK_PIN_MAX_LEN] = {user_id & 0xff, user_id >> 8, status, type, strlen(pin)};
+
+    memcpy(&payload[5], pin, strlen(pin));
+    return cmd_run(ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_PIN_CODE, payload, 5 + strlen(pin));
+}
+
+static uint8_t pin_clear(uint16_t user_id)
+{
+    uint8_t payload[2] = {user_id & 0xff, user_id >> 8};
+
+    return cmd_run(ESP_ZB_ZCL_CMD_DOOR_LOCK_CLEAR_PIN_CODE, payload, sizeof(payload));
+}
+
+static esp_err_t pin_verify(const char *pin, uint16_t *user_id)
+{
+    return esp_zb_door_lock_credential_verify(ESP_ZB_DOOR_LOCK_CREDENTIAL_PIN, (const uint8_t *)pin, strlen(pin), user_id);
+}
+
+static void test_set_code_invalid_field(void)
+{
+    uint8_t type[3] = {1, 0, 0x07};
+    uint8_t status[3] = {1, 0, 0x02};
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_store_init(TEST_USER_NUM));
+    TEST_ASSERT_EQUAL(TEST_RESP_INVALID_FIELD, pin_set(1, 0x02, ESP_ZB_DOOR_LOCK_USER_TYPE_UNRESTRICTED, "1234"));
+    TEST_ASSERT_EQUAL(TEST_RESP_INVALID_FIELD, pin_set(1, ESP_ZB_DOOR_LOCK_USER_STATUS_AVAILABLE,
+                                                       ESP_ZB_DOOR_LOCK_USER_TYPE_UNRESTRICTED, "1234"));
+    TEST_ASSERT_EQUAL(TEST_RESP_INVALID_FIELD, pin_set(1, ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_ENABLED, 0x05, "1234"));
+    TEST_ASSERT_EQUAL(TEST_RESP_INVALID_FIELD, pin_set(1, ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_ENABLED, 0xff, "1234"));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, pin_verify("1234", NULL));
+
+    TEST_ASSERT_EQUAL(TEST_RESP_SUCCESS, pin_set(1, ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_ENABLED,
+                                                 ESP_ZB_DOOR_LOCK_USER_TYPE_UNRESTRICTED, "1234"));
+    TEST_ASSERT_EQUAL(ESP_OK, pin_verify("1234", NULL));
+
+    /* Set User Type and Set User Status validate the value against the other field of the user */
+    TEST_ASSERT_EQUAL(TEST_RESP_INVALID_FIELD, cmd_run(ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_TYPE, type, sizeof(type)));
+    TEST_ASSERT_EQUAL(TEST_RESP_INVALID_FIELD, cmd_run(ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_STATUS, status, sizeof(status)));
+    TEST_ASSERT_EQUAL(ESP_OK, pin_verify("1234", NULL));
+    type[2] = ESP_ZB_DOOR_LOCK_USER_TYPE_NON_ACCESS;
+    TEST_ASSERT_EQUAL(TEST_RESP_SUCCESS, cmd_run(ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_TYPE, type, sizeof(type)));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_ALLOWED, pin_verify("1234", NULL));
+
+    /* an available user stays a failure rather than an invalid field */
+    type[0] = 2;
+    TEST_ASSERT_EQUAL(TEST_RESP_FAILURE, cmd_run(ESP_ZB_ZCL_CMD_DOOR_LOCK_SET_USER_TYPE, type, sizeof(type)));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_store_deinit());
+}
+
+static void test_reserved_type_denied(void)
+{
+    nvs_handle_t handle;
+    uint8_t page[512];
+    size_t size = sizeof(page);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_store_init(TEST_USER_NUM));
+    TEST_ASSERT_EQUAL(TEST_RESP_SUCCESS, pin_set(0, ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_ENABLED,
+                                                 ESP_ZB_DOOR_LOCK_USER_TYPE_MASTER, "0000"));
+    TEST_ASSERT_EQUAL(ESP_OK, pin_verify("0000", NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_store_deinit());
+
+    /* a record written by another firmware holds a type this lock does not know: the status and the type are the first
+     * two bytes of the record */
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_open("zb_door_lock", NVS_READWRITE, &handle));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_get_blob(handle, "user_00", page, &size));
+    page[1] = 0x07;
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_set_blob(handle, "user_00", page, size));
+    nvs_close(handle);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_store_init(TEST_USER_NUM));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_ALLOWED, pin_verify("0000", NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_store_deinit());
+}
+
+/* the users churn through random PIN codes, the index answers as the user table after every change */
+static void test_index_churn(void)
+{
+    char pin[TEST_USER_NUM][12] = {{0}};
+    char code[12];
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_store_init(TEST_USER_NUM));
+    esp_zb_fake_random_seed(7);
+    for (int round = 0; round < 20000; round++) {
+        uint16_t user_id = esp_random() % TEST_USER_NUM;
+
+        if (pin[user_id][0] && esp_random() % 3 == 0) {
+            TEST_ASSERT_EQUAL(TEST_RESP_SUCCESS, pin_clear(user_id));
+            pin[user_id][0] = '\0';
+        } else {
+            bool duplicate = false;
+
+            /* few distinct codes, so their probe sequences collide and cross */
+            snprintf(code, sizeof(code), "%u", (unsigned)(esp_random() % 24));
+            for (int i = 0; i < TEST_USER_NUM; i++) {
+                duplicate |= i != user_id && !strcmp(pin[i], code);
+            }
+            if (pin_set(user_id, ESP_ZB_DOOR_LOCK_USER_STATUS_OCCUPIED_ENABLED, ESP_ZB_DOOR_LOCK_USER_TYPE_UNRESTRICTED,
+                        code) == TEST_RESP_SUCCESS) {
+                TEST_ASSERT(!duplicate);
+                strcpy(pin[user_id], code);
+            } else {
+                TEST_ASSERT(duplicate);
+            }
+        }
+        for (int value = 0; value < 24; value++) {
+            uint16_t owner = 0xffff;
+            int expected = -1;
+
+            snprintf(code, sizeof(code), "%d", value);
+            for (int i = 0; i < TEST_USER_NUM; i++) {
+                expected = !strcmp(pin[i], code) ? i : expected;
+            }
+            if (expected < 0) {
+                TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, pin_verify(code, &owner));
+            } else {
+                TEST_ASSERT_EQUAL(ESP_OK, pin_verify(code, &owner));
+                TEST_ASSERT_EQUAL(expected, owner);
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_door_lock_store_deinit());
+}
+
+int main(void)
+{
+    TEST_RUN(test_set_code_invalid_field);
+    TEST_RUN(test_reserved_type_denied);
+    TEST_RUN(test_index_churn);
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* IAS zone helper tests: the zone status held until the enrollment is sent as soon as the enroll response is
+ * processed, not at the enroll timeout. */
+
+#include <string.h>
+#include "esp_zigbee_ias_zone.h"
+#include "zcl/esp_zigbee_zcl_ias_zone.h"
+#include "esp_zb_fake.h"
+
+#define TEST_ENDPOINT               1
+#define TEST_CIE_ENDPOINT           2
+
+static esp_zb_zcl_attr_t *s_zone_state;
+
+static void zone_attr_add(void)
+{
+    s_zone_state = esp_zb_fake_attr_add(TEST_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_IAS_ZONE, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                        ESP_ZB_ZCL_ATTR_IAS_ZONE_ZONESTATE_ID, 0x30, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, 1);
+    esp_zb_fake_attr_add(TEST_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_IAS_ZONE, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                         ESP_ZB_ZCL_ATTR_IAS_ZONE_ZONESTATUS_ID, 0x19, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, 2);
+    esp_zb_fake_attr_add(TEST_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_IAS_ZONE, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                         ESP_ZB_ZCL_ATTR_IAS_ZONE_ZONEID_ID, 0x20, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, 1);
+}
+
+/* the enroll response of the CIE, the stack applies it once the data indication handlers return */
+static void enroll_resp_deliver(void)
+{
+    zb_apsde_data_indication_t ind = {
+        .src_addr = 0x0000,
+        .clusterid = ESP_ZB_ZCL_CLUSTER_ID_IAS_ZONE,
+        .src_endpoint = TEST_CIE_ENDPOINT,
+        .dst_endpoint = TEST_ENDPOINT,
+    };
+    const uint8_t frame[] = {0x01, 0x42, ESP_ZB_ZCL_CMD_IAS_ZONE_ZONE_ENROLL_RESPONSE_ID, 0x00, 0x05};
+
+    TEST_ASSERT(!esp_zb_fake_af_indication(&ind, frame, sizeof(frame)));
+    *(uint8_t *)s_zone_state->data_p = ESP_ZB_ZCL_IAS_ZONE_ZONESTATE_ENROLLED;
+}
+
+static void test_enroll_flush(void)
+{
+    esp_zb_ias_zone_cfg_t cfg = {
+        .endpoint = TEST_ENDPOINT,
+        .cie_short_addr = 0x0000,
+        .cie_endpoint = TEST_CIE_ENDPOINT,
+        .coalesce_window = 1000,
+    };
+
+    zone_attr_add();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ias_zone_init(&cfg));
+    TEST_ASSERT(esp_zb_fake_af_hook_set());
+    /* the alarm is held while the zone is not enrolled */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ias_zone_status_update(TEST_ENDPOINT, 0x0001));
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_zcl_cmd_count("ias_zone_status_change_notif"));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ias_zone_enroll(TEST_ENDPOINT));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_zcl_cmd_count("ias_zone_enroll"));
+    esp_zb_fake_run(100);
+    enroll_resp_deliver();
+    esp_zb_fake_run_pending();
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_zcl_cmd_count("ias_zone_status_change_notif"));
+    TEST_ASSERT_EQUAL(ESP_ZB_IAS_ZONE_ENROLLED, esp_zb_ias_zone_get_enroll_state(TEST_ENDPOINT));
+    /* the enroll timeout is cancelled, only the coalesce window is left */
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_alarm_count());
+    esp_zb_fake_run(1000);
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ias_zone_deinit(TEST_ENDPOINT));
+    TEST_ASSERT(!esp_zb_fake_af_hook_set());
+}
+
+static void test_other_frames_ignored(void)
+{
+    esp_zb_ias_zone_cfg_t cfg = {
+        .endpoint = TEST_ENDPOINT,
+        .cie_endpoint = TEST_CIE_ENDPOINT,
+    };
+    zb_apsde_data_indication_t ind = {
+        .clusterid = ESP_ZB_ZCL_CLUSTER_ID_IAS_ZONE,
+        .dst_endpoint = TEST_ENDPOINT,
+    };
+    /* a status change notification from a zone to this device, server to client */
+    const uint8_t frame[] = {0x09, 0x10, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00};
+
+    zone_attr_add();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ias_zone_init(&cfg));
+    esp_zb_fake_af_indication(&ind, frame, sizeof(frame));
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ias_zone_deinit(TEST_ENDPOINT));
+}
+
+int main(void)
+{
+    TEST_RUN(test_enroll_flush);
+    TEST_RUN(test_other_frames_ignored);
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Install code store tests: an install code is checked against its CRC and hashed into the link key of the example of
+ * the Zigbee specification, only the pages changed are written to NVS and the devices come back from them, and the
+ * link keys are installed into the key table of the stack in batches, one by one and on an unsecured join. */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_zigbee_ic_store.h"
+#include "esp_zb_fake.h"
+
+#define TEST_RECORD_SIZE            (sizeof(esp_zb_ieee_addr_t) + 1 + 18)
+#define TEST_PAGE_DEVICE_NUM        300
+#define TEST_PROVISION_DEVICE_NUM   100
+#define TEST_KEY_TABLE_SIZE         40
+#define TEST_DEVICE_UPDATE_REJOIN   0x00
+#define TEST_DEVICE_UPDATE_JOIN     0x01
+
+/* the install code of 128 bits with its CRC and the link key derived, Zigbee specification C.6.1 */
+static const uint8_t s_ic[] = {
+    0x83, 0xfe, 0xd3, 0x40, 0x7a, 0x93, 0x97, 0x23, 0xa5, 0xc6, 0x39, 0xb2, 0x69, 0x16, 0xd5, 0x05, 0xc3, 0xb5,
+};
+static const uint8_t s_key[ESP_ZB_IC_STORE_KEY_SIZE] = {
+    0x66, 0xb6, 0x90, 0x09, 0x81, 0xe1, 0xee, 0x3c, 0xa4, 0x20, 0x6b, 0x6b, 0x86, 0x1c, 0x02, 0xbb,
+};
+
+static void ieee_set(esp_zb_ieee_addr_t ieee_addr, uint16_t id)
+{
+    for (uint8_t i = 0; i < sizeof(esp_zb_ieee_addr_t); i++) {
+        ieee_addr[i] = 0xa0 + i;
+    }
+    ieee_addr[0] = id & 0xff;
+    ieee_addr[1] = id >> 8;
+}
+
+/* packed records of the example install code for the devices first_id to first_id + num - 1 */
+static uint8_t *packed_build(uint16_t first_id, uint16_t num)
+{
+    uint8_t *blob = malloc(num * TEST_RECORD_SIZE);
+
+    TEST_ASSERT(blob);
+    for (uint16_t i = 0; i < num; i++) {
+        uint8_t *record = blob + i * TEST_RECORD_SIZE;
+
+        ieee_set(record, first_id + i);
+        record[sizeof(esp_zb_ieee_addr_t)] = ESP_ZB_IC_TYPE_128;
+        memcpy(record + sizeof(esp_zb_ieee_addr_t) + 1, s_ic, sizeof(s_ic));
+    }
+    return blob;
+}
+
+static bool found(uint16_t id)
+{
+    esp_zb_ieee_addr_t ieee_addr;
+    uint8_t key[ESP_ZB_IC_STORE_KEY_SIZE];
+
+    ieee_set(ieee_addr, id);
+    if (esp_zb_ic_store_find(ieee_addr, key) != ESP_OK) {
+        return false;
+    }
+    TEST_ASSERT(!memcmp(key, s_key, sizeof(key)));
+    return true;
+}
+
+static void device_update(uint16_t id, uint8_t status)
+{
+    uint32_t signal[8] = {ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE};
+    esp_zb_app_signal_t signal_s = {.p_app_signal = signal, .esp_err_status = ESP_OK};
+    esp_zb_zdo_signal_device_update_params_t params = {.short_addr = 0x1000 + id, .status = status};
+
+    ieee_set(params.long_addr, id);
+    memcpy(&signal[1], &params, sizeof(params));
+    esp_zb_ic_store_signal_handle(&signal_s);
+}
+
+static void test_hash(void)
+{
+    const char *csv = "id,installcode,mac_address\r\n"
+                      "1,83FED3407A939723A5C639B26916D505C3B5,A7A6A5A4A3A20000\r\n"
+                      "2,NULL,A7A6A5A4A3A20001\r\n"
+                      "\r\n"
+                      "3, 83fed3407a939723a5c639b26916d505c3b5 ,a7a6a5a4a3a20002\n";
+    uint8_t *blob = packed_build(16, 2);
+    uint16_t imported = 0;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_ic_store_import(blob, TEST_RECORD_SIZE, ESP_ZB_IC_STORE_FORMAT_PACKED,
+                                                                     NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_init(8));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_import(blob, TEST_RECORD_SIZE, ESP_ZB_IC_STORE_FORMAT_PACKED, &imported));
+    TEST_ASSERT_EQUAL(1, imported);
+    TEST_ASSERT(found(16));
+    /* the MAC addresses of the CSV are written most significant byte first */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_import((const uint8_t *)csv, strlen(csv), ESP_ZB_IC_STORE_FORMAT_CSV,
+                                                     &imported));
+    TEST_ASSERT_EQUAL(2, imported);
+    TEST_ASSERT(found(0) && !found(1) && found(2));
+    TEST_ASSERT_EQUAL(3, esp_zb_ic_store_get_count());
+    /* a wrong CRC stops the import, the records before it are kept */
+    blob[2 * TEST_RECORD_SIZE - 1] ^= 0x01;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, esp_zb_ic_store_import(blob, 2 * TEST_RECORD_SIZE, ESP_ZB_IC_STORE_FORMAT_PACKED,
+                                                                  &imported));
+    TEST_ASSERT_EQUAL(1, imported);
+    TEST_ASSERT(!found(17));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_ic_store_import(blob, TEST_RECORD_SIZE - 1,
+                                                                  ESP_ZB_IC_STORE_FORMAT_PACKED, &imported));
+    TEST_ASSERT_EQUAL(3, esp_zb_ic_store_get_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_deinit());
+    free(blob);
+}
+
+/* 300 devices take three pages, a change writes its pages and the count only */
+static void test_page(void)
+{
+    uint8_t *blob = packed_build(0, TEST_PAGE_DEVICE_NUM);
+    uint8_t *extra = packed_build(TEST_PAGE_DEVICE_NUM, 1);
+    esp_zb_ieee_addr_t ieee_addr;
+    uint32_t write_count = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_init(TEST_PAGE_DEVICE_NUM));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_import(blob, TEST_PAGE_DEVICE_NUM * TEST_RECORD_SIZE,
+                                                     ESP_ZB_IC_STORE_FORMAT_PACKED, NULL));
+    TEST_ASSERT_EQUAL(4, esp_zb_fake_nvs_write_count());
+    /* the same keys again change nothing */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_import(blob, TEST_PAGE_DEVICE_NUM * TEST_RECORD_SIZE,
+                                                     ESP_ZB_IC_STORE_FORMAT_PACKED, NULL));
+    TEST_ASSERT_EQUAL(4, esp_zb_fake_nvs_write_count());
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_ic_store_import(extra, TEST_RECORD_SIZE, ESP_ZB_IC_STORE_FORMAT_PACKED, NULL));
+    /* the last device fills the hole of the first page */
+    write_count = esp_zb_fake_nvs_write_count();
+    ieee_set(ieee_addr, 5);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_remove(ieee_addr));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_ic_store_remove(ieee_addr));
+    TEST_ASSERT_EQUAL(write_count + 3, esp_zb_fake_nvs_write_count());
+    ieee_set(ieee_addr, TEST_PAGE_DEVICE_NUM - 2);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_remove(ieee_addr));
+    TEST_ASSERT_EQUAL(write_count + 5, esp_zb_fake_nvs_write_count());
+    /* the devices come back from the pages */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_deinit());
+    TEST_ASSERT_EQUAL(0, esp_zb_ic_store_get_count());
+    write_count = esp_zb_fake_nvs_write_count();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_init(TEST_PAGE_DEVICE_NUM));
+    TEST_ASSERT_EQUAL(write_count, esp_zb_fake_nvs_write_count());
+    TEST_ASSERT_EQUAL(TEST_PAGE_DEVICE_NUM - 2, esp_zb_ic_store_get_count());
+    for (uint16_t i = 0; i < TEST_PAGE_DEVICE_NUM; i++) {
+        TEST_ASSERT_EQUAL(i != 5 && i != TEST_PAGE_DEVICE_NUM - 2, found(i));
+    }
+    /* the clear erases the three pages */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_clear());
+    TEST_ASSERT_EQUAL(write_count + 4, esp_zb_fake_nvs_write_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_deinit());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_init(TEST_PAGE_DEVICE_NUM));
+    TEST_ASSERT_EQUAL(0, esp_zb_ic_store_get_count());
+    TEST_ASSERT(!found(0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_deinit());
+    free(extra);
+    free(blob);
+}
+
+static void test_provision(void)
+{
+    uint8_t *blob = packed_build(0, TEST_PROVISION_DEVICE_NUM);
+    esp_zb_ieee_addr_t ieee_addr;
+    uint8_t key[ESP_ZB_IC_STORE_KEY_SIZE];
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_init(TEST_PROVISION_DEVICE_NUM));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_import(blob, TEST_PROVISION_DEVICE_NUM * TEST_RECORD_SIZE,
+                                                     ESP_ZB_IC_STORE_FORMAT_PACKED, NULL));
+    /* the batches stop at the full key table */
+    esp_zb_fake_key_table_size(TEST_KEY_TABLE_SIZE);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_provision_all());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_key_count());
+    esp_zb_fake_run_pending();
+    TEST_ASSERT_EQUAL(TEST_KEY_TABLE_SIZE, esp_zb_fake_key_count());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    ieee_set(ieee_addr, 0);
+    TEST_ASSERT(esp_zb_fake_key_get(ieee_addr, key));
+    TEST_ASSERT(!memcmp(key, s_key, sizeof(key)));
+    /* the key of a device joining is installed once the key table has room */
+    device_update(50, TEST_DEVICE_UPDATE_JOIN);
+    TEST_ASSERT_EQUAL(TEST_KEY_TABLE_SIZE, esp_zb_fake_key_count());
+    esp_zb_fake_key_table_size(0);
+    device_update(50, TEST_DEVICE_UPDATE_JOIN);
+    TEST_ASSERT_EQUAL(TEST_KEY_TABLE_SIZE + 1, esp_zb_fake_key_count());
+    ieee_set(ieee_addr, 50);
+    TEST_ASSERT(esp_zb_fake_key_get(ieee_addr, key));
+    /* a rejoin and an unknown device are left alone */
+    device_update(60, TEST_DEVICE_UPDATE_REJOIN);
+    device_update(TEST_PROVISION_DEVICE_NUM, TEST_DEVICE_UPDATE_JOIN);
+    TEST_ASSERT_EQUAL(TEST_KEY_TABLE_SIZE + 1, esp_zb_fake_key_count());
+    ieee_set(ieee_addr, 61);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_provision(ieee_addr));
+    TEST_ASSERT_EQUAL(TEST_KEY_TABLE_SIZE + 2, esp_zb_fake_key_count());
+    ieee_set(ieee_addr, TEST_PROVISION_DEVICE_NUM);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_ic_store_provision(ieee_addr));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_ic_store_deinit());
+    free(blob);
+}
+
+int main(void)
+{
+    TEST_RUN(test_hash);
+    TEST_RUN(test_page);
+    TEST_RUN(test_provision);
+    return 0;
+}
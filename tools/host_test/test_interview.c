@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Interview engine tests: two devices are interviewed at the same time, the Basic cluster responses are matched to
+ * their device by the source address and the sequence number of the read in flight. */
+
+#include <string.h>
+#include "esp_zigbee_interview.h"
+#include "esp_zigbee_read_attr.h"
+#include "zcl/esp_zigbee_zcl_basic.h"
+#include "esp_zb_fake.h"
+
+#define TEST_LOCAL_ENDPOINT         1
+#define TEST_DEVICE_ENDPOINT        11
+
+static struct {
+    uint32_t count;
+    esp_err_t status[4];
+    esp_zb_interview_device_t device[4];
+} s_done;
+
+static void test_done_cb(esp_err_t status, const esp_zb_interview_device_t *device)
+{
+    s_done.status[s_done.count] = status;
+    s_done.device[s_done.count++] = *device;
+}
+
+/* answer the ZDO requests sent since *next, up to the Basic cluster reads */
+static void zdo_answer(uint32_t *next)
+{
+    for (; *next < esp_zb_fake_zdo_req_count(); (*next)++) {
+        const esp_zb_fake_zdo_req_t *req = esp_zb_fake_zdo_req_get(*next);
+
+        switch (req->cluster_id) {
+        case 0x0002: {
+            esp_zb_af_node_desc_t node_desc = {0};
+            ((esp_zb_zdo_node_desc_callback_t)req->cb)(ESP_ZB_ZDP_STATUS_SUCCESS, req->dst_addr, &node_desc, req->user_ctx);
+            break;
+        }
+        case 0x0005: {
+            uint8_t ep = TEST_DEVICE_ENDPOINT;
+            ((esp_zb_zdo_active_ep_callback_t)req->cb)(ESP_ZB_ZDP_STATUS_SUCCESS, 1, &ep, req->user_ctx);
+            break;
+        }
+        case 0x0004: {
+            esp_zb_af_simple_desc_1_1_t simple_desc = {
+                .endpoint = TEST_DEVICE_ENDPOINT,
+                .app_profile_id = 0x0104,
+                .app_input_cluster_count = 1,
+                .app_cluster_list = {ESP_ZB_ZCL_CLUSTER_ID_BASIC},
+            };
+            ((esp_zb_zdo_simple_desc_callback_t)req->cb)(ESP_ZB_ZDP_STATUS_SUCCESS, &simple_desc, req->user_ctx);
+            break;
+        }
+        default:
+            TEST_ASSERT(false);
+        }
+    }
+}
+
+static void basic_resp(uint16_t src_addr, uint8_t tsn, uint16_t attr_id, uint8_t attr_type, const void *value, uint8_t size)
+{
+    zb_apsde_data_indication_t ind = {
+        .src_addr = src_addr,
+        .clusterid = ESP_ZB_ZCL_CLUSTER_ID_BASIC,
+        .src_endpoint = TEST_DEVICE_ENDPOINT,
+        .dst_endpoint = TEST_LOCAL_ENDPOINT,
+    };
+    uint8_t frame[64];
+    uint8_t len = esp_zb_fake_read_attr_resp_build(frame, tsn, attr_id, attr_type, value, size);
+
+    esp_zb_fake_af_indication(&ind, frame, len);
+}
+
+static void test_basic_concurrent(void)
+{
+    esp_zb_interview_cfg_t cfg = {
+        .src_endpoint = TEST_LOCAL_ENDPOINT,
+        .concurrency = 2,
+        .max_retry = 1,
+        .done_cb = test_done_cb,
+    };
+    esp_zb_ieee_addr_t ieee_a = {1, 2, 3, 4, 5, 6, 7, 0xa};
+    esp_zb_ieee_addr_t ieee_b = {1, 2, 3, 4, 5, 6, 7, 0xb};
+    const uint8_t name_a[] = {3, 'A', 'a', 'a'};
+    const uint8_t name_b[] = {2, 'B', 'b'};
+    const uint8_t model[] = {1, 'M'};
+    uint8_t version = 7;
+    uint8_t power = 1;
+    uint8_t tsn_a = 0;
+    uint8_t tsn_b = 0;
+    uint32_t next = 0;
+
+    memset(&s_done, 0, sizeof(s_done));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_interview_init(&cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_interview_start(0xaaaa, ieee_a, 0x8e));
+    /* a Basic response from the device before its Basic step is ignored */
+    basic_resp(0xaaaa, 0, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, 0x42, name_b, sizeof(name_b));
+    zdo_answer(&next);
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_read_attr_count());
+    esp_zb_fake_read_attr_last(&tsn_a);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_interview_start(0xbbbb, ieee_b, 0x8e));
+    zdo_answer(&next);
+    /* both devices read their Basic cluster at the same time */
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_read_attr_count());
+    TEST_ASSERT_EQUAL(0xbbbb, esp_zb_fake_read_attr_last(&tsn_b)->zcl_basic_cmd.dst_addr_u.addr_short);
+    TEST_ASSERT(tsn_a != tsn_b);
+    /* the response of one device with the sequence number of the other one is ignored */
+    basic_resp(0xbbbb, tsn_a, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, 0x42, name_b, sizeof(name_b));
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_read_attr_count());
+    basic_resp(0xbbbb, tsn_b, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, 0x42, name_b, sizeof(name_b));
+    esp_zb_fake_read_attr_last(&tsn_b);
+    basic_resp(0xaaaa, tsn_a, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, 0x42, name_a, sizeof(name_a));
+    esp_zb_fake_read_attr_last(&tsn_a);
+    TEST_ASSERT_EQUAL(4, esp_zb_fake_read_attr_count());
+    /* the remaining attributes of both devices */
+    for (int i = 0; i < 3; i++) {
+        static const uint16_t attr_id[] = {ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID, ESP_ZB_ZCL_ATTR_BASIC_APPLICATION_VERSION_ID,
+                                           ESP_ZB_ZCL_ATTR_BASIC_POWER_SOURCE_ID
+                                          };
+        static const uint8_t attr_type[] = {0x42, 0x20, 0x30};
+        const void *value[] = {model, &version, &power};
+        uint8_t size[] = {sizeof(model), 1, 1};
+
+        basic_resp(0xaaaa, tsn_a, attr_id[i], attr_type[i], value[i], size[i]);
+        esp_zb_fake_read_attr_last(&tsn_a);
+        basic_resp(0xbbbb, tsn_b, attr_id[i], attr_type[i], value[i], size[i]);
+        esp_zb_fake_read_attr_last(&tsn_b);
+    }
+    TEST_ASSERT_EQUAL(2, s_done.count);
+    TEST_ASSERT_EQUAL(ESP_OK, s_done.status[0]);
+    TEST_ASSERT_EQUAL(ESP_OK, s_done.status[1]);
+    TEST_ASSERT_EQUAL(0xaaaa, s_done.device[0].short_addr);
+    TEST_ASSERT(!strcmp("Aaa", s_done.device[0].manufacturer_name));
+    TEST_ASSERT(!strcmp("Bb", s_done.device[1].manufacturer_name));
+    TEST_ASSERT(!strcmp("M", s_done.device[1].model_id));
+    TEST_ASSERT_EQUAL(7, s_done.device[1].app_version);
+    TEST_ASSERT_EQUAL(1, s_done.device[0].power_source);
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_interview_deinit());
+    TEST_ASSERT(!esp_zb_fake_af_hook_set());
+}
+
+static void test_basic_timeout(void)
+{
+    esp_zb_interview_cfg_t cfg = {
+        .src_endpoint = TEST_LOCAL_ENDPOINT,
+        .concurrency = 1,
+        .max_retry = 1,
+        .step_timeout = 1000,
+        .done_cb = test_done_cb,
+    };
+    esp_zb_ieee_addr_t ieee = {1, 2, 3, 4, 5, 6, 7, 8};
+    const uint8_t name[] = {1, 'X'};
+    uint8_t tsn = 0;
+    uint32_t next = 0;
+
+    memset(&s_done, 0, sizeof(s_done));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_interview_init(&cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_interview_start(0x1111, ieee, 0x8e));
+    zdo_answer(&next);
+    esp_zb_fake_read_attr_last(&tsn);
+    /* the request is resent once, a late response to the first one is stale */
+    esp_zb_fake_run(1000);
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_read_attr_count());
+    basic_resp(0x1111, tsn, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, 0x42, name, sizeof(name));
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_read_attr_count());
+    esp_zb_fake_run(1000);
+    TEST_ASSERT_EQUAL(1, s_done.count);
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, s_done.status[0]);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_interview_deinit());
+}
+
+int main(void)
+{
+    TEST_RUN(test_basic_concurrent);
+    TEST_RUN(test_basic_timeout);
+    return 0;
+}
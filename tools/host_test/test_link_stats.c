@@ -0,0 +1,210 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Link statistics tests: the frames received are accounted to their last hop through the data indication handlers,
+ * alongside the other handlers, the frames sent from their APS confirm, the route failures from the NLME status
+ * indications, and the request latency is matched to the response by its sequence number. */
+
+#include "esp_zigbee_af_indication.h"
+#include "esp_zigbee_link_stats.h"
+#include "zboss_api.h"
+#include "esp_zb_fake.h"
+
+#define TEST_NODE_ADDR              0x1234
+#define TEST_PARENT_ADDR            0x0001
+#define TEST_PROFILE_ID             0x0104
+#define TEST_WINDOW_PERIOD          1000
+
+static uint32_t s_other_count;
+
+static bool other_handler(uint8_t bufid)
+{
+    s_other_count++;
+    return false;
+}
+
+/* a ZCL frame from the node through its parent, the sequence number follows the frame control and manufacturer code */
+static void zcl_frame_receive(uint8_t lqi, int8_t rssi, bool manuf_specific, uint8_t tsn)
+{
+    zb_apsde_data_indication_t ind = {
+        .src_addr = TEST_NODE_ADDR, .profileid = TEST_PROFILE_ID, .mac_src_addr = TEST_PARENT_ADDR,
+        .lqi = lqi, .rssi = rssi,
+    };
+    uint8_t payload[6] = {0x18, tsn, 0x0b};
+
+    if (manuf_specific) {
+        payload[0] |= 0x04;
+        payload[1] = 0x34;
+        payload[2] = 0x12;
+        payload[3] = tsn;
+        payload[4] = 0x0b;
+    }
+    TEST_ASSERT(!esp_zb_fake_af_indication(&ind, payload, sizeof(payload)));
+}
+
+static void zdo_frame_receive(uint8_t tsn)
+{
+    zb_apsde_data_indication_t ind = {.src_addr = TEST_NODE_ADDR, .mac_src_addr = TEST_NODE_ADDR, .lqi = 200};
+    uint8_t payload[2] = {tsn, 0x00};
+
+    TEST_ASSERT(!esp_zb_fake_af_indication(&ind, payload, sizeof(payload)));
+}
+
+static void test_rx(void)
+{
+    esp_zb_link_stats_cfg_t cfg = {.window_period = TEST_WINDOW_PERIOD};
+    esp_zb_link_stats_node_t node;
+
+    s_other_count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_af_indication_handler_add(other_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_start(&cfg));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_link_stats_start(&cfg));
+    zcl_frame_receive(100, -60, false, 1);
+    zcl_frame_receive(200, -40, false, 2);
+    /* the handler added before still sees the frames */
+    TEST_ASSERT_EQUAL(2, s_other_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_get(TEST_PARENT_ADDR, &node));
+    TEST_ASSERT_EQUAL(2, node.window[0].rx_count);
+    TEST_ASSERT_EQUAL(150, node.window[0].lqi_avg);
+    TEST_ASSERT_EQUAL(-50, node.window[0].rssi_avg);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_link_stats_get(TEST_NODE_ADDR, &node));
+
+    /* the window rotates, the total keeps the previous one */
+    esp_zb_fake_run(TEST_WINDOW_PERIOD);
+    zcl_frame_receive(50, -80, false, 3);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_get(TEST_PARENT_ADDR, &node));
+    TEST_ASSERT_EQUAL(1, node.window[0].rx_count);
+    TEST_ASSERT_EQUAL(2, node.window[1].rx_count);
+    TEST_ASSERT_EQUAL(3, node.total.rx_count);
+    TEST_ASSERT_EQUAL(116, node.total.lqi_avg);
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+
+    /* the handler of the statistics is removed, the other one stays */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_stop());
+    zcl_frame_receive(50, -80, false, 4);
+    TEST_ASSERT_EQUAL(4, s_other_count);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_link_stats_get(TEST_PARENT_ADDR, &node));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_af_indication_handler_remove(other_handler));
+    TEST_ASSERT(!esp_zb_fake_af_hook_set());
+}
+
+/* the latency runs to the response with the sequence number of the request, not to the next frame of the node */
+static void test_latency(void)
+{
+    esp_zb_link_stats_cfg_t cfg = {0};
+    esp_zb_link_stats_node_t node;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_start(&cfg));
+    esp_zb_link_stats_request_begin(TEST_NODE_ADDR, false, 5);
+    esp_zb_link_stats_request_begin(TEST_NODE_ADDR, false, 6);
+    esp_zb_link_stats_request_begin(TEST_NODE_ADDR, true, 7);
+    esp_zb_fake_run(10);
+    /* a report of the node and a ZDO frame with the sequence number of a ZCL request are not responses */
+    zcl_frame_receive(100, -60, false, 9);
+    zdo_frame_receive(5);
+    esp_zb_fake_run(20);
+    zcl_frame_receive(100, -60, false, 6);
+    esp_zb_fake_run(20);
+    zcl_frame_receive(100, -60, true, 5);
+    esp_zb_fake_run(40);
+    zdo_frame_receive(7);
+    /* a second response is not a new sample */
+    zcl_frame_receive(100, -60, false, 6);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_get(TEST_NODE_ADDR, &node));
+    TEST_ASSERT_EQUAL(3, node.latency_count);
+    TEST_ASSERT_EQUAL(50, node.latency_p50);
+    TEST_ASSERT_EQUAL(90, node.latency_max);
+    /* the requests are not frames sent, their APS confirm accounts them */
+    TEST_ASSERT_EQUAL(0, node.total.tx_count);
+
+    /* the request waiting the longest is given up once the slots are full */
+    for (uint8_t i = 0; i <= ESP_ZB_LINK_STATS_REQUEST_MAX_NUM; i++) {
+        esp_zb_link_stats_request_begin(TEST_NODE_ADDR, false, 20 + i);
+        esp_zb_fake_run(1);
+    }
+    zcl_frame_receive(100, -60, false, 20);
+    zcl_frame_receive(100, -60, false, 21);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_get(TEST_NODE_ADDR, &node));
+    TEST_ASSERT_EQUAL(4, node.latency_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_stop());
+}
+
+static void zcl_frame_send(uint16_t short_addr)
+{
+    zb_bufid_t bufid = zb_buf_get_out();
+    zb_uint8_t *cmd_ptr = ZB_ZCL_START_PACKET(bufid);
+
+    ZB_ZCL_CONSTRUCT_SPECIFIC_COMMAND_RES_FRAME_CONTROL(cmd_ptr);
+    ZB_ZCL_CONSTRUCT_COMMAND_HEADER(cmd_ptr, ZB_ZCL_GET_SEQ_NUM(), 0x00);
+    ZB_ZCL_FINISH_PACKET(bufid, cmd_ptr)
+    ZB_ZCL_SEND_COMMAND_SHORT(bufid, short_addr, ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT, 1, 1, TEST_PROFILE_ID, 0x0006,
+                              esp_zb_link_stats_tx_confirm);
+}
+
+/* the frames sent are accounted when their APS confirm comes back, with its status */
+static void test_tx_confirm(void)
+{
+    esp_zb_link_stats_cfg_t cfg = {0};
+    esp_zb_link_stats_node_t node;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_start(&cfg));
+    zcl_frame_send(TEST_NODE_ADDR);
+    zcl_frame_send(TEST_NODE_ADDR);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_link_stats_get(TEST_NODE_ADDR, &node));
+    esp_zb_fake_run_pending();
+    esp_zb_fake_zcl_send_fail(true);
+    zcl_frame_send(TEST_NODE_ADDR);
+    esp_zb_fake_run_pending();
+    esp_zb_fake_zcl_send_fail(false);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_get(TEST_NODE_ADDR, &node));
+    TEST_ASSERT_EQUAL(3, node.total.tx_count);
+    TEST_ASSERT_EQUAL(1, node.total.tx_fail_count);
+    /* the confirmation frees the buffer */
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+
+    esp_zb_link_stats_tx_record(TEST_NODE_ADDR, false, 3);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_get(TEST_NODE_ADDR, &node));
+    TEST_ASSERT_EQUAL(4, node.total.tx_count);
+    TEST_ASSERT_EQUAL(2, node.total.tx_fail_count);
+    TEST_ASSERT_EQUAL(3, node.total.retry_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_stop());
+}
+
+/* a route failure is not a frame sent and failed */
+static void test_route_failure(void)
+{
+    struct {
+        uint32_t signal;
+        zb_zdo_signal_nlme_status_indication_params_t params;
+    } nlme = {
+        .signal = ESP_ZB_NLME_STATUS_INDICATION,
+        .params.nlme_status = {.status = 0x01, .network_addr = TEST_NODE_ADDR},
+    };
+    esp_zb_app_signal_t signal_s = {.p_app_signal = &nlme.signal};
+    esp_zb_link_stats_cfg_t cfg = {0};
+    esp_zb_link_stats_node_t node;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_start(&cfg));
+    esp_zb_link_stats_signal_handle(&signal_s);
+    /* not a route failure */
+    nlme.params.nlme_status.status = 0x10;
+    esp_zb_link_stats_signal_handle(&signal_s);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_get(TEST_NODE_ADDR, &node));
+    TEST_ASSERT_EQUAL(1, node.total.route_fail_count);
+    TEST_ASSERT_EQUAL(0, node.total.tx_fail_count);
+    esp_zb_link_stats_dump();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_link_stats_stop());
+}
+
+int main(void)
+{
+    TEST_RUN(test_rx);
+    TEST_RUN(test_latency);
+    TEST_RUN(test_tx_confirm);
+    TEST_RUN(test_route_failure);
+    return 0;
+}
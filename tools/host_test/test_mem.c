@@ -0,0 +1,191 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Memory accounting tests: the blocks are accounted to their tag through the block table, which grows, shrinks and
+ * drops its entries in any order, an entry left by free() is taken over, a block from elsewhere is handed to the heap
+ * without its memory being read, which the address sanitizer checks, and the failures are counted. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_zigbee_mem.h"
+#include "esp_zb_fake.h"
+
+#define TEST_BLOCK_NUM              1000
+#define TEST_REUSE_TRY_NUM          64
+
+/* the heap of the sanitizer gives a freed address again only without its quarantine */
+const char *__asan_default_options(void)
+{
+    return "quarantine_size_mb=0:thread_local_quarantine_size_kb=0";
+}
+
+static esp_zb_mem_stats_t stats_get(esp_zb_mem_tag_t tag)
+{
+    esp_zb_mem_stats_t stats;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_mem_stats_get(tag, &stats));
+    return stats;
+}
+
+static void test_tag(void)
+{
+    uint8_t *nwk = esp_zb_mem_malloc(ESP_ZB_MEM_TAG_NWK, 100);
+    uint32_t *zcl = esp_zb_mem_calloc(ESP_ZB_MEM_TAG_ZCL, 10, sizeof(uint32_t));
+    uint8_t *app = esp_zb_mem_malloc(ESP_ZB_MEM_TAG_MAX, 0);
+
+    TEST_ASSERT(nwk && zcl && app);
+    for (uint8_t i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL(0, zcl[i]);
+    }
+    TEST_ASSERT_EQUAL(100, stats_get(ESP_ZB_MEM_TAG_NWK).current);
+    TEST_ASSERT_EQUAL(40, stats_get(ESP_ZB_MEM_TAG_ZCL).current);
+    /* an invalid tag falls back to the application one */
+    TEST_ASSERT_EQUAL(1, stats_get(ESP_ZB_MEM_TAG_APP).block_count);
+    esp_zb_mem_free(nwk);
+    esp_zb_mem_free(zcl);
+    esp_zb_mem_free(app);
+    esp_zb_mem_free(NULL);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_NWK).current);
+    TEST_ASSERT_EQUAL(100, stats_get(ESP_ZB_MEM_TAG_NWK).peak);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_ZCL).block_count);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_APP).block_count);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_mem_stats_get(ESP_ZB_MEM_TAG_MAX, NULL));
+    TEST_ASSERT(!strcmp("nwk", esp_zb_mem_tag_to_name(ESP_ZB_MEM_TAG_NWK)));
+}
+
+static void test_realloc(void)
+{
+    uint8_t *block = esp_zb_mem_realloc(ESP_ZB_MEM_TAG_ZDO, NULL, 16);
+
+    TEST_ASSERT(block);
+    memset(block, 0xa5, 16);
+    /* the block keeps the tag it was allocated with */
+    block = esp_zb_mem_realloc(ESP_ZB_MEM_TAG_APP, block, 4096);
+    TEST_ASSERT(block);
+    TEST_ASSERT_EQUAL(0xa5, block[15]);
+    TEST_ASSERT_EQUAL(4096, stats_get(ESP_ZB_MEM_TAG_ZDO).current);
+    TEST_ASSERT_EQUAL(1, stats_get(ESP_ZB_MEM_TAG_ZDO).block_count);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_APP).block_count);
+    block = esp_zb_mem_realloc(ESP_ZB_MEM_TAG_ZDO, block, 8);
+    TEST_ASSERT_EQUAL(8, stats_get(ESP_ZB_MEM_TAG_ZDO).current);
+    TEST_ASSERT_EQUAL(4096, stats_get(ESP_ZB_MEM_TAG_ZDO).peak);
+    /* a resize which fails leaves the block as it is */
+    TEST_ASSERT(!esp_zb_mem_realloc(ESP_ZB_MEM_TAG_ZDO, block, SIZE_MAX));
+    TEST_ASSERT_EQUAL(8, stats_get(ESP_ZB_MEM_TAG_ZDO).current);
+    TEST_ASSERT_EQUAL(1, stats_get(ESP_ZB_MEM_TAG_ZDO).fail_count);
+    TEST_ASSERT(!esp_zb_mem_realloc(ESP_ZB_MEM_TAG_ZDO, block, 0));
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_ZDO).current);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_ZDO).block_count);
+}
+
+/* the bytes in front of a block from elsewhere belong to the heap, reading them is an overflow for the sanitizer */
+static void test_foreign(void)
+{
+    uint8_t *block = malloc(16);
+
+    TEST_ASSERT(block);
+    block = esp_zb_mem_realloc(ESP_ZB_MEM_TAG_CORE, block, 32);
+    TEST_ASSERT(block);
+    esp_zb_mem_free(block);
+    for (uint8_t i = 0; i < ESP_ZB_MEM_TAG_MAX; i++) {
+        TEST_ASSERT_EQUAL(0, stats_get(i).block_count);
+        TEST_ASSERT_EQUAL(0, stats_get(i).current);
+    }
+}
+
+/* the table grows from its first size and drops the entries in an order unrelated to their slots */
+static void test_table(void)
+{
+    static void *block[TEST_BLOCK_NUM];
+    uint32_t current = 0;
+
+    for (uint32_t i = 0; i < TEST_BLOCK_NUM; i++) {
+        block[i] = esp_zb_mem_malloc(i % ESP_ZB_MEM_TAG_MAX, i % 64 + 1);
+        TEST_ASSERT(block[i]);
+        if (i % ESP_ZB_MEM_TAG_MAX == ESP_ZB_MEM_TAG_NWK) {
+            current += i % 64 + 1;
+        }
+    }
+    TEST_ASSERT_EQUAL(TEST_BLOCK_NUM / ESP_ZB_MEM_TAG_MAX, stats_get(ESP_ZB_MEM_TAG_NWK).block_count);
+    TEST_ASSERT_EQUAL(current, stats_get(ESP_ZB_MEM_TAG_NWK).current);
+    for (uint32_t i = 0; i < TEST_BLOCK_NUM; i += 3) {
+        esp_zb_mem_free(block[i]);
+        block[i] = NULL;
+    }
+    /* the blocks left are still found with their size */
+    for (uint32_t i = 0; i < TEST_BLOCK_NUM; i++) {
+        if (block[i]) {
+            block[i] = esp_zb_mem_realloc(ESP_ZB_MEM_TAG_APP, block[i], 128);
+            TEST_ASSERT(block[i]);
+        }
+    }
+    TEST_ASSERT_EQUAL(128 * stats_get(ESP_ZB_MEM_TAG_NWK).block_count, stats_get(ESP_ZB_MEM_TAG_NWK).current);
+    for (uint32_t i = TEST_BLOCK_NUM; i > 0; i--) {
+        esp_zb_mem_free(block[i - 1]);
+    }
+    for (uint8_t i = 0; i < ESP_ZB_MEM_TAG_MAX; i++) {
+        TEST_ASSERT_EQUAL(0, stats_get(i).block_count);
+        TEST_ASSERT_EQUAL(0, stats_get(i).current);
+    }
+}
+
+/* a block freed by free() leaves its entry, the allocation which gets its address again takes the entry over */
+static void test_stale(void)
+{
+    void *block[TEST_REUSE_TRY_NUM] = {NULL};
+    uint8_t *stale = esp_zb_mem_malloc(ESP_ZB_MEM_TAG_ZCL, 48);
+    uint8_t i = 0;
+
+    TEST_ASSERT(stale);
+    free(stale);
+    TEST_ASSERT_EQUAL(1, stats_get(ESP_ZB_MEM_TAG_ZCL).block_count);
+    for (i = 0; i < TEST_REUSE_TRY_NUM; i++) {
+        block[i] = esp_zb_mem_malloc(ESP_ZB_MEM_TAG_NWK, 48);
+        TEST_ASSERT(block[i]);
+        if (block[i] == stale) {
+            break;
+        }
+    }
+    TEST_ASSERT(i < TEST_REUSE_TRY_NUM);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_ZCL).block_count);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_ZCL).current);
+    TEST_ASSERT_EQUAL(i + 1, stats_get(ESP_ZB_MEM_TAG_NWK).block_count);
+    TEST_ASSERT_EQUAL(48 * (i + 1), stats_get(ESP_ZB_MEM_TAG_NWK).current);
+    for (uint8_t j = 0; j <= i; j++) {
+        esp_zb_mem_free(block[j]);
+    }
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_NWK).block_count);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_NWK).current);
+}
+
+static void test_fail(void)
+{
+    uint8_t *block = NULL;
+
+    /* the peaks start from the blocks allocated now */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_mem_stats_reset());
+    block = esp_zb_mem_malloc(ESP_ZB_MEM_TAG_OTA, 64);
+    TEST_ASSERT(!esp_zb_mem_malloc(ESP_ZB_MEM_TAG_OTA, SIZE_MAX));
+    TEST_ASSERT(!esp_zb_mem_calloc(ESP_ZB_MEM_TAG_OTA, SIZE_MAX / 2, 4));
+    TEST_ASSERT_EQUAL(2, stats_get(ESP_ZB_MEM_TAG_OTA).fail_count);
+    esp_zb_mem_free(block);
+    TEST_ASSERT_EQUAL(64, stats_get(ESP_ZB_MEM_TAG_OTA).peak);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_mem_stats_reset());
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_OTA).peak);
+    TEST_ASSERT_EQUAL(0, stats_get(ESP_ZB_MEM_TAG_OTA).fail_count);
+    esp_zb_mem_stats_dump();
+}
+
+int main(void)
+{
+    TEST_RUN(test_tag);
+    TEST_RUN(test_realloc);
+    TEST_RUN(test_foreign);
+    TEST_RUN(test_table);
+    TEST_RUN(test_stale);
+    TEST_RUN(test_fail);
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Poll control tests: the writes of the Check-in Interval and Fast Poll Timeout attributes are checked against the
+ * limits of the cluster and applied to the poller, and a check-in without buffer is retried. */
+
+#include <string.h>
+#include "esp_zigbee_poll_control.h"
+#include "esp_zb_fake.h"
+
+#define TEST_ENDPOINT               1
+#define TEST_QS_TO_MS(qs)           ((uint32_t)(qs) * 250)
+
+static const esp_zb_poll_control_cfg_t s_cfg = {
+    .endpoint = TEST_ENDPOINT,
+    .check_in_interval = 240,               /* 1 minute */
+    .long_poll_interval = 20,
+    .short_poll_interval = 2,
+    .fast_poll_timeout = 40,
+    .fast_poll_timeout_max = 120,
+};
+
+static esp_zb_zcl_attr_t *s_check_in_attr;
+static esp_zb_zcl_attr_t *s_fast_poll_attr;
+
+static void poll_control_init(void)
+{
+    s_check_in_attr = esp_zb_fake_attr_add(TEST_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_POLL_CONTROL, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                           ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_ID, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                           ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, 4);
+    s_fast_poll_attr = esp_zb_fake_attr_add(TEST_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_POLL_CONTROL, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                            ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_ID, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, 2);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_poll_control_init(&s_cfg));
+}
+
+static esp_err_t check_in_interval_write(uint32_t interval)
+{
+    uint8_t value[4] = {interval & 0xff, (interval >> 8) & 0xff, (interval >> 16) & 0xff, interval >> 24};
+
+    return esp_zb_poll_control_attr_write_handle(ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_ID, value, sizeof(value));
+}
+
+static esp_err_t fast_poll_timeout_write(uint16_t timeout)
+{
+    uint8_t value[2] = {timeout & 0xff, timeout >> 8};
+
+    return esp_zb_poll_control_attr_write_handle(ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_ID, value, sizeof(value));
+}
+
+static void test_check_in_interval_write(void)
+{
+    uint32_t value = 0;
+
+    poll_control_init();
+    /* shorter than the long poll interval, then above the maximum of the cluster */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, check_in_interval_write(s_cfg.long_poll_interval - 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, check_in_interval_write(ESP_ZB_ZCL_POLL_CONTROL_INTERVAL_MAX_VALUE + 1));
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_attr_write_count());
+
+    /* the new interval is written and the next check-in follows it from now on */
+    esp_zb_fake_run(TEST_QS_TO_MS(s_cfg.check_in_interval) / 2);
+    TEST_ASSERT_EQUAL(ESP_OK, check_in_interval_write(480));
+    memcpy(&value, s_check_in_attr->data_p, sizeof(value));
+    TEST_ASSERT_EQUAL(480, value);
+    esp_zb_fake_run(TEST_QS_TO_MS(s_cfg.check_in_interval));
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_zcl_send_count());
+    esp_zb_fake_run(TEST_QS_TO_MS(480) - TEST_QS_TO_MS(s_cfg.check_in_interval));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_zcl_send_count());
+
+    /* 0 disables the check-in */
+    TEST_ASSERT_EQUAL(ESP_OK, check_in_interval_write(0));
+    esp_zb_fake_run(TEST_QS_TO_MS(ESP_ZB_ZCL_POLL_CONTROL_CHECK_IN_INTERVAL_DEFAULT_VALUE));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_zcl_send_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_poll_control_deinit());
+}
+
+static void test_fast_poll_timeout_write(void)
+{
+    esp_zb_poll_control_stats_t stats;
+    uint16_t value = 0;
+
+    poll_control_init();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, fast_poll_timeout_write(0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, fast_poll_timeout_write(s_cfg.fast_poll_timeout_max + 1));
+    TEST_ASSERT_EQUAL(ESP_OK, fast_poll_timeout_write(8));
+    memcpy(&value, s_fast_poll_attr->data_p, sizeof(value));
+    TEST_ASSERT_EQUAL(8, value);
+
+    /* a fast poll without timeout lasts the new Fast Poll Timeout */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_poll_control_fast_poll_start(0));
+    TEST_ASSERT_EQUAL(TEST_QS_TO_MS(s_cfg.short_poll_interval), esp_zb_fake_long_poll_interval());
+    esp_zb_fake_run(TEST_QS_TO_MS(8) - 1);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_poll_control_get_stats(&stats));
+    TEST_ASSERT(stats.fast_poll);
+    esp_zb_fake_run(1);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_poll_control_get_stats(&stats));
+    TEST_ASSERT(!stats.fast_poll);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_poll_control_deinit());
+}
+
+static void test_attr_write_rejected(void)
+{
+    uint8_t value[4] = {0};
+
+    poll_control_init();
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_ALLOWED, esp_zb_poll_control_attr_write_handle(ESP_ZB_ZCL_ATTR_POLL_CONTROL_LONG_POLL_INTERVAL_ID,
+                                                                                 value, 4));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_ALLOWED, esp_zb_poll_control_attr_write_handle(ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_MAX_ID,
+                                                                                 value, 2));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_zb_poll_control_attr_write_handle(0x0100, value, 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_zb_poll_control_attr_write_handle(ESP_ZB_ZCL_ATTR_POLL_CONTROL_CHECK_IN_INTERVAL_ID,
+                                                                                  value, 2));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_zb_poll_control_attr_write_handle(ESP_ZB_ZCL_ATTR_POLL_CONTROL_FAST_POLL_TIMEOUT_ID,
+                                                                                  value, 4));
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_attr_write_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_poll_control_deinit());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, check_in_interval_write(480));
+}
+
+/* the buffer pool is empty at the check-in, it is retried once a buffer is back */
+static void test_check_in_no_buffer(void)
+{
+    poll_control_init();
+    esp_zb_fake_buf_exhaust(true);
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_poll_control_check_in());
+    esp_zb_fake_run(TEST_QS_TO_MS(s_cfg.check_in_interval));
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_zcl_send_count());
+    esp_zb_fake_buf_exhaust(false);
+    esp_zb_fake_run(1000);
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_zcl_send_count());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_poll_control_deinit());
+}
+
+/* the cluster holds the seven server attributes, an invalid configuration creates none */
+static void test_cluster_create(void)
+{
+    esp_zb_poll_control_cfg_t cfg = s_cfg;
+    esp_zb_attribute_list_t *attr_list = esp_zb_poll_control_cluster_create(&cfg);
+    uint32_t count = 0;
+
+    TEST_ASSERT(attr_list);
+    for (esp_zb_attribute_list_t *node = attr_list->next; node; node = node->next) {
+        TEST_ASSERT_EQUAL(ESP_ZB_ZCL_CLUSTER_ID_POLL_CONTROL, node->cluster_id);
+        count++;
+    }
+    TEST_ASSERT_EQUAL(7, count);
+    cfg.check_in_interval = cfg.long_poll_interval - 1;
+    TEST_ASSERT(!esp_zb_poll_control_cluster_create(&cfg));
+}
+
+int main(void)
+{
+    TEST_RUN(test_cluster_create);
+    TEST_RUN(test_check_in_interval_write);
+    TEST_RUN(test_fast_poll_timeout_write);
+    TEST_RUN(test_attr_write_rejected);
+    TEST_RUN(test_check_in_no_buffer);
+    return 0;
+}
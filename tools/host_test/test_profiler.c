@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Profiler tests: runs of known lengths on the simulated clock land in the expected histogram buckets and entries,
+ * the long ones are counted as stalls, and the alarm callbacks are measured with their lateness. */
+
+#include "esp_zigbee_alarm.h"
+#include "esp_zigbee_profiler.h"
+#include "esp_zb_fake.h"
+
+#define TEST_SIGNAL_ID              0x17
+
+static void run_measure(esp_zb_profiler_type_t type, uintptr_t id, uint32_t time_ms)
+{
+    int64_t start = esp_zb_profiler_begin();
+
+    esp_zb_fake_run(time_ms);
+    esp_zb_profiler_end(type, id, start);
+}
+
+static void test_histogram(void)
+{
+    esp_zb_profiler_cfg_t cfg = {.stall_threshold = 10000};
+    esp_zb_profiler_entry_t entries[4];
+    esp_zb_profiler_stats_t stats;
+    uint8_t entry_num = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_reset());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_start(&cfg));
+    /* 0 us, 1 ms in [512, 1024) us, 2 ms in [1024, 2048) us, 40 ms in the last bucket */
+    run_measure(ESP_ZB_PROFILER_TYPE_SIGNAL, TEST_SIGNAL_ID, 0);
+    run_measure(ESP_ZB_PROFILER_TYPE_SIGNAL, TEST_SIGNAL_ID, 1);
+    run_measure(ESP_ZB_PROFILER_TYPE_SIGNAL, TEST_SIGNAL_ID, 2);
+    run_measure(ESP_ZB_PROFILER_TYPE_LOOP, 0, 40);
+    run_measure(ESP_ZB_PROFILER_TYPE_LOOP, 0, 10);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_get_entries(entries, 4, &entry_num));
+    TEST_ASSERT_EQUAL(2, entry_num);
+    /* the longest cumulative time first */
+    TEST_ASSERT_EQUAL(ESP_ZB_PROFILER_TYPE_LOOP, entries[0].type);
+    TEST_ASSERT_EQUAL(2, entries[0].count);
+    TEST_ASSERT_EQUAL(50000, entries[0].total_time);
+    TEST_ASSERT_EQUAL(40000, entries[0].max_time);
+    TEST_ASSERT_EQUAL(1, entries[0].histogram[ESP_ZB_PROFILER_BUCKET_NUM - 1]);
+    TEST_ASSERT_EQUAL(1, entries[0].histogram[9]);
+    TEST_ASSERT_EQUAL(ESP_ZB_PROFILER_TYPE_SIGNAL, entries[1].type);
+    TEST_ASSERT_EQUAL(TEST_SIGNAL_ID, entries[1].id);
+    TEST_ASSERT_EQUAL(3, entries[1].count);
+    TEST_ASSERT_EQUAL(3000, entries[1].total_time);
+    TEST_ASSERT_EQUAL(1, entries[1].histogram[0]);
+    TEST_ASSERT_EQUAL(1, entries[1].histogram[5]);
+    TEST_ASSERT_EQUAL(1, entries[1].histogram[6]);
+
+    /* the runs from the threshold on are stalls */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_get_stats(&stats));
+    TEST_ASSERT_EQUAL(2, stats.stall_count);
+    TEST_ASSERT_EQUAL(0, stats.drop_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_stop());
+}
+
+static void test_entry_table_full(void)
+{
+    esp_zb_profiler_cfg_t cfg = {0};
+    esp_zb_profiler_stats_t stats;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_reset());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_start(&cfg));
+    for (uintptr_t id = 0; id <= ESP_ZB_PROFILER_ENTRY_MAX_NUM; id++) {
+        run_measure(ESP_ZB_PROFILER_TYPE_CALLBACK, id, 1);
+    }
+    /* a tracked entry is still accounted once the table is full */
+    run_measure(ESP_ZB_PROFILER_TYPE_CALLBACK, 0, 1);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_get_stats(&stats));
+    TEST_ASSERT_EQUAL(ESP_ZB_PROFILER_ENTRY_MAX_NUM, stats.entry_num);
+    TEST_ASSERT_EQUAL(1, stats.drop_count);
+    TEST_ASSERT_EQUAL(0, stats.stall_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_stop());
+}
+
+/* a stopped profiler measures nothing and keeps its profiles until reset */
+static void test_stopped(void)
+{
+    esp_zb_profiler_cfg_t cfg = {0};
+    esp_zb_profiler_stats_t stats;
+    int64_t start = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_reset());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_start(&cfg));
+    start = esp_zb_profiler_begin();
+    TEST_ASSERT(start);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_stop());
+    esp_zb_profiler_end(ESP_ZB_PROFILER_TYPE_CALLBACK, 1, start);
+    TEST_ASSERT_EQUAL(0, esp_zb_profiler_begin());
+    run_measure(ESP_ZB_PROFILER_TYPE_CALLBACK, 1, 1);
+    esp_zb_profiler_lateness_record(100);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.entry_num);
+    TEST_ASSERT_EQUAL(0, stats.lateness_count);
+    TEST_ASSERT(!stats.running);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_start(&cfg));
+    run_measure(ESP_ZB_PROFILER_TYPE_CALLBACK, 1, 1);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_stop());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_get_stats(&stats));
+    TEST_ASSERT_EQUAL(1, stats.entry_num);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_reset());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_get_stats(&stats));
+    TEST_ASSERT_EQUAL(0, stats.entry_num);
+}
+
+static uint32_t s_alarm_count;
+
+static void busy_alarm_cb(esp_zb_alarm_handle_t handle, void *ctx)
+{
+    s_alarm_count++;
+}
+
+/* the alarm callbacks are accounted under their address, with the lateness of each expiry */
+static void test_alarm_lateness(void)
+{
+    esp_zb_profiler_cfg_t cfg = {0};
+    esp_zb_profiler_entry_t entry;
+    esp_zb_profiler_stats_t stats;
+    uint8_t entry_num = 0;
+
+    s_alarm_count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_reset());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_start(&cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_init(4));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_start(busy_alarm_cb, NULL, 5, 100, NULL));
+    esp_zb_fake_run(1000);
+    TEST_ASSERT_EQUAL(10, s_alarm_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_get_entries(&entry, 1, &entry_num));
+    TEST_ASSERT_EQUAL(1, entry_num);
+    TEST_ASSERT_EQUAL(ESP_ZB_PROFILER_TYPE_ALARM, entry.type);
+    TEST_ASSERT_EQUAL((uintptr_t)busy_alarm_cb, entry.id);
+    TEST_ASSERT_EQUAL(10, entry.count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_get_stats(&stats));
+    TEST_ASSERT_EQUAL(10, stats.lateness_count);
+    /* the lateness counts from the tick of the expiry, which the simulated stack runs right on time */
+    TEST_ASSERT_EQUAL(10, stats.lateness_histogram[0]);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_alarm_deinit());
+    esp_zb_profiler_dump();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_profiler_stop());
+}
+
+int main(void)
+{
+    TEST_RUN(test_histogram);
+    TEST_RUN(test_entry_table_full);
+    TEST_RUN(test_stopped);
+    TEST_RUN(test_alarm_lateness);
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Read attribute response dispatcher tests: the responses are parsed from the data indications for every handler, and
+ * the time client only takes the response of its server to the request in flight. */
+
+#include <string.h>
+#include "esp_zigbee_af_indication.h"
+#include "esp_zigbee_read_attr.h"
+#include "esp_zigbee_time.h"
+#include "zcl/esp_zigbee_zcl_time.h"
+#include "esp_zb_fake.h"
+
+#define TEST_SERVER_ADDR            0x1234
+#define TEST_SERVER_ENDPOINT        1
+#define TEST_CLIENT_ENDPOINT        10
+
+static struct {
+    uint32_t count;
+    esp_zb_read_attr_resp_info_t info;
+    uint16_t attr_id;
+    uint32_t value;
+    bool remove_self;
+} s_handler;
+
+static struct {
+    uint32_t count;
+    esp_err_t status;
+    uint32_t utc;
+} s_sync;
+
+static void test_handler(const esp_zb_read_attr_resp_info_t *info, esp_zb_zcl_status_t status, uint16_t attr_id,
+                         esp_zb_zcl_attr_type_t attr_type, const void *value)
+{
+    s_handler.count++;
+    s_handler.info = *info;
+    s_handler.attr_id = attr_id;
+    if (value) {
+        memcpy(&s_handler.value, value, sizeof(uint32_t));
+    }
+    if (s_handler.remove_self) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_zb_read_attr_handler_remove(test_handler));
+    }
+}
+
+static void test_sync_cb(esp_err_t status, uint32_t utc)
+{
+    s_sync.count++;
+    s_sync.status = status;
+    s_sync.utc = utc;
+}
+
+static void resp_deliver(uint16_t src_addr, uint16_t cluster_id, uint8_t tsn, uint16_t attr_id, uint8_t attr_type,
+                         const void *value, uint8_t size)
+{
+    zb_apsde_data_indication_t ind = {
+        .src_addr = src_addr,
+        .clusterid = cluster_id,
+        .profileid = 0x0104,
+        .src_endpoint = TEST_SERVER_ENDPOINT,
+        .dst_endpoint = TEST_CLIENT_ENDPOINT,
+    };
+    uint8_t frame[64];
+    uint8_t len = esp_zb_fake_read_attr_resp_build(frame, tsn, attr_id, attr_type, value, size);
+
+    TEST_ASSERT(!esp_zb_fake_af_indication(&ind, frame, len));
+}
+
+static void test_dispatch(void)
+{
+    uint32_t value = 0x11223344;
+    uint8_t frame[64];
+    uint8_t len = 0;
+    zb_apsde_data_indication_t ind = {.src_addr = 0x4321, .clusterid = 0x0006, .dst_endpoint = 2};
+
+    memset(&s_handler, 0, sizeof(s_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_read_attr_handler_add(test_handler));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_read_attr_handler_add(test_handler));
+    TEST_ASSERT(esp_zb_fake_af_hook_set());
+    resp_deliver(0x4321, 0x0006, 7, 0x0000, 0x23, &value, sizeof(value));
+    TEST_ASSERT_EQUAL(1, s_handler.count);
+    TEST_ASSERT_EQUAL(0x4321, s_handler.info.src_addr);
+    TEST_ASSERT_EQUAL(7, s_handler.info.tsn);
+    TEST_ASSERT_EQUAL(0x0006, s_handler.info.cluster_id);
+    TEST_ASSERT_EQUAL(value, s_handler.value);
+    /* a command other than the read attribute response is not dispatched */
+    len = esp_zb_fake_read_attr_resp_build(frame, 8, 0x0000, 0x23, &value, sizeof(value));
+    frame[2] = 0x0a;
+    esp_zb_fake_af_indication(&ind, frame, len);
+    TEST_ASSERT_EQUAL(1, s_handler.count);
+    /* a truncated value stops the parsing */
+    len = esp_zb_fake_read_attr_resp_build(frame, 9, 0x0000, 0x23, &value, sizeof(value));
+    esp_zb_fake_af_indication(&ind, frame, len - 1);
+    TEST_ASSERT_EQUAL(1, s_handler.count);
+    /* a handler removing itself during the dispatch, the hook is released with the last handler */
+    s_handler.remove_self = true;
+    resp_deliver(0x4321, 0x0006, 10, 0x0000, 0x23, &value, sizeof(value));
+    TEST_ASSERT_EQUAL(2, s_handler.count);
+    TEST_ASSERT(!esp_zb_fake_af_hook_set());
+    resp_deliver(0x4321, 0x0006, 11, 0x0000, 0x23, &value, sizeof(value));
+    TEST_ASSERT_EQUAL(2, s_handler.count);
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+}
+
+static void time_attr_answer(uint16_t attr_id, uint8_t attr_type, const void *value, uint8_t size)
+{
+    uint8_t tsn = 0;
+    const esp_zb_zcl_read_attr_cmd_t *req = esp_zb_fake_read_attr_last(&tsn);
+
+    TEST_ASSERT_EQUAL(attr_id, req->attributeID);
+    resp_deliver(TEST_SERVER_ADDR, ESP_ZB_ZCL_CLUSTER_ID_TIME, tsn, attr_id, attr_type, value, size);
+}
+
+static void test_time_sync(void)
+{
+    esp_zb_time_sync_cfg_t cfg = {
+        .src_endpoint = TEST_CLIENT_ENDPOINT,
+        .dst_short_addr = TEST_SERVER_ADDR,
+        .dst_endpoint = TEST_SERVER_ENDPOINT,
+    };
+    uint32_t utc = 700000000;
+    uint32_t other = 100;
+    int32_t zone = 3600;
+    uint32_t dst = ESP_ZB_TIME_INVALID;
+    int32_t shift = 0;
+    uint8_t tsn = 0;
+
+    memset(&s_handler, 0, sizeof(s_handler));
+    memset(&s_sync, 0, sizeof(s_sync));
+    /* the application handler sees the responses of the time client as well */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_read_attr_handler_add(test_handler));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_time_sync_start(&cfg, test_sync_cb));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_read_attr_count());
+    esp_zb_fake_read_attr_last(&tsn);
+    /* a response of another device, then a stale response of the server, are both ignored */
+    resp_deliver(0x9999, ESP_ZB_ZCL_CLUSTER_ID_TIME, tsn, ESP_ZB_ZCL_ATTR_TIME_TIME_ID, 0xe2, &other, sizeof(other));
+    resp_deliver(TEST_SERVER_ADDR, ESP_ZB_ZCL_CLUSTER_ID_TIME, (uint8_t)(tsn - 1), ESP_ZB_ZCL_ATTR_TIME_TIME_ID, 0xe2,
+                 &other, sizeof(other));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_read_attr_count());
+    TEST_ASSERT_EQUAL(2, s_handler.count);
+    time_attr_answer(ESP_ZB_ZCL_ATTR_TIME_TIME_ID, 0xe2, &utc, sizeof(utc));
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_read_attr_count());
+    time_attr_answer(ESP_ZB_ZCL_ATTR_TIME_TIME_ZONE_ID, 0x2b, &zone, sizeof(zone));
+    time_attr_answer(ESP_ZB_ZCL_ATTR_TIME_DST_START_ID, 0x23, &dst, sizeof(dst));
+    time_attr_answer(ESP_ZB_ZCL_ATTR_TIME_DST_END_ID, 0x23, &dst, sizeof(dst));
+    time_attr_answer(ESP_ZB_ZCL_ATTR_TIME_DST_SHIFT_ID, 0x2b, &shift, sizeof(shift));
+    TEST_ASSERT_EQUAL(1, s_sync.count);
+    TEST_ASSERT_EQUAL(ESP_OK, s_sync.status);
+    TEST_ASSERT_EQUAL(utc, s_sync.utc);
+    TEST_ASSERT_EQUAL(7, s_handler.count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_time_sync_stop());
+    TEST_ASSERT(esp_zb_fake_af_hook_set());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_read_attr_handler_remove(test_handler));
+    TEST_ASSERT(!esp_zb_fake_af_hook_set());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+}
+
+int main(void)
+{
+    TEST_RUN(test_dispatch);
+    TEST_RUN(test_time_sync);
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Device registry tests: the devices are found by both addresses through the indexes, which stay right over removals
+ * and rebuilds, the records come back from NVS with the last seen times flushed, and the announcements, the device
+ * updates and the leave indications add, move and remove the devices. */
+
+#include <string.h>
+#include "esp_zigbee_registry.h"
+#include "esp_zigbee_time.h"
+#include "esp_zb_fake.h"
+
+#define TEST_DEVICE_NUM             8
+#define TEST_CHURN_NUM              200
+#define TEST_INPUT_CLUSTER_NUM      12
+#define TEST_DEVICE_UPDATE_LEFT     0x02
+#define TEST_DEVICE_UPDATE_REJOIN   0x00
+
+static void ieee_set(esp_zb_ieee_addr_t ieee_addr, uint8_t id)
+{
+    for (uint8_t i = 0; i < sizeof(esp_zb_ieee_addr_t); i++) {
+        ieee_addr[i] = 0x10 * (i + 1) + id;
+    }
+}
+
+static esp_zb_registry_device_t device_get(uint8_t id, uint16_t short_addr)
+{
+    esp_zb_registry_device_t device = {
+        .short_addr = short_addr, .power_source = 0xff, .last_seen = ESP_ZB_TIME_INVALID,
+    };
+
+    ieee_set(device.ieee_addr, id);
+    return device;
+}
+
+static const esp_zb_registry_device_t *find(uint8_t id)
+{
+    esp_zb_ieee_addr_t ieee_addr;
+
+    ieee_set(ieee_addr, id);
+    return esp_zb_registry_find_by_ieee(ieee_addr);
+}
+
+static uint16_t device_count(void)
+{
+    uint16_t iterator = 0;
+    uint16_t count = 0;
+
+    while (esp_zb_registry_get_next(&iterator)) {
+        count++;
+    }
+    return count;
+}
+
+static void signal_send(esp_zb_app_signal_type_t type, const void *params, size_t size)
+{
+    uint32_t signal[8] = {type};
+    esp_zb_app_signal_t signal_s = {.p_app_signal = signal, .esp_err_status = ESP_OK};
+
+    memcpy(&signal[1], params, size);
+    esp_zb_registry_signal_handle(&signal_s);
+}
+
+static void device_annce(uint8_t id, uint16_t short_addr)
+{
+    esp_zb_zdo_signal_device_annce_params_t params = {.device_short_addr = short_addr, .capability = 0x8e};
+
+    ieee_set(params.ieee_addr, id);
+    signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, &params, sizeof(params));
+}
+
+static void device_update(uint8_t id, uint16_t short_addr, uint8_t status)
+{
+    esp_zb_zdo_signal_device_update_params_t params = {.short_addr = short_addr, .status = status};
+
+    ieee_set(params.long_addr, id);
+    signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE, &params, sizeof(params));
+}
+
+static void leave_indication(uint8_t id, uint16_t short_addr, uint8_t rejoin)
+{
+    esp_zb_zdo_signal_leave_indication_params_t params = {.short_addr = short_addr, .rejoin = rejoin};
+
+    ieee_set(params.device_addr, id);
+    signal_send(ESP_ZB_ZDO_SIGNAL_LEAVE_INDICATION, &params, sizeof(params));
+}
+
+static void test_index(void)
+{
+    esp_zb_registry_device_t device = device_get(0, 0x1000);
+    esp_zb_ieee_addr_t ieee_addr;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_registry_init(0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_registry_update(&device));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_init(TEST_DEVICE_NUM));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_registry_init(TEST_DEVICE_NUM));
+    for (uint8_t i = 0; i < TEST_DEVICE_NUM; i++) {
+        device = device_get(i, 0x1000 + i);
+        TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_update(&device));
+    }
+    device = device_get(TEST_DEVICE_NUM, 0x2000);
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_registry_update(&device));
+    device.ep_count = 1;
+    device.ep[0].input_cluster_count = ESP_ZB_REGISTRY_CLUSTER_MAX_NUM;
+    device.ep[0].output_cluster_count = 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_registry_update(&device));
+    TEST_ASSERT_EQUAL(TEST_DEVICE_NUM, device_count());
+    for (uint8_t i = 0; i < TEST_DEVICE_NUM; i++) {
+        TEST_ASSERT_EQUAL(find(i), esp_zb_registry_find_by_short(0x1000 + i));
+        TEST_ASSERT_EQUAL(0x1000 + i, find(i)->short_addr);
+    }
+    /* a new NWK address replaces the old one in the index */
+    device = device_get(3, 0x3003);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_update(&device));
+    TEST_ASSERT(!esp_zb_registry_find_by_short(0x1003));
+    TEST_ASSERT_EQUAL(find(3), esp_zb_registry_find_by_short(0x3003));
+    TEST_ASSERT(!esp_zb_registry_find_by_short(ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN));
+    /* the removals and additions leave deleted index entries, which are reused and rebuilt away */
+    for (uint16_t i = 0; i < TEST_CHURN_NUM; i++) {
+        uint8_t id = i % TEST_DEVICE_NUM;
+
+        ieee_set(ieee_addr, id);
+        TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_remove(ieee_addr));
+        TEST_ASSERT(!find(id));
+        TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_registry_remove(ieee_addr));
+        device = device_get(id, 0x4000 + i);
+        TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_update(&device));
+        for (uint8_t j = 0; j < TEST_DEVICE_NUM; j++) {
+            TEST_ASSERT(find(j));
+            TEST_ASSERT_EQUAL(find(j), esp_zb_registry_find_by_short(find(j)->short_addr));
+        }
+    }
+    TEST_ASSERT_EQUAL(TEST_DEVICE_NUM, device_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_deinit());
+    TEST_ASSERT(!find(0));
+}
+
+/* the records are written at once, the last seen times and LQIs with the flush only, and all of them are restored */
+static void test_nvs(void)
+{
+    esp_zb_interview_device_t interview = {
+        .short_addr = 0x1234, .capability = 0x80, .power_source = 0x03, .ep_count = 1,
+    };
+    esp_zb_registry_device_t device = device_get(1, 0x5678);
+    const esp_zb_registry_device_t *found = NULL;
+    uint32_t write_count = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_init(TEST_DEVICE_NUM));
+    ieee_set(interview.ieee_addr, 0);
+    interview.node_desc.manufacturer_code = 0x1037;
+    interview.ep[0].endpoint = 1;
+    interview.ep[0].profile_id = 0x0104;
+    interview.ep[0].input_cluster_count = TEST_INPUT_CLUSTER_NUM;
+    interview.ep[0].output_cluster_count = ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM - TEST_INPUT_CLUSTER_NUM;
+    for (uint8_t i = 0; i < ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM; i++) {
+        interview.ep[0].cluster_list[i] = i;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_update_from_interview(&interview));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_update(&device));
+    write_count = esp_zb_fake_nvs_write_count();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_touch(0x1234, 200));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_registry_touch(0x9999, 200));
+    TEST_ASSERT_EQUAL(write_count, esp_zb_fake_nvs_write_count());
+    esp_zb_fake_run(ESP_ZB_REGISTRY_FLUSH_PERIOD);
+    TEST_ASSERT_EQUAL(write_count + 1, esp_zb_fake_nvs_write_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_touch(0x5678, 100));
+    /* the deinit flushes the pending LQI */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_deinit());
+    TEST_ASSERT_EQUAL(write_count + 2, esp_zb_fake_nvs_write_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_init(TEST_DEVICE_NUM));
+    TEST_ASSERT_EQUAL(2, device_count());
+    found = esp_zb_registry_find_by_short(0x1234);
+    TEST_ASSERT(found && found == find(0));
+    TEST_ASSERT_EQUAL(0x1037, found->manufacturer_code);
+    TEST_ASSERT_EQUAL(0x03, found->power_source);
+    TEST_ASSERT_EQUAL(200, found->lqi);
+    /* the default cluster number keeps all the clusters an interview records */
+    TEST_ASSERT_EQUAL(TEST_INPUT_CLUSTER_NUM, found->ep[0].input_cluster_count);
+    TEST_ASSERT_EQUAL(ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM - TEST_INPUT_CLUSTER_NUM, found->ep[0].output_cluster_count);
+    for (uint8_t i = 0; i < ESP_ZB_INTERVIEW_CLUSTER_MAX_NUM; i++) {
+        TEST_ASSERT_EQUAL(i, found->ep[0].cluster_list[i]);
+    }
+    TEST_ASSERT_EQUAL(100, esp_zb_registry_find_by_short(0x5678)->lqi);
+    /* a record beyond the device number is not loaded and stays in NVS */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_deinit());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_init(1));
+    TEST_ASSERT_EQUAL(1, device_count());
+    TEST_ASSERT(find(0) && !find(1));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_deinit());
+}
+
+static void test_signal(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_init(TEST_DEVICE_NUM));
+    device_annce(0, 0x1000);
+    TEST_ASSERT(find(0));
+    TEST_ASSERT_EQUAL(0x8e, find(0)->capability);
+    TEST_ASSERT_EQUAL(find(0), esp_zb_registry_find_by_short(0x1000));
+    /* a rejoin with a new address moves the device */
+    device_annce(0, 0x1001);
+    TEST_ASSERT(!esp_zb_registry_find_by_short(0x1000));
+    TEST_ASSERT_EQUAL(find(0), esp_zb_registry_find_by_short(0x1001));
+    device_update(0, 0x1002, TEST_DEVICE_UPDATE_REJOIN);
+    TEST_ASSERT_EQUAL(find(0), esp_zb_registry_find_by_short(0x1002));
+    /* the address is taken from the device which held it */
+    device_annce(1, 0x1002);
+    TEST_ASSERT_EQUAL(find(1), esp_zb_registry_find_by_short(0x1002));
+    TEST_ASSERT_EQUAL(ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN, find(0)->short_addr);
+    /* a device update of an unknown device waits for its announcement */
+    device_update(2, 0x1003, TEST_DEVICE_UPDATE_REJOIN);
+    TEST_ASSERT(!find(2));
+    device_update(0, ESP_ZB_REGISTRY_SHORT_ADDR_UNKNOWN, TEST_DEVICE_UPDATE_LEFT);
+    TEST_ASSERT(!find(0));
+    leave_indication(1, 0x1002, 1);
+    TEST_ASSERT(find(1));
+    leave_indication(1, 0x1002, 0);
+    TEST_ASSERT(!find(1));
+    TEST_ASSERT(!esp_zb_registry_find_by_short(0x1002));
+    TEST_ASSERT_EQUAL(0, device_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_registry_deinit());
+}
+
+int main(void)
+{
+    TEST_RUN(test_index);
+    TEST_RUN(test_nvs);
+    TEST_RUN(test_signal);
+    return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Sensor pipeline tests and benchmark: the traces are replayed through the pipeline on the simulated clock, and the
+ * attribute writes and the tracking error are compared for each filter against writing every sample. */
+
+#include <string.h>
+#include "esp_zigbee_sensor.h"
+#include "esp_zb_fake.h"
+
+#define TEST_ENDPOINT               1
+#define TEST_CLUSTER_ID             0x0402
+#define TEST_ATTR_ID                0x0000
+#define TRACE_MAX_NUM               20000
+#define REFERENCE_HALF_WINDOW       4       /* the reference is the centered median of 9 samples */
+
+typedef struct trace_s {
+    const char *path;
+    uint32_t period;
+    uint32_t num;
+    uint32_t pos;
+    int32_t value[TRACE_MAX_NUM];
+    int32_t reference[TRACE_MAX_NUM];
+} trace_t;
+
+static trace_t s_trace;
+static esp_zb_zcl_attr_t *s_attr;
+
+static esp_err_t trace_sample_cb(int32_t *value, void *user_ctx)
+{
+    trace_t *trace = (trace_t *)user_ctx;
+
+    if (trace->pos >= trace->num) {
+        return ESP_FAIL;
+    }
+    *value = trace->value[trace->pos++];
+    return ESP_OK;
+}
+
+static int32_t window_median(const int32_t *values, int num)
+{
+    int32_t sorted[2 * REFERENCE_HALF_WINDOW + 1];
+
+    for (int i = 0; i < num; i++) {
+        int j = i;
+        while (j > 0 && sorted[j - 1] > values[i]) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = values[i];
+    }
+    return sorted[num / 2];
+}
+
+static void trace_load(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char line[64];
+    uint32_t time[2] = {0};
+
+    TEST_ASSERT(file);
+    memset(&s_trace, 0, sizeof(s_trace));
+    s_trace.path = path;
+    while (fgets(line, sizeof(line), file) && s_trace.num < TRACE_MAX_NUM) {
+        unsigned long sample_time = 0;
+        long value = 0;
+        if (sscanf(line, "%lu,%ld", &sample_time, &value) != 2) {
+            continue;
+        }
+        if (s_trace.num < 2) {
+            time[s_trace.num] = sample_time;
+        }
+        s_trace.value[s_trace.num++] = value;
+    }
+    fclose(file);
+    TEST_ASSERT(s_trace.num > 2 * REFERENCE_HALF_WINDOW + 1);
+    s_trace.period = time[1] - time[0];
+    for (uint32_t i = 0; i < s_trace.num; i++) {
+        uint32_t begin = i < REFERENCE_HALF_WINDOW ? 0 : i - REFERENCE_HALF_WINDOW;
+        uint32_t end = i + REFERENCE_HALF_WINDOW >= s_trace.num ? s_trace.num - 1 : i + REFERENCE_HALF_WINDOW;
+        s_trace.reference[i] = window_median(&s_trace.value[begin], end - begin + 1);
+    }
+}
+
+static void sensor_attr_add(void)
+{
+    s_attr = esp_zb_fake_attr_add(TEST_ENDPOINT, TEST_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, TEST_ATTR_ID,
+                                  ESP_ZB_ZCL_ATTR_TYPE_S32, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, sizeof(int32_t));
+}
+
+static esp_zb_sensor_cfg_t sensor_cfg_default(void)
+{
+    esp_zb_sensor_cfg_t cfg = {
+        .endpoint = TEST_ENDPOINT,
+        .cluster_id = TEST_CLUSTER_ID,
+        .attr_id = TEST_ATTR_ID,
+        .attr_type = ESP_ZB_ZCL_ATTR_TYPE_S32,
+        .filter = ESP_ZB_SENSOR_FILTER_NONE,
+        .window_size = 1,
+        .reportable_change = 10,
+    };
+
+    return cfg;
+}
+
+static void test_change_gating(void)
+{
+    esp_zb_sensor_cfg_t cfg = sensor_cfg_default();
+    esp_zb_sensor_stats_t stats;
+    uint8_t id = 0;
+
+    sensor_attr_add();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_create(&cfg, &id));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_push_sample(id, 100));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_attr_write_count());
+    TEST_ASSERT_EQUAL(100, *(int32_t *)s_attr->data_p);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_push_sample(id, 109));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_push_sample(id, 91));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_attr_write_count());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_push_sample(id, 110));
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_attr_write_count());
+    TEST_ASSERT_EQUAL(110, *(int32_t *)s_attr->data_p);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_get_stats(id, &stats));
+    TEST_ASSERT_EQUAL(4, stats.sample_count);
+    TEST_ASSERT_EQUAL(2, stats.attr_write_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_delete(id));
+}
+
+static void test_median_rejects_glitch(void)
+{
+    esp_zb_sensor_cfg_t cfg = sensor_cfg_default();
+    uint8_t id = 0;
+
+    cfg.filter = ESP_ZB_SENSOR_FILTER_MEDIAN;
+    cfg.window_size = 5;
+    sensor_attr_add();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_create(&cfg, &id));
+    for (int i = 0; i < 5; i++) {
+        esp_zb_sensor_push_sample(id, 2000);
+    }
+    esp_zb_sensor_push_sample(id, 2500);
+    esp_zb_sensor_push_sample(id, 1500);
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_attr_write_count());
+    TEST_ASSERT_EQUAL(2000, *(int32_t *)s_attr->data_p);
+    esp_zb_sensor_delete(id);
+}
+
+static void test_periodic_sampling(void)
+{
+    esp_zb_sensor_cfg_t cfg = sensor_cfg_default();
+    esp_zb_sensor_stats_t stats;
+    uint8_t id = 0;
+
+    trace_load("traces/temperature.csv");
+    cfg.sample_cb = trace_sample_cb;
+    cfg.user_ctx = &s_trace;
+    cfg.sample_period = s_trace.period;
+    sensor_attr_add();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_create(&cfg, &id));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_start(id));
+    esp_zb_fake_run(10 * s_trace.period);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_get_stats(id, &stats));
+    TEST_ASSERT_EQUAL(10, stats.sample_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_stop(id));
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    esp_zb_sensor_delete(id);
+}
+
+typedef struct bench_result_s {
+    uint32_t writes;
+    double error_mean;
+    int32_t error_max;
+} bench_result_t;
+
+static bench_result_t bench_run(esp_zb_sensor_filter_t filter, uint8_t window_size, uint32_t reportable_change)
+{
+    esp_zb_sensor_cfg_t cfg = sensor_cfg_default();
+    bench_result_t result = {0};
+    double error_sum = 0;
+    uint8_t id = 0;
+
+    esp_zb_fake_reset();
+    sensor_attr_add();
+    s_trace.pos = 0;
+    cfg.filter = filter;
+    cfg.window_size = window_size;
+    cfg.reportable_change = reportable_change;
+    cfg.sample_cb = trace_sample_cb;
+    cfg.user_ctx = &s_trace;
+    cfg.sample_period = s_trace.period;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sensor_create(&cfg, &id));
+    esp_zb_sensor_start(id);
+    for (uint32_t i = 0; i < s_trace.num; i++) {
+        int32_t error = 0;
+        esp_zb_fake_run(s_trace.period);
+        error = *(int32_t *)s_attr->data_p - s_trace.reference[i];
+        error = error < 0 ? -error : error;
+        error_sum += error;
+        if (error > result.error_max) {
+            result.error_max = error;
+        }
+    }
+    result.writes = esp_zb_fake_attr_write_count();
+    result.error_mean = error_sum / s_trace.num;
+    esp_zb_sensor_delete(id);
+    return result;
+}
+
+static void bench_trace(const char *path, uint32_t reportable_change, bool check)
+{
+    static const struct {
+        const char *name;
+        esp_zb_sensor_filter_t filter;
+        uint8_t window_size;
+        uint32_t reportable_change;         /* 0 uses the reportable change of the trace */
+    } runs[] = {
+        {"every sample", ESP_ZB_SENSOR_FILTER_NONE, 1, 1},     /* the error of the raw samples */
+        {"none", ESP_ZB_SENSOR_FILTER_NONE, 1, 0},
+        {"ema", ESP_ZB_SENSOR_FILTER_EMA, 1, 0},
+        {"median 5", ESP_ZB_SENSOR_FILTER_MEDIAN, 5, 0},
+        {"median 9", ESP_ZB_SENSOR_FILTER_MEDIAN, 9, 0},
+    };
+    bench_result_t baseline = {0};
+
+    trace_load(path);
+    printf("\n%s: %u samples every %u ms, reportable change %u\n", path, s_trace.num, s_trace.period,
+           reportable_change);
+    printf("%-14s %8s %10s %12s %10s\n", "filter", "writes", "reduction", "mean error", "max error");
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); i++) {
+        bench_result_t result = bench_run(runs[i].filter, runs[i].window_size,
+                                          runs[i].reportable_change ? runs[i].reportable_change : reportable_change);
+        if (i == 0) {
+            /* the application without the pipeline writes the attribute on every sample */
+            result.writes = s_trace.num;
+            baseline = result;
+        }
+        printf("%-14s %8u %9.1fx %12.1f %10d\n", runs[i].name, result.writes,
+               result.writes ? (double)baseline.writes / result.writes : 0.0, result.error_mean, result.error_max);
+        if (check && runs[i].filter != ESP_ZB_SENSOR_FILTER_NONE) {
+            /* a filtered pipeline writes an order of magnitude less than the application writing every sample, and
+             * stays within twice the reportable change of the reference on average */
+            TEST_ASSERT(result.writes * 10 <= baseline.writes);
+            TEST_ASSERT(result.error_mean <= 2.0 * reportable_change);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        /* test_sensor <trace.csv> <reportable change> ... benchmarks recorded traces */
+        for (int i = 1; i + 1 < argc; i += 2) {
+            esp_zb_fake_reset();
+            bench_trace(argv[i], (uint32_t)strtoul(argv[i + 1], NULL, 0), false);
+        }
+        return 0;
+    }
+    TEST_RUN(test_change_gating);
+    TEST_RUN(test_median_rejects_glitch);
+    TEST_RUN(test_periodic_sampling);
+    esp_zb_fake_reset();
+    bench_trace("traces/temperature.csv", 10, true);
+    bench_trace("traces/humidity.csv", 100, true);
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Signal subscription tests: the subscribers run in the order of their subscription, the subscriptions changed from
+ * the callbacks, nested dispatches included, take effect without breaking the dispatch, the pool is reused, and the
+ * typed accessors only return the parameters of their own signal type. */
+
+#include <string.h>
+#include "esp_zigbee_signal.h"
+#include "esp_zb_fake.h"
+
+#define TEST_RUN_MAX_NUM            16
+
+static uint32_t s_runs[TEST_RUN_MAX_NUM];
+static uint8_t s_run_num;
+
+static bool signal_send(esp_zb_app_signal_type_t type, const void *params, size_t size)
+{
+    uint32_t signal[8] = {type};
+    esp_zb_app_signal_t signal_s = {.p_app_signal = signal, .esp_err_status = ESP_OK};
+
+    memcpy(&signal[1], params, size);
+    return esp_zb_signal_dispatch(&signal_s);
+}
+
+static void record_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    if (s_run_num < TEST_RUN_MAX_NUM) {
+        s_runs[s_run_num++] = (uint32_t)(uintptr_t)ctx;
+    }
+}
+
+static void runs_clear(void)
+{
+    s_run_num = 0;
+}
+
+static void test_order(void)
+{
+    uint8_t dummy = 0;
+
+    runs_clear();
+    for (uintptr_t i = 1; i <= 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, record_cb, (void *)i));
+    }
+    TEST_ASSERT(signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, &dummy, 0));
+    TEST_ASSERT_EQUAL(3, s_run_num);
+    TEST_ASSERT(s_runs[0] == 1 && s_runs[1] == 2 && s_runs[2] == 3);
+    /* no subscriber */
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_LEAVE, &dummy, 0));
+    TEST_ASSERT_EQUAL(3, s_run_num);
+
+    /* the middle one leaves, the others keep their order */
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, record_cb, (void *)2));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, record_cb, (void *)2));
+    runs_clear();
+    TEST_ASSERT(signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, &dummy, 0));
+    TEST_ASSERT(s_run_num == 2 && s_runs[0] == 1 && s_runs[1] == 3);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, record_cb, (void *)1));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, record_cb, (void *)3));
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, &dummy, 0));
+}
+
+/* the first subscriber drops itself and the next one, then subscribes another callback */
+static void leaving_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    record_cb(signal, ctx);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(signal->type, leaving_cb, ctx));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(signal->type, record_cb, (void *)2));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(signal->type, record_cb, (void *)4));
+}
+
+static void test_change_from_callback(void)
+{
+    uint8_t dummy = 0;
+
+    runs_clear();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, leaving_cb, (void *)1));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, record_cb, (void *)2));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, record_cb, (void *)3));
+    TEST_ASSERT(signal_send(ESP_ZB_ZDO_SIGNAL_LEAVE, &dummy, 0));
+    /* 2 is dropped before its turn, 4 subscribed during the dispatch waits for the next one */
+    TEST_ASSERT(s_run_num == 2 && s_runs[0] == 1 && s_runs[1] == 3);
+    runs_clear();
+    TEST_ASSERT(signal_send(ESP_ZB_ZDO_SIGNAL_LEAVE, &dummy, 0));
+    TEST_ASSERT(s_run_num == 2 && s_runs[0] == 3 && s_runs[1] == 4);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, record_cb, (void *)3));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, record_cb, (void *)4));
+}
+
+/* a subscriber of a signal sends another one, whose subscriber leaves from within the nested dispatch */
+static void nested_leave_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    record_cb(signal, ctx);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(signal->type, nested_leave_cb, ctx));
+}
+
+static void nested_send_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    uint8_t dummy = 0;
+
+    record_cb(signal, ctx);
+    TEST_ASSERT(signal_send(ESP_ZB_ZDO_SIGNAL_LEAVE_INDICATION, &dummy, 0));
+}
+
+static void test_nested_dispatch(void)
+{
+    uint8_t dummy = 0;
+
+    runs_clear();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE, nested_send_cb, (void *)1));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE, record_cb, (void *)3));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_LEAVE_INDICATION, nested_leave_cb, (void *)2));
+    TEST_ASSERT(signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE, &dummy, 0));
+    TEST_ASSERT(s_run_num == 3 && s_runs[0] == 1 && s_runs[1] == 2 && s_runs[2] == 3);
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_LEAVE_INDICATION, &dummy, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE, nested_send_cb, (void *)1));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_UPDATE, record_cb, (void *)3));
+}
+
+/* the pool is shared by the signal types, the slots of the unsubscribed are reused */
+static void test_pool(void)
+{
+    for (uintptr_t i = 0; i < ESP_ZB_SIGNAL_SUBSCRIBER_MAX_NUM; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe((esp_zb_app_signal_type_t)(i % ESP_ZB_SIGNAL_TYPE_MAX_NUM), record_cb,
+                                                          (void *)i));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, record_cb, NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe((esp_zb_app_signal_type_t)5, record_cb, (void *)5));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, record_cb, NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, record_cb, NULL));
+    for (uintptr_t i = 0; i < ESP_ZB_SIGNAL_SUBSCRIBER_MAX_NUM; i++) {
+        if (i != 5) {
+            TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe((esp_zb_app_signal_type_t)(i % ESP_ZB_SIGNAL_TYPE_MAX_NUM),
+                                                                record_cb, (void *)i));
+        }
+    }
+}
+
+static esp_zb_zdo_signal_device_annce_params_t s_annce;
+static bool s_accessor_ok;
+
+static void annce_cb(const esp_zb_signal_t *signal, void *ctx)
+{
+    esp_zb_zdo_signal_device_annce_params_t *params = esp_zb_signal_get_device_annce_params(signal);
+
+    s_accessor_ok = params && params->device_short_addr == s_annce.device_short_addr &&
+                    !memcmp(params->ieee_addr, s_annce.ieee_addr, sizeof(esp_zb_ieee_addr_t)) &&
+                    params->capability == s_annce.capability && !esp_zb_signal_get_leave_params(signal) &&
+                    !esp_zb_signal_get_can_sleep_params(signal) && !esp_zb_signal_get_device_update_params(signal);
+}
+
+static void test_accessors(void)
+{
+    s_annce = (esp_zb_zdo_signal_device_annce_params_t) {
+        .device_short_addr = 0x1234, .ieee_addr = {1, 2, 3, 4, 5, 6, 7, 8}, .capability = 0x8e,
+    };
+    s_accessor_ok = false;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, annce_cb, NULL));
+    TEST_ASSERT(signal_send(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, &s_annce, sizeof(s_annce)));
+    TEST_ASSERT(s_accessor_ok);
+    TEST_ASSERT(!esp_zb_signal_get_device_annce_params(NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_signal_unsubscribe(ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE, annce_cb, NULL));
+}
+
+static void test_invalid(void)
+{
+    esp_zb_app_signal_t signal_s = {0};
+    uint8_t dummy = 0;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_signal_subscribe(ESP_ZB_SIGNAL_TYPE_MAX_NUM, record_cb, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_signal_subscribe(ESP_ZB_ZDO_SIGNAL_LEAVE, NULL, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_zb_signal_unsubscribe(ESP_ZB_SIGNAL_TYPE_MAX_NUM, record_cb, NULL));
+    TEST_ASSERT(!esp_zb_signal_dispatch(NULL));
+    TEST_ASSERT(!esp_zb_signal_dispatch(&signal_s));
+    TEST_ASSERT(!signal_send(ESP_ZB_SIGNAL_TYPE_MAX_NUM, &dummy, 0));
+}
+
+int main(void)
+{
+    TEST_RUN(test_order);
+    TEST_RUN(test_change_from_callback);
+    TEST_RUN(test_nested_dispatch);
+    TEST_RUN(test_pool);
+    TEST_RUN(test_accessors);
+    TEST_RUN(test_invalid);
+    return 0;
+}
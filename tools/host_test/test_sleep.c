@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Sleep helper tests: a sleepy end device sleeps until the deadline of each can sleep signal less the guard time, skips
+ * the deadlines too close, is woken up early by a GPIO, and accounts its awake and asleep time. */
+
+#include "esp_zigbee_sleep.h"
+#include "zdo/esp_zigbee_zdo_common.h"
+#include "esp_timer.h"
+#include "esp_zb_fake.h"
+
+#define TEST_THRESHOLD              20
+#define TEST_GUARD_TIME             2
+#define TEST_POLL_INTERVAL          7500
+#define TEST_AWAKE_TIME             5
+#define TEST_CYCLE_NUM              100
+
+static const esp_zb_sleep_cfg_t s_cfg = {
+    .threshold = TEST_THRESHOLD,
+    .guard_time = TEST_GUARD_TIME,
+    .gpio_wakeup_mask = (1ULL << 3) | (1ULL << 5),
+};
+
+/* the can sleep signal handling of the application, as in the README of tools/power_model */
+static esp_err_t can_sleep(uint32_t sleep_tmo, esp_zb_sleep_wakeup_reason_t *reason)
+{
+    uint32_t signal[2] = {ESP_ZB_COMMON_SIGNAL_CAN_SLEEP, sleep_tmo};
+    esp_zb_zdo_signal_can_sleep_params_t *params = esp_zb_app_signal_get_params(signal);
+
+    esp_zb_sleep_deadline_update(params->sleep_tmo);
+    return esp_zb_sleep_light(reason);
+}
+
+static void test_deadline(void)
+{
+    uint32_t time = 0;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_sleep_get_next_deadline(&time));
+    esp_zb_sleep_deadline_update(1000);
+    esp_zb_fake_run(300);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sleep_get_next_deadline(&time));
+    TEST_ASSERT_EQUAL(700, time);
+    esp_zb_fake_run(2000);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sleep_get_next_deadline(&time));
+    TEST_ASSERT_EQUAL(0, time);
+    /* not initialized */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_sleep_light(NULL));
+}
+
+static void test_sleep_until_deadline(void)
+{
+    esp_zb_sleep_wakeup_reason_t reason = ESP_ZB_SLEEP_WAKEUP_MAX;
+    esp_zb_sleep_cfg_t cfg = s_cfg;
+    esp_zb_sleep_stats_t stats;
+    int64_t start = 0;
+
+    /* the trace line of tools/power_model */
+    cfg.trace = true;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sleep_init(&cfg));
+    TEST_ASSERT_EQUAL(s_cfg.gpio_wakeup_mask, esp_zb_fake_gpio_wakeup_mask());
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, can_sleep(TEST_POLL_INTERVAL, &reason));
+    TEST_ASSERT_EQUAL(ESP_ZB_SLEEP_WAKEUP_TIMER, reason);
+    TEST_ASSERT_EQUAL((TEST_POLL_INTERVAL - TEST_GUARD_TIME) * 1000, esp_zb_fake_sleep_timer());
+    TEST_ASSERT_EQUAL((TEST_POLL_INTERVAL - TEST_GUARD_TIME) * 1000, esp_timer_get_time() - start);
+    /* the deadline is consumed, the stack must run again */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_sleep_light(&reason));
+
+    /* a deadline closer than the threshold and the guard time is skipped */
+    start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, can_sleep(TEST_THRESHOLD + TEST_GUARD_TIME - 1, &reason));
+    TEST_ASSERT_EQUAL(ESP_ZB_SLEEP_WAKEUP_NONE, reason);
+    TEST_ASSERT_EQUAL(start, esp_timer_get_time());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sleep_get_stats(&stats));
+    TEST_ASSERT_EQUAL(1, stats.sleep_count);
+    TEST_ASSERT_EQUAL(1, stats.skip_count);
+    TEST_ASSERT_EQUAL((TEST_POLL_INTERVAL - TEST_GUARD_TIME) * 1000, stats.sleep_time);
+    TEST_ASSERT_EQUAL(1, stats.wakeup_count[ESP_ZB_SLEEP_WAKEUP_NONE]);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sleep_deinit());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_gpio_wakeup_mask());
+}
+
+/* a sleepy end device polls its parent every 7.5 s and a button wakes it up every 10 polls */
+static void test_sleepy_end_device(void)
+{
+    esp_zb_sleep_wakeup_reason_t reason = ESP_ZB_SLEEP_WAKEUP_MAX;
+    esp_zb_sleep_stats_t stats;
+    uint64_t gpio_sleep_time = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sleep_init(&s_cfg));
+    for (uint32_t cycle = 0; cycle < TEST_CYCLE_NUM; cycle++) {
+        esp_zb_fake_run(TEST_AWAKE_TIME);
+        if (cycle % 10 == 9) {
+            esp_zb_fake_sleep_gpio_wakeup(1000);
+            gpio_sleep_time += 1000 * 1000;
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, can_sleep(TEST_POLL_INTERVAL - TEST_AWAKE_TIME, &reason));
+        TEST_ASSERT_EQUAL(cycle % 10 == 9 ? ESP_ZB_SLEEP_WAKEUP_GPIO : ESP_ZB_SLEEP_WAKEUP_TIMER, reason);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sleep_get_stats(&stats));
+    TEST_ASSERT_EQUAL(TEST_CYCLE_NUM, stats.sleep_count);
+    TEST_ASSERT_EQUAL(0, stats.skip_count);
+    TEST_ASSERT_EQUAL(TEST_CYCLE_NUM * TEST_AWAKE_TIME * 1000, stats.awake_time);
+    TEST_ASSERT_EQUAL(90 * (TEST_POLL_INTERVAL - TEST_AWAKE_TIME - TEST_GUARD_TIME) * 1000 + gpio_sleep_time, stats.sleep_time);
+    TEST_ASSERT_EQUAL(90, stats.wakeup_count[ESP_ZB_SLEEP_WAKEUP_TIMER]);
+    TEST_ASSERT_EQUAL(10, stats.wakeup_count[ESP_ZB_SLEEP_WAKEUP_GPIO]);
+    printf("%d polls: awake %.3f s, asleep %.3f s (%.2f %%)\n", TEST_CYCLE_NUM, stats.awake_time / 1e6, stats.sleep_time / 1e6,
+           100.0 * stats.sleep_time / (stats.sleep_time + stats.awake_time));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_sleep_deinit());
+}
+
+static void test_invalid_cfg(void)
+{
+    esp_zb_sleep_cfg_t cfg = s_cfg;
+
+    cfg.gpio_wakeup_mask = 1ULL << 28;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_sleep_init(&cfg));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_sleep_init(NULL));
+}
+
+int main(void)
+{
+    TEST_RUN(test_deadline);
+    TEST_RUN(test_sleep_until_deadline);
+    TEST_RUN(test_sleepy_end_device);
+    TEST_RUN(test_invalid_cfg);
+    return 0;
+}
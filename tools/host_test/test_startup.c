@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Startup tests: the phases are stamped from the wrapped stack calls and the signals, the network is stored at each
+ * join, the next boot narrows the rejoin of the application to the stored channel and retries it with a backoff, and
+ * the failure is then given back to the application with the primary channel set restored. The module keeps its record
+ * for the whole run, as it does for a boot, so the tracing is checked first. */
+
+#include "esp_zigbee_startup.h"
+#include "esp_zb_fake.h"
+
+#define TEST_CHANNEL_MASK           ((1UL << 11) | (1UL << 15) | (1UL << 20))
+#define TEST_CHANNEL                15
+#define TEST_PAN_ID                 0x1a62
+#define TEST_SHORT_ADDR             0x4f21
+
+static bool signal_send(uint32_t signal, esp_err_t status)
+{
+    uint32_t params[2] = {signal, 0};
+    esp_zb_app_signal_t signal_s = {.p_app_signal = params, .esp_err_status = status};
+
+    return esp_zb_startup_signal_handle(&signal_s);
+}
+
+static void startup_config(bool fast_rejoin)
+{
+    esp_zb_startup_cfg_t cfg = {.fast_rejoin = fast_rejoin, .channel_mask = TEST_CHANNEL_MASK};
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_startup_config(&cfg));
+}
+
+/* the first boot, the device joins by the network steering of the application */
+static void first_boot(void)
+{
+    startup_config(true);
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK));
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START, ESP_OK));
+    esp_zb_fake_network_set(TEST_CHANNEL, TEST_PAN_ID, TEST_SHORT_ADDR);
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_STEERING, ESP_OK));
+}
+
+static void test_trace(void)
+{
+    esp_zb_platform_config_t platform_cfg = {0};
+    esp_zb_cfg_t nwk_cfg = {0};
+    esp_zb_startup_record_t record;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_platform_config(&platform_cfg));
+    esp_zb_fake_run(10);
+    esp_zb_init(&nwk_cfg);
+    startup_config(false);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_start(false));
+    /* the wrapped calls reached the stack */
+    TEST_ASSERT_EQUAL(3, esp_zb_fake_stack_call_count());
+    esp_zb_fake_run(20);
+    TEST_ASSERT(!signal_send(ESP_ZB_MACSPLIT_DEVICE_BOOT, ESP_OK));
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK));
+    /* the application starts the BDB initialization itself */
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_bdb_count(NULL));
+    /* the device cannot sleep before it joined */
+    TEST_ASSERT(!signal_send(ESP_ZB_COMMON_SIGNAL_CAN_SLEEP, ESP_OK));
+    esp_zb_fake_run(100);
+    esp_zb_fake_channel_set(TEST_CHANNEL);
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_STEERING, ESP_OK));
+    esp_zb_fake_run(50);
+    TEST_ASSERT(!signal_send(ESP_ZB_COMMON_SIGNAL_CAN_SLEEP, ESP_OK));
+    esp_zb_fake_run(50);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_startup_mark(ESP_ZB_STARTUP_PHASE_FIRST_COMMAND));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_startup_mark(ESP_ZB_STARTUP_PHASE_MAX));
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_startup_get_record(&record));
+    TEST_ASSERT_EQUAL(1001000, record.time[ESP_ZB_STARTUP_PHASE_RADIO_INIT]);
+    TEST_ASSERT_EQUAL(1012000, record.time[ESP_ZB_STARTUP_PHASE_STACK_INIT]);
+    TEST_ASSERT_EQUAL(1012000, record.time[ESP_ZB_STARTUP_PHASE_START]);
+    TEST_ASSERT_EQUAL(1013000, record.time[ESP_ZB_STARTUP_PHASE_NVS_LOADED]);
+    TEST_ASSERT_EQUAL(1033000, record.time[ESP_ZB_STARTUP_PHASE_RCP_READY]);
+    TEST_ASSERT_EQUAL(1033000, record.time[ESP_ZB_STARTUP_PHASE_STACK_READY]);
+    TEST_ASSERT_EQUAL(1133000, record.time[ESP_ZB_STARTUP_PHASE_JOINED]);
+    TEST_ASSERT_EQUAL(1183000, record.time[ESP_ZB_STARTUP_PHASE_FIRST_POLL]);
+    TEST_ASSERT_EQUAL(1233000, record.time[ESP_ZB_STARTUP_PHASE_FIRST_COMMAND]);
+    TEST_ASSERT_EQUAL(TEST_CHANNEL, record.channel);
+    TEST_ASSERT(!record.fast_rejoin);
+    /* without the fast rejoin nothing is stored */
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_nvs_write_count());
+    esp_zb_startup_dump();
+}
+
+/* the network is stored when the device joins, again only if it is another one */
+static void test_store(void)
+{
+    first_boot();
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_nvs_write_count());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_channel_mask());
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_STEERING, ESP_OK));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_nvs_write_count());
+    /* after a leave the device joins another network in the same boot */
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_LEAVE, ESP_OK));
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_nvs_write_count());
+    esp_zb_fake_network_set(20, TEST_PAN_ID + 1, TEST_SHORT_ADDR);
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_STEERING, ESP_OK));
+    TEST_ASSERT_EQUAL(3, esp_zb_fake_nvs_write_count());
+
+    /* the next boot rejoins on the channel of the last network */
+    startup_config(true);
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK));
+    TEST_ASSERT_EQUAL(1UL << 20, esp_zb_fake_channel_mask());
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT, ESP_OK));
+    TEST_ASSERT_EQUAL(TEST_CHANNEL_MASK, esp_zb_fake_channel_mask());
+}
+
+static void test_fast_rejoin(void)
+{
+    esp_zb_startup_record_t record;
+    uint8_t rejoin_count = 0;
+
+    first_boot();
+    esp_zb_startup_get_record(&record);
+    rejoin_count = record.rejoin_count;
+
+    /* the next boot, the stack is ready and the application starts the BDB initialization */
+    startup_config(true);
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK));
+    TEST_ASSERT_EQUAL(1UL << TEST_CHANNEL, esp_zb_fake_channel_mask());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_bdb_count(NULL));
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT, ESP_OK));
+    TEST_ASSERT_EQUAL(TEST_CHANNEL_MASK, esp_zb_fake_channel_mask());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_startup_get_record(&record));
+    TEST_ASSERT(record.fast_rejoin);
+    TEST_ASSERT_EQUAL(rejoin_count + 1, record.rejoin_count);
+    /* the network is unchanged, it is not written again */
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_nvs_write_count());
+}
+
+/* the failed rejoins are retried with a growing backoff, the last failure goes to the application */
+static void test_rejoin_retry(void)
+{
+    uint8_t mode = 0;
+    uint32_t delay = 0;
+
+    first_boot();
+    startup_config(true);
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK));
+    for (uint8_t i = 0; i < ESP_ZB_STARTUP_REJOIN_RETRY_MAX; i++) {
+        TEST_ASSERT(signal_send(ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT, ESP_FAIL));
+        TEST_ASSERT_EQUAL(1UL << TEST_CHANNEL, esp_zb_fake_channel_mask());
+        delay = esp_zb_fake_alarm_next();
+        TEST_ASSERT(delay >= (uint32_t)ESP_ZB_STARTUP_REJOIN_BACKOFF << i);
+        TEST_ASSERT(delay < ((uint32_t)ESP_ZB_STARTUP_REJOIN_BACKOFF << i) + ESP_ZB_STARTUP_REJOIN_BACKOFF);
+        esp_zb_fake_run(delay);
+        TEST_ASSERT_EQUAL(i + 1, esp_zb_fake_bdb_count(&mode));
+        TEST_ASSERT_EQUAL(ESP_ZB_BDB_MODE_INITIALIZATION, mode);
+    }
+    /* the device is still commissioned, the module does not start the network steering */
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT, ESP_FAIL));
+    TEST_ASSERT_EQUAL(TEST_CHANNEL_MASK, esp_zb_fake_channel_mask());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    TEST_ASSERT_EQUAL(ESP_ZB_STARTUP_REJOIN_RETRY_MAX, esp_zb_fake_bdb_count(NULL));
+    /* the later rejoins of the application are not taken over */
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT, ESP_FAIL));
+    /* the stored network is kept for the next boot */
+    startup_config(true);
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK));
+    TEST_ASSERT_EQUAL(1UL << TEST_CHANNEL, esp_zb_fake_channel_mask());
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT, ESP_OK));
+}
+
+/* a factory new start drops the network stored */
+static void test_factory_new(void)
+{
+    esp_zb_startup_cfg_t cfg = {.fast_rejoin = true};
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_startup_config(&cfg));
+    first_boot();
+    startup_config(true);
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK));
+    TEST_ASSERT(!signal_send(ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START, ESP_OK));
+    TEST_ASSERT_EQUAL(TEST_CHANNEL_MASK, esp_zb_fake_channel_mask());
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_nvs_write_count());
+    startup_config(true);
+    TEST_ASSERT(!signal_send(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK));
+    TEST_ASSERT_EQUAL(TEST_CHANNEL_MASK, esp_zb_fake_channel_mask());
+}
+
+int main(void)
+{
+    TEST_RUN(test_trace);
+    TEST_RUN(test_store);
+    TEST_RUN(test_fast_rejoin);
+    TEST_RUN(test_rejoin_retry);
+    TEST_RUN(test_factory_new);
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Submission queue tests: producer threads, half of them running as interrupt handlers, race on the ring while the
+ * Zigbee task drains it, no submission is lost, duplicated or reordered per producer, and a submission ends the wait
+ * of the Zigbee task at once. Built with the thread sanitizer. */
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "esp_zigbee_submit.h"
+#include "esp_zb_fake.h"
+
+#define TEST_PRODUCER_NUM           8
+#define TEST_SUBMIT_NUM             20000   /* submissions of each producer */
+#define TEST_QUEUE_SIZE             64
+
+typedef struct test_submit_s {
+    uint32_t producer;
+    uint32_t sequence;
+} test_submit_t;
+
+typedef struct test_producer_s {
+    pthread_t thread;
+    uint32_t id;
+    uint32_t drop_count;
+} test_producer_t;
+
+static uint32_t s_next[TEST_PRODUCER_NUM];
+static uint32_t s_run_count;
+static uint32_t s_order_error;
+static uint32_t s_nested_count;
+
+static void submit_cb(void *data)
+{
+    const test_submit_t *submit = data;
+
+    if (submit->producer >= TEST_PRODUCER_NUM || submit->sequence != s_next[submit->producer]) {
+        s_order_error++;
+        return;
+    }
+    s_next[submit->producer]++;
+    s_run_count++;
+}
+
+static void *producer_task(void *arg)
+{
+    test_producer_t *producer = arg;
+    test_submit_t submit = {.producer = producer->id};
+
+    esp_zb_fake_isr_set(producer->id & 1);
+    while (submit.sequence < TEST_SUBMIT_NUM) {
+        if (esp_zb_submit(submit_cb, &submit, sizeof(submit)) == ESP_OK) {
+            submit.sequence++;
+        } else {
+            producer->drop_count++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_multi_producer(void)
+{
+    test_producer_t producers[TEST_PRODUCER_NUM];
+    esp_zb_submit_stats_t stats;
+    uint32_t drop_count = 0;
+
+    s_run_count = 0;
+    s_order_error = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_init(TEST_QUEUE_SIZE));
+    for (uint32_t i = 0; i < TEST_PRODUCER_NUM; i++) {
+        s_next[i] = 0;
+        producers[i] = (test_producer_t){.id = i};
+        TEST_ASSERT_EQUAL(0, pthread_create(&producers[i].thread, NULL, producer_task, &producers[i]));
+    }
+    /* the Zigbee task */
+    while (s_run_count + s_order_error < TEST_PRODUCER_NUM * TEST_SUBMIT_NUM) {
+        if (!esp_zb_submit_process()) {
+            esp_zb_submit_wait(ESP_ZB_SUBMIT_IDLE_WAIT_TIME);
+        }
+    }
+    for (uint32_t i = 0; i < TEST_PRODUCER_NUM; i++) {
+        pthread_join(producers[i].thread, NULL);
+        drop_count += producers[i].drop_count;
+        TEST_ASSERT_EQUAL(TEST_SUBMIT_NUM, s_next[i]);
+    }
+    TEST_ASSERT_EQUAL(0, s_order_error);
+    TEST_ASSERT_EQUAL(0, esp_zb_submit_process());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_get_stats(&stats));
+    TEST_ASSERT_EQUAL(TEST_PRODUCER_NUM * TEST_SUBMIT_NUM, stats.submit_count);
+    TEST_ASSERT_EQUAL(TEST_PRODUCER_NUM * TEST_SUBMIT_NUM, stats.run_count);
+    TEST_ASSERT_EQUAL(drop_count, stats.drop_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_deinit());
+    printf("%d producers, %d submissions, queue of %d: %u full queue retries\n", TEST_PRODUCER_NUM,
+           TEST_PRODUCER_NUM * TEST_SUBMIT_NUM, TEST_QUEUE_SIZE, (unsigned)drop_count);
+}
+
+static void *late_producer_task(void *arg)
+{
+    test_submit_t submit = {0};
+    struct timespec delay = {.tv_nsec = 20 * 1000000};
+
+    nanosleep(&delay, NULL);
+    esp_zb_fake_isr_set(true);
+    esp_zb_submit(submit_cb, &submit, sizeof(submit));
+    return NULL;
+}
+
+static uint64_t monotonic_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/* the Zigbee task waits far longer than the producer takes to submit, the submission ends the wait */
+static void test_wakeup(void)
+{
+    pthread_t thread;
+    uint64_t start = 0;
+
+    s_run_count = 0;
+    s_next[0] = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_init(TEST_QUEUE_SIZE));
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, esp_zb_submit_wait(1));
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, late_producer_task, NULL));
+    start = monotonic_ms();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_wait(10000));
+    TEST_ASSERT(monotonic_ms() - start < 5000);
+    pthread_join(thread, NULL);
+    TEST_ASSERT_EQUAL(1, esp_zb_submit_process());
+    TEST_ASSERT_EQUAL(1, s_run_count);
+    /* the wakeup is taken */
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, esp_zb_submit_wait(1));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_deinit());
+}
+
+static void nested_cb(void *data)
+{
+    s_nested_count++;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit(nested_cb, NULL, 0));
+}
+
+static void test_queue_limits(void)
+{
+    esp_zb_submit_stats_t stats;
+    uint8_t data[ESP_ZB_SUBMIT_DATA_MAX_SIZE + 1] = {0};
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_submit(nested_cb, NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_init(3));
+    /* the errors of an interrupt handler are returned without the log of a task */
+    esp_zb_fake_isr_set(true);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_submit(NULL, NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_submit(nested_cb, data, sizeof(data)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_submit(nested_cb, NULL, 1));
+    esp_zb_fake_isr_set(false);
+
+    /* 3 is rounded up to 4 */
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit(nested_cb, NULL, 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_submit(nested_cb, NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_get_stats(&stats));
+    TEST_ASSERT_EQUAL(4, stats.size);
+    TEST_ASSERT_EQUAL(1, stats.drop_count);
+
+    /* a submission of a callback runs on the next call, not in the lap draining it */
+    s_nested_count = 0;
+    TEST_ASSERT_EQUAL(4, esp_zb_submit_process());
+    TEST_ASSERT_EQUAL(4, s_nested_count);
+    TEST_ASSERT_EQUAL(4, esp_zb_submit_process());
+    TEST_ASSERT_EQUAL(8, s_nested_count);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_submit_deinit());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_submit_deinit());
+}
+
+int main(void)
+{
+    TEST_RUN(test_queue_limits);
+    TEST_RUN(test_wakeup);
+    TEST_RUN(test_multi_producer);
+    return 0;
+}
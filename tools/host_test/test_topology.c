@@ -0,0 +1,371 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Topology crawler tests and benchmark: a simulated network of 200 nodes answers the Mgmt_Lqi and Mgmt_Rtg requests
+ * with a delay growing with the depth of the router, and the crawl time is measured for each number of requests in
+ * flight. */
+
+#include <string.h>
+#include "esp_random.h"
+#include "esp_zigbee_topology.h"
+#include "esp_zb_fake.h"
+
+#define NET_NODE_NUM                200
+#define NET_ROUTER_NUM              80      /* the coordinator and the routers, the end devices follow */
+#define NET_MESH_LINK_NUM           2       /* the links of each router to routers other than its parent and children */
+#define NET_NEIGHBOR_MAX_NUM        64
+#define NET_ROUTE_MAX_NUM           8
+#define NET_LQI_PAGE_SIZE           3       /* neighbor table records carried by a Mgmt_Lqi response */
+#define NET_RTG_PAGE_SIZE           10      /* routing table records carried by a Mgmt_Rtg response */
+#define NET_HOP_DELAY               25      /* time in millisecond a frame takes over a hop */
+#define NET_PROCESS_DELAY           15      /* time in millisecond a router takes to answer */
+#define NET_TIMEOUT                 5000    /* time in millisecond until a request is answered with a timeout */
+#define PENDING_MAX_NUM             16
+
+typedef struct net_node_s {
+    uint16_t short_addr;
+    uint8_t ieee_addr[8];
+    uint8_t device_type;
+    uint8_t depth;
+    uint16_t parent;
+    uint8_t neighbor_num;
+    uint16_t neighbor[NET_NEIGHBOR_MAX_NUM];
+    uint8_t route_num;
+    esp_zb_zdo_routing_table_record_t route[NET_ROUTE_MAX_NUM];
+    bool offline;                           /* the node does not answer */
+    bool rtg_not_supported;
+} net_node_t;
+
+typedef struct net_pending_s {
+    bool in_use;
+    uint32_t req_index;
+} net_pending_t;
+
+static net_node_t s_net[NET_NODE_NUM];
+static net_pending_t s_pending[PENDING_MAX_NUM];
+static uint32_t s_req_handled;
+static bool s_done;
+static esp_zb_topology_stats_t s_stats;
+
+static bool net_is_neighbor(uint16_t a, uint16_t b)
+{
+    for (uint8_t i = 0; i < s_net[a].neighbor_num; i++) {
+        if (s_net[a].neighbor[i] == b) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void net_link(uint16_t a, uint16_t b)
+{
+    if (a == b || net_is_neighbor(a, b)) {
+        return;
+    }
+    TEST_ASSERT(s_net[a].neighbor_num < NET_NEIGHBOR_MAX_NUM && s_net[b].neighbor_num < NET_NEIGHBOR_MAX_NUM);
+    s_net[a].neighbor[s_net[a].neighbor_num++] = b;
+    s_net[b].neighbor[s_net[b].neighbor_num++] = a;
+}
+
+/* a tree of routers with mesh links between them, the end devices hang off the routers */
+static void net_build(uint32_t seed)
+{
+    memset(s_net, 0, sizeof(s_net));
+    esp_zb_fake_random_seed(seed);
+    for (uint16_t i = 0; i < NET_NODE_NUM; i++) {
+        net_node_t *node = &s_net[i];
+
+        node->short_addr = i ? (uint16_t)(0x1000 + i * 7) : 0x0000;
+        node->ieee_addr[0] = i & 0xff;
+        node->ieee_addr[1] = i >> 8;
+        node->ieee_addr[7] = 0x74;
+        node->device_type = i == 0 ? 0x00 : (i < NET_ROUTER_NUM ? 0x01 : 0x02);
+        if (i) {
+            node->parent = esp_random() % (i < NET_ROUTER_NUM ? i : NET_ROUTER_NUM);
+            node->depth = s_net[node->parent].depth + 1;
+            net_link(i, node->parent);
+        }
+    }
+    for (uint16_t i = 1; i < NET_ROUTER_NUM; i++) {
+        for (uint8_t j = 0; j < NET_MESH_LINK_NUM; j++) {
+            net_link(i, esp_random() % NET_ROUTER_NUM);
+        }
+    }
+    /* the routes towards the coordinator and a few of the other routers */
+    for (uint16_t i = 0; i < NET_ROUTER_NUM; i++) {
+        net_node_t *node = &s_net[i];
+        uint8_t num = 1 + esp_random() % (NET_ROUTE_MAX_NUM - 1);
+
+        for (uint8_t j = 0; j < num; j++) {
+            uint16_t dst = j == 0 && i ? 0 : esp_random() % NET_ROUTER_NUM;
+            esp_zb_zdo_routing_table_record_t *route = &node->route[node->route_num++];
+
+            route->dst_addr = s_net[dst].short_addr;
+            route->next_hop_addr = s_net[i ? node->parent : node->neighbor[0]].short_addr;
+            route->many_to_one = dst == 0;
+        }
+    }
+}
+
+static uint32_t net_link_total(void)
+{
+    uint32_t total = 0;
+
+    for (uint16_t i = 0; i < NET_ROUTER_NUM; i++) {
+        total += s_net[i].offline ? 0 : s_net[i].neighbor_num;
+    }
+    return total;
+}
+
+static uint32_t net_route_total(void)
+{
+    uint32_t total = 0;
+
+    for (uint16_t i = 0; i < NET_ROUTER_NUM; i++) {
+        total += s_net[i].offline || s_net[i].rtg_not_supported ? 0 : s_net[i].route_num;
+    }
+    return total;
+}
+
+static net_node_t *net_find(uint16_t short_addr)
+{
+    for (uint16_t i = 0; i < NET_NODE_NUM; i++) {
+        if (s_net[i].short_addr == short_addr) {
+            return &s_net[i];
+        }
+    }
+    return NULL;
+}
+
+static void net_answer_lqi(const esp_zb_fake_zdo_req_t *req, const net_node_t *node)
+{
+    esp_zb_zdo_neighbor_table_record_t list[NET_LQI_PAGE_SIZE];
+    esp_zb_zdo_mgmt_lqi_rsp_t rsp = {
+        .src_addr = node->short_addr,
+        .neighbor_table_entries = node->neighbor_num,
+        .start_index = req->start_index,
+        .neighbor_table_list = list,
+    };
+
+    for (uint8_t i = req->start_index; i < node->neighbor_num && rsp.neighbor_table_list_count < NET_LQI_PAGE_SIZE; i++) {
+        const net_node_t *neighbor = &s_net[node->neighbor[i]];
+        esp_zb_zdo_neighbor_table_record_t *record = &list[rsp.neighbor_table_list_count++];
+
+        memset(record, 0, sizeof(*record));
+        memcpy(record->ieee_addr, neighbor->ieee_addr, sizeof(record->ieee_addr));
+        record->short_addr = neighbor->short_addr;
+        record->device_type = neighbor->device_type;
+        record->relationship = neighbor == &s_net[node->parent] && node != s_net ? 0x00 :
+                               (&s_net[neighbor->parent] == node ? 0x01 : 0x02);
+        record->depth = neighbor->depth;
+        record->lqi = 255 - (node->neighbor[i] % 100);
+    }
+    ((esp_zb_zdo_mgmt_lqi_callback_t)req->cb)(ESP_ZB_ZDP_STATUS_SUCCESS, &rsp, req->user_ctx);
+}
+
+static void net_answer_rtg(const esp_zb_fake_zdo_req_t *req, const net_node_t *node)
+{
+    esp_zb_zdo_mgmt_rtg_rsp_t rsp = {
+        .src_addr = node->short_addr,
+        .routing_table_entries = node->route_num,
+        .start_index = req->start_index,
+        .routing_table_list = (esp_zb_zdo_routing_table_record_t *) &node->route[req->start_index],
+    };
+
+    if (node->rtg_not_supported) {
+        ((esp_zb_zdo_mgmt_rtg_callback_t)req->cb)(ESP_ZB_ZDP_STATUS_NOT_SUPPORTED, NULL, req->user_ctx);
+        return;
+    }
+    rsp.routing_table_list_count = node->route_num - req->start_index < NET_RTG_PAGE_SIZE ? node->route_num - req->start_index :
+                                   NET_RTG_PAGE_SIZE;
+    ((esp_zb_zdo_mgmt_rtg_callback_t)req->cb)(ESP_ZB_ZDP_STATUS_SUCCESS, &rsp, req->user_ctx);
+}
+
+static void net_answer(uint8_t param)
+{
+    const esp_zb_fake_zdo_req_t *req = esp_zb_fake_zdo_req_get(s_pending[param].req_index);
+    const net_node_t *node = net_find(req->dst_addr);
+
+    s_pending[param].in_use = false;
+    TEST_ASSERT(node && node->device_type != 0x02);
+    if (node->offline) {
+        if (req->cluster_id == 0x0031) {
+            ((esp_zb_zdo_mgmt_lqi_callback_t)req->cb)(ESP_ZB_ZDP_STATUS_TIMEOUT, NULL, req->user_ctx);
+        } else {
+            ((esp_zb_zdo_mgmt_rtg_callback_t)req->cb)(ESP_ZB_ZDP_STATUS_TIMEOUT, NULL, req->user_ctx);
+        }
+    } else if (req->cluster_id == 0x0031) {
+        net_answer_lqi(req, node);
+    } else {
+        net_answer_rtg(req, node);
+    }
+}
+
+/* the requests sent since the last call are answered after the round trip to the router */
+static void net_serve(void)
+{
+    for (; s_req_handled < esp_zb_fake_zdo_req_count(); s_req_handled++) {
+        const esp_zb_fake_zdo_req_t *req = esp_zb_fake_zdo_req_get(s_req_handled);
+        const net_node_t *node = net_find(req->dst_addr);
+        uint8_t slot = 0;
+
+        TEST_ASSERT(req->cluster_id == 0x0031 || req->cluster_id == 0x0032);
+        while (slot < PENDING_MAX_NUM && s_pending[slot].in_use) {
+            slot++;
+        }
+        TEST_ASSERT(node && slot < PENDING_MAX_NUM);
+        s_pending[slot].in_use = true;
+        s_pending[slot].req_index = s_req_handled;
+        esp_zb_scheduler_alarm(net_answer, slot, node->offline ? NET_TIMEOUT :
+                               2 * NET_HOP_DELAY * (node->depth + 1) + NET_PROCESS_DELAY);
+    }
+}
+
+static void crawl_done_cb(const esp_zb_topology_stats_t *stats)
+{
+    s_done = true;
+    s_stats = *stats;
+}
+
+static esp_zb_topology_stats_t crawl_run(uint8_t max_in_flight, uint8_t max_retry, uint16_t route_capacity)
+{
+    esp_zb_topology_cfg_t cfg = {
+        .root_addr = 0x0000,
+        .max_in_flight = max_in_flight,
+        .max_retry = max_retry,
+        .node_capacity = NET_NODE_NUM,
+        .link_capacity = 2048,
+        .route_capacity = route_capacity,
+        .done_cb = crawl_done_cb,
+    };
+
+    esp_zb_fake_reset();
+    memset(s_pending, 0, sizeof(s_pending));
+    s_req_handled = 0;
+    s_done = false;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_topology_crawl_start(&cfg));
+    for (uint32_t time = 0; !s_done; time++) {
+        TEST_ASSERT(time < 600000);
+        net_serve();
+        esp_zb_fake_run(1);
+    }
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    return s_stats;
+}
+
+static void test_crawl_graph(void)
+{
+    const esp_zb_topology_node_t *nodes = NULL;
+    const esp_zb_topology_link_t *links = NULL;
+    const esp_zb_topology_route_t *routes = NULL;
+    uint16_t node_num = 0, link_num = 0, route_num = 0;
+    esp_zb_topology_stats_t stats;
+
+    net_build(1);
+    stats = crawl_run(4, 1, 1024);
+    TEST_ASSERT_EQUAL(NET_NODE_NUM, stats.node_count);
+    TEST_ASSERT_EQUAL(net_link_total(), stats.link_count);
+    TEST_ASSERT_EQUAL(net_route_total(), stats.route_count);
+    TEST_ASSERT_EQUAL(0, stats.fail_count);
+    TEST_ASSERT(!stats.truncated);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_topology_get_nodes(&nodes, &node_num));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_topology_get_links(&links, &link_num));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_topology_get_routes(&routes, &route_num));
+    /* every link joins the two nodes of the simulated network, with the IEEE addresses of the crawl */
+    for (uint16_t i = 0; i < link_num; i++) {
+        const esp_zb_topology_node_t *from = &nodes[links[i].from];
+        const esp_zb_topology_node_t *to = &nodes[links[i].to];
+
+        TEST_ASSERT(net_is_neighbor(from->ieee_addr[0] | (from->ieee_addr[1] << 8), to->ieee_addr[0] | (to->ieee_addr[1] << 8)));
+        TEST_ASSERT_EQUAL(net_find(to->short_addr)->ieee_addr[0], to->ieee_addr[0]);
+    }
+    /* the routes of a router are those of its routing table */
+    for (uint16_t i = 0; i < route_num; i++) {
+        const net_node_t *router = net_find(nodes[routes[i].from].short_addr);
+        bool found = false;
+
+        for (uint8_t j = 0; j < router->route_num; j++) {
+            found |= router->route[j].dst_addr == routes[i].dst_addr && router->route[j].next_hop_addr == routes[i].next_hop_addr &&
+                     router->route[j].many_to_one == routes[i].many_to_one;
+        }
+        TEST_ASSERT(found);
+    }
+    for (uint16_t i = 0; i < node_num; i++) {
+        TEST_ASSERT_EQUAL(ESP_ZB_TOPOLOGY_NODE_DONE, nodes[i].state);
+    }
+    esp_zb_topology_clear();
+}
+
+static void test_crawl_failures(void)
+{
+    const esp_zb_topology_node_t *nodes = NULL;
+    uint16_t node_num = 0;
+    uint32_t offline_req = 0;
+    uint16_t offline = 0;
+    esp_zb_topology_stats_t stats;
+
+    net_build(2);
+    /* an offline router without children is retried then failed, a router without Mgmt_Rtg is not failed */
+    for (offline = NET_ROUTER_NUM - 1; offline > 1; offline--) {
+        bool leaf = true;
+
+        for (uint16_t i = 0; i < NET_NODE_NUM; i++) {
+            leaf &= s_net[i].parent != offline || i == 0;
+        }
+        if (leaf) {
+            break;
+        }
+    }
+    TEST_ASSERT(offline > 1);
+    s_net[offline].offline = true;
+    s_net[1].rtg_not_supported = true;
+    stats = crawl_run(4, 2, 1024);
+    TEST_ASSERT_EQUAL(NET_NODE_NUM, stats.node_count);
+    TEST_ASSERT_EQUAL(1, stats.fail_count);
+    TEST_ASSERT_EQUAL(net_route_total(), stats.route_count);
+    for (uint32_t i = 0; i < esp_zb_fake_zdo_req_count(); i++) {
+        offline_req += esp_zb_fake_zdo_req_get(i)->dst_addr == s_net[offline].short_addr;
+    }
+    TEST_ASSERT_EQUAL(3, offline_req);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_topology_get_nodes(&nodes, &node_num));
+    for (uint16_t i = 0; i < node_num; i++) {
+        TEST_ASSERT_EQUAL(nodes[i].short_addr == s_net[offline].short_addr ? ESP_ZB_TOPOLOGY_NODE_FAILED : ESP_ZB_TOPOLOGY_NODE_DONE,
+                          nodes[i].state);
+    }
+    esp_zb_topology_clear();
+}
+
+static void bench_crawl(void)
+{
+    uint32_t duration[ESP_ZB_TOPOLOGY_IN_FLIGHT_MAX_NUM + 1] = {0};
+
+    net_build(1);
+    printf("\n%d nodes, %d routers, %u ms per hop, %u ms to answer\n", NET_NODE_NUM, NET_ROUTER_NUM, NET_HOP_DELAY,
+           NET_PROCESS_DELAY);
+    printf("%-10s %-8s %10s %10s %8s %8s\n", "in flight", "tables", "crawl ms", "requests", "links", "routes");
+    for (uint8_t in_flight = 1; in_flight <= ESP_ZB_TOPOLOGY_IN_FLIGHT_MAX_NUM; in_flight++) {
+        for (uint8_t routes = 0; routes < 2; routes++) {
+            esp_zb_topology_stats_t stats = crawl_run(in_flight, 1, routes ? 1024 : 0);
+
+            printf("%-10d %-8s %10u %10u %8u %8u\n", in_flight, routes ? "lqi+rtg" : "lqi", stats.duration, stats.req_count,
+                   stats.link_count, stats.route_count);
+            if (routes) {
+                duration[in_flight] = stats.duration;
+            }
+            esp_zb_topology_clear();
+        }
+    }
+    /* the requests in flight overlap the round trips, the crawl follows the depth rather than the number of routers */
+    TEST_ASSERT(duration[ESP_ZB_TOPOLOGY_IN_FLIGHT_MAX_NUM] * 3 < duration[1]);
+}
+
+int main(void)
+{
+    TEST_RUN(test_crawl_graph);
+    TEST_RUN(test_crawl_failures);
+    bench_crawl();
+    return 0;
+}
@@ -0,0 +1,360 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* ZDO management tests: the Mgmt_Rtg request is sent as a ZDP frame and its response is taken from the APS data
+ * indications, matched by the source and the transaction sequence number. A request the stack does not send releases
+ * its buffer and its slot. A bind batch sends its entries in order, reports the status of each in the order of the
+ * entries whatever the order of the responses, and completes an entry with an invalid address mode or no response. */
+
+#include <string.h>
+#include "zdo/esp_zigbee_zdo_command.h"
+#include "esp_zb_fake.h"
+
+#define TEST_RTG_RSP_CLUSTER        0x8032
+#define TEST_RTG_DST_ADDR           0x1234
+#define TEST_BIND_DST_ADDR          0x2000
+#define TEST_BIND_BATCH_NUM         5
+
+static uint32_t s_cb_count;
+static esp_zb_zdp_status_t s_cb_status;
+static esp_zb_zdo_mgmt_rtg_rsp_t s_cb_rsp;
+static esp_zb_zdo_routing_table_record_t s_cb_list[16];
+static bool s_cb_rsp_valid;
+
+static void rtg_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_rtg_rsp_t *rsp, void *user_ctx)
+{
+    s_cb_count++;
+    s_cb_status = zdo_status;
+    s_cb_rsp_valid = rsp != NULL;
+    if (rsp) {
+        s_cb_rsp = *rsp;
+        memcpy(s_cb_list, rsp->routing_table_list, rsp->routing_table_list_count * sizeof(s_cb_list[0]));
+    }
+    TEST_ASSERT_EQUAL((void *)&s_cb_count, user_ctx);
+}
+
+/* sends a request and returns its transaction sequence number */
+static uint8_t rtg_send(uint8_t start_index)
+{
+    esp_zb_zdo_mgmt_rtg_req_param_t req = {.dst_nwk_addr = TEST_RTG_DST_ADDR, .start_index = start_index};
+    const zb_apsde_data_req_t *aps = NULL;
+    const uint8_t *payload = NULL;
+    uint8_t len = 0;
+    uint32_t count = esp_zb_fake_aps_data_req_count();
+
+    s_cb_count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_zdo_mgmt_rtg_req(&req, rtg_cb, &s_cb_count));
+    TEST_ASSERT_EQUAL(count + 1, esp_zb_fake_aps_data_req_count());
+    aps = esp_zb_fake_aps_data_req_last(&payload, &len);
+    TEST_ASSERT_EQUAL(0x0000, aps->profileid);
+    TEST_ASSERT_EQUAL(0x0032, aps->clusterid);
+    TEST_ASSERT_EQUAL(0x02, aps->addr_mode);
+    TEST_ASSERT_EQUAL(0, aps->dst_endpoint);
+    TEST_ASSERT_EQUAL(TEST_RTG_DST_ADDR, aps->dst_addr.addr_short);
+    TEST_ASSERT_EQUAL(2, len);
+    TEST_ASSERT_EQUAL(start_index, payload[1]);
+    TEST_ASSERT(esp_zb_fake_af_hook_set());
+    return payload[0];
+}
+
+static bool rtg_respond(uint16_t src_addr, const uint8_t *frame, uint8_t len)
+{
+    zb_apsde_data_indication_t ind = {
+        .src_addr = src_addr,
+        .profileid = 0x0000,
+        .clusterid = TEST_RTG_RSP_CLUSTER,
+    };
+
+    return esp_zb_fake_af_indication(&ind, frame, len);
+}
+
+static void test_rtg_response(void)
+{
+    uint8_t tsn = rtg_send(2);
+    /* 4 entries from index 2: a many-to-one route and an inactive route constrained in memory */
+    uint8_t frame[] = {tsn, ESP_ZB_ZDP_STATUS_SUCCESS, 4, 2, 2,
+                       0x00, 0x00, 0x10, 0x34, 0x12,
+                       0x78, 0x56, 0x09, 0xcd, 0xab,
+                      };
+
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+    TEST_ASSERT(rtg_respond(TEST_RTG_DST_ADDR, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(1, s_cb_count);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_SUCCESS, s_cb_status);
+    TEST_ASSERT(s_cb_rsp_valid);
+    TEST_ASSERT_EQUAL(TEST_RTG_DST_ADDR, s_cb_rsp.src_addr);
+    TEST_ASSERT_EQUAL(4, s_cb_rsp.routing_table_entries);
+    TEST_ASSERT_EQUAL(2, s_cb_rsp.start_index);
+    TEST_ASSERT_EQUAL(2, s_cb_rsp.routing_table_list_count);
+    TEST_ASSERT_EQUAL(0x0000, s_cb_list[0].dst_addr);
+    TEST_ASSERT_EQUAL(0, s_cb_list[0].status);
+    TEST_ASSERT_EQUAL(1, s_cb_list[0].many_to_one);
+    TEST_ASSERT_EQUAL(0x1234, s_cb_list[0].next_hop_addr);
+    TEST_ASSERT_EQUAL(0x5678, s_cb_list[1].dst_addr);
+    TEST_ASSERT_EQUAL(1, s_cb_list[1].status);
+    TEST_ASSERT_EQUAL(1, s_cb_list[1].memory_constrained);
+    TEST_ASSERT_EQUAL(0, s_cb_list[1].many_to_one);
+    TEST_ASSERT_EQUAL(0xabcd, s_cb_list[1].next_hop_addr);
+    /* the response is consumed and freed, the timeout and the data indication handler are gone */
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    TEST_ASSERT(!esp_zb_fake_af_hook_set());
+}
+
+static void test_rtg_response_mismatch(void)
+{
+    uint8_t tsn = rtg_send(0);
+    uint8_t frame[] = {(uint8_t)(tsn + 1), ESP_ZB_ZDP_STATUS_SUCCESS, 0, 0, 0};
+
+    /* another transaction, then another source: both are left to the stack */
+    TEST_ASSERT(!rtg_respond(TEST_RTG_DST_ADDR, frame, sizeof(frame)));
+    frame[0] = tsn;
+    TEST_ASSERT(!rtg_respond(TEST_RTG_DST_ADDR + 1, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(0, s_cb_count);
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+
+    TEST_ASSERT(rtg_respond(TEST_RTG_DST_ADDR, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(1, s_cb_count);
+    TEST_ASSERT_EQUAL(0, s_cb_rsp.routing_table_list_count);
+    TEST_ASSERT(!esp_zb_fake_af_hook_set());
+}
+
+static void test_rtg_response_truncated(void)
+{
+    uint8_t tsn = rtg_send(0);
+    /* the list count claims 9 records, the frame carries one and a half */
+    uint8_t frame[] = {tsn, ESP_ZB_ZDP_STATUS_SUCCESS, 9, 0, 9,
+                       0x01, 0x00, 0x00, 0x02, 0x00,
+                       0x03, 0x00,
+                      };
+
+    TEST_ASSERT(rtg_respond(TEST_RTG_DST_ADDR, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(1, s_cb_count);
+    TEST_ASSERT_EQUAL(1, s_cb_rsp.routing_table_list_count);
+    TEST_ASSERT_EQUAL(0x0001, s_cb_list[0].dst_addr);
+    TEST_ASSERT_EQUAL(0x0002, s_cb_list[0].next_hop_addr);
+}
+
+static void test_rtg_not_supported(void)
+{
+    uint8_t tsn = rtg_send(0);
+    uint8_t frame[] = {tsn, ESP_ZB_ZDP_STATUS_NOT_SUPPORTED};
+
+    TEST_ASSERT(rtg_respond(TEST_RTG_DST_ADDR, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(1, s_cb_count);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_NOT_SUPPORTED, s_cb_status);
+    TEST_ASSERT(!s_cb_rsp_valid);
+}
+
+static void test_rtg_timeout(void)
+{
+    uint8_t tsn = rtg_send(0);
+    uint8_t frame[] = {tsn, ESP_ZB_ZDP_STATUS_SUCCESS, 0, 0, 0};
+
+    esp_zb_fake_run(ESP_ZB_ZDO_MGMT_RTG_TIMEOUT - 1);
+    TEST_ASSERT_EQUAL(0, s_cb_count);
+    esp_zb_fake_run(1);
+    TEST_ASSERT_EQUAL(1, s_cb_count);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_TIMEOUT, s_cb_status);
+    TEST_ASSERT(!s_cb_rsp_valid);
+    TEST_ASSERT(!esp_zb_fake_af_hook_set());
+    /* a late response is not taken for the finished request */
+    TEST_ASSERT(!rtg_respond(TEST_RTG_DST_ADDR, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL(1, s_cb_count);
+}
+
+static void lqi_failure_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_lqi_rsp_t *rsp, void *user_ctx)
+{
+    TEST_ASSERT(false);
+}
+
+static void mgmt_bind_failure_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_bind_rsp_t *rsp, void *user_ctx)
+{
+    TEST_ASSERT(false);
+}
+
+static void energy_scan_failure_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_mgmt_nwk_update_rsp_t *rsp, void *user_ctx)
+{
+    TEST_ASSERT(false);
+}
+
+static void match_failure_cb(esp_zb_zdp_status_t zdo_status, const esp_zb_zdo_match_cluster_result_t *results, uint16_t result_num,
+                             void *user_ctx)
+{
+    TEST_ASSERT(false);
+}
+
+static void bind_failure_cb(esp_zb_zdp_status_t zdo_status, void *user_ctx)
+{
+    TEST_ASSERT(false);
+}
+
+/* each request the stack refuses gives its buffer back, the slots stay free for the requests that follow */
+static void test_stack_failure_releases_buffer(void)
+{
+    esp_zb_zdo_mgmt_lqi_req_param_t lqi_req = {.dst_nwk_addr = TEST_RTG_DST_ADDR};
+    esp_zb_zdo_mgmt_bind_req_param_t mgmt_bind_req = {.dst_nwk_addr = TEST_RTG_DST_ADDR};
+    esp_zb_zdo_bind_req_param_t bind_req = {.dst_addr_mode = ESP_ZB_ZDO_BIND_DST_ADDR_MODE_16_BIT_GROUP, .req_dst_addr = TEST_RTG_DST_ADDR};
+    esp_zb_zdo_energy_scan_req_param_t scan_req = {.dst_nwk_addr = TEST_RTG_DST_ADDR, .scan_channels = 0x07fff800, .scan_count = 1};
+    uint16_t cluster_list[] = {0x0006};
+    esp_zb_zdo_match_cluster_req_param_t match_req = {.dst_nwk_addr = TEST_RTG_DST_ADDR, .profile_id = 0x0104, .num_in_clusters = 1,
+                                                      .cluster_list = cluster_list,
+                                                     };
+
+    esp_zb_fake_stack_zdo_fail(true);
+    for (int round = 0; round < ESP_ZB_FAKE_BUF_NUM * 2; round++) {
+        TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_zdo_mgmt_lqi_req(&lqi_req, lqi_failure_cb, NULL));
+        TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_zdo_mgmt_bind_req(&mgmt_bind_req, mgmt_bind_failure_cb, NULL));
+        TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_zdo_device_group_bind_req(&bind_req, bind_failure_cb, NULL));
+        TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_zdo_device_unbind_req(&bind_req, bind_failure_cb, NULL));
+        TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_zdo_energy_scan_req(&scan_req, energy_scan_failure_cb, NULL));
+        TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_zdo_channel_change_req(15));
+        TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, esp_zb_zdo_match_cluster_req(&match_req, match_failure_cb, NULL));
+        TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+    }
+    esp_zb_fake_stack_zdo_fail(false);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_zdo_mgmt_lqi_req(&lqi_req, lqi_failure_cb, NULL));
+}
+
+/* the two counts of a match request are bounded one by one, their sum in uint8_t would wrap */
+static void test_match_cluster_count_wrap(void)
+{
+    uint16_t cluster_list[ESP_ZB_ZDO_MATCH_CLUSTER_MAX_NUM] = {0};
+    esp_zb_zdo_match_cluster_req_param_t match_req = {.dst_nwk_addr = TEST_RTG_DST_ADDR, .profile_id = 0x0104, .num_in_clusters = 250,
+                                                      .num_out_clusters = 10, .cluster_list = cluster_list,
+                                                     };
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_zdo_match_cluster_req(&match_req, match_failure_cb, NULL));
+    match_req.num_in_clusters = 10;
+    match_req.num_out_clusters = 250;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_zdo_match_cluster_req(&match_req, match_failure_cb, NULL));
+    match_req.num_in_clusters = ESP_ZB_ZDO_MATCH_CLUSTER_MAX_NUM;
+    match_req.num_out_clusters = 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_zb_zdo_match_cluster_req(&match_req, match_failure_cb, NULL));
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_stack_zdo_count());
+    match_req.num_out_clusters = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_zdo_match_cluster_req(&match_req, match_failure_cb, NULL));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_stack_zdo_count());
+}
+
+static uint32_t s_batch_cb_count;
+static esp_zb_zdp_status_t s_batch_status[TEST_BIND_BATCH_NUM];
+static uint16_t s_batch_entry_num;
+
+static void bind_batch_cb(const esp_zb_zdp_status_t *status_list, uint16_t entry_num, void *user_ctx)
+{
+    s_batch_cb_count++;
+    s_batch_entry_num = entry_num;
+    memcpy(s_batch_status, status_list, entry_num * sizeof(esp_zb_zdp_status_t));
+    TEST_ASSERT_EQUAL((void *)&s_batch_cb_count, user_ctx);
+}
+
+/* the entry i asks the device TEST_BIND_DST_ADDR + i to bind its cluster i to a group */
+static void bind_batch_entries(esp_zb_zdo_bind_batch_entry_t *entries, uint16_t entry_num)
+{
+    memset(entries, 0, entry_num * sizeof(esp_zb_zdo_bind_batch_entry_t));
+    for (uint16_t i = 0; i < entry_num; i++) {
+        entries[i].bind_req.cluster_id = i;
+        entries[i].bind_req.dst_addr_mode = ESP_ZB_ZDO_BIND_DST_ADDR_MODE_16_BIT_GROUP;
+        entries[i].bind_req.dst_address_u.addr_short = 0x0001;
+        entries[i].bind_req.req_dst_addr = TEST_BIND_DST_ADDR + i;
+    }
+    s_batch_cb_count = 0;
+}
+
+/* checks the request sent with a transaction sequence number is the one of an entry */
+static void bind_batch_check_sent(uint8_t tsn, uint16_t entry, bool unbind)
+{
+    bool sent_unbind = !unbind;
+    const zb_zdo_bind_req_param_t *req = esp_zb_fake_bind_req_get(tsn, &sent_unbind);
+
+    TEST_ASSERT(req);
+    TEST_ASSERT_EQUAL(TEST_BIND_DST_ADDR + entry, req->req_dst_addr);
+    TEST_ASSERT_EQUAL(entry, req->cluster_id);
+    TEST_ASSERT_EQUAL(unbind, sent_unbind);
+}
+
+static void bind_respond(uint8_t tsn, esp_zb_zdp_status_t status)
+{
+    zb_bufid_t buf = zb_buf_get_out();
+    zb_zdo_bind_resp_t *resp = NULL;
+
+    TEST_ASSERT(buf != ZB_BUF_INVALID);
+    resp = zb_buf_initial_alloc(buf, sizeof(zb_zdo_bind_resp_t));
+    resp->tsn = tsn;
+    resp->status = status;
+    esp_zb_fake_stack_zdo_last(NULL)(buf);
+}
+
+/* the responses come out of order, one entry fails, one has no address mode and is not sent */
+static void test_bind_batch_order(void)
+{
+    esp_zb_zdo_bind_batch_entry_t entries[TEST_BIND_BATCH_NUM];
+
+    bind_batch_entries(entries, TEST_BIND_BATCH_NUM);
+    entries[2].bind_req.dst_addr_mode = 0;
+    entries[4].unbind = true;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_zdo_bind_batch_req(entries, TEST_BIND_BATCH_NUM, 2, bind_batch_cb, &s_batch_cb_count));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_zb_zdo_bind_batch_req(entries, 1, 1, bind_batch_cb, &s_batch_cb_count));
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_stack_zdo_count());
+    bind_batch_check_sent(1, 0, false);
+    bind_batch_check_sent(2, 1, false);
+    /* the invalid entry is completed at once and the next one takes its place */
+    bind_respond(2, ESP_ZB_ZDP_STATUS_SUCCESS);
+    TEST_ASSERT_EQUAL(3, esp_zb_fake_stack_zdo_count());
+    bind_batch_check_sent(3, 3, false);
+    bind_respond(1, ESP_ZB_ZDP_STATUS_NOT_AUTHORIZED);
+    TEST_ASSERT_EQUAL(4, esp_zb_fake_stack_zdo_count());
+    bind_batch_check_sent(4, 4, true);
+    bind_respond(4, ESP_ZB_ZDP_STATUS_SUCCESS);
+    TEST_ASSERT_EQUAL(0, s_batch_cb_count);
+    bind_respond(3, ESP_ZB_ZDP_STATUS_TABLE_FULL);
+    TEST_ASSERT_EQUAL(1, s_batch_cb_count);
+    TEST_ASSERT_EQUAL(TEST_BIND_BATCH_NUM, s_batch_entry_num);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_NOT_AUTHORIZED, s_batch_status[0]);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_SUCCESS, s_batch_status[1]);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_INV_REQUESTTYPE, s_batch_status[2]);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_TABLE_FULL, s_batch_status[3]);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_SUCCESS, s_batch_status[4]);
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_buf_in_use());
+}
+
+/* an entry the stack never answers is completed by the batch, its late response is ignored */
+static void test_bind_batch_timeout(void)
+{
+    esp_zb_zdo_bind_batch_entry_t entries[2];
+
+    bind_batch_entries(entries, 2);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_zb_zdo_bind_batch_req(entries, 2, 1, bind_batch_cb, &s_batch_cb_count));
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_stack_zdo_count());
+    esp_zb_fake_run(ESP_ZB_ZDO_BIND_BATCH_TIMEOUT - 1);
+    TEST_ASSERT_EQUAL(1, esp_zb_fake_stack_zdo_count());
+    esp_zb_fake_run(1);
+    TEST_ASSERT_EQUAL(2, esp_zb_fake_stack_zdo_count());
+    bind_batch_check_sent(2, 1, false);
+    bind_respond(1, ESP_ZB_ZDP_STATUS_SUCCESS);
+    TEST_ASSERT_EQUAL(0, s_batch_cb_count);
+    bind_respond(2, ESP_ZB_ZDP_STATUS_SUCCESS);
+    TEST_ASSERT_EQUAL(1, s_batch_cb_count);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_TIMEOUT, s_batch_status[0]);
+    TEST_ASSERT_EQUAL(ESP_ZB_ZDP_STATUS_SUCCESS, s_batch_status[1]);
+    TEST_ASSERT_EQUAL(0, esp_zb_fake_alarm_count());
+}
+
+int main(void)
+{
+    TEST_RUN(test_rtg_response);
+    TEST_RUN(test_rtg_response_mismatch);
+    TEST_RUN(test_rtg_response_truncated);
+    TEST_RUN(test_rtg_not_supported);
+    TEST_RUN(test_rtg_timeout);
+    TEST_RUN(test_bind_batch_order);
+    TEST_RUN(test_bind_batch_timeout);
+    TEST_RUN(test_stack_failure_releases_buffer);
+    TEST_RUN(test_match_cluster_count_wrap);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Script to generate the synthetic sensor traces of the sensor pipeline benchmark, a trace recorded on a device in the same
+format may be given to the benchmark instead.
+"""
+
+import argparse
+import math
+import random
+
+DAY_MS = 24 * 3600 * 1000
+
+
+def temperature(t, rng):
+    # 0.01 degree Celsius: a daily swing, a heater switched on for two hours, sensor noise and rare glitches
+    value = 2100 + 250 * math.sin(2 * math.pi * t / DAY_MS)
+    if 8 * 3600 * 1000 <= t < 10 * 3600 * 1000:
+        value += 300
+    value += rng.gauss(0, 6)
+    if rng.random() < 0.002:
+        value += rng.choice([-1, 1]) * 400
+    return int(round(value))
+
+
+def humidity(t, rng):
+    # 0.01 %RH: a slow swing, a shower raising the humidity for half an hour and a noisier sensor
+    value = 4800 + 600 * math.sin(2 * math.pi * t / DAY_MS + 1.0)
+    if 19 * 3600 * 1000 <= t < 19.5 * 3600 * 1000:
+        value += 2500
+    value += rng.gauss(0, 35)
+    if rng.random() < 0.002:
+        value += rng.choice([-1, 1]) * 1500
+    return int(round(value))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Sensor trace generator')
+    parser.add_argument('--period', default=30000, type=int, help='The sample period in millisecond, default 30000.')
+    parser.add_argument('--seed', default=1, type=int, help='The seed of the random generator, default 1.')
+    args = parser.parse_args()
+    for name, model in (('temperature', temperature), ('humidity', humidity)):
+        rng = random.Random(args.seed)
+        with open('{}.csv'.format(name), 'w') as trace:
+            trace.write('time_ms,value\n')
+            for t in range(0, DAY_MS, args.period):
+                trace.write('{},{}\n'.format(t, model(t, rng)))
+
+
+if __name__ == '__main__':
+    main()
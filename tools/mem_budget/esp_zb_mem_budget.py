@@ -0,0 +1,151 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Script to estimate the heap used by the Zigbee library for a device configuration, per subsystem.
+"""
+
+import argparse
+import json
+import sys
+
+# the subsystems, as printed by esp_zb_mem_stats_dump()
+TAGS = ['core', 'data_model', 'zcl', 'zdo', 'nwk', 'ota', 'cli', 'app']
+
+# the size in bytes of each block the library allocates, for the 32-bit targets
+ATTR_NODE_SIZE = 16             # esp_zb_attribute_list_t
+CLUSTER_NODE_SIZE = 20          # esp_zb_cluster_list_t
+EP_NODE_SIZE = 40               # esp_zb_ep_list_t
+CLUSTER_DESC_SIZE = 15          # esp_zb_zcl_cluster_t
+ATTR_DESC_SIZE = 10             # esp_zb_zcl_attr_t
+SIMPLE_DESC_SIZE = 8            # esp_zb_af_simple_desc_1_1_t without its cluster list
+REPORTING_INFO_SIZE = 48        # esp_zb_zcl_reporting_info_t
+ALARM_ENTRY_SIZE = 28           # esp_zigbee_alarm.c
+SUBMIT_SLOT_SIZE = 44           # esp_zigbee_submit.c
+TOPOLOGY_NODE_SIZE = 16         # esp_zb_topology_node_t
+TOPOLOGY_LINK_SIZE = 6          # esp_zb_topology_link_t
+IC_STORE_ENTRY_SIZE = 24        # esp_zigbee_ic_store.c
+IEEE_ADDR_SIZE = 8              # esp_zb_ieee_addr_t
+DOOR_LOCK_RECORD_SIZE = 40      # esp_zigbee_door_lock.c
+REGISTRY_ENTRY_SIZE = 120       # esp_zigbee_registry.c
+MATCH_RESULT_SIZE = 4 * 64      # ESP_ZB_ZDO_MATCH_CLUSTER_RESULT_MAX_NUM of esp_zb_zdo_match_cluster_result_t
+BIND_BATCH_ENTRY_SIZE = 28 + 4  # esp_zb_zdo_bind_batch_entry_t and its esp_zb_zdp_status_t
+INDEX_ENTRY_SIZE = 2            # the hash indexes hold 16-bit entries
+
+MEM_TABLE_ENTRY_SIZE = 8        # the entry of the block table of esp_zigbee_mem.c
+MEM_TABLE_MIN_SIZE = 32         # ESP_ZB_MEM_TABLE_MIN_SIZE
+
+
+def power_of_two(value):
+    size = 1
+    while size < value:
+        size <<= 1
+    return size
+
+
+def index_size(num):
+    # the hash indexes have twice as many entries as the table, rounded up to a power of two
+    return power_of_two(2 * num) * INDEX_ENTRY_SIZE if num else 0
+
+
+def table_size(blocks):
+    # the block table is doubled when three quarters full, it is a block of its own
+    return max(MEM_TABLE_MIN_SIZE, power_of_two(-(-4 * blocks // 3))) * MEM_TABLE_ENTRY_SIZE
+
+
+def compute_budget(config):
+    # each item: (tag, description, bytes, blocks)
+    items = []
+    for index, ep in enumerate(config.get('endpoints', [])):
+        clusters = ep.get('clusters', [])
+        attr_num = sum(cluster.get('attributes', 0) for cluster in clusters)
+        value_size = sum(cluster.get('attributes', 0) * cluster.get('value_size', 4) for cluster in clusters)
+        reportable = sum(cluster.get('reportable', 0) for cluster in clusters)
+        name = 'endpoint {}'.format(ep.get('id', index + 1))
+        items.append(('data_model', name + ' lists', EP_NODE_SIZE + len(clusters) * (CLUSTER_NODE_SIZE + ATTR_NODE_SIZE) +
+                      attr_num * ATTR_NODE_SIZE, 1 + 2 * len(clusters) + attr_num))
+        items.append(('data_model', name + ' attribute values', value_size, attr_num))
+        items.append(('core', name + ' registration', len(clusters) * (CLUSTER_DESC_SIZE + 2) + SIMPLE_DESC_SIZE +
+                      (attr_num + len(clusters)) * ATTR_DESC_SIZE, 2 + len(clusters)))
+        if reportable:
+            items.append(('core', name + ' reporting slots', reportable * REPORTING_INFO_SIZE, 1))
+    if config.get('alarm_num'):
+        items.append(('core', 'alarms', config['alarm_num'] * ALARM_ENTRY_SIZE, 1))
+    if config.get('submit_queue_size'):
+        items.append(('core', 'submission queue', power_of_two(config['submit_queue_size']) * SUBMIT_SLOT_SIZE, 1))
+    if config.get('door_lock_user_num'):
+        num = config['door_lock_user_num']
+        items.append(('zcl', 'door lock users', num * DOOR_LOCK_RECORD_SIZE + 2 * index_size(num), 3))
+    if config.get('registry_device_num'):
+        num = config['registry_device_num']
+        items.append(('zdo', 'device registry', num * REGISTRY_ENTRY_SIZE + 2 * index_size(num), 3))
+    if config.get('match_request_num'):
+        items.append(('zdo', 'match cluster requests', config['match_request_num'] * MATCH_RESULT_SIZE,
+                      config['match_request_num']))
+    if config.get('bind_batch_entry_num'):
+        items.append(('zdo', 'bind batch', config['bind_batch_entry_num'] * BIND_BATCH_ENTRY_SIZE, 2))
+    if config.get('topology'):
+        nodes = config['topology'].get('node_capacity', 0)
+        links = config['topology'].get('link_capacity', 0)
+        items.append(('nwk', 'topology', nodes * TOPOLOGY_NODE_SIZE + links * TOPOLOGY_LINK_SIZE + index_size(nodes), 3))
+    if config.get('ic_store_device_num'):
+        num = config['ic_store_device_num']
+        items.append(('nwk', 'install codes', num * IC_STORE_ENTRY_SIZE + index_size(num), 2))
+    if config.get('allowlist_num'):
+        items.append(('nwk', 'join allow list', config['allowlist_num'] * IEEE_ADDR_SIZE, 1))
+    # the parts which depend on the traffic or on the application, measured with esp_zb_mem_stats_get()
+    for tag, size in config.get('extra', {}).items():
+        if tag not in TAGS:
+            raise ValueError('unknown tag in extra: {}'.format(tag))
+        items.append((tag, 'extra', size, 0))
+    return items
+
+
+def print_budget(items, args):
+    totals = {tag: [0, 0] for tag in TAGS}
+    print('{:<10} {:<36} {:>8} {:>7}'.format('tag', 'item', 'bytes', 'blocks'))
+    for tag, name, size, blocks in sorted(items, key=lambda item: TAGS.index(item[0])):
+        print('{:<10} {:<36} {:>8} {:>7}'.format(tag, name, size, blocks))
+        totals[tag][0] += size
+        totals[tag][1] += blocks
+    print()
+    print('{:<10} {:>8} {:>7}'.format('tag', 'bytes', 'blocks'))
+    for tag in TAGS:
+        if totals[tag][0]:
+            print('{:<10} {:>8} {:>7}'.format(tag, totals[tag][0], totals[tag][1]))
+    size = sum(total[0] for total in totals.values())
+    blocks = sum(total[1] for total in totals.values())
+    table = table_size(blocks)
+    overhead = (blocks + 1) * args.heap_overhead + table
+    print('{:<10} {:>8} {:>7}'.format('total', size, blocks))
+    print('Overhead: {} bytes ({} per block, block table {}), heap budget: {} bytes'.format(overhead, args.heap_overhead,
+                                                                                          table, size + overhead))
+
+
+def get_args():
+    parser = argparse.ArgumentParser(description='ESP Zigbee Memory Budget')
+    parser.add_argument('config', type=str, help='Device configuration in JSON, - for stdin.')
+    parser.add_argument('--heap_overhead', default=8, type=int, help='The bytes the heap adds to each block, default 8.')
+    return parser.parse_args()
+
+
+def main():
+    args = get_args()
+    if args.config == '-':
+        config = json.load(sys.stdin)
+    else:
+        with open(args.config, 'r') as config_file:
+            config = json.load(config_file)
+    try:
+        items = compute_budget(config)
+    except ValueError as e:
+        print(e)
+        sys.exit(1)
+    print_budget(items, args)
+
+
+if __name__ == '__main__':
+    main()
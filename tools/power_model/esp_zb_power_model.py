@@ -0,0 +1,89 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""
+Script to estimate the average current draw of a sleepy end device from its recorded wake trace.
+"""
+
+import argparse
+import re
+import sys
+
+# trace line logged by esp_zb_sleep_light(): trace,<awake time in us>,<sleep time in us>,<wake-up reason>
+TRACE_PATTERN = re.compile(r'ESP_ZB_SLEEP: trace,(\d+),(\d+),(\w+)')
+
+
+def parse_trace(lines):
+    trace = []
+    for line in lines:
+        match = TRACE_PATTERN.search(line)
+        if match:
+            trace.append((int(match.group(1)), int(match.group(2)), match.group(3)))
+    return trace
+
+
+def compute_model(trace, args):
+    awake_time = sum(awake for awake, _, _ in trace)
+    sleep_time = sum(sleep for _, sleep, _ in trace)
+    total_time = awake_time + sleep_time
+    reasons = {}
+    for _, _, reason in trace:
+        reasons[reason] = reasons.get(reason, 0) + 1
+    # charge in uC: current in mA times time in us gives nC
+    charge = (awake_time * args.active_current + sleep_time * args.sleep_current / 1000) / 1000
+    charge += len(trace) * args.wakeup_charge
+    average_current = charge / total_time * 1000 if total_time else 0
+    return {
+        'sleep_count': len(trace),
+        'total_time': total_time,
+        'awake_time': awake_time,
+        'sleep_time': sleep_time,
+        'reasons': reasons,
+        'average_current': average_current,
+    }
+
+
+def print_model(model, args):
+    total_time = model['total_time']
+    print('Trace: {} sleeps over {:.3f} s'.format(model['sleep_count'], total_time / 1e6))
+    print('Awake: {:.3f} s ({:.2f} %), asleep: {:.3f} s ({:.2f} %)'.format(
+        model['awake_time'] / 1e6, model['awake_time'] * 100 / total_time,
+        model['sleep_time'] / 1e6, model['sleep_time'] * 100 / total_time))
+    for reason, count in sorted(model['reasons'].items()):
+        print('Wake-ups on {}: {}'.format(reason, count))
+    print('Average current: {:.1f} uA'.format(model['average_current'] * 1000))
+    if args.battery_capacity:
+        hours = args.battery_capacity / model['average_current']
+        print('Battery life: {:.0f} h ({:.1f} days)'.format(hours, hours / 24))
+
+
+def get_args():
+    parser = argparse.ArgumentParser(description='ESP Zigbee Sleep Current Model')
+    parser.add_argument('trace', type=str, help='Device log containing the trace lines of esp_zb_sleep_light(), - for stdin.')
+    parser.add_argument('--active_current', default=25.0, type=float, help='The current in mA while awake, default 25 mA.')
+    parser.add_argument('--sleep_current', default=20.0, type=float, help='The current in uA in light sleep, default 20 uA.')
+    parser.add_argument('--wakeup_charge', default=10.0, type=float, help='The extra charge in uC drawn by a wake-up, default 10 uC.')
+    parser.add_argument('--battery_capacity', default=0, type=float, help='The battery capacity in mAh, to estimate the battery life.')
+    return parser.parse_args()
+
+
+def main():
+    args = get_args()
+    if args.trace == '-':
+        trace = parse_trace(sys.stdin)
+    else:
+        with open(args.trace, 'r') as trace_file:
+            trace = parse_trace(trace_file)
+    if not trace:
+        sys.exit('No trace line found, enable the trace of esp_zb_sleep_init()')
+    model = compute_model(trace, args)
+    if not model['total_time']:
+        sys.exit('The trace covers no time')
+    print_model(model, args)
+
+
+if __name__ == '__main__':
+    main()